@@ -4,12 +4,14 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <bitset>
 #include <vector>
 
 #include "revng/ABI/FunctionType/Support.h"
 #include "revng/ABI/ScalarType.h"
 #include "revng/ADT/SortedVector.h"
 #include "revng/Model/ABI.h"
+#include "revng/Model/LayoutCache.h"
 #include "revng/Model/RawFunctionDefinition.h"
 #include "revng/Model/Register.h"
 #include "revng/Support/Debug.h"
@@ -339,12 +341,8 @@ public:
   bool
   isPreliminarilyCompatibleWith(const model::RawFunctionDefinition &RFT) const;
 
-  struct AlignmentInfo {
-    uint64_t Value;
-    bool IsNatural;
-  };
-  using AlignmentCache = std::unordered_map<const model::TypeDefinition *,
-                                            AlignmentInfo>;
+  using AlignmentInfo = model::TypeAlignment;
+  using AlignmentCache = model::LayoutCacheScope::AlignmentCache;
 
   /// Compute the natural alignment of the type in accordance with
   /// the current ABI
@@ -361,12 +359,18 @@ public:
   /// \return either an alignment or a `std::nullopt` when it's not applicable.
   template<model::AnyType AnyType>
   std::optional<uint64_t> alignment(const AnyType &Type) const {
+    if (auto *Scope = model::LayoutCacheScope::current())
+      return alignment(Type, Scope->alignments(ABI()));
+
     AlignmentCache Cache;
     return alignment(Type, Cache);
   }
 
   template<model::AnyType AnyType>
   std::optional<bool> hasNaturalAlignment(const AnyType &Type) const {
+    if (auto *Scope = model::LayoutCacheScope::current())
+      return hasNaturalAlignment(Type, Scope->alignments(ABI()));
+
     AlignmentCache Cache;
     return hasNaturalAlignment(Type, Cache);
   }
@@ -400,6 +404,12 @@ public:
 public:
   using RegisterSet = std::set<model::Register::Values>;
 
+  /// A fixed-width set of registers, indexed by `model::Register::Values`.
+  ///
+  /// Prefer it to \ref RegisterSet on hot paths: the deductions below are
+  /// implemented in terms of it, the `RegisterSet` overloads just convert.
+  using RegisterMask = std::bitset<model::Register::Count>;
+
   /// Try to deduce the specific "holes" in the provided register state
   /// information.
   ///
@@ -430,6 +440,14 @@ public:
   RegisterSet enforceArgumentRegisterState(RegisterSet &&Arguments) const;
   RegisterSet enforceReturnValueRegisterState(RegisterSet &&ReturnValues) const;
 
+  /// \ref RegisterMask based versions of the deductions above.
+  std::optional<RegisterMask>
+  tryDeducingArgumentRegisterMask(RegisterMask Arguments) const;
+  std::optional<RegisterMask>
+  tryDeducingReturnValueRegisterMask(RegisterMask ReturnValues) const;
+  RegisterMask enforceArgumentRegisterMask(RegisterMask Arguments) const;
+  RegisterMask enforceReturnValueRegisterMask(RegisterMask ReturnValues) const;
+
 private:
   llvm::SmallVector<model::Register::Values, 8> argumentOrder() const {
     llvm::SmallVector<model::Register::Values, 8> Result;
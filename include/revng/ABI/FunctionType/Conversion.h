@@ -8,6 +8,8 @@
 
 namespace abi::FunctionType {
 
+class TypeDefinitionReplacer;
+
 /// Best effort `CABIFunctionDefinition` to `RawFunctionDefinition` conversion.
 ///
 /// If `ABI` is not specified, `Binary.DefaultABI` is used instead.
@@ -15,10 +17,13 @@ namespace abi::FunctionType {
 /// \param UseSoftRegisterStateDeductions For specifics see the difference
 ///        between `abi::Definition::tryDeducingArgumentRegisterState` (`true`)
 ///        and `abi::Definition::enforceArgumentRegisterState` (`false`).
+/// \param Replacer If not null, the replacement of \p Function with the new
+///        definition is scheduled here instead of being performed right away.
 std::optional<model::UpcastableType>
 tryConvertToCABI(const model::RawFunctionDefinition &Function,
                  TupleTree<model::Binary> &Binary,
                  std::optional<model::ABI::Values> ABI = std::nullopt,
-                 bool UseSoftRegisterStateDeductions = true);
+                 bool UseSoftRegisterStateDeductions = true,
+                 TypeDefinitionReplacer *Replacer = nullptr);
 
 } // namespace abi::FunctionType
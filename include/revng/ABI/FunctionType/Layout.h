@@ -4,6 +4,8 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <map>
+
 #include "llvm/ADT/STLExtras.h"
 
 #include "revng/ABI/Definition.h"
@@ -11,13 +13,19 @@
 
 namespace abi::FunctionType {
 
+class TypeDefinitionReplacer;
+
 /// Best effort `CABIFunctionDefinition` to `RawFunctionDefinition` conversion.
 ///
 /// \note: this conversion is lossy since there's no way to represent some types
 ///        in `RawFunctionDefinition` in a reversible manner.
+///
+/// \param Replacer If not null, the replacement of \p Prototype with the new
+///        definition is scheduled here instead of being performed right away.
 model::UpcastableType
 convertToRaw(const model::CABIFunctionDefinition &Prototype,
-             TupleTree<model::Binary> &TheBinary);
+             TupleTree<model::Binary> &TheBinary,
+             TypeDefinitionReplacer *Replacer = nullptr);
 
 namespace ArgumentKind {
 
@@ -251,4 +259,32 @@ inline UsedRegisters usedRegisters(const model::UpcastableType &FunctionType) {
   return usedRegisters(FunctionType->toPrototype());
 }
 
+/// Memoizes the layouts and the used registers of prototypes.
+///
+/// Computing a `Layout` requires distributing all the arguments and the return
+/// value according to the ABI. Many functions and call sites usually share a
+/// handful of prototypes, so it's worth computing each layout only once.
+///
+/// Entries are keyed by the address of the prototype. Therefore, the cache must
+/// be cleared whenever the model it refers to is modified.
+///
+/// \note When the reads of the model are tracked (e.g., by pipes producing a
+///       target at a time), the cache has to be cleared before producing each
+///       target. Otherwise, the prototypes read to compute a cached entry will
+///       not be recorded as dependencies of the later targets.
+class LayoutCache {
+private:
+  std::map<const model::TypeDefinition *, Layout> Layouts;
+  std::map<const model::TypeDefinition *, UsedRegisters> Registers;
+
+public:
+  const Layout &layout(const model::TypeDefinition &Prototype);
+  const UsedRegisters &usedRegisters(const model::TypeDefinition &Prototype);
+
+  void clear() {
+    Layouts.clear();
+    Registers.clear();
+  }
+};
+
 } // namespace abi::FunctionType
@@ -5,6 +5,8 @@
 //
 
 #include <concepts>
+#include <map>
+#include <set>
 
 #include "llvm/Support/MathExtras.h"
 
@@ -42,6 +44,49 @@ inline void replaceTypeDefinition(const model::TypeDefinition::Key &O,
   return replaceTypeDefinition(O, llvm::cast<model::DefinedType>(N), B);
 }
 
+/// Collects replacements of type definitions, in order to apply all of them in
+/// a single visit of the model.
+///
+/// `replaceTypeDefinition` visits all the references in the model, therefore
+/// replacing each type definition separately is quadratic when converting all
+/// the prototypes in a binary.
+class TypeDefinitionReplacer {
+private:
+  std::map<model::DefinitionReference, model::DefinitionReference> Replacements;
+  std::set<model::TypeDefinition::Key> ToErase;
+
+public:
+  /// Schedule the replacement of all the references to the type definition
+  /// with \p Old key with \p New and the removal of the old definition.
+  ///
+  /// \note until `apply` is invoked, the old definition is left untouched.
+  void replace(const model::TypeDefinition::Key &Old,
+               const model::Type &New,
+               TupleTree<model::Binary> &Binary) {
+    const auto &NewDefinition = llvm::cast<model::DefinedType>(New);
+    auto OldReference = Binary->getDefinitionReference(Old);
+    Replacements[OldReference] = NewDefinition.Definition();
+    ToErase.insert(Old);
+  }
+
+  bool empty() const { return ToErase.empty(); }
+
+  /// Perform all the scheduled replacements
+  void apply(TupleTree<model::Binary> &Binary) {
+    if (empty())
+      return;
+
+    Binary.replaceReferences(Replacements);
+    llvm::erase_if(Binary->TypeDefinitions(),
+                   [this](model::UpcastableTypeDefinition &Definition) {
+                     return ToErase.contains(Definition->key());
+                   });
+
+    Replacements.clear();
+    ToErase.clear();
+  }
+};
+
 /// Takes care of extending (padding) the size of a stack argument.
 ///
 /// \note This only accounts for the post-padding (extension).
@@ -36,7 +36,6 @@ private:
   const llvm::APInt *const End;
   bool ToLast;
   bool Done;
-  const llvm::APInt Max;
 
 public:
   ConstantRangeSetIterator(const llvm::APInt *Start, const llvm::APInt *End) :
@@ -142,7 +141,11 @@ public:
   }
 
   bool contains(const ConstantRangeSet &Other) const {
-    return intersectWith(Other) == Other;
+    // Other is contained if, whenever it's active, we're active too
+    auto IsCovered = [](const llvm::APInt &, bool Active, bool OtherActive) {
+      return Active or not OtherActive;
+    };
+    return walkBounds(Other, IsCovered);
   }
 
   bool operator==(const ConstantRangeSet &Other) const {
@@ -274,6 +277,46 @@ public:
   }
 
 private:
+  /// Visit, in ascending order, the bounds of this set and of \p Other,
+  /// along with the status of the two sets right after each bound
+  ///
+  /// Bounds shared by the two sets are visited once. The visit stops as soon
+  /// as \p Visitor returns false.
+  ///
+  /// \return false if the visit has been interrupted.
+  template<typename F>
+  bool walkBounds(const ConstantRangeSet &Other, F &&Visitor) const {
+    using namespace llvm;
+
+    const APInt *Left = Bounds.begin();
+    const APInt *LeftEnd = Bounds.end();
+    const APInt *Right = Other.Bounds.begin();
+    const APInt *RightEnd = Other.Bounds.end();
+
+    bool LeftActive = false;
+    bool RightActive = false;
+    while (Left != LeftEnd or Right != RightEnd) {
+      const APInt *Value = nullptr;
+      if (Right == RightEnd or (Left != LeftEnd and Left->ult(*Right))) {
+        Value = Left++;
+        LeftActive = not LeftActive;
+      } else if (Left == LeftEnd or Right->ult(*Left)) {
+        Value = Right++;
+        RightActive = not RightActive;
+      } else {
+        Value = Left++;
+        ++Right;
+        LeftActive = not LeftActive;
+        RightActive = not RightActive;
+      }
+
+      if (not Visitor(*Value, LeftActive, RightActive))
+        return false;
+    }
+
+    return true;
+  }
+
   template<bool And>
   ConstantRangeSet merge(const ConstantRangeSet &Other) const {
     using namespace llvm;
@@ -283,38 +326,36 @@ private:
     revng_assert(BitWidth == 0 or Other.BitWidth == 0
                  or BitWidth == Other.BitWidth);
 
-    bool LastOutput = false;
-    bool LeftActive = false;
-    bool RightActive = false;
-    auto ZipAPIntVector = zipmap_range<const APIntVector,
-                                       const APIntVector,
-                                       APIntVectorKeyContainer>;
-    for (auto &P : ZipAPIntVector(Bounds, Other.Bounds)) {
-      const llvm::APInt *Left = P.first;
-      const llvm::APInt *Right = P.second;
-
-      if (Left != nullptr) {
-        revng_assert(Left->getBitWidth() == ResultBitWidth);
-        LeftActive = not LeftActive;
-      }
+    // Handle the trivial cases without walking the bounds
+    auto WithResultBitWidth = [ResultBitWidth](ConstantRangeSet Set) {
+      Set.BitWidth = ResultBitWidth;
+      return Set;
+    };
 
-      if (Right != nullptr) {
-        revng_assert(Right->getBitWidth() == ResultBitWidth);
-        RightActive = not RightActive;
-      }
+    if (And ? (isEmptySet() or Other.isFullSet()) :
+              (isFullSet() or Other.isEmptySet()))
+      return WithResultBitWidth(*this);
 
-      const llvm::APInt *Value = P.first == nullptr ? P.second : P.first;
-      revng_assert(Value != nullptr);
+    if (And ? (Other.isEmptySet() or isFullSet()) :
+              (Other.isFullSet() or isEmptySet()))
+      return WithResultBitWidth(Other);
+
+    Result.Bounds.reserve(Bounds.size() + Other.Bounds.size());
+
+    bool LastOutput = false;
+    auto Combine = [&](const APInt &Value, bool LeftActive, bool RightActive) {
+      revng_assert(Value.getBitWidth() == ResultBitWidth);
 
       bool NewOutput = And ? (LeftActive and RightActive) :
                              (LeftActive or RightActive);
 
-      if (NewOutput != LastOutput) {
-        Result.Bounds.push_back(*Value);
-      }
+      if (NewOutput != LastOutput)
+        Result.Bounds.push_back(Value);
 
       LastOutput = NewOutput;
-    }
+      return true;
+    };
+    walkBounds(Other, Combine);
 
     return Result;
   }
@@ -1423,6 +1423,21 @@ public:
     return removeNode(findNode(NodePtr));
   }
 
+  /// Removes all the nodes \p Predicate holds for at once: unlike calling
+  /// `removeNode` for each of them, this is linear in the size of the graph.
+  template<typename PredicateType>
+  void removeNodesIf(PredicateType &&Predicate) {
+    auto ShouldRemove = [&Predicate](std::unique_ptr<NodeT> &Pointer) {
+      if (!Predicate(Pointer.get()))
+        return false;
+
+      if constexpr (StrictSpecializationOfMutableEdgeNode<Node>)
+        Pointer->disconnect();
+      return true;
+    };
+    Nodes.erase(llvm::remove_if(Nodes, ShouldRemove), Nodes.end());
+  }
+
 public:
   nodes_iterator insertNode(nodes_iterator Where,
                             std::unique_ptr<NodeT> &&Ptr) {
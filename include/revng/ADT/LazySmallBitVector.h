@@ -5,6 +5,7 @@
 //
 
 #include <algorithm>
+#include <bit>
 #include <climits>
 #include <cstdint>
 #include <cstring>
@@ -16,18 +17,10 @@
 
 // TODO: implement shrinking
 
-// TODO: implement using __builtin_clz if available
 /// Returns the minimum amount of bits required to represent \p Value
 template<typename T>
 inline unsigned requiredBits(T Value) {
-  unsigned Result = 0;
-
-  while (Value != 0) {
-    Result++;
-    Value = Value >> 1;
-  }
-
-  return Result;
+  return std::bit_width(static_cast<std::make_unsigned_t<T>>(Value));
 }
 
 template<typename T, typename A, typename B>
@@ -129,6 +122,26 @@ private:
       return Storage[Index];
     }
 
+    /// Unchecked access to the words, for the loops over whole ranges of them:
+    /// without the per-word assertion of at(), they can be vectorized
+    uintptr_t *words() { return Storage; }
+    const uintptr_t *words() const { return Storage; }
+
+    /// \return true if all the words starting from \p From are zero
+    bool isZero(size_t From = 0) const {
+      uintptr_t Any = 0;
+      for (size_t I = From; I < wordCount(); I++)
+        Any |= Storage[I];
+      return Any == 0;
+    }
+
+    unsigned count() const {
+      unsigned Result = 0;
+      for (size_t I = 0; I < wordCount(); I++)
+        Result += std::popcount(Storage[I]);
+      return Result;
+    }
+
     void zero(size_t From, size_t Count) {
       revng_assert(From + Count <= wordCount());
       memset(&at(From), 0, Count * sizeof(uintptr_t));
@@ -261,7 +274,20 @@ public:
     }
   }
 
-  bool isZero() const { return requiredBits() == 0; }
+  bool isZero() const {
+    if (isSmall())
+      return getSmall() == 0;
+    else
+      return getLarge().isZero();
+  }
+
+  /// \return the number of bits set
+  unsigned count() const {
+    if (isSmall())
+      return std::popcount(getSmall());
+    else
+      return getLarge().count();
+  }
 
   LazySmallBitVector &operator=(const LazySmallBitVector &Other) {
     if (!(Other.isSmall() || Other.capacity() > 63))
@@ -304,36 +330,27 @@ public:
       unsigned Max = std::min(ThisLarge.capacity(), OtherLarge.capacity());
       Max /= BitsPerPointer;
 
-      for (unsigned I = 0; I < Max; I++)
-        if (ThisLarge.at(I) != OtherLarge.at(I))
-          return false;
+      size_t CommonSize = Max * sizeof(uintptr_t);
+      if (memcmp(ThisLarge.words(), OtherLarge.words(), CommonSize) != 0)
+        return false;
 
-      if (ThisLarge.capacity() > OtherLarge.capacity()) {
-        for (unsigned I = Max; I < ThisLarge.wordCount(); I++)
-          if (ThisLarge.at(I) != 0)
-            return false;
-      } else {
-        for (unsigned I = Max; I < OtherLarge.wordCount(); I++)
-          if (OtherLarge.at(I) != 0)
-            return false;
-      }
+      if (ThisLarge.capacity() > OtherLarge.capacity())
+        return ThisLarge.isZero(Max);
+      else
+        return OtherLarge.isZero(Max);
 
     } else if (!isSmall() && Other.isSmall()) {
       const LargeStorage &ThisLarge = getLarge();
       if (ThisLarge.at(0) != Other.getSmall())
         return false;
 
-      for (unsigned I = 1; I < ThisLarge.wordCount(); I++)
-        if (ThisLarge.at(I) != 0)
-          return false;
+      return ThisLarge.isZero(1);
     } else if (isSmall() && !Other.isSmall()) {
       const LargeStorage &OtherLarge = Other.getLarge();
       if (OtherLarge.at(0) != getSmall())
         return false;
 
-      for (unsigned I = 1; I < OtherLarge.wordCount(); I++)
-        if (OtherLarge.at(I) != 0)
-          return false;
+      return OtherLarge.isZero(1);
     }
 
     return true;
@@ -406,8 +423,10 @@ public:
 
       unsigned Max = std::min(ThisLarge.capacity(), OtherLarge.capacity());
       Max /= BitsPerPointer;
+      uintptr_t *Destination = ThisLarge.words();
+      const uintptr_t *Source = OtherLarge.words();
       for (unsigned I = 0; I < Max; I++)
-        ThisLarge.at(I) = ThisLarge.at(I) ^ OtherLarge.at(I);
+        Destination[I] ^= Source[I];
 
     } else if (!isSmall() && Other.isSmall()) {
       LargeStorage &ThisLarge = getLarge();
@@ -435,8 +454,10 @@ public:
       unsigned Max = std::min(ThisLarge.capacity(), OtherLarge.capacity());
       Max /= BitsPerPointer;
 
+      uintptr_t *Destination = ThisLarge.words();
+      const uintptr_t *Source = OtherLarge.words();
       for (unsigned I = 0; I < Max; I++)
-        ThisLarge.at(I) = ThisLarge.at(I) | OtherLarge.at(I);
+        Destination[I] |= Source[I];
 
     } else if (!isSmall() && Other.isSmall()) {
       LargeStorage &ThisLarge = getLarge();
@@ -478,8 +499,10 @@ public:
         }
 
         unsigned Max = std::min(OtherPointersCount, ThisPointersCount);
+        uintptr_t *Destination = Large.words();
+        const uintptr_t *Source = OtherLarge.words();
         for (unsigned I = 0; I < Max; I++)
-          Large.at(I) = Large.at(I) & OtherLarge.at(I);
+          Destination[I] &= Source[I];
       }
     }
 
@@ -588,11 +611,14 @@ public:
   /// \return 0 if no bits are set after \p StartIndex, the 1-based index of the
   ///         next bit set otherwise
   unsigned findNext(unsigned StartIndex) const {
-    if (StartIndex >= requiredBits())
+    // Note: computing requiredBits() upfront would scan the whole storage for
+    //       each bit visited by an iterator
+    if (StartIndex >= capacity())
       return 0;
 
     if (isSmall()) {
-      return StartIndex + findFirstBit(getSmall() >> StartIndex);
+      uintptr_t Value = getSmall() >> StartIndex;
+      return Value == 0 ? 0 : StartIndex + findFirstBit(Value);
     } else {
       const LargeStorage &Large = getLarge();
       unsigned Index = StartIndex / BitsPerPointer;
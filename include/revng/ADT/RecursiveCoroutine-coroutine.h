@@ -9,6 +9,7 @@
 #include <type_traits>
 #include <utility>
 
+#include "revng/ADT/RecyclingAllocated.h"
 #include "revng/Support/Assert.h"
 
 template<typename>
@@ -50,6 +51,19 @@ struct RecursivePromise : public ReturnBase<ReturnT> {
   template<typename>
   friend struct RecursivePromise;
 
+  // Each level of the recursion allocates a coroutine frame and usually frees
+  // it shortly after: serve them from the recycling free lists rather than
+  // going to the system allocator every time.
+  // Since get_return_object_on_allocation_failure is declared, the allocation
+  // function has to be noexcept.
+  static void *operator new(size_t Size) noexcept {
+    return revng::detail::RecyclingFreeLists::allocate(Size);
+  }
+
+  static void operator delete(void *Pointer, size_t Size) {
+    revng::detail::RecyclingFreeLists::deallocate(Pointer, Size);
+  }
+
   RecursiveCoroutine<ReturnT> get_return_object() {
     return RecursiveCoroutine<ReturnT>(coro_handle::from_promise(*this));
   }
@@ -0,0 +1,130 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <array>
+#include <cstddef>
+#include <new>
+
+namespace revng::detail {
+
+/// Per-thread free lists of small memory blocks, bucketed by size
+///
+/// Blocks that are released are not returned to the system allocator, but are
+/// kept around to serve the next allocations of the same size class, up to a
+/// certain amount of memory per size class.
+class RecyclingFreeLists {
+private:
+  static constexpr size_t Granularity = alignof(std::max_align_t);
+  static constexpr size_t MaxBlockSize = 512;
+  static constexpr size_t ClassesCount = MaxBlockSize / Granularity;
+  static constexpr size_t MaxCachedBytesPerClass = 1024 * 1024;
+
+  struct FreeBlock {
+    FreeBlock *Next = nullptr;
+  };
+
+private:
+  std::array<FreeBlock *, ClassesCount> Heads = {};
+  std::array<size_t, ClassesCount> Counts = {};
+
+  /// Set once the instance of the current thread has been destroyed: blocks
+  /// released after that (e.g., by thread-local objects destroyed later) go
+  /// directly to the system allocator
+  static inline thread_local bool Destroyed = false;
+
+public:
+  RecyclingFreeLists() = default;
+  RecyclingFreeLists(const RecyclingFreeLists &) = delete;
+  RecyclingFreeLists &operator=(const RecyclingFreeLists &) = delete;
+
+  ~RecyclingFreeLists() {
+    for (FreeBlock *Head : Heads) {
+      while (Head != nullptr) {
+        FreeBlock *Next = Head->Next;
+        ::operator delete(Head);
+        Head = Next;
+      }
+    }
+
+    Destroyed = true;
+  }
+
+public:
+  static void *allocate(size_t Size) {
+    if (Size > MaxBlockSize or Destroyed)
+      return ::operator new(Size);
+
+    return get().allocateImpl(Size);
+  }
+
+  static void deallocate(void *Pointer, size_t Size) {
+    if (Size > MaxBlockSize or Destroyed) {
+      ::operator delete(Pointer);
+      return;
+    }
+
+    get().deallocateImpl(Pointer, Size);
+  }
+
+private:
+  static RecyclingFreeLists &get() {
+    static thread_local RecyclingFreeLists Instance;
+    return Instance;
+  }
+
+  static size_t classIndex(size_t Size) {
+    return Size == 0 ? 0 : (Size - 1) / Granularity;
+  }
+
+  static size_t classSize(size_t Index) { return (Index + 1) * Granularity; }
+
+  void *allocateImpl(size_t Size) {
+    size_t Index = classIndex(Size);
+    if (FreeBlock *Head = Heads[Index]; Head != nullptr) {
+      Heads[Index] = Head->Next;
+      --Counts[Index];
+      return Head;
+    }
+
+    // Always allocate the whole size class, so that a block can serve any
+    // request in the same class
+    return ::operator new(classSize(Index));
+  }
+
+  void deallocateImpl(void *Pointer, size_t Size) {
+    size_t Index = classIndex(Size);
+    if (Counts[Index] * classSize(Index) >= MaxCachedBytesPerClass) {
+      ::operator delete(Pointer);
+      return;
+    }
+
+    auto *Block = new (Pointer) FreeBlock{ Heads[Index] };
+    Heads[Index] = Block;
+    ++Counts[Index];
+  }
+};
+
+} // namespace revng::detail
+
+/// Inherit from this class to have instances allocated through per-thread
+/// recycling free lists instead of going to the system allocator every time
+///
+/// This is meant for small objects that are created and destroyed in large
+/// numbers, such as the nodes of a GenericGraph that is built and thrown away
+/// for each function: since the payload of a node is one of its bases, it's
+/// enough to inherit from this class in the payload.
+///
+/// \note objects must be destroyed through a pointer to their actual type (or
+///       a base with a virtual destructor), so that the correct size is known.
+struct RecyclingAllocated {
+  static void *operator new(size_t Size) {
+    return revng::detail::RecyclingFreeLists::allocate(Size);
+  }
+
+  static void operator delete(void *Pointer, size_t Size) {
+    revng::detail::RecyclingFreeLists::deallocate(Pointer, Size);
+  }
+};
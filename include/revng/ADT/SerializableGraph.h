@@ -172,6 +172,14 @@ toSerializable(const G &Graph) {
   return Result;
 }
 
+/// Parse a graph serialized with `serializeBinary`, which is much more compact
+/// and cheaper to decode than YAML, see BinarySerialization.h
+template<typename SerializableGraphType>
+llvm::Expected<SerializableGraphType>
+serializableGraphFromBinary(llvm::StringRef Buffer) {
+  return revng::detail::fromBinaryImpl<SerializableGraphType>(Buffer);
+}
+
 //
 // Make `struct Empty` serialiazible
 //
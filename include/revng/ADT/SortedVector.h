@@ -207,6 +207,11 @@ public:
 
     T Value{ std::forward<Types>(Values)... };
     auto Key = KeyedObjectTraits<T>::key(Value);
+    if (appendsInOrder(Key)) {
+      TheVector.emplace_back(std::move(Value));
+      return { --end(), true };
+    }
+
     auto It = lower_bound(Key);
     if (It == end()) {
       TheVector.emplace_back(std::move(Value));
@@ -228,6 +233,11 @@ public:
 
     T Value{ std::forward<Types>(Values)... };
     auto Key = KeyedObjectTraits<T>::key(Value);
+    if (appendsInOrder(Key)) {
+      TheVector.emplace_back(std::move(Value));
+      return { --end(), true };
+    }
+
     auto It = lower_bound(Key);
     if (It == end()) {
       TheVector.emplace_back(std::move(Value));
@@ -322,8 +332,13 @@ public:
   private:
     SortedVector *SV = nullptr;
 
+    /// Number of elements in the vector when the batch started: these are
+    /// already sorted, only the ones inserted after them need sorting
+    size_type SortedPrefix = 0;
+
   public:
-    BatchInserterBase(SortedVector &SV) : SV(&SV) {
+    BatchInserterBase(SortedVector &SV) :
+      SV(&SV), SortedPrefix(SV.TheVector.size()) {
       revng_assert(not SV.BatchInsertInProgress);
       SV.BatchInsertInProgress = true;
     }
@@ -333,11 +348,13 @@ public:
 
     BatchInserterBase(BatchInserterBase &&Other) {
       SV = Other.SV;
+      SortedPrefix = Other.SortedPrefix;
       Other.SV = nullptr;
     }
 
     BatchInserterBase &operator=(BatchInserterBase &&Other) {
       SV = Other.SV;
+      SortedPrefix = Other.SortedPrefix;
       Other.SV = nullptr;
     }
 
@@ -346,10 +363,15 @@ public:
     void commit() {
       if (SV != nullptr && SV->BatchInsertInProgress) {
         SV->BatchInsertInProgress = false;
-        SV->sort<EnsureUnique>();
+        SV->sort<EnsureUnique>(SortedPrefix);
       }
     }
 
+    void reserve(size_type Count) {
+      revng_assert(SV->BatchInsertInProgress);
+      SV->TheVector.reserve(SV->TheVector.size() + Count);
+    }
+
   protected:
     template<typename... Types>
     T &emplaceImpl(Types &&...Values) {
@@ -430,14 +452,33 @@ private:
     return not compareKeys(LHS, RHS) and not compareKeys(RHS, LHS);
   }
 
+  /// \return true if an element with key \p Key belongs at the end of the
+  ///         vector, which is the common case when filling it in order
+  bool appendsInOrder(const key_type &Key) const {
+    return TheVector.empty()
+           or compareKeys(KeyedObjectTraits<T>::key(TheVector.back()), Key);
+  }
+
+  /// Sort the vector, assuming its first \p SortedPrefix elements are already
+  /// sorted and unique: only the rest is sorted, then the two are merged
   template<bool EnsureUnique>
-  void sort() {
+  void sort(size_type SortedPrefix = 0) {
+    auto Middle = std::next(begin(), SortedPrefix);
+
+    // stable_sort and inplace_merge preserve the insertion order of elements
+    // with the same key, which unique_last relies upon to keep the last one
+    if (not std::is_sorted(Middle, end(), compareElements))
+      std::stable_sort(Middle, end(), compareElements);
+
+    if (Middle != begin() and Middle != end()
+        and compareElements(*Middle, *std::prev(Middle))) {
+      std::inplace_merge(begin(), Middle, end(), compareElements);
+    }
+
     if constexpr (EnsureUnique) {
-      std::sort(begin(), end(), compareElements);
       revng_check(std::adjacent_find(begin(), end(), elementsEqual) == end(),
                   "Multiples of the same element in a `SortedVector`.");
     } else {
-      std::stable_sort(begin(), end(), compareElements);
       auto NewEnd = unique_last(begin(), end(), elementsEqual);
       TheVector.erase(NewEnd, end());
     }
@@ -66,25 +66,53 @@ public:
 public:
   static constexpr bool KeyedObjectContainerTag = true;
 
+private:
+  static constexpr bool HasRandomAccess = std::random_access_iterator<
+    typename T::const_iterator>;
+
+  /// Accessed elements that exist, accumulated between two pushes
+  ///
+  /// When elements can be indexed cheaply, this is a bit per element, sized
+  /// upon the first access, so that containers that are never accessed cost
+  /// nothing. Otherwise, computing an index would be linear, so keys are
+  /// recorded as they are accessed and deduplicated by `getTrackingResult`.
+  using ExistingSet = std::conditional_t<HasRandomAccess,
+                                         llvm::BitVector,
+                                         std::vector<std::remove_const_t<
+                                           key_type>>>;
+
 private:
   T Content;
   mutable AccessTracker Exact = AccessTracker(false);
   mutable std::vector<TrackingSet> NonExisting;
-  mutable std::vector<llvm::BitVector> Existing;
+  mutable std::vector<ExistingSet> Existing;
 
   mutable bool TrackingIsActive = false;
+  mutable bool TrackingIsPaused = false;
 
 public:
   /// \defgroup Methods related to tracking
   /// @{
 
   void stopTracking() const { TrackingIsActive = false; }
+
+  void pauseTracking() const {
+    TrackingIsPaused = TrackingIsActive;
+    TrackingIsActive = false;
+    Exact.pauseTracking();
+  }
+
+  void resumeTracking() const {
+    TrackingIsActive = TrackingIsPaused;
+    TrackingIsPaused = false;
+    Exact.resumeTracking();
+  }
   void clearTracking() const {
     Exact.clear();
-    NonExisting = {};
-    NonExisting.push_back(TrackingSet());
-    Existing = {};
-    Existing.push_back(llvm::BitVector(Content.size()));
+    NonExisting.clear();
+    NonExisting.emplace_back();
+    Existing.clear();
+    Existing.emplace_back();
     TrackingIsActive = true;
   }
 
@@ -104,19 +132,19 @@ public:
   }
 
   void trackingPush() const {
-    Existing.push_back(llvm::BitVector(Content.size()));
-    NonExisting.push_back(TrackingSet());
+    Existing.emplace_back();
+    NonExisting.emplace_back();
     Exact.push();
   }
 
   void trackingPop() const {
     Existing.pop_back();
     if (Existing.empty())
-      Existing.push_back(llvm::BitVector(Content.size()));
+      Existing.emplace_back();
 
     NonExisting.pop_back();
     if (NonExisting.empty())
-      NonExisting.push_back(TrackingSet());
+      NonExisting.emplace_back();
 
     Exact.pop();
   }
@@ -213,8 +241,10 @@ public:
 #ifdef TUPLE_TREE_GENERATOR_EMIT_TRACKING_DEBUG
     onFieldAccess("at", name());
 #endif
-    markExistingKey(Key);
-    return Content.at(Key);
+    auto Iter = Content.find(Key);
+    revng_assert(Iter != Content.end());
+    markExisting(Iter);
+    return *Iter;
   }
 
   value_type &operator[](const key_type &Key) { return Content[Key]; }
@@ -306,31 +336,22 @@ public:
 #ifdef TUPLE_TREE_GENERATOR_EMIT_TRACKING_DEBUG
     onFieldAccess("count", name());
 #endif
-    auto Quantity = Content.count(Key);
-
-    if (not TrackingIsActive)
-      return Quantity;
-
-    if (Quantity == 0) {
-      NonExisting.back().insert(Key);
-    } else {
-      markExistingKey(Key);
-    }
-    return Quantity;
-  }
-
-  bool contains(const key_type &Key) const { return count(Key) != 0; }
-
-  value_type *tryGet(const key_type &Key) {
     auto Iter = Content.find(Key);
     if (Iter == Content.end()) {
       if (TrackingIsActive)
         NonExisting.back().insert(Key);
-      return nullptr;
+      return 0;
     }
 
-    markExistingKey(Key);
-    return &*Iter;
+    markExisting(Iter);
+    return 1;
+  }
+
+  bool contains(const key_type &Key) const { return count(Key) != 0; }
+
+  value_type *tryGet(const key_type &Key) {
+    const auto &Self = *this;
+    return const_cast<value_type *>(Self.tryGet(Key));
   }
 
   const value_type *tryGet(const key_type &Key) const {
@@ -344,7 +365,7 @@ public:
       return nullptr;
     }
 
-    markExistingKey(Key);
+    markExisting(Iter);
     return &*Iter;
   }
 
@@ -410,14 +431,23 @@ public:
   }
 
 private:
-  void markExistingKey(const key_type &Key) const {
+  void markExisting(const_iterator Iter) const {
     if (not TrackingIsActive)
       return;
-    auto Iter = Content.find(Key);
-    revng_assert(Iter != Content.end());
-    revng_assert(Existing.back().size() == Content.size());
 
-    Existing.back()[std::distance(Content.begin(), Iter)] = true;
+    ExistingSet &Set = Existing.back();
+    if constexpr (HasRandomAccess) {
+      if (Set.empty())
+        Set.resize(Content.size());
+      revng_assert(Set.size() == Content.size());
+      Set.set(std::distance(Content.begin(), Iter));
+    } else {
+      // Consecutive accesses to the same key are extremely common (e.g., a
+      // `contains` followed by an `at`), don't record them twice
+      auto Key = KeyedObjectTraits<value_type>::key(*Iter);
+      if (Set.empty() or Set.back() != Key)
+        Set.push_back(Key);
+    }
   }
 
   TrackingSet getNonExistingRequestedKeys() const {
@@ -430,13 +460,17 @@ private:
 
   TrackingSet getExistingRequestedKeys() const {
     TrackingSet Set;
-    for (auto &BitVector : Existing) {
-      revng_assert(Content.size() == BitVector.size());
-      for (size_t I = 0; I < Content.size(); I++) {
-        if (not BitVector[I])
+    for (const ExistingSet &Accessed : Existing) {
+      if constexpr (HasRandomAccess) {
+        if (Accessed.empty())
           continue;
+
+        revng_assert(Content.size() == Accessed.size());
         using KOT = KeyedObjectTraits<value_type>;
-        Set.insert(KOT::key(*std::next(Content.begin(), I)));
+        for (unsigned I : Accessed.set_bits())
+          Set.insert(KOT::key(*std::next(Content.begin(), I)));
+      } else {
+        Set.insert(Accessed.begin(), Accessed.end());
       }
     }
 
@@ -4,8 +4,10 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <array>
 #include <memory>
 #include <type_traits>
+#include <utility>
 
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Casting.h"
@@ -52,6 +54,111 @@ concept UpcastablePointerLike = Dereferenceable<T> and Upcastable<pointee<T>>;
 template<typename T>
 concept NotUpcastablePointerLike = not UpcastablePointerLike<T>;
 
+namespace detail {
+
+template<typename T>
+using KindOf = std::decay_t<decltype(std::declval<T &>().Kind())>;
+
+/// \p Concrete is either \p Base itself, which matches any kind, or it
+/// matches exactly the objects whose kind is `Concrete::AssociatedKind`
+template<typename Base, typename Concrete>
+concept KindMatchable = std::is_same_v<std::remove_const_t<Base>,
+                                       std::remove_const_t<Concrete>>
+                        or requires {
+                             {
+                               Concrete::AssociatedKind
+                             } -> std::convertible_to<KindOf<Base>>;
+                           };
+
+template<typename Base, typename Tuple>
+inline constexpr bool AllKindMatchable = false;
+
+template<typename Base, typename... Ts>
+inline constexpr bool
+  AllKindMatchable<Base, std::tuple<Ts...>> = (KindMatchable<Base, Ts> and ...);
+
+} // namespace detail
+
+/// An Upcastable hierarchy whose objects carry their kind, a dense
+/// enumeration terminated by `Count`, such as the hierarchies emitted by
+/// tuple_tree_generator
+///
+/// Upcasting an object of such a hierarchy doesn't need to try each concrete
+/// type in turn: the kind is mapped to the concrete type through a table
+/// computed at compile time and the callable is invoked through a table of
+/// thunks, i.e., with a single indirect jump.
+template<typename T>
+concept KindDispatchable = Upcastable<T> and requires(T &Object) {
+  { Object.Kind() };
+  detail::KindOf<T>::Count;
+} and detail::AllKindMatchable<T, concrete_types_traits_t<T>>;
+
+namespace detail {
+
+/// \return a table mapping each kind to the index of the first concrete type
+///         of \p T matching it, or -1
+template<KindDispatchable T>
+constexpr auto makeKindToIndexTable() {
+  using concrete_types = concrete_types_traits_t<T>;
+  constexpr size_t KindsCount = static_cast<size_t>(KindOf<T>::Count);
+
+  std::array<int, KindsCount> Result;
+  Result.fill(-1);
+
+  auto Record = [&Result]<size_t I>(std::integral_constant<size_t, I>) {
+    using type = std::tuple_element_t<I, concrete_types>;
+    for (size_t Kind = 0; Kind < KindsCount; ++Kind) {
+      if (Result[Kind] != -1)
+        continue;
+
+      if constexpr (std::is_same_v<std::remove_const_t<T>,
+                                   std::remove_const_t<type>>)
+        Result[Kind] = I;
+      else if (static_cast<size_t>(type::AssociatedKind) == Kind)
+        Result[Kind] = I;
+    }
+  };
+
+  [&]<size_t... I>(std::index_sequence<I...>) {
+    (Record(std::integral_constant<size_t, I>()), ...);
+  }(std::make_index_sequence<std::tuple_size_v<concrete_types>>());
+
+  return Result;
+}
+
+template<KindDispatchable T>
+inline constexpr auto KindToIndex = makeKindToIndexTable<T>();
+
+template<typename ReturnT, typename L, KindDispatchable T, size_t... I>
+ReturnT dispatchOnKind(T *Pointer,
+                       const L &Callable,
+                       std::index_sequence<I...>) {
+  using concrete_types = concrete_types_traits_t<T>;
+  using Thunk = ReturnT (*)(T *, const L &);
+  static constexpr Thunk Thunks[] = {
+    [](T *Pointer, const L &Callable) -> ReturnT {
+      using type = std::tuple_element_t<I, concrete_types>;
+      return Callable(*static_cast<type *>(Pointer));
+    }...
+  };
+
+  auto Kind = static_cast<size_t>(Pointer->Kind());
+  revng_assert(Kind < KindToIndex<T>.size());
+  int Index = KindToIndex<T>[Kind];
+  revng_assert(Index != -1);
+  return Thunks[Index](Pointer, Callable);
+}
+
+template<typename ReturnT, typename L, KindDispatchable T>
+ReturnT dispatchOnKind(T *Pointer, const L &Callable) {
+  constexpr size_t Size = std::tuple_size_v<concrete_types_traits_t<T>>;
+  return dispatchOnKind<ReturnT>(Pointer,
+                                 Callable,
+                                 std::make_index_sequence<Size>());
+}
+
+} // namespace detail
+
 template<typename ReturnT, typename L, UpcastablePointerLike P, size_t I = 0>
   requires(not std::is_void_v<ReturnT>)
 ReturnT upcast(P &&Upcastable, const L &Callable, ReturnT &&IfNull) {
@@ -61,7 +168,9 @@ ReturnT upcast(P &&Upcastable, const L &Callable, ReturnT &&IfNull) {
   if (Pointer == nullptr)
     return std::forward<ReturnT>(IfNull);
 
-  if constexpr (I < std::tuple_size_v<concrete_types>) {
+  if constexpr (KindDispatchable<pointee>) {
+    return detail::dispatchOnKind<ReturnT>(Pointer, Callable);
+  } else if constexpr (I < std::tuple_size_v<concrete_types>) {
     using type = std::tuple_element_t<I, concrete_types>;
     if (auto *Upcasted = llvm::dyn_cast<type>(Pointer)) {
       return Callable(*Upcasted);
@@ -83,7 +192,10 @@ llvm::Error upcast(P &&Upcastable, const L &Callable, llvm::Error IfNull) {
   if (Pointer == nullptr)
     return IfNull;
 
-  if constexpr (I < std::tuple_size_v<concrete_types>) {
+  if constexpr (KindDispatchable<pointee>) {
+    llvm::consumeError(std::move(IfNull));
+    return detail::dispatchOnKind<llvm::Error>(Pointer, Callable);
+  } else if constexpr (I < std::tuple_size_v<concrete_types>) {
     using type = std::tuple_element_t<I, concrete_types>;
     if (auto *Upcasted = llvm::dyn_cast<type>(Pointer)) {
       llvm::consumeError(std::move(IfNull));
@@ -4,6 +4,8 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <algorithm>
+#include <concepts>
 #include <iterator>
 #include <set>
 #include <tuple>
@@ -94,10 +96,13 @@ template<typename LeftMap, typename RightMap>
 struct DefaultComparator {
   template<typename T, typename Q>
   static int compare(const T &LHS, const Q &RHS) {
-    auto LHSKey = keyFromValue<LeftMap>(LHS);
-    auto RHSKey = keyFromValue<RightMap>(RHS);
-    static_assert(std::is_same_v<decltype(LHSKey), decltype(RHSKey)>);
-    auto Less = std::less<decltype(LHSKey)>();
+    // Bind the keys by reference: if keyFromValue returns a reference to the
+    // key stored in the element, no copy (and no allocation) is made
+    const auto &LHSKey = keyFromValue<LeftMap>(LHS);
+    const auto &RHSKey = keyFromValue<RightMap>(RHS);
+    using KeyType = std::decay_t<decltype(LHSKey)>;
+    static_assert(std::is_same_v<KeyType, std::decay_t<decltype(RHSKey)>>);
+    auto Less = std::less<KeyType>();
     if (Less(LHSKey, RHSKey))
       return -1;
     else if (Less(RHSKey, LHSKey))
@@ -136,6 +141,16 @@ public:
   using value_type = zipmap_pair<LeftMap, RightMap>;
   using reference = typename ZipMapIterator::reference;
 
+private:
+  /// After this many consecutive elements present on one side only, look for
+  /// the end of the run through a galloping search
+  static constexpr unsigned GallopThreshold = 4;
+
+  static constexpr bool CanGallop = std::random_access_iterator<
+                                      left_inner_iterator>
+                                    and std::random_access_iterator<
+                                      right_inner_iterator>;
+
 private:
   value_type Current;
   left_inner_iterator LeftIt;
@@ -143,6 +158,15 @@ private:
   right_inner_iterator RightIt;
   const right_inner_iterator EndRightIt;
 
+  /// Number of upcoming elements known to be present only on the left (or
+  /// right) side, which can be emitted without comparing them
+  size_t LeftRun = 0;
+  size_t RightRun = 0;
+
+  /// Number of consecutive elements emitted from one side only, positive for
+  /// the left side and negative for the right one
+  int Streak = 0;
+
 public:
   ZipMapIterator(left_inner_range LeftRange, right_inner_range RightRange) :
     LeftIt(LeftRange.begin()),
@@ -176,23 +200,81 @@ private:
   bool leftIsValid() const { return LeftIt != EndLeftIt; }
   bool rightIsValid() const { return RightIt != EndRightIt; }
 
+  /// \return the length of the prefix of [\p Begin, \p End) whose elements
+  ///         satisfy \p IsBefore, which must hold for a prefix of the range,
+  ///         in a logarithmic number of evaluations of \p IsBefore.
+  template<typename Iterator, typename Predicate>
+  static size_t gallop(Iterator Begin, Iterator End, Predicate IsBefore) {
+    size_t Size = End - Begin;
+    size_t Bound = 1;
+    while (Bound <= Size and IsBefore(Begin[Bound - 1]))
+      Bound *= 2;
+
+    size_t Low = Bound / 2;
+    size_t High = std::min(Bound - 1, Size);
+    return std::partition_point(Begin + Low, Begin + High, IsBefore) - Begin;
+  }
+
+  void emitLeft() {
+    Current = std::make_pair(&*LeftIt, nullptr);
+    LeftIt++;
+  }
+
+  void emitRight() {
+    Current = std::make_pair(nullptr, &*RightIt);
+    RightIt++;
+  }
+
   void next() {
+    if (LeftRun != 0) {
+      --LeftRun;
+      emitLeft();
+      return;
+    }
+
+    if (RightRun != 0) {
+      --RightRun;
+      emitRight();
+      return;
+    }
+
     if (leftIsValid() and rightIsValid()) {
       switch (Comparator::compare(*LeftIt, *RightIt)) {
       case 0:
         Current = decltype(Current)(&*LeftIt, &*RightIt);
         LeftIt++;
         RightIt++;
+        Streak = 0;
         break;
 
       case -1:
-        Current = std::make_pair(&*LeftIt, nullptr);
-        LeftIt++;
+        emitLeft();
+        Streak = Streak > 0 ? Streak + 1 : 1;
+        if constexpr (CanGallop) {
+          if (Streak >= static_cast<int>(GallopThreshold)) {
+            const auto &Right = *RightIt;
+            auto IsBefore = [&Right](const auto &Left) {
+              return Comparator::compare(Left, Right) < 0;
+            };
+            LeftRun = gallop(LeftIt, EndLeftIt, IsBefore);
+            Streak = 0;
+          }
+        }
         break;
 
       case 1:
-        Current = std::make_pair(nullptr, &*RightIt);
-        RightIt++;
+        emitRight();
+        Streak = Streak < 0 ? Streak - 1 : -1;
+        if constexpr (CanGallop) {
+          if (-Streak >= static_cast<int>(GallopThreshold)) {
+            const auto &Left = *LeftIt;
+            auto IsBefore = [&Left](const auto &Right) {
+              return Comparator::compare(Left, Right) > 0;
+            };
+            RightRun = gallop(RightIt, EndRightIt, IsBefore);
+            Streak = 0;
+          }
+        }
         break;
 
       default:
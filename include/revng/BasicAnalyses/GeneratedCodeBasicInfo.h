@@ -9,6 +9,9 @@
 #include <utility>
 
 #include "llvm/ADT/Any.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/DepthFirstIterator.h"
 #include "llvm/IR/Dominators.h"
 #include "llvm/IR/GlobalObject.h"
@@ -63,18 +66,30 @@ public:
 
   /// Handle the invalidation of this information, so that it does not get
   /// invalidated by other passes.
+  ///
+  /// The information about the CSVs never changes. The index of the blocks of
+  /// `root` is dropped (and lazily rebuilt) only if the CFG is not preserved.
   bool invalidate(llvm::Module &,
-                  const llvm::PreservedAnalyses &,
+                  const llvm::PreservedAnalyses &PA,
                   llvm::ModuleAnalysisManager::Invalidator &) {
+    if (not PA.allAnalysesInSetPreserved<llvm::CFGAnalyses>())
+      invalidateRootIndex();
     return false;
   }
 
-  bool invalidate(llvm::Function &,
-                  const llvm::PreservedAnalyses &,
+  bool invalidate(llvm::Function &F,
+                  const llvm::PreservedAnalyses &PA,
                   llvm::FunctionAnalysisManager::Invalidator &) {
+    if (&F == RootFunction
+        and not PA.allAnalysesInSetPreserved<llvm::CFGAnalyses>())
+      invalidateRootIndex();
     return false;
   }
 
+  /// Drop the index of the blocks of `root`, to be called by passes that
+  /// change the basic blocks of `root` while keeping this object around
+  void invalidateRootIndex();
+
   static uint32_t getJTReasons(llvm::BasicBlock *BB) {
     return getJTReasons(BB->getTerminator());
   }
@@ -236,9 +251,41 @@ public:
             or Type == BlockType::JumpTargetBlock);
   }
 
+  /// Return the type of \p BB, see BlockType
+  ///
+  /// Same as getType, but served from the index for the blocks of `root`.
+  BlockType::Values getBlockType(const llvm::BasicBlock *BB) {
+    if (const BlockInfo *Info = getBlockInfo(BB))
+      return Info->Type;
+    return getType(BB);
+  }
+
+  /// Return the jump target whose code generated \p BB
+  ///
+  /// Same as the free function getJumpTargetBlock, but served from the index
+  /// for the blocks of `root`.
+  const llvm::BasicBlock *getJumpTargetBlock(const llvm::BasicBlock *BB) {
+    if (const BlockInfo *Info = getBlockInfo(BB))
+      if (Info->JumpTarget != nullptr)
+        return Info->JumpTarget;
+    return ::getJumpTargetBlock(BB);
+  }
+
   /// Return the program counter of the next (i.e., fallthrough) instruction
   /// of \p TheInstruction
-  MetaAddress getNextPC(llvm::Instruction *TheInstruction) const {
+  MetaAddress getNextPC(llvm::Instruction *TheInstruction) {
+    // Terminators are the most common query: the last newpc of their block
+    // is in the index
+    if (TheInstruction->isTerminator()) {
+      const BlockInfo *Info = getBlockInfo(TheInstruction->getParent());
+      if (Info != nullptr and Info->LastNewPC != nullptr) {
+        using namespace NewPCArguments;
+        llvm::CallInst *Call = Info->LastNewPC;
+        MetaAddress PC = blockIDFromNewPC(Call).start();
+        return PC + getLimitedValue(Call->getArgOperand(InstructionSize));
+      }
+    }
+
     auto Pair = getPC(TheInstruction);
     return Pair.first + Pair.second;
   }
@@ -294,10 +341,17 @@ public:
     return ABIRegisters;
   }
 
-  bool isABIRegister(llvm::GlobalVariable *CSV) const {
+  bool isABIRegister(const llvm::GlobalVariable *CSV) const {
     return ABIRegistersSet.contains(CSV);
   }
 
+  /// Check if \p V is a CSV
+  bool isCSV(const llvm::Value *V) const {
+    if (auto *GV = llvm::dyn_cast<const llvm::GlobalVariable>(V))
+      return CSVsSet.contains(GV);
+    return false;
+  }
+
   MetaAddress fromPC(uint64_t PC) const {
     using namespace model::Architecture;
     auto Architecture = toLLVMArchitecture(Binary->Architecture());
@@ -312,8 +366,34 @@ public:
   llvm::SmallVector<std::pair<llvm::BasicBlock *, bool>, 4>
   blocksByPCRange(MetaAddress Start, MetaAddress End);
 
+private:
+  /// What we know about a basic block of `root`
+  struct BlockInfo {
+    BlockType::Values Type = BlockType::TranslatedBlock;
+
+    /// The jump target that generated this block, nullptr if unknown or if
+    /// multiple jump targets lead to this block
+    llvm::BasicBlock *JumpTarget = nullptr;
+
+    /// The last call to newpc in the block, if any
+    llvm::CallInst *LastNewPC = nullptr;
+  };
+
 private:
   void parseRoot();
+  void
+  indexBlocksGeneratedBy(llvm::BasicBlock *JumpTarget,
+                         llvm::SmallPtrSetImpl<const llvm::BasicBlock *>
+                           &Ambiguous);
+
+  const BlockInfo *getBlockInfo(const llvm::BasicBlock *BB) {
+    if (BB->getParent() != RootFunction)
+      return nullptr;
+
+    parseRoot();
+    auto It = Blocks.find(BB);
+    return It == Blocks.end() ? nullptr : &It->second;
+  }
 
 private:
   const model::Binary *Binary;
@@ -329,7 +409,9 @@ private:
   llvm::Function *RootFunction;
   std::vector<llvm::GlobalVariable *> CSVs;
   std::vector<llvm::GlobalVariable *> ABIRegisters;
-  std::set<llvm::GlobalVariable *> ABIRegistersSet;
+  llvm::DenseSet<const llvm::GlobalVariable *> ABIRegistersSet;
+  llvm::DenseSet<const llvm::GlobalVariable *> CSVsSet;
+  llvm::DenseMap<const llvm::BasicBlock *, BlockInfo> Blocks;
   llvm::Function *NewPC;
   std::unique_ptr<ProgramCounterHandler> PCH;
   using PCToBlockMap = std::multimap<MetaAddress, llvm::BasicBlock *>;
@@ -0,0 +1,75 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <optional>
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+
+#include "revng/Support/Assert.h"
+#include "revng/Support/BasicBlockID.h"
+
+namespace efa {
+
+/// A dense numbering of the basic blocks of a function.
+///
+/// Blocks are numbered from 0 to `size() - 1` following the order of their
+/// `BasicBlockID`, i.e., a block number is its position in the `Blocks`
+/// `SortedVector` of the CFG it was built from. This allows per-function
+/// algorithms to keep their per-block data in vectors and bit vectors indexed
+/// by block number, instead of in maps keyed by `BasicBlockID`.
+///
+/// \note The numbering is a snapshot: it's not updated when blocks are added to
+///       or removed from the CFG it was built from.
+class BlockNumbering {
+private:
+  llvm::SmallVector<BasicBlockID, 16> IDs;
+
+public:
+  BlockNumbering() = default;
+
+  /// \param Blocks a range of basic blocks sorted by their `ID()`, such as the
+  ///        `Blocks` of an `efa::ControlFlowGraph` or of a `yield::Function`.
+  template<typename BlocksRange>
+  explicit BlockNumbering(const BlocksRange &Blocks) {
+    for (const auto &Block : Blocks)
+      IDs.push_back(Block.ID());
+
+    revng_assert(std::adjacent_find(IDs.begin(),
+                                    IDs.end(),
+                                    std::greater_equal<BasicBlockID>())
+                 == IDs.end());
+    revng_assert(IDs.size() <= UINT32_MAX);
+  }
+
+public:
+  uint32_t size() const { return IDs.size(); }
+
+  const BasicBlockID &id(uint32_t Number) const {
+    revng_assert(Number < IDs.size());
+    return IDs[Number];
+  }
+
+  /// \return the number of the block identified by \p ID, if it's part of the
+  ///         function
+  std::optional<uint32_t> find(const BasicBlockID &ID) const {
+    auto It = llvm::lower_bound(IDs, ID);
+    if (It == IDs.end() or *It != ID)
+      return std::nullopt;
+    return It - IDs.begin();
+  }
+
+  uint32_t number(const BasicBlockID &ID) const {
+    auto Result = find(ID);
+    revng_assert(Result.has_value());
+    return *Result;
+  }
+};
+
+} // namespace efa
@@ -4,9 +4,16 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
 #include "llvm/ADT/SmallVector.h"
 
 #include "revng/EarlyFunctionAnalysis/CallHandler.h"
+#include "revng/EarlyFunctionAnalysis/DiagnosticsBuffer.h"
+#include "revng/EarlyFunctionAnalysis/FunctionSummaryOracle.h"
 #include "revng/EarlyFunctionAnalysis/Outliner.h"
 #include "revng/EarlyFunctionAnalysis/TemporaryOpaqueFunction.h"
 #include "revng/Model/Binary.h"
@@ -88,12 +95,33 @@ private:
   std::unique_ptr<llvm::raw_ostream> OutputAAWriter;
   std::unique_ptr<llvm::raw_ostream> OutputIBI;
 
+  /// If present, the diagnostics of the instrumented functions are collected
+  /// here, rather than in OutputAAWriter and OutputIBI
+  std::unique_ptr<DiagnosticsBuffer> Diagnostics;
+  /// If not empty, only the functions at these addresses are instrumented
+  std::set<MetaAddress> DiagnosticsFilter;
+
+  /// A pristine copy of an outlined function, along with the requests made to
+  /// the oracle in order to produce it
+  struct CachedOutlinedFunction {
+    OutlinedFunction Function;
+    std::vector<SummaryDependency> Dependencies;
+  };
+
+  /// Functions outlined so far, by entry address
+  ///
+  /// \note this needs to be destroyed before the hooks used by the functions.
+  std::map<MetaAddress, CachedOutlinedFunction> OutlinedFunctions;
+
 public:
   CFGAnalyzer(llvm::Module &M,
               GeneratedCodeBasicInfo &GCBI,
               const TupleTree<model::Binary> &Binary,
               FunctionSummaryOracle &Oracle);
 
+  /// Writes out the collected diagnostics, if any
+  ~CFGAnalyzer();
+
 public:
   llvm::Function *preCallHook() const { return PreCallHook.get(); }
   llvm::Function *postCallHook() const { return PostCallHook.get(); }
@@ -103,9 +131,15 @@ public:
 public:
   FunctionSummary analyze(const MetaAddress &Entry);
 
+  /// Outline the function at \p Entry
+  ///
+  /// The result is reused, i.e., copied, until the oracle changes its answer
+  /// to any of the requests made while producing it.
   OutlinedFunction outline(const MetaAddress &Entry);
 
 private:
+  OutlinedFunction outlineImpl(const MetaAddress &Entry);
+
   static llvm::FunctionType *createCallMarkerType(llvm::Module &M);
   static llvm::FunctionType *createRetMarkerType(llvm::Module &M);
 
@@ -121,7 +155,11 @@ private:
 
   void materializePCValues(llvm::Function *F, llvm::IRBuilder<> &);
 
-  void runOptimizationPipeline(llvm::Function *F);
+  /// \return true if the diagnostics of the function at \p Entry have to be
+  ///         collected
+  bool isInstrumented(const MetaAddress &Entry) const;
+
+  void runOptimizationPipeline(llvm::Function *F, const MetaAddress &Entry);
 
   FunctionSummary milkInfo(OutlinedFunction *F,
                            SortedVector<efa::BasicBlock> &&CFG);
@@ -4,6 +4,10 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <string>
+
+#include "llvm/ADT/StringRef.h"
+
 #include "revng/Pipes/Kinds.h"
 #include "revng/Pipes/StringMap.h"
 
@@ -13,5 +17,16 @@ inline constexpr char CFGMime[] = "text/yaml+tar+gz";
 inline constexpr char CFGName[] = "cfg";
 inline constexpr char CFGExtension[] = ".yml";
 
-using CFGMap = FunctionStringMap<&kinds::CFG, CFGName, CFGMime, CFGExtension>;
+/// CFGs are kept in memory using the binary tuple tree encoding (see
+/// BinarySerialization.h), which is much cheaper to decode for the pipes
+/// consuming them, and are exported as YAML.
+///
+/// \return the YAML form of \p Serialized, which can be either binary or YAML
+std::string exportCFG(llvm::StringRef Serialized);
+
+using CFGMap = FunctionStringMap<&kinds::CFG,
+                                 CFGName,
+                                 CFGMime,
+                                 CFGExtension,
+                                 &exportCFG>;
 } // namespace revng::pipes
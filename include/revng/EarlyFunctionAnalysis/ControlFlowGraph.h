@@ -4,7 +4,10 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <optional>
+
 #include "revng/EarlyFunctionAnalysis/BasicBlock.h"
+#include "revng/EarlyFunctionAnalysis/BlockNumbering.h"
 #include "revng/Model/VerifyHelper.h"
 #include "revng/Support/MetaAddress.h"
 #include "revng/Support/MetaAddress/YAMLTraits.h"
@@ -13,7 +16,8 @@
 
 namespace llvm {
 class BasicBlock;
-}
+class Instruction;
+} // namespace llvm
 class GeneratedCodeBasicInfo;
 
 /* TUPLE-TREE-YAML
@@ -48,8 +52,17 @@ public:
   const efa::BasicBlock *findBlock(GeneratedCodeBasicInfo &GCBI,
                                    llvm::BasicBlock *BB) const;
 
+  /// Attach the binary encoding of this CFG to the terminator of the entry
+  /// block of the function, see BinarySerialization.h
   void serialize(GeneratedCodeBasicInfo &GCBI) const;
 
+  /// Decode the CFG attached by `serialize` to \p Terminator, if any
+  static std::optional<TupleTree<efa::ControlFlowGraph>>
+  deserialize(const llvm::Instruction *Terminator);
+
+  /// Number the blocks of the function densely, see `efa::BlockNumbering`
+  BlockNumbering numbering() const { return BlockNumbering(Blocks()); }
+
 public:
   bool verify(const model::Binary &Binary) const debug_function;
   bool verify(const model::Binary &Binary, bool Assert) const debug_function;
@@ -4,6 +4,12 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/PassManager.h"
 #include "llvm/Pass.h"
@@ -12,6 +18,7 @@
 #include "revng/EarlyFunctionAnalysis/ControlFlowGraph.h"
 #include "revng/Model/Binary.h"
 #include "revng/Model/IRHelpers.h"
+#include "revng/Pipeline/Context.h"
 #include "revng/Pipes/IRHelpers.h"
 #include "revng/Pipes/Kinds.h"
 #include "revng/Support/Assert.h"
@@ -54,6 +61,104 @@ concept ControlFlowGraphCacheTraits = requires {
   } -> std::same_as<MetaAddress>;
 };
 
+/// A cache of deserialized control-flow graphs with a bounded memory budget.
+///
+/// An instance is meant to be shared by all the BasicControlFlowGraphCache of
+/// the pipes running in the same pipeline::Context (see
+/// `getSharedControlFlowGraphCache`), so that the same CFG is not deserialized
+/// by each of them. Entries are identified by the address of the function and
+/// by a hash of its serialized form, so that a CFG that has been recomputed
+/// never hits a stale entry.
+///
+/// Decoded CFGs are evicted in least-recently-used order once their estimated
+/// size exceeds the budget. Their binary encoding (see BinarySerialization.h),
+/// which is much more compact and cheaper to decode than YAML, is retained
+/// within a smaller budget of its own.
+///
+/// This class is thread-safe.
+class SharedControlFlowGraphCache {
+public:
+  using CFGPointer = std::shared_ptr<const TupleTree<efa::ControlFlowGraph>>;
+
+  static constexpr llvm::StringRef ContextName = "shared-cfg-cache";
+
+private:
+  using Key = std::pair<MetaAddress, uint64_t>;
+
+  template<typename T>
+  class LRUList {
+  private:
+    struct Item {
+      Key TheKey;
+      T Value;
+      size_t Cost = 0;
+    };
+
+  private:
+    /// Most recently used first
+    std::list<Item> Items;
+    std::map<Key, typename std::list<Item>::iterator> Index;
+    size_t Used = 0;
+    size_t Budget = 0;
+
+  public:
+    explicit LRUList(size_t Budget) : Budget(Budget) {}
+
+  public:
+    T *get(const Key &TheKey) {
+      auto It = Index.find(TheKey);
+      if (It == Index.end())
+        return nullptr;
+
+      Items.splice(Items.begin(), Items, It->second);
+      return &It->second->Value;
+    }
+
+    /// \note the most recent entry is never evicted, even if it exceeds the
+    ///       budget on its own
+    void insert(const Key &TheKey, T Value, size_t Cost) {
+      if (auto It = Index.find(TheKey); It != Index.end())
+        erase(It->second);
+
+      Items.push_front({ TheKey, std::move(Value), Cost });
+      Index[TheKey] = Items.begin();
+      Used += Cost;
+
+      while (Used > Budget and Items.size() > 1)
+        erase(std::prev(Items.end()));
+    }
+
+  private:
+    void erase(typename std::list<Item>::iterator It) {
+      Used -= It->Cost;
+      Index.erase(It->TheKey);
+      Items.erase(It);
+    }
+  };
+
+private:
+  std::mutex Mutex;
+  LRUList<CFGPointer> Decoded;
+  LRUList<std::string> Encoded;
+
+public:
+  /// Use the budget specified on the command line
+  SharedControlFlowGraphCache();
+  SharedControlFlowGraphCache(size_t DecodedBudget, size_t EncodedBudget) :
+    Decoded(DecodedBudget), Encoded(EncodedBudget) {}
+
+public:
+  /// \return the CFG of the function at \p Address, whose serialized form is
+  ///         \p Serialized.
+  CFGPointer get(const MetaAddress &Address, llvm::StringRef Serialized);
+};
+
+inline SharedControlFlowGraphCache &
+getSharedControlFlowGraphCache(pipeline::Context &Context) {
+  using Cache = SharedControlFlowGraphCache;
+  return Context.getOrCreateSharedObject<Cache>(Cache::ContextName);
+}
+
 /// The BasicControlFlowGraphCache is implemented as a class template customised
 /// via a traits class in order to enable reuse for both LLVM IR and MLIR.
 template<ControlFlowGraphCacheTraits Traits>
@@ -62,27 +167,55 @@ class BasicControlFlowGraphCache {
   using Function = typename Traits::Function;
   using CallInst = typename Traits::CallInst;
 
+  using CFGPointer = SharedControlFlowGraphCache::CFGPointer;
+
+  /// How many of the most recently requested CFGs are kept alive, even if
+  /// they have been evicted from the shared cache
+  static constexpr size_t PinnedCount = 16;
+
   const revng::pipes::CFGMap &CFGs;
-  std::map<MetaAddress, TupleTree<efa::ControlFlowGraph>> Deserialized;
+  std::unique_ptr<SharedControlFlowGraphCache> Owned;
+  SharedControlFlowGraphCache *Shared = nullptr;
+  /// CFGs set explicitly, they are never evicted
+  std::map<MetaAddress, TupleTree<efa::ControlFlowGraph>> Overridden;
+  /// Most recently requested last
+  std::deque<std::pair<MetaAddress, CFGPointer>> Pinned;
 
 public:
-  BasicControlFlowGraphCache(const revng::pipes::CFGMap &CFGs) : CFGs(CFGs) {}
+  /// \param Shared the cache to use to deserialize CFGs, if null a private one
+  ///        is created.
+  BasicControlFlowGraphCache(const revng::pipes::CFGMap &CFGs,
+                             SharedControlFlowGraphCache *Shared = nullptr) :
+    CFGs(CFGs), Shared(Shared) {
+    if (this->Shared == nullptr) {
+      Owned = std::make_unique<SharedControlFlowGraphCache>();
+      this->Shared = Owned.get();
+    }
+  }
 
 public:
   void set(TupleTree<efa::ControlFlowGraph> &&New) {
-    Deserialized[New->Entry()] = std::move(New);
+    Overridden[New->Entry()] = std::move(New);
   }
 
 public:
+  /// \note the returned reference is guaranteed to be valid only until
+  ///       `PinnedCount` other CFGs have been requested.
   const efa::ControlFlowGraph &getControlFlowGraph(const MetaAddress &Address) {
-    auto It = Deserialized.find(Address);
-    if (It != Deserialized.end())
-      return *It->second.get();
-
-    TupleTree<efa::ControlFlowGraph> &Result = Deserialized[Address];
-    Result = TupleTree<efa::ControlFlowGraph>::fromString(CFGs.at(Address))
-               .get();
-    return *Result.get();
+    auto It = Overridden.find(Address);
+    if (It != Overridden.end())
+      return *It->second;
+
+    for (const auto &[PinnedAddress, CFG] : llvm::reverse(Pinned))
+      if (PinnedAddress == Address)
+        return **CFG;
+
+    CFGPointer Result = Shared->get(Address, CFGs.at(Address));
+    if (Pinned.size() == PinnedCount)
+      Pinned.pop_front();
+    Pinned.emplace_back(Address, Result);
+
+    return **Result;
   }
 
   const efa::ControlFlowGraph &getControlFlowGraph(const Function Function) {
@@ -188,8 +321,9 @@ private:
   ControlFlowGraphCache Cache;
 
 public:
-  ControlFlowGraphCachePass(const revng::pipes::CFGMap &CFGs) :
-    llvm::ImmutablePass(ID), Cache(CFGs) {}
+  ControlFlowGraphCachePass(const revng::pipes::CFGMap &CFGs,
+                            SharedControlFlowGraphCache *Shared = nullptr) :
+    llvm::ImmutablePass(ID), Cache(CFGs, Shared) {}
   ControlFlowGraphCache &get() { return Cache; }
 };
 
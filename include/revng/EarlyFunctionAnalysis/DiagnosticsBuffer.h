@@ -0,0 +1,79 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <cstdint>
+#include <deque>
+#include <string>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace efa {
+
+/// A bounded in-memory buffer of the diagnostics produced while analyzing
+/// functions, i.e., the alias information and the indirect branch info
+/// summary, written out as a compact binary artifact at the end of the
+/// analysis.
+///
+/// Once the buffer is full, the oldest records are dropped, so that the
+/// artifact always describes the functions analyzed most recently.
+///
+/// The artifact is gzip-compressed. Once decompressed, it looks as follows,
+/// all the integers being little endian:
+///
+///     "EFADIAG1"
+///     u64: number of dropped records
+///     u32: size of the preamble, followed by the preamble itself
+///     for each record:
+///       u8:  kind of the record (see RecordKind)
+///       u64: entry address of the function
+///       u32: size of the data, followed by the data itself
+class DiagnosticsBuffer {
+public:
+  enum RecordKind : uint8_t {
+    /// A line of the summary of the indirect branch info for each exit point
+    IndirectBranchInfo,
+    /// The function, annotated with the alias information
+    AliasAnalysis
+  };
+
+  static constexpr llvm::StringRef Magic = "EFADIAG1";
+
+private:
+  struct Record {
+    RecordKind Kind;
+    uint64_t Address = 0;
+    std::string Data;
+  };
+
+private:
+  size_t Capacity = 0;
+  size_t Size = 0;
+  uint64_t Dropped = 0;
+  std::string Preamble;
+  std::deque<Record> Records;
+
+public:
+  /// \param Capacity the maximum number of bytes of data to keep
+  explicit DiagnosticsBuffer(size_t Capacity) : Capacity(Capacity) {}
+
+public:
+  /// Set the data describing how to interpret the records, e.g., the header
+  /// of the indirect branch info summary. It is not subject to the capacity.
+  void setPreamble(llvm::StringRef NewPreamble) {
+    Preamble = NewPreamble.str();
+  }
+
+  void record(RecordKind Kind, uint64_t Address, std::string &&Data);
+
+public:
+  size_t size() const { return Size; }
+  uint64_t dropped() const { return Dropped; }
+
+  void write(llvm::raw_ostream &OS) const;
+};
+
+} // namespace efa
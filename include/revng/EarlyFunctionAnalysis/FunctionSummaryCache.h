@@ -0,0 +1,87 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "revng/EarlyFunctionAnalysis/FunctionSummaryOracle.h"
+#include "revng/Support/MetaAddress.h"
+
+namespace llvm {
+class Module;
+} // namespace llvm
+
+namespace model {
+class Binary;
+} // namespace model
+
+namespace efa {
+
+class CFGAnalyzer;
+
+/// A persistent cache of the results of CFGAnalyzer::analyze.
+///
+/// Other than on the code of the function, the result of the analysis depends
+/// on the summaries provided by the FunctionSummaryOracle for the function
+/// itself and for its callees. Each entry records the requests made to the
+/// oracle during the analysis, along with a hash of the summary each of them
+/// obtained: the result can be reused if performing the same requests on the
+/// current oracle yields the same summaries. This way, after a small change to
+/// the model, only the affected functions are analyzed again.
+///
+/// The code is accounted for by identifying the whole cache through a hash of
+/// the module and of the parts of the model that the analysis reads directly.
+/// Caches are stored in the revng cache directory.
+class FunctionSummaryCache {
+private:
+  /// How many results are kept for each function
+  static constexpr size_t MaxEntriesPerFunction = 8;
+
+  struct Entry {
+    std::vector<SummaryDependency> Dependencies;
+    FunctionSummary Summary;
+  };
+
+private:
+  const llvm::Module &M;
+  /// Empty if the cache is disabled
+  std::string Path;
+  /// Most recent entry last
+  std::map<MetaAddress, std::vector<Entry>> Entries;
+  /// Functions that have been analyzed at least once during this run
+  std::set<MetaAddress> Recomputed;
+  bool Changed = false;
+  uint64_t Hits = 0;
+  uint64_t Misses = 0;
+
+public:
+  /// \note \p M must not have been altered by a CFGAnalyzer yet.
+  FunctionSummaryCache(const llvm::Module &M, const model::Binary &Binary);
+
+  FunctionSummaryCache(const FunctionSummaryCache &) = delete;
+  FunctionSummaryCache &operator=(const FunctionSummaryCache &) = delete;
+
+public:
+  /// \return the summary of the function at \p Entry, running \p Analyzer
+  ///         only if no reusable result is available.
+  FunctionSummary analyze(CFGAnalyzer &Analyzer,
+                          FunctionSummaryOracle &Oracle,
+                          const MetaAddress &Entry);
+
+  /// \return the functions for which no reusable result was available at
+  ///         least once, i.e., all of them if the cache is disabled.
+  const std::set<MetaAddress> &recomputed() const { return Recomputed; }
+
+  /// Write the cache back to disk, if anything changed
+  void store();
+
+private:
+  void load();
+};
+
+} // namespace efa
@@ -4,13 +4,20 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <optional>
 #include <set>
+#include <vector>
 
 #include "revng/ADT/MutableSet.h"
 #include "revng/EarlyFunctionAnalysis/AnalyzeRegisterUsage.h"
 #include "revng/EarlyFunctionAnalysis/BasicBlock.h"
 #include "revng/Model/FunctionAttribute.h"
 
+namespace revng::detail {
+class BinaryTupleTreeReader;
+class BinaryTupleTreeWriter;
+} // namespace revng::detail
+
 namespace efa {
 
 using AttributesSet = MutableSet<model::FunctionAttribute::Values>;
@@ -78,6 +85,19 @@ public:
                          ClobberedRegisters.end());
   }
 
+  /// Serialize the fields populated by CFGAnalyzer::analyze, i.e., everything
+  /// except for ABIResults and WrittenRegisters
+  void serialize(revng::detail::BinaryTupleTreeWriter &Writer) const;
+
+  /// Deserialize what `serialize` produced, looking up CSVs in \p M
+  ///
+  /// \return false if the input is malformed or refers to missing CSVs
+  bool deserialize(revng::detail::BinaryTupleTreeReader &Reader,
+                   const llvm::Module &M);
+
+  /// \return a hash of the fields handled by `serialize`
+  uint64_t hash() const;
+
   void dump() const debug_function { dump(dbg); }
 
   template<typename T>
@@ -127,6 +147,25 @@ public:
                             const model::TypeDefinition *Prototype);
 };
 
+/// A request made to a FunctionSummaryOracle, along with a hash of the summary
+/// it obtained
+struct SummaryDependency {
+  enum KindType : uint8_t {
+    Default,
+    LocalFunction,
+    DynamicFunction,
+    CallSite,
+    ExactCallSite
+  };
+
+  KindType Kind = Default;
+  MetaAddress Function = MetaAddress::invalid();
+  BasicBlockID CallSite = BasicBlockID::invalid();
+  MetaAddress CalledLocalFunction = MetaAddress::invalid();
+  std::string CalledSymbol;
+  uint64_t Hash = 0;
+};
+
 /// An oracle providing information about functions.
 ///
 /// This oracle can be populated with analysis results. But even if it has not
@@ -153,6 +192,9 @@ private:
   /// Default
   std::optional<FunctionSummary> Default;
 
+  /// If not null, the requests made to the oracle are recorded here
+  std::vector<SummaryDependency> *Recorder = nullptr;
+
 public:
   FunctionSummaryOracle() = delete;
   FunctionSummaryOracle(const model::Binary &Binary,
@@ -214,6 +256,38 @@ public:
 
   std::pair<FunctionSummary *, bool> getExactCallSite(MetaAddress Function,
                                                       BasicBlockID CallSite);
+
+public:
+  /// Record all the requests made from now on in \p NewRecorder, or stop
+  /// recording if null
+  ///
+  /// \note requests made by the oracle to itself are not recorded.
+  void setRecorder(std::vector<SummaryDependency> *NewRecorder) {
+    Recorder = NewRecorder;
+  }
+
+  std::vector<SummaryDependency> *recorder() const { return Recorder; }
+
+  /// Perform again a recorded request
+  ///
+  /// \return the hash of the obtained summary, or std::nullopt if the request
+  ///         cannot be performed anymore (e.g., the function is gone).
+  std::optional<uint64_t> replay(const SummaryDependency &Dependency);
+
+private:
+  template<typename CallableType>
+  decltype(auto) record(SummaryDependency Request, CallableType &&Compute);
+
+  const FunctionSummary &getDefaultImpl();
+  FunctionSummary &getLocalFunctionImpl(MetaAddress PC);
+  std::pair<const FunctionSummary *, bool>
+  getCallSiteImpl(MetaAddress Function,
+                  BasicBlockID CallerBlockAddress,
+                  MetaAddress CalledLocalFunction,
+                  llvm::StringRef CalledSymbol);
+  const FunctionSummary &getDynamicFunctionImpl(llvm::StringRef Name);
+  std::pair<FunctionSummary *, bool>
+  getExactCallSiteImpl(MetaAddress Function, BasicBlockID CallSite);
 };
 
 } // namespace efa
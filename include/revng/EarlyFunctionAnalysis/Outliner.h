@@ -79,7 +79,7 @@ class Outliner {
 private:
   llvm::Module &M;
   GeneratedCodeBasicInfo &GCBI;
-  FunctionSummaryOracle &Oracle;
+  FunctionSummaryOracle *Oracle = nullptr;
 
   /// UnexpectedPCMarker is used to indicate that `unexpectedpc` basic
   /// block of a function to inline need to be adjusted to jump to
@@ -96,7 +96,7 @@ public:
            FunctionSummaryOracle &Oracle) :
     M(M),
     GCBI(GCBI),
-    Oracle(Oracle),
+    Oracle(&Oracle),
     UnexpectedPCMarker(initializeUnexpectedPCMarker(M)),
     OpaqueReturnAddress(&M, false),
     CEAC(*M.getFunction("root")) {
@@ -116,6 +116,12 @@ public:
   OutlinedFunction outline(const MetaAddress &EntryAddress,
                            CallHandler *TheCallHandler);
 
+  /// Use \p NewOracle for the functions outlined from now on
+  ///
+  /// This enables reusing the state built upon construction (e.g., the
+  /// analysis of `root`) across functions that need different oracles.
+  void setOracle(FunctionSummaryOracle &NewOracle) { Oracle = &NewOracle; }
+
 private:
   static TemporaryOpaqueFunction initializeUnexpectedPCMarker(llvm::Module &M) {
     return { llvm::FunctionType::get(llvm::Type::getVoidTy(M.getContext()),
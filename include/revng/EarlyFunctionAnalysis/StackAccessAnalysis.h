@@ -0,0 +1,66 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/PassManager.h"
+
+class GeneratedCodeBasicInfo;
+
+/// The memory accesses of a function, classified in a single walk over the IR.
+///
+/// Each load and store is either an access to a CSV, a direct access to the
+/// stack (i.e., its address is the stack pointer as loaded at the entry of the
+/// function plus a constant offset), or any other kind of memory access.
+class StackAccesses {
+public:
+  enum class AccessKind { CSV, Stack, Other };
+
+  struct MemoryAccess {
+    llvm::Instruction *I = nullptr;
+    /// The address accessed by \p I, casts excluded
+    llvm::Value *Pointer = nullptr;
+    AccessKind Kind = AccessKind::Other;
+    /// For stack accesses, the offset from the entry stack pointer
+    int64_t Offset = 0;
+  };
+
+private:
+  llvm::LoadInst *StackPointer = nullptr;
+  std::vector<MemoryAccess> Accesses;
+  llvm::DenseMap<llvm::Value *, std::optional<int64_t>> Offsets;
+
+public:
+  StackAccesses(llvm::Function &F, const GeneratedCodeBasicInfo &GCBI);
+
+public:
+  /// The first load of the stack pointer CSV in the function, if any
+  llvm::LoadInst *stackPointer() const { return StackPointer; }
+
+  const std::vector<MemoryAccess> &accesses() const { return Accesses; }
+
+  /// The offset of \p V from the entry stack pointer, if \p V is an integer
+  /// computed by adding and subtracting constants to it
+  std::optional<int64_t> stackOffset(llvm::Value *V);
+};
+
+/// An analysis pass computing the \c StackAccesses of a function, so that the
+/// passes of the same pipeline that need them can share a single walk of the
+/// function as long as the IR is not changed in between.
+class StackAccessAnalysis
+  : public llvm::AnalysisInfoMixin<StackAccessAnalysis> {
+  friend llvm::AnalysisInfoMixin<StackAccessAnalysis>;
+  static llvm::AnalysisKey Key;
+
+public:
+  using Result = StackAccesses;
+  /// \note Requires \c GeneratedCodeBasicInfoAnalysis to be registered.
+  Result run(llvm::Function &F, llvm::FunctionAnalysisManager &FAM);
+};
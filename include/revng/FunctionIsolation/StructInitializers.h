@@ -8,6 +8,14 @@
 
 #include "revng/Support/OpaqueFunctionsPool.h"
 
+/// Pool of opaque functions building a struct out of its fields, one for each
+/// struct type returned by a function
+///
+/// \note Creating an initializer alters the module and the LLVMContext, and
+///       therefore requires exclusive access. Once the initializers for all
+///       the types of interest have been created through `pregenerate`,
+///       `lookup` can be used concurrently, e.g., by parallel workers
+///       processing different functions.
 class StructInitializers {
 private:
   OpaqueFunctionsPool<llvm::StructType *> Pool;
@@ -16,7 +24,24 @@ private:
 public:
   StructInitializers(llvm::Module *M);
 
+public:
+  /// Create, in a single pass, the initializers for all of \p Types
+  void pregenerate(llvm::ArrayRef<llvm::StructType *> Types);
+
+  /// \return the initializer for \p Type, if it has already been created
+  llvm::Function *lookup(llvm::StructType *Type) const {
+    return Pool.find(Type);
+  }
+
+  /// \return the initializer for \p Type, creating it if necessary
+  llvm::Function *get(llvm::StructType *Type);
+
 public:
   llvm::Instruction *createReturn(llvm::IRBuilder<> &Builder,
                                   llvm::ArrayRef<llvm::Value *> Values);
+
+  /// Emit a return of a struct built by \p Initializer out of \p Values
+  static llvm::Instruction *createReturn(llvm::IRBuilder<> &Builder,
+                                         llvm::Function *Initializer,
+                                         llvm::ArrayRef<llvm::Value *> Values);
 };
@@ -14,7 +14,12 @@ enum class RankingStrategy {
   BreadthFirstSearch,
   DepthFirstSearch,
   Topological,
-  DisjointDepthFirstSearch
+  DisjointDepthFirstSearch,
+
+  /// Minimizes the total edge length (see "A Technique for Drawing Directed
+  /// Graphs" by Gansner et al.), keeping the number of virtual nodes low on
+  /// big graphs with many long edges (e.g. huge switches).
+  NetworkSimplex
 };
 
 /// List graph orientation options the layouter implements.
@@ -75,6 +80,24 @@ public:
 
   /// Specifies the minimum possible distance between two edges.
   layout::Dimension EdgeMarginSize;
+
+  /// Specifies the number of nodes in the widest layer above which crossing
+  /// minimization switches from the exhaustive hill climbing (its cost grows
+  /// with the cube of the width of the layers) to a sweep heuristic that only
+  /// considers swapping adjacent nodes.
+  ///
+  /// The sweep counts crossings with an accumulator tree and processes the
+  /// layers that do not neighbor each other in parallel.
+  ///
+  /// \note: set to zero to always use the sweep heuristic.
+  size_t ScalableCrossingMinimizationThreshold = 64;
+
+  /// Specifies whether the horizontal coordinates should be assigned in linear
+  /// time following "Fast and Simple Horizontal Coordinate Assignment" by
+  /// Brandes and Koepf, instead of iterating until the positions settle.
+  ///
+  /// \note: `VirtualNodeWeight` is ignored when this is set.
+  bool UseLinearTimeHorizontalPlacement = false;
 };
 
 namespace detail {
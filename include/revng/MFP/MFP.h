@@ -50,6 +50,19 @@ concept MonotoneFrameworkInstance = requires(const MFI &I,
   { I.applyTransferFunction(L, E2) } -> std::same_as<LatticeElement>;
 };
 
+/// An instance can optionally provide `combineInPlace`, which merges \p Source
+/// into \p Target and returns true if \p Target changed
+///
+/// This replaces an `isLessOrEqual` followed by a `combineValues` with a single
+/// operation that does not need temporaries, which is significantly cheaper
+/// for lattices of large sets (e.g., bit vectors).
+template<typename MFI, typename LatticeElement = typename MFI::LatticeElement>
+concept HasCombineInPlace = requires(const MFI &I,
+                                     LatticeElement &Target,
+                                     const LatticeElement &Source) {
+  { I.combineInPlace(Target, Source) } -> std::same_as<bool>;
+};
+
 template<typename Label, typename LatticeElement>
 using ResultMap = std::map<Label, MFPResult<LatticeElement>>;
 
@@ -124,11 +137,20 @@ getMaximalFixedPoint(const MFI &Instance,
 
     for (Label End : successors<GT>(Start)) {
       auto &PartialEnd = AnalysisResult.at(End);
-      if (!Instance.isLessOrEqual(LabelAnalysis.OutValue, PartialEnd.InValue)) {
+
+      bool Changed = false;
+      if constexpr (HasCombineInPlace<MFI>) {
+        Changed = Instance.combineInPlace(PartialEnd.InValue,
+                                          LabelAnalysis.OutValue);
+      } else if (!Instance.isLessOrEqual(LabelAnalysis.OutValue,
+                                         PartialEnd.InValue)) {
         PartialEnd.InValue = Instance.combineValues(PartialEnd.InValue,
                                                     LabelAnalysis.OutValue);
-        Worklist.insert({ LabelPriority.at(End), End });
+        Changed = true;
       }
+
+      if (Changed)
+        Worklist.insert({ LabelPriority.at(End), End });
     }
   }
 
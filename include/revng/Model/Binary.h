@@ -278,6 +278,10 @@ public:
   bool verify(bool Assert) const debug_function;
   bool verify() const debug_function;
 
+  /// Same as `verify`, except that functions, segments and type definitions
+  /// are split in shards verified concurrently
+  bool verifyInParallel(bool Assert = false) const;
+
   bool verifyTypeDefinitions(VerifyHelper &VH) const;
   bool verifyTypeDefinitions(bool Assert) const debug_function;
   bool verifyTypeDefinitions() const debug_function;
@@ -294,3 +298,20 @@ public:
 };
 
 #include "revng/Model/Generated/Late/Binary.h"
+
+namespace model {
+
+/// Verify \p Model after \p Diff has been applied to it
+///
+/// This assumes the model verified before the diff was applied: if the diff
+/// only touches functions, dynamic functions and segments, only the touched
+/// objects are verified, along with the global namespace and whatever else
+/// they could break. Otherwise, this is equivalent to `Model.verify()`.
+bool verifyAfterDiff(const model::Binary &Model,
+                     const TupleTreeDiff<model::Binary> &Diff,
+                     VerifyHelper &VH);
+bool verifyAfterDiff(const model::Binary &Model,
+                     const TupleTreeDiff<model::Binary> &Diff,
+                     bool Assert = false);
+
+} // namespace model
@@ -0,0 +1,99 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <optional>
+#include <string>
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+
+#include "revng/Model/Binary.h"
+
+namespace model {
+
+/// \name Paths of the objects owning a name in the global namespace
+/// @{
+std::string globalSymbolPath(const model::Function &F);
+std::string globalSymbolPath(const model::DynamicFunction &F);
+std::string globalSymbolPath(const model::TypeDefinition &T);
+std::string globalSymbolPath(const model::EnumDefinition &D,
+                             const model::EnumEntry &Entry);
+std::string globalSymbolPath(const model::Segment &Segment);
+/// @}
+
+/// A hash-based index of the names in the global namespace of a model, i.e.,
+/// the names of functions, dynamic functions, type definitions, enum entries
+/// and segments, along with the path of the object owning each of them.
+///
+/// The index can be kept alive next to a model and updated with the diffs
+/// applied to it (see `update`), so that collisions can be detected, e.g.,
+/// before renaming an object, without visiting the whole model again.
+///
+/// \note Names used by more than one object are tracked too, so that an index
+///       built from an invalid model stays consistent as the offending objects
+///       are renamed.
+///
+/// \note Like standard containers, the const methods can be used concurrently
+///       but altering the index requires exclusive access.
+class GlobalNamespace {
+private:
+  /// Name -> paths of the objects using it, usually a single one
+  llvm::StringMap<llvm::SmallVector<std::string, 1>> Owners;
+  /// Path -> name of the object
+  llvm::StringMap<std::string> Names;
+
+public:
+  GlobalNamespace() = default;
+  /// Index all the names in the global namespace of \p Model
+  explicit GlobalNamespace(const model::Binary &Model);
+
+public:
+  size_t size() const { return Names.size(); }
+  bool empty() const { return Names.empty(); }
+
+  bool contains(llvm::StringRef Name) const { return Owners.count(Name) != 0; }
+
+  /// \return the path of the first object that has been registered as the
+  ///         owner of \p Name, if any
+  std::optional<llvm::StringRef> owner(llvm::StringRef Name) const;
+
+  /// \return true if the object at \p Path can be named \p Name without
+  ///         colliding with any other global symbol
+  bool isAvailable(llvm::StringRef Name, llvm::StringRef Path) const;
+
+  /// \return the first name used by more than one object, if any
+  std::optional<llvm::StringRef> findCollision() const;
+
+public:
+  /// Record that the object at \p Path is named \p Name, replacing its
+  /// previous name, if any
+  ///
+  /// Empty names are not part of the global namespace: they just drop the
+  /// previous name of the object.
+  ///
+  /// \return false if \p Name was already used by another object, in which
+  ///         case the collision is recorded anyway
+  bool insert(llvm::StringRef Name, llvm::StringRef Path);
+
+  /// Forget the name of the object at \p Path
+  void erase(llvm::StringRef Path);
+
+  void clear() {
+    Owners.clear();
+    Names.clear();
+  }
+
+  /// Bring the index in sync with \p Model after \p Diff has been applied to
+  /// it
+  ///
+  /// Only the functions, dynamic functions and segments touched by the diff
+  /// are indexed again, any other change causes the whole index to be rebuilt.
+  void update(const model::Binary &Model,
+              const TupleTreeDiff<model::Binary> &Diff);
+};
+
+} // namespace model
@@ -38,6 +38,17 @@ public:
 public:
   void import(llvm::StringRef FileName, const ImporterOptions &Options);
 
+  /// Same as `import(FileName, Options)`, for an already parsed \p TheBinary
+  /// with the content of \p FileName
+  void import(const llvm::object::Binary &TheBinary,
+              llvm::StringRef FileName,
+              const ImporterOptions &Options);
+
+  /// Concurrently look for, and fetch if necessary, the detached debug
+  /// information of each of \p FileNames, so that importing them later on
+  /// does not have to wait for the network
+  static void fetchDebugInfo(llvm::ArrayRef<std::string> FileNames);
+
 private:
   void import(const llvm::object::Binary &TheBinary,
               llvm::StringRef FileName,
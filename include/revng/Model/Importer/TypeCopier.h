@@ -53,29 +53,7 @@ public:
     for (const auto &P : FromModel->TypeDefinitions()) {
       if (AlreadyCopied.count(P.get()->ID()) == 0
           && Visited.contains(TypeToNode.at(P.get()))) {
-        // Clone the type
-        model::UpcastableTypeDefinition NewType = P;
-
-        // Reset type ID: recordNewType will set it for us
-        NewType->ID() = 0;
-
-        // Adjust all CustomNames
-        auto Visitor = [](auto &Element) {
-          using T = std::decay_t<decltype(Element)>;
-          if constexpr (HasCustomAndOriginalName<T>) {
-            std::string CustomName = Element.CustomName().str().str();
-            Element.CustomName() = model::Identifier();
-            if (Element.OriginalName().empty())
-              Element.OriginalName() = CustomName;
-          }
-        };
-        visitTupleTree(NewType, Visitor, [](const auto &) {});
-
-        // Record the type
-        auto [Def, Type] = DestinationModel->recordNewType(std::move(NewType));
-        NewTypes.insert(&Def);
-        auto [_, Success] = AlreadyCopied.insert({ P->ID(), Def.ID() });
-        revng_assert(Success);
+        model::UpcastableType Type = copy(P);
 
         // Record the type we were looking for originally
         if (P->key() == Definition.key())
@@ -89,6 +67,29 @@ public:
     return Result;
   }
 
+  /// Copy all the type definitions of the source model that have not been
+  /// copied yet
+  ///
+  /// This is equivalent to, but much cheaper than, calling `copyTypeInto` on
+  /// each of them.
+  void copyAllTypesInto() {
+    for (const auto &P : FromModel->TypeDefinitions())
+      if (AlreadyCopied.count(P.get()->ID()) == 0)
+        copy(P);
+
+    DestinationModel.initializeReferences();
+  }
+
+  /// 
+eturns the destination model type for the copy of the definition with
+  ///          key \p Key, which must have already been copied.
+  model::UpcastableType getCopy(const model::TypeDefinition::Key &Key) const {
+    auto [ID, Kind] = Key;
+    auto It = AlreadyCopied.find(ID);
+    revng_assert(It != AlreadyCopied.end());
+    return DestinationModel->makeType({ It->second, Kind });
+  }
+
   void finalize() {
     revng_assert(not Finalized);
     Finalized = true;
@@ -116,6 +117,34 @@ public:
   }
 
 private:
+  model::UpcastableType copy(const model::UpcastableTypeDefinition &P) {
+    // Clone the type
+    model::UpcastableTypeDefinition NewType = P;
+
+    // Reset type ID: recordNewType will set it for us
+    NewType->ID() = 0;
+
+    // Adjust all CustomNames
+    auto Visitor = [](auto &Element) {
+      using T = std::decay_t<decltype(Element)>;
+      if constexpr (HasCustomAndOriginalName<T>) {
+        std::string CustomName = Element.CustomName().str().str();
+        Element.CustomName() = model::Identifier();
+        if (Element.OriginalName().empty())
+          Element.OriginalName() = CustomName;
+      }
+    };
+    visitTupleTree(NewType, Visitor, [](const auto &) {});
+
+    // Record the type
+    auto [Def, Type] = DestinationModel->recordNewType(std::move(NewType));
+    NewTypes.insert(&Def);
+    auto [_, Success] = AlreadyCopied.insert({ P->ID(), Def.ID() });
+    revng_assert(Success);
+
+    return std::move(Type);
+  }
+
   void ensureGraph() {
     if (!TypeGraph) {
       TypeGraph = Graph();
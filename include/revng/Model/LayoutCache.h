@@ -0,0 +1,70 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+
+#include "revng/Model/ABI.h"
+#include "revng/Model/VerifyHelper.h"
+
+namespace model {
+
+class TypeDefinition;
+
+/// The alignment of a type according to a certain ABI
+struct TypeAlignment {
+  uint64_t Value;
+  bool IsNatural;
+};
+
+/// Memoize the size and the alignment of type definitions across queries
+///
+/// Sizes and alignments are usually computed from scratch on each query, which
+/// is expensive for deeply nested types. While an instance of this class is
+/// alive, the queries that are not given an explicit cache (e.g.,
+/// `model::Type::size()` or `abi::Definition::alignment(Type)`) issued by the
+/// same thread share its caches instead.
+///
+/// Entries are keyed by the address of the type definition: the caller must
+/// ensure that, while the scope is alive, no type definition whose size has
+/// been computed is modified or erased, or call `invalidate` if it does.
+class LayoutCacheScope {
+public:
+  using AlignmentCache = std::unordered_map<const model::TypeDefinition *,
+                                            TypeAlignment>;
+
+private:
+  VerifyHelper Sizes;
+  std::map<model::ABI::Values, AlignmentCache> Alignments;
+  LayoutCacheScope *Previous = nullptr;
+
+public:
+  LayoutCacheScope();
+  ~LayoutCacheScope();
+
+  LayoutCacheScope(const LayoutCacheScope &) = delete;
+  LayoutCacheScope &operator=(const LayoutCacheScope &) = delete;
+
+public:
+  /// \return the innermost scope active in this thread, if any
+  static LayoutCacheScope *current();
+
+public:
+  VerifyHelper &sizes() { return Sizes; }
+
+  AlignmentCache &alignments(model::ABI::Values ABI) {
+    return Alignments[ABI];
+  }
+
+  /// Forget everything, to be used after the type system has been modified
+  void invalidate() {
+    Sizes = VerifyHelper();
+    Alignments.clear();
+  }
+};
+
+} // namespace model
@@ -0,0 +1,43 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <vector>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+
+#include "revng/Model/Binary.h"
+#include "revng/Model/Pass/RegisterModelPass.h"
+
+/// Runs a sequence of registered model passes.
+///
+/// Consecutive passes whose ModelPassEffects do not conflict are run
+/// concurrently on the same model: none of them writes anything the others
+/// access, so the result is the same as running them in sequence. A read-only
+/// pass is skipped if it has already been run and nothing it reads has been
+/// written since.
+class ModelPassManager {
+public:
+  using Pass = RegisterModelPass::Registered;
+
+private:
+  std::vector<const Pass *> Passes;
+  unsigned Threads = 0;
+
+public:
+  /// \param Threads the maximum number of passes to run at the same time, 0
+  ///        stands for the number of hardware threads
+  explicit ModelPassManager(unsigned Threads = 0) : Threads(Threads) {}
+
+public:
+  llvm::Error add(llvm::StringRef Name);
+  void add(const Pass &ToAdd) { Passes.push_back(&ToAdd); }
+
+  /// \return the groups of passes that will run concurrently, in order
+  std::vector<std::vector<const Pass *>> schedule() const;
+
+  void run(TupleTree<model::Binary> &Model) const;
+};
@@ -5,6 +5,8 @@
 //
 
 #include <compare>
+#include <cstdint>
+#include <functional>
 #include <set>
 
 #include "llvm/ADT/Twine.h"
@@ -12,16 +14,48 @@
 
 #include "revng/Model/Binary.h"
 
+/// The parts of the model a model pass reads and writes. ModelPassManager uses
+/// them to run concurrently the passes that do not interfere with each other.
+/// By default, a pass is assumed to read and write everything.
+struct ModelPassEffects {
+public:
+  enum Part : uint8_t {
+    None = 0,
+    Functions = 1 << 0,
+    ImportedDynamicFunctions = 1 << 1,
+    TypeDefinitions = 1 << 2,
+    Segments = 1 << 3,
+    /// All the other fields of model::Binary
+    Rest = 1 << 4,
+    All = (1 << 5) - 1
+  };
+
+public:
+  uint8_t Reads = All;
+  uint8_t Writes = All;
+
+public:
+  bool isReadOnly() const { return Writes == None; }
+
+  bool conflictsWith(const ModelPassEffects &Other) const {
+    return (Writes & (Other.Reads | Other.Writes)) != 0
+           or (Other.Writes & (Reads | Writes)) != 0;
+  }
+};
+
 class RegisterModelPass {
 public:
   using ModelPass = std::function<void(TupleTree<model::Binary> &)>;
 
-private:
+public:
   struct Registered {
     std::string Name;
     std::string Description;
     ModelPass Pass;
+    ModelPassEffects Effects;
   };
+
+private:
   struct TransparentNameComparator {
     using is_transparent = std::true_type;
 
@@ -43,18 +77,25 @@ private:
 public:
   RegisterModelPass(const llvm::Twine &Name,
                     const llvm::Twine &Description,
-                    ModelPass Pass) {
-    Registered RegisteredPass{ Name.str(), Description.str(), Pass };
+                    ModelPass Pass,
+                    ModelPassEffects Effects = {}) {
+    Registered RegisteredPass{ Name.str(), Description.str(), Pass, Effects };
     auto [_, Success] = Registry->emplace(std::move(RegisteredPass));
     revng_assert(Success);
   }
 
 public:
   static const ModelPass *get(llvm::StringRef Name) {
+    if (const Registered *Pass = lookup(Name))
+      return &Pass->Pass;
+    return nullptr;
+  }
+
+  static const Registered *lookup(llvm::StringRef Name) {
     if (auto It = Registry->find(Name); It == Registry->end())
       return nullptr;
     else
-      return &It->Pass;
+      return &*It;
   }
 
   static auto passes() {
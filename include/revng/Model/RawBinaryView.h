@@ -4,16 +4,30 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <algorithm>
 #include <cstdint>
 #include <optional>
 #include <utility>
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
 
 #include "revng/Model/Binary.h"
 #include "revng/Support/Generator.h"
 #include "revng/Support/OverflowSafeInt.h"
 
+/// Map \p Path (or read the standard input, if it's "-") in memory, so that it
+/// can back a RawBinaryView or be parsed by llvm::object without copies
+inline llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
+mapBinaryFile(const llvm::Twine &Path) {
+  // A binary is never used as a C string: not requiring a null terminator lets
+  // the file be memory-mapped whatever its size
+  return llvm::MemoryBuffer::getFileOrSTDIN(Path,
+                                            /* IsText */ false,
+                                            /* RequiresNullTerminator */ false);
+}
+
 /// Provide a view onto a raw binary through the lens of the model
 class RawBinaryView {
 private:
@@ -61,10 +75,49 @@ public:
     return llvm::StringRef(reinterpret_cast<const char *>(Bytes.data()), Size);
   }
 
+  /// Fill \p Output with the bytes starting at \p Address
+  ///
+  /// Unlike getByAddress, this can also read the part of a segment that is not
+  /// backed by the file (e.g., .bss): such bytes are never materialized in
+  /// memory, they are synthesized as zeros while reading.
+  ///
+  /// \return false if the range is not entirely contained in a segment.
+  [[nodiscard]] bool read(MetaAddress Address,
+                          llvm::MutableArrayRef<uint8_t> Output) const {
+    auto [Segment, OffsetInSegment] = findOffsetInSegment(Address,
+                                                          Output.size());
+    if (Segment == nullptr)
+      return false;
+
+    uint64_t FileSize = Segment->FileSize();
+    uint64_t FromFile = 0;
+    if (OffsetInSegment < FileSize)
+      FromFile = std::min<uint64_t>(Output.size(), FileSize - OffsetInSegment);
+
+    if (FromFile != 0) {
+      auto Offset = OverflowSafeInt(Segment->StartOffset()) + OffsetInSegment;
+      if (not Offset)
+        return false;
+
+      auto MaybeData = getByOffset(*Offset, FromFile);
+      if (not MaybeData)
+        return false;
+
+      llvm::copy(*MaybeData, Output.begin());
+    }
+
+    std::fill(Output.begin() + FromFile, Output.end(), 0);
+    return true;
+  }
+
   std::optional<uint64_t>
   readInteger(MetaAddress Address, uint64_t Size, bool IsLittleEndian) const {
-    auto MaybeData = getByAddress(Address, Size);
-    if (not MaybeData)
+    uint8_t Buffer[8];
+    if (Size > sizeof(Buffer))
+      revng_abort("Unexpected read size");
+
+    llvm::MutableArrayRef<uint8_t> Bytes(Buffer, Size);
+    if (not read(Address, Bytes))
       return std::nullopt;
 
     llvm::support::endianness Endianness;
@@ -76,13 +129,13 @@ public:
 
     switch (Size) {
     case 1:
-      return (*MaybeData)[0];
+      return Bytes[0];
     case 2:
-      return llvm::support::endian::read16(MaybeData->data(), Endianness);
+      return llvm::support::endian::read16(Bytes.data(), Endianness);
     case 4:
-      return llvm::support::endian::read32(MaybeData->data(), Endianness);
+      return llvm::support::endian::read32(Bytes.data(), Endianness);
     case 8:
-      return llvm::support::endian::read64(MaybeData->data(), Endianness);
+      return llvm::support::endian::read64(Bytes.data(), Endianness);
     default:
       revng_abort("Unexpected read size");
     }
@@ -168,6 +221,9 @@ public:
 
   using SegmentDataPair = std::pair<const model::Segment &,
                                     llvm::ArrayRef<uint8_t>>;
+
+  /// \note The data of each segment references the file-backed portion only,
+  ///       the rest of the segment (up to VirtualSize) is implicitly zero.
   cppcoro::generator<SegmentDataPair> segments() const {
     for (const model::Segment &Segment : Binary.Segments()) {
       auto MaybeData = getByOffset(Segment.StartOffset(), Segment.FileSize());
@@ -4,6 +4,9 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <array>
+
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Triple.h"
 
@@ -517,7 +520,7 @@ inline llvm::StringRef getRegisterName(Values V) {
 }
 
 /// Return the size of the register in bytes
-inline uint64_t getSize(Values V) {
+constexpr inline uint64_t getSize(Values V) {
   model::Architecture::Values Architecture = getReferenceArchitecture(V);
 
   switch (V) {
@@ -609,13 +612,41 @@ constexpr size_t getCount(model::Architecture::Values Architecture) {
   });
 }
 
+namespace detail {
+
+using NameTable = std::array<llvm::StringMap<Values>,
+                             model::Architecture::Count>;
+
+/// Register names (without the architecture suffix), by reference
+/// architecture
+inline const NameTable &registerNames() {
+  static const NameTable Table = [] {
+    NameTable Result;
+    for (unsigned I = Invalid + 1; I < Count; ++I) {
+      auto Register = static_cast<Values>(I);
+      auto Architecture = getReferenceArchitecture(Register);
+      Result[Architecture][getRegisterName(Register)] = Register;
+    }
+    return Result;
+  }();
+
+  return Table;
+}
+
+inline Values lookup(const NameTable &Table,
+                     llvm::StringRef Name,
+                     model::Architecture::Values Architecture) {
+  revng_assert(Architecture < model::Architecture::Count);
+  const llvm::StringMap<Values> &Names = Table[Architecture];
+  auto It = Names.find(Name);
+  return It == Names.end() ? Invalid : It->second;
+}
+
+} // namespace detail
+
 inline Values fromRegisterName(llvm::StringRef Name,
                                model::Architecture::Values Architecture) {
-  std::string FullName = (llvm::Twine(Name) + "_"
-                          + model::Architecture::getName(Architecture))
-                           .str();
-
-  return fromName(FullName);
+  return detail::lookup(detail::registerNames(), Name, Architecture);
 }
 
 inline std::optional<unsigned> getMContextIndex(Values V) {
@@ -688,32 +719,33 @@ inline llvm::StringRef getCSVName(Values V) {
   }
 }
 
-inline Values fromCSVName(llvm::StringRef Name,
-                          model::Architecture::Values Architecture) {
-  if (Architecture == model::Architecture::x86_64) {
+namespace detail {
+
+/// CSV names, by architecture
+inline const NameTable &csvNames() {
+  static const NameTable Table = [] {
+    NameTable Result = registerNames();
+
     // TODO: handle xmm0_x86
-    if (Name == "state_0x83c0") {
-      return st0_x86;
-    } else if (Name == "state_0x8558") {
-      return xmm0_x86_64;
-    } else if (Name == "state_0x8598") {
-      return xmm1_x86_64;
-    } else if (Name == "state_0x85d8") {
-      return xmm2_x86_64;
-    } else if (Name == "state_0x8618") {
-      return xmm3_x86_64;
-    } else if (Name == "state_0x8658") {
-      return xmm4_x86_64;
-    } else if (Name == "state_0x8698") {
-      return xmm5_x86_64;
-    } else if (Name == "state_0x86d8") {
-      return xmm6_x86_64;
-    } else if (Name == "state_0x8718") {
-      return xmm7_x86_64;
+    // Registers with a dedicated CSV name are recognized only on x86-64
+    for (unsigned I = Invalid + 1; I < Count; ++I) {
+      auto Register = static_cast<Values>(I);
+      llvm::StringRef CSVName = getCSVName(Register);
+      if (CSVName != getRegisterName(Register))
+        Result[model::Architecture::x86_64][CSVName] = Register;
     }
-  }
 
-  return model::Register::fromRegisterName(Name, Architecture);
+    return Result;
+  }();
+
+  return Table;
+}
+
+} // namespace detail
+
+inline Values fromCSVName(llvm::StringRef Name,
+                          model::Architecture::Values Architecture) {
+  return detail::lookup(detail::csvNames(), Name, Architecture);
 }
 
 constexpr inline model::PrimitiveKind::Values primitiveKind(Values V) {
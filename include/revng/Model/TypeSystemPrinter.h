@@ -4,6 +4,9 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/SmallPtrSet.h"
 
 #include "revng/Model/Segment.h"
@@ -17,7 +20,10 @@ private:
   /// Visited == all the edges have already been emitted
   llvm::SmallPtrSet<const model::TypeDefinition *, 16> Visited;
   /// Map each Type to the ID of the corresponding emitted `.dot` node
-  std::map<const model::TypeDefinition *, uint64_t> NodesMap;
+  llvm::DenseMap<const model::TypeDefinition *, uint64_t> NodesMap;
+  /// If set, only the types in here are printed, along with the edges among
+  /// them
+  const llvm::DenseSet<const model::TypeDefinition *> *Filter = nullptr;
 
   /// Next free ID to assign to a node
   uint64_t NextID = 0;
@@ -69,4 +75,13 @@ public:
 
   /// Generate a graph of all the types in a given Module.
   void print(const model::Binary &Model);
+
+  /// Generate a graph of the types of \p Model that are at most \p Depth edges
+  /// away from one of \p Roots, following edges in both directions.
+  ///
+  /// Nodes are emitted while visiting, so that small portions of huge models
+  /// can be inspected without printing them whole.
+  void printNeighbourhood(const model::Binary &Model,
+                          llvm::ArrayRef<const model::TypeDefinition *> Roots,
+                          unsigned Depth);
 };
@@ -9,6 +9,7 @@
 #include <set>
 #include <type_traits>
 
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -74,9 +75,12 @@ private:
   std::map<const model::TypeDefinition *, uint64_t> SizeCache;
   std::set<const model::TypeDefinition *> InProgress;
   bool AssertOnFail = false;
-  std::map<model::Identifier, std::string> GlobalSymbols;
+  llvm::StringMap<std::string> GlobalSymbols;
   bool HasPushedTracking = false;
 
+  /// The helper this has been created from through `makeShard`, if any
+  const VerifyHelper *Parent = nullptr;
+
   // TODO: This is a hack for now, but the methods, when the Model does not
   // verify, should return an llvm::Error with the error message found by this.
   std::string ReasonBuffer;
@@ -87,6 +91,21 @@ public:
 
   ~VerifyHelper() { revng_assert(InProgress.size() == 0); }
 
+private:
+  explicit VerifyHelper(const VerifyHelper *Parent) :
+    AssertOnFail(Parent->AssertOnFail),
+    HasPushedTracking(true),
+    Parent(Parent) {}
+
+public:
+  /// Create a helper to verify part of the same model from another thread
+  ///
+  /// The shard sees the global symbols registered in this helper, which must
+  /// not change while the shard is alive, but has its own caches. It never
+  /// touches the tracking of the model: the caller is responsible for pausing
+  /// it, see `PauseTracking`.
+  VerifyHelper makeShard() const { return VerifyHelper(this); }
+
 private:
   bool hasPushedTracking() const { return HasPushedTracking; }
 
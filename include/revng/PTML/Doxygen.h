@@ -4,10 +4,14 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <cstdint>
+#include <map>
+#include <mutex>
 #include <string>
 
 #include "revng/Model/Helpers.h"
 #include "revng/PTML/Tag.h"
+#include "revng/Support/MetaAddress.h"
 
 namespace ptml {
 
@@ -56,4 +60,39 @@ std::string functionComment(const ::ptml::PTMLBuilder &B,
                             size_t Indentation,
                             size_t WrapAt);
 
+/// A cache of the comments emitted by `functionComment`.
+///
+/// Entries are keyed by the entry of the function and are reused until a hash
+/// of everything the comment is built from changes: the comment of the
+/// function, the comments, names and locations of its arguments, return values
+/// and stack arguments, and the formatting parameters. An instance is meant to
+/// be shared by all the pipes running in the same pipeline::Context, see
+/// `getOrCreateSharedObject`.
+///
+/// This class is thread-safe.
+class FunctionCommentCache {
+public:
+  static constexpr llvm::StringRef ContextName = "ptml-function-comment-cache";
+
+private:
+  struct Entry {
+    uint64_t Hash = 0;
+    std::string Comment;
+  };
+
+private:
+  std::mutex Mutex;
+  std::map<MetaAddress, Entry> Entries;
+
+public:
+  /// Same as `functionComment`, reusing the previous result for \p Function
+  /// if none of its inputs changed.
+  std::string functionComment(const ::ptml::PTMLBuilder &B,
+                              const model::Function &Function,
+                              const model::Binary &Binary,
+                              llvm::StringRef CommentIndicator,
+                              size_t Indentation,
+                              size_t WrapAt);
+};
+
 } // namespace ptml
@@ -4,12 +4,19 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <string>
+
 #include "llvm/Support/raw_ostream.h"
 
 #include "revng/PTML/Tag.h"
 
 namespace ptml {
 
+/// An output stream indenting each line it writes to another stream.
+///
+/// The output is buffered: the buffer is flushed before each change of the
+/// indentation, so that each line gets the indentation in effect when it was
+/// written. Writing directly to the underlying stream requires a flush() first.
 class PTMLIndentedOstream : public llvm::raw_ostream {
 private:
   PTMLBuilder B;
@@ -21,6 +28,9 @@ private:
   // character.
   bool TrailingNewline;
   raw_ostream &OS;
+  // The serialized indentation tag for CachedIndentDepth
+  int CachedIndentDepth = 0;
+  std::string CachedIndent;
 
 public:
   explicit PTMLIndentedOstream(llvm::raw_ostream &OS,
@@ -30,9 +40,9 @@ public:
     IndentSize(IndentSize),
     IndentDepth(0),
     TrailingNewline(false),
-    OS(OS) {
-    SetUnbuffered();
-  }
+    OS(OS) {}
+
+  ~PTMLIndentedOstream() override { flush(); }
 
   struct Scope {
   private:
@@ -46,8 +56,15 @@ public:
 
   Scope scope() { return Scope(*this); }
 
-  void indent() { IndentDepth = std::min(INT_MAX, IndentDepth + 1); }
-  void unindent() { IndentDepth = std::max(0, IndentDepth - 1); }
+  void indent() {
+    flush();
+    IndentDepth = std::min(INT_MAX, IndentDepth + 1);
+  }
+
+  void unindent() {
+    flush();
+    IndentDepth = std::max(0, IndentDepth - 1);
+  }
 
   const PTMLBuilder &getPTMLBuilder() const { return B; }
 
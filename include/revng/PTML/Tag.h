@@ -9,6 +9,7 @@
 
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/Support/raw_ostream.h"
 
 #include "revng/ADT/Concepts.h"
 #include "revng/PTML/Constants.h"
@@ -92,6 +93,28 @@ public:
 
   std::string toString() const { return open() + Content + close(); }
 
+  /// Write the tag to \p OS, without materializing it as a string first
+  void write(llvm::raw_ostream &OS) const {
+    writeOpen(OS);
+    OS << Content;
+    writeClose(OS);
+  }
+
+  void writeOpen(llvm::raw_ostream &OS) const {
+    if (TheTag.empty())
+      return;
+
+    OS << '<' << TheTag;
+    for (auto &Pair : Attributes)
+      OS << ' ' << Pair.first() << "=\"" << Pair.second << '"';
+    OS << '>';
+  }
+
+  void writeClose(llvm::raw_ostream &OS) const {
+    if (not TheTag.empty())
+      OS << "</" << TheTag << '>';
+  }
+
   void dump() const debug_function { dump(dbg); }
 
   template<typename T>
@@ -113,7 +136,7 @@ inline std::string operator+(const Tag &LHS, const Tag &RHS) {
 }
 
 inline llvm::raw_ostream &operator<<(llvm::raw_ostream &OS, const Tag &TheTag) {
-  OS << TheTag.toString();
+  TheTag.write(OS);
   return OS;
 }
 
@@ -137,7 +160,7 @@ private:
 private:
   ScopeTag(llvm::raw_ostream &OS, const Tag &TheTag, bool Newline) :
     OS(OS), TagClose(TheTag.close()) {
-    OS << TheTag.open();
+    TheTag.writeOpen(OS);
     if (Newline)
       OS << "\n";
   }
@@ -151,6 +174,87 @@ inline ScopeTag Tag::scope(llvm::raw_ostream &OS, bool Newline) const {
   return ScopeTag(OS, *this, Newline);
 }
 
+/// Writes a tag straight into a stream, without building it in memory first
+///
+/// Unlike `Tag`, this never allocates: the opening tag is written at
+/// construction, attributes are written in the order they are added and
+/// `finish` writes the content along with the closing tag.
+/// \code{.cpp}
+/// B.writeTag(Out, tags::Span)
+///   .addAttribute(attributes::Token, tokens::Comment)
+///   .finish("Foo");
+/// \endcode
+/// \note the tag name must outlive the writer, this is meant to be used with
+///       the names in `PTML/Constants.h`. Attributes are not deduplicated.
+class TagWriter {
+private:
+  llvm::raw_ostream &OS;
+  llvm::StringRef TheTag;
+  bool Finished = false;
+
+  friend class PTMLBuilder;
+
+private:
+  TagWriter(llvm::raw_ostream &OS, llvm::StringRef TheTag) :
+    OS(OS), TheTag(TheTag) {
+    if (not TheTag.empty())
+      OS << '<' << TheTag;
+  }
+
+public:
+  TagWriter(const TagWriter &) = delete;
+  TagWriter &operator=(const TagWriter &) = delete;
+
+  ~TagWriter() { revng_assert(Finished); }
+
+public:
+  TagWriter &addAttribute(llvm::StringRef Name, llvm::StringRef Value) {
+    revng_assert(not Finished);
+    if (not TheTag.empty())
+      OS << ' ' << Name << "=\"" << Value << '"';
+    return *this;
+  }
+
+  template<range_with_value_type<llvm::StringRef> T>
+  TagWriter &addListAttribute(llvm::StringRef Name, const T &Values) {
+    revng_assert(not Finished);
+    if (TheTag.empty())
+      return *this;
+
+    OS << ' ' << Name << "=\"";
+    bool First = true;
+    for (auto &Value : Values) {
+      revng_check(!llvm::StringRef(Value).contains(","));
+      if (not First)
+        OS << ',';
+      OS << Value;
+      First = false;
+    }
+    OS << '"';
+    return *this;
+  }
+
+  template<typename... T>
+    requires(std::is_convertible_v<T, llvm::StringRef> and ...)
+  TagWriter &addListAttribute(llvm::StringRef Name, const T &...Value) {
+    std::initializer_list<llvm::StringRef> Values = { Value... };
+    return this->addListAttribute(Name, Values);
+  }
+
+  /// Terminate the opening tag, then write \p Content and the closing tag
+  void finish(llvm::StringRef Content = "") {
+    revng_assert(not Finished);
+    Finished = true;
+
+    if (TheTag.empty()) {
+      OS << Content;
+      return;
+    }
+
+    OS << '>' << Content << "</" << TheTag << '>';
+  }
+};
+
 class PTMLBuilder {
 private:
   const bool GenerateTagLessPTML;
@@ -168,6 +272,20 @@ public:
   ptml::Tag scopeTag(const llvm::StringRef AttributeName) const;
   ptml::Tag tokenTag(const llvm::StringRef Str,
                      const llvm::StringRef Token) const;
+
+  /// \see TagWriter
+  ptml::TagWriter writeTag(llvm::raw_ostream &OS, llvm::StringRef Tag) const {
+    return ptml::TagWriter(OS, GenerateTagLessPTML ? "" : Tag);
+  }
+
+  /// Same as `OS << tokenTag(Str, Token)`, without any intermediate string
+  void writeToken(llvm::raw_ostream &OS,
+                  llvm::StringRef Str,
+                  llvm::StringRef Token) const {
+    writeTag(OS, ptml::tags::Span)
+      .addAttribute(ptml::attributes::Token, Token)
+      .finish(Str);
+  }
 };
 
 } // namespace ptml
@@ -0,0 +1,94 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <memory>
+#include <string>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "revng/Storage/Path.h"
+#include "revng/Storage/StorageClient.h"
+
+namespace pipeline {
+
+/// A content-addressed cache of the results of pipes.
+///
+/// Each entry is identified by a hash of everything that can affect the outcome
+/// of running a pipe: the pipe itself, the targets it has been asked to
+/// produce, the content of the containers it runs on and the content of the
+/// globals. Since the key does not depend on the workspace, a single cache can
+/// be shared by multiple pipelines, possibly through a remote StorageClient.
+///
+/// Each entry is a directory holding the containers produced by the pipe along
+/// with the invalidation metadata of the committed targets, see `Step::run`.
+class ArtifactCache {
+public:
+  /// Incrementally computes the key of a cache entry
+  class KeyBuilder : public llvm::raw_ostream {
+  private:
+    llvm::SHA1 Hasher;
+    uint64_t Position = 0;
+
+  public:
+    KeyBuilder() { SetUnbuffered(); }
+    ~KeyBuilder() override = default;
+
+  public:
+    /// Add a length-prefixed string, so that consecutive fields cannot be
+    /// confused with one another
+    void addField(llvm::StringRef Field) {
+      *this << Field.size() << ':' << Field;
+    }
+
+    std::string finalize() { return llvm::toHex(Hasher.final(), true); }
+
+  private:
+    void write_impl(const char *Ptr, size_t Size) override {
+      Hasher.update(llvm::StringRef(Ptr, Size));
+      Position += Size;
+    }
+
+    uint64_t current_pos() const override { return Position; }
+  };
+
+private:
+  static constexpr llvm::StringRef CompleteMarkerName = "complete";
+
+private:
+  std::unique_ptr<revng::StorageClient> Client;
+  revng::DirectoryPath Root;
+  std::string ComponentsHash;
+
+public:
+  explicit ArtifactCache(revng::DirectoryPath Root);
+
+  static llvm::Expected<std::unique_ptr<ArtifactCache>>
+  fromPathOrURL(llvm::StringRef URL);
+
+public:
+  /// \note the returned builder is already seeded with the version of revng,
+  ///       so that entries produced by different versions never match
+  std::unique_ptr<KeyBuilder> makeKeyBuilder() const;
+
+  revng::DirectoryPath getEntry(llvm::StringRef Key) const {
+    return Root.getDirectory(Key);
+  }
+
+  /// \return true if the entry has been completely written
+  llvm::Expected<bool> contains(llvm::StringRef Key) const;
+
+  /// Create the directory of an entry, before populating it
+  llvm::Expected<revng::DirectoryPath> createEntry(llvm::StringRef Key) const;
+
+  /// Mark an entry as completely populated and make it visible to other
+  /// users of the cache
+  llvm::Error markComplete(llvm::StringRef Key);
+};
+
+} // namespace pipeline
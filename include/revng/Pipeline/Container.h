@@ -123,6 +123,18 @@ public:
   /// loaded from the provided path.
   virtual llvm::Error load(const revng::FilePath &Path);
 
+  /// Drop the in-memory content of the container, which must have just been
+  /// stored to \p Path. The content is expected to be loaded back from \p Path
+  /// the first time it is accessed.
+  ///
+  /// \return true if the container supports releasing its content.
+  virtual bool release(const revng::FilePath &Path) { return false; }
+
+  /// \return an estimate of the number of bytes of memory used by the content
+  ///         of this container. The estimate is meant to compare containers
+  ///         with each other, not to be exact.
+  virtual uint64_t memoryUsage() const { return 0; }
+
   /// Checks that the content of the this container is valid.
   virtual llvm::Error verify() const { return enumerate().verify(*this); }
 
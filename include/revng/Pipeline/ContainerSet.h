@@ -160,6 +160,15 @@ public:
   llvm::Error store(const revng::DirectoryPath &DirectoryPath) const;
   llvm::Error load(const revng::DirectoryPath &DirectoryPath);
 
+  /// \return the sum of the memoryUsage of all the containers
+  uint64_t memoryUsage() const;
+
+  /// Release the in-memory content of the containers, which must have just
+  /// been stored to \p DirectoryPath, see ContainerBase::release
+  ///
+  /// \return the number of released containers
+  size_t release(const revng::DirectoryPath &DirectoryPath);
+
   std::vector<revng::FilePath>
   getWrittenFiles(const revng::DirectoryPath &DirectoryPath) const;
 
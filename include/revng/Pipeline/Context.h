@@ -4,7 +4,9 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <atomic>
 #include <initializer_list>
+#include <memory>
 
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallVector.h"
@@ -20,6 +22,7 @@
 #include "revng/Pipeline/Global.h"
 #include "revng/Pipeline/GlobalsMap.h"
 #include "revng/Pipeline/KindsRegistry.h"
+#include "revng/Pipeline/TargetCosts.h"
 #include "revng/Storage/Path.h"
 #include "revng/Support/Assert.h"
 
@@ -28,6 +31,11 @@ namespace pipeline {
 extern Logger<> ExplanationLogger;
 extern Logger<> CommandLogger;
 
+class ArtifactCache;
+class EventLog;
+class ProductionProgress;
+class Profiler;
+
 /// A class that contains every object that has a lifetime longer than a
 /// pipeline.
 ///
@@ -38,11 +46,20 @@ private:
   GlobalsMap Globals;
   uint64_t CommitIndex = 0;
   llvm::StringMap<std::any> Contexts;
+  llvm::StringMap<std::shared_ptr<void>> SharedObjects;
   KindsRegistry TheKindRegistry;
 
   llvm::StringMap<const pipeline::ContainerSet::value_type *>
     ReadOnlyContainers;
 
+  ArtifactCache *Cache = nullptr;
+  Profiler *TheProfiler = nullptr;
+  ProductionProgress *Progress = nullptr;
+  EventLog *Events = nullptr;
+  TargetCosts Costs;
+  const std::atomic<bool> *CancellationFlag = nullptr;
+  bool ReadTracking = true;
+
 private:
   explicit Context(KindsRegistry Registry) :
     TheKindRegistry(std::move(Registry)) {}
@@ -98,6 +115,21 @@ public:
     return Casted;
   }
 
+  /// Get the object of type T called \p Name, creating it on first use.
+  ///
+  /// Shared objects are owned by the context and let pipes reuse the results
+  /// of expensive computations that do not belong to any container (e.g.,
+  /// caches).
+  ///
+  /// \note the same \p Name must always be requested with the same type.
+  template<typename T>
+  T &getOrCreateSharedObject(llvm::StringRef Name) {
+    std::shared_ptr<void> &Slot = SharedObjects[Name];
+    if (Slot == nullptr)
+      Slot = std::make_shared<T>();
+    return *static_cast<T *>(Slot.get());
+  }
+
   const GlobalsMap &getGlobals() const { return Globals; }
   GlobalsMap &getGlobals() { return Globals; }
 
@@ -123,6 +155,51 @@ public:
     return *llvm::cast<ContainerType>(ToReturn);
   }
 
+public:
+  /// Set the cache pipes consult before running, see Step::run. The cache is
+  /// not owned by the context and must outlive it.
+  void setArtifactCache(ArtifactCache *NewCache) { Cache = NewCache; }
+  ArtifactCache *getArtifactCache() const { return Cache; }
+
+  /// Set the profiler recording the cost of each step and pipe. The profiler is
+  /// not owned by the context and must outlive it.
+  void setProfiler(Profiler *NewProfiler) { TheProfiler = NewProfiler; }
+  Profiler *getProfiler() const { return TheProfiler; }
+
+  /// Set the tracker of the targets committed by the running pipe. The
+  /// tracker is not owned by the context and must outlive it.
+  void setProgress(ProductionProgress *NewProgress) { Progress = NewProgress; }
+  ProductionProgress *getProgress() const { return Progress; }
+
+  /// Set the log of the targets invalidated and produced and of the changes
+  /// to the globals. The log is not owned by the context and must outlive it.
+  void setEventLog(EventLog *NewEvents) { Events = NewEvents; }
+  EventLog *getEventLog() const { return Events; }
+
+  /// The average cost of producing targets, recorded every time a pipe runs
+  /// and stored together with the context
+  TargetCosts &getTargetCosts() { return Costs; }
+  const TargetCosts &getTargetCosts() const { return Costs; }
+
+  /// Set the flag polled between steps, pipes and functions to stop running as
+  /// soon as possible. The flag is not owned by the context and must outlive
+  /// it.
+  void setCancellationFlag(const std::atomic<bool> *Flag) {
+    CancellationFlag = Flag;
+  }
+
+  bool isCancellationRequested() const {
+    return CancellationFlag != nullptr and CancellationFlag->load();
+  }
+
+  /// Enable or disable tracking the fields of the globals read to produce each
+  /// target. Without tracking, no invalidation metadata is recorded nor stored
+  /// and any change to a global invalidates everything that has been produced.
+  /// This is meant for runs that (almost) never change the globals after
+  /// producing targets, such as batch ones.
+  void setReadTracking(bool Enable) { ReadTracking = Enable; }
+  bool isReadTrackingEnabled() const { return ReadTracking; }
+
 public:
   llvm::Error store(const revng::DirectoryPath &Path) const;
   llvm::Error load(const revng::DirectoryPath &Path);
@@ -130,12 +207,28 @@ public:
 public:
   void collectReadFields(const TargetInContainer &Target,
                          llvm::StringMap<PathTargetBimap> &Out) const {
-    Globals.collectReadFields(Target, Out);
+    if (ReadTracking)
+      Globals.collectReadFields(Target, Out);
   }
 
-  void clearAndResume() const { Globals.clearAndResume(); }
-  void pushReadFields() const { Globals.pushReadFields(); }
-  void popReadFields() const { Globals.popReadFields(); }
-  void stopTracking() const { Globals.stopTracking(); }
+  void clearAndResume() const {
+    if (ReadTracking)
+      Globals.clearAndResume();
+  }
+
+  void pushReadFields() const {
+    if (ReadTracking)
+      Globals.pushReadFields();
+  }
+
+  void popReadFields() const {
+    if (ReadTracking)
+      Globals.popReadFields();
+  }
+
+  void stopTracking() const {
+    if (ReadTracking)
+      Globals.stopTracking();
+  }
 };
 } // namespace pipeline
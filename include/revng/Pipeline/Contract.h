@@ -4,7 +4,9 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <map>
 #include <string>
+#include <utility>
 
 #include "llvm/ADT/ArrayRef.h"
 
@@ -147,6 +149,36 @@ private:
 /// A group contract is the way contracts can be composed.
 /// All subcontracts inside a group contract are evaluated in parallel on the
 /// same input and their output is merged.
+/// While an instance of this class is alive, the contracts evaluated by the
+/// current thread enumerate all the targets of each kind only once.
+///
+/// Enumerating all the targets of a kind (e.g., all the functions in the model)
+/// is the most expensive part of evaluating a contract, and planning a request
+/// evaluates the contracts of every pipe of every step involved. Since the
+/// pipeline does not run while planning, the enumeration cannot change.
+///
+/// \note a scope must not be alive while pipes run, since they can change the
+///       set of targets of a kind (e.g., by adding functions to the model).
+///       Nested scopes reuse the outermost one.
+class ContractEvaluationScope {
+private:
+  using Key = std::pair<const Context *, const Kind *>;
+  std::map<Key, TargetsList> AllTargets;
+
+public:
+  ContractEvaluationScope();
+  ~ContractEvaluationScope();
+
+  ContractEvaluationScope(const ContractEvaluationScope &) = delete;
+  ContractEvaluationScope &operator=(const ContractEvaluationScope &) = delete;
+
+public:
+  /// \return all the targets of \p K. If no scope is active, they are
+  ///         enumerated in \p Storage.
+  static const TargetsList &
+  allTargets(const Context &Context, const Kind &K, TargetsList &Storage);
+};
+
 class ContractGroup {
 public:
   static constexpr auto Erase = InputPreservation::Erase;
@@ -0,0 +1,104 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace pipeline {
+
+class Target;
+
+/// A fine-grained change in the state of the pipeline
+struct PipelineEvent {
+public:
+  enum KindType {
+    /// A target that had been produced is no longer available
+    TargetInvalidated,
+    /// A target has been produced
+    TargetProduced,
+    /// The object at Path within a global has changed
+    GlobalChanged
+  };
+
+public:
+  /// Increasing, without gaps, across all the events of a log
+  uint64_t Sequence = 0;
+  KindType Kind = TargetInvalidated;
+  /// Only for target events
+  std::string Step;
+  std::string Container;
+  std::string Target;
+  /// Only for GlobalChanged. The path is empty if it cannot be represented as
+  /// a string.
+  std::string Global;
+  std::string Path;
+
+public:
+  static llvm::StringRef kindName(KindType Kind);
+};
+
+/// The events of a log starting from a given sequence number
+struct EventBatch {
+  /// The sequence number to ask for to get the following events
+  uint64_t Next = 0;
+  /// True if some of the requested events have been dropped from the log, in
+  /// which case the client should get the whole state from scratch
+  bool Truncated = false;
+  std::vector<PipelineEvent> Events;
+
+public:
+  /// Emit the batch as a JSON object
+  void dump(llvm::raw_ostream &OS) const;
+};
+
+/// An ordered log of the targets invalidated and produced and of the changes
+/// to the globals, which allows clients to update only what changed, rather
+/// than requesting again everything they display after each operation.
+///
+/// Clients keep track of the sequence number of the next event they expect
+/// and ask for the events starting from it. Only the most recent events are
+/// kept.
+///
+/// \note Events can be read from any thread while the pipeline is running.
+class EventLog {
+public:
+  static constexpr size_t DefaultCapacity = 1 << 16;
+
+private:
+  mutable std::mutex Mutex;
+  std::deque<PipelineEvent> Events;
+  uint64_t NextSequence = 0;
+  size_t Capacity;
+
+public:
+  explicit EventLog(size_t Capacity = DefaultCapacity) : Capacity(Capacity) {}
+
+public:
+  void targetInvalidated(llvm::StringRef Step,
+                         llvm::StringRef Container,
+                         const Target &Invalidated);
+  void targetProduced(llvm::StringRef Step,
+                      llvm::StringRef Container,
+                      const Target &Produced);
+  void globalChanged(llvm::StringRef Global, llvm::StringRef Path);
+
+public:
+  uint64_t nextSequence() const;
+
+  /// \return the events with sequence number \p Sequence or later
+  EventBatch since(uint64_t Sequence) const;
+
+private:
+  void push(PipelineEvent &&Event);
+};
+
+} // namespace pipeline
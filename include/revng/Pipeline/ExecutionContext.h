@@ -11,6 +11,7 @@
 #include "revng/Pipeline/Container.h"
 #include "revng/Pipeline/Context.h"
 #include "revng/Pipeline/Target.h"
+#include "revng/Support/Deadline.h"
 #include "revng/Support/Generator.h"
 
 namespace pipeline {
@@ -70,6 +71,10 @@ concept IsTargetToGlobal = requires {
 //   }
 // }
 //
+// While an execution context is alive, the deadline set by -pipe-deadline is
+// active: the analyses polling it (see revng/Support/Deadline.h) return a
+// partial result once it expires.
+//
 class ExecutionContext {
 private:
   Context *TheContext = nullptr;
@@ -78,6 +83,7 @@ private:
   ContainerToTargetsMap Committed;
   // false when running on a analysis
   bool RunningOnPipe = true;
+  revng::DeadlineScope Deadline;
 
 public:
   ~ExecutionContext();
@@ -150,6 +156,10 @@ public:
   /// Verifies all the requested targets have been committed
   void verify() const;
 
+  /// \return true if some analysis returned a partial result since the
+  ///         deadline expired
+  bool hasPartialResults() const { return Deadline.hasExpired(); }
+
 public:
   const Context &getContext() const { return *TheContext; }
   Context &getContext() { return *TheContext; }
@@ -4,6 +4,7 @@
 //
 
 #include <any>
+#include <concepts>
 #include <memory>
 #include <type_traits>
 
@@ -16,6 +17,7 @@
 #include "revng/Pipeline/PathTargetBimap.h"
 #include "revng/Storage/Path.h"
 #include "revng/Support/YAMLTraits.h"
+#include "revng/TupleTree/ConcurrentDeserialization.h"
 #include "revng/TupleTree/Tracking.h"
 #include "revng/TupleTree/TupleTreeDiff.h"
 
@@ -51,6 +53,14 @@ public:
   diffFromString(llvm::StringRef String) = 0;
 
   virtual bool verify() const = 0;
+
+  /// Verify the global after \p Diff has been applied to it, assuming it
+  /// verified before: implementations can limit the verification to the parts
+  /// affected by the diff
+  virtual bool verifyAfterDiff(const GlobalTupleTreeDiff &Diff) const {
+    return verify();
+  }
+
   virtual void clear() = 0;
 
   virtual llvm::Expected<std::unique_ptr<Global>>
@@ -75,6 +85,23 @@ public:
   virtual void stopTracking() const = 0;
 };
 
+namespace detail {
+
+/// Objects can provide an incremental verification by declaring a
+/// `verifyAfterDiff` function next to them (found through ADL)
+template<typename T>
+concept HasVerifyAfterDiff = requires(const T &Object,
+                                      const TupleTreeDiff<T> &Diff) {
+  { verifyAfterDiff(Object, Diff) } -> std::same_as<bool>;
+};
+
+template<HasVerifyAfterDiff T>
+bool callVerifyAfterDiff(const T &Object, const TupleTreeDiff<T> &Diff) {
+  return verifyAfterDiff(Object, Diff);
+}
+
+} // namespace detail
+
 template<TupleTreeCompatibleAndVerifiable Object>
 class TupleTreeGlobal : public Global {
 private:
@@ -98,11 +125,19 @@ public:
 
   static bool classof(const Global *T) { return T->getID() == &getID(); }
 
+private:
+  static llvm::ErrorOr<TupleTree<Object>> parse(llvm::StringRef String) {
+    if constexpr (TraitedTupleLike<Object>)
+      return concurrentlyFromString<Object>(String);
+    else
+      return TupleTree<Object>::fromString(String);
+  }
+
 public:
   llvm::Expected<std::unique_ptr<Global>>
   createNew(llvm::StringRef Name,
             const llvm::MemoryBuffer &Buffer) const override {
-    auto MaybeTree = TupleTree<Object>::fromString(Buffer.getBuffer());
+    auto MaybeTree = parse(Buffer.getBuffer());
     if (!MaybeTree)
       return llvm::errorCodeToError(MaybeTree.getError());
     return std::make_unique<TupleTreeGlobal>(Name, MaybeTree.get());
@@ -124,7 +159,7 @@ public:
   }
 
   llvm::Error fromString(llvm::StringRef String) override {
-    auto MaybeTupleTree = TupleTree<Object>::fromString(String);
+    auto MaybeTupleTree = parse(String);
     if (!MaybeTupleTree)
       return llvm::errorCodeToError(MaybeTupleTree.getError());
 
@@ -148,6 +183,15 @@ public:
 
   bool verify() const override { return Value->verify(); }
 
+  bool verifyAfterDiff(const GlobalTupleTreeDiff &Diff) const override {
+    if constexpr (detail::HasVerifyAfterDiff<Object>) {
+      if (const TupleTreeDiff<Object> *ObjectDiff = Diff.getAs<Object>())
+        return detail::callVerifyAfterDiff(*Value, *ObjectDiff);
+    }
+
+    return verify();
+  }
+
   GlobalTupleTreeDiff diff(const Global &Other) const override {
     const TupleTreeGlobal &Casted = llvm::cast<TupleTreeGlobal>(Other);
     auto Diff = ::diff(*Value, *Casted.Value);
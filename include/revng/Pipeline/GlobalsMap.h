@@ -27,6 +27,27 @@ public:
     return ToReturn;
   }
 
+  /// Apply \p Diffs, as produced by diff(), to the globals of this map
+  ///
+  /// This is the cheap way to bring a copy of the globals up to date: its cost
+  /// is proportional to the changes, while making a new copy is proportional
+  /// to the size of the globals.
+  llvm::Error applyDiffs(const DiffMap &Diffs) {
+    for (const auto &Entry : Diffs) {
+      if (Entry.second.isEmpty())
+        continue;
+
+      auto MaybeGlobal = get(Entry.first());
+      if (not MaybeGlobal)
+        return MaybeGlobal.takeError();
+
+      if (auto Error = MaybeGlobal.get()->applyDiff(Entry.second); Error)
+        return Error;
+    }
+
+    return llvm::Error::success();
+  }
+
 private:
   static const Global *
   dereferenceIterator(const MapType::const_iterator::value_type &Pair) {
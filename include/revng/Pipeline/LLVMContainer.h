@@ -29,7 +29,23 @@ private:
   using ThisType = LLVMContainer;
 
 private:
-  std::unique_ptr<llvm::Module> Module;
+  mutable std::unique_ptr<llvm::Module> Module;
+
+  /// Serialized module read by `load` and not parsed yet.
+  ///
+  /// Loading a pipeline loads all the containers of all the steps, but a
+  /// request usually touches only a few of them: parsing is deferred until
+  /// the module is actually accessed, and serializing a container that has
+  /// never been accessed just writes back the original buffer.
+  mutable std::unique_ptr<llvm::MemoryBuffer> Serialized;
+
+  /// The file `Serialized` has been loaded from. As long as the module is not
+  /// accessed, storing the container to the same file is a no-op.
+  std::optional<revng::FilePath> LoadedFrom;
+
+  /// The module has been released, see `release`: it has to be read back from
+  /// `LoadedFrom` before being parsed.
+  mutable bool Released = false;
 
 public:
   inline static const llvm::StringRef MIMEType = "text/x.llvm.ir";
@@ -55,8 +71,15 @@ public:
   }
 
 public:
-  const llvm::Module &getModule() const { return *Module; }
-  llvm::Module &getModule() { return *Module; }
+  const llvm::Module &getModule() const {
+    materialize();
+    return *Module;
+  }
+
+  llvm::Module &getModule() {
+    materialize();
+    return *Module;
+  }
 
 public:
   std::unique_ptr<ContainerBase>
@@ -70,13 +93,39 @@ public:
 
   llvm::Error deserialize(const llvm::MemoryBuffer &Buffer) final;
 
+  /// Unlike `deserialize`, the module is parsed only when it is first
+  /// accessed: the files of a pipeline are the product of a previous
+  /// `store`, and are therefore expected to be valid.
+  llvm::Error load(const revng::FilePath &Path) final;
+
+  /// Skips writing if the container has not been accessed since it has been
+  /// loaded from \p Path.
+  llvm::Error store(const revng::FilePath &Path) const final;
+
+  /// Drops both the module and its serialized form: the module will be read
+  /// back from \p Path and parsed the first time it is accessed.
+  bool release(const revng::FilePath &Path) final;
+
+  /// As long as the module has not been parsed, this is the size of its
+  /// serialized form.
+  uint64_t memoryUsage() const final;
+
   void clear() final {
+    Serialized.reset();
+    LoadedFrom.reset();
+    Released = false;
     Module = std::make_unique<llvm::Module>("revng.module",
                                             Module->getContext());
   }
 
 private:
   void mergeBackImpl(ThisType &&OtherContainer) final;
+
+  /// Parse the pending serialized module, if any
+  void materialize() const;
+
+  /// Read back the serialized module, if it has been released
+  void reload() const;
 };
 
 } // namespace pipeline
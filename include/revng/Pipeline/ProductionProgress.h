@@ -0,0 +1,83 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace pipeline {
+
+/// The state of the production of targets at a given point in time
+struct ProgressSnapshot {
+  bool Running = false;
+  std::string Step;
+  std::string Pipe;
+  uint64_t DoneTargets = 0;
+  uint64_t TotalTargets = 0;
+  /// Targets committed per second, over the most recent commits
+  double TargetsPerSecond = 0;
+  /// Estimated time to commit the remaining targets of the current pipe, if
+  /// there's enough information to tell
+  std::optional<double> RemainingSeconds;
+
+public:
+  /// Emit the snapshot as a JSON object
+  void dump(llvm::raw_ostream &OS) const;
+};
+
+/// Tracks the progress of the pipe currently running, counting the targets it
+/// commits.
+///
+/// The throughput is computed over a window of the most recent commits, so
+/// that the estimate adapts to targets of different size. Until at least two
+/// commits have been observed, the estimate is based on the average cost of
+/// a target recorded in TargetCosts, if any.
+///
+/// \note The snapshot can be taken from any thread while a pipe is running.
+class ProductionProgress {
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Sample {
+    Clock::time_point Time;
+    uint64_t DoneTargets = 0;
+  };
+
+  static constexpr size_t WindowSize = 32;
+
+private:
+  mutable std::mutex Mutex;
+  ProgressSnapshot Current;
+  std::deque<Sample> Window;
+  /// The average cost of a target of the current pipe, in seconds
+  std::optional<double> ExpectedCost;
+
+public:
+  /// Start tracking a pipe of \p StepName expected to commit \p TotalTargets
+  /// targets, each taking \p ExpectedCost seconds, if known
+  void startPipe(llvm::StringRef StepName,
+                 llvm::StringRef PipeName,
+                 uint64_t TotalTargets,
+                 std::optional<double> ExpectedCost);
+
+  /// Record that \p Count targets have been committed by the current pipe
+  void advance(uint64_t Count = 1);
+
+  void endPipe();
+
+  ProgressSnapshot snapshot() const;
+
+private:
+  void updateEstimate();
+};
+
+} // namespace pipeline
@@ -0,0 +1,100 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "revng/Support/PerfCounters.h"
+
+namespace pipeline {
+/// Collects the cost of running each analysis, step and pipe.
+/// Collects the cost of running each step and pipe.
+///
+/// Events are exported in the Chrome trace-event format, which can be loaded in
+/// chrome://tracing or in Perfetto. Pipe events are nested in the event of the
+/// step they belong to and report, in their arguments, the CPU time, the
+/// growth of the peak resident set size and the number of targets requested
+/// and produced. Pipes writing LLVM modules also report their size, in
+/// functions and instructions, after running. If -perf-counters is enabled,
+/// they also report the hardware performance counters measured on the thread
+/// running them.
+class Profiler {
+public:
+  struct Event {
+    std::string Name;
+    std::string Category;
+    /// Microseconds since the creation of the profiler
+    uint64_t Start = 0;
+    uint64_t WallTime = 0;
+    uint64_t CPUTime = 0;
+    /// Growth of the peak resident set size, in KiB
+    uint64_t PeakRSSDelta = 0;
+    uint64_t InputTargets = 0;
+    uint64_t OutputTargets = 0;
+    bool FromCache = false;
+    /// Size of the LLVM modules written by the pipe, once it has run
+    bool HasIRSize = false;
+    uint64_t IRFunctions = 0;
+    uint64_t IRInstructions = 0;
+    bool HasPerfCounters = false;
+    revng::PerfCounterValues PerfCounters;
+  };
+
+  /// Measures the lifetime of an object and records it as an event
+  class Scope {
+  private:
+    Profiler *TheProfiler = nullptr;
+    Event TheEvent;
+    uint64_t StartCPUTime = 0;
+    uint64_t StartPeakRSS = 0;
+    revng::PerfCounterValues StartPerfCounters;
+
+  public:
+    /// \p TheProfiler can be nullptr, in which case nothing is recorded
+    Scope(Profiler *TheProfiler,
+          llvm::StringRef Category,
+          llvm::StringRef Name,
+          uint64_t InputTargets = 0);
+    ~Scope();
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  public:
+    void setOutputTargets(uint64_t Count) { TheEvent.OutputTargets = Count; }
+    void setFromCache() { TheEvent.FromCache = true; }
+    void addIRSize(uint64_t Functions, uint64_t Instructions) {
+      TheEvent.HasIRSize = true;
+      TheEvent.IRFunctions += Functions;
+      TheEvent.IRInstructions += Instructions;
+    }
+  };
+
+private:
+  using Clock = std::chrono::steady_clock;
+  Clock::time_point Origin;
+  std::vector<Event> Events;
+
+public:
+  Profiler() : Origin(Clock::now()), Events() {}
+
+public:
+  const std::vector<Event> &events() const { return Events; }
+  void clear() { Events.clear(); }
+
+  /// Emit the recorded events as a Chrome trace-event JSON document
+  void emitChromeTrace(llvm::raw_ostream &OS) const;
+
+private:
+  uint64_t now() const;
+};
+
+} // namespace pipeline
@@ -20,6 +20,7 @@
 #include "revng/Pipeline/KindsRegistry.h"
 #include "revng/Pipeline/Step.h"
 #include "revng/Pipeline/Target.h"
+#include "revng/Pipeline/TargetCosts.h"
 #include "revng/Storage/Path.h"
 #include "revng/Support/Debug.h"
 
@@ -77,6 +78,13 @@ public:
   void getDiffInvalidations(const GlobalTupleTreeDiff &Diff,
                             pipeline::TargetInStepSet &Out) const;
 
+  /// Compute, without applying \p Diff, all the targets it would invalidate
+  /// (including the propagations) and estimate the cost of producing them
+  /// again, based on the costs recorded in the context.
+  llvm::Expected<CostEstimate>
+  estimateInvalidations(const GlobalTupleTreeDiff &Diff,
+                        pipeline::TargetInStepSet &Map) const;
+
 public:
   Step &operator[](llvm::StringRef Name) { return getStep(Name); }
   const Step &operator[](llvm::StringRef Name) const { return getStep(Name); }
@@ -185,6 +193,30 @@ public:
               pipeline::TargetInStepSet &InvalidationsMap,
               const llvm::StringMap<std::string> &Options = {});
 
+private:
+  /// Produce \p Targets in \p StepName and run \p AnalysisName on them,
+  /// without computing the diff of the globals nor invalidating anything
+  llvm::Error executeAnalysis(llvm::StringRef AnalysisName,
+                              llvm::StringRef StepName,
+                              const ContainerToTargetsMap &Targets,
+                              const llvm::StringMap<std::string> &Options);
+
+  /// \return all the targets accepted by the analysis referenced by \p Ref
+  ContainerToTargetsMap analysisTargets(const AnalysisReference &Ref);
+
+  /// Like the public runAnalysis, but \p Before is the caller-provided state of
+  /// the globals before running the analysis. Once done, \p Before is brought
+  /// up to date by applying the diff to it, so it can be reused for the next
+  /// analysis without copying the globals again.
+  llvm::Expected<DiffMap>
+  runAnalysis(llvm::StringRef AnalysisName,
+              llvm::StringRef StepName,
+              const ContainerToTargetsMap &Targets,
+              pipeline::TargetInStepSet &InvalidationsMap,
+              const llvm::StringMap<std::string> &Options,
+              GlobalsMap &Before);
+
+public:
   void addContainerFactory(llvm::StringRef Name, ContainerFactory Entry) {
     ContainerFactoriesRegistry.registerContainerFactory(Name, std::move(Entry));
   }
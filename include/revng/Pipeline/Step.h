@@ -21,6 +21,7 @@
 
 #include "revng/ADT/STLExtras.h"
 #include "revng/Pipeline/Analysis.h"
+#include "revng/Pipeline/ArtifactCache.h"
 #include "revng/Pipeline/ContainerSet.h"
 #include "revng/Pipeline/Context.h"
 #include "revng/Pipeline/Contract.h"
@@ -106,30 +107,20 @@ public:
                                   const TupleTreePath &Path,
                                   TargetInStepSet &Out,
                                   Logger<> &Log) const {
-    ContainerToTargetsMap ToInvalidateMap;
-
-    for (const PipeWrapper &Pipe : Pipes) {
-      revng_log(Log, "Handling the " << Pipe.Pipe->getName() << " pipe");
-      LoggerIndent<> Indent(Log);
-      Pipe.InvalidationMetadata.registerTargetsDependingOn(*TheContext,
-                                                           GlobalName,
-                                                           Path,
-                                                           ToInvalidateMap,
-                                                           Log);
-      Pipe.Pipe->deduceResults(*TheContext, ToInvalidateMap);
-    }
-
-    for (auto &Container : ToInvalidateMap) {
-      if (Containers.contains(Container.first())) {
-        Container.second = Container.second.intersect(Containers
-                                                        .at(Container.first())
-                                                        .enumerate());
-      }
-    }
-
+    ContainerToTargetsMap ToInvalidateMap = targetsDependingOn(GlobalName,
+                                                               Path,
+                                                               Log);
+    intersectWithContainers(ToInvalidateMap);
     Out[getName()].merge(ToInvalidateMap);
   }
 
+  /// Equivalent to invoking registerTargetsDependingOn on each path changed
+  /// by \p Diff, except that the containers are enumerated once, instead of
+  /// once per path, which dominates the cost on large diffs.
+  void registerTargetsDependingOn(const GlobalTupleTreeDiff &Diff,
+                                  TargetInStepSet &Out,
+                                  Logger<> &Log) const;
+
   bool invalidationMetadataContains(llvm::StringRef GlobalName,
                                     const TargetInContainer &Target) const {
     for (const PipeWrapper &Pipe : Pipes) {
@@ -140,9 +131,36 @@ public:
   }
 
 private:
+  ContainerToTargetsMap targetsDependingOn(llvm::StringRef GlobalName,
+                                           const TupleTreePath &Path,
+                                           Logger<> &Log) const;
+
+  /// Drop from \p Map all the targets that are not in the containers
+  void intersectWithContainers(ContainerToTargetsMap &Map) const;
+
   llvm::Error loadInvalidationMetadataImpl(const revng::DirectoryPath &Path,
                                            ContainerSet::value_type &Pair);
 
+private:
+  /// \return the key identifying the outcome of running \p Pipe on \p Input
+  std::string computeCacheKey(const ArtifactCache &Cache,
+                              const PipeWrapper &Pipe,
+                              const PipeExecutionEntry &Info,
+                              const ContainerSet &Input) const;
+
+  /// \return true if the outcome of running \p Pipe has been loaded from the
+  ///         cache into \p Input, along with its invalidation metadata
+  llvm::Expected<bool> restoreFromCache(const ArtifactCache &Cache,
+                                        llvm::StringRef Key,
+                                        PipeWrapper &Pipe,
+                                        ContainerSet &Input);
+
+  llvm::Error storeInCache(ArtifactCache &Cache,
+                           llvm::StringRef Key,
+                           const PipeWrapper &Pipe,
+                           const ContainerToTargetsMap &Committed,
+                           const ContainerSet &Input) const;
+
 private:
   llvm::Error loadInvalidationMetadata(const revng::DirectoryPath &Path);
 
@@ -273,6 +291,15 @@ public:
   ContainerSet run(ContainerSet &&Targets,
                    const std::vector<PipeExecutionEntry> &ExecutionInfos);
 
+  /// Like run, but without returning a filtered copy of the results, which is
+  /// expensive for containers such as LLVMContainer.
+  ///
+  /// \return the targets produced by this step, or std::nullopt if the
+  ///         execution has been cancelled.
+  std::optional<ContainerToTargetsMap>
+  runInPlace(ContainerSet &&Targets,
+             const std::vector<PipeExecutionEntry> &ExecutionInfos);
+
   void pipeInvalidate(const GlobalTupleTreeDiff &Diff,
                       ContainerToTargetsMap &Map) const;
 
@@ -41,33 +41,43 @@ class Context;
 /// have a relationship of containment or extension.
 /// The PathComponent list is used to tell apart objects belonging to the same
 /// Kind
+///
+/// Path components are interned: each distinct string is stored once for the
+/// lifetime of the process and is null-terminated. This makes copying targets
+/// cheap and allows to compare components for equality by address.
 class Target {
 private:
-  using PathComponents = std::vector<std::string>;
+  using PathComponents = llvm::SmallVector<llvm::StringRef, 2>;
   PathComponents Components;
   const Kind *K = nullptr;
 
 public:
-  Target(PathComponents Components, const Kind &K) :
-    Components(std::move(Components)), K(&K) {
+  Target(const std::vector<std::string> &Components, const Kind &K) : K(&K) {
+    for (const std::string &Component : Components)
+      this->Components.push_back(intern(Component));
     revng_assert(this->Components.size() == getKind().depth());
   }
 
-  Target(std::string PathComponent, const Kind &K) :
-    Components({ std::move(PathComponent) }), K(&K) {
+  Target(llvm::StringRef PathComponent, const Kind &K) :
+    Components({ intern(PathComponent) }), K(&K) {
     revng_assert(this->Components.size() == getKind().depth());
   }
 
+  Target(const std::string &PathComponent, const Kind &K) :
+    Target(llvm::StringRef(PathComponent), K) {}
+
+  Target(const char *PathComponent, const Kind &K) :
+    Target(llvm::StringRef(PathComponent), K) {}
+
   Target(std::initializer_list<std::string> Names, const Kind &K) : K(&K) {
-    for (auto Name : Names)
-      Components.emplace_back(Name);
+    for (const std::string &Name : Names)
+      Components.push_back(intern(Name));
     revng_assert(this->Components.size() == getKind().depth());
   }
 
   Target(llvm::ArrayRef<llvm::StringRef> Names, const Kind &K) : K(&K) {
-    for (auto Name : Names) {
-      Components.emplace_back(Name.str());
-    }
+    for (llvm::StringRef Name : Names)
+      Components.push_back(intern(Name));
     revng_assert(this->Components.size() == getKind().depth());
   }
 
@@ -81,14 +91,32 @@ public:
 
 public:
   bool operator<(const Target &Other) const {
-    auto Self = std::tie(K, Components);
-    auto OtherSelf = std::tie(Other.K, Other.Components);
-    return Self < OtherSelf;
+    if (K != Other.K)
+      return K < Other.K;
+
+    // Interned components are equal if and only if they have the same address
+    auto Less = [](llvm::StringRef Left, llvm::StringRef Right) {
+      return Left.data() != Right.data() and Left < Right;
+    };
+    return std::lexicographical_compare(Components.begin(),
+                                        Components.end(),
+                                        Other.Components.begin(),
+                                        Other.Components.end(),
+                                        Less);
   }
 
   int operator<=>(const Target &Other) const;
 
-  bool operator==(const Target &Other) const { return (*this <=> Other) == 0; }
+  bool operator==(const Target &Other) const {
+    if (K != Other.K or Components.size() != Other.Components.size())
+      return false;
+
+    for (const auto &[Left, Right] : llvm::zip(Components, Other.Components))
+      if (Left.data() != Right.data())
+        return false;
+
+    return true;
+  }
 
 public:
   const Kind &getKind() const { return *K; }
@@ -105,6 +133,12 @@ public:
 public:
   std::string toString() const;
 
+private:
+  /// \return the unique copy of \p String
+  static llvm::StringRef intern(llvm::StringRef String);
+
+public:
+
   void dump() const debug_function { dump(dbg); }
 
   template<typename OStream>
@@ -117,7 +151,7 @@ public:
   void dumpPathComponents(OStream &OS) const debug_function {
     OS << "/";
     for (const auto &Entry : Components) {
-      OS << Entry;
+      OS << Entry.str();
       if (&Entry != &Components.back())
         OS << "/";
     }
@@ -148,7 +182,11 @@ private:
 
 public:
   TargetsList() = default;
-  TargetsList(List C) : Contained(std::move(C)) {}
+  TargetsList(List C) : Contained(std::move(C)) {
+    llvm::sort(Contained);
+    Contained.erase(std::unique(Contained.begin(), Contained.end()),
+                    Contained.end());
+  }
   static TargetsList allTargets(const Context &Context, const Kind &K) {
     TargetsList ToReturn;
     K.appendAllTargets(Context, ToReturn);
@@ -182,9 +220,7 @@ public:
   bool contains(const Target &Target) const;
 
   bool contains(const TargetsList &Targets) const {
-    return llvm::all_of(Targets, [this](const Target &Target) {
-      return contains(Target);
-    });
+    return std::includes(begin(), end(), Targets.begin(), Targets.end());
   }
 
   TargetsList filter(const Kind &K) const {
@@ -200,18 +236,14 @@ public:
   template<typename... Args>
   void emplace_back(Args &&...A) {
     Contained.emplace_back(std::forward<Args>(A)...);
-    llvm::sort(Contained);
-    Contained.erase(unique(Contained.begin(), Contained.end()),
-                    Contained.end());
+    sortBack();
   }
 
   void merge(const TargetsList &Other);
 
   void push_back(const Target &Target) {
     Contained.push_back(Target);
-    llvm::sort(Contained);
-    Contained.erase(unique(Contained.begin(), Contained.end()),
-                    Contained.end());
+    sortBack();
   }
 
   template<typename... Args>
@@ -225,10 +257,14 @@ public:
   }
 
   void erase(const Target &Target) {
-    Contained.erase(std::remove(Contained.begin(), Contained.end(), Target),
-                    Contained.end());
+    auto It = std::lower_bound(Contained.begin(), Contained.end(), Target);
+    if (It != Contained.end() and *It == Target)
+      Contained.erase(It);
   }
 
+  /// Remove all the elements of \p Targets, in a single pass
+  void erase(const TargetsList &Targets);
+
   TargetsList intersect(const TargetsList &Other) const {
     TargetsList ToReturn;
     std::set_intersection(begin(),
@@ -241,6 +277,30 @@ public:
   }
 
 private:
+  /// Restores the sorted and unique invariant after a single element has been
+  /// appended.
+  ///
+  /// Targets are often added in order (e.g., committing the requested targets
+  /// of a pipe one at a time), in that case this is O(1). Otherwise, the new
+  /// element is moved into place in O(n), without sorting the whole list.
+  void sortBack() {
+    if (Contained.size() < 2)
+      return;
+
+    auto Last = std::prev(Contained.end());
+    if (*std::prev(Last) < *Last)
+      return;
+
+    auto Position = std::lower_bound(Contained.begin(), Last, *Last);
+    if (not(*Last < *Position)) {
+      // The element is already present
+      Contained.pop_back();
+      return;
+    }
+
+    std::rotate(Position, Last, Contained.end());
+  }
+
   struct Comp {
     bool operator()(const Target &T, const Kind &K) const {
       return &T.getKind() < &K;
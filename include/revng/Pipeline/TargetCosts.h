@@ -0,0 +1,73 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <cstdint>
+#include <optional>
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "revng/Pipeline/Target.h"
+#include "revng/Storage/Path.h"
+
+namespace pipeline {
+
+/// The estimated cost of producing again a set of targets
+struct CostEstimate {
+  /// Estimated wall time to produce the targets with a known cost
+  double Seconds = 0;
+  /// Number of targets
+  uint64_t Targets = 0;
+  /// Number of targets of containers that were never produced while costs
+  /// were being recorded, which do not contribute to `Seconds`
+  uint64_t UnknownTargets = 0;
+
+public:
+  void dump(llvm::raw_ostream &OS) const;
+};
+
+/// Records the average cost of producing a single target, for each container
+/// of each step.
+///
+/// The cost of each pipe that actually runs (i.e., that is not restored from
+/// the artifact cache) is split evenly among the targets it produces. The
+/// costs are used to estimate how long it would take to produce again the
+/// targets invalidated by a change, before applying it.
+class TargetCosts {
+private:
+  struct Entry {
+    double Seconds = 0;
+    uint64_t Targets = 0;
+  };
+
+private:
+  /// Step name -> container name -> cost
+  llvm::StringMap<llvm::StringMap<Entry>> Costs;
+
+public:
+  /// Record that producing \p Produced in \p StepName took \p Seconds
+  void record(llvm::StringRef StepName,
+              const ContainerToTargetsMap &Produced,
+              double Seconds);
+
+  /// \return the average cost, in seconds, of producing a target of
+  ///         \p ContainerName in \p StepName, if it has ever been recorded
+  std::optional<double> averageCost(llvm::StringRef StepName,
+                                    llvm::StringRef ContainerName) const;
+
+  CostEstimate estimate(const TargetInStepSet &Targets) const;
+
+  bool empty() const { return Costs.empty(); }
+  void clear() { Costs.clear(); }
+
+public:
+  llvm::Error store(const revng::FilePath &Path) const;
+  llvm::Error load(const revng::FilePath &Path);
+};
+
+} // namespace pipeline
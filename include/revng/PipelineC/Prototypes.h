@@ -98,6 +98,12 @@ bool rp_shutdown();
  */
 void rp_string_destroy(char *string);
 
+/**
+ * \return a JSON object with the current value of all the statistics collected
+ *         so far, such as the counters of the lifter.
+ */
+char * /*owning*/ rp_statistics_create_json();
+
 /**
  * \defgroup rp_manager rp_manager methods
  * \{
@@ -190,6 +196,46 @@ rp_manager_produce_targets(rp_manager *manager,
                            rp_error *error);
 LENGTH_HINT(rp_manager_produce_targets, 4, 3)
 
+/**
+ * Request the production of the provided targets in a particular container,
+ * without serializing the container.
+ *
+ * This is cheaper than rp_manager_produce_targets when only some of the
+ * targets are needed afterwards: they can be obtained one at a time through
+ * rp_container_extract_one.
+ *
+ * \param tagets_count must be equal to the size of targets.
+ *
+ * \return true if the targets have been produced
+ */
+bool rp_manager_produce_targets_in_place(rp_manager *manager,
+                                         const rp_step *step,
+                                         const rp_container *container,
+                                         uint64_t targets_count,
+                                         const rp_target *targets[],
+                                         rp_error *error);
+LENGTH_HINT(rp_manager_produce_targets_in_place, 4, 3)
+
+/**
+ * Request the production of targets in multiple steps and containers at once.
+ * The whole request is planned together, so the pipes required by more than
+ * one target run only once. Like rp_manager_produce_targets_in_place, the
+ * containers are not serialized: use rp_container_extract_one.
+ *
+ * \param steps_count must be equal to the size of step_names and maps.
+ * \param maps the i-th map holds the targets to produce in the containers of
+ *        the i-th step.
+ *
+ * \return true if all the targets have been produced
+ */
+bool rp_manager_produce_targets_batch(rp_manager *manager,
+                                      uint64_t steps_count,
+                                      const char *step_names[],
+                                      const rp_container_targets_map *maps[],
+                                      rp_error *error);
+LENGTH_HINT(rp_manager_produce_targets_batch, 2, 1)
+LENGTH_HINT(rp_manager_produce_targets_batch, 3, 1)
+
 /**
  * Request to run the required analysis
  *
@@ -254,6 +300,75 @@ bool rp_manager_set_storage_credentials(rp_manager *manager,
  */
 uint64_t rp_manager_get_context_commit_index(rp_manager *manager);
 
+/**
+ * Start or stop recording the time, memory and targets of each step and pipe.
+ * Stopping discards the events recorded so far.
+ */
+void rp_manager_set_profiling(rp_manager *manager, bool enable);
+
+/**
+ * \return the events recorded since profiling has been enabled, in the Chrome
+ *         trace-event JSON format, or NULL if profiling is not enabled
+ */
+char * /*owning*/ rp_manager_create_profiling_trace(const rp_manager *manager);
+
+/**
+ * Compute, without applying it, the targets that a diff would invalidate and
+ * estimate the cost of producing them again, based on the time the pipes took
+ * when they last ran.
+ *
+ * \param global_name the name of the global \p diff applies to
+ * \param diff the serialized diff
+ * \param invalidations see \ref pipelineC_invalidations
+ *
+ * \return nullptr if an error was encountered, otherwise a YAML document with
+ *         the estimated seconds, the number of invalidated targets and how many
+ *         of them have no recorded cost
+ */
+char * /*owning*/
+rp_manager_create_invalidation_estimate(rp_manager *manager,
+                                        const char *global_name,
+                                        const char *diff,
+                                        rp_invalidations *invalidations,
+                                        rp_error *error);
+
+/**
+ * Ask the production of targets currently running in another thread to stop
+ * before the next step, pipe or function. The interrupted production fails.
+ *
+ * \note unlike all the other functions, this can be invoked while another
+ *       function is running on the same manager. When tracing is enabled,
+ *       calls are serialized and this has no effect.
+ */
+void rp_manager_request_cancellation(rp_manager *manager);
+
+/**
+ * \return a JSON object describing the progress of the production of targets:
+ *         whether a pipe is running, its step and name, how many of the
+ *         requested targets it committed so far, the recent throughput in
+ *         targets per second and the estimated remaining seconds, which is
+ *         null if unknown
+ *
+ * \note like rp_manager_request_cancellation(), this can be invoked while
+ *       another function is running on the same manager.
+ */
+char * /*owning*/ rp_manager_create_progress_json(const rp_manager *manager);
+
+/**
+ * \return a JSON object with the events that happened starting from the one
+ *         with sequence number \p since : targets invalidated, targets
+ *         produced and paths of the globals that changed, in order. The
+ *         \c next field is the sequence number to pass to get the following
+ *         events, while \c truncated is true if some of the requested events
+ *         are no longer available, in which case the whole state should be
+ *         requested again.
+ *
+ * \note like rp_manager_request_cancellation(), this can be invoked while
+ *       another function is running on the same manager.
+ */
+char * /*owning*/ rp_manager_create_events_json(const rp_manager *manager,
+                                                uint64_t since);
+
 /** \} */
 
 /**
@@ -356,6 +471,12 @@ bool rp_target_is_ready(const rp_target *target, const rp_container *container);
  */
 const char *rp_container_get_mime(const rp_container *container);
 
+/**
+ * \return an estimate of the number of bytes of memory used by the content of
+ * \p container
+ */
+uint64_t rp_container_memory_usage(const rp_container *container);
+
 /**
  * Load the provided container given a buffer
  * \param step the step where the container resides
@@ -11,5 +11,7 @@ namespace revng::tracing {
 // This will write a new trace header to the stream and write any
 // subsequent commands.
 // Passing nullptr will disable tracing.
-void setTracing(llvm::raw_ostream *OS = nullptr);
+// If IndexOS is specified, the index of the trace is written to it.
+void setTracing(llvm::raw_ostream *OS = nullptr,
+                llvm::raw_ostream *IndexOS = nullptr);
 } // namespace revng::tracing
@@ -3,11 +3,13 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <limits>
 #include <set>
 #include <string>
 #include <vector>
 
 #include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/YAMLTraits.h"
 
 #include "revng/Support/Assert.h"
@@ -101,6 +103,9 @@ public:
   std::string Result;
   uint64_t EndTime;
 
+public:
+  llvm::Expected<std::vector<char>> getBuffer(size_t ArgNo) const;
+
 public:
   void dump(llvm::raw_ostream &Stream) const;
 
@@ -127,6 +132,10 @@ public:
   // Instead of using a temporary directory, the first invocation will use
   // these directory instead and subsequent ones will abort
   std::string ResumeDirectory;
+  // If set, each command will be timed and, at the end of the run, the timing
+  // of the slowest commands along with per-function statistics will be printed
+  // onto this stream
+  llvm::raw_ostream *BenchmarkOutput = nullptr;
 };
 
 struct Trace {
@@ -147,6 +156,72 @@ public:
   static llvm::Expected<Trace> fromBuffer(const llvm::MemoryBuffer &Buffer);
 };
 
+/// Index of the commands of a trace, which allows to answer queries about a
+/// trace, and to load single commands out of it, without parsing it whole.
+///
+/// The tracing runtime writes the index next to the trace (see `pathFor`), one
+/// line per command:
+///
+///     <ID> <Offset> <Name> [<ArgumentNumber>=<Handle> ...] [R=<Handle>]
+///
+/// where `Offset` is the position of the command in the trace file and the
+/// handles are the non-null pointers taken or returned by the command.
+struct TraceIndex {
+public:
+  struct Entry {
+  public:
+    /// Argument number used for the handle returned by the command
+    static constexpr size_t Result = std::numeric_limits<size_t>::max();
+
+  public:
+    uint64_t ID = 0;
+    uint64_t Offset = 0;
+    std::string Name;
+    /// Argument number and the handle it references, in the order they appear
+    std::vector<std::pair<size_t, std::string>> Handles;
+
+  public:
+    bool references(llvm::StringRef Handle) const;
+
+  public:
+    void dump(llvm::raw_ostream &OS) const;
+    static llvm::Expected<Entry> parse(llvm::StringRef Line);
+  };
+
+public:
+  std::vector<Entry> Entries;
+
+public:
+  std::vector<BufferLocation> listBuffers() const;
+
+  /// \return the number of the commands taking or returning \p Handle
+  std::vector<size_t> commandsUsing(llvm::StringRef Handle) const;
+
+  /// Parse the command \p CommandNo alone out of \p TraceBuffer
+  llvm::Expected<Command> loadCommand(llvm::StringRef TraceBuffer,
+                                      size_t CommandNo) const;
+
+public:
+  void dump(llvm::raw_ostream &OS) const;
+
+public:
+  static std::string pathFor(llvm::StringRef TracePath) {
+    return (TracePath + ".index").str();
+  }
+
+  static llvm::Expected<TraceIndex> fromBuffer(llvm::StringRef Buffer);
+  static llvm::Expected<TraceIndex> fromFile(llvm::StringRef Path);
+
+  /// Build the index scanning \p TraceBuffer line by line, for traces that
+  /// have been recorded without one
+  static TraceIndex fromTrace(llvm::StringRef TraceBuffer);
+
+  /// Load the index stored next to the trace at \p TracePath, if any,
+  /// otherwise build it from \p TraceBuffer
+  static llvm::Expected<TraceIndex> forTrace(llvm::StringRef TracePath,
+                                             llvm::StringRef TraceBuffer);
+};
+
 } // namespace revng::tracing
 
 template<>
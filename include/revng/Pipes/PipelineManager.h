@@ -4,6 +4,8 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <atomic>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -12,6 +14,9 @@
 #include "llvm/Support/raw_ostream.h"
 
 #include "revng/Pipeline/Context.h"
+#include "revng/Pipeline/EventLog.h"
+#include "revng/Pipeline/ProductionProgress.h"
+#include "revng/Pipeline/Profiler.h"
 #include "revng/Pipeline/Runner.h"
 #include "revng/Pipes/ModelGlobal.h"
 #include "revng/Storage/Path.h"
@@ -40,11 +45,19 @@ private:
   std::unique_ptr<pipeline::Context> PipelineContext;
   std::unique_ptr<pipeline::Loader> Loader;
   std::unique_ptr<pipeline::Runner> Runner;
+  std::unique_ptr<pipeline::Profiler> Profiler;
+  std::unique_ptr<std::atomic<bool>> CancellationRequested;
+  std::unique_ptr<pipeline::ProductionProgress> Progress;
+  std::unique_ptr<pipeline::EventLog> Events;
   pipeline::Runner::State CurrentState;
   std::map<const pipeline::ContainerSet::value_type *,
            const pipeline::TargetsList *>
     ContainerToEnumeration;
   std::string Description;
+  /// For each step, the value of UseClock the last time targets have been
+  /// requested from it, used to pick the containers to release first
+  llvm::StringMap<uint64_t> StepsLastUse;
+  uint64_t UseClock = 0;
 
 public:
   PipelineManager(PipelineManager &&Other) = default;
@@ -145,6 +158,14 @@ public:
   invalidateFromDiff(const llvm::StringRef Name,
                      const pipeline::GlobalTupleTreeDiff &Diff);
 
+  /// Compute the targets that applying \p Diff, the serialized form of a diff
+  /// of the global \p GlobalName, would invalidate and the estimated cost of
+  /// producing them again. The diff is not applied.
+  llvm::Expected<pipeline::CostEstimate>
+  estimateInvalidationsFromDiff(llvm::StringRef GlobalName,
+                                llvm::StringRef Diff,
+                                pipeline::TargetInStepSet &Map);
+
   /// returns the cached list of targets that are known to be available to be
   /// produced in a container
   const pipeline::TargetsList *
@@ -164,6 +185,10 @@ public:
   llvm::Error materializeTargets(const llvm::StringRef StepName,
                                  const pipeline::ContainerToTargetsMap &Map);
 
+  /// Produce the targets of multiple steps at once, running each pipe at most
+  /// once for all of them
+  llvm::Error materializeTargets(const pipeline::Runner::State &ToProduce);
+
   llvm::Expected<std::unique_ptr<pipeline::ContainerBase>>
   produceTargets(const llvm::StringRef StepName,
                  const Container &TheContainer,
@@ -192,6 +217,10 @@ public:
   /// be produced by the pipeline in the current state
   void writeAllPossibleTargets(llvm::raw_ostream &OS) const;
 
+  /// prints to the provided raw_ostream an estimate of the memory used by
+  /// each container of each step, see ContainerBase::memoryUsage
+  void writeMemoryUsage(llvm::raw_ostream &OS) const;
+
   const revng::DirectoryPath &executionDirectory() const {
     return ExecutionDirectory;
   }
@@ -200,8 +229,50 @@ public:
 
   llvm::Error setStorageCredentials(llvm::StringRef Credentials);
 
+  /// Start or stop recording the cost of each step and pipe, stopping discards
+  /// the events recorded so far
+  void setProfiling(bool Enable);
+
+  /// \return the profiler, nullptr if profiling is not enabled
+  const pipeline::Profiler *getProfiler() const { return Profiler.get(); }
+
+  /// Ask the production of targets currently running to stop as soon as
+  /// possible, i.e., before the next step, pipe or function. The interrupted
+  /// production fails with std::errc::operation_canceled.
+  ///
+  /// \note this is the only method that can be invoked while another thread is
+  ///       running the pipeline.
+  void requestCancellation() { CancellationRequested->store(true); }
+
+  /// \return the progress of the pipe currently running, if any
+  ///
+  /// \note like requestCancellation, this can be invoked while another thread
+  ///       is running the pipeline.
+  pipeline::ProgressSnapshot getProgress() const {
+    return Progress->snapshot();
+  }
+
+  /// \return the events, i.e., targets invalidated and produced and changes
+  ///         to the globals, starting from the one with sequence number
+  ///         \p Since
+  ///
+  /// \note like requestCancellation, this can be invoked while another thread
+  ///       is running the pipeline.
+  pipeline::EventBatch getEvents(uint64_t Since) const {
+    return Events->since(Since);
+  }
+
 private:
   llvm::Error produceAllPossibleTargets(bool ExpandTargets);
   llvm::Error computeDescription();
+
+  /// If the memory budget set by --containers-memory-budget is exceeded,
+  /// release the containers of all the steps but the most recently used one.
+  /// Released containers are read back from the execution directory when
+  /// accessed again.
+  ///
+  /// \note must be invoked right after the pipeline has been stored and the
+  ///       changes have been committed.
+  void enforceMemoryBudget();
 };
 } // namespace revng::pipes
@@ -63,6 +63,8 @@ public:
 
   void setContent(std::string NewString) { Content = std::move(NewString); }
 
+  uint64_t memoryUsage() const final { return Content.capacity(); }
+
   void clear() override { *this = StringBufferContainer(this->name()); }
 
   llvm::Error serialize(llvm::raw_ostream &OS) const override {
@@ -5,8 +5,10 @@
 //
 
 #include <map>
+#include <optional>
 #include <utility>
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/YAMLTraits.h"
 
@@ -18,10 +20,12 @@
 #include "revng/Pipes/Kinds.h"
 #include "revng/Pipes/ModelGlobal.h"
 #include "revng/Pipes/TypeKind.h"
+#include "revng/Support/CommonOptions.h"
 #include "revng/Support/GzipTarFile.h"
 #include "revng/Support/MetaAddress.h"
 #include "revng/Support/MetaAddress/YAMLTraits.h"
 #include "revng/Support/YAMLTraits.h"
+#include "revng/Support/ZstdStream.h"
 #include "revng/TupleTree/TupleTree.h"
 
 namespace detail {
@@ -71,14 +75,31 @@ namespace revng::pipes {
 
 namespace detail {
 
+/// Converts an entry from its in-memory representation to the one exposed
+/// outside of the container, see GenericStringMap
+using ExportEntryFunction = std::string (*)(llvm::StringRef);
+
+/// A container mapping each key of \p Rank to a string.
+///
+/// If \p ExportEntry is provided, entries can be kept in memory in a private
+/// representation (e.g., one that is cheaper to decode) and are converted by
+/// \p ExportEntry whenever they leave the container: when serializing,
+/// storing or extracting a single entry. Entries that have been deserialized
+/// or loaded are kept in the exported representation, hence consumers must
+/// accept both.
 template<auto *Rank,
          auto *K,
          const char *TypeName,
          const char *MIMETypeParam,
-         const char *ArchiveSuffix>
+         const char *ArchiveSuffix,
+         ExportEntryFunction ExportEntry = nullptr>
 class GenericStringMap
-  : public pipeline::Container<
-      GenericStringMap<Rank, K, TypeName, MIMETypeParam, ArchiveSuffix>> {
+  : public pipeline::Container<GenericStringMap<Rank,
+                                                K,
+                                                TypeName,
+                                                MIMETypeParam,
+                                                ArchiveSuffix,
+                                                ExportEntry>> {
 private:
   using RankType = std::remove_pointer_t<decltype(Rank)>;
   static_assert(pipeline::RankSpecialization<RankType>);
@@ -98,7 +119,16 @@ public:
 
 private:
   using OffsetMap = ::detail::OffsetMap<KeyType>;
-  MapType Map;
+
+  /// Decompressed entries. Mutable since, while the container is backed by
+  /// Archive, it is populated upon first access.
+  mutable MapType Map;
+
+  /// When loaded from an archive with an index, the content of the archive is
+  /// kept compressed, and single entries are decompressed on demand using the
+  /// index. While this is set, Map is empty.
+  mutable std::unique_ptr<llvm::MemoryBuffer> Archive;
+  mutable OffsetMap Index;
 
 public:
   inline static char ID = '0';
@@ -109,8 +139,23 @@ public:
     revng_assert(&K->rank() == Rank);
   }
 
-  GenericStringMap(const GenericStringMap &) = default;
-  GenericStringMap &operator=(const GenericStringMap &) = default;
+  GenericStringMap(const GenericStringMap &Other) :
+    pipeline::Container<GenericStringMap>(Other), Map() {
+    Other.materialize();
+    Map = Other.Map;
+  }
+
+  GenericStringMap &operator=(const GenericStringMap &Other) {
+    if (this == &Other)
+      return *this;
+
+    Other.materialize();
+    pipeline::Container<GenericStringMap>::operator=(Other);
+    Archive.reset();
+    Index.clear();
+    Map = Other.Map;
+    return *this;
+  }
 
   GenericStringMap(GenericStringMap &&) = default;
   GenericStringMap &operator=(GenericStringMap &&) = default;
@@ -118,12 +163,14 @@ public:
   ~GenericStringMap() override = default;
 
 public:
-  void clear() override { Map.clear(); }
+  void clear() override {
+    Map.clear();
+    Archive.reset();
+    Index.clear();
+  }
 
   std::unique_ptr<pipeline::ContainerBase>
   cloneFiltered(const pipeline::TargetsList &Targets) const override {
-    auto Clone = std::make_unique<GenericStringMap>(*this);
-
     // Returns true if Targets contains a Target that matches the Entry in the
     // Map
     const auto EntryIsInTargets = [&](const auto &Entry) {
@@ -132,42 +179,81 @@ public:
       return Targets.contains(EntryTarget);
     };
 
+    // Only decompress the requested entries
+    if (Archive) {
+      auto Clone = std::make_unique<GenericStringMap>(this->name());
+      for (const auto &Entry : Index)
+        if (EntryIsInTargets(Entry))
+          Clone->Map[Entry.first] = readEntry(Entry.second);
+      return Clone;
+    }
+
+    auto Clone = std::make_unique<GenericStringMap>(*this);
+
     // Drop all the entries in Map that are not in Targets
     std::erase_if(Clone->Map, std::not_fn(EntryIsInTargets));
 
     return Clone;
   }
 
+  uint64_t memoryUsage() const override {
+    uint64_t Result = 0;
+    if (Archive)
+      Result += Archive->getBufferSize();
+    Result += Index.size() * sizeof(typename OffsetMap::value_type);
+
+    for (const auto &Entry : Map)
+      Result += sizeof(typename MapType::value_type) + Entry.second.capacity();
+
+    return Result;
+  }
+
   llvm::Error extractOne(llvm::raw_ostream &OS,
                          const pipeline::Target &Target) const override {
     revng_check(&Target.getKind() == K);
 
-    std::string KeyString = Target.getPathComponents().back();
+    std::string KeyString = Target.getPathComponents().back().str();
+
+    if (Archive) {
+      auto It = Index.find(keyFromString(KeyString));
+      revng_check(It != Index.end());
+      OS << readEntry(It->second);
+      return llvm::Error::success();
+    }
 
     auto It = find(keyFromString(KeyString));
     revng_check(It != end());
 
-    OS << It->second;
+    if constexpr (ExportEntry != nullptr)
+      OS << ExportEntry(It->second);
+    else
+      OS << It->second;
 
     return llvm::Error::success();
   }
 
   pipeline::TargetsList enumerate() const override {
     pipeline::TargetsList::List Result;
-    for (const auto &[Key, Value] : Map)
-      Result.push_back({ keyToString(Key), *K });
+    if (Archive) {
+      for (const auto &[Key, Offset] : Index)
+        Result.push_back({ keyToString(Key), *K });
+    } else {
+      for (const auto &[Key, Value] : Map)
+        Result.push_back({ keyToString(Key), *K });
+    }
 
     return Result;
   }
 
   bool remove(const pipeline::TargetsList &Targets) override {
+    materialize();
     bool Changed = false;
 
     auto End = Map.end();
     for (const pipeline::Target &T : Targets) {
       revng_assert(&T.getKind() == K);
 
-      std::string KeyString = T.getPathComponents().back();
+      std::string KeyString = T.getPathComponents().back().str();
       auto It = Map.find(keyFromString(KeyString));
       if (It != End) {
         Map.erase(It);
@@ -179,22 +265,42 @@ public:
   }
 
   llvm::Error serialize(llvm::raw_ostream &OS) const override {
-    serializeWithOffsets(OS);
+    // Archives loaded from the workspace might use zstd, while the serialized
+    // form must always be gzip
+    if (Archive and not isArchiveZstd()) {
+      OS << Archive->getBuffer();
+    } else {
+      materialize();
+      serializeWithOffsets(OS, TarCompression::Gzip);
+    }
     return llvm::Error::success();
   }
 
   llvm::Error deserialize(const llvm::MemoryBuffer &Buffer) override {
+    clear();
     GzipTarReader Reader(Buffer);
     deserializeImpl(Reader);
     return llvm::Error::success();
   }
 
   llvm::Error store(const revng::FilePath &Path) const override {
-    auto MaybeWritableFile = Path.getWritableFile(ContentEncoding::Gzip);
+    // Archives in the workspace are not exposed to the user, hence they can
+    // use the faster zstd compression, if requested
+    bool UseZstd = Archive ? isArchiveZstd() : ZstdWorkspace.getValue();
+    auto Compression = UseZstd ? TarCompression::Zstd : TarCompression::Gzip;
+    auto Encoding = UseZstd ? ContentEncoding::Zstd : ContentEncoding::Gzip;
+    auto MaybeWritableFile = Path.getWritableFile(Encoding);
     if (not MaybeWritableFile)
       return MaybeWritableFile.takeError();
 
-    OffsetMap Offsets = serializeWithOffsets(MaybeWritableFile.get()->os());
+    OffsetMap Offsets;
+    if (Archive) {
+      MaybeWritableFile.get()->os() << Archive->getBuffer();
+      Offsets = Index;
+    } else {
+      Offsets = serializeWithOffsets(MaybeWritableFile.get()->os(),
+                                     Compression);
+    }
 
     if (auto Error = MaybeWritableFile.get()->commit(); Error)
       return Error;
@@ -228,7 +334,24 @@ public:
     if (not MaybeBuffer)
       return MaybeBuffer.takeError();
 
-    GzipTarReader Reader(MaybeBuffer.get()->buffer());
+    clear();
+
+    // If an index is available, defer decompression to the first access
+    auto MaybeIndex = loadIndex(Path.addExtension("idx"));
+    if (not MaybeIndex)
+      return MaybeIndex.takeError();
+
+    const llvm::MemoryBuffer &Buffer = MaybeBuffer.get()->buffer();
+    if (MaybeIndex->has_value() and isIndexValid(**MaybeIndex, Buffer)) {
+      // The file might be overwritten in place, copy it
+      using llvm::MemoryBuffer;
+      Archive = MemoryBuffer::getMemBufferCopy(Buffer.getBuffer(),
+                                               Buffer.getBufferIdentifier());
+      Index = std::move(**MaybeIndex);
+      return llvm::Error::success();
+    }
+
+    GzipTarReader Reader(Buffer);
     deserializeImpl(Reader);
     return llvm::Error::success();
   }
@@ -242,6 +365,9 @@ public:
 
 protected:
   void mergeBackImpl(GenericStringMap &&Other) override {
+    materialize();
+    Other.materialize();
+
     // Stuff in Other should overwrite what's in this container.
     // We first merge this->Map into Other.Map (which keeps Other's version if
     // present), and then we replace this->Map with the newly merged version of
@@ -253,10 +379,19 @@ protected:
 public:
   /// std::map-like methods
 
-  std::string &operator[](KeyType M) { return Map[M]; };
+  std::string &operator[](KeyType M) {
+    materialize();
+    return Map[M];
+  };
 
-  std::string &at(KeyType M) { return Map.at(M); };
-  const std::string &at(KeyType M) const { return Map.at(M); };
+  std::string &at(KeyType M) {
+    materialize();
+    return Map.at(M);
+  };
+  const std::string &at(KeyType M) const {
+    materialize();
+    return Map.at(M);
+  };
 
 private:
   using IteratedValue = std::pair<const KeyType &, std::string &>;
@@ -271,40 +406,118 @@ private:
 
 public:
   auto insert(const ValueType &V) {
+    materialize();
     auto [Iterator, Success] = Map.insert(V);
     return std::pair{ revng::map_iterator(Iterator, mapIt), Success };
   };
   auto insert(ValueType &&V) {
+    materialize();
     auto [Iterator, Success] = Map.insert(std::move(V));
     return std::pair{ revng::map_iterator(Iterator, mapIt), Success };
   };
 
   auto insert_or_assign(KeyType Key, const std::string &Value) {
+    materialize();
     auto [Iterator, Success] = Map.insert_or_assign(Key, Value);
     return std::pair{ revng::map_iterator(Iterator, mapIt), Success };
   };
   auto insert_or_assign(KeyType Key, std::string &&Value) {
+    materialize();
     auto [Iterator, Success] = Map.insert_or_assign(Key, std::move(Value));
     return std::pair{ revng::map_iterator(Iterator, mapIt), Success };
   };
 
-  bool contains(KeyType Key) const { return Map.contains(Key); }
+  bool contains(KeyType Key) const {
+    return Archive ? Index.contains(Key) : Map.contains(Key);
+  }
 
   auto find(KeyType Key) {
+    materialize();
     return revng::map_iterator(Map.find(Key), this->mapIt);
   }
 
   auto find(KeyType Key) const {
+    materialize();
     return revng::map_iterator(Map.find(Key), this->mapCIt);
   }
 
-  auto begin() { return revng::map_iterator(Map.begin(), this->mapIt); }
-  auto end() { return revng::map_iterator(Map.end(), this->mapIt); }
+  auto begin() {
+    materialize();
+    return revng::map_iterator(Map.begin(), this->mapIt);
+  }
+  auto end() {
+    materialize();
+    return revng::map_iterator(Map.end(), this->mapIt);
+  }
 
-  auto begin() const { return revng::map_iterator(Map.begin(), this->mapCIt); }
-  auto end() const { return revng::map_iterator(Map.end(), this->mapCIt); }
+  auto begin() const {
+    materialize();
+    return revng::map_iterator(Map.begin(), this->mapCIt);
+  }
+  auto end() const {
+    materialize();
+    return revng::map_iterator(Map.end(), this->mapCIt);
+  }
 
 private:
+  std::string readEntry(const ::detail::DataOffset &Offset) const {
+    revng_assert(Archive);
+    llvm::ArrayRef<char> Data(Archive->getBufferStart(),
+                              Archive->getBufferSize());
+    auto Entry = readGzipTarEntry(Data, Offset.Start, Offset.End + 1);
+    revng_check(Entry.size() == Offset.UncompressedSize);
+    return std::string(Entry.data(), Entry.size());
+  }
+
+  bool isArchiveZstd() const {
+    revng_assert(Archive);
+    return isZstdFrame({ Archive->getBufferStart(), Archive->getBufferSize() });
+  }
+
+  /// Decompress all the entries of the archive, if any
+  void materialize() const {
+    if (not Archive)
+      return;
+
+    for (const auto &[Key, Offset] : Index)
+      Map[Key] = readEntry(Offset);
+
+    Archive.reset();
+    Index.clear();
+  }
+
+  static llvm::Expected<std::optional<OffsetMap>>
+  loadIndex(const revng::FilePath &IndexPath) {
+    auto MaybeExists = IndexPath.exists();
+    if (not MaybeExists)
+      return MaybeExists.takeError();
+
+    if (not MaybeExists.get())
+      return std::nullopt;
+
+    auto MaybeIndexFile = IndexPath.getReadableFile();
+    if (not MaybeIndexFile)
+      return MaybeIndexFile.takeError();
+
+    OffsetMap Result;
+    llvm::yaml::Input IndexInput(MaybeIndexFile.get()->buffer().getBuffer());
+    IndexInput >> Result;
+
+    // A broken index is not fatal, the archive can still be read sequentially
+    if (IndexInput.error())
+      return std::nullopt;
+
+    return Result;
+  }
+
+  static bool isIndexValid(const OffsetMap &Index,
+                           const llvm::MemoryBuffer &Buffer) {
+    for (const auto &[Key, Offset] : Index)
+      if (Offset.Start > Offset.End or Offset.End >= Buffer.getBufferSize())
+        return false;
+    return true;
+  }
+
   void deserializeImpl(GzipTarReader &Reader) {
     for (ArchiveEntry &Entry : Reader.entries()) {
       llvm::StringRef Name = Entry.Filename;
@@ -315,19 +528,42 @@ private:
     }
   }
 
-  OffsetMap serializeWithOffsets(llvm::raw_ostream &OS) const {
-    OffsetMap Result;
-    revng::GzipTarWriter Writer(OS);
-    for (auto &[Key, Data] : Map) {
-      std::string Name = keyToString(Key) + ArchiveSuffix;
-      OffsetDescriptor Offsets = Writer.append(Name,
-                                               { Data.data(), Data.size() });
-      Result[Key] = { .UncompressedSize = Data.size(),
-                      .Start = Offsets.DataStart,
-                      .End = Offsets.PaddingStart - 1 };
+  OffsetMap serializeWithOffsets(llvm::raw_ostream &OS,
+                                 TarCompression Compression) const {
+    std::vector<std::string> Names;
+    Names.reserve(Map.size());
+    for (auto &[Key, Data] : Map)
+      Names.push_back(keyToString(Key) + ArchiveSuffix);
+
+    // Entries as they are exposed outside of the container
+    std::vector<llvm::StringRef> Contents;
+    std::vector<std::string> Exported;
+    Contents.reserve(Map.size());
+    if constexpr (ExportEntry != nullptr) {
+      Exported.reserve(Map.size());
+      for (auto &[Key, Data] : Map)
+        Contents.push_back(Exported.emplace_back(ExportEntry(Data)));
+    } else {
+      for (auto &[Key, Data] : Map)
+        Contents.push_back(Data);
     }
+
+    std::vector<GzipTarWriter::File> Files;
+    Files.reserve(Map.size());
+    for (auto &&[Name, Content] : llvm::zip(Names, Contents))
+      Files.push_back({ Name, { Content.data(), Content.size() } });
+
+    revng::GzipTarWriter Writer(OS, Compression);
+    std::vector<OffsetDescriptor> Offsets = Writer.appendAll(Files);
     Writer.close();
 
+    OffsetMap Result;
+    for (auto &&[Entry, Content, Offset] : llvm::zip(Map, Contents, Offsets)) {
+      Result[Entry.first] = { .UncompressedSize = Content.size(),
+                              .Start = Offset.DataStart,
+                              .End = Offset.PaddingStart - 1 };
+    }
+
     return Result;
   }
 
@@ -344,12 +580,14 @@ public:
 template<kinds::FunctionKind *TheKind,
          const char *TypeName,
          const char *MIMETypeParam,
-         const char *ArchiveSuffix>
+         const char *ArchiveSuffix,
+         detail::ExportEntryFunction ExportEntry = nullptr>
 using FunctionStringMap = detail::GenericStringMap<&ranks::Function,
                                                    TheKind,
                                                    TypeName,
                                                    MIMETypeParam,
-                                                   ArchiveSuffix>;
+                                                   ArchiveSuffix,
+                                                   ExportEntry>;
 
 template<kinds::TypeKind *TheKind,
          const char *TypeName,
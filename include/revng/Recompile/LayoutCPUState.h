@@ -0,0 +1,14 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+namespace llvm {
+class Module;
+} // namespace llvm
+
+/// Place the CSVs of the translated binary next to each other, the most
+/// accessed ones first, so that the hot part of the CPU state spans as few
+/// cache lines as possible. Enabled by -layout-cpu-state.
+void layoutCPUState(llvm::Module &M);
@@ -0,0 +1,13 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+namespace llvm {
+class Module;
+} // namespace llvm
+
+/// Speed up, at run time, how the translated binary reaches the targets of
+/// indirect jumps and calls. Each transformation is enabled by an option.
+void optimizeDispatchers(llvm::Module &M);
@@ -0,0 +1,17 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+namespace llvm {
+class Module;
+} // namespace llvm
+
+/// Count, at run time, how many times each basic block of the translated code
+/// runs (-profile-instrument), or use the counts collected this way to guide
+/// the optimization of the translated binary (-profile-use).
+///
+/// \note the counts are matched with the basic blocks by position: a profile
+///       can only be used on the module it has been collected on.
+void applyProfileGuidedOptimization(llvm::Module &M);
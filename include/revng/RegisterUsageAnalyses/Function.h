@@ -12,6 +12,7 @@
 #include "llvm/ADT/SmallVector.h"
 
 #include "revng/ADT/GenericGraph.h"
+#include "revng/ADT/RecyclingAllocated.h"
 #include "revng/Model/Register.h"
 
 template<>
@@ -69,7 +70,7 @@ public:
 
 static_assert(sizeof(Operation) == 2);
 
-struct Block {
+struct Block : public RecyclingAllocated {
 public:
   using OperationsVector = llvm::SmallVector<Operation, 8>;
   using iterator = OperationsVector::iterator;
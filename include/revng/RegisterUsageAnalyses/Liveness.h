@@ -5,6 +5,7 @@
 //
 
 #include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
 
 #include "revng/MFP/MFP.h"
 #include "revng/RegisterUsageAnalyses/Function.h"
@@ -21,8 +22,19 @@ public:
   using GraphType = llvm::Inverse<const Function *>;
   using Label = const BlockNode *;
 
+private:
+  /// The effect of a block, summarized as (Live - Kill) | Gen
+  struct Summary {
+    /// Registers read before being written in the block
+    Set Gen;
+
+    /// Registers written or clobbered in the block
+    Set Kill;
+  };
+
 private:
   Set Default;
+  llvm::DenseMap<const Block *, Summary> Summaries;
 
 public:
   Liveness(const Function &F) {
@@ -34,6 +46,33 @@ public:
     }
 
     Default.resize(Max + 1);
+
+    // Precompute the effect of each block, so that the transfer function
+    // boils down to a couple of operations on bit vectors
+    for (const Block *Block : F.nodes()) {
+      Summary &BlockSummary = Summaries[Block];
+      BlockSummary.Gen.resize(Max + 1);
+      BlockSummary.Kill.resize(Max + 1);
+
+      for (const Operation &Operation :
+           llvm::make_range(Block->rbegin(), Block->rend())) {
+        switch (Operation.Type) {
+        case OperationType::Read:
+          BlockSummary.Gen.set(Operation.Target);
+          break;
+
+        case OperationType::Write:
+        case OperationType::Clobber:
+          BlockSummary.Gen.reset(Operation.Target);
+          BlockSummary.Kill.set(Operation.Target);
+          break;
+
+        case OperationType::Invalid:
+          revng_abort();
+          break;
+        }
+      }
+    }
   }
 
 public:
@@ -47,35 +86,26 @@ public:
   }
 
   bool isLessOrEqual(const Set &LHS, const Set &RHS) const {
-    // RHS must contain or be equal to LHS
-    Set Intersection = RHS;
-    Intersection &= LHS;
-    return Intersection == LHS;
+    // RHS must contain or be equal to LHS, i.e., LHS - RHS must be empty
+    return not LHS.test(RHS);
+  }
+
+  bool combineInPlace(Set &Target, const Set &Source) const {
+    bool Changed = Source.test(Target);
+    if (Changed)
+      Target |= Source;
+    return Changed;
   }
 
   RegisterSet applyTransferFunction(const BlockNode *Block,
                                     const RegisterSet &InitialState) const {
-    RegisterSet Result = InitialState;
-
-    for (const Operation &Operation :
-         llvm::make_range(Block->rbegin(), Block->rend())) {
-
-      switch (Operation.Type) {
-      case OperationType::Read:
-        Result.set(Operation.Target);
-        break;
-
-      case OperationType::Write:
-      case OperationType::Clobber:
-        Result.reset(Operation.Target);
-        break;
-
-      case OperationType::Invalid:
-        revng_abort();
-        break;
-      }
-    }
+    auto It = Summaries.find(Block);
+    revng_assert(It != Summaries.end());
+    const Summary &BlockSummary = It->second;
 
+    RegisterSet Result = InitialState;
+    Result.reset(BlockSummary.Kill);
+    Result |= BlockSummary.Gen;
     return Result;
   }
 };
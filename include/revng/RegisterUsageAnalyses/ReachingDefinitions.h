@@ -5,6 +5,7 @@
 //
 
 #include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
 
 #include "revng/MFP/MFP.h"
@@ -66,12 +67,35 @@ public:
   using Label = BlockNode *;
 
 private:
-  llvm::DenseMap<const Operation *, uint8_t> WriteToIndex;
+  /// The effect of a block on the writers of a register it accesses
+  struct RegisterSummary {
+    uint8_t Register = 0;
+
+    /// Whether the register is read before being written or clobbered, i.e.,
+    /// whether the incoming reaching writes are read
+    bool ReadsIncoming = false;
+
+    /// Whether the register is written or clobbered, i.e., whether the
+    /// incoming reaching writes are replaced by OutgoingReaching
+    bool Defines = false;
+
+    /// Writes performed in the block and read in the block itself
+    llvm::BitVector Read;
+
+    /// The writes reaching the end of the block, if Defines
+    llvm::BitVector OutgoingReaching;
+  };
+
+  using BlockSummary = llvm::SmallVector<RegisterSummary, 4>;
+
+private:
   WritersSet Default = LatticeElement::empty();
+  llvm::DenseMap<const Block *, BlockSummary> Summaries;
 
 public:
   ReachingDefinitions(const Function &F) {
-    // Populate WriteToIndex
+    // Assign an index to each write
+    llvm::DenseMap<const Operation *, uint8_t> WriteToIndex;
     llvm::SmallVector<int> RegisterWriteIndex(F.registersCount(), 0);
     for (const Block *Block : F.nodes()) {
       for (const Operation &Operation : Block->Operations) {
@@ -87,6 +111,51 @@ public:
       Default[I].Reaching.resize(RegisterWriteIndex[I]);
       Default[I].Read.resize(RegisterWriteIndex[I]);
     }
+
+    // Precompute the effect of each block on the registers it accesses, so
+    // that the transfer function doesn't need to go through its operations
+    for (const Block *Block : F.nodes()) {
+      BlockSummary &Summary = Summaries[Block];
+      llvm::SmallVector<int16_t, 16> SummaryIndex(RegisterWriteIndex.size(),
+                                                  -1);
+
+      for (const Operation &Operation : *Block) {
+        int16_t &Index = SummaryIndex[Operation.Target];
+        if (Index == -1) {
+          Index = Summary.size();
+          RegisterSummary &New = Summary.emplace_back();
+          New.Register = Operation.Target;
+          unsigned WritesCount = RegisterWriteIndex[Operation.Target];
+          New.Read.resize(WritesCount);
+          New.OutgoingReaching.resize(WritesCount);
+        }
+
+        RegisterSummary &Entry = Summary[Index];
+        switch (Operation.Type) {
+        case OperationType::Write:
+          Entry.Defines = true;
+          Entry.OutgoingReaching.reset();
+          Entry.OutgoingReaching.set(WriteToIndex.find(&Operation)->second);
+          break;
+
+        case OperationType::Clobber:
+          Entry.Defines = true;
+          Entry.OutgoingReaching.reset();
+          break;
+
+        case OperationType::Read:
+          if (Entry.Defines)
+            Entry.Read |= Entry.OutgoingReaching;
+          else
+            Entry.ReadsIncoming = true;
+          break;
+
+        case OperationType::Invalid:
+          revng_abort();
+          break;
+        }
+      }
+    }
   }
 
 public:
@@ -121,37 +190,42 @@ public:
 
   bool isLessOrEqual(const WritersSet &LHS, const WritersSet &RHS) const {
     for (const auto &[LHSEntry, RHSEntry] : zip(LHS, RHS)) {
-      auto Intersection = LHSEntry;
-      Intersection &= RHSEntry;
-      if (Intersection != LHSEntry)
+      if (LHSEntry.Reaching.test(RHSEntry.Reaching)
+          or LHSEntry.Read.test(RHSEntry.Read))
         return false;
     }
 
     return true;
   }
 
+  bool combineInPlace(WritersSet &Target, const WritersSet &Source) const {
+    bool Changed = false;
+    for (const auto &[TargetEntry, SourceEntry] : zip(Target, Source)) {
+      if (SourceEntry.Reaching.test(TargetEntry.Reaching)
+          or SourceEntry.Read.test(TargetEntry.Read)) {
+        TargetEntry |= SourceEntry;
+        Changed = true;
+      }
+    }
+
+    return Changed;
+  }
+
   WritersSet applyTransferFunction(const Block *Block,
                                    const WritersSet &InitialState) const {
+    auto It = Summaries.find(Block);
+    revng_assert(It != Summaries.end());
+
     WritersSet Result = InitialState;
+    for (const RegisterSummary &Entry : It->second) {
+      RegisterWriters &Writes = Result[Entry.Register];
 
-    for (const Operation &Operation : *Block) {
-      RegisterWriters &Writes = Result[Operation.Target];
-
-      switch (Operation.Type) {
-      case OperationType::Write: {
-        Writes.Reaching.reset();
-        Writes.Reaching.set(WriteToIndex.find(&Operation)->second);
-      } break;
-      case OperationType::Clobber: {
-        Writes.Reaching.reset();
-      } break;
-      case OperationType::Read: {
+      if (Entry.ReadsIncoming)
         Writes.Read |= Writes.Reaching;
-      } break;
-      case OperationType::Invalid:
-        revng_abort();
-        break;
-      }
+      Writes.Read |= Entry.Read;
+
+      if (Entry.Defines)
+        Writes.Reaching = Entry.OutgoingReaching;
     }
 
     return Result;
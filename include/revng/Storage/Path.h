@@ -33,6 +33,8 @@ public:
   }
 
   bool isValid() const { return Client != nullptr; }
+
+  bool operator==(const PathBase &Other) const = default;
 };
 
 class FilePath : public PathBase {
@@ -5,7 +5,9 @@
 //
 
 #include <memory>
+#include <mutex>
 
+#include "llvm/ADT/FunctionExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
@@ -17,11 +19,16 @@
 #include "revng/Support/Assert.h"
 #include "revng/Support/Debug.h"
 
+namespace llvm {
+class ThreadPool;
+} // namespace llvm
+
 namespace revng {
 
 enum class ContentEncoding {
   None,
-  Gzip
+  Gzip,
+  Zstd
 };
 
 enum class PathType {
@@ -67,12 +74,24 @@ enum class PathType {
 ///   return Client.commit();
 /// }
 /// \endcode
+///
+/// In write-behind mode (see ::setWriteBehind) WritableFile::commit only
+/// enqueues the actual write, which is carried out by background threads. This
+/// allows the caller to serialize the next file while the previous one is
+/// being written. ::commit waits for all the pending writes and reports their
+/// errors, while all the other methods wait for them before touching the
+/// storage, so that they always observe the effects of previous writes.
 class StorageClient {
+private:
+  std::unique_ptr<llvm::ThreadPool> WriteBehindPool;
+  std::mutex PendingErrorsMutex;
+  llvm::Error PendingErrors = llvm::Error::success();
+
 protected:
-  StorageClient() = default;
+  StorageClient();
 
 public:
-  virtual ~StorageClient() = default;
+  virtual ~StorageClient();
   StorageClient(const StorageClient &Other) = delete;
   StorageClient &operator=(const StorageClient &Other) = delete;
   StorageClient(const StorageClient &&Other) = delete;
@@ -103,13 +122,30 @@ public:
   virtual llvm::Expected<std::unique_ptr<WritableFile>>
   getWritableFile(llvm::StringRef Path, ContentEncoding Encoding) = 0;
 
-  virtual llvm::Error commit() { return llvm::Error::success(); };
+  virtual llvm::Error commit() { return waitPendingWrites(); };
 
   virtual llvm::Error setCredentials(llvm::StringRef Credentials) {
     return llvm::createStringError(llvm::inconvertibleErrorCode(),
                                    "Not Supported");
   }
 
+  /// Enable or disable write-behind mode, disabling it waits for the pending
+  /// writes
+  llvm::Error setWriteBehind(bool Enable);
+  bool isWriteBehind() const { return WriteBehindPool != nullptr; }
+
+protected:
+  /// Run \p Write in background if write-behind is enabled, immediately
+  /// otherwise. \p Write must not rely on the WritableFile it originates from.
+  llvm::Error enqueueWrite(llvm::unique_function<llvm::Error()> Write);
+
+  /// Wait for all the writes enqueued so far
+  /// \return the errors they produced
+  llvm::Error waitPendingWrites();
+
+  /// \return how many writes can be carried out at the same time
+  virtual unsigned getWriteBehindConcurrency() const { return 1; }
+
 private:
   virtual std::string dumpString() const = 0;
 };
@@ -24,6 +24,7 @@ class AccessTracker {
 private:
   std::uint8_t Counter = 0;
   bool IsTracking;
+  bool IsPaused = false;
 
 public:
   AccessTracker(bool StartsActive) { IsTracking = StartsActive; }
@@ -38,7 +39,12 @@ public:
     Counter &= ~0x1;
     IsTracking = true;
   }
-  void access() { Counter |= (0x1 & IsTracking); }
+  /// \note this never writes when not tracking, so that the model can be read
+  ///       concurrently while tracking is stopped or paused
+  void access() {
+    if (IsTracking)
+      Counter |= 0x1;
+  }
   void push() {
     bool HasLeadingZeroes = llvm::countLeadingZeros(Counter) != 0;
     revng_assert(HasLeadingZeroes, "More than 8 pushes have been performed");
@@ -49,6 +55,18 @@ public:
   bool peak() const { return Counter & 0x1; }
   bool isSet() const { return Counter; }
   void stopTracking() { IsTracking = false; }
+
+  /// Stop tracking until `resumeTracking`, leaving everything else untouched
+  void pauseTracking() {
+    revng_assert(not IsPaused);
+    IsPaused = IsTracking;
+    IsTracking = false;
+  }
+
+  void resumeTracking() {
+    IsTracking = IsPaused;
+    IsPaused = false;
+  }
 };
 
 } // namespace revng
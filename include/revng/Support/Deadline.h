@@ -0,0 +1,64 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "llvm/ADT/StringRef.h"
+
+namespace revng {
+
+/// A point in time after which the algorithms that can produce a partial
+/// result (e.g., a fixed point that has not been reached yet) should stop and
+/// return what they have
+///
+/// Algorithms poll the deadline of the innermost active DeadlineScope through
+/// `deadlineExpired`. The deadline is process-wide, so that it also applies to
+/// the work done on other threads (e.g., by `llvm::parallelForEach`).
+class DeadlineScope {
+private:
+  using Clock = std::chrono::steady_clock;
+
+private:
+  /// The deadline that was active when this scope was created
+  int64_t Previous = 0;
+  DeadlineScope *PreviousScope = nullptr;
+  std::atomic<bool> Expired = false;
+
+public:
+  /// Stop after \p Budget from now, or keep the current deadline if it's
+  /// earlier. A zero \p Budget preserves the current deadline.
+  explicit DeadlineScope(std::chrono::milliseconds Budget);
+  ~DeadlineScope();
+
+  DeadlineScope(const DeadlineScope &) = delete;
+  DeadlineScope &operator=(const DeadlineScope &) = delete;
+
+public:
+  /// \return true if some algorithm returned a partial result while this scope
+  ///         was active
+  bool hasExpired() const { return Expired; }
+
+  friend bool deadlineExpired(llvm::StringRef What);
+
+/// \return true if the current deadline, if any, has expired, without
+///         reporting it. Useful to avoid caching a result that might be
+///         partial.
+bool deadlinePassed();
+};
+
+/// \return true if the current deadline, if any, has expired, in which case
+///         the caller is expected to return its best result so far.
+///         \p What describes the caller in the diagnostics.
+bool deadlineExpired(llvm::StringRef What);
+
+/// \return true if the current deadline, if any, has expired, without
+///         reporting it. Useful to avoid caching a result that might be
+///         partial.
+bool deadlinePassed();
+
+} // namespace revng
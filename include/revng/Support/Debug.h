@@ -17,6 +17,12 @@ extern size_t MaxLoggerNameLength;
 
 #define debug_function __attribute__((used, noinline))
 
+#if defined(DISABLE_LOGGERS)
+inline constexpr bool LoggersCompiledIn = false;
+#else
+inline constexpr bool LoggersCompiledIn = true;
+#endif
+
 /// Emits \p Indentation space pairs
 template<typename Stream>
 void indent(Stream &Output, size_t Indentation) {
@@ -36,6 +42,10 @@ struct LogTerminator {
 ///
 /// The typical usage of this class is to be a static global variable in a
 /// translation unit.
+///
+/// When \p StaticEnabled is false, or when building with DISABLE_LOGGERS, the
+/// logger is disabled at compile time: revng_log does not even evaluate what
+/// it's asked to log.
 template<bool StaticEnabled = true>
 class Logger {
 private:
@@ -48,7 +58,9 @@ public:
   void unindent(unsigned Level = 1);
   void setIndentation(unsigned Level);
 
-  bool isEnabled() const { return StaticEnabled && Enabled; }
+  bool isEnabled() const {
+    return LoggersCompiledIn && StaticEnabled && Enabled;
+  }
   llvm::StringRef name() const { return Name; }
   // TODO: allow optional description
   llvm::StringRef description() const { return ""; }
@@ -76,10 +88,13 @@ public:
   friend void writeToLog(Logger<X> &This, const LogTerminator &T, int Ignore);
 
   template<bool X, typename T, typename LowPrio>
-  friend void writeToLog(Logger<X> &This, const T Other, LowPrio Ignore);
+  friend void writeToLog(Logger<X> &This, const T &Other, LowPrio Ignore);
+
+  template<bool X>
+  friend void writeToLog(Logger<X> &This, const llvm::StringRef &S, int Ign);
 
   std::unique_ptr<llvm::raw_ostream> getAsLLVMStream() {
-    if (Enabled)
+    if (isEnabled())
       return std::make_unique<llvm::raw_os_ostream>(Buffer);
     return std::make_unique<llvm::raw_null_ostream>();
   }
@@ -134,7 +149,7 @@ private:
 ///
 /// For an example see the next specialization.
 template<bool X, typename T, typename LowPrio>
-inline void writeToLog(Logger<X> &This, const T Other, LowPrio) {
+inline void writeToLog(Logger<X> &This, const T &Other, LowPrio) {
   if (This.isEnabled())
     This.Buffer << Other;
 }
@@ -147,8 +162,9 @@ inline void writeToLog(Logger<X> &This, const LogTerminator &LineInfo, int) {
 
 /// Specialization for llvm::StringRef
 template<bool X>
-inline void writeToLog(Logger<X> &This, const llvm::StringRef &S, int Ign) {
-  writeToLog(This, S.str(), Ign);
+inline void writeToLog(Logger<X> &This, const llvm::StringRef &S, int) {
+  if (This.isEnabled())
+    This.Buffer.write(S.data(), S.size());
 }
 
 /// Specialization for llvm::StringRef
@@ -0,0 +1,40 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace llvm::object {
+class ObjectFile;
+} // namespace llvm::object
+
+/// The information about an ELF file that is relevant to resolve its
+/// dependencies, or to use it as a dependency
+struct ELFDynamicInfo {
+  uint16_t EMachine = 0;
+  bool Is64 = false;
+  bool NoDefault = false;
+  std::optional<std::string> RPath;
+  std::optional<std::string> RunPath;
+  std::vector<std::string> Needed;
+};
+
+/// \return the dynamic information of the ELF at \p Path, or std::nullopt if
+///         it does not exist or it's not an ELF
+///
+/// The information is parsed once per process and shared by all the users,
+/// e.g., the binary importer and lddtree. An entry is discarded if the size or
+/// the modification time of the file change.
+std::optional<ELFDynamicInfo> getELFDynamicInfo(const std::string &Path);
+
+/// Same as `getELFDynamicInfo(Path)`, but, if the information is not cached
+/// yet, it's obtained from \p Object, the already parsed content of \p Path,
+/// instead of opening the file again
+std::optional<ELFDynamicInfo>
+getELFDynamicInfo(const std::string &Path,
+                  const llvm::object::ObjectFile &Object);
@@ -54,6 +54,22 @@ public:
   }
   static TagsSet from(const llvm::MDNode *MD);
 
+  /// \return the tag named \p Name, or nullptr if there's none
+  static const Tag *findTag(llvm::StringRef Name);
+
+public:
+  /// Equivalent to `from(V).contains(Target)`, without building the set
+  static bool contains(const Taggable auto *V, const Tag &Target) {
+    return contains(V->getMetadata(TagsMetadataName), Target);
+  }
+  static bool contains(const llvm::MDNode *MD, const Tag &Target);
+
+  /// Equivalent to `from(V).containsExactly(Target)`, without building the set
+  static bool containsExactly(const Taggable auto *V, const Tag &Target) {
+    return containsExactly(V->getMetadata(TagsMetadataName), Target);
+  }
+  static bool containsExactly(const llvm::MDNode *MD, const Tag &Target);
+
 public:
   auto begin() const { return Tags.begin(); }
   auto end() const { return Tags.end(); }
@@ -96,11 +112,11 @@ public:
 
 public:
   bool isTagOf(const Taggable auto *I) const {
-    return TagsSet::from(I).contains(*this);
+    return TagsSet::contains(I, *this);
   }
 
   bool isExactTagOf(const Taggable auto *I) const {
-    return TagsSet::from(I).containsExactly(*this);
+    return TagsSet::containsExactly(I, *this);
   }
 
   auto functions(llvm::Module *M) const {
@@ -21,6 +21,7 @@
 #include "llvm/ADT/SmallPtrSet.h"
 
 #include "revng/Support/Debug.h"
+#include "revng/Support/IndexedGraph.h"
 
 template<typename T>
 struct scc_iterator_traits {
@@ -216,40 +217,6 @@ public:
   InternalMapT::iterator end() { return InternalMap.end(); }
 };
 
-template<FilterSet FilterSetType, class NodeT>
-class DFStackBackedge {
-  using InternalMapT = DFStack<NodeT>::InternalMapT;
-
-private:
-  DFStack<NodeT> VisitStack;
-  llvm::SmallPtrSet<NodeT, 4> &Set;
-
-public:
-  DFStackBackedge(llvm::SmallPtrSet<NodeT, 4> &Set) : Set(Set) {}
-
-  std::pair<typename InternalMapT::iterator, bool> insert(NodeT Block) {
-
-    // If we are trying to insert a valid block, we can process it as normal
-    if ((FilterSetType == FilterSet::WhiteList and Set.contains(Block))
-        or (FilterSetType == FilterSet::BlackList
-            and not Set.contains(Block))) {
-      return VisitStack.insertInMap(Block, true);
-    } else {
-
-      // We want to completely ignore the fact that we inserted an element in
-      // the `DFStack`, otherwise we will explore it anyway, therefore we
-      // manually return `false`, so the node is not explored at all, in
-      // addition of adding it as not on the exploration stack
-      auto InsertIt = VisitStack.insertInMap(Block, false);
-      return std::make_pair(InsertIt.first, false);
-    }
-  }
-
-  bool onStack(NodeT Block) const { return VisitStack.onStack(Block); }
-
-  void completed(NodeT Block) { return VisitStack.completed(Block); }
-};
-
 } // namespace revng::detail
 
 // TODO: remove the `BlackList`/`WhiteList` parameter once the last use in
@@ -261,26 +228,22 @@ llvm::SmallSetVector<revng::detail::EdgeDescriptor<typename GT::NodeRef>, 4>
 getBackedgesImpl(GraphT Block,
                  llvm::SmallPtrSet<typename GT::NodeRef, 4> &Set) {
   using NodeRef = typename GT::NodeRef;
-  using StateType = typename revng::detail::DFStackBackedge<FilterSetType,
-                                                            NodeRef>;
   using EdgeDescriptor = revng::detail::EdgeDescriptor<NodeRef>;
-  StateType State(Set);
 
-  llvm::SmallSetVector<EdgeDescriptor, 4> Backedges;
+  auto IsAllowed = [&Set](NodeRef Node) {
+    if constexpr (FilterSetType == revng::detail::FilterSet::WhiteList)
+      return Set.contains(Node);
+    else
+      return not Set.contains(Node);
+  };
 
-  // Declare manually a custom `df_iterator`
-  using bdf_iterator = llvm::df_iterator<GraphT, StateType, true, GT>;
-  auto Begin = bdf_iterator::begin(Block, State);
-  auto End = bdf_iterator::end(Block, State);
+  // Nodes excluded by the filter are never explored, hence they never end up
+  // on the visit stack
+  revng::IndexedGraph<GraphT, GT> View(Block, IsAllowed);
 
-  for (NodeRef Block : llvm::make_range(Begin, End)) {
-    for (NodeRef Succ :
-         llvm::make_range(GT::child_begin(Block), GT::child_end(Block))) {
-      if (State.onStack(Succ)) {
-        Backedges.insert(EdgeDescriptor(Block, Succ));
-      }
-    }
-  }
+  llvm::SmallSetVector<EdgeDescriptor, 4> Backedges;
+  for (auto [From, To] : View.backedges())
+    Backedges.insert(EdgeDescriptor(View.node(From), View.node(To)));
 
   return Backedges;
 }
@@ -439,12 +402,5 @@ nodesBetweenReverse(GraphT Source, GraphT Destination) {
 
 template<class GraphT>
 bool isDAG(GraphT Graph) {
-  for (llvm::scc_iterator<GraphT> I = llvm::scc_begin(Graph),
-                                  IE = llvm::scc_end(Graph);
-       I != IE;
-       ++I) {
-    if (I.hasCycle())
-      return false;
-  }
-  return true;
+  return revng::IndexedGraph<GraphT>(Graph).backedges().empty();
 }
@@ -4,6 +4,8 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <vector>
+
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -29,6 +31,12 @@ struct OffsetDescriptor {
   size_t paddingSize() { return End - PaddingStart; }
 };
 
+/// The compression of the streams of an archive produced by GzipTarWriter
+enum class TarCompression {
+  Gzip,
+  Zstd
+};
+
 /// Class that allows writing a '.tar.gz' file conforming to the PAX archive
 /// format. The archive is created with these additional properties:
 /// * The header of each file is a stand-alone gzip stream
@@ -52,13 +60,20 @@ struct OffsetDescriptor {
 /// Additionally, since the gzip standard allows concatenating streams, the file
 /// produced is still a valid '.tar.gz' file that can be opened by any program
 /// that supports "ordinary" '.tar.gz' files.
+///
+/// With TarCompression::Zstd each stream is a zstd frame instead, which is
+/// much faster to decompress. Since zstd frames can be concatenated too, the
+/// result is an ordinary '.tar.zst' file with the same properties.
 class GzipTarWriter {
 private:
   llvm::raw_ostream *OS = nullptr;
   llvm::StringSet<> Filenames;
+  TarCompression Compression = TarCompression::Gzip;
 
 public:
-  GzipTarWriter(llvm::raw_ostream &OS) : OS(&OS){};
+  GzipTarWriter(llvm::raw_ostream &OS,
+                TarCompression Compression = TarCompression::Gzip) :
+    OS(&OS), Compression(Compression){};
   ~GzipTarWriter() { revng_assert(OS == nullptr); }
 
   GzipTarWriter(const GzipTarWriter &Other) = delete;
@@ -68,14 +83,34 @@ public:
   GzipTarWriter &operator=(GzipTarWriter &&Other) = default;
 
   OffsetDescriptor append(llvm::StringRef Name, llvm::ArrayRef<char> Data);
+
+  struct File {
+    llvm::StringRef Name;
+    llvm::ArrayRef<char> Data;
+  };
+
+  /// Equivalent to invoking ::append on each element of \p Files, in order,
+  /// but the files are compressed in parallel
+  std::vector<OffsetDescriptor> appendAll(llvm::ArrayRef<File> Files);
+
   void close();
 };
 
+/// Decompress a single file of an archive produced by GzipTarWriter without
+/// decompressing the rest of the archive. \p DataStart and \p PaddingStart are
+/// the homonymous fields of the OffsetDescriptor returned by
+/// GzipTarWriter::append. The compression of the entry is detected
+/// automatically.
+llvm::SmallVector<char, 0> readGzipTarEntry(llvm::ArrayRef<char> Archive,
+                                            size_t DataStart,
+                                            size_t PaddingStart);
+
 struct ArchiveEntry {
   std::string Filename;
   llvm::SmallVector<char> Data;
 };
 
+/// Reader for archives produced by GzipTarWriter, with either compression
 class GzipTarReader {
 private:
   archive *Archive = nullptr;
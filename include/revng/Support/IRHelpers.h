@@ -9,6 +9,7 @@
 #include <sstream>
 #include <type_traits>
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/iterator_range.h"
@@ -1236,6 +1237,49 @@ inline bool replaceAllUsesInFunctionWith(llvm::Function *F,
   return Changed;
 }
 
+/// Replace all the uses in \p F of each key of \p Replacements with the
+/// corresponding value
+///
+/// This is equivalent to invoking replaceAllUsesInFunctionWith for each entry,
+/// but \p F is visited once, instead of going through all the uses of each
+/// value, most of which might be outside of \p F.
+inline bool replaceAllUsesInFunctionWith(llvm::Function *F,
+                                         const llvm::DenseMap<llvm::Value *,
+                                                              llvm::Value *>
+                                           &Replacements) {
+  using namespace llvm;
+  bool Changed = false;
+
+  for (BasicBlock &BB : *F) {
+    for (Instruction &I : BB) {
+      for (Use &U : I.operands()) {
+        auto *CE = dyn_cast<ConstantExpr>(U.get());
+        bool IsCast = CE != nullptr and CE->isCast();
+        Value *Old = IsCast ? CE->getOperand(0) : U.get();
+
+        auto It = Replacements.find(Old);
+        if (It == Replacements.end() or It->second == Old)
+          continue;
+
+        if (IsCast) {
+          // The ConstantExpr might be used outside of F: create an equivalent
+          // instruction and perform the replacement only there
+          Instruction *CastInst = CE->getAsInstruction();
+          CastInst->replaceUsesOfWith(Old, It->second);
+          CastInst->insertBefore(&I);
+          U.set(CastInst);
+        } else {
+          U.set(It->second);
+        }
+
+        Changed = true;
+      }
+    }
+  }
+
+  return Changed;
+}
+
 /// Checks if \p I is a marker
 ///
 /// A marker a function call to an empty function acting as meta-information,
@@ -0,0 +1,445 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/GraphTraits.h"
+
+#include "revng/Support/Assert.h"
+
+namespace revng {
+
+/// A compact, index-based copy of the nodes of a graph reachable from its entry
+/// node, for any graph exposing `llvm::GraphTraits`.
+///
+/// Nodes are numbered in depth-first preorder, starting from the entry node (0)
+/// and the successors (and the predecessors) of each node are stored
+/// contiguously (CSR), preserving the order of `GraphTraits`. This makes
+/// repeated visits cheap and the results easy to store in vectors.
+///
+/// All the algorithms are iterative, so that they do not exhaust the stack on
+/// large graphs.
+///
+/// \note the view is a snapshot: it has to be rebuilt if the graph changes.
+template<class GraphT, class GT = llvm::GraphTraits<GraphT>>
+class IndexedGraph {
+public:
+  using NodeRef = typename GT::NodeRef;
+  using Edge = std::pair<unsigned, unsigned>;
+
+  static constexpr unsigned Invalid = std::numeric_limits<unsigned>::max();
+
+  /// The strongly connected components of the graph. Components are numbered
+  /// in reverse topological order, i.e., the successors of a component have a
+  /// lower number, as for `llvm::scc_iterator`.
+  struct SCCs {
+    std::vector<unsigned> ComponentOf;
+    std::vector<std::vector<unsigned>> Components;
+  };
+
+private:
+  using ChildIterator = typename GT::ChildIteratorType;
+
+private:
+  std::vector<NodeRef> Nodes;
+  llvm::DenseMap<NodeRef, unsigned> Indices;
+
+  /// The successors of node I are in [SuccessorsBegin[I], SuccessorsBegin[I+1])
+  std::vector<unsigned> SuccessorsBegin;
+  std::vector<unsigned> Successors;
+
+  std::vector<unsigned> PredecessorsBegin;
+  std::vector<unsigned> Predecessors;
+
+public:
+  explicit IndexedGraph(GraphT Graph) :
+    IndexedGraph(Graph, [](NodeRef) { return true; }) {}
+
+  /// Build the view considering only the nodes for which \p IsAllowed returns
+  /// true: the others, and their edges, are ignored
+  template<typename FilterType>
+  IndexedGraph(GraphT Graph, FilterType &&IsAllowed) {
+    NodeRef Entry = GT::getEntryNode(Graph);
+    if (IsAllowed(Entry))
+      number(Entry, IsAllowed);
+    buildEdges();
+  }
+
+public:
+  unsigned size() const { return Nodes.size(); }
+  bool empty() const { return Nodes.empty(); }
+
+  NodeRef node(unsigned Index) const { return Nodes[Index]; }
+  llvm::ArrayRef<NodeRef> nodes() const { return Nodes; }
+
+  bool contains(NodeRef Node) const { return Indices.count(Node) != 0; }
+
+  /// \return the index of \p Node, or Invalid if it's not part of the view
+  unsigned index(NodeRef Node) const {
+    auto It = Indices.find(Node);
+    return It == Indices.end() ? Invalid : It->second;
+  }
+
+  llvm::ArrayRef<unsigned> successors(unsigned Index) const {
+    return slice(Successors, SuccessorsBegin, Index);
+  }
+
+  llvm::ArrayRef<unsigned> predecessors(unsigned Index) const {
+    return slice(Predecessors, PredecessorsBegin, Index);
+  }
+
+public:
+  /// \return the nodes in post order
+  std::vector<unsigned> postOrder() const {
+    std::vector<unsigned> Result;
+    Result.reserve(size());
+    depthFirstVisit(
+      [](unsigned, unsigned, bool) {},
+      [&Result](unsigned Node) { Result.push_back(Node); });
+    return Result;
+  }
+
+  /// \return the nodes in reverse post order
+  std::vector<unsigned> reversePostOrder() const {
+    std::vector<unsigned> Result = postOrder();
+    std::reverse(Result.begin(), Result.end());
+    return Result;
+  }
+
+  /// \return the edges whose destination is on the depth-first visit stack,
+  ///         sorted by the preorder number of the source, then in successor
+  ///         order
+  std::vector<Edge> backedges() const {
+    std::vector<Edge> Result;
+    depthFirstVisit(
+      [&Result](unsigned From, unsigned To, bool OnStack) {
+        if (OnStack)
+          Result.emplace_back(From, To);
+      },
+      [](unsigned) {});
+
+    // Edges are discovered in visit order, sort them by source (preorder)
+    auto BySource = [](const Edge &A, const Edge &B) {
+      return A.first < B.first;
+    };
+    std::stable_sort(Result.begin(), Result.end(), BySource);
+    return Result;
+  }
+
+  /// Iterative Tarjan's algorithm
+  SCCs stronglyConnectedComponents() const {
+    SCCs Result;
+    Result.ComponentOf.assign(size(), Invalid);
+
+    std::vector<unsigned> LowLink(size(), Invalid);
+    std::vector<unsigned> Order(size(), Invalid);
+    std::vector<unsigned> Stack;
+    llvm::BitVector OnStack(size());
+    unsigned NextOrder = 0;
+
+    // (node, index of the next successor to visit)
+    std::vector<std::pair<unsigned, unsigned>> VisitStack;
+    for (unsigned Root = 0; Root < size(); ++Root) {
+      if (Order[Root] != Invalid)
+        continue;
+
+      auto Enter = [&](unsigned Node) {
+        Order[Node] = LowLink[Node] = NextOrder++;
+        Stack.push_back(Node);
+        OnStack.set(Node);
+        VisitStack.emplace_back(Node, 0);
+      };
+
+      Enter(Root);
+      while (not VisitStack.empty()) {
+        auto &[Node, Next] = VisitStack.back();
+        llvm::ArrayRef<unsigned> Children = successors(Node);
+        if (Next < Children.size()) {
+          unsigned Child = Children[Next++];
+          if (Order[Child] == Invalid)
+            Enter(Child);
+          else if (OnStack.test(Child))
+            LowLink[Node] = std::min(LowLink[Node], Order[Child]);
+          continue;
+        }
+
+        unsigned Completed = Node;
+        VisitStack.pop_back();
+        if (not VisitStack.empty()) {
+          unsigned Parent = VisitStack.back().first;
+          LowLink[Parent] = std::min(LowLink[Parent], LowLink[Completed]);
+        }
+
+        if (LowLink[Completed] != Order[Completed])
+          continue;
+
+        // Completed is the root of a component: pop it
+        unsigned ComponentIndex = Result.Components.size();
+        auto &Component = Result.Components.emplace_back();
+        unsigned Member = Invalid;
+        do {
+          Member = Stack.back();
+          Stack.pop_back();
+          OnStack.reset(Member);
+          Result.ComponentOf[Member] = ComponentIndex;
+          Component.push_back(Member);
+        } while (Member != Completed);
+      }
+    }
+
+    return Result;
+  }
+
+  /// Compute the immediate dominators using the algorithm described in "A
+  /// Simple, Fast Dominance Algorithm" by Cooper, Harvey and Kennedy.
+  ///
+  /// \return a vector associating to each node its immediate dominator. The
+  ///         entry node is its own immediate dominator.
+  std::vector<unsigned> immediateDominators() const {
+    std::vector<unsigned> Result(size(), Invalid);
+    if (empty())
+      return Result;
+
+    std::vector<unsigned> RPO = reversePostOrder();
+    std::vector<unsigned> RPONumber(size());
+    for (unsigned I = 0; I < RPO.size(); ++I)
+      RPONumber[RPO[I]] = I;
+
+    auto Intersect = [&](unsigned A, unsigned B) {
+      while (A != B) {
+        while (RPONumber[A] > RPONumber[B])
+          A = Result[A];
+        while (RPONumber[B] > RPONumber[A])
+          B = Result[B];
+      }
+      return A;
+    };
+
+    Result[0] = 0;
+    bool Changed = true;
+    while (Changed) {
+      Changed = false;
+      for (unsigned Node : llvm::ArrayRef(RPO).drop_front()) {
+        unsigned NewIDom = Invalid;
+        for (unsigned Predecessor : predecessors(Node)) {
+          if (Result[Predecessor] == Invalid)
+            continue;
+          if (NewIDom == Invalid)
+            NewIDom = Predecessor;
+          else
+            NewIDom = Intersect(Predecessor, NewIDom);
+        }
+
+        revng_assert(NewIDom != Invalid);
+        if (Result[Node] != NewIDom) {
+          Result[Node] = NewIDom;
+          Changed = true;
+        }
+      }
+    }
+
+    return Result;
+  }
+
+private:
+  template<typename FilterType>
+  void number(NodeRef Entry, FilterType &IsAllowed) {
+    auto Enter = [this](NodeRef Node) {
+      Indices[Node] = Nodes.size();
+      Nodes.push_back(Node);
+    };
+
+    std::vector<std::pair<NodeRef, ChildIterator>> Stack;
+    Enter(Entry);
+    Stack.emplace_back(Entry, GT::child_begin(Entry));
+    while (not Stack.empty()) {
+      auto &[Node, Next] = Stack.back();
+      if (Next == GT::child_end(Node)) {
+        Stack.pop_back();
+        continue;
+      }
+
+      NodeRef Child = *Next;
+      ++Next;
+      if (Indices.count(Child) == 0 and IsAllowed(Child)) {
+        Enter(Child);
+        Stack.emplace_back(Child, GT::child_begin(Child));
+      }
+    }
+  }
+
+  void buildEdges() {
+    SuccessorsBegin.reserve(size() + 1);
+    std::vector<unsigned> PredecessorsCount(size(), 0);
+    for (NodeRef Node : Nodes) {
+      SuccessorsBegin.push_back(Successors.size());
+      for (auto It = GT::child_begin(Node), End = GT::child_end(Node);
+           It != End;
+           ++It) {
+        unsigned Index = index(*It);
+        if (Index == Invalid)
+          continue;
+        Successors.push_back(Index);
+        ++PredecessorsCount[Index];
+      }
+    }
+    SuccessorsBegin.push_back(Successors.size());
+
+    // Counting sort of the edges by their destination
+    PredecessorsBegin.assign(size() + 1, 0);
+    for (unsigned I = 0; I < size(); ++I)
+      PredecessorsBegin[I + 1] = PredecessorsBegin[I] + PredecessorsCount[I];
+
+    Predecessors.resize(Successors.size());
+    std::vector<unsigned> Cursor(PredecessorsBegin.begin(),
+                                 PredecessorsBegin.end() - 1);
+    for (unsigned From = 0; From < size(); ++From)
+      for (unsigned To : successors(From))
+        Predecessors[Cursor[To]++] = From;
+  }
+
+  static llvm::ArrayRef<unsigned> slice(const std::vector<unsigned> &Edges,
+                                        const std::vector<unsigned> &Begin,
+                                        unsigned Index) {
+    revng_assert(Index < Begin.size() - 1);
+    return llvm::ArrayRef(Edges).slice(Begin[Index],
+                                       Begin[Index + 1] - Begin[Index]);
+  }
+
+  /// Depth-first visit from the entry node. \p OnEdge is invoked on each edge
+  /// with a flag indicating whether its destination is on the visit stack,
+  /// \p OnCompleted when all the successors of a node have been visited.
+  template<typename EdgeVisitor, typename CompletedVisitor>
+  void depthFirstVisit(EdgeVisitor &&OnEdge,
+                       CompletedVisitor &&OnCompleted) const {
+    if (empty())
+      return;
+
+    llvm::BitVector Visited(size());
+    llvm::BitVector OnStack(size());
+    std::vector<std::pair<unsigned, unsigned>> Stack;
+
+    Visited.set(0);
+    OnStack.set(0);
+    Stack.emplace_back(0, 0);
+    while (not Stack.empty()) {
+      auto &[Node, Next] = Stack.back();
+      llvm::ArrayRef<unsigned> Children = successors(Node);
+      if (Next == Children.size()) {
+        OnStack.reset(Node);
+        OnCompleted(Node);
+        Stack.pop_back();
+        continue;
+      }
+
+      unsigned From = Node;
+      unsigned Child = Children[Next++];
+      OnEdge(From, Child, OnStack.test(Child));
+      if (not Visited.test(Child)) {
+        Visited.set(Child);
+        OnStack.set(Child);
+        Stack.emplace_back(Child, 0);
+      }
+    }
+  }
+};
+
+/// Lazily computes and caches the results of the most common analyses on a
+/// graph, so that clients running them repeatedly on the same graph pay for
+/// them only once.
+///
+/// The cache cannot observe changes to the graph: whoever mutates it has to
+/// call `invalidate`.
+template<class GraphT, class GT = llvm::GraphTraits<GraphT>>
+class GraphAnalysisCache {
+public:
+  using View = IndexedGraph<GraphT, GT>;
+  using NodeRef = typename View::NodeRef;
+
+private:
+  GraphT Graph;
+  std::optional<View> TheView;
+  std::optional<std::vector<unsigned>> RPO;
+  std::optional<std::vector<unsigned>> RPONumbers;
+  std::optional<typename View::SCCs> TheSCCs;
+  std::optional<std::vector<unsigned>> IDoms;
+
+public:
+  explicit GraphAnalysisCache(GraphT Graph) : Graph(Graph) {}
+
+public:
+  /// Drop all the cached results, to be called after the graph changes
+  void invalidate() {
+    TheView.reset();
+    RPO.reset();
+    RPONumbers.reset();
+    TheSCCs.reset();
+    IDoms.reset();
+  }
+
+public:
+  const View &view() {
+    if (not TheView)
+      TheView.emplace(Graph);
+    return *TheView;
+  }
+
+  llvm::ArrayRef<unsigned> reversePostOrder() {
+    if (not RPO)
+      RPO = view().reversePostOrder();
+    return *RPO;
+  }
+
+  /// \return the position of \p Node in reverse post order, or View::Invalid
+  ///         if it's not reachable from the entry node
+  unsigned rpoNumber(NodeRef Node) {
+    if (not RPONumbers) {
+      std::vector<unsigned> Numbers(view().size(), View::Invalid);
+      llvm::ArrayRef<unsigned> Order = reversePostOrder();
+      for (unsigned I = 0; I < Order.size(); ++I)
+        Numbers[Order[I]] = I;
+      RPONumbers = std::move(Numbers);
+    }
+
+    unsigned Index = view().index(Node);
+    return Index == View::Invalid ? View::Invalid : (*RPONumbers)[Index];
+  }
+
+  const typename View::SCCs &stronglyConnectedComponents() {
+    if (not TheSCCs)
+      TheSCCs = view().stronglyConnectedComponents();
+    return *TheSCCs;
+  }
+
+  llvm::ArrayRef<unsigned> immediateDominators() {
+    if (not IDoms)
+      IDoms = view().immediateDominators();
+    return *IDoms;
+  }
+
+  /// \return true if \p A dominates \p B. Unreachable nodes are dominated by
+  ///         no one.
+  bool dominates(NodeRef A, NodeRef B) {
+    unsigned Dominator = view().index(A);
+    unsigned Node = view().index(B);
+    if (Dominator == View::Invalid or Node == View::Invalid)
+      return false;
+
+    llvm::ArrayRef<unsigned> Tree = immediateDominators();
+    while (Node != Dominator and Node != 0)
+      Node = Tree[Node];
+    return Node == Dominator;
+  }
+};
+
+} // namespace revng
@@ -4,6 +4,10 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <compare>
+
+#include "llvm/ADT/DenseMapInfo.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Triple.h"
 
@@ -577,10 +581,31 @@ public:
     return Features(*MetaAddressType::arch(type()), Epoch, AddressSpace);
   }
 
+public:
+  /// A MetaAddress packed in two 64-bit words, ordered as MetaAddress itself
+  ///
+  /// The first word holds the epoch, the address space and the type, the
+  /// second one holds the address. Comparing two words is cheaper than
+  /// comparing the four fields one after the other.
+  struct Packed {
+    uint64_t Features = 0;
+    uint64_t Address = 0;
+
+    constexpr bool operator==(const Packed &Other) const = default;
+    constexpr auto operator<=>(const Packed &Other) const = default;
+  };
+
+  constexpr Packed packed() const {
+    return { (static_cast<uint64_t>(Epoch) << 32)
+               | (static_cast<uint64_t>(AddressSpace) << 16)
+               | static_cast<uint64_t>(Type),
+             Address };
+  }
+
 public:
   /// @{
   constexpr bool operator==(const MetaAddress &Other) const {
-    return tie() == Other.tie();
+    return packed() == Other.packed();
   }
 
   constexpr bool operator!=(const MetaAddress &Other) const {
@@ -588,16 +613,16 @@ public:
   }
 
   constexpr bool operator<(const MetaAddress &Other) const {
-    return tie() < Other.tie();
+    return packed() < Other.packed();
   }
   constexpr bool operator<=(const MetaAddress &Other) const {
-    return tie() <= Other.tie();
+    return packed() <= Other.packed();
   }
   constexpr bool operator>(const MetaAddress &Other) const {
-    return tie() > Other.tie();
+    return packed() > Other.packed();
   }
   constexpr bool operator>=(const MetaAddress &Other) const {
-    return tie() >= Other.tie();
+    return packed() >= Other.packed();
   }
 
   /// @}
@@ -942,12 +967,16 @@ public:
   static MetaAddress fromString(llvm::StringRef Text);
 
 private:
-  using Tied = std::tuple<const uint32_t &,
-                          const uint16_t &,
-                          const uint16_t &,
-                          const uint64_t &>;
-  constexpr Tied tie() const {
-    return std::tie(Epoch, AddressSpace, Type, Address);
+  friend struct llvm::DenseMapInfo<MetaAddress>;
+
+  /// Build a MetaAddress from its packed form without validating it
+  static constexpr MetaAddress fromPackedUnchecked(Packed Key) {
+    MetaAddress Result;
+    Result.Epoch = static_cast<uint32_t>(Key.Features >> 32);
+    Result.AddressSpace = static_cast<uint16_t>(Key.Features >> 16);
+    Result.Type = static_cast<uint16_t>(Key.Features);
+    Result.Address = Key.Address;
+    return Result;
   }
 };
 
@@ -968,15 +997,37 @@ template<>
 struct KeyedObjectTraits<MetaAddress>
   : public IdentityKeyedObjectTraits<MetaAddress> {};
 
+/// \note the empty and tombstone keys use an invalid type, so they can never
+///       collide with an instance of MetaAddress built in the usual ways
+template<>
+struct llvm::DenseMapInfo<MetaAddress> {
+  using PackedInfo = llvm::DenseMapInfo<std::pair<uint64_t, uint64_t>>;
+
+  static constexpr MetaAddress getEmptyKey() {
+    return MetaAddress::fromPackedUnchecked({ ~uint64_t(0), 0 });
+  }
+
+  static constexpr MetaAddress getTombstoneKey() {
+    return MetaAddress::fromPackedUnchecked({ ~uint64_t(0), 1 });
+  }
+
+  static unsigned getHashValue(const MetaAddress &Address) {
+    MetaAddress::Packed Key = Address.packed();
+    return PackedInfo::getHashValue({ Key.Features, Key.Address });
+  }
+
+  static bool isEqual(const MetaAddress &LHS, const MetaAddress &RHS) {
+    return LHS == RHS;
+  }
+};
+
 namespace std {
 template<>
 class hash<MetaAddress> {
 public:
   uint64_t operator()(const MetaAddress &Address) const {
-    return hash_combine(Address.arch(),
-                        Address.address(),
-                        Address.epoch(),
-                        Address.addressSpace());
+    MetaAddress::Packed Key = Address.packed();
+    return llvm::hash_combine(Key.Features, Key.Address);
   }
 };
 } // namespace std
@@ -46,6 +46,32 @@ public:
     return Result;
   }
 
+public:
+  /// Add all the elements of \p Other, as if they had been pushed here
+  void merge(const ListStatistics &Other) {
+    if (Other.ElementsCount == 0)
+      return;
+
+    if (ElementsCount == 0) {
+      *this = Other;
+      return;
+    }
+
+    // See Chan, Golub, LeVeque, "Updating formulae and a pairwise algorithm
+    // for computing sample variances", 1979
+    double Count = ElementsCount;
+    double OtherCount = Other.ElementsCount;
+    double Total = Count + OtherCount;
+    double Delta = Other.NewM - NewM;
+    NewM = NewM + Delta * OtherCount / Total;
+    NewS = NewS + Other.NewS + Delta * Delta * Count * OtherCount / Total;
+    OldM = NewM;
+    OldS = NewS;
+
+    ElementsCount += Other.ElementsCount;
+    Sum += Other.Sum;
+  }
+
 public:
   void push(unsigned NewElement) {
     ++ElementsCount;
@@ -86,11 +112,40 @@ public:
     }
   }
 
+  void merge(const FunctionClass &Other) {
+    DeclarationsCount += Other.DeclarationsCount;
+    DefinitionsCount += Other.DefinitionsCount;
+    InstructionsStatistics.merge(Other.InstructionsStatistics);
+  }
+
   void dump(llvm::raw_ostream &Output,
             unsigned Indent,
             const FunctionClass *Old = nullptr) const;
 };
 
+/// The statistics about the functions of a module, overall and by tag
+class FunctionsStatistics {
+public:
+  FunctionClass AllFunctions;
+  std::map<const FunctionTags::Tag *, FunctionClass> TaggedFunctions;
+
+public:
+  void process(const llvm::Function &F);
+
+  void merge(const FunctionsStatistics &Other) {
+    AllFunctions.merge(Other.AllFunctions);
+    for (const auto &[Tag, Class] : Other.TaggedFunctions)
+      TaggedFunctions[Tag].merge(Class);
+  }
+
+public:
+  /// Measure the functions of \p M, in parallel
+  ///
+  /// This is much cheaper than ModuleStatistics::analyze, since it doesn't
+  /// look at types and debug information.
+  static FunctionsStatistics analyze(const llvm::Module &M);
+};
+
 class ModuleStatistics {
 private:
   unsigned NamedGlobalsCount = 0;
@@ -103,8 +158,7 @@ private:
   unsigned MaxArrayElements = 0;
   unsigned MaxStructElements = 0;
 
-  FunctionClass AllFunctions;
-  std::map<const FunctionTags::Tag *, FunctionClass> TaggedFunctions;
+  FunctionsStatistics Functions;
 
   unsigned NamedStructsCount = 0;
   unsigned AnonymousStructsCount = 0;
@@ -118,6 +172,8 @@ private:
 public:
   static ModuleStatistics analyze(const llvm::Module &M);
 
+  const FunctionsStatistics &functions() const { return Functions; }
+
   void dump() const debug_function {
     std::string Result;
     {
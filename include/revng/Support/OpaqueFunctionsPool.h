@@ -4,8 +4,10 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
-#include <map>
+#include <string>
+#include <unordered_map>
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/IR/Attributes.h"
 #include "llvm/IR/DerivedTypes.h"
@@ -22,12 +24,27 @@ template<typename T>
 concept PointerToLLVMTypeOrDerived = std::derived_from<std::remove_pointer_t<T>,
                                                        llvm::Type>;
 
+namespace detail {
+
+/// The hash table used by OpaqueFunctionsPool to map keys to functions
+template<typename KeyT>
+struct OpaqueFunctionsMap {
+  using type = llvm::DenseMap<KeyT, llvm::Function *>;
+};
+
+template<>
+struct OpaqueFunctionsMap<std::string> {
+  using type = std::unordered_map<std::string, llvm::Function *>;
+};
+
+} // namespace detail
+
 template<typename KeyT>
 class OpaqueFunctionsPool {
 private:
   llvm::Module *M;
   const bool PurgeOnDestruction;
-  std::map<KeyT, llvm::Function *> Pool;
+  typename detail::OpaqueFunctionsMap<KeyT>::type Pool;
   llvm::AttributeList AttributeSets;
   llvm::MemoryEffects MemoryEffects = llvm::MemoryEffects::none();
   FunctionTags::TagsSet Tags;
@@ -63,11 +80,14 @@ public:
 
 public:
   void record(KeyT Key, llvm::Function *F) {
+    auto [It, New] = Pool.try_emplace(std::move(Key), F);
+    revng_assert(New or It->second == F);
+  }
+
+  /// \return the function associated to \p Key, if any, without creating it
+  llvm::Function *find(const KeyT &Key) const {
     auto It = Pool.find(Key);
-    if (It == Pool.end())
-      Pool[Key] = F;
-    else
-      revng_assert(It->second == F);
+    return It == Pool.end() ? nullptr : It->second;
   }
 
 public:
@@ -75,17 +95,18 @@ public:
   get(KeyT Key, llvm::FunctionType *FT, const llvm::Twine &Name = {}) {
     using namespace llvm;
 
-    Function *F = nullptr;
-    auto It = Pool.find(Key);
-    if (It != Pool.end()) {
-      F = It->second;
-    } else {
-      F = Function::Create(FT, GlobalValue::ExternalLinkage, Name, M);
-      F->setAttributes(AttributeSets);
-      F->setMemoryEffects(MemoryEffects);
-      Tags.set(F);
-      Pool.insert(It, { Key, F });
+    auto [It, New] = Pool.try_emplace(std::move(Key), nullptr);
+    if (New) {
+      auto *NewFunction = Function::Create(FT,
+                                           GlobalValue::ExternalLinkage,
+                                           Name,
+                                           M);
+      NewFunction->setAttributes(AttributeSets);
+      NewFunction->setMemoryEffects(MemoryEffects);
+      Tags.set(NewFunction);
+      It->second = NewFunction;
     }
+    Function *F = It->second;
 
     // Ensure the function we're returning is as expected
     revng_assert(F->getFunctionType() == FT);
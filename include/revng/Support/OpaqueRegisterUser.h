@@ -28,19 +28,26 @@ public:
     Clobberers.addFnAttribute(Attribute::NoUnwind);
     Clobberers.addFnAttribute(Attribute::WillReturn);
     Clobberers.setTags({ &FunctionTags::ClobbererFunction });
-    Clobberers.initializeFromName(FunctionTags::ClobbererFunction);
 
     Writers.setMemoryEffects(MemoryEffects::readOnly());
     Writers.addFnAttribute(Attribute::NoUnwind);
     Writers.addFnAttribute(Attribute::WillReturn);
     Writers.setTags({ &FunctionTags::WriterFunction });
-    Writers.initializeFromName(FunctionTags::WriterFunction);
 
     Readers.setMemoryEffects(MemoryEffects::inaccessibleMemOnly());
     Readers.addFnAttribute(Attribute::NoUnwind);
     Readers.addFnAttribute(Attribute::WillReturn);
     Readers.setTags({ &FunctionTags::ReaderFunction });
-    Readers.initializeFromName(FunctionTags::ReaderFunction);
+
+    // Seed all the pools with a single scan of the module
+    for (Function &F : M->functions()) {
+      if (FunctionTags::ClobbererFunction.isTagOf(&F))
+        Clobberers.record(F.getName().str(), &F);
+      if (FunctionTags::WriterFunction.isTagOf(&F))
+        Writers.record(F.getName().str(), &F);
+      if (FunctionTags::ReaderFunction.isTagOf(&F))
+        Readers.record(F.getName().str(), &F);
+    }
   }
 
 public:
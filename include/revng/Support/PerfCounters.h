@@ -0,0 +1,86 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <cstdint>
+#include <string>
+
+#include "revng/Support/Statistics.h"
+
+namespace revng {
+
+/// Values of the hardware performance counters of a thread
+struct PerfCounterValues {
+  uint64_t Cycles = 0;
+  uint64_t Instructions = 0;
+  uint64_t CacheMisses = 0;
+  uint64_t BranchMisses = 0;
+
+  PerfCounterValues operator-(const PerfCounterValues &Other) const {
+    return { Cycles - Other.Cycles,
+             Instructions - Other.Instructions,
+             CacheMisses - Other.CacheMisses,
+             BranchMisses - Other.BranchMisses };
+  }
+};
+
+/// Hardware performance counters of the calling thread, through perf_event
+///
+/// Counters are collected only if requested through -perf-counters. The
+/// counters of a thread are opened the first time they are read from it.
+class PerfCounters {
+public:
+  /// \return true if the counters have been requested and the system provides
+  ///         them (e.g., perf_event_paranoid allows it)
+  static bool isEnabled();
+
+  /// \return the current values of the counters of the calling thread, or all
+  ///         zeros if they are not enabled
+  static PerfCounterValues read();
+};
+
+/// Accumulate the hardware counters measured during the lifetime of this object
+/// in a CounterMap, which can then be exported as any other statistic
+///
+/// Typical usage:
+///
+///     static CounterMap<std::string> LookupCounters("jtm-lookup-counters");
+///
+///     {
+///       PerfCountersRegion Region(LookupCounters);
+///       // ...
+///     }
+///
+/// This costs a single check when the counters are not enabled.
+class PerfCountersRegion {
+private:
+  CounterMap<std::string> *Totals = nullptr;
+  PerfCounterValues Start;
+
+public:
+  PerfCountersRegion(CounterMap<std::string> &Totals) {
+    if (PerfCounters::isEnabled()) {
+      this->Totals = &Totals;
+      Start = PerfCounters::read();
+    }
+  }
+
+  ~PerfCountersRegion() {
+    if (Totals == nullptr)
+      return;
+
+    PerfCounterValues Delta = PerfCounters::read() - Start;
+    Totals->push("regions");
+    Totals->push("cycles", Delta.Cycles);
+    Totals->push("instructions", Delta.Instructions);
+    Totals->push("cache-misses", Delta.CacheMisses);
+    Totals->push("branch-misses", Delta.BranchMisses);
+  }
+
+  PerfCountersRegion(const PerfCountersRegion &) = delete;
+  PerfCountersRegion &operator=(const PerfCountersRegion &) = delete;
+};
+
+} // namespace revng
@@ -4,6 +4,7 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <optional>
 #include <string>
 
 #include "llvm/ADT/ArrayRef.h"
@@ -23,6 +24,19 @@ public:
   /// returns the exit code of the program.
   [[nodiscard]] int run(llvm::StringRef ProgramName,
                         llvm::ArrayRef<std::string> Args);
+
+  /// Like run, but \p ProgramName must be the `revng` driver, which is asked
+  /// to run the command through a pool of persistent `revng helper-server`
+  /// processes. This avoids paying the startup of the Python interpreter on
+  /// each invocation. Falls back to run if the helpers are disabled
+  /// (-program-runner-helpers=false) or cannot be used.
+  ///
+  /// \returns the exit code of the command.
+  [[nodiscard]] int runRevngCommand(llvm::StringRef ProgramName,
+                                    llvm::ArrayRef<std::string> Args);
+
+private:
+  std::optional<std::string> findProgram(llvm::StringRef ProgramName);
 };
 
 extern ProgramRunner Runner;
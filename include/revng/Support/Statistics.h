@@ -5,10 +5,12 @@
 //
 
 #include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/JSON.h"
 
 #include "revng/Support/Debug.h"
 #include "revng/Support/OnQuit.h"
@@ -29,12 +31,47 @@ inline size_t digitsCount(T Value) {
   return Digits;
 }
 
+/// Base class of the named statistics, which register themselves in the
+/// StatisticsRegistry so that they can be exported all together
+class RegisteredStatistics {
+public:
+  RegisteredStatistics();
+  RegisteredStatistics(const RegisteredStatistics &) = delete;
+  RegisteredStatistics &operator=(const RegisteredStatistics &) = delete;
+  virtual ~RegisteredStatistics();
+
+public:
+  virtual llvm::StringRef name() const = 0;
+  virtual void toJSON(llvm::json::OStream &Output) const = 0;
+};
+
+class StatisticsRegistry {
+private:
+  std::mutex Mutex;
+  std::vector<const RegisteredStatistics *> Registry;
+
+public:
+  /// \note this is a function-local static, rather than a ManagedStatic, so
+  ///       that it outlives the global statistics objects registered in it
+  static StatisticsRegistry &get();
+
+public:
+  void add(const RegisteredStatistics *Entry);
+  void remove(const RegisteredStatistics *Entry);
+
+  /// Write all the registered statistics as a JSON object with a member for
+  /// each of them
+  void writeJSON(llvm::raw_ostream &Output);
+};
+
+/// Count occurrences of a set of keys. All the methods are thread-safe.
 template<typename K, typename T = uint64_t>
-class CounterMap {
+class CounterMap : public RegisteredStatistics {
 private:
   using Container = std::map<K, T>;
   Container Map;
   std::string Name;
+  mutable std::mutex Mutex;
 
 public:
   CounterMap(const llvm::StringRef Name) : Name(Name.str()) {
@@ -44,13 +81,40 @@ public:
     });
   }
 
-  void push(K Key) { Map[Key]++; }
-  void push(K Key, T Value) { Map[Key] += Value; }
-  void clear(K Key) { Map.erase(Key); }
-  void clear() { Map.clear(); }
+  void push(K Key) {
+    std::lock_guard Lock(Mutex);
+    Map[Key]++;
+  }
+
+  void push(K Key, T Value) {
+    std::lock_guard Lock(Mutex);
+    Map[Key] += Value;
+  }
+
+  void clear(K Key) {
+    std::lock_guard Lock(Mutex);
+    Map.erase(Key);
+  }
+
+  void clear() {
+    std::lock_guard Lock(Mutex);
+    Map.clear();
+  }
+
+  llvm::StringRef name() const final { return Name; }
+
+  void toJSON(llvm::json::OStream &Output) const final {
+    std::lock_guard Lock(Mutex);
+    Output.object([&] {
+      for (const auto &[Key, Value] : Map)
+        Output.attribute(Key, Value);
+    });
+  }
 
   template<typename O>
   void dump(size_t Max, O &Output) {
+    std::lock_guard Lock(Mutex);
+
     if (not Name.empty())
       Output << Name << ":\n";
 
@@ -92,10 +156,11 @@ public:
 /// and variance.
 ///
 /// If a name is provided, the results will be registered for printing at
-/// program termination.
-class RunningStatistics {
+/// program termination. All the methods are thread-safe.
+class RunningStatistics : public RegisteredStatistics {
 private:
   std::string Name;
+  mutable std::mutex Mutex;
   int N = 0;
   double OldM = 0.0;
   double NewM = 0.0;
@@ -113,11 +178,15 @@ public:
     });
   }
 
-  void clear() { N = 0; }
+  void clear() {
+    std::lock_guard Lock(Mutex);
+    N = 0;
+  }
 
   // TODO: make a template
   /// Record a new value
   void push(double X) {
+    std::lock_guard Lock(Mutex);
     N++;
     Sum += X;
 
@@ -136,24 +205,53 @@ public:
   }
 
   /// \return the total number of recorded values.
-  int size() const { return N; }
+  int size() const {
+    std::lock_guard Lock(Mutex);
+    return N;
+  }
 
-  double mean() const { return (N > 0) ? NewM : 0.0; }
+  double mean() const {
+    std::lock_guard Lock(Mutex);
+    return meanImpl();
+  }
 
-  double variance() const { return ((N > 1) ? NewS / (N - 1) : 0.0); }
+  double variance() const {
+    std::lock_guard Lock(Mutex);
+    return varianceImpl();
+  }
 
   double standardDeviation() const { return sqrt(variance()); }
 
-  double sum() const { return Sum; }
+  double sum() const {
+    std::lock_guard Lock(Mutex);
+    return Sum;
+  }
+
+  llvm::StringRef name() const final { return Name; }
+
+  void toJSON(llvm::json::OStream &Output) const final {
+    std::lock_guard Lock(Mutex);
+    Output.object([&] {
+      Output.attribute("count", N);
+      Output.attribute("sum", Sum);
+      Output.attribute("mean", meanImpl());
+      Output.attribute("variance", varianceImpl());
+    });
+  }
 
   template<typename T>
   void dump(T &Output) {
+    std::lock_guard Lock(Mutex);
     Output << Name << ": "
-           << "{ s: " << sum() << " "
-           << "n: " << size() << " "
-           << "u: " << mean() << " "
-           << "o: " << variance() << " }\n";
+           << "{ s: " << Sum << " "
+           << "n: " << N << " "
+           << "u: " << meanImpl() << " "
+           << "o: " << varianceImpl() << " }\n";
   }
 
   void dump() { dump(dbg); }
+
+private:
+  double meanImpl() const { return (N > 0) ? NewM : 0.0; }
+  double varianceImpl() const { return ((N > 1) ? NewS / (N - 1) : 0.0); }
 };
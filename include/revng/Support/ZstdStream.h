@@ -0,0 +1,32 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+/// Compress \p Buffer as a zstd frame, large buffers are compressed using
+/// multiple threads
+void zstdCompress(llvm::raw_ostream &OS,
+                  llvm::ArrayRef<uint8_t> Buffer,
+                  int CompressionLevel = 3);
+
+inline void zstdCompress(llvm::raw_ostream &OS, llvm::ArrayRef<char> Buffer) {
+  return zstdCompress(OS,
+                      { reinterpret_cast<const uint8_t *>(Buffer.data()),
+                        Buffer.size() });
+}
+
+/// Decompress \p Buffer, which can be made of multiple concatenated frames
+void zstdDecompress(llvm::raw_ostream &OS, llvm::ArrayRef<uint8_t> Buffer);
+
+inline void zstdDecompress(llvm::raw_ostream &OS, llvm::ArrayRef<char> Buffer) {
+  return zstdDecompress(OS,
+                        { reinterpret_cast<const uint8_t *>(Buffer.data()),
+                          Buffer.size() });
+}
+
+/// \return true if \p Buffer starts with a zstd frame
+bool isZstdFrame(llvm::ArrayRef<char> Buffer);
@@ -0,0 +1,431 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "revng/ADT/Concepts.h"
+#include "revng/ADT/KeyedObjectContainer.h"
+#include "revng/ADT/STLExtras.h"
+#include "revng/ADT/UpcastablePointer.h"
+#include "revng/Support/Assert.h"
+#include "revng/Support/BasicBlockID.h"
+#include "revng/Support/MetaAddress.h"
+#include "revng/Support/YAMLTraits.h"
+#include "revng/TupleTree/TupleLikeTraits.h"
+#include "revng/TupleTree/TupleTreeCompatible.h"
+
+/// Compact binary encoding of a tuple tree.
+///
+/// The YAML form of a large model is expensive to parse: most of the time is
+/// spent tokenizing and matching field names. The binary form encodes each
+/// object as the sequence of its fields in declaration order, without names:
+///
+/// * unsigned integers are stored as LEB128 variable-length integers, signed
+///   integers and enums are zigzag-encoded first, `bool`s take a byte;
+/// * strings are interned: the first occurrence of a string is stored as a
+///   zero followed by its length and its raw bytes, later occurrences as the
+///   1-based index of the first one;
+/// * `MetaAddress`es are stored as their type, epoch, address space and the
+///   difference between their address and the one of the previous
+///   `MetaAddress`, which, in sorted containers, is usually small;
+/// * `BasicBlockID`s are stored as their `MetaAddress` followed by their
+///   inlining index;
+/// * other scalars (e.g., `TupleTreeReference`) are stored as their YAML
+///   scalar representation, as a string;
+/// * containers are stored as an element count followed by the elements, in
+///   iteration order (i.e., already sorted by key);
+/// * `UpcastablePointer`s are stored as the name of the concrete type (empty
+///   for null pointers) followed by the fields of the concrete type.
+///
+/// Interning and the differences between addresses make the encoding of an
+/// object depend on what has been written before it by the same writer:
+/// values must be read back in the order they have been written.
+///
+/// The encoding is tied to the layout of the schema: readers reject buffers
+/// whose version does not match `TupleTreeBinaryVersion`. YAML remains the
+/// interchange format, the binary form is meant for caches and for large
+/// models exchanged between revng components built from the same sources.
+///
+/// The decoder works directly on a `llvm::StringRef`, so it can be fed a
+/// `llvm::MemoryBuffer` backed by a memory-mapped file without copies.
+
+inline constexpr llvm::StringLiteral TupleTreeBinaryMagic = "\x7fRVNGTT\x01";
+inline constexpr uint32_t TupleTreeBinaryVersion = 2;
+
+/// \return true if \p Buffer starts with the binary tuple tree header
+inline bool isBinaryTupleTree(llvm::StringRef Buffer) {
+  return Buffer.startswith(TupleTreeBinaryMagic);
+}
+
+namespace revng::detail {
+
+class BinaryTupleTreeWriter {
+private:
+  llvm::raw_ostream &Stream;
+  llvm::StringMap<uint64_t> Strings;
+  uint64_t LastAddress = 0;
+
+public:
+  BinaryTupleTreeWriter(llvm::raw_ostream &Stream) : Stream(Stream) {}
+
+public:
+  void writeHeader() {
+    Stream << TupleTreeBinaryMagic;
+    writeInteger(TupleTreeBinaryVersion);
+  }
+
+  template<typename T>
+  void write(T &Value) {
+    if constexpr (std::is_same_v<T, bool>) {
+      writeInteger(static_cast<uint8_t>(Value));
+    } else if constexpr (std::is_integral_v<T>) {
+      writeInteger(Value);
+    } else if constexpr (std::is_enum_v<T>) {
+      writeInteger(static_cast<std::underlying_type_t<T>>(Value));
+    } else if constexpr (std::is_same_v<T, std::string>) {
+      writeString(Value);
+    } else if constexpr (std::is_same_v<T, MetaAddress>) {
+      writeMetaAddress(Value);
+    } else if constexpr (std::is_same_v<T, BasicBlockID>) {
+      writeMetaAddress(Value.start());
+      writeInteger(Value.inliningIndex());
+    } else if constexpr (HasScalarTraits<T>) {
+      writeString(getNameFromYAMLScalar(Value));
+    } else if constexpr (KeyedObjectContainer<T>) {
+      writeInteger(static_cast<uint64_t>(Value.size()));
+      for (auto &Element : Value)
+        write(Element);
+    } else if constexpr (StrictSpecializationOf<T, std::vector>) {
+      writeInteger(static_cast<uint64_t>(Value.size()));
+      for (auto &Element : Value)
+        write(Element);
+    } else if constexpr (UpcastablePointerLike<T>) {
+      if (Value.isEmpty()) {
+        writeString("");
+      } else {
+        Value.upcast([this]<typename UT>(UT &Upcasted) {
+          writeString(TupleLikeTraits<std::remove_const_t<UT>>::Name);
+          writeFields(const_cast<std::remove_const_t<UT> &>(Upcasted));
+        });
+      }
+    } else if constexpr (TupleLike<T>) {
+      writeFields(Value);
+    } else {
+      static_assert(type_always_false_v<T>);
+    }
+  }
+
+private:
+  template<typename T, size_t I = 0>
+  void writeFields(T &Value) {
+    if constexpr (I < std::tuple_size_v<T>) {
+      using std::get;
+      write(get<I>(Value));
+      writeFields<T, I + 1>(Value);
+    }
+  }
+
+  template<typename T>
+  void writeInteger(T Value) {
+    uint64_t Bits = 0;
+    if constexpr (std::is_signed_v<T>) {
+      // Zigzag encoding: small negative numbers get small encodings too
+      auto Wide = static_cast<int64_t>(Value);
+      Bits = (static_cast<uint64_t>(Wide) << 1)
+             ^ static_cast<uint64_t>(Wide >> 63);
+    } else {
+      Bits = static_cast<uint64_t>(Value);
+    }
+
+    char Bytes[10];
+    size_t Size = 0;
+    do {
+      uint8_t Byte = Bits & 0x7F;
+      Bits >>= 7;
+      if (Bits != 0)
+        Byte |= 0x80;
+      Bytes[Size++] = static_cast<char>(Byte);
+    } while (Bits != 0);
+    Stream.write(Bytes, Size);
+  }
+
+  void writeString(llvm::StringRef String) {
+    auto [It, New] = Strings.try_emplace(String, Strings.size() + 1);
+    if (not New) {
+      writeInteger(It->second);
+      return;
+    }
+
+    writeInteger(uint64_t(0));
+    writeInteger(static_cast<uint64_t>(String.size()));
+    Stream << String;
+  }
+
+  void writeMetaAddress(const MetaAddress &Value) {
+    writeInteger(static_cast<uint64_t>(Value.type()));
+    if (Value.isInvalid())
+      return;
+
+    writeInteger(Value.epoch());
+    writeInteger(Value.addressSpace());
+    writeInteger(static_cast<int64_t>(Value.address() - LastAddress));
+    LastAddress = Value.address();
+  }
+};
+
+class BinaryTupleTreeReader {
+private:
+  llvm::StringRef Buffer;
+  bool Failed = false;
+  std::vector<llvm::StringRef> Strings;
+  uint64_t LastAddress = 0;
+
+public:
+  BinaryTupleTreeReader(llvm::StringRef Buffer) : Buffer(Buffer) {}
+
+public:
+  bool failed() const { return Failed; }
+  bool atEnd() const { return Buffer.empty(); }
+
+  bool readHeader() {
+    if (not Buffer.consume_front(TupleTreeBinaryMagic)) {
+      Failed = true;
+      return false;
+    }
+
+    uint32_t Version = 0;
+    readInteger(Version);
+    if (Version != TupleTreeBinaryVersion)
+      Failed = true;
+
+    return not Failed;
+  }
+
+  template<typename T>
+  void read(T &Value) {
+    if (Failed)
+      return;
+
+    if constexpr (std::is_same_v<T, bool>) {
+      uint8_t Byte = 0;
+      readInteger(Byte);
+      Value = Byte != 0;
+    } else if constexpr (std::is_integral_v<T>) {
+      readInteger(Value);
+    } else if constexpr (std::is_enum_v<T>) {
+      std::underlying_type_t<T> Underlying = 0;
+      readInteger(Underlying);
+      Value = static_cast<T>(Underlying);
+    } else if constexpr (std::is_same_v<T, std::string>) {
+      Value = readString().str();
+    } else if constexpr (std::is_same_v<T, MetaAddress>) {
+      Value = readMetaAddress();
+    } else if constexpr (std::is_same_v<T, BasicBlockID>) {
+      MetaAddress Start = readMetaAddress();
+      uint64_t InliningIndex = 0;
+      readInteger(InliningIndex);
+      if (Failed)
+        return;
+
+      if (InliningIndex == 0)
+        Value = BasicBlockID(Start);
+      else if (Start.isValid())
+        Value = BasicBlockID(Start, InliningIndex);
+      else
+        Failed = true;
+    } else if constexpr (HasScalarTraits<T>) {
+      llvm::StringRef Scalar = readString();
+      if (not Failed)
+        Value = getValueFromYAMLScalar<T>(Scalar);
+    } else if constexpr (KeyedObjectContainer<T>) {
+      using value_type = typename T::value_type;
+      using KOT = KeyedObjectTraits<value_type>;
+      using key_type = decltype(KOT::key(std::declval<value_type>()));
+
+      uint64_t Count = readCount();
+      auto Inserter = Value.batch_insert();
+      for (uint64_t I = 0; I < Count and not Failed; ++I) {
+        value_type Instance = KOT::fromKey(key_type());
+        read(Instance);
+        Inserter.insert(Instance);
+      }
+    } else if constexpr (StrictSpecializationOf<T, std::vector>) {
+      uint64_t Count = readCount();
+      Value.resize(Count);
+      for (auto &Element : Value)
+        read(Element);
+    } else if constexpr (UpcastablePointerLike<T>) {
+      llvm::StringRef Kind = readString();
+      if (Failed or Kind.empty()) {
+        Value.reset();
+        return;
+      }
+
+      readUpcastable(Kind, Value);
+    } else if constexpr (TupleLike<T>) {
+      readFields(Value);
+    } else {
+      static_assert(type_always_false_v<T>);
+    }
+  }
+
+private:
+  template<typename T, size_t I = 0>
+  void readUpcastable(llvm::StringRef Kind, T &Value) {
+    using concrete_types = concrete_types_traits_t<typename T::element_type>;
+    if constexpr (I < std::tuple_size_v<concrete_types>) {
+      using type = typename std::tuple_element_t<I, concrete_types>;
+      if (llvm::StringRef(TupleLikeTraits<type>::Name) == Kind) {
+        auto *Concrete = new type;
+        Value.reset(Concrete);
+        readFields(*Concrete);
+      } else {
+        readUpcastable<T, I + 1>(Kind, Value);
+      }
+    } else {
+      // Unknown kind
+      Failed = true;
+    }
+  }
+
+  template<typename T, size_t I = 0>
+  void readFields(T &Value) {
+    if constexpr (I < std::tuple_size_v<T>) {
+      using std::get;
+      read(get<I>(Value));
+      readFields<T, I + 1>(Value);
+    }
+  }
+
+  template<typename T>
+  void readInteger(T &Value) {
+    uint64_t Bits = 0;
+    unsigned Shift = 0;
+    while (true) {
+      if (Buffer.empty() or Shift >= 64) {
+        Failed = true;
+        return;
+      }
+
+      auto Byte = static_cast<uint8_t>(Buffer.front());
+      Buffer = Buffer.drop_front();
+      Bits |= static_cast<uint64_t>(Byte & 0x7F) << Shift;
+      Shift += 7;
+      if ((Byte & 0x80) == 0)
+        break;
+    }
+
+    if constexpr (std::is_signed_v<T>) {
+      auto Wide = static_cast<int64_t>((Bits >> 1) ^ (~(Bits & 1) + 1));
+      Value = static_cast<T>(Wide);
+    } else {
+      Value = static_cast<T>(Bits);
+    }
+  }
+
+  /// Read an element count, rejecting counts that cannot possibly fit in the
+  /// rest of the buffer, so that a corrupt input cannot trigger huge
+  /// allocations
+  uint64_t readCount() {
+    uint64_t Count = 0;
+    readInteger(Count);
+    if (Count > Buffer.size()) {
+      Failed = true;
+      return 0;
+    }
+    return Count;
+  }
+
+  llvm::StringRef readString() {
+    uint64_t Index = 0;
+    readInteger(Index);
+    if (Failed)
+      return {};
+
+    if (Index != 0) {
+      if (Index > Strings.size()) {
+        Failed = true;
+        return {};
+      }
+      return Strings[Index - 1];
+    }
+
+    uint64_t Size = readCount();
+    if (Failed)
+      return {};
+
+    llvm::StringRef Result = Buffer.take_front(Size);
+    Buffer = Buffer.drop_front(Size);
+    Strings.push_back(Result);
+    return Result;
+  }
+
+  MetaAddress readMetaAddress() {
+    uint64_t Type = 0;
+    readInteger(Type);
+    if (Failed or Type == MetaAddressType::Invalid)
+      return MetaAddress::invalid();
+
+    uint32_t Epoch = 0;
+    uint16_t AddressSpace = 0;
+    int64_t Delta = 0;
+    readInteger(Epoch);
+    readInteger(AddressSpace);
+    readInteger(Delta);
+    if (Failed)
+      return MetaAddress::invalid();
+
+    uint64_t Address = LastAddress + static_cast<uint64_t>(Delta);
+    LastAddress = Address;
+
+    using TypeValues = MetaAddressType::Values;
+    MetaAddress Result(Address,
+                       static_cast<TypeValues>(Type),
+                       Epoch,
+                       AddressSpace);
+    if (Result.isInvalid())
+      Failed = true;
+    return Result;
+  }
+};
+
+} // namespace revng::detail
+
+/// Serialize \p Element using the binary tuple tree encoding
+template<TupleTreeCompatible T>
+void serializeBinary(llvm::raw_ostream &Stream, const T &Element) {
+  revng::detail::BinaryTupleTreeWriter Writer(Stream);
+  Writer.writeHeader();
+  Writer.write(const_cast<T &>(Element));
+}
+
+namespace revng::detail {
+
+template<TupleTreeCompatible T>
+llvm::Expected<T> fromBinaryImpl(llvm::StringRef Buffer) {
+  T Result;
+
+  BinaryTupleTreeReader Reader(Buffer);
+  if (Reader.readHeader())
+    Reader.read(Result);
+
+  if (Reader.failed() or not Reader.atEnd())
+    return llvm::createStringError(std::errc::invalid_argument,
+                                   "Malformed binary tuple tree");
+
+  return Result;
+}
+
+} // namespace revng::detail
@@ -0,0 +1,220 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <array>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+
+#include "revng/TupleTree/TupleLikeTraits.h"
+#include "revng/TupleTree/TupleTree.h"
+
+namespace revng::detail {
+
+/// An entry of the top-level mapping of a YAML document
+struct YAMLSection {
+  llvm::StringRef Key;
+  /// The whole entry, key included
+  llvm::StringRef Text;
+  /// The value of the entry, i.e., everything after the colon
+  llvm::StringRef Value;
+};
+
+/// Split a YAML document whose root is a block mapping into its entries
+///
+/// Only the shape produced by `llvm::yaml::Output` is recognized: if any line
+/// starting at column zero is not a plain `Key:`, a comment or a document
+/// marker, the document is not split.
+inline std::optional<std::vector<YAMLSection>>
+splitTopLevelMapping(llvm::StringRef YAML) {
+  std::vector<YAMLSection> Result;
+  size_t SectionStart = 0;
+
+  auto CloseSection = [&](size_t End) {
+    if (Result.empty())
+      return;
+    YAMLSection &Last = Result.back();
+    Last.Text = YAML.slice(SectionStart, End);
+    Last.Value = Last.Text.drop_front(Last.Key.size() + 1);
+  };
+
+  size_t Offset = 0;
+  while (Offset < YAML.size()) {
+    size_t End = YAML.find('\n', Offset);
+    End = End == llvm::StringRef::npos ? YAML.size() : End + 1;
+    llvm::StringRef Line = YAML.slice(Offset, End).rtrim("\r\n");
+
+    if (Line.empty() or Line.front() == ' ' or Line.front() == '#') {
+      // Part of the current entry
+    } else if (Line == "---" and Result.empty()) {
+      // Start of the document
+    } else if (Line == "...") {
+      // End of the document, no other document can follow
+      if (not YAML.drop_front(End).trim().empty())
+        return std::nullopt;
+      CloseSection(Offset);
+      return Result;
+    } else {
+      size_t Colon = Line.find(':');
+      if (Colon == llvm::StringRef::npos or Colon == 0)
+        return std::nullopt;
+
+      llvm::StringRef Key = Line.take_front(Colon);
+      auto IsKeyCharacter = [](char C) { return llvm::isAlnum(C) or C == '_'; };
+      if (not llvm::all_of(Key, IsKeyCharacter))
+        return std::nullopt;
+
+      if (Colon + 1 < Line.size() and Line[Colon + 1] != ' ')
+        return std::nullopt;
+
+      CloseSection(Offset);
+      SectionStart = Offset;
+      Result.push_back({ Key, {}, {} });
+    }
+
+    Offset = End;
+  }
+
+  CloseSection(YAML.size());
+  return Result;
+}
+
+template<typename T>
+concept ParsableDocument = requires(llvm::yaml::Input &Input, T &Value) {
+  Input >> Value;
+};
+
+/// A field can be parsed on its own if it's optional, so that the rest of the
+/// root can be parsed without it, and it can be a YAML document on its own
+template<TraitedTupleLike T, size_t I>
+constexpr bool isSplittableField() {
+  using Traits = llvm::yaml::MappingTraits<T>;
+  constexpr auto Field = static_cast<typename TupleLikeTraits<T>::Fields>(I);
+  if constexpr (not ParsableDocument<std::tuple_element_t<I, T>>)
+    return false;
+  else if constexpr (requires { Traits::template isOptional<Field>(); })
+    return Traits::template isOptional<Field>();
+  else
+    return false;
+}
+
+template<TraitedTupleLike T, size_t... I>
+constexpr std::array<bool, sizeof...(I)>
+splittableFields(std::index_sequence<I...>) {
+  return { isSplittableField<T, I>()... };
+}
+
+} // namespace revng::detail
+
+/// Deserialize a tuple tree parsing the largest top-level fields of its root
+/// concurrently
+///
+/// Each entry of the top-level mapping larger than \p MinimumSectionSize is
+/// parsed on its own, while the remaining ones are parsed together as a
+/// partial root. Only optional fields are split (see `isSplittableField`), so
+/// that the partial root is valid on its own.
+///
+/// The result is the same as `TupleTree<T>::fromString`, which is used when
+/// the document cannot be split (e.g., it's in the binary form) or anything
+/// goes wrong, so that errors are reported in the same way.
+template<TupleTreeCompatible T>
+  requires TraitedTupleLike<T>
+llvm::ErrorOr<TupleTree<T>>
+concurrentlyFromString(llvm::StringRef String,
+                       size_t MinimumSectionSize = 64 * 1024) {
+  using namespace revng::detail;
+  constexpr size_t FieldCount = std::tuple_size_v<T>;
+  using Indices = std::make_index_sequence<FieldCount>;
+
+  if (isBinaryTupleTree(String))
+    return TupleTree<T>::fromString(String);
+
+  auto MaybeSections = splitTopLevelMapping(String);
+  if (not MaybeSections)
+    return TupleTree<T>::fromString(String);
+
+  // Pick the entries to parse on their own
+  constexpr auto Splittable = splittableFields<T>(Indices());
+  std::array<std::optional<llvm::StringRef>, FieldCount> Split;
+  std::string Rest;
+  size_t SplitCount = 0;
+  for (const YAMLSection &Section : *MaybeSections) {
+    const auto &Names = TupleLikeTraits<T>::FieldNames;
+    auto It = llvm::find(Names, Section.Key);
+    size_t Index = std::distance(Names.begin(), It);
+    if (It != Names.end() and Splittable[Index] and not Split[Index].has_value()
+        and Section.Text.size() >= MinimumSectionSize) {
+      Split[Index] = Section.Value;
+      ++SplitCount;
+    } else {
+      Rest += Section.Text;
+    }
+  }
+
+  if (SplitCount == 0)
+    return TupleTree<T>::fromString(String);
+
+  T Root;
+  typename TupleLikeTraits<T>::tuple Fields;
+  std::array<bool, FieldCount + 1> Failed{};
+  {
+    llvm::ThreadPool Pool(llvm::hardware_concurrency());
+
+    Pool.async([&] {
+      auto MaybeRoot = fromStringImpl<T>(Rest);
+      Failed[FieldCount] = not MaybeRoot;
+      if (MaybeRoot)
+        Root = std::move(*MaybeRoot);
+      else
+        llvm::consumeError(MaybeRoot.takeError());
+    });
+
+    auto ParseField = [&]<size_t I>(std::integral_constant<size_t, I>) {
+      if constexpr (Splittable[I]) {
+        if (not Split[I].has_value())
+          return;
+
+        Pool.async([&] {
+          using FieldType = std::tuple_element_t<I, T>;
+          auto MaybeField = fromStringImpl<FieldType>(*Split[I]);
+          Failed[I] = not MaybeField;
+          if (MaybeField)
+            std::get<I>(Fields) = std::move(*MaybeField);
+          else
+            llvm::consumeError(MaybeField.takeError());
+        });
+      }
+    };
+    [&]<size_t... I>(std::index_sequence<I...>) {
+      (ParseField(std::integral_constant<size_t, I>()), ...);
+    }(Indices());
+
+    Pool.wait();
+  }
+
+  if (llvm::is_contained(Failed, true))
+    return TupleTree<T>::fromString(String);
+
+  auto MoveField = [&]<size_t I>(std::integral_constant<size_t, I>) {
+    if (Split[I].has_value())
+      get<I>(Root) = std::move(std::get<I>(Fields));
+  };
+  [&]<size_t... I>(std::index_sequence<I...>) {
+    (MoveField(std::integral_constant<size_t, I>()), ...);
+  }(Indices());
+
+  TupleTree<T> Result;
+  *Result = std::move(Root);
+  Result.initializeReferences();
+  return Result;
+}
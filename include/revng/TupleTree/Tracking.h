@@ -38,6 +38,14 @@ struct Tracking {
 
   template<typename M>
   static void stop(const M &LHS);
+
+  /// Stop tracking without affecting what has been tracked so far, until
+  /// `resume` is called. While paused, `LHS` can be read from multiple threads.
+  template<typename M>
+  static void pause(const M &LHS);
+
+  template<typename M>
+  static void resume(const M &LHS);
 };
 
 } // namespace revng
@@ -61,6 +61,30 @@ struct TrackingImpl {
     }
   };
 
+  struct PauseTrackingVisitor {
+    template<revng::SetOrKOC Type>
+    static void visitKeyedObjectContainer(const Type &CurrentItem) {
+      CurrentItem.pauseTracking();
+    }
+
+    template<typename Type, size_t FieldIndex>
+    static void visitTupleElement(const Type &CurrentItem) {
+      CurrentItem.template getTracker<FieldIndex>().pauseTracking();
+    }
+  };
+
+  struct ResumeTrackingVisitor {
+    template<revng::SetOrKOC Type>
+    static void visitKeyedObjectContainer(const Type &CurrentItem) {
+      CurrentItem.resumeTracking();
+    }
+
+    template<typename Type, size_t FieldIndex>
+    static void visitTupleElement(const Type &CurrentItem) {
+      CurrentItem.template getTracker<FieldIndex>().resumeTracking();
+    }
+  };
+
   template<typename M, size_t I = 0, typename T>
   static void
   collectTuple(const T &LHS, TupleTreePath &Stack, ReadFields &Info) {
@@ -190,4 +214,14 @@ void Tracking::stop(const M &LHS) {
   TrackingImpl::visitTuple<M, TrackingImpl::StopTrackingVisitor>(LHS);
 }
 
+template<typename M>
+void Tracking::pause(const M &LHS) {
+  TrackingImpl::visitTuple<M, TrackingImpl::PauseTrackingVisitor>(LHS);
+}
+
+template<typename M>
+void Tracking::resume(const M &LHS) {
+  TrackingImpl::visitTuple<M, TrackingImpl::ResumeTrackingVisitor>(LHS);
+}
+
 } // namespace revng
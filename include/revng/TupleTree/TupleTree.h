@@ -25,6 +25,7 @@
 #include "revng/Support/Assert.h"
 #include "revng/Support/Debug.h"
 #include "revng/Support/YAMLTraits.h"
+#include "revng/TupleTree/BinarySerialization.h"
 #include "revng/TupleTree/Tracking.h"
 #include "revng/TupleTree/TupleTreeCompatible.h"
 #include "revng/TupleTree/TupleTreePath.h"
@@ -75,6 +76,30 @@ private:
   }
 };
 
+/// Pause the tracking of \p TrackedObject for the lifetime of this object
+///
+/// Unlike `DisableTracking`, accessing the object while paused performs no
+/// writes at all, which makes it safe to read it from multiple threads.
+template<typename T>
+class PauseTracking {
+private:
+  const T &TrackedObject;
+
+public:
+  PauseTracking(const T &TrackedObject) : TrackedObject(TrackedObject) {
+    if constexpr (T::HasTracking)
+      revng::Tracking::pause(TrackedObject);
+  }
+
+  PauseTracking(const PauseTracking &Other) = delete;
+  PauseTracking &operator=(const PauseTracking &Other) = delete;
+
+  ~PauseTracking() {
+    if constexpr (T::HasTracking)
+      revng::Tracking::resume(TrackedObject);
+  }
+};
+
 template<TupleTreeCompatible T>
 class TupleTree {
 private:
@@ -149,10 +174,14 @@ public:
   }
 
 public:
+  /// Deserialize a tuple tree from either its YAML or its binary form (see
+  /// `serializeBinary`), the latter is detected by its header.
   static llvm::ErrorOr<TupleTree> fromString(llvm::StringRef YAMLString) {
     TupleTree Result{};
 
-    auto MaybeRoot = revng::detail::fromStringImpl<T>(YAMLString);
+    auto MaybeRoot = isBinaryTupleTree(YAMLString) ?
+                       revng::detail::fromBinaryImpl<T>(YAMLString) :
+                       revng::detail::fromStringImpl<T>(YAMLString);
     if (not MaybeRoot)
       return llvm::errorToErrorCode(MaybeRoot.takeError());
 
@@ -197,6 +226,27 @@ public:
     serialize(Stream);
   }
 
+  void serializeBinary(llvm::raw_ostream &Stream) const {
+    revng_assert(Root);
+
+    ::serializeBinary(Stream, *Root);
+  }
+
+  llvm::Error toBinaryFile(const llvm::StringRef &Path) const {
+    std::error_code ErrorCode;
+    using namespace llvm::sys::fs;
+    llvm::raw_fd_ostream OutFile(Path, ErrorCode, CD_CreateAlways);
+    if (!!ErrorCode) {
+      return llvm::make_error<llvm::StringError>("Could not open file "
+                                                   + Path.str(),
+                                                 ErrorCode);
+    }
+
+    serializeBinary(OutFile);
+
+    return llvm::Error::success();
+  }
+
 public:
   const T *get() const noexcept { return Root.get(); }
   T *get() noexcept {
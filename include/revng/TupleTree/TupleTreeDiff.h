@@ -319,24 +319,28 @@ struct llvm::yaml::MappingTraits<T> {
 //
 namespace tupletreediff::detail {
 
-template<typename M>
+/// Computes the differences between two trees and reports them to \p Sink,
+/// which can be a TupleTreeDiff or anything else with its `add`, `remove` and
+/// `change` methods, such as a TupleTreeDiffWriter
+template<typename M, typename Sink = TupleTreeDiff<M>>
 struct Diff {
   TupleTreePath Stack;
-  TupleTreeDiff<M> Result;
+  Sink &Result;
 
-  TupleTreeDiff<M> diff(const M &LHS, const M &RHS) {
-    diffImpl(LHS, RHS);
-    return Result;
-  }
+  explicit Diff(Sink &Result) : Result(Result) {}
+
+  void diff(const M &LHS, const M &RHS) { diffImpl(LHS, RHS); }
 
 private:
   template<size_t I = 0, typename T>
   void diffTuple(const T &LHS, const T &RHS) {
     if constexpr (I < std::tuple_size_v<T>) {
 
-      Stack.push_back(size_t(I));
-      diffImpl(get<I>(LHS), get<I>(RHS));
-      Stack.pop_back();
+      if (not equalImpl(get<I>(LHS), get<I>(RHS))) {
+        Stack.push_back(size_t(I));
+        diffImpl(get<I>(LHS), get<I>(RHS));
+        Stack.pop_back();
+      }
 
       // Recur
       diffTuple<I + 1>(LHS, RHS);
@@ -380,7 +384,10 @@ private:
         // Removed
         Result.remove(Stack, *LHSElement);
       } else {
-        // Identical
+        // Same key
+        if (equalImpl(*LHSElement, *RHSElement))
+          continue;
+
         using value_type = typename T::value_type;
         Stack.push_back(KeyedObjectTraits<value_type>::key(*LHSElement));
         diffImpl(*LHSElement, *RHSElement);
@@ -395,13 +402,83 @@ private:
       Result.change(Stack, LHS, RHS);
     }
   }
+
+private:
+  // Deep equality, including references and GUIDs (unlike
+  // `localCompare`). Every step of `diffImpl` pushes to `Stack`, which
+  // allocates: identical subtrees, which in an edited model are the vast
+  // majority, are skipped with this instead, without allocating.
+
+  template<size_t I = 0, typename T>
+  static bool equalTuple(const T &LHS, const T &RHS) {
+    if constexpr (I < std::tuple_size_v<T>) {
+      return equalImpl(get<I>(LHS), get<I>(RHS))
+             and equalTuple<I + 1>(LHS, RHS);
+    } else {
+      return true;
+    }
+  }
+
+  template<StrictSpecializationOf<UpcastablePointer> T>
+  static bool equalImpl(const T &LHS, const T &RHS) {
+    if (LHS.isEmpty() || RHS.isEmpty())
+      return LHS.isEmpty() and RHS.isEmpty();
+
+    bool Result = false;
+    LHS.upcast([&](auto &LHSUpcasted) {
+      RHS.upcast([&](auto &RHSUpcasted) {
+        using LHSType = std::remove_cvref_t<decltype(LHSUpcasted)>;
+        using RHSType = std::remove_cvref_t<decltype(RHSUpcasted)>;
+        if constexpr (std::is_same_v<LHSType, RHSType>)
+          Result = equalImpl(LHSUpcasted, RHSUpcasted);
+      });
+    });
+    return Result;
+  }
+
+  template<TupleSizeCompatible T>
+  static bool equalImpl(const T &LHS, const T &RHS) {
+    return equalTuple(LHS, RHS);
+  }
+
+  template<revng::SetOrKOC T>
+  static bool equalImpl(const T &LHS, const T &RHS) {
+    if (LHS.size() != RHS.size())
+      return false;
+
+    // Both sides are sorted by key
+    using KOT = KeyedObjectTraits<typename T::value_type>;
+    auto RHSIterator = RHS.begin();
+    for (const auto &LHSElement : LHS) {
+      const auto &RHSElement = *RHSIterator++;
+      if (KOT::key(LHSElement) != KOT::key(RHSElement)
+          or not equalImpl(LHSElement, RHSElement))
+        return false;
+    }
+
+    return true;
+  }
+
+  template<NotTupleTreeCompatible T>
+  static bool equalImpl(const T &LHS, const T &RHS) {
+    return not(LHS != RHS);
+  }
 };
 
 } // namespace tupletreediff::detail
 
 template<TupleTreeRootLike M>
 TupleTreeDiff<M> diff(const M &LHS, const M &RHS) {
-  return tupletreediff::detail::Diff<M>().diff(LHS, RHS);
+  TupleTreeDiff<M> Result;
+  tupletreediff::detail::Diff<M>(Result).diff(LHS, RHS);
+  return Result;
+}
+
+/// Reports the differences between \p LHS and \p RHS to \p Sink as they are
+/// found, without accumulating them
+template<TupleTreeRootLike M, typename SinkType>
+void diff(const M &LHS, const M &RHS, SinkType &Sink) {
+  tupletreediff::detail::Diff<M, SinkType>(Sink).diff(LHS, RHS);
 }
 
 //
@@ -413,6 +490,66 @@ inline void TupleTreeDiff<T>::dump(llvm::raw_ostream &OutputStream) const {
   serialize(OutputStream, *this);
 }
 
+/// Writes a TupleTreeDiff one change at a time, so that the changes do not
+/// have to be held in memory all together. The output is the same as the one
+/// of TupleTreeDiff::dump.
+template<TupleTreeRootLike T>
+class TupleTreeDiffWriter {
+private:
+  llvm::raw_ostream &OutputStream;
+  size_t Count = 0;
+
+public:
+  explicit TupleTreeDiffWriter(llvm::raw_ostream &OutputStream) :
+    OutputStream(OutputStream) {}
+
+public:
+  template<typename ToAdd>
+  void add(const TupleTreePath &Path, ToAdd What) {
+    write(Change<T>::createAddition(Path, What));
+  }
+
+  template<typename ToRemove>
+  void remove(const TupleTreePath &Path, ToRemove What) {
+    write(Change<T>::createRemoval(Path, What));
+  }
+
+  template<typename ToChange>
+  void
+  change(const TupleTreePath &Path, const ToChange &From, const ToChange &To) {
+    write(Change<T>::createChange(Path, From, To));
+  }
+
+  /// Terminate the document
+  void finish() {
+    if (Count == 0)
+      TupleTreeDiff<T>().dump(OutputStream);
+    else
+      OutputStream << "...\n";
+  }
+
+  size_t changes() const { return Count; }
+
+private:
+  void write(Change<T> &&C) {
+    // Serialize a diff with C alone, and keep only the element of `Changes`.
+    // The document header is emitted once, before the first change.
+    TupleTreeDiff<T> Single;
+    Single.Changes.push_back(std::move(C));
+    std::string Buffer = toString(Single);
+
+    llvm::StringRef Element = Buffer;
+    llvm::StringRef Header = "---\nChanges:\n";
+    revng_assert(Element.startswith(Header) and Element.endswith("...\n"));
+    Element = Element.drop_front(Header.size()).drop_back(4);
+
+    if (Count == 0)
+      OutputStream << Header;
+    OutputStream << Element;
+    ++Count;
+  }
+};
+
 //
 // TupleTreeDiff::apply
 //
@@ -425,10 +562,24 @@ public:
   const Change *C = nullptr;
   size_t ChangeIndex;
   revng::DiffError *EL;
+  T *Root = nullptr;
 
 private:
   void generateError() { generateError(""); }
 
+  /// Point the references in \p Subtree, which comes from the diff, to the
+  /// tree being patched. This way the rest of the tree, whose references are
+  /// already initialized, does not have to be visited again.
+  template<typename S>
+  void initializeReferences(S &Subtree) {
+    auto Visitor = [this](auto &Element) {
+      using type = std::remove_cvref_t<decltype(Element)>;
+      if constexpr (StrictSpecializationOf<type, TupleTreeReference>)
+        Element.setRoot(Root);
+    };
+    visitTupleTree(Subtree, Visitor, [](auto &) {});
+  }
+
   void generateError(const llvm::StringRef Reason,
                      revng::DiffLocation::KindType Kind) {
     std::string Description = "Error in applying diff";
@@ -489,7 +640,9 @@ public:
                       revng::DiffLocation::KindType::Old);
     } else if (C->New != std::nullopt) {
       // TODO: assert not there already
-      addToContainer(M, std::get<value_type>(*C->New));
+      value_type NewElement = std::get<value_type>(*C->New);
+      initializeReferences(NewElement);
+      addToContainer(M, NewElement);
       if (OldSize + 1 != M.size())
         generateError("Subtree addition failed",
                       revng::DiffLocation::KindType::New);
@@ -525,9 +678,10 @@ public:
     }
 
     // Replace the contents with `New`
-    if (C->New.has_value())
+    if (C->New.has_value()) {
       M = std::get<S>(*C->New);
-    else if constexpr (SpecializationOf<S, UpcastablePointer>)
+      initializeReferences(M);
+    } else if constexpr (SpecializationOf<S, UpcastablePointer>)
       M = S::empty();
     else
       generateError("Missing 'Add' key", revng::DiffLocation::KindType::New);
@@ -541,6 +695,10 @@ inline llvm::Error TupleTreeDiff<T>::apply(TupleTree<T> &M) const {
   using namespace revng;
 
   auto Error = std::make_unique<revng::DiffError>();
+  // References are initialized as new subtrees are added, there's no need
+  // to touch the whole tree
+  M.evictCachedReferences();
+
   size_t Index = 0;
   for (const Change &C : Changes) {
 
@@ -549,7 +707,10 @@ inline llvm::Error TupleTreeDiff<T>::apply(TupleTree<T> &M) const {
                        DiffLocation(Index, DiffLocation::KindType::Path));
       continue;
     }
-    tupletreediff::detail::ApplyDiffVisitor<T> ADV{ &C, Index, Error.get() };
+    tupletreediff::detail::ApplyDiffVisitor<T> ADV{ &C,
+                                                    Index,
+                                                    Error.get(),
+                                                    M.get() };
 
     if (not callByPath(ADV, C.Path, *M)) {
       Error->addReason("Path not present: "
@@ -560,7 +721,5 @@ inline llvm::Error TupleTreeDiff<T>::apply(TupleTree<T> &M) const {
     Index++;
   }
 
-  M.evictCachedReferences();
-  M.initializeReferences();
   return revng::DiffError::makeError(std::move(Error));
 }
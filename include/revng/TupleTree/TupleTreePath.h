@@ -5,7 +5,10 @@
 //
 
 #include <compare>
+#include <new>
+#include <type_traits>
 
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Twine.h"
 
 #include "revng/ADT/STLExtras.h"
@@ -19,11 +22,30 @@ char *typeID() {
 
 class TupleTreeKeyWrapper {
 protected:
-  void *Pointer;
+  /// Keys that fit in a pointer (e.g., the index of a field) are stored in
+  /// place of the pointer, without allocating them on the heap
+  template<typename T>
+  static constexpr bool IsStoredInline = sizeof(T) <= sizeof(void *)
+                                         and alignof(T) <= alignof(void *)
+                                         and std::is_trivially_copyable_v<T>;
+
+protected:
+  union {
+    void *Pointer;
+    alignas(void *) char Inline[sizeof(void *)];
+  };
 
 protected:
   TupleTreeKeyWrapper(void *Pointer) : Pointer(Pointer) {}
 
+  template<typename T>
+  T *address() const {
+    if constexpr (IsStoredInline<T>)
+      return reinterpret_cast<T *>(const_cast<char *>(Inline));
+    else
+      return reinterpret_cast<T *>(Pointer);
+  }
+
 public:
   TupleTreeKeyWrapper() : Pointer(nullptr) {}
 
@@ -78,7 +100,7 @@ public:
   template<typename T>
   T *tryGet() const {
     if (isa<T>())
-      return reinterpret_cast<T *>(Pointer);
+      return address<T>();
     else
       return nullptr;
   }
@@ -92,21 +114,28 @@ public:
   }
 };
 
-// TODO: optimize integral types
 template<typename T, bool LastFieldIsKind = false>
 class ConcreteTupleTreeKeyWrapper : public TupleTreeKeyWrapper {
 private:
   static char ID;
 
 public:
-  T *get() const { return reinterpret_cast<T *>(Pointer); }
+  T *get() const { return address<T>(); }
 
 public:
   template<typename... Args>
-  ConcreteTupleTreeKeyWrapper(Args... A) : TupleTreeKeyWrapper(new T(A...)) {}
+  ConcreteTupleTreeKeyWrapper(Args... A) {
+    if constexpr (IsStoredInline<T>)
+      new (Inline) T(A...);
+    else
+      Pointer = new T(A...);
+  }
 
   ~ConcreteTupleTreeKeyWrapper() override {
-    delete reinterpret_cast<T *>(Pointer);
+    if constexpr (IsStoredInline<T>)
+      get()->~T();
+    else
+      delete get();
   }
 
   bool operator==(const TupleTreeKeyWrapper &Other) const override {
@@ -161,7 +190,8 @@ public:
 
 class TupleTreePath {
 private:
-  std::vector<TupleTreeKeyWrapper> Storage;
+  // Most paths are short: keep their steps inline
+  llvm::SmallVector<TupleTreeKeyWrapper, 4> Storage;
 
 public:
   TupleTreePath() = default;
@@ -4,8 +4,10 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <array>
 #include <cstdint>
 #include <tuple>
+#include <utility>
 
 #include "revng/ADT/KeyedObjectContainer.h"
 #include "revng/ADT/UpcastablePointer.h"
@@ -94,33 +96,45 @@ bool callOnPathSteps(Visitor &, llvm::ArrayRef<TupleTreeKeyWrapper> Path) {
 
 namespace tupletree::detail {
 
-template<TupleSizeCompatible RootT,
-         size_t I = 0,
-         typename KindT,
-         typename Visitor>
+template<TupleSizeCompatible RootT, size_t I, typename KindT, typename Visitor>
+bool tupleElementStep(Visitor &V,
+                      llvm::ArrayRef<TupleTreeKeyWrapper> Path,
+                      KindT Kind) {
+  if constexpr (std::is_same_v<KindT, size_t>)
+    V.template visitTupleElement<RootT, I>();
+  else
+    V.template visitPolymorphicElement<RootT, I>(Kind);
+
+  using next_type = typename std::tuple_element<I, RootT>::type;
+  return callOnPathSteps<next_type>(V, Path.slice(1));
+}
+
+/// Dispatch on the index of the field in the first step of \p Path through a
+/// table generated at compile time, rather than comparing it against each
+/// field in turn
+template<TupleSizeCompatible RootT, typename KindT, typename Visitor>
 bool polymorphicTupleImpl(Visitor &V,
                           llvm::ArrayRef<TupleTreeKeyWrapper> Path,
                           KindT Kind) {
-  if constexpr (I < std::tuple_size_v<RootT>) {
-    if (Path[0].get<size_t>() == I) {
-      if constexpr (std::is_same_v<KindT, size_t>)
-        V.template visitTupleElement<RootT, I>();
-      else
-        V.template visitPolymorphicElement<RootT, I>(Kind);
-
-      using next_type = typename std::tuple_element<I, RootT>::type;
-      return callOnPathSteps<next_type>(V, Path.slice(1));
-    } else {
-      return polymorphicTupleImpl<RootT, I + 1>(V, Path, Kind);
-    }
-  }
+  using StepType = bool (*)(Visitor &,
+                            llvm::ArrayRef<TupleTreeKeyWrapper>,
+                            KindT);
+  static constexpr auto Steps = []<size_t... I>(std::index_sequence<I...>) {
+    return std::array<StepType, sizeof...(I)>{
+      &tupleElementStep<RootT, I, KindT, Visitor>...
+    };
+  }(std::make_index_sequence<std::tuple_size_v<RootT>>());
+
+  size_t Index = Path[0].get<size_t>();
+  if (Index >= Steps.size())
+    return false;
 
-  return false;
+  return Steps[Index](V, Path, Kind);
 }
 
 template<TupleSizeCompatible RootT, typename Visitor>
 bool tupleImpl(Visitor &V, llvm::ArrayRef<TupleTreeKeyWrapper> Path) {
-  return polymorphicTupleImpl<RootT, 0, size_t>(V, Path, 0);
+  return polymorphicTupleImpl<RootT, size_t>(V, Path, 0);
 }
 
 } // namespace tupletree::detail
@@ -189,35 +203,46 @@ bool callOnPathSteps(Visitor &,
 
 namespace tupletree::detail {
 
-template<TupleSizeCompatible RootT,
-         size_t I = 0,
-         typename KindT,
-         typename Visitor>
+template<TupleSizeCompatible RootT, size_t I, typename KindT, typename Visitor>
+bool tupleElementStep(Visitor &V,
+                      llvm::ArrayRef<TupleTreeKeyWrapper> Path,
+                      RootT &M,
+                      KindT Kind) {
+  auto &Element = get<I>(M);
+  if constexpr (std::is_same_v<KindT, size_t>)
+    V.template visitTupleElement<RootT, I>(Element);
+  else
+    V.template visitPolymorphicElement<RootT, I>(Kind, Element);
+
+  using next_type = typename std::tuple_element<I, RootT>::type;
+  return callOnPathSteps<next_type>(V, Path.slice(1), Element);
+}
+
+template<TupleSizeCompatible RootT, typename KindT, typename Visitor>
 bool polymorphicTupleImpl(Visitor &V,
                           llvm::ArrayRef<TupleTreeKeyWrapper> Path,
                           RootT &M,
                           KindT Kind) {
-  if constexpr (I < std::tuple_size_v<RootT>) {
-    if (Path[0].get<size_t>() == I) {
-      auto &Element = get<I>(M);
-      if constexpr (std::is_same_v<KindT, size_t>)
-        V.template visitTupleElement<RootT, I>(Element);
-      else
-        V.template visitPolymorphicElement<RootT, I>(Kind, Element);
-
-      using next_type = typename std::tuple_element<I, RootT>::type;
-      return callOnPathSteps<next_type>(V, Path.slice(1), Element);
-    } else {
-      return polymorphicTupleImpl<RootT, I + 1>(V, Path, M, Kind);
-    }
-  }
+  using StepType = bool (*)(Visitor &,
+                            llvm::ArrayRef<TupleTreeKeyWrapper>,
+                            RootT &,
+                            KindT);
+  static constexpr auto Steps = []<size_t... I>(std::index_sequence<I...>) {
+    return std::array<StepType, sizeof...(I)>{
+      &tupleElementStep<RootT, I, KindT, Visitor>...
+    };
+  }(std::make_index_sequence<std::tuple_size_v<RootT>>());
+
+  size_t Index = Path[0].get<size_t>();
+  if (Index >= Steps.size())
+    return false;
 
-  return false;
+  return Steps[Index](V, Path, M, Kind);
 }
 
 template<TupleSizeCompatible RootT, typename Visitor>
 bool tupleImpl(Visitor &V, llvm::ArrayRef<TupleTreeKeyWrapper> Path, RootT &M) {
-  return polymorphicTupleImpl<RootT, 0, size_t>(V, Path, M, 0);
+  return polymorphicTupleImpl<RootT, size_t>(V, Path, M, 0);
 }
 
 } // namespace tupletree::detail
@@ -10,10 +10,11 @@
 #include "llvm/Support/DOTGraphTraits.h"
 
 #include "revng/ADT/GenericGraph.h"
+#include "revng/ADT/RecyclingAllocated.h"
 
 namespace TypeShrinking {
 
-struct DataFlowNodeData {
+struct DataFlowNodeData : public RecyclingAllocated {
   DataFlowNodeData(llvm::Instruction *Ins) : Instruction(Ins){};
   llvm::Instruction *Instruction;
 };
@@ -111,6 +111,13 @@ public:
 private:
   using NodeValuesMap = std::map<Node *, std::optional<MaterializedValues>>;
 
+  /// State of a single materialization query
+  struct MaterializationState {
+    NodeValuesMap Results;
+    /// How many more values the query is allowed to compute before giving up
+    uint64_t RemainingCost = 0;
+  };
+
 private:
   llvm::DenseMap<llvm::Value *, Node *> NodeMap;
 
@@ -126,17 +133,15 @@ public:
   // a list of values and a list of read memory areas
   std::optional<MaterializedValues> materialize(Node *N,
                                                 MemoryOracle &MO) const {
-    using Map = std::map<Node *, std::optional<MaterializedValues>>;
-    Map Results;
-    return materializeImpl(N, MO, Results);
+    MaterializationState State{ {}, maxMaterializationCost() };
+    return materializeImpl(N, MO, State);
   }
 
   std::optional<MaterializedValue>
   materializeOne(Node *N,
                  MemoryOracle &MO,
                  const llvm::APInt &InputValue) const {
-    using Map = std::map<Node *, std::optional<MaterializedValues>>;
-    Map Results;
+    MaterializationState State{ {}, maxMaterializationCost() };
 
     // Remember the current oracle range for the node.
     std::optional<ConstantRangeSet> CurrentRange = N->OracleRange;
@@ -146,7 +151,7 @@ public:
     N->OracleRange = { InputValue };
     N->UseOracle = true;
 
-    std::optional<MaterializedValues> Values = materializeImpl(N, MO, Results);
+    std::optional<MaterializedValues> Values = materializeImpl(N, MO, State);
 
     // Restore the oracle range.
     N->OracleRange = CurrentRange;
@@ -166,7 +171,11 @@ public:
 
 private:
   RecursiveCoroutine<std::optional<MaterializedValues>>
-  materializeImpl(Node *N, MemoryOracle &MO, NodeValuesMap &Results) const;
+  materializeImpl(Node *N, MemoryOracle &MO, MaterializationState &State) const;
+
+  /// \return the maximum number of values a single query can compute, across
+  ///         all the nodes, see `--vm-max-cost`
+  static uint64_t maxMaterializationCost();
 
   /// \param Limits best effort limits for the creation of the data-flow graph.
   ///        In order to reliably enforce these limits, invoke enforceLimits at
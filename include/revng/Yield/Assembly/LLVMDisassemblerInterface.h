@@ -31,6 +31,20 @@ private:
   std::unique_ptr<llvm::MCDisassembler> Disassembler;
   std::unique_ptr<llvm::MCInstPrinter> Printer;
 
+public:
+  /// Everything, besides the address and bytes of an instruction, that
+  /// affects the output of `instruction`
+  struct Flavor {
+    MetaAddressType::Values AddressType = MetaAddressType::Invalid;
+    unsigned AssemblyDialect = 0;
+    model::DisassemblyConfigurationImmediateStyle::Values ImmediateStyle = {};
+
+    auto operator<=>(const Flavor &) const = default;
+  };
+
+private:
+  Flavor CurrentFlavor;
+
 public:
   explicit LLVMDisassemblerInterface(MetaAddressType::Values AddressType,
                                      const model::DisassemblyConfiguration &);
@@ -48,6 +62,13 @@ public:
     bool HasDelaySlot = false;
     uint64_t Size = 0;
   };
+
+  /// Decode the instruction at \p Where
+  ///
+  /// Successfully decoded instructions are cached process-wide, keyed by
+  /// flavor, address and bytes: disassembling the same code again (e.g.,
+  /// after something unrelated changed in the model) does not go through
+  /// LLVM MC.
   Disassembled instruction(const MetaAddress &Where,
                            llvm::ArrayRef<uint8_t> RawBytes);
 
@@ -60,6 +81,8 @@ public:
   }
 
 private:
+  Disassembled decode(const MetaAddress &Where,
+                      llvm::ArrayRef<uint8_t> RawBytes);
   std::pair<std::optional<llvm::MCInst>, uint64_t>
   disassemble(const MetaAddress &Address,
               llvm::ArrayRef<uint8_t> RawBytes,
@@ -4,6 +4,9 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <string_view>
+#include <unordered_map>
+
 #include "revng/Pipeline/Location.h"
 #include "revng/Yield/CallGraphs/Graph.h"
 
@@ -45,4 +48,34 @@ PreLayoutGraph makeCalleeTree(const PreLayoutGraph &Input,
 PreLayoutGraph makeCallerTree(const PreLayoutGraph &Input,
                               std::string_view SlicePointLocation = "");
 
+/// A call graph meant to be sliced at many different points.
+///
+/// Looking the slice point up in the graph is the only part of slicing that
+/// does not depend on the size of the slice: this keeps an index of the nodes
+/// by location, so that producing the slices of every function only costs as
+/// much as the slices themselves.
+class SliceableCallGraph {
+private:
+  PreLayoutGraph Graph;
+  std::unordered_map<std::string_view, const PreLayoutNode *> Lookup;
+
+public:
+  explicit SliceableCallGraph(PreLayoutGraph &&Input);
+
+  SliceableCallGraph(const SliceableCallGraph &) = delete;
+  SliceableCallGraph &operator=(const SliceableCallGraph &) = delete;
+
+public:
+  const PreLayoutGraph &graph() const { return Graph; }
+
+  /// \see yield::calls::makeCalleeTree
+  PreLayoutGraph makeCalleeTree(std::string_view SlicePointLocation) const;
+
+  /// \see yield::calls::makeCallerTree
+  PreLayoutGraph makeCallerTree(std::string_view SlicePointLocation) const;
+
+private:
+  const PreLayoutNode *find(std::string_view SlicePointLocation) const;
+};
+
 } // namespace yield::calls
@@ -98,6 +98,12 @@ public:
   /// information see layouter documentation).
   float VirtualNodeWeight;
 
+  /// Specifies the number of nodes above which the layouter switches to
+  /// the network simplex ranking and to the linear time horizontal placement,
+  /// which scale to huge graphs at the cost of the layouts looking less
+  /// structured.
+  size_t ScalableLayoutThreshold;
+
 public:
   constexpr static Configuration getDefault() {
     return Configuration{ .EdgeMarginSize = 20.f,
@@ -121,7 +127,9 @@ public:
                           .AddExitNode = false,
 
                           .PreserveLinearSegments = true,
-                          .VirtualNodeWeight = 0.1f };
+                          .VirtualNodeWeight = 0.1f,
+
+                          .ScalableLayoutThreshold = 1000 };
   }
 };
 
@@ -4,6 +4,13 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <cstdint>
+#include <map>
+#include <mutex>
+
+#include "llvm/ADT/StringRef.h"
+
+#include "revng/Support/MetaAddress.h"
 #include "revng/Yield/ControlFlow/Graph.h"
 
 namespace model {
@@ -20,4 +27,43 @@ PreLayoutGraph extractFromInternal(const yield::Function &Function,
                                    const model::Binary &Binary,
                                    const Configuration &Configuration);
 
+/// \return a hash of everything `extractFromInternal` depends on: the blocks of
+///         \p Function, their successors (as seen through `noreturn` and
+///         tail-call information from \p Binary) and the relevant parts of
+///         \p Configuration. Instructions and labels do not contribute.
+uint64_t extractionHash(const yield::Function &Function,
+                        const model::Binary &Binary,
+                        const Configuration &Configuration);
+
+/// A cache of the graphs produced by `extractFromInternal`.
+///
+/// An instance is meant to be shared by all the pipes running in the same
+/// pipeline::Context, see `getOrCreateSharedObject`. Graphs are keyed by the
+/// entry of their function and are re-extracted only when its
+/// `extractionHash` changes, e.g., not when only the text of the instructions
+/// changed.
+///
+/// This class is thread-safe.
+class ExtractionCache {
+public:
+  static constexpr llvm::StringRef ContextName = "yield-cfg-extraction-cache";
+
+private:
+  struct Entry {
+    uint64_t Hash = 0;
+    PreLayoutGraph Graph;
+  };
+
+private:
+  std::mutex Mutex;
+  std::map<MetaAddress, Entry> Entries;
+
+public:
+  /// \return a copy of the graph extracted from \p Function, which the caller
+  ///         is free to modify (e.g., by computing the size of its nodes).
+  PreLayoutGraph extract(const yield::Function &Function,
+                         const model::Binary &Binary,
+                         const Configuration &Configuration);
+};
+
 } // namespace yield::cfg
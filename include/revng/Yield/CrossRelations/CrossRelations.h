@@ -33,6 +33,23 @@ public:
   CrossRelations(const SortedVector<efa::ControlFlowGraph> &Metadata,
                  const model::Binary &Binary);
 
+public:
+  /// Bring the relations up to date after the control flow graph of a single
+  /// function changed, without rebuilding them from all the functions.
+  ///
+  /// \note the function itself (and all its callees) must already be known.
+  void update(const efa::ControlFlowGraph &ControlFlowGraph) {
+    removeCallSitesIn(ControlFlowGraph.Entry());
+    recordCallSites(ControlFlowGraph);
+  }
+
+  /// Forget about all the calls performed by the function at \p Entry
+  void removeCallSitesIn(const MetaAddress &Entry);
+
+  /// Record all the calls performed by the function described by
+  /// \p ControlFlowGraph
+  void recordCallSites(const efa::ControlFlowGraph &ControlFlowGraph);
+
   GenericGraph<Node, 16, true> toCallGraph() const;
   yield::calls::PreLayoutGraph toYieldGraph() const;
 };
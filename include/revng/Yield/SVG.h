@@ -4,11 +4,13 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <map>
 #include <string>
 
 #include "revng/PTML/Tag.h"
+#include "revng/Support/BasicBlockID.h"
+#include "revng/Yield/ControlFlow/Graph.h"
 
-class BasicBlockID;
 namespace model {
 class Binary;
 }
@@ -21,6 +23,18 @@ namespace yield {
 
 class Function;
 
+namespace calls {
+
+class SliceableCallGraph;
+
+} // namespace calls
+
+namespace cfg {
+
+class ExtractionCache;
+
+} // namespace cfg
+
 namespace crossrelations {
 
 class CrossRelations;
@@ -35,17 +49,54 @@ using CrossRelations = yield::crossrelations::CrossRelations;
 
 } // namespace detail
 
+/// \param Cache if not null, used to avoid extracting the graph of
+///        \p InternalFunction again when its structure did not change.
 std::string controlFlowGraph(const ::ptml::PTMLBuilder &B,
                              const yield::Function &InternalFunction,
-                             const model::Binary &Binary);
+                             const model::Binary &Binary,
+                             cfg::ExtractionCache *Cache = nullptr);
+
+/// The control flow graph of a function, along with the contents of its
+/// nodes: everything that depends on the model.
+struct PreparedControlFlowGraph {
+  cfg::PreLayoutGraph Graph;
+  std::map<BasicBlockID, std::string> Contents;
+};
+
+/// The first half of `controlFlowGraph`, which accesses the model.
+PreparedControlFlowGraph
+prepareControlFlowGraph(const ::ptml::PTMLBuilder &B,
+                        const yield::Function &InternalFunction,
+                        const model::Binary &Binary,
+                        cfg::ExtractionCache *Cache = nullptr);
+
+/// The second half of `controlFlowGraph`: the layout and the export. Since it
+/// does not access the model, it's safe to run it on a different thread for
+/// each function.
+std::string controlFlowGraph(const ::ptml::PTMLBuilder &B,
+                             const PreparedControlFlowGraph &Prepared);
 std::string callGraph(const ::ptml::PTMLBuilder &B,
                       const detail::CrossRelations &CrossRelationTree,
                       const model::Binary &Binary);
+
+/// Write the call graph directly to \p OS: this is preferable for big
+/// binaries, since the SVG is never materialized as a whole.
+void callGraph(llvm::raw_ostream &OS,
+               const ::ptml::PTMLBuilder &B,
+               const detail::CrossRelations &CrossRelationTree,
+               const model::Binary &Binary);
 std::string callGraphSlice(const ::ptml::PTMLBuilder &B,
                            std::string_view SlicePoint,
                            const detail::CrossRelations &CrossRelationTree,
                            const model::Binary &Binary);
 
+/// Slice an already built call graph: this is preferable when producing the
+/// slices of many functions, since the graph is only built once.
+std::string callGraphSlice(const ::ptml::PTMLBuilder &B,
+                           std::string_view SlicePoint,
+                           const yield::calls::SliceableCallGraph &CallGraph,
+                           const model::Binary &Binary);
+
 } // namespace svg
 
 } // namespace yield
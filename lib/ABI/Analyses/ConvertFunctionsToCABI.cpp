@@ -4,10 +4,13 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <optional>
+
 #include "revng/ABI/FunctionType/Conversion.h"
 #include "revng/ABI/FunctionType/Support.h"
 #include "revng/ADT/UpcastablePointer.h"
 #include "revng/Model/Binary.h"
+#include "revng/Model/LayoutCache.h"
 #include "revng/Model/Pass/PurgeUnnamedAndUnreachableTypes.h"
 #include "revng/Model/RawFunctionDefinition.h"
 #include "revng/Model/TypeDefinition.h"
@@ -252,7 +255,15 @@ public:
     auto ToConvert = filterTypes<RawFD>(Model->TypeDefinitions(),
                                         TypesToIgnore);
 
-    // And convert them.
+    // And convert them, replacing all the converted types at once at the end
+    abi::FunctionType::TypeDefinitionReplacer Replacer;
+
+    // Until the replacement, existing type definitions are not modified: the
+    // sizes and the alignments computed for a function can be reused for the
+    // next ones
+    std::optional<model::LayoutCacheScope> LayoutCache;
+    LayoutCache.emplace();
+
     for (model::RawFunctionDefinition *Old : ToConvert) {
       auto &DT = llvm::cast<model::DefinedType>(*Model->makeType(Old->key()));
       if (!checkVectorRegisterSupport(VectorVH, *Old)) {
@@ -278,7 +289,11 @@ public:
       }
 
       namespace FT = abi::FunctionType;
-      if (auto New = FT::tryConvertToCABI(*Old, Model, ABI, SoftDeductions)) {
+      if (auto New = FT::tryConvertToCABI(*Old,
+                                          Model,
+                                          ABI,
+                                          SoftDeductions,
+                                          &Replacer)) {
         // If the conversion succeeds, make sure the returned type is valid,
         revng_assert(!New->isEmpty());
 
@@ -292,9 +307,16 @@ public:
         // `RawFunctionDefinition` is still used for those functions.
         // This might be an indication of an ABI misdetection.
         revng_log(Log, "Function Conversion Failed.");
+
+        // The temporary types created while trying are gone, their addresses
+        // might be reused
+        LayoutCache->invalidate();
       }
     }
 
+    LayoutCache.reset();
+    Replacer.apply(Model);
+
     // Don't forget to clean up any possible remainders of removed types.
     purgeUnnamedAndUnreachableTypes(Model);
   }
@@ -28,12 +28,17 @@ public:
     using abi::FunctionType::filterTypes;
     using CABIFD = model::CABIFunctionDefinition;
     auto ToConvert = filterTypes<CABIFD>(Model->TypeDefinitions());
+    abi::FunctionType::TypeDefinitionReplacer Replacer;
     for (model::CABIFunctionDefinition *Old : ToConvert) {
-      model::UpcastableType New = abi::FunctionType::convertToRaw(*Old, Model);
+      namespace FT = abi::FunctionType;
+      model::UpcastableType New = FT::convertToRaw(*Old, Model, &Replacer);
       revng_assert(!New.isEmpty());
       revng_assert(New->verify(VH));
     }
 
+    // Replace all the converted types at once
+    Replacer.apply(Model);
+
     // Don't forget to clean up any possible remainders of removed types.
     purgeUnnamedAndUnreachableTypes(Model);
   }
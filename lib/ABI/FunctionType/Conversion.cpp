@@ -140,7 +140,8 @@ std::optional<model::UpcastableType>
 tryConvertToCABI(const model::RawFunctionDefinition &FunctionType,
                  TupleTree<model::Binary> &Binary,
                  std::optional<model::ABI::Values> MaybeABI,
-                 bool UseSoftRegisterStateDeductions) {
+                 bool UseSoftRegisterStateDeductions,
+                 TypeDefinitionReplacer *Replacer) {
   if (!MaybeABI.has_value())
     MaybeABI = Binary->DefaultABI();
 
@@ -196,6 +197,12 @@ tryConvertToCABI(const model::RawFunctionDefinition &FunctionType,
     }
   }
 
+  if (Replacer != nullptr) {
+    // Let the caller replace all the converted types at once
+    Replacer->replace(FunctionType.key(), *Type, Binary);
+    return std::move(Type);
+  }
+
   // To finish up the conversion, remove all the references to the old type by
   // carefully replacing them with references to the new one.
   replaceTypeDefinition(FunctionType.key(), *Type, Binary);
@@ -40,7 +40,8 @@ public:
   /// Entry point for the `toRaw` conversion.
   model::UpcastableType
   convert(const model::CABIFunctionDefinition &FunctionType,
-          TupleTree<model::Binary> &Binary) const;
+          TupleTree<model::Binary> &Binary,
+          TypeDefinitionReplacer *Replacer) const;
 
   /// Helper used for deciding how an arbitrary return type should be
   /// distributed across registers and the stack accordingly to the \ref ABI.
@@ -74,7 +75,8 @@ public:
 
 model::UpcastableType
 ToRawConverter::convert(const model::CABIFunctionDefinition &FunctionType,
-                        TupleTree<model::Binary> &Binary) const {
+                        TupleTree<model::Binary> &Binary,
+                        TypeDefinitionReplacer *Replacer) const {
   revng_log(Log,
             "Converting a `CABIFunctionDefinition` to "
             "`RawFunctionDefinition`.");
@@ -295,6 +297,12 @@ ToRawConverter::convert(const model::CABIFunctionDefinition &FunctionType,
 
   revng_log(Log, "Conversion successful:\n" << toString(NewPrototype));
 
+  if (Replacer != nullptr) {
+    // Let the caller replace all the converted types at once
+    Replacer->replace(FunctionType.key(), *NewType, Binary);
+    return std::move(NewType);
+  }
+
   // To finish up the conversion, remove all the references to the old type
   // by carefully replacing them with references to the new one.
   replaceTypeDefinition(FunctionType.key(), *NewType, Binary);
@@ -358,9 +366,10 @@ ToRawConverter::distributeArguments(CFTArguments Arguments,
 
 model::UpcastableType
 convertToRaw(const model::CABIFunctionDefinition &FunctionType,
-             TupleTree<model::Binary> &Binary) {
+             TupleTree<model::Binary> &Binary,
+             TypeDefinitionReplacer *Replacer) {
   ToRawConverter ToRaw(abi::Definition::get(FunctionType.ABI()));
-  return ToRaw.convert(FunctionType, Binary);
+  return ToRaw.convert(FunctionType, Binary, Replacer);
 }
 
 Layout::Layout(const model::CABIFunctionDefinition &Function) {
@@ -685,6 +694,25 @@ UsedRegisters usedRegisters(const model::CABIFunctionDefinition &Function) {
   return Result;
 }
 
+const Layout &LayoutCache::layout(const model::TypeDefinition &Prototype) {
+  auto It = Layouts.find(&Prototype);
+  if (It == Layouts.end())
+    It = Layouts.emplace(&Prototype, Layout::make(Prototype)).first;
+
+  return It->second;
+}
+
+const UsedRegisters &
+LayoutCache::usedRegisters(const model::TypeDefinition &Prototype) {
+  auto It = Registers.find(&Prototype);
+  if (It == Registers.end()) {
+    auto Used = abi::FunctionType::usedRegisters(Prototype);
+    It = Registers.emplace(&Prototype, std::move(Used)).first;
+  }
+
+  return It->second;
+}
+
 } // namespace abi::FunctionType
 
 using FTL = abi::FunctionType::Layout;
@@ -7,6 +7,7 @@
 #include "llvm/ADT/SmallVector.h"
 
 #include "revng/ABI/Definition.h"
+#include "revng/Model/LayoutCache.h"
 #include "revng/Model/Register.h"
 
 namespace abi::FunctionType {
@@ -90,6 +91,15 @@ protected:
     revng_assert(ABI.verify());
   }
 
+  /// \return the alignment cache of the active `model::LayoutCacheScope`, if
+  ///         there's one, \p Local otherwise.
+  abi::Definition::AlignmentCache &
+  alignmentCache(abi::Definition::AlignmentCache &Local) const {
+    if (auto *Scope = model::LayoutCacheScope::current())
+      return Scope->alignments(ABI.ABI());
+    return Local;
+  }
+
   /// Helper for converting a single object into a "distributed" state.
   ///
   /// \param Size The size of the object.
@@ -125,7 +135,8 @@ protected:
              uint64_t OccupiedRegisterCount,
              uint64_t AllowedRegisterLimit,
              bool ForbidSplittingBetweenRegistersAndStack) {
-    abi::Definition::AlignmentCache Cache;
+    abi::Definition::AlignmentCache LocalCache;
+    auto &Cache = alignmentCache(LocalCache);
     return distribute(*Type.size(),
                       *ABI.alignment(Type, Cache),
                       *ABI.hasNaturalAlignment(Type, Cache),
@@ -163,7 +174,8 @@ public:
     if (ABI.ArgumentsArePositionBased()) {
       return positionBased(Type.isFloatPrimitive(), *Type.size());
     } else {
-      abi::Definition::AlignmentCache Cache;
+      abi::Definition::AlignmentCache LocalCache;
+      auto &Cache = alignmentCache(LocalCache);
       uint64_t Alignment = *ABI.alignment(Type, Cache);
       bool IsNatural = *ABI.hasNaturalAlignment(Type, Cache);
       return nonPositionBased(Type.isScalar(),
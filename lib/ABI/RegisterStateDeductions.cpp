@@ -7,120 +7,177 @@
 #include <span>
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
 
 #include "revng/ABI/Definition.h"
 #include "revng/Model/Binary.h"
 
 static Logger Log("abi-register-state-deduction");
 
-/// Finds last relevant (`Yes` or `Dead`) register out of the provided list.
-///
-/// Returns `0` if no registers from the list were mentioned.
-static size_t
-findLastUsedIndex(llvm::ArrayRef<model::Register::Values> Registers,
-                  const abi::Definition::RegisterSet &State) {
-  for (size_t Index = Registers.size(); Index != 0; --Index)
-    if (State.contains(Registers[Index - 1]))
-      return Index;
-
-  return 0;
+using Def = abi::Definition;
+using Mask = Def::RegisterMask;
+
+/// One of the ordered register lists of an ABI, together with the masks of all
+/// its prefixes, so that extending a state to every register preceding the
+/// last used one is a single mask operation.
+class RegisterList {
+private:
+  llvm::ArrayRef<model::Register::Values> Registers;
+
+  /// `Prefixes[I]` contains the first `I` registers of the list
+  llvm::SmallVector<Mask, 9> Prefixes;
+
+public:
+  explicit RegisterList(llvm::ArrayRef<model::Register::Values> Registers) :
+    Registers(Registers) {
+    Prefixes.reserve(Registers.size() + 1);
+    Prefixes.emplace_back();
+    for (model::Register::Values Register : Registers) {
+      Mask Next = Prefixes.back();
+      Next.set(Register);
+      Prefixes.push_back(Next);
+    }
+  }
+
+public:
+  llvm::ArrayRef<model::Register::Values> registers() const {
+    return Registers;
+  }
+
+  const Mask &all() const { return Prefixes.back(); }
+
+  /// Finds last relevant (`Yes` or `Dead`) register out of the list.
+  ///
+  /// Returns `0` if no registers from the list were mentioned.
+  size_t findLastUsedIndex(const Mask &State) const {
+    if ((State & all()).none())
+      return 0;
+
+    for (size_t Index = Registers.size(); Index != 0; --Index)
+      if (State.test(Registers[Index - 1]))
+        return Index;
+
+    revng_abort();
+  }
+
+  /// All the registers up to the last relevant one, i.e., the ones that must
+  /// be either used or padding in \p State.
+  const Mask &required(const Mask &State) const {
+    return Prefixes[findLastUsedIndex(State)];
+  }
+};
+
+static Mask toMask(const Def::RegisterSet &Registers) {
+  Mask Result;
+  for (model::Register::Values Register : Registers)
+    Result.set(Register);
+  return Result;
 }
 
-using Def = abi::Definition;
+static Def::RegisterSet toSet(const Mask &Registers) {
+  Def::RegisterSet Result;
+  for (size_t I = model::Register::Invalid + 1; I < model::Register::Count; ++I)
+    if (Registers.test(I))
+      Result.emplace_hint(Result.end(), model::Register::Values(I));
+  return Result;
+}
+
+static model::Register::Values first(const Mask &Registers) {
+  for (size_t I = model::Register::Invalid + 1; I < model::Register::Count; ++I)
+    if (Registers.test(I))
+      return model::Register::Values(I);
+  return model::Register::Invalid;
+}
 
 template<bool EnforceABIConformance>
 struct DeductionImpl {
   const abi::Definition &ABI;
   const std::string_view ABIName;
-  explicit DeductionImpl(const abi::Definition &ABI) :
-    ABI(ABI), ABIName(model::ABI::getName(ABI.ABI())) {}
+  const RegisterList GPArguments;
+  const RegisterList VectorArguments;
+  const RegisterList GPReturnValues;
+  const RegisterList VectorReturnValues;
 
-  std::optional<Def::RegisterSet> arguments(Def::RegisterSet Arguments) {
-    if (!ensureRegistersAreAllowed(Arguments, allowedArgumentRegisters()))
+  explicit DeductionImpl(const abi::Definition &ABI) :
+    ABI(ABI),
+    ABIName(model::ABI::getName(ABI.ABI())),
+    GPArguments(ABI.GeneralPurposeArgumentRegisters()),
+    VectorArguments(ABI.VectorArgumentRegisters()),
+    GPReturnValues(ABI.GeneralPurposeReturnValueRegisters()),
+    VectorReturnValues(ABI.VectorReturnValueRegisters()) {}
+
+  std::optional<Mask> arguments(Mask Arguments) {
+    Mask Allowed = GPArguments.all() | VectorArguments.all();
+    if (!ensureRegistersAreAllowed(Arguments, Allowed))
       return std::nullopt;
 
     if (ABI.ArgumentsArePositionBased()) {
       if (deducePositionBasedArguments(Arguments))
-        return std::move(Arguments);
+        return Arguments;
 
     } else {
       if (deduceNonPositionBasedArguments(Arguments))
-        return std::move(Arguments);
+        return Arguments;
     }
 
     return std::nullopt;
   }
 
-  std::optional<Def::RegisterSet> returnValues(Def::RegisterSet ReturnValues) {
-    if (!ensureRegistersAreAllowed(ReturnValues, allowedReturnValueRegisters()))
+  std::optional<Mask> returnValues(Mask ReturnValues) {
+    Mask Allowed = GPReturnValues.all() | VectorReturnValues.all();
+    if (!ensureRegistersAreAllowed(ReturnValues, Allowed))
       return std::nullopt;
 
     if (deduceReturnValues(ReturnValues))
-      return std::move(ReturnValues);
+      return ReturnValues;
 
     return std::nullopt;
   }
 
 private:
-  using CRegister = const model::Register::Values;
-  auto allowedArgumentRegisters() const {
-    return llvm::concat<CRegister>(ABI.GeneralPurposeArgumentRegisters(),
-                                   ABI.VectorArgumentRegisters());
-  }
-  auto allowedReturnValueRegisters() const {
-    return llvm::concat<CRegister>(ABI.GeneralPurposeReturnValueRegisters(),
-                                   ABI.VectorReturnValueRegisters());
-  }
+  bool ensureRegistersAreAllowed(Mask &UsedSet, const Mask &Allowed) const {
+    Mask Disallowed = UsedSet & ~Allowed;
+    if (Disallowed.none())
+      return true;
 
-  template<range_with_value_type<CRegister> Registers>
-  bool ensureRegistersAreAllowed(Def::RegisterSet &UsedSet,
-                                 Registers &&AllowedRegisters) const {
     if constexpr (EnforceABIConformance == true) {
-      size_t CountBefore = UsedSet.size();
-      std::erase_if(UsedSet, [&](model::Register::Values Register) {
-        return !llvm::is_contained(AllowedRegisters, Register);
-      });
-      if (size_t RemovedCount = UsedSet.size() != CountBefore)
-        revng_log(Log,
-                  "Removing " << RemovedCount
-                              << " registers from the set, as ABI doesn't "
-                                 "allow them to be used.");
+      UsedSet &= Allowed;
+      revng_log(Log,
+                "Removing " << Disallowed.count()
+                            << " registers from the set, as ABI doesn't "
+                               "allow them to be used.");
 
     } else {
-      for (model::Register::Values Register : UsedSet) {
-        if (!llvm::is_contained(AllowedRegisters, Register)) {
-          revng_log(Log,
-                    "Aborting, `model::Register::"
-                      << model::Register::getName(Register).data()
-                      << "` register is used despite not being allowed by `"
-                      << ABIName << "` ABI.");
-          return false;
-        }
-      }
+      revng_log(Log,
+                "Aborting, `model::Register::"
+                  << model::Register::getName(first(Disallowed)).data()
+                  << "` register is used despite not being allowed by `"
+                  << ABIName << "` ABI.");
+      return false;
     }
 
     return true;
   }
 
-  bool deducePositionBasedArguments(Def::RegisterSet &State) {
-    llvm::ArrayRef GPAR = ABI.GeneralPurposeArgumentRegisters();
-    llvm::ArrayRef VAR = ABI.VectorArgumentRegisters();
+  bool deducePositionBasedArguments(Mask &State) {
+    llvm::ArrayRef GPAR = GPArguments.registers();
+    llvm::ArrayRef VAR = VectorArguments.registers();
 
     bool IsRequired = false;
     if (GPAR.size() > VAR.size()) {
       for (auto Register : llvm::reverse(GPAR.drop_front(VAR.size()))) {
-        if (State.contains(Register))
+        if (State.test(Register))
           IsRequired = true;
         else if (IsRequired)
-          State.emplace(Register);
+          State.set(Register);
       }
       GPAR = GPAR.take_front(VAR.size());
     } else if (VAR.size() > GPAR.size()) {
       for (auto Register : llvm::reverse(VAR.drop_front(GPAR.size()))) {
-        if (State.contains(Register))
+        if (State.test(Register))
           IsRequired = true;
         else if (IsRequired)
-          State.emplace(Register);
+          State.set(Register);
       }
       VAR = VAR.take_front(GPAR.size());
     }
@@ -135,14 +192,14 @@ private:
 
   bool singlePositionBasedDeduction(model::Register::Values GPRegister,
                                     model::Register::Values VRegister,
-                                    Def::RegisterSet &State,
+                                    Mask &State,
                                     bool &IsRequired) {
-    if (State.contains(GPRegister)) {
-      if (State.contains(VRegister)) {
+    if (State.test(GPRegister)) {
+      if (State.test(VRegister)) {
         // Both are set - there's no way to tell which one is actually used.
         if constexpr (EnforceABIConformance == true) {
           // Pick one arbitrarily because most likely both of them are `Dead`.
-          State.erase(VRegister);
+          State.reset(VRegister);
         } else {
           // Report the problem and abort.
           revng_log(Log,
@@ -160,7 +217,7 @@ private:
         IsRequired = true;
       }
     } else {
-      if (State.contains(VRegister)) {
+      if (State.test(VRegister)) {
         // Only vector one is set: we're happy.
         IsRequired = true;
       } else {
@@ -168,7 +225,7 @@ private:
         if (IsRequired) {
           if constexpr (EnforceABIConformance == true) {
             // Pick one arbitrarily because most likely both of them are `Dead`.
-            State.emplace(GPRegister);
+            State.set(GPRegister);
           } else {
             // Report the problem and abort.
             revng_log(Log,
@@ -188,31 +245,17 @@ private:
     return true;
   }
 
-  template<range_with_value_type<CRegister> Registers>
-  void fillState(Def::RegisterSet &State, Registers RequiredRegisters) {
-    for (model::Register::Values Register : RequiredRegisters)
-      State.emplace(Register);
-  }
-
-  bool deduceNonPositionBasedArguments(Def::RegisterSet &State) {
-    llvm::ArrayRef GPs = ABI.GeneralPurposeArgumentRegisters();
-    llvm::ArrayRef RequiredGPRs = GPs.take_front(findLastUsedIndex(GPs, State));
-    llvm::ArrayRef VRs = ABI.VectorArgumentRegisters();
-    llvm::ArrayRef RequiredVRs = VRs.take_front(findLastUsedIndex(VRs, State));
-
-    fillState(State, llvm::concat<CRegister>(RequiredGPRs, RequiredVRs));
-
+  bool deduceNonPositionBasedArguments(Mask &State) {
+    State |= GPArguments.required(State) | VectorArguments.required(State);
     return true;
   }
 
-  bool deduceReturnValues(Def::RegisterSet &State) {
-    llvm::ArrayRef GPs = ABI.GeneralPurposeReturnValueRegisters();
-    llvm::ArrayRef RequiredGPRs = GPs.take_front(findLastUsedIndex(GPs, State));
-    llvm::ArrayRef VRs = ABI.VectorReturnValueRegisters();
-    llvm::ArrayRef RequiredVRs = VRs.take_front(findLastUsedIndex(VRs, State));
+  bool deduceReturnValues(Mask &State) {
+    const Mask &RequiredGPRs = GPReturnValues.required(State);
+    const Mask &RequiredVRs = VectorReturnValues.required(State);
 
-    if (!RequiredGPRs.empty()) {
-      if (!RequiredVRs.empty()) {
+    if (RequiredGPRs.any()) {
+      if (RequiredVRs.any()) {
         if constexpr (EnforceABIConformance == true) {
           // Even though we shouldn't let both through, we have no way
           // to differentiate between the two. So just keep them as is.
@@ -226,12 +269,12 @@ private:
         }
       } else {
         // Only general purpose registers are used: we're happy.
-        fillState(State, RequiredGPRs);
+        State |= RequiredGPRs;
       }
     } else {
-      if (!RequiredVRs.empty()) {
+      if (RequiredVRs.any()) {
         // Only vector registers are used: we're happy.
-        fillState(State, RequiredVRs);
+        State |= RequiredVRs;
       } else {
         // No return value (???)
         // Since there's no way to confirm, do nothing.
@@ -245,26 +288,50 @@ private:
 using SoftDeduction = DeductionImpl<false>;
 using StrictDeduction = DeductionImpl<true>;
 
+std::optional<abi::Definition::RegisterMask>
+Def::tryDeducingArgumentRegisterMask(RegisterMask Arguments) const {
+  return SoftDeduction(*this).arguments(Arguments);
+}
+
+std::optional<abi::Definition::RegisterMask>
+Def::tryDeducingReturnValueRegisterMask(RegisterMask ReturnValues) const {
+  return SoftDeduction(*this).returnValues(ReturnValues);
+}
+
+abi::Definition::RegisterMask
+Def::enforceArgumentRegisterMask(RegisterMask Arguments) const {
+  auto Result = StrictDeduction(*this).arguments(Arguments);
+  revng_assert(Result != std::nullopt);
+  return Result.value();
+}
+
+abi::Definition::RegisterMask
+Def::enforceReturnValueRegisterMask(RegisterMask ReturnValues) const {
+  auto Result = StrictDeduction(*this).returnValues(ReturnValues);
+  revng_assert(Result != std::nullopt);
+  return Result.value();
+}
+
 std::optional<abi::Definition::RegisterSet>
 Def::tryDeducingArgumentRegisterState(RegisterSet &&Arguments) const {
-  return SoftDeduction(*this).arguments(std::move(Arguments));
+  if (auto Result = tryDeducingArgumentRegisterMask(toMask(Arguments)))
+    return toSet(*Result);
+  return std::nullopt;
 }
 
 std::optional<abi::Definition::RegisterSet>
 Def::tryDeducingReturnValueRegisterState(RegisterSet &&ReturnValues) const {
-  return SoftDeduction(*this).returnValues(std::move(ReturnValues));
+  if (auto Result = tryDeducingReturnValueRegisterMask(toMask(ReturnValues)))
+    return toSet(*Result);
+  return std::nullopt;
 }
 
 abi::Definition::RegisterSet
 Def::enforceArgumentRegisterState(RegisterSet &&Arguments) const {
-  auto Result = StrictDeduction(*this).arguments(std::move(Arguments));
-  revng_assert(Result != std::nullopt);
-  return Result.value();
+  return toSet(enforceArgumentRegisterMask(toMask(Arguments)));
 }
 
 abi::Definition::RegisterSet
 Def::enforceReturnValueRegisterState(RegisterSet &&ReturnValues) const {
-  auto Result = StrictDeduction(*this).returnValues(std::move(ReturnValues));
-  revng_assert(Result != std::nullopt);
-  return Result.value();
+  return toSet(enforceReturnValueRegisterMask(toMask(ReturnValues)));
 }
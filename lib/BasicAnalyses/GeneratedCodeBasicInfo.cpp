@@ -51,8 +51,10 @@ void GeneratedCodeBasicInfo::run(Module &M) {
   Type *PCType = PC->getValueType();
   PCRegSize = M.getDataLayout().getTypeAllocSize(PCType);
 
-  for (GlobalVariable &CSV : FunctionTags::CSV.globals(&M))
+  for (GlobalVariable &CSV : FunctionTags::CSV.globals(&M)) {
     CSVs.push_back(&CSV);
+    CSVsSet.insert(&CSV);
+  }
 
   revng_log(PassesLog, "Ending GeneratedCodeBasicInfo");
 }
@@ -65,9 +67,19 @@ void GeneratedCodeBasicInfo::parseRoot() {
     return;
   RootParsed = true;
 
+  Blocks.reserve(RootFunction->size());
   for (BasicBlock &BB : *RootFunction) {
     if (!BB.empty()) {
-      switch (getType(&BB)) {
+      BlockInfo &Info = Blocks[&BB];
+      Info.Type = getType(&BB);
+      for (Instruction &I : llvm::reverse(BB)) {
+        if (auto *Call = getCallTo(&I, "newpc")) {
+          Info.LastNewPC = Call;
+          break;
+        }
+      }
+
+      switch (Info.Type) {
       case BlockType::RootDispatcherBlock:
         revng_assert(Dispatcher == nullptr);
         Dispatcher = &BB;
@@ -92,6 +104,7 @@ void GeneratedCodeBasicInfo::parseRoot() {
         auto *Call = cast<CallInst>(&*BB.begin());
         revng_assert(getCalledFunction(Call) == NewPC);
         JumpTargets[addressFromNewPC(Call)] = &BB;
+        Info.JumpTarget = &BB;
         break;
       }
       case BlockType::RootDispatcherHelperBlock:
@@ -104,6 +117,54 @@ void GeneratedCodeBasicInfo::parseRoot() {
       }
     }
   }
+
+  // Record the jump target of each block. A block reachable from multiple
+  // jump targets is left out, so that getJumpTargetBlock complains about it.
+  SmallPtrSet<const BasicBlock *, 4> Ambiguous;
+  for (auto &[Address, JumpTarget] : JumpTargets)
+    indexBlocksGeneratedBy(JumpTarget, Ambiguous);
+  for (const BasicBlock *BB : Ambiguous)
+    Blocks[BB].JumpTarget = nullptr;
+}
+
+using BlockSet = SmallPtrSetImpl<const BasicBlock *>;
+
+void GeneratedCodeBasicInfo::indexBlocksGeneratedBy(BasicBlock *JumpTarget,
+                                                    BlockSet &Ambiguous) {
+  // Visit all the blocks reachable without going through another jump target
+  // or leaving the translated code, as getBlocksGeneratedByPC does
+  SmallVector<BasicBlock *, 16> WorkList{ JumpTarget };
+  while (not WorkList.empty()) {
+    BasicBlock *BB = WorkList.pop_back_val();
+    for (BasicBlock *Successor : successors(BB)) {
+      auto It = Blocks.find(Successor);
+      if (It == Blocks.end())
+        continue;
+
+      BlockInfo &Info = It->second;
+      const auto IBDHB = BlockType::IndirectBranchDispatcherHelperBlock;
+      if (Info.Type != BlockType::TranslatedBlock and Info.Type != IBDHB)
+        continue;
+
+      if (Info.JumpTarget == JumpTarget)
+        continue;
+
+      if (Info.JumpTarget != nullptr)
+        Ambiguous.insert(Successor);
+      Info.JumpTarget = JumpTarget;
+      WorkList.push_back(Successor);
+    }
+  }
+}
+
+void GeneratedCodeBasicInfo::invalidateRootIndex() {
+  RootParsed = false;
+  Dispatcher = nullptr;
+  DispatcherFail = nullptr;
+  AnyPC = nullptr;
+  UnexpectedPC = nullptr;
+  JumpTargets.clear();
+  Blocks.clear();
 }
 
 SmallVector<std::pair<BasicBlock *, bool>, 4>
@@ -15,6 +15,10 @@
 /// strict debug info verification logic, which we currently do not handle.
 /// Specifically, if a function as debug information, then all the inlinable
 /// call sites targeting it need to have debug information too.
+///
+/// Since running the pass again on a function would produce the same result,
+/// each processed function is marked with the number of instructions it had,
+/// and, as long as that number doesn't change, it's not processed again.
 
 //
 // This file is distributed under the MIT License. See LICENSE.md for details.
@@ -22,6 +26,7 @@
 
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/IR/DIBuilder.h"
+#include "llvm/IR/Constants.h"
 #include "llvm/IR/DebugInfoMetadata.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Instructions.h"
@@ -70,6 +75,29 @@ public:
 template<>
 char pipeline::FunctionPass<AttachDebugInfo>::ID = 0;
 
+/// Name of the function metadata recording the number of instructions the
+/// function had when debug information has been attached to it
+static constexpr const char *AttachedMDName = "revng.debug-info-attached";
+
+/// \return true if debug information has been attached to \p F and, as far as
+///         we can tell, its body has not changed since
+static bool hasUpToDateDebugInfo(const llvm::Function &F) {
+  auto *Tuple = F.getMetadata(AttachedMDName);
+  if (Tuple == nullptr or Tuple->getNumOperands() != 1)
+    return false;
+
+  auto *Count = mdconst::dyn_extract<ConstantInt>(Tuple->getOperand(0));
+  return Count != nullptr and Count->getZExtValue() == F.getInstructionCount();
+}
+
+static void markDebugInfoAsAttached(llvm::Function &F) {
+  LLVMContext &Context = F.getContext();
+  auto *Count = ConstantInt::get(Type::getInt64Ty(Context),
+                                 F.getInstructionCount());
+  F.setMetadata(AttachedMDName,
+                MDTuple::get(Context, { ConstantAsMetadata::get(Count) }));
+}
+
 static bool isTrue(const llvm::Value *V) {
   return getLimitedValue(V) != 0;
 }
@@ -176,6 +204,12 @@ bool AttachDebugInfo::runOnFunction(const model::Function &ModelFunction,
   // Skip declarations
   revng_assert(not F.isDeclaration());
 
+  // Skip functions that have not changed since the last time we handled them
+  if (hasUpToDateDebugInfo(F)) {
+    revng_log(Log, "Debug info of " << F.getName() << " is up to date");
+    return true;
+  }
+
   auto FM = Cache->getControlFlowGraph(&F);
   revng_log(Log,
             "Metadata for Function " << F.getName() << ":"
@@ -201,6 +235,7 @@ bool AttachDebugInfo::runOnFunction(const model::Function &ModelFunction,
   DIB.finalizeSubprogram(TheSubprogram);
 
   handleFunction(DIB, F, TheSubprogram, FM, GCBI);
+  markDebugInfoAsAttached(F);
 
   return true;
 }
@@ -232,7 +267,8 @@ struct AttachDebugInfoToIsolatedPipe {
     Manager.add(new pipeline::LoadExecutionContextPass(&EC,
                                                        ModuleContainer.name()));
     Manager.add(new LoadModelWrapperPass(revng::getModelFromContext(EC)));
-    Manager.add(new ControlFlowGraphCachePass(CFGMap));
+    auto &SharedCFGs = getSharedControlFlowGraphCache(EC.getContext());
+    Manager.add(new ControlFlowGraphCachePass(CFGMap, &SharedCFGs));
     Manager.add(new pipeline::FunctionPass<AttachDebugInfo>());
     Manager.run(ModuleContainer.getModule());
   }
@@ -265,7 +301,8 @@ struct AttachDebugInfoToABIEnforcedPipe {
     Manager.add(new pipeline::LoadExecutionContextPass(&EC,
                                                        ModuleContainer.name()));
     Manager.add(new LoadModelWrapperPass(revng::getModelFromContext(EC)));
-    Manager.add(new ControlFlowGraphCachePass(CFGMap));
+    auto &SharedCFGs = getSharedControlFlowGraphCache(EC.getContext());
+    Manager.add(new ControlFlowGraphCachePass(CFGMap, &SharedCFGs));
     Manager.add(new pipeline::FunctionPass<AttachDebugInfo>());
     Manager.run(ModuleContainer.getModule());
   }
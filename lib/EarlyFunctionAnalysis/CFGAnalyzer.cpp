@@ -22,6 +22,7 @@
 #include "llvm/Transforms/Scalar/MergedLoadStoreMotion.h"
 #include "llvm/Transforms/Scalar/SROA.h"
 #include "llvm/Transforms/Scalar/SimplifyCFG.h"
+#include "llvm/Transforms/Utils/Cloning.h"
 
 #include "revng/ADT/Queue.h"
 #include "revng/BasicAnalyses/RemoveHelperCalls.h"
@@ -30,11 +31,13 @@
 #include "revng/EarlyFunctionAnalysis/BasicBlock.h"
 #include "revng/EarlyFunctionAnalysis/CFGAnalyzer.h"
 #include "revng/EarlyFunctionAnalysis/CallEdge.h"
+#include "revng/EarlyFunctionAnalysis/DiagnosticsBuffer.h"
 #include "revng/EarlyFunctionAnalysis/FunctionEdgeBase.h"
 #include "revng/EarlyFunctionAnalysis/Generated/Early/FunctionEdgeType.h"
 #include "revng/EarlyFunctionAnalysis/IndirectBranchInfoPrinterPass.h"
 #include "revng/EarlyFunctionAnalysis/PromoteGlobalToLocalVars.h"
 #include "revng/EarlyFunctionAnalysis/SegregateDirectStackAccesses.h"
+#include "revng/EarlyFunctionAnalysis/StackAccessAnalysis.h"
 #include "revng/Model/Generated/Early/FunctionAttribute.h"
 #include "revng/Support/BasicBlockID.h"
 #include "revng/Support/FunctionTags.h"
@@ -55,6 +58,35 @@ static opt<std::string> IndirectBranchInfoSummaryPath("indirect-branch-info-"
                                                            "of SA2 on disk."),
                                                       value_desc("filename"));
 
+static opt<std::string> DiagnosticsPath("efa-diagnostics",
+                                        desc("Keep in memory the output of "
+                                             "aa-writer and "
+                                             "indirect-branch-info-summary "
+                                             "and write it on disk, as a "
+                                             "compressed binary artifact, at "
+                                             "the end of the analysis."),
+                                        value_desc("filename"));
+
+static opt<unsigned> DiagnosticsBufferSize("efa-diagnostics-buffer-size",
+                                           desc("Maximum size, in KiB, of the "
+                                                "diagnostics kept in memory. "
+                                                "The oldest are dropped."),
+                                           init(4096));
+
+static opt<unsigned> DiagnosticsSampling("efa-diagnostics-sampling",
+                                         desc("Instrument only one in N "
+                                              "functions, selected through "
+                                              "their entry address."),
+                                         value_desc("N"),
+                                         init(1));
+
+static list<std::string> DiagnosticsFunctions("efa-diagnostics-functions",
+                                              desc("Instrument only the "
+                                                   "functions with these "
+                                                   "entry addresses."),
+                                              value_desc("address"),
+                                              CommaSeparated);
+
 static Logger<> Log("cfg-analyzer");
 
 static MetaAddress getFinalAddressOfBasicBlock(llvm::BasicBlock *BB) {
@@ -143,13 +175,113 @@ CFGAnalyzer::CFGAnalyzer(llvm::Module &M,
       ABICSVs.emplace_back(CSV);
 
   // Prepare header for debugging information about indirect branch infos
-  *OutputIBI << "name,ra,fso,address";
+  std::string IBIHeader = "name,ra,fso,address";
   for (const auto &Reg : ABICSVs)
-    *OutputIBI << "," << Reg->getName();
-  *OutputIBI << "\n";
+    IBIHeader += ("," + Reg->getName()).str();
+  IBIHeader += "\n";
+  *OutputIBI << IBIHeader;
+
+  if (DiagnosticsPath.getNumOccurrences() == 1) {
+    Diagnostics = std::make_unique<DiagnosticsBuffer>(DiagnosticsBufferSize
+                                                      * 1024);
+    Diagnostics->setPreamble(IBIHeader);
+  }
+
+  for (const std::string &Address : DiagnosticsFunctions) {
+    MetaAddress Entry = MetaAddress::fromString(Address);
+    revng_check(Entry.isValid(),
+                "Invalid address in efa-diagnostics-functions");
+    DiagnosticsFilter.insert(Entry);
+  }
+}
+
+CFGAnalyzer::~CFGAnalyzer() {
+  if (Diagnostics == nullptr)
+    return;
+
+  revng_log(Log,
+            "Writing " << Diagnostics->size() << " bytes of diagnostics, "
+                       << Diagnostics->dropped() << " records dropped");
+
+  std::error_code EC;
+  raw_fd_ostream Output(DiagnosticsPath, EC, llvm::sys::fs::OF_None);
+  revng_assert(!EC);
+  Diagnostics->write(Output);
+}
+
+bool CFGAnalyzer::isInstrumented(const MetaAddress &Entry) const {
+  if (not DiagnosticsFilter.empty() and not DiagnosticsFilter.contains(Entry))
+    return false;
+
+  if (DiagnosticsSampling <= 1)
+    return true;
+
+  // Use a fixed hash, so that the same functions are selected on each run
+  uint64_t Hash = Entry.address() * 0x9E3779B97F4A7C15ULL;
+  return (Hash >> 32) % DiagnosticsSampling == 0;
+}
+
+static OutlinedFunction copy(const OutlinedFunction &Original) {
+  revng_assert(Original.IndirectBranchInfoMarker == nullptr);
+
+  OutlinedFunction Result;
+  Result.Address = Original.Address;
+  Result.InlinedFunctionsByIndex = Original.InlinedFunctionsByIndex;
+
+  llvm::ValueToValueMapTy VMap;
+  Function *F = CloneFunction(Original.Function.get(), VMap);
+  Result.Function = UniqueValuePtr<llvm::Function>(F);
+
+  if (Original.AnyPCCloned != nullptr)
+    Result.AnyPCCloned = cast<llvm::BasicBlock>(VMap[Original.AnyPCCloned]);
+  if (Original.UnexpectedPCCloned != nullptr) {
+    auto *UnexpectedPC = VMap[Original.UnexpectedPCCloned];
+    Result.UnexpectedPCCloned = cast<llvm::BasicBlock>(UnexpectedPC);
+  }
+
+  return Result;
 }
 
 OutlinedFunction CFGAnalyzer::outline(const MetaAddress &Entry) {
+  // The requests we make are also requests of whoever is recording
+  std::vector<SummaryDependency> *Outer = Oracle.recorder();
+  auto Forward = [Outer](const std::vector<SummaryDependency> &Dependencies) {
+    if (Outer != nullptr)
+      llvm::append_range(*Outer, Dependencies);
+  };
+
+  auto It = OutlinedFunctions.find(Entry);
+  if (It != OutlinedFunctions.end()) {
+    auto IsUnchanged = [this](const SummaryDependency &Dependency) {
+      return Oracle.replay(Dependency) == Dependency.Hash;
+    };
+
+    Oracle.setRecorder(nullptr);
+    bool Unchanged = llvm::all_of(It->second.Dependencies, IsUnchanged);
+    Oracle.setRecorder(Outer);
+
+    if (Unchanged) {
+      revng_log(Log, "Reusing the outlined function " << Entry.toString());
+      Forward(It->second.Dependencies);
+      return copy(It->second.Function);
+    }
+
+    OutlinedFunctions.erase(It);
+  }
+
+  CachedOutlinedFunction NewEntry;
+  Oracle.setRecorder(&NewEntry.Dependencies);
+  OutlinedFunction Result = outlineImpl(Entry);
+  Oracle.setRecorder(Outer);
+  Forward(NewEntry.Dependencies);
+
+  NewEntry.Function = copy(Result);
+  OutlinedFunctions[Entry] = std::move(NewEntry);
+
+  return Result;
+}
+
+OutlinedFunction CFGAnalyzer::outlineImpl(const MetaAddress &Entry) {
   auto &CFG = Oracle.getLocalFunction(Entry).CFG;
   bool HasCFG = CFG.size() != 0;
   llvm::SmallSet<MetaAddress, 4> ReturnBlocks;
@@ -169,22 +301,31 @@ OutlinedFunction CFGAnalyzer::outline(const MetaAddress &Entry) {
 
   OutlinedFunction Result = Outliner.outline(Entry, &Summarizer);
 
-  // Make sure we start a new block before a PreCallHook
+  // Make sure we start a new block before a PreCallHook and for each jump
+  // target.
+  // Note: we only look into the outlined function, other functions (e.g., the
+  //       copies in OutlinedFunctions) have been handled already.
   auto IsFirst = [](llvm::Instruction *I) {
     return I->getParent()->getFirstNonPHI() == I;
   };
-  for (llvm::CallBase *Call : callers(PreCallHook.get()))
-    if (not IsFirst(Call))
-      Call->getParent()->splitBasicBlock(Call);
-
-  // Make sure we start a new block for each jump target
   auto IsJumpTarget = [](llvm::CallBase *Call) {
     auto IsJumpTarget = NewPCArguments::IsJumpTarget;
     return getLimitedValue(&*Call->getArgOperand(IsJumpTarget)) == 1;
   };
-  for (llvm::CallBase *Call : callers(M.getFunction("newpc")))
-    if (IsJumpTarget(Call) and not IsFirst(Call))
-      Call->getParent()->splitBasicBlock(Call);
+
+  llvm::SmallVector<llvm::CallBase *, 16> ToSplit;
+  for (llvm::Instruction &I : llvm::instructions(Result.Function.get())) {
+    if (auto *Call = getCallTo(&I, PreCallHook.get())) {
+      if (not IsFirst(Call))
+        ToSplit.push_back(Call);
+    } else if (auto *Call = getCallTo(&I, "newpc")) {
+      if (IsJumpTarget(Call) and not IsFirst(Call))
+        ToSplit.push_back(Call);
+    }
+  }
+
+  for (llvm::CallBase *Call : ToSplit)
+    Call->getParent()->splitBasicBlock(Call);
 
   return Result;
 }
@@ -591,7 +732,8 @@ void CFGAnalyzer::materializePCValues(llvm::Function *F,
   }
 }
 
-void CFGAnalyzer::runOptimizationPipeline(llvm::Function *F) {
+void CFGAnalyzer::runOptimizationPipeline(llvm::Function *F,
+                                          const MetaAddress &Entry) {
   using namespace llvm;
 
   // Some LLVM passes used later in the pipeline scan for cut-offs, meaning that
@@ -606,6 +748,14 @@ void CFGAnalyzer::runOptimizationPipeline(llvm::Function *F) {
   TemporaryUOption MemSSALimitOption(MemSSALimit, UINT_MAX);
   TemporaryUOption MemDepBlockLimitOption(MemDepBlockLimit, UINT_MAX);
 
+  // When collecting diagnostics in memory, the passes emitting them write
+  // here, and the output is recorded once the pipeline is done
+  bool Instrumented = isInstrumented(Entry);
+  std::string IBIOutput;
+  std::string AAOutput;
+  raw_string_ostream IBIStream(IBIOutput);
+  raw_string_ostream AAStream(AAOutput);
+
   // TODO: break it down in the future, and check if some passes can be dropped
   {
     FunctionPassManager FPM;
@@ -637,11 +787,17 @@ void CFGAnalyzer::runOptimizationPipeline(llvm::Function *F) {
 
     // Third stage: if enabled, serialize the results and dump the functions on
     // disk with the alias information included as comments.
-    if (IndirectBranchInfoSummaryPath.getNumOccurrences() == 1)
-      FPM.addPass(IndirectBranchInfoPrinterPass(*OutputIBI));
-
-    if (AAWriterPath.getNumOccurrences() == 1)
-      FPM.addPass(AAWriterPass(*OutputAAWriter));
+    if (Instrumented) {
+      if (IndirectBranchInfoSummaryPath.getNumOccurrences() == 1)
+        FPM.addPass(IndirectBranchInfoPrinterPass(*OutputIBI));
+      else if (Diagnostics != nullptr)
+        FPM.addPass(IndirectBranchInfoPrinterPass(IBIStream));
+
+      if (AAWriterPath.getNumOccurrences() == 1)
+        FPM.addPass(AAWriterPass(*OutputAAWriter));
+      else if (Diagnostics != nullptr)
+        FPM.addPass(AAWriterPass(AAStream));
+    }
 
     ModuleAnalysisManager MAM;
 
@@ -658,6 +814,7 @@ void CFGAnalyzer::runOptimizationPipeline(llvm::Function *F) {
       return LMA::fromModelWrapper(Binary);
     });
     FAM.registerPass([&] { return GeneratedCodeBasicInfoAnalysis(); });
+    FAM.registerPass([] { return StackAccessAnalysis(); });
     FAM.registerPass([&] { return ModuleAnalysisManagerFunctionProxy(MAM); });
 
     PassBuilder PB;
@@ -666,6 +823,20 @@ void CFGAnalyzer::runOptimizationPipeline(llvm::Function *F) {
 
     FPM.run(*F, FAM);
   }
+
+  if (Instrumented and Diagnostics != nullptr) {
+    IBIStream.flush();
+    AAStream.flush();
+    using Kind = DiagnosticsBuffer::RecordKind;
+    if (not IBIOutput.empty())
+      Diagnostics->record(Kind::IndirectBranchInfo,
+                          Entry.address(),
+                          std::move(IBIOutput));
+    if (not AAOutput.empty())
+      Diagnostics->record(Kind::AliasAnalysis,
+                          Entry.address(),
+                          std::move(AAOutput));
+  }
 }
 
 class ClobberedRegistersRegistry {
@@ -1097,7 +1268,7 @@ FunctionSummary CFGAnalyzer::analyze(const MetaAddress &Entry) {
   materializePCValues(F, Builder);
 
   // Execute the optimization pipeline over the outlined function
-  runOptimizationPipeline(F);
+  runOptimizationPipeline(F, Entry);
 
   // Squeeze out the results obtained from the optimization passes
   auto FunctionInfo = milkInfo(&OutlinedFunction, std::move(CFG));
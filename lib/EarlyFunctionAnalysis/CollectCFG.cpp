@@ -10,6 +10,7 @@
 #include "revng/EarlyFunctionAnalysis/CFGAnalyzer.h"
 #include "revng/EarlyFunctionAnalysis/CFGStringMap.h"
 #include "revng/EarlyFunctionAnalysis/ControlFlowGraph.h"
+#include "revng/EarlyFunctionAnalysis/FunctionSummaryCache.h"
 #include "revng/EarlyFunctionAnalysis/FunctionSummaryOracle.h"
 #include "revng/Model/Binary.h"
 #include "revng/Pipeline/Contract.h"
@@ -25,6 +26,15 @@ using namespace llvm;
 
 namespace revng::pipes {
 
+std::string exportCFG(llvm::StringRef Serialized) {
+  if (not isBinaryTupleTree(Serialized))
+    return Serialized.str();
+
+  auto MaybeCFG = TupleTree<efa::ControlFlowGraph>::fromString(Serialized);
+  revng_assert(MaybeCFG);
+  return toString(*MaybeCFG->get());
+}
+
 class CollectCFGPipe {
 public:
   static constexpr auto Name = "collect-cfg";
@@ -53,6 +63,7 @@ public:
     GCBI.run(M);
 
     FSOracle Oracle = FSOracle::importBasicPrototypeData(M, GCBI, *Binary);
+    efa::FunctionSummaryCache SummaryCache(M, *Binary);
     efa::CFGAnalyzer Analyzer(M, GCBI, Binary, Oracle);
 
     for (const model::Function &Function :
@@ -62,7 +73,8 @@ public:
       // Recover the control-flow graph of the function
       efa::ControlFlowGraph New;
       New.Entry() = EntryAddress;
-      New.Blocks() = std::move(Analyzer.analyze(EntryAddress).CFG);
+      auto Summary = SummaryCache.analyze(Analyzer, Oracle, EntryAddress);
+      New.Blocks() = std::move(Summary.CFG);
 
       if (DebugNames) {
         auto Function = Binary->Functions().at(EntryAddress);
@@ -77,8 +89,14 @@ public:
       revng_assert(New.Blocks().contains(BasicBlockID(New.Entry())));
 
       // TODO: we'd need a function-wise TupleTreeContainer
-      CFGs[EntryAddress] = toString(New);
+      std::string &Serialized = CFGs[EntryAddress];
+      Serialized.clear();
+      raw_string_ostream Stream(Serialized);
+      serializeBinary(Stream, New);
+      Stream.flush();
     }
+
+    SummaryCache.store();
   }
 };
 
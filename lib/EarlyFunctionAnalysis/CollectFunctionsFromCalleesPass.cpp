@@ -36,10 +36,10 @@ static void collectFunctionsFromCallees(Module &M,
   // Static symbols have already been registered during lifting phase. Now
   // register all the other candidate entry points.
   for (BasicBlock &BB : Root) {
-    if (getType(&BB) != BlockType::JumpTargetBlock)
+    if (GCBI.getBlockType(&BB) != BlockType::JumpTargetBlock)
       continue;
 
-    MetaAddress Entry = getBasicBlockAddress(getJumpTargetBlock(&BB));
+    MetaAddress Entry = getBasicBlockAddress(GCBI.getJumpTargetBlock(&BB));
     if (Binary.Functions().contains(Entry))
       continue;
 
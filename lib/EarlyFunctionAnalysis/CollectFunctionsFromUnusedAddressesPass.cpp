@@ -5,9 +5,10 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
-#include "boost/icl/interval_set.hpp"
-#include "boost/icl/right_open_interval.hpp"
+#include <algorithm>
+#include <vector>
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/IR/Module.h"
 
 #include "revng/EarlyFunctionAnalysis/CollectFunctionsFromUnusedAddressesPass.h"
@@ -41,9 +42,6 @@ public:
 private:
   void loadAllCFGs(ControlFlowGraphCache &MDCache) {
     for (auto &Function : Binary.Functions()) {
-      llvm::BasicBlock *Entry = GCBI.getBlockAt(Function.Entry());
-      llvm::Instruction *Term = Entry->getTerminator();
-
       const efa::ControlFlowGraph &FM = MDCache.getControlFlowGraph(Function
                                                                       .Entry());
       for (const efa::BasicBlock &Block : FM.Blocks()) {
@@ -52,20 +50,51 @@ private:
         revng_log(Log,
                   "Registering as used range [" << Start.toString() << ", "
                                                 << End.toString() << ")");
-        UsedRanges += interval::right_open(Start, End);
+        UsedRanges.emplace_back(Start, End);
+      }
+    }
+
+    // Sort and merge the ranges once, rather than keeping them merged as we go
+    llvm::sort(UsedRanges);
+    auto Last = UsedRanges.begin();
+    for (auto It = UsedRanges.begin(); It != UsedRanges.end(); ++It) {
+      if (It == Last)
+        continue;
+
+      if (It->first <= Last->second) {
+        Last->second = std::max(Last->second, It->second);
+      } else {
+        ++Last;
+        *Last = *It;
       }
     }
+
+    if (not UsedRanges.empty())
+      UsedRanges.erase(std::next(Last), UsedRanges.end());
+  }
+
+  bool isUsed(const MetaAddress &Address) const {
+    auto IsBefore = [](const MetaAddress &Address, const Range &R) {
+      return Address < R.first;
+    };
+    auto It = llvm::upper_bound(UsedRanges, Address, IsBefore);
+    if (It == UsedRanges.begin())
+      return false;
+    return Address < std::prev(It)->second;
   }
 
   void collectFunctionsFromUnusedAddresses() {
     using namespace llvm;
     Function &Root = *M.getFunction("root");
 
+    // Functions() cannot be queried during a batch insertion: insert the new
+    // functions at the end
+    std::vector<MetaAddress> NewFunctions;
     for (BasicBlock &BB : Root) {
-      if (getType(&BB) != BlockType::JumpTargetBlock)
+      if (GCBI.getBlockType(&BB) != BlockType::JumpTargetBlock)
         continue;
 
-      MetaAddress Entry = getBasicBlockAddress(getJumpTargetBlock(&BB));
+      MetaAddress Entry = getBasicBlockAddress(GCBI.getJumpTargetBlock(&BB));
       if (Binary.Functions().tryGet(Entry) != nullptr)
         continue;
 
@@ -76,7 +105,7 @@ private:
       bool IsPCStore = hasReason(Reasons, JTReason::PCStore);
       bool IsReturnAddress = hasReason(Reasons, JTReason::ReturnAddress);
       bool IsLoadAddress = hasReason(Reasons, JTReason::LoadAddress);
-      bool IsPartOfOtherCFG = UsedRanges.find(Entry) != UsedRanges.end();
+      bool IsPartOfOtherCFG = isUsed(Entry);
 
       revng_log(Log,
                 Entry.toString()
@@ -109,24 +138,29 @@ private:
                         << Entry.toString());
           }
 
-          Binary.Functions()[Entry];
+          NewFunctions.push_back(Entry);
           revng_log(Log,
                     "Found function from unused addresses: "
                       << BB.getName().str());
         }
       }
     }
+
+    auto Inserter = Binary.Functions().batch_insert();
+    for (const MetaAddress &Entry : NewFunctions)
+      Inserter.insert(model::Function(Entry));
   }
 
 private:
-  using interval_set = boost::icl::interval_set<MetaAddress>;
-  using interval = boost::icl::interval<MetaAddress>;
+  /// A right-open range of addresses
+  using Range = std::pair<MetaAddress, MetaAddress>;
 
 private:
   llvm::Module &M;
   GeneratedCodeBasicInfo &GCBI;
   model::Binary &Binary;
-  interval_set UsedRanges;
+  /// Sorted, non-overlapping ranges covered by the CFG of some function
+  std::vector<Range> UsedRanges;
 };
 
 bool CFFUAWrapperPass::runOnModule(llvm::Module &M) {
@@ -130,7 +130,7 @@ void ControlFlowGraph::serialize(GeneratedCodeBasicInfo &GCBI) const {
   std::string Buffer;
   {
     raw_string_ostream Stream(Buffer);
-    ::serialize(Stream, *this);
+    serializeBinary(Stream, *this);
   }
 
   Instruction *Term = BB->getTerminator();
@@ -138,22 +138,43 @@ void ControlFlowGraph::serialize(GeneratedCodeBasicInfo &GCBI) const {
   Term->setMetadata(ControlFlowGraphMDName, Node);
 }
 
+std::optional<TupleTree<ControlFlowGraph>>
+ControlFlowGraph::deserialize(const llvm::Instruction *Terminator) {
+  using namespace llvm;
+
+  auto *Node = Terminator->getMetadata(ControlFlowGraphMDName);
+  if (Node == nullptr)
+    return std::nullopt;
+
+  // Both the binary and the YAML encoding are accepted
+  StringRef Serialized = cast<MDString>(Node->getOperand(0))->getString();
+  auto MaybeCFG = TupleTree<ControlFlowGraph>::fromString(Serialized);
+  revng_assert(MaybeCFG);
+  return std::move(*MaybeCFG);
+}
+
 void ControlFlowGraph::simplify(const model::Binary &Binary) {
   // If A does not end with a call and A.end == B.start and A is the only
   // predecessor of B and B is the only successor of A, merge
 
   // Create quick map of predecessors
-  std::map<BasicBlockID, SmallVector<BasicBlockID, 2>> Predecessors;
+  BlockNumbering Numbering = numbering();
+  std::vector<SmallVector<BasicBlockID, 2>> Predecessors(Numbering.size());
+  auto AddPredecessor = [&](const BasicBlockID &ID,
+                            const BasicBlockID &Predecessor) {
+    if (auto Number = Numbering.find(ID))
+      Predecessors[*Number].push_back(Predecessor);
+  };
   for (efa::BasicBlock &Block : Blocks()) {
     for (auto &Successor : Block.Successors()) {
       if (Successor->Type() == efa::FunctionEdgeType::DirectBranch
           and Successor->Destination().isValid()) {
-        Predecessors[Successor->Destination()].push_back(Block.ID());
+        AddPredecessor(Successor->Destination(), Block.ID());
       } else if (auto *Call = dyn_cast<efa::CallEdge>(Successor.get())) {
         if (not Call->IsTailCall()
             and not Call->hasAttribute(Binary,
                                        model::FunctionAttribute::NoReturn)) {
-          Predecessors[Block.nextBlock()].push_back(Block.ID());
+          AddPredecessor(Block.nextBlock(), Block.ID());
         }
       }
     }
@@ -177,7 +198,8 @@ void ControlFlowGraph::simplify(const model::Binary &Binary) {
       continue;
 
     // Does the only successor has only one predecessor?
-    auto PredecessorsAddress = Predecessors.at(Block.nextBlock());
+    uint32_t Next = Numbering.number(Block.nextBlock());
+    const auto &PredecessorsAddress = Predecessors[Next];
     if (PredecessorsAddress.size() != 1)
       continue;
 
@@ -2,6 +2,9 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/xxhash.h"
+
 #include "revng/EarlyFunctionAnalysis/ControlFlowGraphCache.h"
 
 char ControlFlowGraphCachePass::ID = '_';
@@ -14,3 +17,60 @@ static llvm::RegisterPass<ControlFlowGraphCachePass> _("metadata-cache",
                                                        "used by later passes",
                                                        true,
                                                        true);
+
+static llvm::cl::opt<unsigned> CFGCacheSize("cfg-cache-size",
+                                            llvm::cl::desc("Memory budget, "
+                                                           "in MiB, for the "
+                                                           "deserialized "
+                                                           "CFGs"),
+                                            llvm::cl::init(1024));
+
+/// Rough ratio between the memory used by a deserialized CFG and the size of
+/// its binary encoding
+static constexpr size_t DecodedSizeFactor = 8;
+
+SharedControlFlowGraphCache::SharedControlFlowGraphCache() :
+  SharedControlFlowGraphCache(size_t(CFGCacheSize) * 1024 * 1024,
+                              size_t(CFGCacheSize) * 1024 * 1024 / 4) {
+}
+
+SharedControlFlowGraphCache::CFGPointer
+SharedControlFlowGraphCache::get(const MetaAddress &Address,
+                                 llvm::StringRef Serialized) {
+  Key TheKey = { Address, llvm::xxHash64(Serialized) };
+
+  std::string Binary;
+  {
+    std::lock_guard Lock(Mutex);
+    if (CFGPointer *Hit = Decoded.get(TheKey))
+      return *Hit;
+
+    if (std::string *Hit = Encoded.get(TheKey))
+      Binary = *Hit;
+  }
+
+  // The container might already hold the binary encoding
+  if (Binary.empty() and isBinaryTupleTree(Serialized))
+    Binary = Serialized.str();
+
+  // Decode outside of the critical section. Prefer the binary encoding, if we
+  // have it.
+  using CFGTree = TupleTree<efa::ControlFlowGraph>;
+  auto MaybeCFG = CFGTree::fromString(Binary.empty() ? Serialized : Binary);
+  revng_assert(MaybeCFG);
+
+  if (Binary.empty()) {
+    llvm::raw_string_ostream Stream(Binary);
+    MaybeCFG->serializeBinary(Stream);
+    Stream.flush();
+  }
+
+  auto Result = std::make_shared<const CFGTree>(std::move(*MaybeCFG));
+
+  std::lock_guard Lock(Mutex);
+  size_t Size = Binary.size();
+  Decoded.insert(TheKey, Result, Size * DecodedSizeFactor);
+  Encoded.insert(TheKey, std::move(Binary), Size);
+
+  return Result;
+}
@@ -12,6 +12,7 @@
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SetOperations.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/IR/GlobalVariable.h"
 #include "llvm/IR/Instruction.h"
@@ -31,6 +32,7 @@
 #include "revng/EarlyFunctionAnalysis/ControlFlowGraphCache.h"
 #include "revng/EarlyFunctionAnalysis/DetectABI.h"
 #include "revng/EarlyFunctionAnalysis/FunctionEdgeBase.h"
+#include "revng/EarlyFunctionAnalysis/FunctionSummaryCache.h"
 #include "revng/EarlyFunctionAnalysis/FunctionSummaryOracle.h"
 #include "revng/Model/Binary.h"
 #include "revng/Model/Pass/PromoteOriginalName.h"
@@ -40,6 +42,7 @@
 #include "revng/Pipes/Kinds.h"
 #include "revng/Pipes/ModelGlobal.h"
 #include "revng/Support/BasicBlockID.h"
+#include "revng/Support/Deadline.h"
 #include "revng/Support/Debug.h"
 #include "revng/Support/IRHelpers.h"
 #include "revng/Support/MetaAddress.h"
@@ -82,6 +85,24 @@ static opt<ABIOpt> ABIEnforcement("abi-enforcement-level",
                                                     "found.")),
                                   init(ABIOpt::FullABIEnforcement));
 
+static opt<bool> IncrementalABI("detect-abi-incremental",
+                                 desc("Only run the ABI analysis on the "
+                                      "functions without a prototype, the "
+                                      "functions whose CFG analysis could not "
+                                      "be reused and the functions listed in "
+                                      "-detect-abi-changed, along with their "
+                                      "callers. The analysis then proceeds as "
+                                      "far as results change."),
+                                 init(false));
+
+static list<std::string> ChangedFunctions("detect-abi-changed",
+                                          desc("In incremental mode, the "
+                                               "entry points of the "
+                                               "functions whose prototype "
+                                               "has changed since the last "
+                                               "run."),
+                                          CommaSeparated);
+
 static Logger<> Log("detect-abi");
 
 struct Changes {
@@ -149,6 +170,7 @@ private:
   TupleTree<model::Binary> &Binary;
   FunctionSummaryOracle &Oracle;
   CFGAnalyzer &Analyzer;
+  FunctionSummaryCache &SummaryCache;
 
   CallGraph ApproximateCallGraph;
   BasicBlockToNodeMap BasicBlockNodeMap;
@@ -159,14 +181,16 @@ public:
             ControlFlowGraphCache &FMC,
             TupleTree<model::Binary> &Binary,
             FunctionSummaryOracle &Oracle,
-            CFGAnalyzer &Analyzer) :
+            CFGAnalyzer &Analyzer,
+            FunctionSummaryCache &SummaryCache) :
     M(M),
     Context(M.getContext()),
     GCBI(GCBI),
     FMC(FMC),
     Binary(Binary),
     Oracle(Oracle),
-    Analyzer(Analyzer) {}
+    Analyzer(Analyzer),
+    SummaryCache(SummaryCache) {}
 
 public:
   void run() {
@@ -207,6 +231,7 @@ private:
   void computeApproximateCallGraph();
   void preliminaryFunctionAnalysis();
   void analyzeABI();
+  std::vector<model::Function *> selectFunctionsToAnalyze();
   Changes analyzeFunctionABI(const model::Function &Function,
                              OutlinedFunction &OutlinedFunction,
                              OpaqueRegisterUser &Clobberer);
@@ -257,6 +282,7 @@ void DetectABI::computeApproximateCallGraph() {
 
   for (const auto &Function : Binary->Functions()) {
     llvm::SmallSet<BasicBlock *, 8> Visited;
+    llvm::SmallPtrSet<BasicBlockNode *, 8> Callees;
     auto *Entry = GCBI.getBlockAt(Function.Entry());
     revng_assert(Entry != nullptr);
 
@@ -266,18 +292,17 @@ void DetectABI::computeApproximateCallGraph() {
 
     while (!Worklist.empty()) {
       BasicBlock *Current = Worklist.pop_back_val();
-      Visited.insert(Current);
+
+      // A block can be enqueued multiple times before being visited
+      if (not Visited.insert(Current).second)
+        continue;
 
       if (hasMarker(Current, "function_call")) {
         // If not an indirect call, add the node to the CG
         if (BasicBlock *Callee = getFunctionCallCallee(Current)) {
-          BasicBlockNode *GraphNode = nullptr;
           auto It = BasicBlockNodeMap.find(Callee);
           if (It != BasicBlockNodeMap.end()) {
-            auto IsCurrentSuccessor = [&It](auto &Successor) {
-              return Successor == It->second;
-            };
-            if (not any_of(StartNode->successors(), IsCurrentSuccessor))
+            if (Callees.insert(It->second).second)
               StartNode->addSuccessor(It->second);
           }
         }
@@ -339,7 +364,6 @@ void DetectABI::preliminaryFunctionAnalysis() {
 
     // The intraprocedural analysis will be scheduled only for those functions
     // which have `Invalid` as type.
-    auto &Function = Binary->Functions().at(Node->Address);
     EntrypointsQueue.insert(Node);
   }
 
@@ -355,7 +379,9 @@ void DetectABI::preliminaryFunctionAnalysis() {
     revng_log(Log, "Analyzing " << EntryPointAddress.toString());
     LoggerIndent<> Indent(Log);
 
-    FunctionSummary AnalysisResult = Analyzer.analyze(EntryNode->Address);
+    FunctionSummary AnalysisResult = SummaryCache.analyze(Analyzer,
+                                                          Oracle,
+                                                          EntryNode->Address);
 
     if (Log.isEnabled()) {
       AnalysisResult.dump(Log);
@@ -452,15 +478,20 @@ void DetectABI::analyzeABI() {
   LoggerIndent<> Indent(Log);
 
   llvm::Task Task(2, "analyzeABI");
+
+  // Temporary functions are created on demand, since in incremental mode only
+  // a fraction of them is usually needed. This is not affecting the results:
+  // outlining only depends on information that does not change from now on.
   std::map<MetaAddress, std::unique_ptr<OutlinedFunction>> Functions;
+  auto GetOutlined = [this, &Functions](MetaAddress Entry) -> auto & {
+    std::unique_ptr<OutlinedFunction> &Result = Functions[Entry];
+    if (Result == nullptr)
+      Result = make_unique<OutlinedFunction>(Analyzer.outline(Entry));
+    return *Result;
+  };
 
-  // Create all temporary functions
-  Task.advance("Create temporary functions");
-  for (model::Function &Function : Binary->Functions()) {
-    const MetaAddress &Entry = Function.Entry();
-    auto NewFunction = make_unique<OutlinedFunction>(Analyzer.outline(Entry));
-    Functions[Function.Entry()] = std::move(NewFunction);
-  }
+  Task.advance("Select functions to analyze");
+  std::vector<model::Function *> InitialWorklist = selectFunctionsToAnalyze();
 
   // Push this into analyzeFunction
   OpaqueRegisterUser RegisterUser(&M);
@@ -469,8 +500,8 @@ void DetectABI::analyzeABI() {
   Task.advance("Run fixed-point analyses");
   llvm::Task FixedPointTask({}, "Fixed-point analysis");
   UniquedQueue<model::Function *> ToAnalyze;
-  for (model::Function &Function : Binary->Functions())
-    ToAnalyze.insert(&Function);
+  for (model::Function *Function : InitialWorklist)
+    ToAnalyze.insert(Function);
 
   // Change the oracle default prototype to have no arguments nor return values
   {
@@ -482,10 +513,15 @@ void DetectABI::analyzeABI() {
 
   unsigned Runs = 0;
   while (not ToAnalyze.empty()) {
+    // Give up on the fixed point: the functions still to analyze keep the
+    // results obtained so far, the ones never analyzed the default prototype
+    if (revng::deadlineExpired("the ABI analysis fixed point"))
+      break;
+
     model::Function &Function = *ToAnalyze.pop();
     revng_log(Log, "Analyzing " << Function.Entry().toString());
     FixedPointTask.advance(Function.name());
-    OutlinedFunction &OutlinedFunction = *Functions.at(Function.Entry());
+    OutlinedFunction &OutlinedFunction = GetOutlined(Function.Entry());
     Changes Changes = analyzeFunctionABI(Function,
                                          OutlinedFunction,
                                          RegisterUser);
@@ -514,6 +550,51 @@ void DetectABI::analyzeABI() {
   }
 }
 
+std::vector<model::Function *> DetectABI::selectFunctionsToAnalyze() {
+  std::vector<model::Function *> Result;
+
+  if (not IncrementalABI) {
+    for (model::Function &Function : Binary->Functions())
+      Result.push_back(&Function);
+    return Result;
+  }
+
+  std::set<MetaAddress> Seeds = SummaryCache.recomputed();
+  for (const model::Function &Function : Binary->Functions())
+    if (Function.Prototype().isEmpty())
+      Seeds.insert(Function.Entry());
+
+  for (const std::string &Changed : ChangedFunctions) {
+    MetaAddress Entry = MetaAddress::fromString(Changed);
+    if (not Binary->Functions().contains(Entry)) {
+      revng_log(Log, "Ignoring unknown function " << Changed);
+      continue;
+    }
+    Seeds.insert(Entry);
+  }
+
+  // The callers need to see the new arguments and return values of the seeds
+  std::set<MetaAddress> Selected = Seeds;
+  for (const MetaAddress &Entry : Seeds) {
+    auto *Node = BasicBlockNodeMap.lookup(GCBI.getBlockAt(Entry));
+    revng_assert(Node != nullptr);
+    for (auto *CallerNode : Node->predecessors())
+      if (CallerNode->Address.isValid())
+        Selected.insert(CallerNode->Address);
+  }
+
+  revng_log(Log,
+            "Incremental mode: analyzing " << Selected.size() << " out of "
+                                           << Binary->Functions().size()
+                                           << " functions");
+
+  for (model::Function &Function : Binary->Functions())
+    if (Selected.contains(Function.Entry()))
+      Result.push_back(&Function);
+
+  return Result;
+}
+
 Changes DetectABI::analyzeFunctionABI(const model::Function &Function,
                                       OutlinedFunction &OutlinedFunction,
                                       OpaqueRegisterUser &RegisterReader) {
@@ -588,34 +669,34 @@ void DetectABI::applyABIDeductions() {
   if (ABIEnforcement == NoABIEnforcement)
     return;
 
-  auto ABI = abi::Definition::get(Binary->DefaultABI());
+  const auto &ABI = abi::Definition::get(Binary->DefaultABI());
   for (const model::Function &Function : Binary->Functions()) {
     auto &Summary = Oracle.getLocalFunction(Function.Entry());
 
-    abi::Definition::RegisterSet Arguments;
-    abi::Definition::RegisterSet RValues;
+    abi::Definition::RegisterMask Arguments;
+    abi::Definition::RegisterMask RValues;
     model::Architecture::Values Architecture = Binary->Architecture();
     for (const auto &Register : model::Architecture::registers(Architecture)) {
       llvm::StringRef Name = model::Register::getCSVName(Register);
       if (llvm::GlobalVariable *CSV = M.getGlobalVariable(Name, true)) {
         if (Summary.ABIResults.ArgumentsRegisters.contains(CSV))
-          Arguments.emplace(Register);
+          Arguments.set(Register);
 
         if (Summary.ABIResults.ReturnValuesRegisters.contains(CSV))
-          RValues.emplace(Register);
+          RValues.set(Register);
       }
     }
 
     if (ABIEnforcement == FullABIEnforcement) {
-      Arguments = ABI.enforceArgumentRegisterState(std::move(Arguments));
-      RValues = ABI.enforceReturnValueRegisterState(std::move(RValues));
+      Arguments = ABI.enforceArgumentRegisterMask(Arguments);
+      RValues = ABI.enforceReturnValueRegisterMask(RValues);
     } else {
-      if (auto R = ABI.tryDeducingArgumentRegisterState(std::move(Arguments)))
+      if (auto R = ABI.tryDeducingArgumentRegisterMask(Arguments))
         Arguments = *R;
       else
         continue; // Register deduction failed.
 
-      if (auto R = ABI.tryDeducingReturnValueRegisterState(std::move(RValues)))
+      if (auto R = ABI.tryDeducingReturnValueRegisterMask(RValues))
         RValues = *R;
       else
         continue; // Register deduction failed.
@@ -626,9 +707,9 @@ void DetectABI::applyABIDeductions() {
     for (const auto &Register : model::Architecture::registers(Architecture)) {
       llvm::StringRef Name = model::Register::getCSVName(Register);
       if (llvm::GlobalVariable *CSV = M.getGlobalVariable(Name, true)) {
-        if (Arguments.contains(Register))
+        if (Arguments.test(Register))
           ResultingArguments.insert(CSV);
-        if (RValues.contains(Register))
+        if (RValues.test(Register))
           ResultingReturnValues.insert(CSV);
       }
     }
@@ -1079,11 +1160,13 @@ bool DetectABIPass::runOnModule(Module &M) {
 
   using FSOracle = FunctionSummaryOracle;
   FSOracle Oracle = FSOracle::importFullPrototypes(M, GCBI, *Binary);
+  FunctionSummaryCache SummaryCache(M, *Binary);
   CFGAnalyzer Analyzer(M, GCBI, Binary, Oracle);
 
-  DetectABI ABIDetector(M, GCBI, FMC, Binary, Oracle, Analyzer);
+  DetectABI ABIDetector(M, GCBI, FMC, Binary, Oracle, Analyzer, SummaryCache);
 
   ABIDetector.run();
+  SummaryCache.store();
 
   return false;
 }
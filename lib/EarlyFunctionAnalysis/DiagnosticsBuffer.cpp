@@ -0,0 +1,63 @@
+/// \file DiagnosticsBuffer.cpp
+/// Bounded in-memory buffer of the diagnostics of the CFG analysis.
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/EndianStream.h"
+
+#include "revng/EarlyFunctionAnalysis/DiagnosticsBuffer.h"
+#include "revng/Support/Assert.h"
+#include "revng/Support/GzipStream.h"
+
+using namespace llvm;
+
+namespace efa {
+
+void DiagnosticsBuffer::record(RecordKind Kind,
+                               uint64_t Address,
+                               std::string &&Data) {
+  // A record that does not fit at all is dropped right away
+  if (Data.size() > Capacity) {
+    ++Dropped;
+    return;
+  }
+
+  Size += Data.size();
+  Records.push_back({ Kind, Address, std::move(Data) });
+
+  while (Size > Capacity) {
+    revng_assert(not Records.empty());
+    Size -= Records.front().Data.size();
+    Records.pop_front();
+    ++Dropped;
+  }
+}
+
+void DiagnosticsBuffer::write(raw_ostream &OS) const {
+  SmallVector<char, 0> Uncompressed;
+  raw_svector_ostream Stream(Uncompressed);
+  support::endian::Writer Writer(Stream, support::little);
+
+  auto WriteString = [&](StringRef String) {
+    revng_assert(String.size() <= UINT32_MAX);
+    Writer.write<uint32_t>(String.size());
+    Stream << String;
+  };
+
+  Stream << Magic;
+  Writer.write<uint64_t>(Dropped);
+  WriteString(Preamble);
+
+  for (const Record &TheRecord : Records) {
+    Writer.write<uint8_t>(TheRecord.Kind);
+    Writer.write<uint64_t>(TheRecord.Address);
+    WriteString(TheRecord.Data);
+  }
+
+  gzipCompress(OS, ArrayRef<char>(Uncompressed));
+}
+
+} // namespace efa
@@ -0,0 +1,239 @@
+/// \file FunctionSummaryCache.cpp
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+
+#include "revng/EarlyFunctionAnalysis/CFGAnalyzer.h"
+#include "revng/EarlyFunctionAnalysis/FunctionSummaryCache.h"
+#include "revng/Model/Binary.h"
+#include "revng/Pipeline/ArtifactCache.h"
+#include "revng/Support/Debug.h"
+#include "revng/Support/PathList.h"
+#include "revng/TupleTree/BinarySerialization.h"
+
+using namespace llvm;
+
+static Logger<> Log("function-summary-cache");
+
+static cl::opt<bool> NoFunctionSummaryCache("no-function-summary-cache",
+                                            cl::desc("Do not reuse the "
+                                                     "results of previous "
+                                                     "analyses of functions"),
+                                            cl::init(false));
+
+/// Bump this every time the layout of the cache or the analysis change
+static constexpr unsigned FunctionSummaryCacheVersion = 2;
+
+using Reader = revng::detail::BinaryTupleTreeReader;
+using Writer = revng::detail::BinaryTupleTreeWriter;
+
+namespace efa {
+
+/// Hash everything, other than the oracle, that can affect the outcome of
+/// CFGAnalyzer::analyze
+static std::string computeKey(const Module &M, const model::Binary &Binary) {
+  pipeline::ArtifactCache::KeyBuilder Builder;
+  Builder.addField(model::Architecture::getName(Binary.Architecture()));
+
+  for (const model::Function &Function : Binary.Functions()) {
+    Builder.addField(Function.Entry().toString());
+    for (model::FunctionAttribute::Values Attribute : Function.Attributes())
+      Builder.addField(model::FunctionAttribute::getName(Attribute));
+  }
+
+  for (const model::DynamicFunction &Function :
+       Binary.ImportedDynamicFunctions()) {
+    Builder.addField(Function.OriginalName());
+    for (model::FunctionAttribute::Values Attribute : Function.Attributes())
+      Builder.addField(model::FunctionAttribute::getName(Attribute));
+  }
+
+  M.print(Builder, nullptr);
+
+  return Builder.finalize();
+}
+
+static void write(Writer &Writer, const SummaryDependency &Dependency) {
+  auto Kind = static_cast<uint8_t>(Dependency.Kind);
+  MetaAddress Function = Dependency.Function;
+  BasicBlockID CallSite = Dependency.CallSite;
+  MetaAddress CalledLocalFunction = Dependency.CalledLocalFunction;
+  std::string CalledSymbol = Dependency.CalledSymbol;
+  uint64_t Hash = Dependency.Hash;
+  Writer.write(Kind);
+  Writer.write(Function);
+  Writer.write(CallSite);
+  Writer.write(CalledLocalFunction);
+  Writer.write(CalledSymbol);
+  Writer.write(Hash);
+}
+
+static bool read(Reader &Reader, SummaryDependency &Dependency) {
+  uint8_t Kind = 0;
+  Reader.read(Kind);
+  Reader.read(Dependency.Function);
+  Reader.read(Dependency.CallSite);
+  Reader.read(Dependency.CalledLocalFunction);
+  Reader.read(Dependency.CalledSymbol);
+  Reader.read(Dependency.Hash);
+
+  if (Kind > SummaryDependency::ExactCallSite)
+    return false;
+  Dependency.Kind = static_cast<SummaryDependency::KindType>(Kind);
+
+  return not Reader.failed();
+}
+
+FunctionSummaryCache::FunctionSummaryCache(const Module &M,
+                                           const model::Binary &Binary) :
+  M(M) {
+  if (NoFunctionSummaryCache)
+    return;
+
+  std::string FileName = ("summaries-v" + Twine(FunctionSummaryCacheVersion)
+                          + "-" + computeKey(M, Binary) + ".bin")
+                           .str();
+  Path = joinPath(getCacheDirectory(), "function-summaries", FileName);
+  load();
+}
+
+void FunctionSummaryCache::load() {
+  auto MaybeBuffer = MemoryBuffer::getFile(Path,
+                                           /* IsText */ false,
+                                           /* RequiresNullTerminator */ false);
+  if (not MaybeBuffer)
+    return;
+
+  Reader Reader((*MaybeBuffer)->getBuffer());
+  std::map<MetaAddress, std::vector<Entry>> Loaded;
+
+  auto ReadAll = [&]() {
+    if (not Reader.readHeader())
+      return false;
+
+    uint64_t FunctionsCount = 0;
+    Reader.read(FunctionsCount);
+    for (uint64_t I = 0; I < FunctionsCount and not Reader.failed(); ++I) {
+      MetaAddress Address;
+      uint64_t EntriesCount = 0;
+      Reader.read(Address);
+      Reader.read(EntriesCount);
+      std::vector<Entry> &FunctionEntries = Loaded[Address];
+      for (uint64_t J = 0; J < EntriesCount and not Reader.failed(); ++J) {
+        Entry &NewEntry = FunctionEntries.emplace_back();
+        uint64_t DependenciesCount = 0;
+        Reader.read(DependenciesCount);
+        for (uint64_t K = 0; K < DependenciesCount; ++K)
+          if (not read(Reader, NewEntry.Dependencies.emplace_back()))
+            return false;
+
+        if (not NewEntry.Summary.deserialize(Reader, M))
+          return false;
+      }
+    }
+
+    return not Reader.failed() and Reader.atEnd();
+  };
+
+  if (not ReadAll()) {
+    revng_log(Log, "Ignoring malformed cache " << Path);
+    return;
+  }
+
+  Entries = std::move(Loaded);
+  revng_log(Log, "Loaded " << Entries.size() << " functions from " << Path);
+}
+
+FunctionSummary FunctionSummaryCache::analyze(CFGAnalyzer &Analyzer,
+                                              FunctionSummaryOracle &Oracle,
+                                              const MetaAddress &Address) {
+  if (Path.empty()) {
+    Recomputed.insert(Address);
+    return Analyzer.analyze(Address);
+  }
+
+  std::vector<Entry> &FunctionEntries = Entries[Address];
+
+  // Look for an entry which recorded the same answers from the oracle
+  for (auto It = FunctionEntries.rbegin(); It != FunctionEntries.rend(); ++It) {
+    auto IsUnchanged = [&Oracle](const SummaryDependency &Dependency) {
+      return Oracle.replay(Dependency) == Dependency.Hash;
+    };
+
+    if (llvm::all_of(It->Dependencies, IsUnchanged)) {
+      revng_log(Log, "Reusing the summary of " << Address.toString());
+      ++Hits;
+      return It->Summary.clone();
+    }
+  }
+
+  ++Misses;
+  Recomputed.insert(Address);
+
+  Entry NewEntry;
+  Oracle.setRecorder(&NewEntry.Dependencies);
+  FunctionSummary Result = Analyzer.analyze(Address);
+  Oracle.setRecorder(nullptr);
+  NewEntry.Summary = Result.clone();
+
+  if (FunctionEntries.size() == MaxEntriesPerFunction)
+    FunctionEntries.erase(FunctionEntries.begin());
+  FunctionEntries.push_back(std::move(NewEntry));
+  Changed = true;
+
+  return Result;
+}
+
+void FunctionSummaryCache::store() {
+  revng_log(Log, Hits << " hits, " << Misses << " misses");
+
+  if (Path.empty() or not Changed)
+    return;
+
+  if (auto EC = sys::fs::create_directories(sys::path::parent_path(Path))) {
+    revng_log(Log, "Unable to create the directory of " << Path);
+    return;
+  }
+
+  auto WriteAll = [this](raw_ostream &Stream) {
+    Writer Writer(Stream);
+    Writer.writeHeader();
+
+    uint64_t FunctionsCount = Entries.size();
+    Writer.write(FunctionsCount);
+    for (const auto &[Address, FunctionEntries] : Entries) {
+      MetaAddress Key = Address;
+      uint64_t EntriesCount = FunctionEntries.size();
+      Writer.write(Key);
+      Writer.write(EntriesCount);
+      for (const Entry &Entry : FunctionEntries) {
+        uint64_t DependenciesCount = Entry.Dependencies.size();
+        Writer.write(DependenciesCount);
+        for (const SummaryDependency &Dependency : Entry.Dependencies)
+          write(Writer, Dependency);
+        Entry.Summary.serialize(Writer);
+      }
+    }
+
+    return Error::success();
+  };
+
+  // Write to a temporary file first, so that concurrent analyses never observe
+  // a partially written cache
+  std::string TemporaryPath = Path + ".tmp-%%%%%%%%";
+  if (auto Result = writeFileAtomically(TemporaryPath, Path, WriteAll)) {
+    revng_log(Log, "Unable to write " << Path << ": " << Result);
+    consumeError(std::move(Result));
+  }
+
+  Changed = false;
+}
+
+} // namespace efa
@@ -4,16 +4,76 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include "llvm/ADT/Hashing.h"
 #include "llvm/IR/GlobalVariable.h"
+#include "llvm/Support/xxhash.h"
 
 #include "revng/ABI/FunctionType/Layout.h"
 #include "revng/ADT/STLExtras.h"
 #include "revng/EarlyFunctionAnalysis/FunctionSummaryOracle.h"
+#include "revng/TupleTree/BinarySerialization.h"
 
 static Logger<> Log("efa-import-model");
 
 namespace efa {
 
+void FunctionSummary::serialize(revng::detail::BinaryTupleTreeWriter &Writer)
+  const {
+  Writer.write(const_cast<AttributesSet &>(Attributes));
+
+  // CSVs are identified by name, in order not to depend on their addresses
+  std::vector<std::string> Clobbered;
+  for (const llvm::GlobalVariable *CSV : ClobberedRegisters)
+    Clobbered.push_back(CSV->getName().str());
+  llvm::sort(Clobbered);
+  Writer.write(Clobbered);
+
+  bool HasFSO = ElectedFSO.has_value();
+  int64_t FSO = ElectedFSO.value_or(0);
+  Writer.write(HasFSO);
+  Writer.write(FSO);
+
+  Writer.write(const_cast<SortedVector<efa::BasicBlock> &>(CFG));
+}
+
+bool FunctionSummary::deserialize(revng::detail::BinaryTupleTreeReader &Reader,
+                                  const llvm::Module &M) {
+  std::vector<std::string> Clobbered;
+  bool HasFSO = false;
+  int64_t FSO = 0;
+  Reader.read(Attributes);
+  Reader.read(Clobbered);
+  Reader.read(HasFSO);
+  Reader.read(FSO);
+  Reader.read(CFG);
+  if (Reader.failed())
+    return false;
+
+  ClobberedRegisters.clear();
+  for (const std::string &Name : Clobbered) {
+    llvm::GlobalVariable *CSV = M.getGlobalVariable(Name, true);
+    if (CSV == nullptr)
+      return false;
+    ClobberedRegisters.insert(CSV);
+  }
+
+  ElectedFSO.reset();
+  if (HasFSO)
+    ElectedFSO = FSO;
+
+  return true;
+}
+
+uint64_t FunctionSummary::hash() const {
+  std::string Buffer;
+  {
+    llvm::raw_string_ostream Stream(Buffer);
+    revng::detail::BinaryTupleTreeWriter Writer(Stream);
+    serialize(Writer);
+  }
+  return llvm::xxHash64(Buffer);
+}
+
 FunctionSummary
 PrototypeImporter::prototype(const AttributesSet &Attributes,
                              const model::TypeDefinition *Prototype) {
@@ -69,10 +129,10 @@ PrototypeImporter::prototype(const AttributesSet &Attributes,
 }
 
 std::pair<const FunctionSummary *, bool>
-FunctionSummaryOracle::getCallSite(MetaAddress Function,
-                                   BasicBlockID CallerBlockAddress,
-                                   MetaAddress CalledLocalFunction,
-                                   llvm::StringRef CalledSymbol) {
+FunctionSummaryOracle::getCallSiteImpl(MetaAddress Function,
+                                       BasicBlockID CallerBlockAddress,
+                                       MetaAddress CalledLocalFunction,
+                                       llvm::StringRef CalledSymbol) {
   auto [Summary, IsTailCall] = getExactCallSite(Function, CallerBlockAddress);
   if (Summary != nullptr) {
     return { Summary, IsTailCall };
@@ -146,13 +206,13 @@ bool FunctionSummaryOracle::registerDynamicFunction(llvm::StringRef Name,
   }
 }
 
-const FunctionSummary &FunctionSummaryOracle::getDefault() {
+const FunctionSummary &FunctionSummaryOracle::getDefaultImpl() {
   if (not Default.has_value())
     setDefault(Importer.prototype({}, Binary.defaultPrototype()));
   return Default.value();
 }
 
-FunctionSummary &FunctionSummaryOracle::getLocalFunction(MetaAddress PC) {
+FunctionSummary &FunctionSummaryOracle::getLocalFunctionImpl(MetaAddress PC) {
   if (not LocalFunctions.contains(PC)) {
     const model::Function &Function = Binary.Functions().at(PC);
     AttributesSet Attributes;
@@ -168,7 +228,7 @@ FunctionSummary &FunctionSummaryOracle::getLocalFunction(MetaAddress PC) {
 }
 
 const FunctionSummary &
-FunctionSummaryOracle::getDynamicFunction(llvm::StringRef Name) {
+FunctionSummaryOracle::getDynamicFunctionImpl(llvm::StringRef Name) {
   if (not DynamicFunctions.contains(Name.str())) {
     const auto &DynamicFunction = Binary.ImportedDynamicFunctions()
                                     .at(Name.str());
@@ -185,8 +245,8 @@ FunctionSummaryOracle::getDynamicFunction(llvm::StringRef Name) {
 }
 
 std::pair<FunctionSummary *, bool>
-FunctionSummaryOracle::getExactCallSite(MetaAddress Entry,
-                                        BasicBlockID CallSiteAddress) {
+FunctionSummaryOracle::getExactCallSiteImpl(MetaAddress Entry,
+                                            BasicBlockID CallSiteAddress) {
   auto It = CallSites.find({ Entry, CallSiteAddress });
   if (It == CallSites.end()) {
     // Note: in case of absence we're doing the lookup every time, not super
@@ -215,6 +275,126 @@ FunctionSummaryOracle::getExactCallSite(MetaAddress Entry,
   }
 }
 
+static uint64_t hash(const std::pair<const FunctionSummary *, bool> &Result) {
+  auto [Summary, IsTailCall] = Result;
+  uint64_t SummaryHash = Summary != nullptr ? Summary->hash() : 0;
+  return llvm::hash_combine(SummaryHash, IsTailCall);
+}
+
+static uint64_t hash(const FunctionSummary &Summary) {
+  return Summary.hash();
+}
+
+template<typename CallableType>
+decltype(auto) FunctionSummaryOracle::record(SummaryDependency Request,
+                                             CallableType &&Compute) {
+  // Requests performed while computing the result are implied by the
+  // outermost one, don't record them
+  std::vector<SummaryDependency> *Outer = std::exchange(Recorder, nullptr);
+  decltype(auto) Result = Compute();
+  Recorder = Outer;
+
+  if (Recorder != nullptr) {
+    Request.Hash = hash(Result);
+    Recorder->push_back(std::move(Request));
+  }
+
+  return Result;
+}
+
+const FunctionSummary &FunctionSummaryOracle::getDefault() {
+  return record({ .Kind = SummaryDependency::Default },
+                [this]() -> const FunctionSummary & {
+                  return getDefaultImpl();
+                });
+}
+
+FunctionSummary &FunctionSummaryOracle::getLocalFunction(MetaAddress PC) {
+  return record({ .Kind = SummaryDependency::LocalFunction, .Function = PC },
+                [this, PC]() -> FunctionSummary & {
+                  return getLocalFunctionImpl(PC);
+                });
+}
+
+std::pair<const FunctionSummary *, bool>
+FunctionSummaryOracle::getCallSite(MetaAddress Function,
+                                   BasicBlockID CallerBlockAddress,
+                                   MetaAddress CalledLocalFunction,
+                                   llvm::StringRef CalledSymbol) {
+  return record({ .Kind = SummaryDependency::CallSite,
+                  .Function = Function,
+                  .CallSite = CallerBlockAddress,
+                  .CalledLocalFunction = CalledLocalFunction,
+                  .CalledSymbol = CalledSymbol.str() },
+                [&]() {
+                  return getCallSiteImpl(Function,
+                                         CallerBlockAddress,
+                                         CalledLocalFunction,
+                                         CalledSymbol);
+                });
+}
+
+const FunctionSummary &
+FunctionSummaryOracle::getDynamicFunction(llvm::StringRef Name) {
+  return record({ .Kind = SummaryDependency::DynamicFunction,
+                  .CalledSymbol = Name.str() },
+                [this, Name]() -> const FunctionSummary & {
+                  return getDynamicFunctionImpl(Name);
+                });
+}
+
+std::pair<FunctionSummary *, bool>
+FunctionSummaryOracle::getExactCallSite(MetaAddress Function,
+                                        BasicBlockID CallSite) {
+  return record({ .Kind = SummaryDependency::ExactCallSite,
+                  .Function = Function,
+                  .CallSite = CallSite },
+                [this, Function, CallSite]() {
+                  return getExactCallSiteImpl(Function, CallSite);
+                });
+}
+
+std::optional<uint64_t>
+FunctionSummaryOracle::replay(const SummaryDependency &Dependency) {
+  revng_assert(Recorder == nullptr);
+
+  const auto &Functions = Binary.Functions();
+  const auto &DynamicFunctions = Binary.ImportedDynamicFunctions();
+  bool HasFunction = Functions.contains(Dependency.Function);
+  llvm::StringRef Symbol = Dependency.CalledSymbol;
+  bool HasSymbol = Symbol.empty() or DynamicFunctions.contains(Symbol.str());
+
+  switch (Dependency.Kind) {
+  case SummaryDependency::Default:
+    return getDefault().hash();
+
+  case SummaryDependency::LocalFunction:
+    if (not HasFunction)
+      return std::nullopt;
+    return getLocalFunction(Dependency.Function).hash();
+
+  case SummaryDependency::DynamicFunction:
+    if (Symbol.empty() or not HasSymbol)
+      return std::nullopt;
+    return getDynamicFunction(Symbol).hash();
+
+  case SummaryDependency::CallSite:
+    if (not HasFunction or not HasSymbol)
+      return std::nullopt;
+    return hash(getCallSite(Dependency.Function,
+                            Dependency.CallSite,
+                            Dependency.CalledLocalFunction,
+                            Symbol));
+
+  case SummaryDependency::ExactCallSite:
+    if (not HasFunction)
+      return std::nullopt;
+    return hash(getExactCallSite(Dependency.Function, Dependency.CallSite));
+  }
+
+  revng_abort();
+}
+
 template<PrototypeImportLevel Level>
 FunctionSummaryOracle importImpl(llvm::Module &M,
                                  GeneratedCodeBasicInfo &GCBI,
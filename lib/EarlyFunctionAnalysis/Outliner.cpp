@@ -670,10 +670,10 @@ Outliner::getCallSiteInfo(MetaAddress CallerFunction,
     CalledSymbol = extractFromConstantStringPtr(JumpToSymbol->getArgOperand(0));
   }
 
-  return Oracle.getCallSite(CallerFunction,
-                            CallSiteAddress,
-                            Callee,
-                            CalledSymbol);
+  return Oracle->getCallSite(CallerFunction,
+                             CallSiteAddress,
+                             Callee,
+                             CalledSymbol);
 }
 
 } // namespace efa
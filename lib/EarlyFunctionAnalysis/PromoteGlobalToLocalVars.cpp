@@ -9,6 +9,7 @@
 #include "llvm/IR/IRBuilder.h"
 
 #include "revng/EarlyFunctionAnalysis/PromoteGlobalToLocalVars.h"
+#include "revng/EarlyFunctionAnalysis/StackAccessAnalysis.h"
 #include "revng/Support/IRHelpers.h"
 #include "revng/Support/OpaqueRegisterUser.h"
 
@@ -20,20 +21,9 @@ PromoteGlobalToLocalPass::run(llvm::Function &F,
 
   // Collect the CSVs used by the current function.
   std::map<GlobalVariable *, Value *> CSVMap;
-  for (auto &BB : F) {
-    for (auto &I : BB) {
-      Value *Pointer = nullptr;
-      if (auto *Load = dyn_cast<LoadInst>(&I))
-        Pointer = skipCasts(Load->getPointerOperand());
-      else if (auto *Store = dyn_cast<StoreInst>(&I))
-        Pointer = skipCasts(Store->getPointerOperand());
-      else
-        continue;
-
-      if (auto *CSV = dyn_cast_or_null<GlobalVariable>(Pointer))
-        CSVMap.try_emplace(CSV);
-    }
-  }
+  for (const auto &Access : FAM.getResult<StackAccessAnalysis>(F).accesses())
+    if (Access.Kind == StackAccesses::AccessKind::CSV)
+      CSVMap.try_emplace(cast<GlobalVariable>(Access.Pointer));
 
   // Create an equivalent local variable, replace all the uses of the CSV.
   IRBuilder<> Builder(&F.getEntryBlock().front());
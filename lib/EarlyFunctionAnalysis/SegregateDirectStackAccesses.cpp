@@ -12,10 +12,10 @@
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/MDBuilder.h"
-#include "llvm/IR/PatternMatch.h"
 
 #include "revng/BasicAnalyses/GeneratedCodeBasicInfo.h"
 #include "revng/EarlyFunctionAnalysis/SegregateDirectStackAccesses.h"
+#include "revng/EarlyFunctionAnalysis/StackAccessAnalysis.h"
 #include "revng/Support/Assert.h"
 
 using namespace llvm;
@@ -27,6 +27,7 @@ using SDSAPI = SegregateDirectStackAccessesPassImpl;
 class SegregateDirectStackAccessesPassImpl {
   LLVMContext *Context = nullptr;
   GeneratedCodeBasicInfo *GCBI = nullptr;
+  StackAccesses *Accesses = nullptr;
   std::vector<Instruction *> DirectStackAccesses;
   std::vector<Instruction *> NotDirectStackAccesses;
 
@@ -51,6 +52,10 @@ void SDSAPI::run(Function &F, FunctionAnalysisManager &FAM) {
   GCBI = &(FAM.getResult<GeneratedCodeBasicInfoAnalysis>(F));
   revng_assert(GCBI != nullptr);
 
+  // Get the memory accesses of the function, along with their offset from the
+  // stack pointer, if any
+  Accesses = &(FAM.getResult<StackAccessAnalysis>(F));
+
   // Populate the two buckets with all load and store instruction of the
   // function, properly segregated.
   segregateAccesses(F);
@@ -60,27 +65,6 @@ void SDSAPI::run(Function &F, FunctionAnalysisManager &FAM) {
 }
 
 void SDSAPI::segregateAccesses(Function &F) {
-  using namespace PatternMatch;
-
-  Value *LoadSP = nullptr;
-  bool Found = false;
-
-  for (BasicBlock &BB : F) {
-    for (Instruction &I : BB) {
-      if (auto *LI = dyn_cast<LoadInst>(&I)) {
-        if (GCBI->isSPReg(skipCasts(LI->getPointerOperand()))) {
-          revng_assert(!Found);
-          LoadSP = LI;
-          Found = true;
-          break;
-        }
-      }
-    }
-
-    if (Found)
-      break;
-  }
-
   // Modify the IR after alloca instructions, if they exist.
   auto It = F.getEntryBlock().begin();
   while (It->getOpcode() == Instruction::Alloca)
@@ -94,65 +78,44 @@ void SDSAPI::segregateAccesses(Function &F) {
   // Note that this problem will be addressed by opaque pointers in the future.
   auto *I8PtrTy = Builder.getInt8PtrTy();
   auto *CE = ConstantExpr::getBitCast(GCBI->spReg(), I8PtrTy->getPointerTo());
-  Value *SPI8Ptr = Builder.CreateLoad(I8PtrTy, CE);
-
-  for (BasicBlock &BB : F) {
-    for (Instruction &I : BB) {
-      Value *Pointer = nullptr;
-
-      // Differentiate accesses and add them onto their respective bucket.
-      // Everything that is not a direct access on the stack is put onto the
-      // bucket `NotDirectStackAccesses`. Load/store that access the CSVs will
-      // have their alias info added later as well.
-      if (auto *LI = dyn_cast<LoadInst>(&I))
-        Pointer = skipCasts(LI->getPointerOperand());
-      else if (auto *SI = dyn_cast<StoreInst>(&I))
-        Pointer = skipCasts(SI->getPointerOperand());
-
-      if (Pointer != nullptr) {
-        Value *LoadPtr = nullptr;
-        Value *LHS = nullptr;
-        Value *BitCast = nullptr;
-        ConstantInt *Offset = nullptr;
-        Builder.SetInsertPoint(&I);
-
-        // Do we have a inttoptr to a load i64, i64* LoadPtr as pointer operand
-        // of the current instruction, where LoadPtr is SP? Change it with the
-        // newly-created bitcasted load in order to prevent from using inttoptr.
-        if (Pointer == LoadSP) {
-          Type *DestTy = nullptr;
-          if (isa<LoadInst>(&I))
-            DestTy = I.getOperand(0)->getType();
-          else
-            DestTy = I.getOperand(0)->getType()->getPointerTo();
-
-          BitCast = Builder.CreateBitCast(SPI8Ptr, DestTy);
-          I.setOperand(isa<LoadInst>(&I) ? 0 : 1, BitCast);
-
-          DirectStackAccesses.emplace_back(&I);
-        } else if (match(Pointer, m_c_Add(m_Value(LHS), m_ConstantInt(Offset)))
-                   && LHS == LoadSP) {
-          // Do we have a inttoptr whose pointer operand is an instruction `add
-          // i64 LHS, X` with X negative constant and LHS the stack pointer? If
-          // so, canonicalize the i2p + add into a gep whose value is bitcasted
-          // to the original type of SP.
-          auto *GEP = Builder.CreateGEP(Builder.getInt8Ty(), SPI8Ptr, Offset);
-
-          Type *DestTy = nullptr;
-          if (isa<LoadInst>(&I))
-            DestTy = I.getOperand(0)->getType();
-          else
-            DestTy = I.getOperand(0)->getType()->getPointerTo();
-
-          BitCast = Builder.CreateBitCast(GEP, DestTy);
-          I.setOperand(isa<LoadInst>(&I) ? 0 : 1, BitCast);
-
-          DirectStackAccesses.emplace_back(&I);
-        } else {
-          NotDirectStackAccesses.emplace_back(&I);
-        }
-      }
+  auto *SPI8Ptr = Builder.CreateLoad(I8PtrTy, CE);
+  NotDirectStackAccesses.emplace_back(SPI8Ptr);
+
+  LoadInst *LoadSP = Accesses->stackPointer();
+  for (const StackAccesses::MemoryAccess &Access : Accesses->accesses()) {
+    Instruction &I = *Access.I;
+
+    // Differentiate accesses and add them onto their respective bucket.
+    // Everything that is not a direct access on the stack is put onto the
+    // bucket `NotDirectStackAccesses`. Load/store that access the CSVs will
+    // have their alias info added later as well.
+    if (Access.Kind != StackAccesses::AccessKind::Stack) {
+      NotDirectStackAccesses.emplace_back(&I);
+      continue;
     }
+
+    Builder.SetInsertPoint(&I);
+
+    // Is the pointer operand of the current instruction the stack pointer
+    // itself, or a constant offset from it (e.g., `add i64 LoadSP, X`)? If so,
+    // canonicalize the inttoptr into a gep on the newly-created bitcasted load
+    // of SP, in order to prevent from using inttoptr.
+    Value *Pointer = SPI8Ptr;
+    if (Access.Offset != 0) {
+      auto *Offset = ConstantInt::get(LoadSP->getType(), Access.Offset, true);
+      Pointer = Builder.CreateGEP(Builder.getInt8Ty(), SPI8Ptr, Offset);
+    }
+
+    Type *DestTy = nullptr;
+    if (isa<LoadInst>(&I))
+      DestTy = I.getOperand(0)->getType();
+    else
+      DestTy = I.getOperand(0)->getType()->getPointerTo();
+
+    Value *BitCast = Builder.CreateBitCast(Pointer, DestTy);
+    I.setOperand(isa<LoadInst>(&I) ? 0 : 1, BitCast);
+
+    DirectStackAccesses.emplace_back(&I);
   }
 }
 
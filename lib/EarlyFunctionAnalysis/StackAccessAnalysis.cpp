@@ -0,0 +1,88 @@
+/// \file StackAccessAnalysis.cpp
+/// Classify the memory accesses of a function and compute the offset of the
+/// direct stack accesses from the stack pointer at the function entry.
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/InstrTypes.h"
+
+#include "revng/BasicAnalyses/GeneratedCodeBasicInfo.h"
+#include "revng/EarlyFunctionAnalysis/StackAccessAnalysis.h"
+#include "revng/Support/Assert.h"
+#include "revng/Support/IRHelpers.h"
+
+using namespace llvm;
+
+AnalysisKey StackAccessAnalysis::Key;
+
+StackAccesses::StackAccesses(Function &F, const GeneratedCodeBasicInfo &GCBI) {
+  for (BasicBlock &BB : F) {
+    for (Instruction &I : BB) {
+      Value *Pointer = nullptr;
+      if (auto *Load = dyn_cast<LoadInst>(&I))
+        Pointer = skipCasts(Load->getPointerOperand());
+      else if (auto *Store = dyn_cast<StoreInst>(&I))
+        Pointer = skipCasts(Store->getPointerOperand());
+      else
+        continue;
+
+      // The accesses are visited in layout order, the first load of the stack
+      // pointer is therefore the one in the entry block, if any
+      if (StackPointer == nullptr and isa<LoadInst>(&I)
+          and GCBI.isSPReg(Pointer)) {
+        StackPointer = cast<LoadInst>(&I);
+        Offsets[StackPointer] = 0;
+      }
+
+      MemoryAccess Access{ &I, Pointer };
+      if (isa<GlobalVariable>(Pointer)) {
+        Access.Kind = AccessKind::CSV;
+      } else if (auto Offset = stackOffset(Pointer)) {
+        Access.Kind = AccessKind::Stack;
+        Access.Offset = *Offset;
+      }
+
+      Accesses.push_back(Access);
+    }
+  }
+}
+
+std::optional<int64_t> StackAccesses::stackOffset(Value *V) {
+  if (StackPointer == nullptr)
+    return std::nullopt;
+
+  auto It = Offsets.find(V);
+  if (It != Offsets.end())
+    return It->second;
+
+  std::optional<int64_t> Result;
+  if (auto *BO = dyn_cast<BinaryOperator>(V)) {
+    Value *LHS = BO->getOperand(0);
+    Value *RHS = BO->getOperand(1);
+    auto *Constant = dyn_cast<ConstantInt>(RHS);
+    if (Constant == nullptr and BO->getOpcode() == Instruction::Add) {
+      std::swap(LHS, RHS);
+      Constant = dyn_cast<ConstantInt>(RHS);
+    }
+
+    if (Constant != nullptr and Constant->getBitWidth() <= 64) {
+      auto Base = stackOffset(LHS);
+      if (Base and BO->getOpcode() == Instruction::Add)
+        Result = *Base + Constant->getSExtValue();
+      else if (Base and BO->getOpcode() == Instruction::Sub)
+        Result = *Base - Constant->getSExtValue();
+    }
+  }
+
+  Offsets[V] = Result;
+  return Result;
+}
+
+StackAccesses StackAccessAnalysis::run(Function &F,
+                                       FunctionAnalysisManager &FAM) {
+  auto &GCBI = FAM.getResult<GeneratedCodeBasicInfoAnalysis>(F);
+  return StackAccesses(F, GCBI);
+}
@@ -21,6 +21,51 @@ static RegisterPass<FunctionCallIdentification> X("fci",
 
 static Logger<> FilteredCFGLog("filtered-cfg");
 
+/// The integer types a return address can be stored with, i.e., the types of
+/// the program counter and of the ABI registers
+static SmallVector<IntegerType *, 4>
+returnAddressTypes(const GeneratedCodeBasicInfo &GCBI) {
+  SmallVector<IntegerType *, 4> Result;
+  auto Record = [&Result](Type *T) {
+    if (auto *IntegerT = dyn_cast<IntegerType>(T))
+      if (not llvm::is_contained(Result, IntegerT))
+        Result.push_back(IntegerT);
+  };
+
+  Record(GCBI.pcReg()->getValueType());
+  for (GlobalVariable *CSV : GCBI.abiRegisters())
+    Record(CSV->getValueType());
+
+  return Result;
+}
+
+/// \return true if \p F contains a store of \p ReturnPC as an immediate
+///
+/// Stores of immediates are found through the use lists of the constants
+/// themselves, which makes this a cheap filter to run before looking for the
+/// whole call pattern.
+static bool isStoredAsImmediate(Function &F,
+                                MetaAddress ReturnPC,
+                                ArrayRef<IntegerType *> Types) {
+  // On Thumb the return address might have the lowest bit set
+  uint64_t Candidates[] = { ReturnPC.address(), ReturnPC.asPC() };
+  for (IntegerType *T : Types) {
+    for (uint64_t Candidate : Candidates) {
+      if (not isUIntN(T->getBitWidth(), Candidate))
+        continue;
+
+      auto *Constant = ConstantInt::get(T, Candidate);
+      for (User *U : Constant->users())
+        if (auto *Store = dyn_cast<StoreInst>(U))
+          if (Store->getValueOperand() == Constant
+              and Store->getFunction() == &F)
+            return true;
+    }
+  }
+
+  return false;
+}
+
 bool FunctionCallIdentification::runOnModule(llvm::Module &M) {
   revng_log(PassesLog, "Starting FunctionCallIdentification");
 
@@ -52,6 +97,8 @@ bool FunctionCallIdentification::runOnModule(llvm::Module &M) {
     revng_assert(FunctionCall->user_begin() == FunctionCall->user_end());
   }
 
+  auto ReturnAddressTypes = returnAddressTypes(GCBI);
+
   // Collect function calls
   for (BasicBlock &BB : F) {
 
@@ -73,6 +120,13 @@ bool FunctionCallIdentification::runOnModule(llvm::Module &M) {
     if (not GCBI.isJump(Terminator))
       continue;
 
+    // Don't bother looking for the call pattern if the return address is
+    // never stored
+    MetaAddress ReturnPC = GCBI.getNextPC(Terminator);
+    if (not ReturnPC.isValid()
+        or not isStoredAsImmediate(F, ReturnPC, ReturnAddressTypes))
+      continue;
+
     // To be a function call we need to find:
     //
     // * a call to "newpc"
@@ -217,7 +271,6 @@ bool FunctionCallIdentification::runOnModule(llvm::Module &M) {
       }
     };
 
-    MetaAddress ReturnPC = GCBI.getNextPC(Terminator);
     Visitor V(&BB, GCBI, ReturnPC, PCPtrTy);
     V.run(Terminator);
 
@@ -288,7 +341,10 @@ bool FunctionCallIdentification::runOnModule(llvm::Module &M) {
     }
   }
 
-  buildFilteredCFG(F);
+  // The filtered CFG is only used for debugging purposes, don't walk root
+  // again at each run unless it has been requested
+  if (FilteredCFGLog.isEnabled())
+    buildFilteredCFG(F);
 
   revng_log(PassesLog, "Ending FunctionCallIdentification");
 
@@ -346,7 +402,5 @@ void FunctionCallIdentification::buildFilteredCFG(llvm::Function &F) {
   }
 
   FilteredCFG.buildBackLinks();
-
-  if (FilteredCFGLog.isEnabled())
-    FilteredCFG.dump(FilteredCFGLog);
+  FilteredCFG.dump(FilteredCFGLog);
 }
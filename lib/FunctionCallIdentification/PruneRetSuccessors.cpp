@@ -94,6 +94,15 @@ bool PruneRetSuccessors::runOnModule(llvm::Module &M) {
         or BB.getTerminator()->getNumSuccessors() < 2)
       continue;
 
+    // Most of the candidates have a direct successor which is not the
+    // fallthrough of a call: bail out before exploring the successors
+    auto IsNonFallthroughJT = [&FCI](BasicBlock *Successor) {
+      MetaAddress Address = getBasicBlockID(Successor).start();
+      return Address.isValid() and not FCI.isFallthrough(Address);
+    };
+    if (llvm::any_of(successors(&BB), IsNonFallthroughJT))
+      continue;
+
     auto Successors = getSuccessors(GCBI, &BB);
     if (not Successors.UnexpectedPC or Successors.Other)
       continue;
@@ -61,6 +61,11 @@ private:
   pipeline::LoadExecutionContextPass &LECP;
   GeneratedCodeBasicInfo &GCBI;
 
+  /// \note this is flushed before processing each function, so that the
+  ///       fields read to compute the registers used by a prototype are
+  ///       tracked as dependencies of each function using it.
+  abi::FunctionType::LayoutCache Layouts;
+
 public:
   EnforceABI(llvm::ModulePass &Pass,
              const model::Binary &Binary,
@@ -134,7 +139,7 @@ bool EnforceABI::prologue() {
 
     const auto *ProtoT = Binary.prototypeOrDefault(FunctionModel.prototype());
     revng_assert(ProtoT != nullptr);
-    auto UsedRegisters = abi::FunctionType::usedRegisters(*ProtoT);
+    const auto &UsedRegisters = Layouts.usedRegisters(*ProtoT);
     Function *NewFunction = recreateFunction(*OldFunction, UsedRegisters);
 
     // EnforceABI currently does not support execution
@@ -154,10 +159,12 @@ bool EnforceABI::runOnFunction(const model::Function &FunctionModel,
   revng_assert(not FunctionModel.name().empty());
   auto OldFunctionName = getLLVMFunctionName(FunctionModel);
 
+  Layouts.clear();
+
   // Recreate the function with the right prototype and the function prologue
   const auto *ProtoT = Binary.prototypeOrDefault(FunctionModel.prototype());
   revng_assert(ProtoT != nullptr);
-  auto UsedRegisters = abi::FunctionType::usedRegisters(*ProtoT);
+  const auto &UsedRegisters = Layouts.usedRegisters(*ProtoT);
   Function *NewFunction = getOrCreateNewFunction(OldFunction, UsedRegisters);
 
   // Collect function calls
@@ -317,6 +324,13 @@ void EnforceABI::createPrologue(Function *NewFunction,
 
   // Build the return value
   if (ReturnCSVs.size() != 0) {
+    // All the returns share the same initializer, look it up once
+    Function *Initializer = nullptr;
+    if (ReturnCSVs.size() > 1) {
+      auto *ReturnType = cast<StructType>(NewFunction->getReturnType());
+      Initializer = Initializers.get(ReturnType);
+    }
+
     for (BasicBlock &BB : *NewFunction) {
       if (auto *Return = dyn_cast<ReturnInst>(BB.getTerminator())) {
         IRBuilder<> Builder(Return);
@@ -327,7 +341,7 @@ void EnforceABI::createPrologue(Function *NewFunction,
         if (ReturnValues.size() == 1)
           Builder.CreateRet(ReturnValues[0]);
         else
-          Initializers.createReturn(Builder, ReturnValues);
+          StructInitializers::createReturn(Builder, Initializer, ReturnValues);
 
         eraseFromParent(Return);
       }
@@ -367,8 +381,7 @@ void EnforceABI::handleRegularFunctionCall(const MetaAddress &CallerAddress,
     const model::Function &ModelFunc = Binary.Functions().at(CalleeAddress);
     const auto *Prototype = Binary.prototypeOrDefault(ModelFunc.prototype());
     revng_assert(Prototype != nullptr);
-    auto UsedRegisters = abi::FunctionType::usedRegisters(*Prototype);
-    Callee = getOrCreateNewFunction(*Callee, UsedRegisters);
+    Callee = getOrCreateNewFunction(*Callee, Layouts.usedRegisters(*Prototype));
   }
 
   // Note that currently, in case of indirect call, we emit a call to a
@@ -432,7 +445,7 @@ CallInst *EnforceABI::generateCall(IRBuilder<> &Builder,
 
   auto *Prototype = getPrototype(Binary, Entry, CallSiteBlock.ID(), CallSite);
   revng_assert(Prototype != nullptr);
-  auto Registers = abi::FunctionType::usedRegisters(*Prototype);
+  const UsedRegisters &Registers = Layouts.usedRegisters(*Prototype);
 
   bool IsIndirect = (Callee.getCallee() == FunctionDispatcher);
   if (IsIndirect) {
@@ -511,7 +524,8 @@ struct EnforceABIPipe {
     Manager.add(new pipeline::LoadExecutionContextPass(&EC,
                                                        ModuleContainer.name()));
     Manager.add(new LoadModelWrapperPass(revng::getModelFromContext(EC)));
-    Manager.add(new ControlFlowGraphCachePass(CFGMap));
+    auto &SharedCFGs = getSharedControlFlowGraphCache(EC.getContext());
+    Manager.add(new ControlFlowGraphCachePass(CFGMap, &SharedCFGs));
     Manager.add(new pipeline::FunctionPass<EnforceABI>());
     Manager.run(ModuleContainer.getModule());
   }
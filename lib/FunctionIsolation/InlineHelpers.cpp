@@ -5,6 +5,7 @@
 //
 
 #include <iterator>
+#include <map>
 
 #include "llvm/ADT/SCCIterator.h"
 #include "llvm/ADT/STLExtras.h"
@@ -25,11 +26,30 @@ char InlineHelpersPass::ID = 0;
 using Register = RegisterPass<InlineHelpersPass>;
 static Register X("inline-helpers", "Inline Helpers Pass", true, true);
 
+static void dropDebugOrPseudoInst(Function *F) {
+  SmallVector<Instruction *, 16> ToErase;
+  for (BasicBlock &BB : *F) {
+    for (Instruction &I : BB) {
+      if (I.isDebugOrPseudoInst()) {
+        ToErase.push_back(&I);
+      }
+    }
+  }
+
+  for (Instruction *I : ToErase) {
+    I->eraseFromParent();
+  }
+}
+
 class InlineHelpers {
 private:
   LLVMContext &C;
   SmallDenseSet<Function *, 8> Recursive;
 
+  /// Copies of the helpers where all the calls to other helpers have already
+  /// been inlined, shared by all the functions
+  std::map<Function *, Function *> Flattened;
+
 public:
   InlineHelpers(Module &M) : C(M.getContext()) {
     using namespace llvm;
@@ -41,11 +61,19 @@ public:
             Recursive.insert(F);
   }
 
+  ~InlineHelpers() {
+    for (auto &[Helper, Copy] : Flattened) {
+      revng_assert(Copy->use_empty());
+      Copy->eraseFromParent();
+    }
+  }
+
   void run(Function *F);
 
 private:
-  void doInline(CallInst *Call) const;
-  bool doInline(Function *F) const;
+  void doInline(CallInst *Call);
+  void doInline(Function *F);
+  Function *getFlattened(Function *Helper);
   CallInst *getCallToInline(Instruction *I) const;
   bool shouldInline(Function *F) const;
 };
@@ -70,13 +98,37 @@ CallInst *InlineHelpers::getCallToInline(Instruction *I) const {
   return nullptr;
 }
 
-void InlineHelpers::doInline(CallInst *Call) const {
+/// \return a copy of \p Helper in which all the calls to other helpers have
+///         been inlined, ready to be inlined in one go
+Function *InlineHelpers::getFlattened(Function *Helper) {
+  auto It = Flattened.find(Helper);
+  if (It != Flattened.end())
+    return It->second;
+
+  ValueToValueMapTy VMap;
+  Function *Copy = CloneFunction(Helper, VMap);
+  Copy->setName(Helper->getName() + "_flattened");
+  Copy->setLinkage(GlobalValue::InternalLinkage);
+
+  // Helpers calling each other are not inlined, therefore this terminates
+  doInline(Copy);
+  dropDebugOrPseudoInst(Copy);
+
+  Flattened[Helper] = Copy;
+  return Copy;
+}
+
+void InlineHelpers::doInline(CallInst *Call) {
+  // Inline the flattened version of the helper, so that the inlined code does
+  // not need to be visited again
+  Call->setCalledFunction(getFlattened(getCalledFunction(Call)));
+
   InlineFunctionInfo IFI;
   auto Result = InlineFunction(*Call, IFI, false, nullptr, false);
   revng_assert(Result.isSuccess(), Result.getFailureReason());
 }
 
-bool InlineHelpers::doInline(Function *F) const {
+void InlineHelpers::doInline(Function *F) {
   SmallVector<CallInst *, 8> ToInline;
 
   for (BasicBlock &BB : *F)
@@ -86,28 +138,11 @@ bool InlineHelpers::doInline(Function *F) const {
 
   for (CallInst *Call : ToInline)
     doInline(Call);
-
-  return ToInline.size() > 0;
-}
-static void dropDebugOrPseudoInst(Function *F) {
-  SmallVector<Instruction *, 16> ToErase;
-  for (BasicBlock &BB : *F) {
-    for (Instruction &I : BB) {
-      if (I.isDebugOrPseudoInst()) {
-        ToErase.push_back(&I);
-      }
-    }
-  }
-
-  for (Instruction *I : ToErase) {
-    I->eraseFromParent();
-  }
 }
 
 void InlineHelpers::run(Function *F) {
-  // Fixed-point inlining
-  while (doInline(F))
-    ;
+  // Since flattened helpers are inlined, a single round is enough
+  doInline(F);
 
   dropDebugOrPseudoInst(F);
 }
@@ -118,10 +153,14 @@ bool InlineHelpersPass::runOnModule(llvm::Module &M) {
     if (FunctionTags::Isolated.isTagOf(&F))
       Isolated.push_back(&F);
 
+  // Note: inlining does not affect which helpers are recursive, so the
+  //       helpers (and their flattened versions) can be shared by all the
+  //       functions
+  InlineHelpers IH(M);
+
   llvm::Task T(Isolated.size(), "Inline helpers");
   for (Function *F : Isolated) {
     T.advance(F->getName());
-    InlineHelpers IH(*F->getParent());
     IH.run(F);
   }
 
@@ -170,6 +170,7 @@ public:
     // Add the personality to the root function
     RootFunction->setPersonalityFn(PersonalityFunction);
 
+    abi::FunctionType::LayoutCache Layouts;
     for (auto [_, T] : Map) {
       auto [ModelF, BB, F] = T;
 
@@ -185,7 +186,7 @@ public:
       SmallVector<Value *, 4> Arguments;
       if (F->getFunctionType()->getNumParams() > 0) {
         auto ThePrototype = Binary.prototypeOrDefault(ModelF->prototype());
-        auto Layout = abi::FunctionType::Layout::make(*ThePrototype);
+        const auto &Layout = Layouts.layout(*ThePrototype);
         for (const auto &ArgumentLayout : Layout.Arguments) {
           for (model::Register::Values Register : ArgumentLayout.Registers) {
             auto Name = model::Register::getCSVName(Register);
@@ -6,6 +6,8 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <optional>
+
 #include "llvm/ADT/DepthFirstIterator.h"
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/STLExtras.h"
@@ -97,7 +99,8 @@ struct IsolatePipe {
                                                        ModuleContainer.name()));
     Manager
       .add(new LoadModelWrapperPass(ModelWrapper(getModelFromContext(EC))));
-    Manager.add(new ControlFlowGraphCachePass(CFGMap));
+    auto &SharedCFGs = getSharedControlFlowGraphCache(EC.getContext());
+    Manager.add(new ControlFlowGraphCachePass(CFGMap, &SharedCFGs));
     Manager.add(new IsolateFunctions());
     Manager.run(ModuleContainer.getModule());
   }
@@ -481,22 +484,36 @@ inline auto toVector(R &&Range) {
 
 using FSOracle = efa::FunctionSummaryOracle;
 
+/// Outlines functions from root, one at a time
+///
+/// The efa::Outliner, which analyzes the whole root upon construction, is
+/// created once and reused for all the functions. The oracle, instead, is
+/// imported for each function, so that the fields of the model it reads are
+/// tracked as dependencies of the function being isolated.
 class FunctionOutliner {
 private:
-  efa::FunctionSummaryOracle Oracle;
-  efa::Outliner Outliner;
+  llvm::Module &M;
+  const model::Binary &Binary;
+  GeneratedCodeBasicInfo &GCBI;
+  std::optional<efa::Outliner> Outliner;
 
 public:
   FunctionOutliner(llvm::Module &M,
                    const model::Binary &Binary,
                    GeneratedCodeBasicInfo &GCBI) :
-    Oracle(FSOracle::importWithoutPrototypes(M, GCBI, Binary)),
-    Outliner(M, GCBI, Oracle) {}
+    M(M), Binary(Binary), GCBI(GCBI) {}
 
 public:
   efa::OutlinedFunction outline(MetaAddress Entry,
                                 efa::CallHandler *TheCallHandler) {
-    return Outliner.outline(Entry, TheCallHandler);
+    auto Oracle = FSOracle::importWithoutPrototypes(M, GCBI, Binary);
+
+    if (Outliner.has_value())
+      Outliner->setOracle(Oracle);
+    else
+      Outliner.emplace(M, GCBI, Oracle);
+
+    return Outliner->outline(Entry, TheCallHandler);
   }
 };
 
@@ -568,6 +585,8 @@ void IsolateFunctionsImpl::run() {
   pipeline::ExecutionContext &Context = *LECP.get();
   const pipeline::TargetsList &RequestedTargets = LECP.getRequestedTargets();
 
+  FunctionOutliner Outliner(*TheModule, Binary, GCBI);
+
   Task IsolateTask(RequestedTargets.size(), "Isolating functions");
   for (const pipeline::Target &Target : RequestedTargets) {
     IsolateTask.advance(Target.toString(), true);
@@ -587,7 +606,6 @@ void IsolateFunctionsImpl::run() {
 
     // Outline the function (later on we'll steal its body and move it into F)
     CallIsolatedFunction CallHandler(*this, FM);
-    FunctionOutliner Outliner(*TheModule, Binary, GCBI);
     OutlinedFunction Outlined = Outliner.outline(Entry, &CallHandler);
 
     handleUnexpectedPCCloned(Outlined);
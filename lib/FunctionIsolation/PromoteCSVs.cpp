@@ -4,6 +4,10 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <optional>
+#include <tuple>
+
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallVector.h"
@@ -51,19 +55,52 @@ public:
   /// GlobalVariables representing written CPU State Variables sorted by name.
   std::vector<GlobalVariable *> Written;
 
-private:
-  auto tie() const { return std::tie(Helper, Read, Written); }
-
 public:
-  bool operator<(const WrapperKey &Other) const { return tie() < Other.tie(); }
+  auto tie() const {
+    return std::make_tuple(Helper, ArrayRef(Read), ArrayRef(Written));
+  }
+};
+
+/// Compares WrapperKeys with tuples of the same shape, so that Wrappers can be
+/// queried without copying the CSV lists
+struct CompareWrapperKeys {
+  using is_transparent = std::true_type;
+  using Tuple = std::tuple<Function *,
+                           ArrayRef<GlobalVariable *>,
+                           ArrayRef<GlobalVariable *>>;
+
+  static Tuple tie(const WrapperKey &Key) { return Key.tie(); }
+  static const Tuple &tie(const Tuple &Key) { return Key; }
+
+  static bool lessThan(ArrayRef<GlobalVariable *> LHS,
+                       ArrayRef<GlobalVariable *> RHS) {
+    return std::lexicographical_compare(LHS.begin(),
+                                        LHS.end(),
+                                        RHS.begin(),
+                                        RHS.end());
+  }
+
+  template<typename L, typename R>
+  bool operator()(const L &LHS, const R &RHS) const {
+    const auto &[LHelper, LRead, LWritten] = tie(LHS);
+    const auto &[RHelper, RRead, RWritten] = tie(RHS);
+    if (LHelper != RHelper)
+      return std::less<Function *>()(LHelper, RHelper);
+    if (LRead != RRead)
+      return lessThan(LRead, RRead);
+    return lessThan(LWritten, RWritten);
+  }
 };
 
 class PromoteCSVs final : public pipeline::FunctionPassImpl {
 private:
   StructInitializers Initializers;
   OpaqueFunctionsPool<StringRef> CSVInitializers;
-  std::map<WrapperKey, Function *> Wrappers;
+  std::map<WrapperKey, Function *, CompareWrapperKeys> Wrappers;
   SetVector<GlobalVariable *> CSVs;
+  /// The initializer of each CSV associated to a register, populated on first
+  /// use and then shared by all the functions
+  std::optional<std::map<GlobalVariable *, Function *>> InitializerForCSV;
   model::Architecture::Values Architecture;
 
 public:
@@ -88,6 +125,8 @@ private:
 
   void promoteCSVs(Function *F);
 
+  const std::map<GlobalVariable *, Function *> &getInitializers(Module &M);
+
   Function *createWrapper(const WrapperKey &Key);
 
   CSVsUsageMap getUsedCSVs(ArrayRef<CallInst *> CallsRange);
@@ -227,12 +266,18 @@ void PromoteCSVs::wrap(CallInst *Call,
   Function *Helper = getCallee(Call);
   revng_assert(Helper != nullptr);
 
-  WrapperKey Key{ Helper, Read, Written };
-
-  // Fetch or create the wrapper
-  Function *&HelperWrapper = Wrappers[Key];
-  if (HelperWrapper == nullptr)
+  // Fetch or create the wrapper, copying the CSV lists only in the latter case
+  Function *HelperWrapper = nullptr;
+  auto WrapperIt = Wrappers.find(CompareWrapperKeys::Tuple{ Helper,
+                                                            Read,
+                                                            Written });
+  if (WrapperIt != Wrappers.end()) {
+    HelperWrapper = WrapperIt->second;
+  } else {
+    WrapperKey Key{ Helper, Read, Written };
     HelperWrapper = createWrapper(Key);
+    Wrappers.emplace(std::move(Key), HelperWrapper);
+  }
 
   auto *PointeeTy = Helper->getValueType();
   auto *HelperType = cast<FunctionType>(PointeeTy);
@@ -281,15 +326,15 @@ static Instruction *findFirstNonAlloca(BasicBlock *BB) {
   return nullptr;
 }
 
-void PromoteCSVs::promoteCSVs(Function *F) {
-  // Create an alloca for each CSV and replace all uses of CSVs with the
-  // corresponding allocas
-  BasicBlock &Entry = F->getEntryBlock();
-  QuickMetadata QMD(F->getParent()->getContext());
+const std::map<GlobalVariable *, Function *> &
+PromoteCSVs::getInitializers(Module &M) {
+  if (InitializerForCSV)
+    return *InitializerForCSV;
+
+  QuickMetadata QMD(M.getContext());
 
   // Get/create initializers
-  std::map<Function *, GlobalVariable *> CSVForInitializer;
-  std::map<GlobalVariable *, Function *> InitializerForCSV;
+  InitializerForCSV.emplace();
   for (GlobalVariable *CSV : CSVs) {
     // Initialize all allocas with opaque, CSV-specific values
     Type *CSVType = CSV->getValueType();
@@ -307,11 +352,19 @@ void PromoteCSVs::promoteCSVs(Function *F) {
                                  QMD.tuple(getName(Register)));
       }
 
-      CSVForInitializer[Initializer] = CSV;
-      InitializerForCSV[CSV] = Initializer;
+      (*InitializerForCSV)[CSV] = Initializer;
     }
   }
 
+  return *InitializerForCSV;
+}
+
+void PromoteCSVs::promoteCSVs(Function *F) {
+  // Create an alloca for each CSV and replace all uses of CSVs with the
+  // corresponding allocas
+  BasicBlock &Entry = F->getEntryBlock();
+  const auto &Initializers = getInitializers(*F->getParent());
+
   // Collect existing CSV allocas
 
   Instruction *NonAlloca = findFirstNonAlloca(&Entry);
@@ -322,37 +375,30 @@ void PromoteCSVs::promoteCSVs(Function *F) {
   IRBuilder<> AllocaBuilder(&Entry, Entry.begin());
 
   // For each GlobalVariable representing a CSV used in F, create a dedicated
-  // alloca and save it in CSVMaps.
-  std::map<GlobalVariable *, AllocaInst *> CSVAllocas;
+  // alloca
+  DenseMap<Value *, Value *> CSVAllocas;
   for (GlobalVariable *CSV : CSVs) {
-    AllocaInst *Alloca = nullptr;
+    // Create the alloca
+    Type *CSVType = CSV->getValueType();
+    auto *Alloca = AllocaBuilder.CreateAlloca(CSVType, nullptr, CSV->getName());
 
-    auto It = CSVAllocas.find(CSV);
-    if (It != CSVAllocas.end()) {
-      Alloca = It->second;
-    } else {
-      // Create the alloca
-      Type *CSVType = CSV->getValueType();
-      Alloca = AllocaBuilder.CreateAlloca(CSVType, nullptr, CSV->getName());
-
-      // Check if already have an initializer
-      Value *Initializer = nullptr;
-      auto It = InitializerForCSV.find(CSV);
-      if (It != InitializerForCSV.end()) {
-        Function *InitializerFunction = InitializerForCSV.at(CSV);
-        Initializer = InitializersBuilder.CreateCall(InitializerFunction);
-      } else {
-        Initializer = CSV->getInitializer();
-      }
+    // Check if already have an initializer
+    Value *Initializer = nullptr;
+    auto It = Initializers.find(CSV);
+    if (It != Initializers.end())
+      Initializer = InitializersBuilder.CreateCall(It->second);
+    else
+      Initializer = CSV->getInitializer();
 
-      // Initialize the alloca
-      InitializersBuilder.CreateStore(Initializer, Alloca);
-    }
+    // Initialize the alloca
+    InitializersBuilder.CreateStore(Initializer, Alloca);
 
-    // Replace users
-    replaceAllUsesInFunctionWith(F, CSV, Alloca);
+    CSVAllocas[CSV] = Alloca;
   }
 
+  // Replace users, visiting F once
+  replaceAllUsesInFunctionWith(F, CSVAllocas);
+
   // Drop separators
   eraseFromParent(Separator);
 
@@ -23,22 +23,25 @@ StructInitializers::StructInitializers(llvm::Module *M) :
   Pool.initializeFromReturnType(FunctionTags::StructInitializer);
 }
 
-Instruction *StructInitializers::createReturn(IRBuilder<> &Builder,
-                                              ArrayRef<Value *> Values) {
-  // Obtain return StructType
-  auto *FT = Builder.GetInsertBlock()->getParent()->getFunctionType();
-  auto *ReturnType = cast<StructType>(FT->getReturnType());
+void StructInitializers::pregenerate(ArrayRef<StructType *> Types) {
+  for (StructType *Type : Types)
+    get(Type);
+}
 
-  SmallVector<Type *, 8> Types;
-  llvm::copy(ReturnType->elements(), std::back_inserter(Types));
+Function *StructInitializers::get(StructType *Type) {
+  // Fast path: initializers are created along with their body, or recorded
+  // from the module, hence a function in the pool is ready to be used
+  if (Function *Initializer = Pool.find(Type))
+    if (not Initializer->isDeclaration())
+      return Initializer;
 
   // Create struct_initializer
-  Function *Initializer = Pool.get(ReturnType,
-                                   ReturnType,
-                                   Types,
+  Function *Initializer = Pool.get(Type,
+                                   Type,
+                                   Type->elements(),
                                    StructInitializerPrefix);
 
-  // Lazily populate its body
+  // Populate its body
   if (Initializer->isDeclaration()) {
     auto *Entry = BasicBlock::Create(Context, "", Initializer);
     IRBuilder<> InitializerBuilder(Entry);
@@ -50,6 +53,21 @@ Instruction *StructInitializers::createReturn(IRBuilder<> &Builder,
     InitializerBuilder.CreateAggregateRet(Arguments.data(), Arguments.size());
   }
 
+  return Initializer;
+}
+
+Instruction *StructInitializers::createReturn(IRBuilder<> &Builder,
+                                              ArrayRef<Value *> Values) {
+  // Obtain return StructType
+  auto *FT = Builder.GetInsertBlock()->getParent()->getFunctionType();
+  auto *ReturnType = cast<StructType>(FT->getReturnType());
+
+  return createReturn(Builder, get(ReturnType), Values);
+}
+
+Instruction *StructInitializers::createReturn(IRBuilder<> &Builder,
+                                              Function *Initializer,
+                                              ArrayRef<Value *> Values) {
   // Emit a call in the caller
   return Builder.CreateRet(Builder.CreateCall(Initializer, Values));
 }
@@ -4,13 +4,151 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <unordered_map>
+
+#include "llvm/Support/Parallel.h"
+#include "llvm/Support/raw_ostream.h"
+
 #include "revng/GraphLayout/SugiyamaStyle/Compute.h"
+#include "revng/Support/Deadline.h"
 
 #include "InternalCompute.h"
 
 namespace sugiyama = yield::layout::sugiyama;
-bool sugiyama::detail::computeImpl(InternalGraph &Graph,
-                                   const Configuration &Configuration) {
+
+namespace {
+
+/// The positions of the real nodes and the paths of the real edges of a laid
+/// out graph, indexed by their `index()`
+struct CachedLayout {
+  std::vector<yield::layout::Point> Centers;
+  std::vector<yield::layout::Path> Paths;
+};
+
+/// Process-wide cache of the computed layouts, keyed by the shape of the graph
+///
+/// The layout only depends on the sizes of the nodes, on the edges between
+/// them and on the configuration: graphs that are rebuilt after a change that
+/// does not affect any of those (e.g., in a comment) do not need to be laid
+/// out again.
+class LayoutCache {
+private:
+  /// Stop caching new layouts after this many, to bound memory usage
+  static constexpr size_t MaxEntries = 1 << 12;
+
+private:
+  std::mutex Mutex;
+  std::unordered_map<std::string, CachedLayout> Entries;
+
+public:
+  std::optional<CachedLayout> get(const std::string &Key) {
+    std::lock_guard Lock(Mutex);
+    auto It = Entries.find(Key);
+    if (It == Entries.end())
+      return std::nullopt;
+    return It->second;
+  }
+
+  void insert(std::string &&Key, CachedLayout &&Layout) {
+    std::lock_guard Lock(Mutex);
+    if (Entries.size() < MaxEntries)
+      Entries.try_emplace(std::move(Key), std::move(Layout));
+  }
+};
+
+} // namespace
+
+static LayoutCache Layouts;
+
+template<typename T>
+static void writeRaw(llvm::raw_ostream &Stream, const T &Value) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  Stream.write(reinterpret_cast<const char *>(&Value), sizeof(T));
+}
+
+/// Encode everything the layout of \p Graph depends on.
+///
+/// \note: this has to be called before the layouter starts modifying the graph
+///        and it has to be kept in sync with the fields of `Configuration`.
+static std::string shapeOf(InternalGraph &Graph,
+                           const sugiyama::Configuration &Configuration) {
+  std::string Result;
+  llvm::raw_string_ostream Stream(Result);
+
+  writeRaw(Stream, Configuration.Ranking);
+  writeRaw(Stream, Configuration.Orientation);
+  writeRaw(Stream, Configuration.UseOrthogonalBends);
+  writeRaw(Stream, Configuration.PreserveLinearSegments);
+  writeRaw(Stream, Configuration.UseSimpleTreeOptimization);
+  writeRaw(Stream, Configuration.VirtualNodeWeight);
+  writeRaw(Stream, Configuration.NodeMarginSize);
+  writeRaw(Stream, Configuration.EdgeMarginSize);
+  writeRaw(Stream, Configuration.ScalableCrossingMinimizationThreshold);
+  writeRaw(Stream, Configuration.UseLinearTimeHorizontalPlacement);
+
+  writeRaw(Stream, Graph.size());
+  for (auto *Node : Graph.nodes()) {
+    revng_assert(!Node->IsVirtual);
+    writeRaw(Stream, Node->index());
+    writeRaw(Stream, Node->Size.W);
+    writeRaw(Stream, Node->Size.H);
+  }
+
+  for (auto *From : Graph.nodes()) {
+    for (auto [To, Label] : From->successor_edges()) {
+      writeRaw(Stream, Label->index());
+      writeRaw(Stream, From->index());
+      writeRaw(Stream, To->index());
+    }
+  }
+
+  Stream.flush();
+  return Result;
+}
+
+static CachedLayout extractLayout(InternalGraph &Graph) {
+  CachedLayout Result;
+  for (auto *Node : Graph.nodes()) {
+    if (!Node->IsVirtual) {
+      if (Node->index() >= Result.Centers.size())
+        Result.Centers.resize(Node->index() + 1);
+      Result.Centers[Node->index()] = Node->Center;
+    }
+
+    // Real edges can end up attached to virtual nodes
+    for (auto [_, Label] : Node->successor_edges()) {
+      if (Label->isVirtual())
+        continue;
+
+      if (Label->index() >= Result.Paths.size())
+        Result.Paths.resize(Label->index() + 1);
+      Result.Paths[Label->index()] = Label->getPath();
+    }
+  }
+
+  return Result;
+}
+
+static void applyLayout(InternalGraph &Graph, const CachedLayout &Layout) {
+  for (auto *Node : Graph.nodes()) {
+    if (Node->index() < Layout.Centers.size())
+      Node->Center = Layout.Centers[Node->index()];
+
+    for (auto [_, Label] : Node->successor_edges()) {
+      if (Label->index() < Layout.Paths.size())
+        Label->getPath() = Layout.Paths[Label->index()];
+      Label->IsRouted = true;
+    }
+  }
+}
+
+static bool computeUncached(InternalGraph &Graph,
+                            const sugiyama::Configuration &Configuration) {
   using RS = sugiyama::RankingStrategy;
 
   if (Configuration.Orientation == sugiyama::Orientation::LeftToRight
@@ -33,6 +171,9 @@ bool sugiyama::detail::computeImpl(InternalGraph &Graph,
   case RS::DisjointDepthFirstSearch:
     Res = computeInternal<RS::DisjointDepthFirstSearch>(Graph, Configuration);
     break;
+  case RS::NetworkSimplex:
+    Res = computeInternal<RS::NetworkSimplex>(Graph, Configuration);
+    break;
   default:
     revng_abort("Unknown ranking strategy");
   }
@@ -75,3 +216,176 @@ bool sugiyama::detail::computeImpl(InternalGraph &Graph,
 
   return Res;
 }
+
+/// Graphs with fewer nodes than this are laid out as a whole, even if they
+/// are made of multiple disconnected components
+static constexpr size_t MinimumComponentSplitSize = 64;
+
+namespace {
+
+/// A weakly connected component of a graph, laid out on its own
+struct Component {
+  InternalGraph Graph;
+
+  /// The nodes and the edges of the original graph, indexed by the `index()`
+  /// of the corresponding ones in `Graph`
+  std::vector<InternalNode *> Nodes;
+  std::vector<InternalNode::Edge *> Edges;
+};
+
+} // namespace
+
+static std::vector<Component> splitComponents(InternalGraph &Graph) {
+  size_t IndexCount = 0;
+  for (auto *Node : Graph.nodes())
+    IndexCount = std::max(IndexCount, Node->index() + 1);
+
+  // Union-find on the node indices
+  std::vector<size_t> Leader(IndexCount);
+  std::iota(Leader.begin(), Leader.end(), 0);
+  auto Find = [&Leader](size_t Index) {
+    while (Leader[Index] != Index)
+      Index = Leader[Index] = Leader[Leader[Index]];
+    return Index;
+  };
+
+  for (auto *From : Graph.nodes())
+    for (auto [To, _] : From->successor_edges())
+      Leader[Find(From->index())] = Find(To->index());
+
+  // Number the components following the order of the nodes, so that the
+  // result does not depend on the union-find
+  constexpr size_t None = std::numeric_limits<size_t>::max();
+  std::vector<size_t> ComponentOf(IndexCount, None);
+  std::vector<InternalNode *> Lookup(IndexCount, nullptr);
+  std::vector<Component> Result;
+  for (auto *Node : Graph.nodes()) {
+    size_t &Index = ComponentOf[Find(Node->index())];
+    if (Index == None) {
+      Index = Result.size();
+      Result.emplace_back();
+    }
+
+    Component &Current = Result[Index];
+    Lookup[Node->index()] = Current.Graph.makeNode(Node->Size);
+    Current.Nodes.push_back(Node);
+  }
+
+  for (auto *From : Graph.nodes()) {
+    Component &Current = Result[ComponentOf[Find(From->index())]];
+    for (auto [To, Label] : From->successor_edges()) {
+      Current.Graph.makeEdge(Lookup[From->index()], Lookup[To->index()]);
+      Current.Edges.push_back(Label);
+    }
+  }
+
+  return Result;
+}
+
+/// Lay out each of the \p Components in parallel, then place them side by
+/// side, perpendicularly to the direction of the layers.
+static bool computeComponents(std::vector<Component> &Components,
+                              const sugiyama::Configuration &Configuration) {
+  std::vector<char> Succeeded(Components.size(), false);
+  llvm::parallelForEachN(0, Components.size(), [&](size_t Index) {
+    auto &Current = Components[Index].Graph;
+    Succeeded[Index] = sugiyama::detail::computeImpl(Current, Configuration);
+  });
+
+  if (llvm::is_contained(Succeeded, false))
+    return false;
+
+  using Orientation = sugiyama::Orientation;
+  bool Horizontal = Configuration.Orientation == Orientation::TopToBottom
+                    or Configuration.Orientation == Orientation::BottomToTop;
+  // Align the first layer of all the components: depending on the orientation
+  // it's the one with the smallest or the biggest coordinate
+  bool AlignMaximum = Configuration.Orientation == Orientation::TopToBottom
+                      or Configuration.Orientation == Orientation::RightToLeft;
+
+  // Along returns the coordinate on which the components are placed next to
+  // each other, Across the other one
+  auto Along = [Horizontal](yield::layout::Point &Point) -> auto & {
+    return Horizontal ? Point.X : Point.Y;
+  };
+  auto Across = [Horizontal](yield::layout::Point &Point) -> auto & {
+    return Horizontal ? Point.Y : Point.X;
+  };
+
+  yield::layout::Coordinate Cursor = 0;
+  for (Component &Current : Components) {
+    CachedLayout Layout = extractLayout(Current.Graph);
+
+    using Limits = std::numeric_limits<yield::layout::Coordinate>;
+    yield::layout::Point Minimum(Limits::max(), Limits::max());
+    yield::layout::Point Maximum(Limits::lowest(), Limits::lowest());
+    auto Extend = [&](const yield::layout::Point &Point,
+                      const yield::layout::Size &Size) {
+      Minimum.X = std::min(Minimum.X, Point.X - Size.W / 2);
+      Minimum.Y = std::min(Minimum.Y, Point.Y - Size.H / 2);
+      Maximum.X = std::max(Maximum.X, Point.X + Size.W / 2);
+      Maximum.Y = std::max(Maximum.Y, Point.Y + Size.H / 2);
+    };
+
+    for (size_t I = 0; I < Layout.Centers.size(); ++I)
+      Extend(Layout.Centers[I], Current.Nodes[I]->Size);
+    for (const yield::layout::Path &Path : Layout.Paths)
+      for (const yield::layout::Point &Point : Path)
+        Extend(Point, {});
+
+    yield::layout::Point Offset;
+    Along(Offset) = Cursor - Along(Minimum);
+    Across(Offset) = AlignMaximum ? -Across(Maximum) : -Across(Minimum);
+    Cursor += Along(Maximum) - Along(Minimum) + Configuration.NodeMarginSize;
+
+    auto Move = [&Offset](yield::layout::Point &Point) {
+      Point.X += Offset.X;
+      Point.Y += Offset.Y;
+    };
+
+    for (size_t I = 0; I < Layout.Centers.size(); ++I) {
+      Current.Nodes[I]->Center = Layout.Centers[I];
+      Move(Current.Nodes[I]->Center);
+    }
+
+    for (size_t I = 0; I < Current.Edges.size(); ++I) {
+      auto &Path = Current.Edges[I]->getPath();
+      if (I < Layout.Paths.size())
+        Path = std::move(Layout.Paths[I]);
+      for (yield::layout::Point &Point : Path)
+        Move(Point);
+      Current.Edges[I]->IsRouted = true;
+    }
+  }
+
+  return true;
+}
+
+bool sugiyama::detail::computeImpl(InternalGraph &Graph,
+                                   const Configuration &Configuration) {
+  std::string Key = shapeOf(Graph, Configuration);
+  if (std::optional<CachedLayout> Cached = Layouts.get(Key)) {
+    applyLayout(Graph, *Cached);
+    return true;
+  }
+
+  // Disconnected components do not affect each other: lay them out in
+  // parallel
+  std::vector<Component> Components;
+  if (Graph.size() >= MinimumComponentSplitSize)
+    Components = splitComponents(Graph);
+
+  if (Components.size() > 1) {
+    if (!computeComponents(Components, Configuration))
+      return false;
+  } else if (!computeUncached(Graph, Configuration)) {
+    return false;
+  }
+
+  // The layout might have been cut short by the deadline
+  if (revng::deadlinePassed())
+    return true;
+
+  Layouts.insert(std::move(Key), extractLayout(Graph));
+  return true;
+}
@@ -5,6 +5,7 @@
 //
 
 #include <set>
+#include <unordered_set>
 #include <vector>
 
 #include "revng/Support/GraphAlgorithms.h"
@@ -119,6 +120,24 @@ static std::vector<EdgeView> pickLongEdges(InternalGraph &Graph,
   return Result;
 }
 
+// Same as `pickLongEdges`, except the edges leaving an artificial entry node
+// are skipped: they are removed together with the node once the ranking is
+// final, so partitioning them would only waste time (and memory, as there can
+// be an edge per real entry point, each one spanning a lot of layers).
+static std::vector<EdgeView> pickLongNonEntryEdges(InternalGraph &Graph,
+                                                   const RankContainer &Ranks) {
+  auto Result = pickLongEdges(Graph, Ranks);
+
+  if (InternalNode *Entry = Graph.getEntryNode(); Entry->IsVirtual) {
+    auto IsFromEntry = [Entry](const EdgeView &Edge) {
+      return Edge.From->index() == Entry->index();
+    };
+    llvm::erase_if(Result, IsFromEntry);
+  }
+
+  return Result;
+}
+
 template<typename EdgeType, RankingStrategy Strategy>
 void partition(std::vector<EdgeType> &Edges,
                InternalGraph &Graph,
@@ -213,7 +232,7 @@ RankContainer partitionLongEdges(InternalGraph &Graph,
   Ranks = rankNodes<Strategy>(Graph);
 
   // Pick new long edges based on the real ranks.
-  auto NewLongEdges = pickLongEdges(Graph, Ranks);
+  auto NewLongEdges = pickLongNonEntryEdges(Graph, Ranks);
 
   // Add partitions based on removed earlier edges.
   partition(SavedLongEdges, Graph, Ranks, Classifier);
@@ -231,7 +250,7 @@ RankContainer partitionLongEdges(InternalGraph &Graph,
   updateRanks(Graph, Ranks);
 
   // Make sure that new long edges are properly broken up.
-  NewLongEdges = pickLongEdges(Graph, Ranks);
+  NewLongEdges = pickLongNonEntryEdges(Graph, Ranks);
   partition(NewLongEdges, Graph, Ranks, Classifier);
   for (auto &Edge : NewLongEdges)
     Edge.From->removeSuccessors(Edge.To);
@@ -243,20 +262,21 @@ RankContainer partitionLongEdges(InternalGraph &Graph,
   revng_assert(HasSingleEntryPoint(Graph));
   if (Graph.getEntryNode() != nullptr) {
     if (InternalNode *Entry = Graph.getEntryNode(); Entry->IsVirtual) {
-      std::vector<NodeView> ToRemove;
+      std::unordered_set<InternalNode *> ToRemove;
       llvm::df_iterator_default_set<InternalNode *> Visited;
       for (InternalNode *Current : llvm::depth_first_ext(Entry, Visited)) {
-        ToRemove.emplace_back(Current);
+        ToRemove.insert(Current);
 
         for (InternalNode *Successor : Current->successors())
           if (!Successor->IsVirtual)
             Visited.insert(Successor);
       }
 
-      for (NodeView Node : ToRemove) {
+      for (InternalNode *Node : ToRemove)
         Ranks.erase(Node);
-        Graph.removeNode(Node);
-      }
+      Graph.removeNodesIf([&ToRemove](InternalNode *Node) {
+        return ToRemove.contains(Node);
+      });
     }
   }
 
@@ -437,3 +457,6 @@ prepareGraph<RankingStrategy::Topological>(InternalGraph &, bool);
 
 template ResultTuple<RankingStrategy::DisjointDepthFirstSearch>
 prepareGraph<RankingStrategy::DisjointDepthFirstSearch>(InternalGraph &, bool);
+
+template ResultTuple<RankingStrategy::NetworkSimplex>
+prepareGraph<RankingStrategy::NetworkSimplex>(InternalGraph &, bool);
@@ -4,7 +4,14 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <array>
+#include <limits>
 #include <map>
+#include <numeric>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallVector.h"
 
 #include "InternalCompute.h"
 
@@ -194,6 +201,266 @@ void setHorizontalCoordinates(const LayerContainer &Layers,
   }
 }
 
+/// The nodes are first aligned into vertical blocks with their median
+/// neighbors, in each of the four combinations of vertical (top-down and
+/// bottom-up) and horizontal (left-to-right and right-to-left) directions.
+/// The blocks are then compacted as close to each other as their widths allow,
+/// and the four candidate positions of each node are balanced.
+///
+/// The edges between virtual nodes and those within a linear segment are
+/// preferred when aligning, so that long edges and linear segments are kept
+/// straight whenever possible.
+void setLinearTimeHorizontalCoordinates(const LayerContainer &Layers,
+                                        const SegmentContainer &LinearSegments,
+                                        const LayoutContainer &Layout,
+                                        float MarginSize) {
+  // Number the nodes densely, in layer order.
+  std::vector<NodeView> Nodes;
+  std::unordered_map<NodeView, size_t> Numbers;
+  for (const auto &Layer : Layers) {
+    for (auto Node : Layer) {
+      Numbers.emplace(Node, Nodes.size());
+      Nodes.emplace_back(Node);
+    }
+  }
+
+  // Collect the neighbors in the adjacent layers, sorted by their position.
+  std::vector<size_t> Position(Nodes.size());
+  std::vector<size_t> Segment(Nodes.size());
+  std::vector<llvm::SmallVector<size_t, 2>> Above(Nodes.size());
+  std::vector<llvm::SmallVector<size_t, 2>> Below(Nodes.size());
+  for (size_t Index = 0; Index < Nodes.size(); ++Index) {
+    NodeView Node = Nodes[Index];
+    const LogicalPosition &Current = Layout.at(Node);
+    Position[Index] = Current.Index;
+    Segment[Index] = Numbers.at(LinearSegments.at(Node));
+
+    auto Add = [&](NodeView Neighbor) {
+      auto Layer = Layout.at(Neighbor).Layer;
+      if (Layer + 1 == Current.Layer)
+        Above[Index].push_back(Numbers.at(Neighbor));
+      else if (Layer == Current.Layer + 1)
+        Below[Index].push_back(Numbers.at(Neighbor));
+    };
+    for (auto *Predecessor : Node->predecessors())
+      Add(Predecessor);
+    for (auto *Successor : Node->successors())
+      Add(Successor);
+  }
+
+  auto ByPosition = [&Position](size_t LHS, size_t RHS) {
+    return Position[LHS] < Position[RHS];
+  };
+  for (auto *Neighbors : { &Above, &Below }) {
+    for (auto &List : *Neighbors) {
+      llvm::sort(List, ByPosition);
+      List.erase(std::unique(List.begin(), List.end()), List.end());
+    }
+  }
+
+  auto IsInner = [&](size_t LHS, size_t RHS) {
+    if (Nodes[LHS]->IsVirtual && Nodes[RHS]->IsVirtual)
+      return true;
+    return Segment[LHS] == Segment[RHS];
+  };
+
+  // Mark the edges crossing an inner edge, so that they never prevent inner
+  // edges from being aligned.
+  using NodePair = std::pair<size_t, size_t>;
+  auto pairOf = [](size_t LHS, size_t RHS) -> NodePair {
+    return { std::min(LHS, RHS), std::max(LHS, RHS) };
+  };
+  llvm::DenseSet<NodePair> Conflicts;
+  for (size_t LayerIndex = 1; LayerIndex < Layers.size(); ++LayerIndex) {
+    const auto &Layer = Layers[LayerIndex];
+    size_t PreviousSize = Layers[LayerIndex - 1].size();
+    size_t LeftBound = 0;
+    size_t Scanned = 0;
+    for (size_t I = 0; I < Layer.size(); ++I) {
+      size_t Current = Numbers.at(Layer[I]);
+      auto IsInnerNeighbor = [&](size_t Other) {
+        return IsInner(Other, Current);
+      };
+      auto Inner = llvm::find_if(Above[Current], IsInnerNeighbor);
+      bool HasInner = Inner != Above[Current].end();
+      if (!HasInner && I + 1 != Layer.size())
+        continue;
+
+      size_t RightBound = HasInner ? Position[*Inner] : PreviousSize;
+      for (; Scanned <= I; ++Scanned) {
+        size_t Scanning = Numbers.at(Layer[Scanned]);
+        for (size_t Neighbor : Above[Scanning]) {
+          bool IsOutside = Position[Neighbor] < LeftBound
+                           || Position[Neighbor] > RightBound;
+          if (IsOutside && !IsInner(Neighbor, Scanning))
+            Conflicts.insert(pairOf(Neighbor, Scanning));
+        }
+      }
+      LeftBound = RightBound;
+    }
+  }
+
+  std::vector<float> Width(Nodes.size());
+  for (size_t Index = 0; Index < Nodes.size(); ++Index)
+    Width[Index] = Nodes[Index]->Size.W;
+
+  constexpr float Infinity = std::numeric_limits<float>::infinity();
+  std::array<std::vector<float>, 4> Candidates;
+  for (size_t Direction = 0; Direction < Candidates.size(); ++Direction) {
+    bool IsBottomUp = Direction & 1;
+    bool IsRightToLeft = Direction & 2;
+
+    // Lay the layers out in the order they are visited in for this direction.
+    std::vector<std::vector<size_t>> Order;
+    for (const auto &Layer : Layers) {
+      auto &Current = Order.emplace_back();
+      for (auto Node : Layer)
+        Current.push_back(Numbers.at(Node));
+      if (IsRightToLeft)
+        std::reverse(Current.begin(), Current.end());
+    }
+    if (IsBottomUp)
+      std::reverse(Order.begin(), Order.end());
+
+    std::vector<size_t> Local(Nodes.size());
+    for (const auto &Layer : Order)
+      for (size_t I = 0; I < Layer.size(); ++I)
+        Local[Layer[I]] = I;
+
+    // Align each node with one of its median neighbors.
+    std::vector<size_t> Root(Nodes.size());
+    std::vector<size_t> Align(Nodes.size());
+    std::iota(Root.begin(), Root.end(), 0);
+    std::iota(Align.begin(), Align.end(), 0);
+    for (const auto &Layer : Order) {
+      std::ptrdiff_t Previous = -1;
+      for (size_t Current : Layer) {
+        const auto &Neighbors = IsBottomUp ? Below[Current] : Above[Current];
+        size_t Count = Neighbors.size();
+        for (size_t M = (Count - 1) / 2; Count && M <= Count / 2; ++M) {
+          size_t Neighbor = Neighbors[IsRightToLeft ? Count - 1 - M : M];
+          if (Align[Current] == Current
+              && Previous < std::ptrdiff_t(Local[Neighbor])
+              && !Conflicts.contains(pairOf(Current, Neighbor))) {
+            Align[Neighbor] = Current;
+            Root[Current] = Root[Neighbor];
+            Align[Current] = Root[Current];
+            Previous = Local[Neighbor];
+          }
+        }
+      }
+    }
+
+    // Compact the blocks: each block is placed as far to the left as its left
+    // neighbors allow, then, if it has right neighbors, moved as close to them
+    // as possible.
+    llvm::DenseMap<NodePair, float> Separations;
+    for (const auto &Layer : Order) {
+      for (size_t I = 1; I < Layer.size(); ++I) {
+        size_t Left = Layer[I - 1];
+        size_t Right = Layer[I];
+        float Distance = (Width[Left] + Width[Right]) / 2 + MarginSize * 2;
+        float &Separation = Separations[{ Root[Left], Root[Right] }];
+        Separation = std::max(Separation, Distance);
+      }
+    }
+
+    std::vector<llvm::SmallVector<std::pair<size_t, float>, 2>> Lefts;
+    std::vector<llvm::SmallVector<std::pair<size_t, float>, 2>> Rights;
+    Lefts.resize(Nodes.size());
+    Rights.resize(Nodes.size());
+    std::vector<size_t> Remaining(Nodes.size());
+    for (auto [Pair, Separation] : Separations) {
+      Rights[Pair.first].emplace_back(Pair.second, Separation);
+      Lefts[Pair.second].emplace_back(Pair.first, Separation);
+      ++Remaining[Pair.second];
+    }
+
+    // Aligning never swaps nodes, so the blocks can always be sorted.
+    std::vector<size_t> BlockOrder;
+    size_t BlockCount = 0;
+    for (size_t Index = 0; Index < Nodes.size(); ++Index) {
+      if (Root[Index] == Index) {
+        ++BlockCount;
+        if (Remaining[Index] == 0)
+          BlockOrder.push_back(Index);
+      }
+    }
+    for (size_t I = 0; I < BlockOrder.size(); ++I)
+      for (auto [Right, _] : Rights[BlockOrder[I]])
+        if (--Remaining[Right] == 0)
+          BlockOrder.push_back(Right);
+    revng_assert(BlockOrder.size() == BlockCount);
+
+    std::vector<float> X(Nodes.size(), 0);
+    for (size_t Block : BlockOrder)
+      for (auto [Left, Separation] : Lefts[Block])
+        X[Block] = std::max(X[Block], X[Left] + Separation);
+
+    for (size_t Block : llvm::reverse(BlockOrder)) {
+      float Limit = Infinity;
+      for (auto [Right, Separation] : Rights[Block])
+        Limit = std::min(Limit, X[Right] - Separation);
+      if (Limit != Infinity)
+        X[Block] = std::max(X[Block], Limit);
+    }
+
+    auto &Result = Candidates[Direction];
+    Result.resize(Nodes.size());
+    for (size_t Index = 0; Index < Nodes.size(); ++Index)
+      Result[Index] = IsRightToLeft ? -X[Root[Index]] : X[Root[Index]];
+  }
+
+  // Align the candidates to the narrowest one, then balance them.
+  std::array<float, 4> Minimum;
+  std::array<float, 4> Maximum;
+  std::array<float, 4> Extent;
+  size_t Narrowest = 0;
+  for (size_t Direction = 0; Direction < Candidates.size(); ++Direction) {
+    float Left = Infinity;
+    float Right = -Infinity;
+    Minimum[Direction] = Infinity;
+    Maximum[Direction] = -Infinity;
+    for (size_t Index = 0; Index < Nodes.size(); ++Index) {
+      float Center = Candidates[Direction][Index];
+      Left = std::min(Left, Center - Width[Index] / 2);
+      Right = std::max(Right, Center + Width[Index] / 2);
+      Minimum[Direction] = std::min(Minimum[Direction], Center);
+      Maximum[Direction] = std::max(Maximum[Direction], Center);
+    }
+
+    Extent[Direction] = Right - Left;
+    if (Extent[Direction] < Extent[Narrowest])
+      Narrowest = Direction;
+  }
+
+  for (size_t Direction = 0; Direction < Candidates.size(); ++Direction) {
+    bool IsRightToLeft = Direction & 2;
+    float Delta = IsRightToLeft ? Maximum[Narrowest] - Maximum[Direction] :
+                                  Minimum[Narrowest] - Minimum[Direction];
+    for (float &Center : Candidates[Direction])
+      Center += Delta;
+  }
+
+  float Left = Infinity;
+  float Right = -Infinity;
+  std::vector<float> Balanced(Nodes.size());
+  for (size_t Index = 0; Index < Nodes.size(); ++Index) {
+    std::array<float, 4> Values;
+    for (size_t Direction = 0; Direction < Candidates.size(); ++Direction)
+      Values[Direction] = Candidates[Direction][Index];
+    std::sort(Values.begin(), Values.end());
+
+    Balanced[Index] = (Values[1] + Values[2]) / 2;
+    Left = std::min(Left, Balanced[Index] - Width[Index] / 2);
+    Right = std::max(Right, Balanced[Index] + Width[Index] / 2);
+  }
+
+  // Center the layout, like the iterative placement does.
+  for (size_t Index = 0; Index < Nodes.size(); ++Index)
+    Nodes[Index]->Center = { Balanced[Index] - (Left + Right) / 2, 0 };
+}
+
 void setStaticOffsetHorizontalCoordinates(const LayerContainer &Layers,
                                           float MarginSize) {
   struct Subtree {
@@ -16,7 +16,8 @@ prepareGraph(InternalGraph &Graph, bool OmitClassification);
 template<RankingStrategy Strategy>
 LayerContainer selectPermutation(InternalGraph &Graph,
                                  RankContainer &Ranks,
-                                 const MaybeClassifier<Strategy> &Classifier);
+                                 const MaybeClassifier<Strategy> &Classifier,
+                                 const Configuration &Configuration);
 
 /// A simplified permutation selection to only be used with simple tree.
 LayerContainer selectSimpleTreePermutation(InternalGraph &Graph,
@@ -57,6 +58,13 @@ void setHorizontalCoordinates(const LayerContainer &Layers,
                               float MarginSize,
                               float VirtualNodeWeight = 0.1f);
 
+/// Calculates horizontal coordinates in linear time by balancing four
+/// alignments of the nodes with their median neighbors (see Brandes and Koepf).
+void setLinearTimeHorizontalCoordinates(const LayerContainer &Layers,
+                                        const SegmentContainer &LinearSegments,
+                                        const LayoutContainer &Layout,
+                                        float MarginSize);
+
 /// Simplified horizontal coordinate calculation based on layers only.
 void setStaticOffsetHorizontalCoordinates(const LayerContainer &Layers,
                                           float MarginSize);
@@ -132,7 +140,10 @@ bool computeInternal(InternalGraph &Graph, const Configuration &Configuration) {
   // climbing algorithm.
   auto Layers = Configuration.UseSimpleTreeOptimization ?
                   selectSimpleTreePermutation(Graph, Ranks) :
-                  selectPermutation<RS>(Graph, Ranks, *Classified);
+                  selectPermutation<RS>(Graph,
+                                        Ranks,
+                                        *Classified,
+                                        Configuration);
 
   // Compute an augmented topological ordering of the nodes of the graph.
   auto Order = extractAugmentedTopologicalOrder(Graph, Layers);
@@ -156,6 +167,8 @@ bool computeInternal(InternalGraph &Graph, const Configuration &Configuration) {
       if (Node->Size.W > MaximumNodeWidth)
         MaximumNodeWidth = Node->Size.W;
     setStaticOffsetHorizontalCoordinates(Layers, MaximumNodeWidth + Margin);
+  } else if (Configuration.UseLinearTimeHorizontalPlacement) {
+    setLinearTimeHorizontalCoordinates(Layers, LinearSegments, Final, Margin);
   } else {
     const auto &W = Configuration.VirtualNodeWeight;
     setHorizontalCoordinates(Layers, Order, LinearSegments, Final, Margin, W);
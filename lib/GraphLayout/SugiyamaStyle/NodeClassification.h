@@ -36,6 +36,10 @@ template<>
 class NodeClassifierStorage<RankingStrategy::DisjointDepthFirstSearch>
   : public NodeClassifierStorage<RankingStrategy::BreadthFirstSearch> {};
 
+template<>
+class NodeClassifierStorage<RankingStrategy::NetworkSimplex>
+  : public NodeClassifierStorage<RankingStrategy::BreadthFirstSearch> {};
+
 } // namespace detail
 
 /// It is used to classify the nodes by selecting the right cluster depending
@@ -4,9 +4,13 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <limits>
+
 #include "llvm/ADT/BreadthFirstIterator.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DepthFirstIterator.h"
 #include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/SmallVector.h"
 
 #include "revng/ADT/SmallMap.h"
 
@@ -186,6 +190,435 @@ RankContainer rankNodes<DDFS>(InternalGraph &Graph) {
   return rankNodes<DDFS>(Graph, 4u);
 }
 
+namespace {
+
+/// Minimizes the total length of the edges of a DAG using the network simplex
+/// method from "A Technique for Drawing Directed Graphs" by Gansner et al.
+///
+/// Starting from a feasible spanning tree of tight edges, tree edges with
+/// a negative cut value are repeatedly exchanged with the non-tree edge with
+/// the minimum slack. After each exchange only the cut values on the tree path
+/// between the ends of the entering edge and the postorder numbering of the
+/// subtree rooted at their common ancestor are updated, which keeps an
+/// iteration proportional to the size of the affected subtree.
+class NetworkSimplex {
+private:
+  static constexpr size_t None = std::numeric_limits<size_t>::max();
+
+  /// The maximum number of tree edges with a negative cut value compared
+  /// before picking the one leaving the tree.
+  static constexpr size_t SearchSize = 30;
+
+  struct Edge {
+    size_t From = None;
+    size_t To = None;
+    RankDelta Weight = 0;
+    RankDelta CutValue = 0;
+    bool IsTree = false;
+  };
+
+  using EdgeList = llvm::SmallVector<size_t, 4>;
+
+private:
+  std::vector<NodeView> Nodes;
+  std::vector<Edge> Edges;
+  std::vector<EdgeList> Outgoing;
+  std::vector<EdgeList> Incoming;
+  std::vector<RankDelta> Ranks;
+
+  /// The edges of the spanning tree, both in total and per node
+  std::vector<size_t> TreeEdges;
+  std::vector<EdgeList> TreeAdjacency;
+  std::vector<size_t> TreeSlot;
+  size_t SearchStart = 0;
+
+  /// The tree edge leading to the parent of each node and the range of
+  /// postorder numbers of its subtree: a node `N` belongs to the subtree rooted
+  /// at `R` if and only if `Low[R] <= Lim[N] <= Lim[R]`.
+  std::vector<size_t> Parent;
+  std::vector<size_t> Low;
+  std::vector<size_t> Lim;
+
+public:
+  explicit NetworkSimplex(InternalGraph &Graph) {
+    std::unordered_map<NodeView, size_t> Numbers;
+    for (auto *Node : Graph.nodes()) {
+      Numbers.emplace(Node, Nodes.size());
+      Nodes.emplace_back(Node);
+    }
+
+    Outgoing.resize(Nodes.size());
+    Incoming.resize(Nodes.size());
+    TreeAdjacency.resize(Nodes.size());
+
+    // Parallel edges are merged into a single edge whose weight is their count
+    llvm::DenseMap<std::pair<size_t, size_t>, size_t> Lookup;
+    for (size_t From = 0; From < Nodes.size(); ++From) {
+      for (auto *Successor : Nodes[From]->successors()) {
+        size_t To = Numbers.at(Successor);
+        revng_assert(From != To);
+
+        auto [Iterator, IsNew] = Lookup.try_emplace({ From, To }, Edges.size());
+        if (IsNew) {
+          Edges.push_back(Edge{ .From = From, .To = To });
+          Outgoing[From].push_back(Iterator->second);
+          Incoming[To].push_back(Iterator->second);
+        }
+        ++Edges[Iterator->second].Weight;
+      }
+    }
+
+    TreeSlot.resize(Edges.size(), None);
+  }
+
+public:
+  RankContainer run(size_t IterationLimit) {
+    if (Nodes.empty())
+      return {};
+
+    rankLongestPath();
+    buildFeasibleTree();
+
+    for (size_t Iteration = 0; Iteration < IterationLimit; ++Iteration) {
+      size_t Leaving = leavingEdge();
+      if (Leaving == None)
+        break;
+
+      size_t Entering = enteringEdge(Leaving);
+      if (Entering == None)
+        break;
+
+      exchange(Leaving, Entering);
+    }
+
+    RankDelta Minimum = *std::min_element(Ranks.begin(), Ranks.end());
+    RankContainer Result;
+    for (size_t Index = 0; Index < Nodes.size(); ++Index)
+      Result.emplace(Nodes[Index], Ranks[Index] - Minimum + RootNodeRankValue);
+    return Result;
+  }
+
+private:
+  RankDelta slack(size_t Index) const {
+    const Edge &E = Edges[Index];
+    return Ranks[E.To] - Ranks[E.From] - 1;
+  }
+
+  size_t opposite(size_t Index, size_t Node) const {
+    const Edge &E = Edges[Index];
+    return E.From == Node ? E.To : E.From;
+  }
+
+  bool isInSubtree(size_t Node, size_t Root) const {
+    return Low[Root] <= Lim[Node] && Lim[Node] <= Lim[Root];
+  }
+
+  /// Assigns the initial ranks: each node is placed right below the lowest of
+  /// its predecessors.
+  void rankLongestPath() {
+    Ranks.assign(Nodes.size(), 0);
+
+    std::vector<size_t> Remaining(Nodes.size());
+    std::vector<size_t> Worklist;
+    for (size_t Index = 0; Index < Nodes.size(); ++Index) {
+      Remaining[Index] = Incoming[Index].size();
+      if (Remaining[Index] == 0)
+        Worklist.push_back(Index);
+    }
+
+    size_t Visited = 0;
+    while (!Worklist.empty()) {
+      size_t Current = Worklist.back();
+      Worklist.pop_back();
+      ++Visited;
+
+      for (size_t Index : Outgoing[Current]) {
+        size_t To = Edges[Index].To;
+        Ranks[To] = std::max(Ranks[To], Ranks[Current] + 1);
+        if (--Remaining[To] == 0)
+          Worklist.push_back(To);
+      }
+    }
+
+    revng_assert(Visited == Nodes.size(), "Only DAGs can be ranked.");
+  }
+
+  void addTreeEdge(size_t Index) {
+    Edge &E = Edges[Index];
+    E.IsTree = true;
+    TreeSlot[Index] = TreeEdges.size();
+    TreeEdges.push_back(Index);
+    TreeAdjacency[E.From].push_back(Index);
+    TreeAdjacency[E.To].push_back(Index);
+  }
+
+  /// Builds a spanning tree (a forest, if the graph is disconnected) only
+  /// made of tight edges, shifting the ranks of the partial tree towards the
+  /// edge with the minimum slack whenever it cannot be grown any further.
+  void buildFeasibleTree() {
+    std::vector<bool> InTree(Nodes.size(), false);
+    std::vector<size_t> TreeNodes;
+    std::vector<size_t> Roots;
+
+    auto Grow = [&]() {
+      std::vector<size_t> Worklist = TreeNodes;
+      while (!Worklist.empty()) {
+        size_t Current = Worklist.back();
+        Worklist.pop_back();
+
+        for (const EdgeList *List :
+             { &Outgoing[Current], &Incoming[Current] }) {
+          for (size_t Index : *List) {
+            size_t Other = opposite(Index, Current);
+            if (!InTree[Other] && slack(Index) == 0) {
+              InTree[Other] = true;
+              TreeNodes.push_back(Other);
+              Worklist.push_back(Other);
+              addTreeEdge(Index);
+            }
+          }
+        }
+      }
+    };
+
+    size_t NextRoot = 0;
+    while (TreeNodes.size() < Nodes.size()) {
+      size_t Candidate = None;
+      for (size_t Index = 0; Index < Edges.size(); ++Index) {
+        const Edge &E = Edges[Index];
+        if (InTree[E.From] != InTree[E.To])
+          if (Candidate == None || slack(Index) < slack(Candidate))
+            Candidate = Index;
+      }
+
+      if (Candidate == None) {
+        // No edge connects the tree to the rest of the graph: start a new one.
+        while (InTree[NextRoot])
+          ++NextRoot;
+        InTree[NextRoot] = true;
+        TreeNodes.push_back(NextRoot);
+        Roots.push_back(NextRoot);
+      } else {
+        RankDelta Delta = slack(Candidate);
+        if (!InTree[Edges[Candidate].From])
+          Delta = -Delta;
+        for (size_t Node : TreeNodes)
+          Ranks[Node] += Delta;
+      }
+
+      Grow();
+    }
+
+    Parent.assign(Nodes.size(), None);
+    Low.assign(Nodes.size(), 0);
+    Lim.assign(Nodes.size(), 0);
+
+    std::vector<size_t> PostOrder;
+    for (size_t NextLim = 0; size_t Root : Roots)
+      NextLim = assignRanges(Root, None, NextLim, &PostOrder);
+
+    for (size_t Node : PostOrder)
+      if (Parent[Node] != None)
+        Edges[Parent[Node]].CutValue = computeCutValue(Node);
+  }
+
+  /// Assigns the parent edges and the postorder ranges of the subtree rooted
+  /// at \p Root starting from \p FirstLim.
+  ///
+  /// \returns the first postorder number after the subtree.
+  size_t assignRanges(size_t Root,
+                      size_t ParentEdge,
+                      size_t FirstLim,
+                      std::vector<size_t> *PostOrder = nullptr) {
+    Parent[Root] = ParentEdge;
+    Low[Root] = FirstLim;
+
+    size_t NextLim = FirstLim;
+    std::vector<std::pair<size_t, size_t>> Stack{ { Root, 0 } };
+    while (!Stack.empty()) {
+      auto [Current, Next] = Stack.back();
+      if (Next < TreeAdjacency[Current].size()) {
+        ++Stack.back().second;
+
+        size_t Index = TreeAdjacency[Current][Next];
+        if (Index == Parent[Current])
+          continue;
+
+        size_t Child = opposite(Index, Current);
+        Parent[Child] = Index;
+        Low[Child] = NextLim;
+        Stack.emplace_back(Child, 0);
+      } else {
+        Lim[Current] = NextLim++;
+        if (PostOrder != nullptr)
+          PostOrder->push_back(Current);
+        Stack.pop_back();
+      }
+    }
+
+    return NextLim;
+  }
+
+  /// Computes the cut value of the tree edge leading to the parent of \p Node
+  /// provided the cut values of the edges leading to its children.
+  RankDelta computeCutValue(size_t Node) const {
+    const Edge &TreeEdge = Edges[Parent[Node]];
+    bool IsTail = TreeEdge.From == Node;
+
+    RankDelta Result = TreeEdge.Weight;
+    for (bool IsOutgoing : { true, false }) {
+      for (size_t Index : IsOutgoing ? Outgoing[Node] : Incoming[Node]) {
+        if (Index == Parent[Node])
+          continue;
+
+        const Edge &E = Edges[Index];
+        bool IsAligned = IsOutgoing == IsTail;
+        Result += IsAligned ? E.Weight : -E.Weight;
+        if (E.IsTree)
+          Result += IsAligned ? -E.CutValue : E.CutValue;
+      }
+    }
+
+    return Result;
+  }
+
+  size_t leavingEdge() {
+    size_t Result = None;
+    size_t Found = 0;
+    for (size_t Step = 0; Step < TreeEdges.size(); ++Step) {
+      size_t Slot = (SearchStart + Step) % TreeEdges.size();
+      size_t Index = TreeEdges[Slot];
+      if (Edges[Index].CutValue < 0) {
+        if (Result == None || Edges[Index].CutValue < Edges[Result].CutValue)
+          Result = Index;
+
+        if (++Found == SearchSize) {
+          SearchStart = Slot;
+          break;
+        }
+      }
+    }
+
+    return Result;
+  }
+
+  /// Looks for the non-tree edge with the minimum slack that reconnects
+  /// the two components the tree is split into by removing \p Leaving.
+  size_t enteringEdge(size_t Leaving) const {
+    const Edge &L = Edges[Leaving];
+
+    // The subtree below `Leaving` holds its tail: look for the edges entering
+    // the subtree. Otherwise, look for the edges leaving it.
+    bool IsTailBelow = Lim[L.From] < Lim[L.To];
+    size_t Below = IsTailBelow ? L.From : L.To;
+
+    size_t Result = None;
+    std::vector<size_t> Worklist{ Below };
+    while (!Worklist.empty()) {
+      size_t Current = Worklist.back();
+      Worklist.pop_back();
+
+      for (size_t Index : IsTailBelow ? Incoming[Current] : Outgoing[Current]) {
+        if (Edges[Index].IsTree || isInSubtree(opposite(Index, Current), Below))
+          continue;
+
+        if (Result == None || slack(Index) < slack(Result)) {
+          Result = Index;
+          if (slack(Result) == 0)
+            return Result;
+        }
+      }
+
+      for (size_t Index : TreeAdjacency[Current])
+        if (Index != Parent[Current])
+          Worklist.push_back(opposite(Index, Current));
+    }
+
+    return Result;
+  }
+
+  /// Walks up from \p From until reaching the common ancestor with \p To,
+  /// updating the cut values of the edges on the way.
+  size_t updatePath(size_t From, size_t To, RankDelta Delta, bool Direction) {
+    size_t Current = From;
+    while (!isInSubtree(To, Current)) {
+      Edge &E = Edges[Parent[Current]];
+      bool IsForward = E.From == Current ? Direction : !Direction;
+      E.CutValue += IsForward ? Delta : -Delta;
+      Current = Lim[E.From] > Lim[E.To] ? E.From : E.To;
+    }
+
+    return Current;
+  }
+
+  void exchange(size_t Leaving, size_t Entering) {
+    const Edge &L = Edges[Leaving];
+    const Edge &E = Edges[Entering];
+
+    // Make the entering edge tight by moving the subtree below the leaving one
+    if (RankDelta Delta = slack(Entering); Delta != 0) {
+      bool IsTailBelow = Lim[L.From] < Lim[L.To];
+      size_t Below = IsTailBelow ? L.From : L.To;
+      if (!IsTailBelow)
+        Delta = -Delta;
+
+      std::vector<size_t> Worklist{ Below };
+      while (!Worklist.empty()) {
+        size_t Current = Worklist.back();
+        Worklist.pop_back();
+
+        Ranks[Current] -= Delta;
+        for (size_t Index : TreeAdjacency[Current])
+          if (Index != Parent[Current])
+            Worklist.push_back(opposite(Index, Current));
+      }
+    }
+
+    // Only the cut values of the cycle closed by the entering edge change
+    RankDelta CutValue = L.CutValue;
+    size_t Ancestor = updatePath(E.From, E.To, CutValue, true);
+    revng_assert(updatePath(E.To, E.From, CutValue, false) == Ancestor);
+
+    Edges[Entering].CutValue = -CutValue;
+    Edges[Leaving].CutValue = 0;
+
+    Edges[Leaving].IsTree = false;
+    for (size_t Node : { L.From, L.To }) {
+      auto &Adjacency = TreeAdjacency[Node];
+      Adjacency.erase(llvm::find(Adjacency, Leaving));
+    }
+
+    Edges[Entering].IsTree = true;
+    TreeAdjacency[E.From].push_back(Entering);
+    TreeAdjacency[E.To].push_back(Entering);
+
+    size_t Slot = TreeSlot[Leaving];
+    TreeSlot[Leaving] = None;
+    TreeSlot[Entering] = Slot;
+    TreeEdges[Slot] = Entering;
+
+    // The subtree of the common ancestor still holds the same nodes
+    assignRanges(Ancestor, Parent[Ancestor], Low[Ancestor]);
+  }
+};
+
+} // namespace
+
+/// `RankingStrategy::NetworkSimplex` template specialization.
+/// Assigns ranks minimizing the total length of the edges, i.e., the number
+/// of virtual nodes needed to partition them.
+constexpr auto NS = RankingStrategy::NetworkSimplex;
+template<>
+RankContainer rankNodes<NS>(InternalGraph &Graph) {
+  // The optimum is usually reached in far fewer iterations, the limit only
+  // prevents degenerate graphs from pivoting for too long.
+  size_t IterationLimit = 4 * Graph.size() + 64;
+  RankContainer Ranks = NetworkSimplex(Graph).run(IterationLimit);
+
+  revng_assert(Ranks.size() == Graph.size());
+  return Ranks;
+}
+
 RankContainer &updateRanks(InternalGraph &Graph, RankContainer &Ranks) {
   Ranks.try_emplace(Graph.getEntryNode(),
                     Graph.getEntryNode()->IsVirtual ? Rank(-1) : Rank(0));
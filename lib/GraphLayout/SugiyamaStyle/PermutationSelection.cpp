@@ -5,8 +5,13 @@
 //
 
 #include <map>
+#include <numeric>
+#include <unordered_set>
 
 #include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/Support/Parallel.h"
+
+#include "revng/Support/Deadline.h"
 
 #include "InternalCompute.h"
 
@@ -14,6 +19,10 @@
 /// the layers that are not required for correct routing.
 static LayerContainer optimizeLayers(InternalGraph &Graph,
                                      RankContainer &Ranks) {
+  // Removing the nodes one by one is quadratic, so only disconnect them here
+  // and remove all of them at the end.
+  std::unordered_set<InternalNode *> Removed;
+
   LayerContainer Layers;
   for (auto &[Node, Rank] : Ranks) {
     if (Rank >= Layers.size())
@@ -58,7 +67,8 @@ static LayerContainer optimizeLayers(InternalGraph &Graph,
         auto *Label = Node->successor_edges().begin()->Label;
         Predecessor->addSuccessor(Successor, std::move(*Label));
         Ranks.erase(Node);
-        Graph.removeNode(Node);
+        Node->disconnect();
+        Removed.insert(Node);
       }
 
       Iterator = Layers.erase(Iterator);
@@ -67,6 +77,10 @@ static LayerContainer optimizeLayers(InternalGraph &Graph,
     }
   }
 
+  Graph.removeNodesIf([&Removed](InternalNode *Node) {
+    return Removed.contains(Node);
+  });
+
   // Update ranks
   for (size_t Index = 0; Index < Layers.size(); ++Index)
     for (auto Node : Layers[Index])
@@ -239,6 +253,10 @@ LayerContainer minimizeCrossingCount(const RankContainer &Ranks,
 
   CrossingCalculator Calculator{ Layers, Ranks, Permutation };
   for (size_t Iteration = 0; Iteration < IterationCount; ++Iteration) {
+    // Every iteration leaves a valid permutation, just with more crossings
+    if (revng::deadlineExpired("the crossing minimization"))
+      break;
+
     bool DidAnySwaps = false;
     for (size_t Index = 0; Index < Layers.size(); ++Index) {
       if (size_t CurrentLayerSize = Layers[Index].size(); CurrentLayerSize) {
@@ -298,36 +316,274 @@ LayerContainer minimizeCrossingCount(const RankContainer &Ranks,
   return Result;
 }
 
-template<bool PreOrPost, typename ClusterType>
-class BarycentricComparator {
+/// A crossing minimization heuristic meant for graphs that are too wide for
+/// `minimizeCrossingCount`.
+///
+/// Each layer is swept with the "adjacent exchange" heuristic: two neighboring
+/// nodes are swapped if it reduces the number of crossings among their edges,
+/// which takes time linear in the number of those edges. Since each swap only
+/// looks at the adjacent layers, all the even layers can be swept in parallel,
+/// followed by all the odd ones.
+///
+/// The total crossing count, used to detect convergence, is computed using the
+/// accumulator tree described in "Simple and Efficient Bilayer Cross Counting"
+/// by W. Barth, M. Juenger, P. Mutzel (2002).
+class CrossingSweeper {
+private:
+  /// Sweeping stops after this many iterations even if it did not converge
+  static constexpr size_t MaxIterationCount = 32;
+
+  /// Each layer is swept at most this many times per iteration
+  static constexpr size_t MaxPassCount = 16;
+
+  using NodeIndex = size_t;
+
+private:
+  std::vector<NodeView> Nodes;
+  std::vector<size_t> Clusters;
+  std::vector<NodeIndex> Positions;
+
+  /// Neighbors in the previous and in the next layers
+  std::vector<std::vector<NodeIndex>> Upper;
+  std::vector<std::vector<NodeIndex>> Lower;
+
+  std::vector<std::vector<NodeIndex>> Layers;
+
 public:
-  BarycentricComparator(const RankContainer &Ranks,
-                        const RankContainer &Positions,
-                        const LayerContainer &Layers,
-                        const ClusterType &Cluster) :
-    Ranks(Ranks), Positions(Positions), Layers(Layers), Cluster(Cluster) {}
+  template<typename ClusterType>
+  CrossingSweeper(const RankContainer &Ranks,
+                  const ClusterType &Cluster,
+                  const LayerContainer &InputLayers) {
+    std::unordered_map<NodeView, NodeIndex> Indices;
+    Layers.resize(InputLayers.size());
+    for (size_t LayerIndex = 0; LayerIndex < InputLayers.size(); ++LayerIndex) {
+      for (NodeView Node : InputLayers[LayerIndex]) {
+        auto [_, Success] = Indices.try_emplace(Node, Nodes.size());
+        revng_assert(Success);
+        Layers[LayerIndex].emplace_back(Nodes.size());
+        Nodes.emplace_back(Node);
+        Clusters.emplace_back(Cluster(Node));
+      }
+    }
 
-  bool operator()(NodeView LHS, NodeView RHS) {
-    if (int A = Cluster(LHS), B = Cluster(RHS); A == B) {
-      auto BarycenterA = get(LHS), BarycenterB = get(RHS);
-      if (std::isnan(BarycenterA) || std::isnan(BarycenterB))
-        return LHS->index() < RHS->index();
-      else
-        return BarycenterA < BarycenterB;
-    } else {
-      return A < B;
+    Upper.resize(Nodes.size());
+    Lower.resize(Nodes.size());
+    for (NodeIndex Index = 0; Index < Nodes.size(); ++Index) {
+      NodeView Node = Nodes[Index];
+      Rank CurrentRank = Ranks.at(Node);
+      for (auto *Predecessor : Node->predecessors())
+        if (Ranks.at(Predecessor) + 1 == CurrentRank)
+          Upper[Index].emplace_back(Indices.at(Predecessor));
+      for (auto *Successor : Node->successors())
+        if (Ranks.at(Successor) == CurrentRank + 1)
+          Lower[Index].emplace_back(Indices.at(Successor));
+    }
+
+    // Start from the order the layers come in, grouped by cluster
+    Positions.resize(Nodes.size());
+    for (auto &Layer : Layers) {
+      std::stable_sort(Layer.begin(),
+                       Layer.end(),
+                       [this](NodeIndex LHS, NodeIndex RHS) {
+                         return Clusters[LHS] < Clusters[RHS];
+                       });
+      updatePositions(Layer);
     }
   }
 
-protected:
-  double get(NodeView Node) {
-    auto Iterator = Barycenters.lower_bound(Node);
-    if (Iterator == Barycenters.end() || Node < Iterator->first)
-      Iterator = Barycenters.insert(Iterator, { Node, compute(Node) });
-    return Iterator->second;
+public:
+  void run() {
+    size_t CrossingCount = countCrossings();
+    for (size_t Iteration = 0; Iteration < MaxIterationCount; ++Iteration) {
+      if (revng::deadlineExpired("the crossing minimization"))
+        break;
+
+      for (size_t Parity = 0; Parity < 2; ++Parity) {
+        size_t SweepCount = (Layers.size() + 1 - Parity) / 2;
+        llvm::parallelForEachN(0, SweepCount, [this, Parity](size_t Index) {
+          sweep(Layers[Index * 2 + Parity]);
+        });
+      }
+
+      // Swaps never increase the crossing count: stop once it's stable
+      size_t NewCrossingCount = countCrossings();
+      revng_assert(NewCrossingCount <= CrossingCount);
+      if (NewCrossingCount == CrossingCount)
+        break;
+      CrossingCount = NewCrossingCount;
+    }
+  }
+
+  LayerContainer takeLayers() const {
+    LayerContainer Result(Layers.size());
+    for (size_t LayerIndex = 0; LayerIndex < Layers.size(); ++LayerIndex)
+      for (NodeIndex Index : Layers[LayerIndex])
+        Result[LayerIndex].emplace_back(Nodes[Index]);
+    return Result;
+  }
+
+private:
+  void updatePositions(const std::vector<NodeIndex> &Layer) {
+    for (size_t Position = 0; Position < Layer.size(); ++Position)
+      Positions[Layer[Position]] = Position;
+  }
+
+  std::vector<size_t>
+  sortedPositions(const std::vector<NodeIndex> &Neighbors) const {
+    std::vector<size_t> Result;
+    Result.reserve(Neighbors.size());
+    for (NodeIndex Neighbor : Neighbors)
+      Result.emplace_back(Positions[Neighbor]);
+    llvm::sort(Result);
+    return Result;
+  }
+
+  /// Counts the crossings between the edges of two nodes, assuming the one
+  /// connected to \p Left is to the left of the one connected to \p Right.
+  static size_t countPairCrossings(const std::vector<size_t> &Left,
+                                   const std::vector<size_t> &Right) {
+    size_t Result = 0;
+    size_t RightIndex = 0;
+    for (size_t Position : Left) {
+      while (RightIndex < Right.size() && Right[RightIndex] < Position)
+        ++RightIndex;
+      Result += RightIndex;
+    }
+    return Result;
+  }
+
+  /// Swaps adjacent nodes of \p Layer as long as it reduces crossings.
+  ///
+  /// \note: this only reads the positions of the nodes in adjacent layers,
+  ///        and only writes those of the nodes in \p Layer.
+  void sweep(std::vector<NodeIndex> &Layer) {
+    if (Layer.size() < 2)
+      return;
+
+    // Neighbor positions do not change while this layer is being swept
+    std::vector<std::vector<size_t>> UpperPositions, LowerPositions;
+    std::unordered_map<NodeIndex, size_t> Local;
+    for (NodeIndex Index : Layer) {
+      Local[Index] = UpperPositions.size();
+      UpperPositions.emplace_back(sortedPositions(Upper[Index]));
+      LowerPositions.emplace_back(sortedPositions(Lower[Index]));
+    }
+
+    auto Crossings = [&](NodeIndex Left, NodeIndex Right) {
+      size_t L = Local.at(Left), R = Local.at(Right);
+      return countPairCrossings(UpperPositions[L], UpperPositions[R])
+             + countPairCrossings(LowerPositions[L], LowerPositions[R]);
+    };
+
+    for (size_t Pass = 0; Pass < MaxPassCount; ++Pass) {
+      bool DidAnySwaps = false;
+      for (size_t Position = 0; Position + 1 < Layer.size(); ++Position) {
+        NodeIndex Left = Layer[Position], Right = Layer[Position + 1];
+        if (Clusters[Left] != Clusters[Right])
+          continue;
+
+        if (Crossings(Right, Left) < Crossings(Left, Right)) {
+          std::swap(Layer[Position], Layer[Position + 1]);
+          DidAnySwaps = true;
+        }
+      }
+
+      if (!DidAnySwaps)
+        break;
+    }
+
+    updatePositions(Layer);
+  }
+
+  /// Counts the crossings between the layer \p Index and the next one.
+  size_t countLayerCrossings(size_t Index) const {
+    const auto &UpperLayer = Layers[Index];
+    const auto &LowerLayer = Layers[Index + 1];
+
+    // Sort the edges by the position of their upper end first, and of their
+    // lower end second: crossings are the inversions in the lower ends.
+    std::vector<size_t> LowerEnds;
+    for (NodeIndex Node : UpperLayer) {
+      auto Neighbors = sortedPositions(Lower[Node]);
+      LowerEnds.insert(LowerEnds.end(), Neighbors.begin(), Neighbors.end());
+    }
+
+    size_t FirstLeaf = 1;
+    while (FirstLeaf < LowerLayer.size())
+      FirstLeaf *= 2;
+    std::vector<size_t> Tree(2 * FirstLeaf - 1, 0);
+    --FirstLeaf;
+
+    size_t Result = 0;
+    for (size_t Position : LowerEnds) {
+      size_t TreeIndex = Position + FirstLeaf;
+      ++Tree[TreeIndex];
+      while (TreeIndex > 0) {
+        if (TreeIndex % 2 != 0)
+          Result += Tree[TreeIndex + 1];
+        TreeIndex = (TreeIndex - 1) / 2;
+        ++Tree[TreeIndex];
+      }
+    }
+
+    return Result;
   }
 
-  double computeImpl(NodeView Node, auto NeighborContainerView) {
+  size_t countCrossings() const {
+    if (Layers.size() < 2)
+      return 0;
+
+    std::vector<size_t> PerLayer(Layers.size() - 1);
+    llvm::parallelForEachN(0, PerLayer.size(), [this, &PerLayer](size_t I) {
+      PerLayer[I] = countLayerCrossings(I);
+    });
+    return std::accumulate(PerLayer.begin(), PerLayer.end(), size_t(0));
+  }
+};
+
+template<bool PreOrPost, typename ClusterType>
+class BarycentricSorter {
+public:
+  BarycentricSorter(const RankContainer &Ranks,
+                    const RankContainer &Positions,
+                    const LayerContainer &Layers,
+                    const ClusterType &Cluster) :
+    Ranks(Ranks), Positions(Positions), Layers(Layers), Cluster(Cluster) {}
+
+  /// Sorts \p Layer by cluster first, and by barycenter within a cluster.
+  ///
+  /// \note: the keys only depend on the other layers, so they are computed
+  ///        once per node instead of on every comparison.
+  void sort(std::vector<NodeView> &Layer) const {
+    struct Entry {
+      int Cluster;
+      double Barycenter;
+      NodeView Node;
+    };
+
+    std::vector<Entry> Entries;
+    Entries.reserve(Layer.size());
+    for (NodeView Node : Layer)
+      Entries.push_back({ int(Cluster(Node)), compute(Node), Node });
+
+    auto Comparator = [](const Entry &LHS, const Entry &RHS) {
+      if (LHS.Cluster == RHS.Cluster) {
+        if (std::isnan(LHS.Barycenter) || std::isnan(RHS.Barycenter))
+          return LHS.Node->index() < RHS.Node->index();
+        else
+          return LHS.Barycenter < RHS.Barycenter;
+      } else {
+        return LHS.Cluster < RHS.Cluster;
+      }
+    };
+    std::sort(Entries.begin(), Entries.end(), Comparator);
+
+    for (size_t Index = 0; Index < Entries.size(); ++Index)
+      Layer[Index] = Entries[Index].Node;
+  }
+
+protected:
+  double computeImpl(NodeView Node, auto NeighborContainerView) const {
     if (NeighborContainerView.empty())
       return std::numeric_limits<double>::quiet_NaN();
 
@@ -348,7 +604,7 @@ protected:
     return Accumulator / Counter;
   }
 
-  double compute(NodeView Node) {
+  double compute(NodeView Node) const {
     if constexpr (PreOrPost)
       return computeImpl(Node, Node->predecessors());
     else
@@ -356,7 +612,6 @@ protected:
   }
 
 private:
-  std::map<NodeView, double> Barycenters;
   const RankContainer &Ranks;
   const RankContainer &Positions;
   const LayerContainer &Layers;
@@ -374,13 +629,15 @@ LayerContainer sortNodes(const RankContainer &Ranks,
 
   RankContainer Positions;
   for (size_t Iteration = 0; Iteration < IterationCount; Iteration++) {
+    if (revng::deadlineExpired("the graph node sorting"))
+      break;
+
     for (size_t Index = 0; Index < Layers.size(); ++Index) {
       for (size_t Counter = 0; auto Node : Layers[Index])
         Positions[Node] = Counter++;
 
-      using PBC = BarycentricComparator<true, decltype(Cluster)>;
-      PBC Comparator(Ranks, Positions, Layers, Cluster);
-      std::sort(Layers[Index].begin(), Layers[Index].end(), Comparator);
+      using PBS = BarycentricSorter<true, decltype(Cluster)>;
+      PBS(Ranks, Positions, Layers, Cluster).sort(Layers[Index]);
 
       for (size_t Counter = 0; auto Node : Layers[Index])
         Positions[Node] = Counter++;
@@ -389,9 +646,8 @@ LayerContainer sortNodes(const RankContainer &Ranks,
       for (size_t Counter = 0; auto Node : Layers[Index])
         Positions[Node] = Counter++;
 
-      using PBC = BarycentricComparator<false, decltype(Cluster)>;
-      PBC Comparator(Ranks, Positions, Layers, Cluster);
-      std::sort(Layers[Index].begin(), Layers[Index].end(), Comparator);
+      using PBS = BarycentricSorter<false, decltype(Cluster)>;
+      PBS(Ranks, Positions, Layers, Cluster).sort(Layers[Index]);
 
       for (size_t Counter = 0; auto Node : Layers[Index])
         Positions[Node] = Counter++;
@@ -403,7 +659,8 @@ LayerContainer sortNodes(const RankContainer &Ranks,
 template<RankingStrategy Strategy>
 LayerContainer selectPermutation(InternalGraph &Graph,
                                  RankContainer &Ranks,
-                                 const MaybeClassifier<Strategy> &Classifier) {
+                                 const MaybeClassifier<Strategy> &Classifier,
+                                 const Configuration &Configuration) {
   revng_assert(Classifier.has_value());
 
   // Build a layer container based on a given ranking, then remove layers
@@ -411,9 +668,20 @@ LayerContainer selectPermutation(InternalGraph &Graph,
   // backwards edge routing. Update ranks accordingly.
   auto InitialLayers = optimizeLayers(Graph, Ranks);
 
-  auto MinimalCrossingLayers = minimizeCrossingCount(Ranks,
-                                                     *Classifier,
-                                                     std::move(InitialLayers));
+  size_t WidestLayer = 0;
+  for (const auto &Layer : InitialLayers)
+    WidestLayer = std::max(WidestLayer, Layer.size());
+
+  LayerContainer MinimalCrossingLayers;
+  if (WidestLayer > Configuration.ScalableCrossingMinimizationThreshold) {
+    CrossingSweeper Sweeper(Ranks, *Classifier, InitialLayers);
+    Sweeper.run();
+    MinimalCrossingLayers = Sweeper.takeLayers();
+  } else {
+    MinimalCrossingLayers = minimizeCrossingCount(Ranks,
+                                                  *Classifier,
+                                                  std::move(InitialLayers));
+  }
 
   // Iteration counts are chosen arbitrarily. If the computation time was not
   // an issue, we could keep iterating until convergence, but since it's not
@@ -440,26 +708,37 @@ constexpr auto BFSRS = RankingStrategy::BreadthFirstSearch;
 constexpr auto DFSRS = RankingStrategy::DepthFirstSearch;
 constexpr auto TRS = RankingStrategy::Topological;
 constexpr auto DDFSRS = RankingStrategy::DisjointDepthFirstSearch;
+constexpr auto NSRS = RankingStrategy::NetworkSimplex;
 
 template LayerContainer
 selectPermutation<BFSRS>(InternalGraph &Graph,
                          RankContainer &Ranks,
-                         const MaybeClassifier<BFSRS> &Classifier);
+                         const MaybeClassifier<BFSRS> &Classifier,
+                         const Configuration &Configuration);
 
 template LayerContainer
 selectPermutation<DFSRS>(InternalGraph &Graph,
                          RankContainer &Ranks,
-                         const MaybeClassifier<DFSRS> &Classifier);
+                         const MaybeClassifier<DFSRS> &Classifier,
+                         const Configuration &Configuration);
 
 template LayerContainer
 selectPermutation<TRS>(InternalGraph &Graph,
                        RankContainer &Ranks,
-                       const MaybeClassifier<TRS> &Classifier);
+                       const MaybeClassifier<TRS> &Classifier,
+                       const Configuration &Configuration);
 
 template LayerContainer
 selectPermutation<DDFSRS>(InternalGraph &Graph,
                           RankContainer &Ranks,
-                          const MaybeClassifier<DDFSRS> &Classifier);
+                          const MaybeClassifier<DDFSRS> &Classifier,
+                          const Configuration &Configuration);
+
+template LayerContainer
+selectPermutation<NSRS>(InternalGraph &Graph,
+                        RankContainer &Ranks,
+                        const MaybeClassifier<NSRS> &Classifier,
+                        const Configuration &Configuration);
 
 static std::unordered_map<NodeView, size_t> rankSubtrees(InternalGraph &Graph) {
   std::unordered_map<NodeView, size_t> Result;
@@ -6,6 +6,7 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <map>
 #include <sstream>
 #include <stack>
 #include <string>
@@ -13,6 +14,7 @@
 
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/IR/InstIterator.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Type.h"
@@ -3098,6 +3100,23 @@ public:
 
 private:
   void forceEmptyMetadata(Function *RootFunction) const;
+
+  /// Decorate the calls to helpers in root that are equivalent to a call
+  /// decorated in a previous run, so that they don't need to be analyzed
+  ///
+  /// The accesses performed by a call only depend on the callee and on the
+  /// values of its arguments. If they are all constants or the CPU state
+  /// itself, two calls with the same callee and arguments access the same
+  /// CSVs.
+  ///
+  /// \note this only makes sense in lazy mode, since in non-lazy mode each
+  ///       call is rewritten according to its own accesses.
+  void reuseEquivalentResults(Function *RootFunction) const;
+
+  /// \return the callee followed by the arguments of \p Call, with nullptr
+  ///         standing for the CPU state, or an empty vector if any argument
+  ///         is not a constant.
+  std::vector<const Value *> getCallSignature(const CallInst *Call) const;
 };
 
 static void addAccessMetadata(const CallSiteOffsetMap &OffsetMap,
@@ -3163,6 +3182,73 @@ void CPUStateAccessAnalysis::forceEmptyMetadata(Function *RootFunction) const {
   }
 }
 
+std::vector<const Value *>
+CPUStateAccessAnalysis::getCallSignature(const CallInst *Call) const {
+  std::vector<const Value *> Result = { getCallee(Call) };
+
+  for (const Value *Argument : Call->args()) {
+    // Look through casts of a load of the CPU state pointer
+    const Value *Stripped = Argument->stripPointerCasts();
+    while (const auto *Cast = dyn_cast<CastInst>(Stripped))
+      Stripped = Cast->getOperand(0);
+
+    const auto *Load = dyn_cast<LoadInst>(Stripped);
+    if (Stripped == CPUStatePtr
+        or (Load != nullptr and Load->getPointerOperand() == CPUStatePtr)) {
+      Result.push_back(nullptr);
+    } else if (isa<Constant>(Argument)) {
+      Result.push_back(Argument);
+    } else {
+      return {};
+    }
+  }
+
+  return Result;
+}
+
+void CPUStateAccessAnalysis::reuseEquivalentResults(Function *RootFunction)
+  const {
+  using MetadataPair = std::pair<MDNode *, MDNode *>;
+  std::map<std::vector<const Value *>, MetadataPair> Known;
+  std::vector<CallInst *> Undecorated;
+
+  for (Instruction &I : instructions(RootFunction)) {
+    if (not isCallToHelper(&I))
+      continue;
+
+    auto *Call = cast<CallInst>(&I);
+    MDNode *Load = Call->getMetadata(LoadMDKind);
+    MDNode *Store = Call->getMetadata(StoreMDKind);
+    if (Load == nullptr and Store == nullptr) {
+      Undecorated.push_back(Call);
+      continue;
+    }
+
+    std::vector<const Value *> Signature = getCallSignature(Call);
+    if (not Signature.empty())
+      Known.try_emplace(std::move(Signature), Load, Store);
+  }
+
+  unsigned Reused = 0;
+  for (CallInst *Call : Undecorated) {
+    auto It = Known.find(getCallSignature(Call));
+    if (It == Known.end())
+      continue;
+
+    auto [Load, Store] = It->second;
+    if (Load != nullptr)
+      Call->setMetadata(LoadMDKind, Load);
+    if (Store != nullptr)
+      Call->setMetadata(StoreMDKind, Store);
+    ++Reused;
+  }
+
+  revng_log(CSVAccessLog,
+            "Reused the results of " << Reused << " out of "
+                                     << Undecorated.size()
+                                     << " new calls to helpers");
+}
+
 bool CPUStateAccessAnalysis::run() {
 
   if (CPUStatePtr == nullptr)
@@ -3172,6 +3258,9 @@ bool CPUStateAccessAnalysis::run() {
   Function *RootFunction = M.getFunction("root");
   revng_assert(RootFunction);
 
+  if (Lazy)
+    reuseEquivalentResults(RootFunction);
+
   // Preprocessing: detect all the functions that are directly reachable from
   // the RootFunction
   auto ReachedFunctions = computeDirectlyReachableFunctions(RootFunction,
@@ -8,7 +8,9 @@
 
 #include <cstring>
 #include <fstream>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <queue>
 #include <set>
 #include <sstream>
@@ -18,6 +20,7 @@
 
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/ExecutionEngine/RuntimeDyld.h"
 #include "llvm/IR/CFG.h"
 #include "llvm/IR/DiagnosticPrinter.h"
@@ -29,6 +32,10 @@
 #include "llvm/IRReader/IRReader.h"
 #include "llvm/Linker/Linker.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/Progress.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/raw_os_ostream.h"
@@ -44,10 +51,13 @@
 #include "revng/Model/Architecture.h"
 #include "revng/Model/Importer/DebugInfo/DwarfImporter.h"
 #include "revng/Model/RawBinaryView.h"
+#include "revng/Pipeline/ArtifactCache.h"
 #include "revng/Support/CommandLine.h"
 #include "revng/Support/Debug.h"
 #include "revng/Support/FunctionTags.h"
+#include "revng/Support/PathList.h"
 #include "revng/Support/ProgramCounterHandler.h"
+#include "revng/Support/ResourceFinder.h"
 
 #include "CodeGenerator.h"
 #include "ExternalJumpsHandler.h"
@@ -66,9 +76,188 @@ static cl::opt<bool> RecordPTC("record-ptc",
                                cl::desc("create metadata for PTC"),
                                cl::cat(MainCategory));
 
+static cl::opt<std::string> TranslationRange("translation-range",
+                                             cl::desc("translate only the code "
+                                                      "in [start, end), "
+                                                      "dumping its PTC and "
+                                                      "recording PTC "
+                                                      "metadata, to debug the "
+                                                      "translation of a few "
+                                                      "instructions"),
+                                             cl::value_desc("start-end"),
+                                             cl::cat(MainCategory));
+
+static cl::opt<bool> CachePTC("cache-ptc-translations",
+                              cl::desc("reuse the output of libtinycode "
+                                       "across lifting runs in the same "
+                                       "process when the code bytes did not "
+                                       "change"),
+                              cl::cat(MainCategory));
+
+static cl::opt<bool> NoHelpersCache("no-helpers-cache",
+                                    cl::desc("do not reuse the helper module "
+                                             "prepared by previous lifting "
+                                             "runs"),
+                                    cl::cat(MainCategory));
+
+/// Bump this every time the way the helper module is prepared changes
+static constexpr unsigned PreparedHelpersVersion = 1;
+
 static Logger<> PTCLog("ptc");
 static Logger<> Log("lift");
 
+namespace {
+
+/// Cache of the output of `ptc.translate`, shared by all the CodeGenerators of
+/// the process
+///
+/// Lifting the same binary multiple times in the same process (e.g., after
+/// adding a function in the model) translates the same code again: here we
+/// keep the instruction lists produced by libtinycode, along with the code
+/// bytes they have been obtained from, so that, if the bytes did not change,
+/// they can be reused.
+///
+/// \note instruction lists must be freed by the libtinycode instance that
+///       produced them: the cache has to be reset before loading a different
+///       one, see `resetPTCTranslationCache`.
+class PTCTranslationCache {
+private:
+  /// Stop caching new entries after this many, to bound memory usage
+  static constexpr size_t MaxEntries = 1 << 16;
+
+  struct Entry {
+    std::vector<uint8_t> Code;
+    PTCInstructionListPtr Instructions;
+  };
+
+private:
+  model::Architecture::Values Architecture = model::Architecture::Invalid;
+  std::map<MetaAddress, Entry> Entries;
+
+public:
+  void reset(model::Architecture::Values NewArchitecture) {
+    if (NewArchitecture != Architecture)
+      Entries.clear();
+    Architecture = NewArchitecture;
+  }
+
+  /// \return the instruction list for \p Address, if the code it has been
+  ///         obtained from matches the current content of \p RawBinary. In
+  ///         this case, \p Size is set to the size of such code.
+  PTCInstructionList *get(const RawBinaryView &RawBinary,
+                          MetaAddress Address,
+                          uint64_t &Size) const {
+    auto It = Entries.find(Address);
+    if (It == Entries.end())
+      return nullptr;
+
+    const Entry &Cached = It->second;
+    auto MaybeCode = RawBinary.getByAddress(Address, Cached.Code.size());
+    if (not MaybeCode or *MaybeCode != llvm::ArrayRef<uint8_t>(Cached.Code))
+      return nullptr;
+
+    Size = Cached.Code.size();
+    return Cached.Instructions.get();
+  }
+
+  /// Record \p Instructions, obtained translating \p Size bytes starting at
+  /// \p Address
+  ///
+  /// \return the instruction list, owned by the cache if it has been cached
+  PTCInstructionList *insert(const RawBinaryView &RawBinary,
+                             MetaAddress Address,
+                             uint64_t Size,
+                             PTCInstructionListPtr &Instructions) {
+    if (Entries.size() >= MaxEntries)
+      return Instructions.get();
+
+    // Translations of code that is not backed by the binary (e.g., crossing
+    // into the padding we map after code segments) cannot be validated
+    auto MaybeCode = RawBinary.getByAddress(Address, Size);
+    if (not MaybeCode)
+      return Instructions.get();
+
+    Entry &NewEntry = Entries[Address];
+    NewEntry.Code.assign(MaybeCode->begin(), MaybeCode->end());
+    NewEntry.Instructions = std::move(Instructions);
+    return NewEntry.Instructions.get();
+  }
+};
+
+/// Bitcode of the modules loaded by the CodeGenerators of the process
+///
+/// Modules cannot be shared across LLVMContexts, but parsing bitcode from
+/// memory is much cheaper than reading and preparing the helpers, or parsing
+/// textual IR, again: this matters for processes lifting many binaries.
+class InMemoryModules {
+private:
+  std::mutex Mutex;
+  std::map<std::string, std::shared_ptr<const std::string>> Entries;
+
+public:
+  /// \return a key identifying the current version of the file at \p Path,
+  ///         or an empty string if it cannot be determined
+  static std::string key(StringRef Kind, StringRef Path) {
+    sys::fs::file_status Status;
+    if (sys::fs::status(Path, Status))
+      return "";
+
+    auto ModificationTime = Status.getLastModificationTime().time_since_epoch();
+    return (Kind + ":" + Path + ":" + Twine(Status.getSize()) + ":"
+            + Twine(ModificationTime.count()))
+      .str();
+  }
+
+  std::unique_ptr<Module> get(const std::string &Key, LLVMContext &Context) {
+    std::shared_ptr<const std::string> Bitcode;
+    {
+      std::lock_guard Lock(Mutex);
+      auto It = Entries.find(Key);
+      if (It == Entries.end())
+        return nullptr;
+      Bitcode = It->second;
+    }
+
+    SMDiagnostic Errors;
+    return llvm::parseIR(MemoryBufferRef(*Bitcode, Key), Errors, Context);
+  }
+
+  void insert(const std::string &Key, const Module &M) {
+    auto Bitcode = std::make_shared<std::string>();
+    raw_string_ostream Stream(*Bitcode);
+    WriteBitcodeToFile(M, Stream);
+    Stream.flush();
+
+    std::lock_guard Lock(Mutex);
+    Entries[Key] = std::move(Bitcode);
+  }
+};
+
+} // namespace
+
+static PTCTranslationCache TranslationCache;
+
+static InMemoryModules LoadedModules;
+
+/// Parse -translation-range, if specified
+static std::optional<std::pair<uint64_t, uint64_t>> getTranslationRange() {
+  if (TranslationRange.empty())
+    return std::nullopt;
+
+  auto [StartString, EndString] = StringRef(TranslationRange).split('-');
+  uint64_t Start = 0;
+  uint64_t End = 0;
+  bool Invalid = StartString.getAsInteger(0, Start)
+                 or EndString.getAsInteger(0, End);
+  revng_check(not Invalid and Start < End,
+              "-translation-range expects start-end, with start < end");
+  return std::make_pair(Start, End);
+}
+
+void resetPTCTranslationCache(model::Architecture::Values Architecture) {
+  TranslationCache.reset(Architecture);
+}
+
 template<typename T, typename... ArgTypes>
 inline std::array<T, sizeof...(ArgTypes)> make_array(ArgTypes &&...Args) {
   return { { std::forward<ArgTypes>(Args)... } };
@@ -144,6 +333,23 @@ static std::unique_ptr<Module> parseIR(StringRef Path, LLVMContext &Context) {
   return Result;
 }
 
+static std::unique_ptr<Module> loadHelpers(StringRef Path,
+                                           LLVMContext &Context);
+
+static std::unique_ptr<Module> loadEarlyLinked(StringRef Path,
+                                               LLVMContext &Context) {
+  std::string Key = InMemoryModules::key("early-linked", Path);
+  if (not Key.empty())
+    if (auto Result = LoadedModules.get(Key, Context))
+      return Result;
+
+  std::unique_ptr<Module> Result = parseIR(Path, Context);
+  if (not Key.empty())
+    LoadedModules.insert(Key, *Result);
+
+  return Result;
+}
+
 CodeGenerator::CodeGenerator(const RawBinaryView &RawBinary,
                              llvm::Module *TheModule,
                              const TupleTree<model::Binary> &Model,
@@ -159,7 +365,7 @@ CodeGenerator::CodeGenerator(const RawBinaryView &RawBinary,
   OriginalInstrMDKind = Context.getMDKindID("oi");
   PTCInstrMDKind = Context.getMDKindID("pi");
 
-  HelpersModule = parseIR(Helpers, Context);
+  HelpersModule = loadHelpers(Helpers, Context);
 
   TheModule->setDataLayout(HelpersModule->getDataLayout());
 
@@ -180,7 +386,7 @@ CodeGenerator::CodeGenerator(const RawBinaryView &RawBinary,
       FunctionTags::Exceptional.addTo(&F);
   }
 
-  EarlyLinkedModule = parseIR(EarlyLinked, Context);
+  EarlyLinkedModule = loadEarlyLinked(EarlyLinked, Context);
   for (llvm::Function &F : *EarlyLinkedModule) {
     if (F.isIntrinsic())
       continue;
@@ -201,16 +407,25 @@ CodeGenerator::CodeGenerator(const RawBinaryView &RawBinary,
   for (auto &[Segment, Data] : RawBinary.segments()) {
     // If it's executable register it as a valid code area
     if (Segment.IsExecutable()) {
-      // We ignore possible p_filesz-p_memsz mismatches, zeros wouldn't be
-      // useful code anyway
       uint64_t Size = Segment.VirtualSize();
       revng_log(Log,
                 "mmap'ing segment starting at "
                   << Segment.StartAddress().toString() << " with size 0x"
                   << Size);
-      bool Success = ptc.mmap(Segment.StartAddress().address(),
-                              static_cast<const void *>(Data.data()),
-                              Size);
+
+      // Data only covers the part of the segment backed by the file: in the
+      // (unusual) case of an executable segment with p_filesz < p_memsz,
+      // synthesize the trailing zeros instead of reading past it
+      const void *Source = Data.data();
+      std::vector<uint8_t> ZeroExtended;
+      if (Data.size() < Size) {
+        ZeroExtended.resize(Size);
+        bool Success = RawBinary.read(Segment.StartAddress(), ZeroExtended);
+        revng_assert(Success);
+        Source = ZeroExtended.data();
+      }
+
+      bool Success = ptc.mmap(Segment.StartAddress().address(), Source, Size);
       if (not Success) {
         revng_log(Log, "Couldn't mmap segment!");
         continue;
@@ -301,6 +516,160 @@ char CpuLoopFunctionPass::ID = 0;
 using RegisterCLF = RegisterPass<CpuLoopFunctionPass>;
 static RegisterCLF Y("cpu-loop", "cpu_loop FunctionPass", false, false);
 
+/// Prepare the helper module for linking by transforming the cpu_loop function,
+/// running SROA and replacing the QEMU functions we cannot support
+static void prepareHelpers(Module &HelpersModule) {
+  LLVMContext &Context = HelpersModule.getContext();
+
+  legacy::PassManager CpuLoopPM;
+  CpuLoopPM.add(new LoopInfoWrapperPass());
+  CpuLoopPM.add(new CpuLoopFunctionPass(ptc.exception_index));
+  CpuLoopPM.add(createSROAPass());
+  CpuLoopPM.run(HelpersModule);
+
+  // Drop the main
+  eraseFromParent(HelpersModule.getFunction("main"));
+
+  //
+  // Handle some specific QEMU functions as no-ops or abort
+  //
+
+  // Transform in no op
+  auto NoOpFunctionNames = make_array<const char *>("cpu_dump_state",
+                                                    "cpu_exit",
+                                                    "end_exclusive"
+                                                    "fprintf",
+                                                    "mmap_lock",
+                                                    "mmap_unlock",
+                                                    "pthread_cond_broadcast",
+                                                    "pthread_mutex_unlock",
+                                                    "pthread_mutex_lock",
+                                                    "pthread_cond_wait",
+                                                    "pthread_cond_signal",
+                                                    "process_pending_signals",
+                                                    "qemu_log_mask",
+                                                    "qemu_thread_atexit_init",
+                                                    "start_exclusive");
+  for (auto Name : NoOpFunctionNames)
+    replaceFunctionWithRet(HelpersModule.getFunction(Name), 0);
+
+  // Transform in abort
+
+  // do_arm_semihosting: we don't care about semihosting
+  // EmulateAll: requires access to the opcode
+  auto AbortFunctionNames = make_array<const char *>("cpu_restore_state",
+                                                     "cpu_mips_exec",
+                                                     "gdb_handlesig",
+                                                     "queue_signal",
+                                                     // syscall.c
+                                                     "do_ioctl_dm",
+                                                     "print_syscall",
+                                                     "print_syscall_ret",
+                                                     // ARM cpu_loop
+                                                     "cpu_abort",
+                                                     "do_arm_semihosting",
+                                                     "EmulateAll");
+  for (auto Name : AbortFunctionNames) {
+    Function *TheFunction = HelpersModule.getFunction(Name);
+    if (TheFunction != nullptr) {
+      revng_assert(HelpersModule.getFunction("abort") != nullptr);
+      BasicBlock *NewBody = replaceFunction(TheFunction);
+      CallInst::Create(HelpersModule.getFunction("abort"), {}, NewBody);
+      new UnreachableInst(Context, NewBody);
+    }
+  }
+
+  replaceFunctionWithRet(HelpersModule.getFunction("page_check_range"), 1);
+  replaceFunctionWithRet(HelpersModule.getFunction("page_get_flags"),
+                         0xffffffff);
+}
+
+/// Load the helper module at \p Path and prepare it for linking
+///
+/// Preparing the helper module takes a significant amount of time, but its
+/// result only depends on the helper module itself and on the version of
+/// revng: the prepared module is stored as bitcode in the cache directory and
+/// reused by the following runs.
+static std::unique_ptr<Module> loadHelpers(StringRef Path,
+                                           LLVMContext &Context) {
+  if (NoHelpersCache) {
+    std::unique_ptr<Module> Result = parseIR(Path, Context);
+    prepareHelpers(*Result);
+    return Result;
+  }
+
+  // Look for a module prepared by this process first
+  std::string InMemoryKey = InMemoryModules::key("helpers", Path);
+  if (not InMemoryKey.empty()) {
+    InMemoryKey += ":" + std::to_string(ptc.exception_index);
+    if (auto Result = LoadedModules.get(InMemoryKey, Context)) {
+      revng_log(Log, "Reusing the helper module prepared by this process");
+      return Result;
+    }
+  }
+
+  auto RememberInMemory = [&InMemoryKey](const Module &Prepared) {
+    if (not InMemoryKey.empty())
+      LoadedModules.insert(InMemoryKey, Prepared);
+  };
+
+  auto MaybeBuffer = MemoryBuffer::getFile(Path,
+                                           /* IsText */ false,
+                                           /* RequiresNullTerminator */ false);
+  revng_assert(MaybeBuffer, "Cannot read the helper module");
+  MemoryBufferRef Buffer = (*MaybeBuffer)->getMemBufferRef();
+
+  pipeline::ArtifactCache::KeyBuilder Builder;
+  Builder.addField(revng::getComponentsHash());
+  Builder.addField(std::to_string(ptc.exception_index));
+  Builder.addField(Buffer.getBuffer());
+  std::string FileName = ("helpers-v" + Twine(PreparedHelpersVersion) + "-"
+                          + Builder.finalize() + ".bc")
+                           .str();
+  std::string CachePath = joinPath(getCacheDirectory(), "helpers", FileName);
+
+  if (sys::fs::exists(CachePath)) {
+    SMDiagnostic Errors;
+    if (auto Result = parseIRFile(CachePath, Errors, Context)) {
+      revng_log(Log, "Reusing the prepared helper module " << CachePath);
+      RememberInMemory(*Result);
+      return Result;
+    }
+
+    revng_log(Log, "Ignoring malformed prepared helper module " << CachePath);
+  }
+
+  SMDiagnostic Errors;
+  std::unique_ptr<Module> Result = llvm::parseIR(Buffer, Errors, Context);
+  if (Result == nullptr) {
+    Errors.print("revng", dbgs());
+    revng_abort();
+  }
+
+  prepareHelpers(*Result);
+  RememberInMemory(*Result);
+
+  auto Directory = sys::path::parent_path(CachePath);
+  if (auto EC = sys::fs::create_directories(Directory)) {
+    revng_log(Log, "Unable to create the directory of " << CachePath);
+    return Result;
+  }
+
+  // Write to a temporary file first, so that concurrent runs never observe a
+  // partially written module
+  auto Write = [&Result](raw_ostream &Stream) {
+    WriteBitcodeToFile(*Result, Stream);
+    return Error::success();
+  };
+  std::string TemporaryPath = CachePath + ".tmp-%%%%%%%%";
+  if (auto Error = writeFileAtomically(TemporaryPath, CachePath, Write)) {
+    revng_log(Log, "Unable to write " << CachePath << ": " << Error);
+    consumeError(std::move(Error));
+  }
+
+  return Result;
+}
+
 void CpuLoopFunctionPass::getAnalysisUsage(llvm::AnalysisUsage &AU) const {
   AU.addRequired<LoopInfoWrapperPass>();
 }
@@ -430,6 +799,30 @@ static void purgeNoReturn(Function *F) {
       }
 }
 
+/// For each instruction in \p InstructionList, find the next
+/// `op_debug_insn_start` not in \p ToIgnore, or `nullptr` if there's none
+///
+/// This is computed with a single backward scan so that the translation loop
+/// does not have to look ahead for each guest instruction.
+static std::vector<PTCInstruction *>
+findNextInstructions(PTCInstructionList *InstructionList,
+                     const SmallSet<unsigned, 1> &ToIgnore) {
+  const auto InstructionCount = InstructionList->instruction_count;
+  std::vector<PTCInstruction *> Result(InstructionCount, nullptr);
+
+  PTCInstruction *Next = nullptr;
+  for (unsigned K = InstructionCount; K > 0; --K) {
+    Result[K - 1] = Next;
+
+    PTCInstruction *I = &InstructionList->instructions[K - 1];
+    if (I->opc == PTC_INSTRUCTION_op_debug_insn_start
+        and not ToIgnore.contains(K - 1))
+      Next = I;
+  }
+
+  return Result;
+}
+
 static ReturnInst *createRet(Instruction *Position) {
   Function *F = Position->getParent()->getParent();
   purgeNoReturn(F);
@@ -587,7 +980,7 @@ bool CpuLoopExitPass::runOnModule(llvm::Module &M) {
 void CodeGenerator::translate(optional<uint64_t> RawVirtualAddress) {
   using FT = FunctionType;
 
-  Task T(12, "Translation");
+  Task T(11, "Translation");
 
   // Declare the abort function
   auto *AbortTy = FunctionType::get(Type::getVoidTy(Context), false);
@@ -598,18 +991,6 @@ void CodeGenerator::translate(optional<uint64_t> RawVirtualAddress) {
     FunctionTags::Exceptional.addTo(Abort);
   }
 
-  // Prepare the helper modules by transforming the cpu_loop function and
-  // running SROA
-  T.advance("Prepare helpers module", true);
-  legacy::PassManager CpuLoopPM;
-  CpuLoopPM.add(new LoopInfoWrapperPass());
-  CpuLoopPM.add(new CpuLoopFunctionPass(ptc.exception_index));
-  CpuLoopPM.add(createSROAPass());
-  CpuLoopPM.run(*HelpersModule);
-
-  // Drop the main
-  eraseFromParent(HelpersModule->getFunction("main"));
-
   // From syscall.c
   new GlobalVariable(*TheModule,
                      Type::getInt32Ty(Context),
@@ -618,59 +999,6 @@ void CodeGenerator::translate(optional<uint64_t> RawVirtualAddress) {
                      ConstantInt::get(Type::getInt32Ty(Context), 0),
                      StringRef("do_strace"));
 
-  //
-  // Handle some specific QEMU functions as no-ops or abort
-  //
-
-  // Transform in no op
-  auto NoOpFunctionNames = make_array<const char *>("cpu_dump_state",
-                                                    "cpu_exit",
-                                                    "end_exclusive"
-                                                    "fprintf",
-                                                    "mmap_lock",
-                                                    "mmap_unlock",
-                                                    "pthread_cond_broadcast",
-                                                    "pthread_mutex_unlock",
-                                                    "pthread_mutex_lock",
-                                                    "pthread_cond_wait",
-                                                    "pthread_cond_signal",
-                                                    "process_pending_signals",
-                                                    "qemu_log_mask",
-                                                    "qemu_thread_atexit_init",
-                                                    "start_exclusive");
-  for (auto Name : NoOpFunctionNames)
-    replaceFunctionWithRet(HelpersModule->getFunction(Name), 0);
-
-  // Transform in abort
-
-  // do_arm_semihosting: we don't care about semihosting
-  // EmulateAll: requires access to the opcode
-  auto AbortFunctionNames = make_array<const char *>("cpu_restore_state",
-                                                     "cpu_mips_exec",
-                                                     "gdb_handlesig",
-                                                     "queue_signal",
-                                                     // syscall.c
-                                                     "do_ioctl_dm",
-                                                     "print_syscall",
-                                                     "print_syscall_ret",
-                                                     // ARM cpu_loop
-                                                     "cpu_abort",
-                                                     "do_arm_semihosting",
-                                                     "EmulateAll");
-  for (auto Name : AbortFunctionNames) {
-    Function *TheFunction = HelpersModule->getFunction(Name);
-    if (TheFunction != nullptr) {
-      revng_assert(HelpersModule->getFunction("abort") != nullptr);
-      BasicBlock *NewBody = replaceFunction(TheFunction);
-      CallInst::Create(HelpersModule->getFunction("abort"), {}, NewBody);
-      new UnreachableInst(Context, NewBody);
-    }
-  }
-
-  replaceFunctionWithRet(HelpersModule->getFunction("page_check_range"), 1);
-  replaceFunctionWithRet(HelpersModule->getFunction("page_get_flags"),
-                         0xffffffff);
-
   //
   // Record globals for marking them as internal after linking
   //
@@ -823,8 +1151,20 @@ void CodeGenerator::translate(optional<uint64_t> RawVirtualAddress) {
                                 Model,
                                 RawBinary);
 
+  // When debugging the translation of a range of code, start from it and stay
+  // within it
+  auto Range = getTranslationRange();
+  auto IsInRange = [&Range](MetaAddress Address) {
+    return not Range.has_value()
+           or (Address.address() >= Range->first
+               and Address.address() < Range->second);
+  };
+  bool RecordPTCMetadata = RecordPTC or Range.has_value();
+
   MetaAddress VirtualAddress = MetaAddress::invalid();
-  if (RawVirtualAddress) {
+  if (Range.has_value()) {
+    VirtualAddress = JumpTargets.fromPC(Range->first);
+  } else if (RawVirtualAddress) {
     VirtualAddress = JumpTargets.fromPC(*RawVirtualAddress);
   } else {
     JumpTargets.harvestGlobalData();
@@ -884,7 +1224,8 @@ void CodeGenerator::translate(optional<uint64_t> RawVirtualAddress) {
     Translator.reset();
 
     // TODO: rename this type
-    PTCInstructionListPtr InstructionList(new PTCInstructionList);
+    PTCInstructionListPtr OwnedInstructionList;
+    PTCInstructionList *InstructionList = nullptr;
     uint64_t ConsumedSize = 0;
 
     PTCCodeType Type = PTC_CODE_REGULAR;
@@ -902,10 +1243,42 @@ void CodeGenerator::translate(optional<uint64_t> RawVirtualAddress) {
       break;
     }
 
-    revng_log(Log, "Translating " << VirtualAddress.toString());
-    ConsumedSize = ptc.translate(VirtualAddress.address(),
-                                 Type,
-                                 InstructionList.get());
+    if (not IsInRange(VirtualAddress)) {
+      revng_log(Log,
+                "Not translating " << VirtualAddress.toString()
+                                   << ", outside of the translation range");
+      Translator.emitNewPCCall(Builder, VirtualAddress, 1, nullptr);
+      Builder.CreateCall(AbortFunction);
+      Builder.CreateUnreachable();
+
+      TranslateTask.complete();
+      LiftTask.advance("Peek new address", true);
+      std::tie(VirtualAddress, Entry) = JumpTargets.peek();
+
+      continue;
+    }
+
+    if (CachePTC)
+      InstructionList = TranslationCache.get(RawBinary,
+                                             VirtualAddress,
+                                             ConsumedSize);
+
+    if (InstructionList != nullptr) {
+      revng_log(Log, "Reusing translation of " << VirtualAddress.toString());
+    } else {
+      revng_log(Log, "Translating " << VirtualAddress.toString());
+      OwnedInstructionList.reset(new PTCInstructionList);
+      InstructionList = OwnedInstructionList.get();
+      ConsumedSize = ptc.translate(VirtualAddress.address(),
+                                   Type,
+                                   InstructionList);
+
+      if (CachePTC and ConsumedSize != 0)
+        InstructionList = TranslationCache.insert(RawBinary,
+                                                  VirtualAddress,
+                                                  ConsumedSize,
+                                                  OwnedInstructionList);
+    }
 
     if (ConsumedSize == 0) {
       Translator.emitNewPCCall(Builder, VirtualAddress, 1, nullptr);
@@ -930,15 +1303,18 @@ void CodeGenerator::translate(optional<uint64_t> RawVirtualAddress) {
     }
 
     SmallSet<unsigned, 1> ToIgnore;
-    ToIgnore = Translator.preprocess(InstructionList.get());
+    ToIgnore = Translator.preprocess(InstructionList);
 
-    if (PTCLog.isEnabled()) {
+    if (PTCLog.isEnabled() or Range.has_value()) {
       std::stringstream Stream;
-      dumpTranslation(VirtualAddress, Stream, InstructionList.get());
-      PTCLog << Stream.str() << DoLog;
+      dumpTranslation(VirtualAddress, Stream, InstructionList);
+      if (PTCLog.isEnabled())
+        PTCLog << Stream.str() << DoLog;
+      else
+        dbg << Stream.str();
     }
 
-    Variables.newFunction(InstructionList.get());
+    Variables.newFunction(InstructionList);
     unsigned J = 0;
     MDNode *MDOriginalInstr = nullptr;
     bool StopTranslation = false;
@@ -951,6 +1327,9 @@ void CodeGenerator::translate(optional<uint64_t> RawVirtualAddress) {
     using IT = InstructionTranslator;
     IT::TranslationResult Result;
 
+    auto NextInstructions = findNextInstructions(InstructionList,
+                                                 ToIgnore);
+
     TranslateTask.advance("Translate to LLVM IR", true);
 
     Task TranslateToLLVMTask(InstructionCount + 1, "Translate to LLVM IR");
@@ -958,15 +1337,7 @@ void CodeGenerator::translate(optional<uint64_t> RawVirtualAddress) {
 
     // Handle the first PTC_INSTRUCTION_op_debug_insn_start
     {
-      PTCInstruction *NextInstruction = nullptr;
-      for (unsigned K = 1; K < InstructionCount; K++) {
-        PTCInstruction *I = &InstructionList->instructions[K];
-        if (I->opc == PTC_INSTRUCTION_op_debug_insn_start
-            && !ToIgnore.contains(K)) {
-          NextInstruction = I;
-          break;
-        }
-      }
+      PTCInstruction *NextInstruction = NextInstructions[J];
       PTCInstruction *Instruction = &InstructionList->instructions[J];
       std::tie(Result,
                MDOriginalInstr,
@@ -1005,15 +1376,7 @@ void CodeGenerator::translate(optional<uint64_t> RawVirtualAddress) {
         break;
       case PTC_INSTRUCTION_op_debug_insn_start: {
         // Find next instruction, if there is one
-        PTCInstruction *NextInstruction = nullptr;
-        for (unsigned K = J + 1; K < InstructionCount; K++) {
-          PTCInstruction *I = &InstructionList->instructions[K];
-          if (I->opc == PTC_INSTRUCTION_op_debug_insn_start
-              && !ToIgnore.contains(K)) {
-            NextInstruction = I;
-            break;
-          }
-        }
+        PTCInstruction *NextInstruction = NextInstructions[J];
 
         std::tie(Result,
                  MDOriginalInstr,
@@ -1061,9 +1424,9 @@ void CodeGenerator::translate(optional<uint64_t> RawVirtualAddress) {
       // Create a new metadata referencing the PTC instruction we have just
       // translated
       MDNode *MDPTCInstr = nullptr;
-      if (RecordPTC) {
+      if (RecordPTCMetadata) {
         std::stringstream PTCStringStream;
-        dumpInstruction(PTCStringStream, InstructionList.get(), J);
+        dumpInstruction(PTCStringStream, InstructionList, J);
         std::string PTCString = PTCStringStream.str() + "\n";
         MDString *MDPTCString = MDString::get(Context, PTCString);
         MDPTCInstr = MDNode::getDistinct(Context, MDPTCString);
@@ -26,6 +26,12 @@ class DataLayout;
 
 }; // namespace llvm
 
+/// Drop the translations cached by previous runs of `CodeGenerator` if they
+/// have been produced for an architecture other than \p Architecture
+///
+/// \note this has to be called before loading libtinycode.
+void resetPTCTranslationCache(model::Architecture::Values Architecture);
+
 /// Translator from binary code to LLVM IR.
 class CodeGenerator {
 public:
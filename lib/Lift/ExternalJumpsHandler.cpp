@@ -6,7 +6,9 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <algorithm>
 #include <string>
+#include <utility>
 
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Triple.h"
@@ -219,14 +221,28 @@ llvm::BasicBlock *ExternalJumpsHandler::createSetjmp(BasicBlock *FirstReturn,
 void ExternalJumpsHandler::buildExecutableSegmentsList() {
   IRBuilder<> Builder(Context);
   IntegerType *Int64 = Builder.getInt64Ty();
-  SmallVector<Constant *, 10> ExecutableSegments;
   auto Int = [Int64](uint64_t V) { return ConstantInt::get(Int64, V); };
+
+  // Collect the ranges sorted by start address and merge those overlapping or
+  // adjacent, so that is_executable can perform a binary search
+  SmallVector<std::pair<uint64_t, uint64_t>, 5> Ranges;
   for (auto &Segment : Model.Segments()) {
     if (Segment.IsExecutable()) {
-      ExecutableSegments.push_back(Int(Segment.StartAddress().address()));
-      ExecutableSegments.push_back(Int(Segment.endAddress().address()));
+      Ranges.emplace_back(Segment.StartAddress().address(),
+                          Segment.endAddress().address());
     }
   }
+  llvm::sort(Ranges);
+
+  SmallVector<Constant *, 10> ExecutableSegments;
+  for (size_t I = 0; I < Ranges.size();) {
+    auto [Start, End] = Ranges[I];
+    for (++I; I < Ranges.size() and Ranges[I].first <= End; ++I)
+      End = std::max(End, Ranges[I].second);
+
+    ExecutableSegments.push_back(Int(Start));
+    ExecutableSegments.push_back(Int(End));
+  }
 
   auto *SegmentsType = ArrayType::get(Int64, ExecutableSegments.size());
   auto *SegmentsArray = ConstantArray::get(SegmentsType, ExecutableSegments);
@@ -75,11 +75,15 @@ private:
   /// This method creates three global variables:
   ///
   /// * an unnamed array of uint64_t large as twice the number of executable
-  ///   segments, where the even entries contain the start address of a segment
+  ///   ranges, where the even entries contain the start address of a range
   ///   and odd ones the end address.
   /// * "segment_boundaries": a `uint64_t *` targeting the previous array.
   /// * "segments_count": an uint64_t containing the number of executable
-  ///   segments.
+  ///   ranges.
+  ///
+  /// The ranges are the executable segments sorted by start address, with
+  /// overlapping or adjacent segments merged, so that they can be binary
+  /// searched.
   void buildExecutableSegmentsList();
 
   /// Creates the basic block taking care of deserializing the CPU state to
@@ -337,8 +337,6 @@ bool TDBP::runOnModule(Module &M) {
 MaterializedValue JumpTargetManager::readFromPointer(MetaAddress LoadAddress,
                                                      unsigned LoadSize,
                                                      bool IsLittleEndian) {
-  auto NewAPInt = [LoadSize](uint64_t V) { return APInt(LoadSize * 8, V); };
-
   UnusedCodePointers.erase(LoadAddress);
 
   // Prevent overflow when computing the label interval
@@ -348,6 +346,26 @@ MaterializedValue JumpTargetManager::readFromPointer(MetaAddress LoadAddress,
 
   registerReadRange(LoadAddress, EndAddress);
 
+  // The same locations (e.g., the entries of a jump table) are read again in
+  // each harvesting iteration, avoid going through relocations and segments
+  auto Key = std::make_tuple(LoadAddress, LoadSize, IsLittleEndian);
+  auto It = ReadCache.find(Key);
+  if (It != ReadCache.end())
+    return It->second;
+
+  MaterializedValue Result = readFromPointerImpl(LoadAddress,
+                                                 LoadSize,
+                                                 IsLittleEndian);
+  ReadCache[Key] = Result;
+  return Result;
+}
+
+MaterializedValue
+JumpTargetManager::readFromPointerImpl(MetaAddress LoadAddress,
+                                       unsigned LoadSize,
+                                       bool IsLittleEndian) const {
+  auto NewAPInt = [LoadSize](uint64_t V) { return APInt(LoadSize * 8, V); };
+
   //
   // Check relocations
   //
@@ -548,9 +566,11 @@ BasicBlock *JumpTargetManager::newPC(MetaAddress PC, bool &ShouldContinue) {
   auto JTIt = JumpTargets.find(PC);
   if (JTIt != JumpTargets.end()) {
     // If it was planned to explore it in the future, just to do it now
-    for (auto UnexploredIt = Unexplored.begin();
-         UnexploredIt != Unexplored.end();
-         UnexploredIt++) {
+    auto UnexploredIt = Unexplored.begin();
+    if (not UnexploredPCs.contains(PC))
+      UnexploredIt = Unexplored.end();
+
+    for (; UnexploredIt != Unexplored.end(); UnexploredIt++) {
 
       if (UnexploredIt->first == PC) {
         BasicBlock *Result = UnexploredIt->second;
@@ -560,6 +580,7 @@ BasicBlock *JumpTargetManager::newPC(MetaAddress PC, bool &ShouldContinue) {
         if (ShouldContinue) {
           // We don't, OK let's explore it next
           Unexplored.erase(UnexploredIt);
+          UnexploredPCs.erase(UnexploredPCs.find(PC));
         } else {
           // We do, it will be purged at the next `peek`
           revng_assert(ToPurge.contains(Result));
@@ -791,6 +812,7 @@ JumpTargetManager::BlockWithAddress JumpTargetManager::peek() {
   } else {
     BlockWithAddress Result = Unexplored.back();
     Unexplored.pop_back();
+    UnexploredPCs.erase(UnexploredPCs.find(Result.first));
     return Result;
   }
 }
@@ -912,6 +934,7 @@ BasicBlock *JumpTargetManager::registerJT(MetaAddress PC,
   }
 
   Unexplored.push_back(BlockWithAddress(PC, NewBlock));
+  UnexploredPCs.insert(PC);
 
   std::stringstream Name;
   Name << "bb." << nameForAddress(PC);
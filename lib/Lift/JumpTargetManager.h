@@ -6,6 +6,8 @@
 
 #include <cstdint>
 #include <map>
+#include <tuple>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -406,6 +408,11 @@ public:
     return Pair.first + Pair.second;
   }
 
+  /// Read \p LoadSize bytes at \p LoadAddress, taking into account
+  /// relocations
+  ///
+  /// \note The results are memoized for the whole lifting process: segments
+  ///       and relocations do not change while harvesting.
   MaterializedValue readFromPointer(MetaAddress LoadAddress,
                                     unsigned LoadSize,
                                     bool IsLittleEndian);
@@ -576,8 +583,13 @@ private:
 
   llvm::CallInst *getJumpTarget(llvm::BasicBlock *Target);
 
+  MaterializedValue readFromPointerImpl(MetaAddress LoadAddress,
+                                        unsigned LoadSize,
+                                        bool IsLittleEndian) const;
+
 private:
-  using InstructionMap = std::map<MetaAddress, llvm::Instruction *>;
+  /// \note this is only used for exact lookups, no need to keep it sorted
+  using InstructionMap = std::unordered_map<MetaAddress, llvm::Instruction *>;
 
   llvm::Module &TheModule;
   llvm::LLVMContext &Context;
@@ -589,6 +601,8 @@ private:
   BlockMap JumpTargets;
   /// Queue of program counters we still have to translate.
   std::vector<BlockWithAddress> Unexplored;
+  /// The program counters in `Unexplored`, to avoid scanning it in `newPC`.
+  std::unordered_multiset<MetaAddress> UnexploredPCs;
 
   llvm::Function *ExitTB;
   MetaAddressRangeSet ExecutableRanges;
@@ -603,6 +617,9 @@ private:
 
   std::set<MetaAddress> UnusedCodePointers;
   interval_set ReadIntervalSet;
+  /// (address, size, little endian) -> value read by readFromPointer
+  std::map<std::tuple<MetaAddress, unsigned, bool>, MaterializedValue>
+    ReadCache;
 
   CFGForm::Values CurrentCFGForm;
   std::set<llvm::BasicBlock *> ToPurge;
@@ -122,6 +122,7 @@ bool LiftPass::runOnModule(llvm::Module &M) {
 
   // Load the appropriate libtyncode version
   T.advance("loadPTC", false);
+  resetPTCTranslationCache(Model->Architecture());
   LibraryPointer PTCLibrary;
   if (loadPTCLibrary(PTCLibrary) != EXIT_SUCCESS)
     return EXIT_FAILURE;
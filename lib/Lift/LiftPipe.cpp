@@ -15,6 +15,7 @@ extern "C" {
 #include "revng/Lift/Lift.h"
 #include "revng/Lift/LiftPipe.h"
 #include "revng/Model/LoadModelPass.h"
+#include "revng/Model/RawBinaryView.h"
 #include "revng/Pipeline/AllRegistries.h"
 #include "revng/Pipes/FileContainer.h"
 #include "revng/Pipes/Kinds.h"
@@ -22,12 +23,60 @@ extern "C" {
 #include "revng/Pipes/RootKind.h"
 #include "revng/Support/IRAnnotators.h"
 #include "revng/Support/IRHelpers.h"
+#include "revng/Support/MetaAddress/MetaAddressRangeSet.h"
 #include "revng/Support/ResourceFinder.h"
 
 using namespace llvm;
 using namespace pipeline;
 using namespace ::revng::pipes;
 
+/// Name of the named metadata recording the executable ranges of the binary at
+/// the time it has been lifted
+static constexpr const char *ExecutableRangesMDName = "revng.executable-ranges";
+
+/// Record \p Ranges in \p M, so that invalidation can tell if an address would
+/// have been considered by JumpTargetManager without having the model at hand
+static void recordExecutableRanges(Module &M,
+                                   const MetaAddressRangeSet &Ranges) {
+  LLVMContext &Context = M.getContext();
+  NamedMDNode *RangesMD = M.getOrInsertNamedMetadata(ExecutableRangesMDName);
+  RangesMD->clearOperands();
+  for (const auto &[Start, End] : Ranges) {
+    RangesMD->addOperand(MDTuple::get(Context,
+                                      { MDString::get(Context,
+                                                      Start.toString()),
+                                        MDString::get(Context,
+                                                      End.toString()) }));
+  }
+}
+
+/// \return the ranges recorded by `recordExecutableRanges`, if any
+static std::optional<MetaAddressRangeSet>
+readExecutableRanges(const Module &M) {
+  NamedMDNode *RangesMD = M.getNamedMetadata(ExecutableRangesMDName);
+  if (RangesMD == nullptr)
+    return std::nullopt;
+
+  MetaAddressRangeSet Result;
+  for (const MDNode *Range : RangesMD->operands()) {
+    if (Range->getNumOperands() != 2)
+      return std::nullopt;
+
+    auto *StartMD = dyn_cast<MDString>(Range->getOperand(0));
+    auto *EndMD = dyn_cast<MDString>(Range->getOperand(1));
+    if (StartMD == nullptr or EndMD == nullptr)
+      return std::nullopt;
+
+    auto Start = MetaAddress::fromString(StartMD->getString());
+    auto End = MetaAddress::fromString(EndMD->getString());
+    if (not Start.isValid() or not End.isValid())
+      return std::nullopt;
+    Result.add(Start, End);
+  }
+
+  return Result;
+}
+
 void Lift::run(ExecutionContext &EC,
                const BinaryFileContainer &SourceBinary,
                LLVMContainer &Output) {
@@ -36,7 +85,7 @@ void Lift::run(ExecutionContext &EC,
 
   const TupleTree<model::Binary> &Model = getModelFromContext(EC);
 
-  auto BufferOrError = MemoryBuffer::getFileOrSTDIN(*SourceBinary.path());
+  auto BufferOrError = mapBinaryFile(*SourceBinary.path());
   auto Buffer = cantFail(errorOrToExpected(std::move(BufferOrError)));
   RawBinaryView RawBinary(*Model, Buffer->getBuffer());
 
@@ -48,6 +97,8 @@ void Lift::run(ExecutionContext &EC,
   PM.add(new LiftPass);
   PM.run(Output.getModule());
 
+  recordExecutableRanges(Output.getModule(), Model->executableRanges());
+
   EC.commitUniqueTarget(Output);
 }
 
@@ -92,6 +143,15 @@ Lift::invalidate(const BinaryFileContainer &SourceBinary,
     }
   }
 
+  // Addresses outside of the executable ranges are ignored by
+  // JumpTargetManager, adding a function there does not affect the lifted code
+  std::optional<MetaAddressRangeSet>
+    ExecutableRanges = readExecutableRanges(ModuleContainer.getModule());
+  auto IsIgnoredByLifter = [&ExecutableRanges](const MetaAddress &Address) {
+    return ExecutableRanges.has_value() and Address.isValid()
+           and not ExecutableRanges->contains(Address);
+  };
+
   // Inspect the diff looking for newly added model::Functions
   auto *ModelDiff = Diff.getAs<model::Binary>();
   revng_assert(ModelDiff != nullptr);
@@ -117,7 +177,8 @@ Lift::invalidate(const BinaryFileContainer &SourceBinary,
         bool IsJumpTarget = It != JumpTargets.end();
         bool DependsOnModelFunction = IsJumpTarget and It->second;
 
-        if (IsAddition and not IsJumpTarget) {
+        if (IsAddition and not IsJumpTarget
+            and not IsIgnoredByLifter(ChangedAddress)) {
           // We're adding a function that was not a jump target
           return InvalidateResult;
         } else if (IsRemoval and DependsOnModelFunction) {
@@ -32,7 +32,7 @@ llvm::Expected<std::pair<RawBinaryView, std::unique_ptr<llvm::MemoryBuffer>>>
 loadBinary(const model::Binary &Model, llvm::StringRef BinaryPath) {
   revng_assert(Model.verify(true));
 
-  auto FileContentsBuffer = llvm::MemoryBuffer::getFileOrSTDIN(BinaryPath);
+  auto FileContentsBuffer = mapBinaryFile(BinaryPath);
   if (auto ErrorCode = FileContentsBuffer.getError())
     return llvm::errorCodeToError(std::move(ErrorCode));
 
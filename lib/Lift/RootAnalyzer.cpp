@@ -512,18 +512,49 @@ RootAnalyzer::promoteCSVsToAlloca(Function *OptimizedFunction) {
   IRBuilder<> AllocaBuilder(&*EntryBB->begin());
   IRBuilder<> InitializeBuilder(EntryBB->getTerminator());
 
-  for (GlobalVariable *CSV : toSortedByName(NonPCCSVs)) {
+  auto SortedCSVs = toSortedByName(NonPCCSVs);
+  for (GlobalVariable *CSV : SortedCSVs) {
     Type *CSVType = CSV->getValueType();
     auto *Alloca = AllocaBuilder.CreateAlloca(CSVType, nullptr, CSV->getName());
     CSVMap[CSV] = Alloca;
+  }
+
+  // Replace all uses of the CSVs within OptimizedFunction with the allocas.
+  // Note: we visit OptimizedFunction once instead of going through the uses
+  //       of each CSV, since most of them are in the root function, which
+  //       keeps growing at each harvesting iteration.
+  for (Instruction &I : llvm::instructions(OptimizedFunction)) {
+    for (Use &U : I.operands()) {
+      auto *CE = dyn_cast<ConstantExpr>(U.get());
+      bool IsCast = CE != nullptr and CE->isCast();
+      Value *Operand = IsCast ? CE->getOperand(0) : U.get();
+
+      auto *CSV = dyn_cast<GlobalVariable>(Operand);
+      if (CSV == nullptr)
+        continue;
 
-    // Replace all uses of the CSV within OptimizedFunction with the alloca
-    replaceAllUsesInFunctionWith(OptimizedFunction, CSV, Alloca);
+      auto It = CSVMap.find(CSV);
+      if (It == CSVMap.end())
+        continue;
 
-    // Initialize the alloca
-    InitializeBuilder.CreateStore(createLoad(InitializeBuilder, CSV), Alloca);
+      if (IsCast) {
+        // The ConstantExpr might be used outside of OptimizedFunction: create
+        // an equivalent instruction and use the alloca only there
+        Instruction *Cast = CE->getAsInstruction();
+        Cast->replaceUsesOfWith(CSV, It->second);
+        Cast->insertBefore(&I);
+        U.set(Cast);
+      } else {
+        U.set(It->second);
+      }
+    }
   }
 
+  // Initialize the allocas
+  for (GlobalVariable *CSV : SortedCSVs)
+    InitializeBuilder.CreateStore(createLoad(InitializeBuilder, CSV),
+                                  CSVMap[CSV]);
+
   return CSVMap;
 }
 
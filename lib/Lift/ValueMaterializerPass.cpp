@@ -4,6 +4,10 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <map>
+#include <optional>
+#include <tuple>
+
 #include "llvm/Analysis/LazyValueInfo.h"
 #include "llvm/Analysis/ValueTracking.h"
 #include "llvm/Support/CommandLine.h"
@@ -93,6 +97,12 @@ PreservedAnalyses ValueMaterializerPass::run(Function &F,
     return cast<ConstantInt>(Call->getArgOperand(Index))->getLimitedValue();
   };
 
+  // Different markers often ask for the same value in the same basic block
+  // (e.g., a load and the indirect jump using its result): the oracles only
+  // take into account the block of the context, so we can reuse the results
+  using QueryKey = std::tuple<Value *, BasicBlock *, uint64_t, uint64_t, int>;
+  std::map<QueryKey, MaterializedValues> Memoized;
+
   for (CallBase *Call : callersIn(Marker, &F)) {
     // Decode arguments
     revng_assert(Call->arg_size() >= 4);
@@ -108,20 +118,31 @@ PreservedAnalyses ValueMaterializerPass::run(Function &F,
     revng_assert(Address.isValid());
     uint64_t CurrentAddress = Address.address();
 
+    bool Dump = (DumpValueMaterializer
+                 or count(DumpValueMaterializerAt, CurrentAddress) > 0);
+
+    QueryKey Key = { ToTrack, Call->getParent(), MaxPhiLike, MaxLoad, Oracle };
+    auto MemoizedIt = Memoized.find(Key);
+
     MaterializedValues Values;
-    DataFlowGraph::Limits Limits(MaxPhiLike, MaxLoad);
-    auto Results = ValueMaterializer::getValuesFor(Call,
-                                                   ToTrack,
-                                                   MO,
-                                                   LVI,
-                                                   DT,
-                                                   Limits,
-                                                   Oracle);
-    if (Results.values())
-      Values = std::move(*Results.values());
-
-    if (DumpValueMaterializer
-        or count(DumpValueMaterializerAt, CurrentAddress) > 0) {
+    std::optional<ValueMaterializer> Results;
+    if (MemoizedIt != Memoized.end() and not Dump) {
+      Values = MemoizedIt->second;
+    } else {
+      DataFlowGraph::Limits Limits(MaxPhiLike, MaxLoad);
+      Results.emplace(ValueMaterializer::getValuesFor(Call,
+                                                      ToTrack,
+                                                      MO,
+                                                      LVI,
+                                                      DT,
+                                                      Limits,
+                                                      Oracle));
+      if (Results->values())
+        Values = *Results->values();
+      Memoized[Key] = Values;
+    }
+
+    if (Dump) {
       // User asked to dump information about this address
       dbg << "Values produced by ValueMaterializer for " << getName(ToTrack)
           << " at " << Address.toString() << ":\n";
@@ -132,8 +153,8 @@ PreservedAnalyses ValueMaterializerPass::run(Function &F,
       }
 
       dbg << "Dumping graphs\n";
-      Results.dataFlowGraph().dump();
-      AdvancedValueInfoMFI::dump(&Results.cfeg(), Results.mfiResult());
+      Results->dataFlowGraph().dump();
+      AdvancedValueInfoMFI::dump(&Results->cfeg(), Results->mfiResult());
     }
 
     //
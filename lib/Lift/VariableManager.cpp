@@ -151,6 +151,82 @@ getTypeAtOffset(const DataLayout *TheLayout, Type *VarType, intptr_t Offset) {
   }
 }
 
+/// Describe each byte of \p T, which starts at \p Base in \p Table
+static void fillLayoutTable(const DataLayout &Layout,
+                            Type *T,
+                            uint64_t Base,
+                            auto &Table) {
+  uint64_t Size = Layout.getTypeAllocSize(T);
+  revng_assert(Base + Size <= Table.size());
+
+  switch (T->getTypeID()) {
+  case llvm::Type::TypeID::PointerTyID:
+    // Treated like padding, see getTypeAtOffset
+    for (uint64_t I = 0; I < Size; ++I)
+      Table[Base + I] = { nullptr, 0, true };
+    break;
+
+  case llvm::Type::TypeID::IntegerTyID:
+    for (uint64_t I = 0; I < Size; ++I) {
+      auto Remaining = static_cast<uint16_t>(I);
+      Table[Base + I] = { cast<IntegerType>(T), Remaining, true };
+    }
+    break;
+
+  case llvm::Type::TypeID::ArrayTyID: {
+    Type *ElementType = T->getArrayElementType();
+    uint64_t ElementSize = Layout.getTypeAllocSize(ElementType);
+    if (ElementSize == 0)
+      break;
+
+    for (uint64_t I = 0; I < T->getArrayNumElements(); ++I)
+      fillLayoutTable(Layout, ElementType, Base + I * ElementSize, Table);
+  } break;
+
+  case llvm::Type::TypeID::StructTyID: {
+    // Everything not covered by a field is padding
+    for (uint64_t I = 0; I < Size; ++I)
+      Table[Base + I] = { nullptr, 0, true };
+
+    auto *TheStruct = cast<StructType>(T);
+    const StructLayout *StructLayout = Layout.getStructLayout(TheStruct);
+    for (unsigned I = 0; I < TheStruct->getNumElements(); ++I) {
+      uint64_t FieldOffset = StructLayout->getElementOffset(I);
+      fillLayoutTable(Layout,
+                      TheStruct->getElementType(I),
+                      Base + FieldOffset,
+                      Table);
+    }
+  } break;
+
+  default:
+    // Let getTypeAtOffset handle this, if ever needed
+    for (uint64_t I = 0; I < Size; ++I)
+      Table[Base + I] = {};
+    break;
+  }
+}
+
+void VariableManager::buildCPUStateLayoutTable() {
+  CPUStateLayout.clear();
+  if (CPUStateType == nullptr or ModuleLayout == nullptr)
+    return;
+
+  CPUStateLayout.resize(ModuleLayout->getTypeAllocSize(CPUStateType));
+  fillLayoutTable(*ModuleLayout, CPUStateType, 0, CPUStateLayout);
+}
+
+std::pair<IntegerType *, unsigned>
+VariableManager::getTypeAtCPUStateOffset(intptr_t Offset) const {
+  if (Offset >= 0 and static_cast<uint64_t>(Offset) < CPUStateLayout.size()) {
+    const CPUStateByte &Byte = CPUStateLayout[Offset];
+    if (Byte.Known)
+      return { Byte.Type, Byte.Remaining };
+  }
+
+  return getTypeAtOffset(ModuleLayout, CPUStateType, Offset);
+}
+
 VariableManager::VariableManager(Module &M,
                                  bool TargetIsLittleEndian,
                                  StructType *CPUStruct,
@@ -168,6 +244,8 @@ VariableManager::VariableManager(Module &M,
   IntegerType *IntPtrTy = AllocaBuilder.getIntPtrTy(*ModuleLayout);
   Env = cast<GlobalVariable>(TheModule.getOrInsertGlobal("env", IntPtrTy));
   Env->setInitializer(ConstantInt::getNullValue(IntPtrTy));
+
+  buildCPUStateLayoutTable();
 }
 
 std::optional<StoreInst *>
@@ -470,8 +548,7 @@ VariableManager::getByCPUStateOffsetInternal(intptr_t Offset,
           && It->second->getName().startswith(UnknownCSVPref))) {
     Type *VariableType = nullptr;
     unsigned Remaining;
-    std::tie(VariableType,
-             Remaining) = getTypeAtOffset(ModuleLayout, CPUStateType, Offset);
+    std::tie(VariableType, Remaining) = getTypeAtCPUStateOffset(Offset);
 
     // Unsupported type, let the caller handle the situation
     if (VariableType == nullptr)
@@ -7,6 +7,7 @@
 #include <cstdint>
 #include <map>
 #include <string>
+#include <vector>
 
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/Pass.h"
@@ -113,6 +114,7 @@ public:
 
   void setDataLayout(const llvm::DataLayout *NewLayout) {
     ModuleLayout = NewLayout;
+    buildCPUStateLayoutTable();
   }
 
   std::vector<llvm::AllocaInst *> locals() {
@@ -174,6 +176,26 @@ private:
   std::pair<llvm::GlobalVariable *, unsigned>
   getByCPUStateOffsetInternal(intptr_t Offset, std::string Name = "");
 
+  /// \return the integer type of the field of the CPU state containing
+  ///         \p Offset, along with the offset within such field, or nullptr
+  ///         for padding.
+  std::pair<llvm::IntegerType *, unsigned>
+  getTypeAtCPUStateOffset(intptr_t Offset) const;
+
+  void buildCPUStateLayoutTable();
+
+private:
+  /// What a byte of the CPU state belongs to
+  struct CPUStateByte {
+    /// The field containing this byte, nullptr for padding
+    llvm::IntegerType *Type = nullptr;
+    /// Offset of this byte within the field
+    uint16_t Remaining = 0;
+    /// False if the byte is part of a field that is not an integer nor a
+    /// pointer, i.e., something the layout table cannot describe
+    bool Known = false;
+  };
+
 private:
   llvm::Module &TheModule;
   llvm::IRBuilder<> AllocaBuilder;
@@ -187,6 +209,9 @@ private:
 
   llvm::StructType *CPUStateType;
   const llvm::DataLayout *ModuleLayout;
+  /// Describe each byte of the CPU state, to avoid walking its layout upon
+  /// each access
+  std::vector<CPUStateByte> CPUStateLayout;
   unsigned EnvOffset;
 
   llvm::GlobalVariable *Env;
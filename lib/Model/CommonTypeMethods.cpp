@@ -7,6 +7,7 @@
 #include "revng/ADT/RecursiveCoroutine.h"
 #include "revng/Model/Binary.h"
 #include "revng/Model/CommonTypeMethods.h"
+#include "revng/Model/LayoutCache.h"
 #include "revng/Model/VerifyHelper.h"
 
 template<typename CRTP>
@@ -18,6 +19,9 @@ using Common = model::CommonTypeMethods<CRTP>;
 
 template<typename CRTP>
 std::optional<uint64_t> Common<CRTP>::size() const {
+  if (auto *Scope = model::LayoutCacheScope::current())
+    return size(Scope->sizes());
+
   model::VerifyHelper VH;
   return size(VH);
 }
@@ -0,0 +1,207 @@
+/// \file GlobalNamespace.cpp
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include "revng/Model/Binary.h"
+#include "revng/Model/GlobalNamespace.h"
+
+using namespace llvm;
+
+namespace model {
+
+template<typename T>
+static std::string path(llvm::StringRef Collection, const KeyOf<T> &Key) {
+  return ("/" + Collection + "/" + getNameFromYAMLScalar(Key)).str();
+}
+
+template<typename T>
+static KeyOf<T> key(const T &Object) {
+  return KeyedObjectTraits<T>::key(Object);
+}
+
+std::string globalSymbolPath(const model::Function &F) {
+  return path<model::Function>("Functions", key(F));
+}
+
+std::string globalSymbolPath(const model::DynamicFunction &F) {
+  return path<model::DynamicFunction>("ImportedDynamicFunctions", key(F));
+}
+
+std::string globalSymbolPath(const model::TypeDefinition &T) {
+  return path<model::TypeDefinition>("TypeDefinitions", key(T));
+}
+
+std::string globalSymbolPath(const model::EnumDefinition &D,
+                             const model::EnumEntry &Entry) {
+  return globalSymbolPath(static_cast<const model::TypeDefinition &>(D))
+         + "/EnumDefinition/Entries/" + getNameFromYAMLScalar(key(Entry));
+}
+
+std::string globalSymbolPath(const model::Segment &Segment) {
+  return path<model::Segment>("Segments", key(Segment));
+}
+
+GlobalNamespace::GlobalNamespace(const model::Binary &Model) {
+  for (const model::Function &F : Model.Functions())
+    insert(F.CustomName(), globalSymbolPath(F));
+
+  for (const model::DynamicFunction &DF : Model.ImportedDynamicFunctions())
+    insert(DF.CustomName(), globalSymbolPath(DF));
+
+  for (const model::UpcastableTypeDefinition &Def : Model.TypeDefinitions()) {
+    insert(Def->CustomName(), globalSymbolPath(*Def));
+
+    if (auto *Enum = dyn_cast<model::EnumDefinition>(Def.get()))
+      for (const model::EnumEntry &Entry : Enum->Entries())
+        insert(Entry.CustomName(), globalSymbolPath(*Enum, Entry));
+  }
+
+  for (const model::Segment &S : Model.Segments())
+    insert(S.CustomName(), globalSymbolPath(S));
+}
+
+std::optional<StringRef> GlobalNamespace::owner(StringRef Name) const {
+  auto It = Owners.find(Name);
+  if (It == Owners.end())
+    return std::nullopt;
+
+  revng_assert(not It->second.empty());
+  return StringRef(It->second.front());
+}
+
+bool GlobalNamespace::isAvailable(StringRef Name, StringRef Path) const {
+  auto It = Owners.find(Name);
+  if (It == Owners.end())
+    return true;
+
+  const auto &Paths = It->second;
+  return Paths.size() == 1 and Paths.front() == Path;
+}
+
+std::optional<StringRef> GlobalNamespace::findCollision() const {
+  for (const auto &Entry : Owners)
+    if (Entry.second.size() > 1)
+      return Entry.first();
+
+  return std::nullopt;
+}
+
+bool GlobalNamespace::insert(StringRef Name, StringRef Path) {
+  auto It = Names.find(Path);
+  if (It != Names.end()) {
+    if (It->second == Name)
+      return isAvailable(Name, Path);
+    erase(Path);
+  }
+
+  if (Name.empty())
+    return true;
+
+  auto &Paths = Owners[Name];
+  Paths.emplace_back(Path.str());
+  Names[Path] = Name.str();
+  return Paths.size() == 1;
+}
+
+void GlobalNamespace::erase(StringRef Path) {
+  auto It = Names.find(Path);
+  if (It == Names.end())
+    return;
+
+  auto OwnersIt = Owners.find(It->second);
+  revng_assert(OwnersIt != Owners.end());
+  auto &Paths = OwnersIt->second;
+  llvm::erase_value(Paths, Path);
+  if (Paths.empty())
+    Owners.erase(OwnersIt);
+
+  Names.erase(It);
+}
+
+/// Index again the element of \p Collection touched by \p TheChange
+///
+/// \return false if the change cannot be mapped to an element
+template<typename T>
+static bool reindexTouched(GlobalNamespace &Index,
+                           const Change<model::Binary> &TheChange,
+                           llvm::StringRef CollectionName,
+                           const auto &Collection) {
+  const TupleTreePath &Path = TheChange.Path;
+  revng_assert(Path.size() > 0);
+
+  std::optional<KeyOf<T>> Key;
+  if (Path.size() > 1) {
+    // A change within the element
+    if (const auto *ChangedKey = Path[1].tryGet<KeyOf<T>>())
+      Key = *ChangedKey;
+  } else if (TheChange.New.has_value()) {
+    // A whole element has been added
+    if (const auto *Element = std::get_if<T>(&*TheChange.New))
+      Key = KeyedObjectTraits<T>::key(*Element);
+  } else if (TheChange.Old.has_value()) {
+    // A whole element has been removed
+    if (const auto *Element = std::get_if<T>(&*TheChange.Old))
+      Key = KeyedObjectTraits<T>::key(*Element);
+  }
+
+  if (not Key.has_value())
+    return false;
+
+  std::string ElementPath = path<T>(CollectionName, *Key);
+  if (const T *Element = Collection.tryGet(*Key))
+    Index.insert(Element->CustomName(), ElementPath);
+  else
+    Index.erase(ElementPath);
+
+  return true;
+}
+
+void GlobalNamespace::update(const model::Binary &Model,
+                             const TupleTreeDiff<model::Binary> &Diff) {
+  using Fields = TupleLikeTraits<model::Binary>::Fields;
+  constexpr auto FunctionsIndex = static_cast<size_t>(Fields::Functions);
+  constexpr auto DynamicFunctionsIndex = static_cast<size_t>(
+    Fields::ImportedDynamicFunctions);
+  constexpr auto SegmentsIndex = static_cast<size_t>(Fields::Segments);
+  constexpr auto TypeDefinitionsIndex = static_cast<size_t>(
+    Fields::TypeDefinitions);
+
+  for (const auto &Change : Diff.Changes) {
+    const TupleTreePath &Path = Change.Path;
+    const size_t *Field = Path.empty() ? nullptr : Path[0].tryGet<size_t>();
+
+    bool Understood = false;
+    if (Field == nullptr) {
+      Understood = false;
+    } else if (*Field == FunctionsIndex) {
+      Understood = reindexTouched<model::Function>(*this,
+                                                   Change,
+                                                   "Functions",
+                                                   Model.Functions());
+    } else if (*Field == DynamicFunctionsIndex) {
+      auto &DynamicFunctions = Model.ImportedDynamicFunctions();
+      Understood = reindexTouched<model::DynamicFunction>(*this,
+                                                          Change,
+                                                          "ImportedDynamic"
+                                                          "Functions",
+                                                          DynamicFunctions);
+    } else if (*Field == SegmentsIndex) {
+      Understood = reindexTouched<model::Segment>(*this,
+                                                  Change,
+                                                  "Segments",
+                                                  Model.Segments());
+    } else {
+      // Changes not involving type definitions cannot affect names
+      Understood = *Field != TypeDefinitionsIndex;
+    }
+
+    if (not Understood) {
+      *this = GlobalNamespace(Model);
+      return;
+    }
+  }
+}
+
+} // namespace model
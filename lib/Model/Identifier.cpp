@@ -4,6 +4,9 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <cstdint>
+#include <cstring>
+
 #include "revng/Model/Identifier.h"
 
 using namespace model;
@@ -250,18 +253,76 @@ const std::set<llvm::StringRef> ReservedKeywords = {
   "asm",
 };
 
-static bool isNotUnderscore(const char C) {
-  return C != '_';
-};
+static bool isIdentifierCharacter(const char C) {
+  return (C >= 'a' and C <= 'z') or (C >= 'A' and C <= 'Z')
+         or (C >= '0' and C <= '9') or C == '_';
+}
+
+/// \return a word with the most significant bit of each byte set if the
+///         corresponding byte of \p Word is in [\p Low, \p High]
+///
+/// \note all the bytes of \p Word must be ASCII characters, so that none of
+///       the additions below carries into the next byte.
+static uint64_t bytesInRange(uint64_t Word, uint8_t Low, uint8_t High) {
+  constexpr uint64_t Ones = 0x0101010101010101;
+  constexpr uint64_t HighBits = 0x8080808080808080;
+  uint64_t AtLeastLow = Word + Ones * (128 - Low);
+  uint64_t AboveHigh = Word + Ones * (127 - High);
+  return AtLeastLow & ~AboveHigh & HighBits;
+}
+
+/// \return true if all the 8 characters packed in \p Word are valid
+///         identifier characters
+static bool isIdentifierWord(uint64_t Word) {
+  constexpr uint64_t HighBits = 0x8080808080808080;
+  if ((Word & HighBits) != 0)
+    return false;
+
+  // Setting the 0x20 bit maps upper case letters onto lower case ones, while
+  // none of the other characters ends up in [a-z]
+  constexpr uint64_t LowerCaseBits = 0x2020202020202020;
+  uint64_t Valid = bytesInRange(Word | LowerCaseBits, 'a', 'z')
+                   | bytesInRange(Word, '0', '9')
+                   | bytesInRange(Word, '_', '_');
+  return Valid == HighBits;
+}
+
+/// \return the index of the first character of \p Name that cannot appear in
+///         an identifier, or the size of \p Name if there's none
+///
+/// Names are checked a word at a time, falling back to single characters only
+/// for the word containing the first invalid character and for the tail.
+static size_t findInvalidCharacter(llvm::StringRef Name, size_t Start = 0) {
+  const char *Data = Name.data();
+  size_t Size = Name.size();
+  size_t Index = Start;
+
+  for (; Index + sizeof(uint64_t) <= Size; Index += sizeof(uint64_t)) {
+    uint64_t Word;
+    std::memcpy(&Word, Data + Index, sizeof(Word));
+    if (not isIdentifierWord(Word))
+      break;
+  }
+
+  for (; Index < Size; ++Index)
+    if (not isIdentifierCharacter(Data[Index]))
+      return Index;
 
-static bool allAlphaNumOrUnderscore(const Identifier &Range) {
-  const auto &FilterRange = llvm::make_filter_range(Range, isNotUnderscore);
-  for (const auto &Entry : FilterRange)
-    if (not std::isalnum(Entry))
-      return false;
-  return true;
+  return Size;
+}
+
+static bool allAlphaNumOrUnderscore(llvm::StringRef Name) {
+  return findInvalidCharacter(Name) == Name.size();
 };
 
+/// Convert all the characters that are not valid in an identifier to
+/// underscores, skipping over the runs of valid ones
+static void sanitizeInPlace(Identifier &Name) {
+  for (size_t Index = findInvalidCharacter(Name); Index < Name.size();
+       Index = findInvalidCharacter(Name, Index + 1))
+    Name[Index] = '_';
+}
+
 bool Identifier::verify(VerifyHelper &VH) const {
   return VH.maybeFail(not(not empty() and std::isdigit(str()[0]))
                         and not startswith("_")
@@ -291,28 +352,22 @@ Identifier Identifier::fromString(llvm::StringRef Name) {
     return Result;
   }
 
-  const auto BecomesUnderscore = [](const char C) {
-    return not std::isalnum(C) or C == '_';
-  };
-
   // For invalid C identifiers prepend the our reserved prefix.
-  if (std::isdigit(Name[0]) or BecomesUnderscore(Name[0])) {
+  if (std::isdigit(Name[0]) or not isIdentifierCharacter(Name[0])
+      or Name[0] == '_') {
+    Result.reserve(PrefixForReservedNames.size() + Name.size());
     Result += PrefixForReservedNames;
   }
 
   // Append the rest of the name
   Result += Name;
 
-  return sanitize(Result);
+  sanitizeInPlace(Result);
+  return Result;
 }
 
 Identifier Identifier::sanitize(llvm::StringRef Name) {
   Identifier Result(Name);
-
-  // Convert all non-alphanumeric chars to underscores
-  for (char &C : Result)
-    if (not std::isalnum(C))
-      C = '_';
-
+  sanitizeInPlace(Result);
   return Result;
 }
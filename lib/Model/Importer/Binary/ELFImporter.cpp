@@ -5,7 +5,9 @@
 //
 
 #include <cstdint>
+#include <map>
 #include <optional>
+#include <set>
 
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/Object/ELF.h"
@@ -22,6 +24,7 @@
 #include "revng/Model/Pass/AllPasses.h"
 #include "revng/Model/RawBinaryView.h"
 #include "revng/Support/Debug.h"
+#include "revng/Support/ELFDynamicInfo.h"
 #include "revng/Support/LDDTree.h"
 
 #include "CrossModelFindTypeHelper.h"
@@ -399,7 +402,7 @@ Error ELFImporter<T, HasAddend>::import(const ImporterOptions &Options) {
 
     // Import Dwarf
     DwarfImporter Importer(Model);
-    Importer.import(TheBinary.getFileName(), AdjustedOptions);
+    Importer.import(TheBinary, TheBinary.getFileName(), AdjustedOptions);
 
     // Now we try to find missing types in the dependencies.
     Task.advance("Find missing types from debug info", true);
@@ -425,8 +428,21 @@ void ELFImporter<T, HasAddend>::findMissingTypes(object::ELFFile<T> &TheELF,
   //       the `ImporterOptions::DebugInfo`, if the need ever arises.
   unsigned MaximumRecursionDepth = 1;
 
+  // Let lddtree use the binary we already parsed instead of opening it again
+  std::string FileName = TheBinary.getFileName().str();
+  getELFDynamicInfo(FileName, TheBinary);
+
   LDDTree Dependencies;
-  lddtree(Dependencies, TheBinary.getFileName().str(), MaximumRecursionDepth);
+  lddtree(Dependencies, FileName, MaximumRecursionDepth);
+
+  // Fetch the debug information of all the libraries at once, instead of
+  // one at a time while importing them
+  std::set<std::string> Libraries;
+  for (auto &[_, DependencyLibraries] : Dependencies)
+    Libraries.insert(DependencyLibraries.begin(), DependencyLibraries.end());
+  DwarfImporter::fetchDebugInfo(std::vector<std::string>(Libraries.begin(),
+                                                         Libraries.end()));
+
   for (auto &Library : Dependencies) {
     revng_log(ELFImporterLog,
               "Importing Models for dependencies of " << Library.first << ":");
@@ -626,6 +642,11 @@ void ELFImporter<T, HasAddend>::parseSymbols(object::ELFFile<T> &TheELF,
     return;
   }
 
+  // Symbol tables can have millions of entries: collect the new functions and
+  // insert them all at once, instead of performing a sorted insertion for each
+  // of them. The first symbol for a certain address wins.
+  std::map<MetaAddress, std::optional<StringRef>> NewFunctions;
+
   for (auto &Symbol : *ELFSymbols) {
     auto MaybeName = expectedToOptional(Symbol.getName(StrtabContent));
 
@@ -645,22 +666,24 @@ void ELFImporter<T, HasAddend>::parseSymbols(object::ELFFile<T> &TheELF,
 
     if (IsCode) {
       revng_assert(Address.isValid());
-      if (Model->Functions().tryGet(Address) == nullptr) {
-        model::Function &Function = Model->Functions()[Address];
-        if (MaybeName and MaybeName->size() > 0) {
-          Function.OriginalName() = *MaybeName;
-          // Insert Original name into exported ones, since it is by default
-          // true.
-          Function.ExportedNames().insert((*MaybeName).str());
-        }
-      }
+      if (Model->Functions().tryGet(Address) == nullptr)
+        NewFunctions.try_emplace(Address, MaybeName);
     } else if (IsDataObject and Size > 0) {
-      auto IsSameAddress = [Address](const auto &E) {
-        return Address == E.Address;
-      };
-      if (llvm::count_if(DataSymbols, IsSameAddress) == 0)
-        DataSymbols.emplace_back(Address, Size, *MaybeName);
+      if (not hasDataSymbolAt(Address))
+        addDataSymbol(Address, Size, *MaybeName);
+    }
+  }
+
+  auto Inserter = Model->Functions().batch_insert();
+  for (auto &[Address, MaybeName] : NewFunctions) {
+    model::Function Function(Address);
+    if (MaybeName and MaybeName->size() > 0) {
+      Function.OriginalName() = *MaybeName;
+      // Insert Original name into exported ones, since it is by default
+      // true.
+      Function.ExportedNames().insert((*MaybeName).str());
     }
+    Inserter.insert(std::move(Function));
   }
 }
 
@@ -814,10 +837,9 @@ void ELFImporter<T, HasAddend>::parseDynamicSymbol(Elf_Sym_Impl<T> &Symbol,
         Function->ExportedNames().insert(Name.str());
     } else {
       Address = relocate(fromGeneric(Symbol.st_value));
-      if (not llvm::is_contained(DataSymbols,
-                                 DataSymbol{ Address, Size, Name }))
+      if (not KnownDataSymbols.contains({ Address, Size, Name }))
         if (IsDataObject and Size > 0)
-          DataSymbols.emplace_back(Address, Size, Name);
+          addDataSymbol(Address, Size, Name);
     }
   }
 }
@@ -4,6 +4,9 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <set>
+#include <tuple>
+
 #include "llvm/Object/ELFObjectFile.h"
 
 #include "revng/Model/Importer/Binary/BinaryImporterHelper.h"
@@ -71,6 +74,9 @@ private:
 private:
   llvm::SmallVector<DataSymbol, 32> DataSymbols;
 
+  /// Index of DataSymbols, to avoid linear searches on large symbol tables
+  std::set<std::tuple<MetaAddress, uint64_t, llvm::StringRef>> KnownDataSymbols;
+
 protected:
   std::optional<uint64_t> SymbolsCount;
   std::unique_ptr<FilePortion> DynstrPortion;
@@ -140,6 +146,16 @@ private:
   /// \param LSDAAddress the address of the target LSDA
   void parseLSDA(MetaAddress FDEStart, MetaAddress LSDAAddress);
 
+  void addDataSymbol(MetaAddress Address, uint64_t Size, llvm::StringRef Name) {
+    if (KnownDataSymbols.emplace(Address, Size, Name).second)
+      DataSymbols.emplace_back(Address, Size, Name);
+  }
+
+  bool hasDataSymbolAt(MetaAddress Address) const {
+    auto It = KnownDataSymbols.lower_bound({ Address, 0, llvm::StringRef() });
+    return It != KnownDataSymbols.end() and std::get<0>(*It) == Address;
+  }
+
   void parseSymbols(llvm::object::ELFFile<T> &TheELF,
                     ConstElf_Shdr *SectionHeader);
 
@@ -32,6 +32,11 @@ private:
   const object::COFFObjectFile &TheBinary;
   MetaAddress ImageBase = MetaAddress::invalid();
 
+  /// The imported functions found so far, with the relocation of their first
+  /// import entry. They are added to the model all at once, since DLLs can
+  /// import tens of thousands of functions.
+  std::map<std::string, model::Relocation> NewImportedFunctions;
+
 public:
   PECOFFImporter(TupleTree<model::Binary> &Model,
                  const object::COFFObjectFile &TheBinary,
@@ -54,6 +59,12 @@ private:
                                uint32_t ImportAddressTableEntry);
   /// Parse delay dynamic symbols from the file.
   void parseDelayImportedSymbols();
+  /// Add to the model the functions found by the previous two methods.
+  void registerImportedFunctions();
+  bool isImportedFunctionKnown(StringRef Name) const {
+    return NewImportedFunctions.contains(Name.str())
+           or Model->ImportedDynamicFunctions().contains(Name.str());
+  }
 
   /// Resolve dependent DLLs.
   void getDependencies(PELDDTree Dependencies, unsigned Level);
@@ -143,6 +154,10 @@ Error PECOFFImporter::parseSectionsHeaders() {
 }
 
 void PECOFFImporter::parseSymbols() {
+  // Collect the functions and insert them all at once, the first symbol for a
+  // certain address wins
+  std::map<MetaAddress, StringRef> NewFunctions;
+
   for (auto Sym : TheBinary.symbols()) {
     COFFSymbolRef Symbol = TheBinary.getCOFFSymbol(Sym);
 
@@ -160,8 +175,14 @@ void PECOFFImporter::parseSymbols() {
     if (Model->Functions().contains(Address))
       continue;
 
-    model::Function &Function = Model->Functions()[Address];
-    Function.OriginalName() = *NameOrErr;
+    NewFunctions.try_emplace(Address, *NameOrErr);
+  }
+
+  auto Inserter = Model->Functions().batch_insert();
+  for (auto &[Address, Name] : NewFunctions) {
+    model::Function Function(Address);
+    Function.OriginalName() = Name;
+    Inserter.insert(std::move(Function));
   }
 }
 
@@ -187,7 +208,7 @@ void PECOFFImporter::recordImportedFunctions(ImportedSymbolRange Range,
 
     // Dynamic functions must have a name, so skip those without it.
     // TODO: handle imports by ordinal
-    if (Sym.empty() or Model->ImportedDynamicFunctions().contains(Sym.str()))
+    if (Sym.empty() or isImportedFunctionKnown(Sym))
       continue;
 
     // NOTE: This address will occur in the .text section as a target of a jump.
@@ -202,9 +223,8 @@ void PECOFFImporter::recordImportedFunctions(ImportedSymbolRange Range,
     auto RelocationType = formCOFFRelocation(Model->Architecture());
     model::Relocation NewRelocation(AddressOfImportEntry, RelocationType);
 
-    auto It = Model->ImportedDynamicFunctions().insert(Sym.str()).first;
     revng_assert(NewRelocation.verify(true));
-    It->Relocations().insert(NewRelocation);
+    NewImportedFunctions.emplace(Sym.str(), NewRelocation);
     ++Index;
   }
 }
@@ -272,7 +292,7 @@ void PECOFFImporter::recordDelayImportedFunctions(DelayDirectoryRef &I,
 
     // Dynamic functions must have a name, so skip those without it.
     // TODO: handle imports by ordinal
-    if (Sym.empty() or Model->ImportedDynamicFunctions().contains(Sym.str()))
+    if (Sym.empty() or isImportedFunctionKnown(Sym))
       continue;
 
     MetaAddress AddressOfDelayImportEntry = ImageBase + u64(Addr);
@@ -281,12 +301,22 @@ void PECOFFImporter::recordDelayImportedFunctions(DelayDirectoryRef &I,
     using namespace model::RelocationType;
     auto RelocationType = formCOFFRelocation(Model->Architecture());
     model::Relocation NewRelocation(AddressOfDelayImportEntry, RelocationType);
-    auto NewIt = Model->ImportedDynamicFunctions().insert(Sym.str()).first;
     revng_assert(NewRelocation.verify(true));
-    NewIt->Relocations().insert(NewRelocation);
+    NewImportedFunctions.emplace(Sym.str(), NewRelocation);
   }
 }
 
+void PECOFFImporter::registerImportedFunctions() {
+  auto Inserter = Model->ImportedDynamicFunctions().batch_insert();
+  for (auto &[Name, Relocation] : NewImportedFunctions) {
+    model::DynamicFunction Function(Name);
+    Function.Relocations().insert(Relocation);
+    Inserter.insert(std::move(Function));
+  }
+
+  NewImportedFunctions.clear();
+}
+
 void PECOFFImporter::parseDelayImportedSymbols() {
   for (DelayDirectoryRef &I : TheBinary.delay_import_directories()) {
     StringRef Name;
@@ -495,6 +525,8 @@ Error PECOFFImporter::import(const ImporterOptions &Options) {
   // linking).
   parseDelayImportedSymbols();
 
+  registerImportedFunctions();
+
   if (Model->DefaultABI() == model::ABI::Invalid) {
     auto &Architecture = Model->Architecture();
     Model->DefaultABI() = model::ABI::getDefaultMicrosoftABI(Architecture);
@@ -17,8 +17,10 @@
 #include "llvm/IR/DebugInfoMetadata.h"
 #include "llvm/Object/ELFObjectFile.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Support/Progress.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_os_ostream.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -29,12 +31,14 @@
 #include "revng/Model/Importer/DebugInfo/DwarfImporter.h"
 #include "revng/Model/Pass/AllPasses.h"
 #include "revng/Model/Processing.h"
+#include "revng/Model/RawBinaryView.h"
 #include "revng/Support/Assert.h"
 #include "revng/Support/Debug.h"
 #include "revng/Support/PathList.h"
 #include "revng/Support/ProgramRunner.h"
 
 #include "ImportDebugInfoHelper.h"
+#include "TypeInterningTable.h"
 
 using namespace llvm;
 using namespace llvm::dwarf;
@@ -169,6 +173,7 @@ private:
   std::map<size_t, const model::TypeDefinition *> Placeholders;
   std::set<const model::TypeDefinition *> InvalidPrimitives;
   std::set<const DWARFDie *> InProgressDies;
+  TypeInterningTable Prototypes;
 
 public:
   DwarfToModelConverter(DwarfImporter &Importer,
@@ -182,7 +187,8 @@ public:
     Model(Importer.getModel()),
     Index(Index),
     AltIndex(AltIndex),
-    Context(Context) {
+    Context(Context),
+    Prototypes(Importer.getModel()) {
 
     Architecture = Model->Architecture();
     BaseAddress = PreferredBaseAddress;
@@ -368,6 +374,36 @@ private:
     }
   }
 
+  /// Parse the DIEs of all the compile units, in parallel
+  ///
+  /// Decoding `.debug_info` is independent for each compile unit and it's the
+  /// bulk of the work for programs with lots of debug information. Everything
+  /// after this only reads the parsed DIEs, but has to be done sequentially,
+  /// since types are shared across compile units in the model.
+  void parseCompileUnits() {
+    SmallVector<llvm::DWARFUnit *, 16> CompileUnits;
+    for (const auto &CU : Context.compile_units()) {
+      // Abbreviations are lazily parsed into a table shared by all the units:
+      // do it in advance so that the units can then be parsed concurrently
+      CU->getAbbreviations();
+      CompileUnits.push_back(CU.get());
+    }
+
+    std::vector<std::string> Errors(CompileUnits.size());
+    llvm::parallelForEachN(0, CompileUnits.size(), [&](size_t I) {
+      if (auto Error = CompileUnits[I]->tryExtractDIEsIfNeeded(false))
+        Errors[I] = toString(std::move(Error));
+    });
+
+    // Report errors sequentially and in order
+    for (std::string &Message : Errors) {
+      if (not Message.empty()) {
+        auto Error = createStringError(inconvertibleErrorCode(), Message);
+        Context.getRecoverableErrorHandler()(std::move(Error));
+      }
+    }
+  }
+
   void materializeTypesWithIdentity() {
     SmallVector<llvm::DWARFUnit *, 16> CompileUnits;
     for (const auto &CU : Context.compile_units())
@@ -820,7 +856,7 @@ private:
 
     // Return type
     FunctionType.ReturnType() = makeType(Die);
-    return Model->recordNewType(std::move(NewType)).second;
+    return Prototypes.record(std::move(NewType));
   }
 
   void createFunctions() {
@@ -892,6 +928,9 @@ private:
         }
       }
     }
+
+    revng_log(DILogger,
+              Prototypes.hitCount() << " subprogram prototypes were shared");
   }
 
   void purgeUnresolvedPlaceholders() {
@@ -910,7 +949,9 @@ private:
 
 public:
   void run() {
-    Task T(9, "Importing DWARF");
+    Task T(10, "Importing DWARF");
+    T.advance("Parse compile units", true);
+    parseCompileUnits();
     T.advance("Materialize types with an identity", true);
     materializeTypesWithIdentity();
     T.advance("Resolve types", true);
@@ -928,7 +969,7 @@ public:
     T.advance("Purge unnamed unreachable types", true);
     purgeUnnamedAndUnreachableTypes(Model);
     T.advance("Verify the model", true);
-    Model->verify(true);
+    Model->verifyInParallel(true);
   }
 };
 
@@ -1048,7 +1089,7 @@ static bool fileExists(const Twine &Path) {
 static std::optional<std::string>
 findDebugInfoFileByName(StringRef FileName,
                         StringRef DebugFileName,
-                        llvm::object::ObjectFile *ELF) {
+                        const llvm::object::ObjectFile *ELF) {
   // Let's find it in canonical places, where debug info was fetched.
   //  1) Look for a .gnu_debuglink/.gnu_debugaltlink/.debug_sup section.
   //  The .debug file should be in canonical places.
@@ -1147,7 +1188,96 @@ findDebugInfoFileByName(StringRef FileName,
   return std::nullopt;
 }
 
+static bool hasDebugInfo(const object::ObjectFile &Object) {
+  for (const object::SectionRef &Section : Object.sections()) {
+    StringRef SectionName;
+    if (Expected<StringRef> NameOrErr = Section.getName()) {
+      SectionName = *NameOrErr;
+    } else {
+      llvm::consumeError(NameOrErr.takeError());
+      continue;
+    }
+
+    // TODO: When adding support for Split dwarf, there will be
+    // .debug_info.dwo section, so we need to handle it.
+    if (SectionName == ".debug_info")
+      return true;
+  }
+  return false;
+}
+
+/// Look for the detached debug information file of \p FileName on the
+/// device and, if it can't be found, try to fetch it with `fetch-debuginfo`
+static std::optional<std::string>
+findOrFetchDebugInfoFile(StringRef FileName,
+                         StringRef DebugFileName,
+                         const llvm::object::ObjectFile *ELF) {
+  auto DebugFilePath = findDebugInfoFileByName(FileName, DebugFileName, ELF);
+  if (DebugFilePath)
+    return DebugFilePath;
+
+  std::string BuildID = getBuildID(ELF);
+  if (not BuildID.empty() and isKnownToBeMissing("elf", BuildID)) {
+    revng_log(DILogger,
+              "Fetching debug info for " << BuildID
+                                         << " failed recently, skipping.");
+    return std::nullopt;
+  }
+
+  if (!::Runner.isProgramAvailable("revng")) {
+    revng_log(DILogger, "Can't find `revng` binary to run `fetch-debuginfo`.");
+    return std::nullopt;
+  }
+
+  int ExitCode = runFetchDebugInfo(FileName);
+  if (ExitCode != 0) {
+    revng_log(DILogger,
+              "Failed to find debug info with `revng model "
+              "fetch-debuginfo`.");
+    if (not BuildID.empty())
+      markAsMissing("elf", BuildID);
+    return std::nullopt;
+  }
+
+  return findDebugInfoFileByName(FileName, DebugFileName, ELF);
+}
+
+void DwarfImporter::fetchDebugInfo(llvm::ArrayRef<std::string> FileNames) {
+  llvm::ThreadPool Pool(llvm::hardware_concurrency());
+  for (const std::string &FileName : FileNames) {
+    Pool.async([&FileName]() {
+      auto ExpectedBinary = object::createBinary(FileName);
+      if (not ExpectedBinary) {
+        llvm::consumeError(ExpectedBinary.takeError());
+        return;
+      }
+
+      auto *ELF = dyn_cast<object::ObjectFile>(ExpectedBinary->getBinary());
+      if (ELF == nullptr or hasDebugInfo(*ELF))
+        return;
+
+      StringRef DebugFile = getDebugFileName(ELF);
+      if (not DebugFile.empty())
+        findOrFetchDebugInfoFile(FileName, DebugFile, ELF);
+    });
+  }
+  Pool.wait();
+}
+
 void DwarfImporter::import(StringRef FileName, const ImporterOptions &Options) {
+  using namespace llvm::object;
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BuffOrErr = mapBinaryFile(FileName);
+  error(FileName, BuffOrErr.getError());
+  std::unique_ptr<MemoryBuffer> Buffer = std::move(BuffOrErr.get());
+  Expected<std::unique_ptr<Binary>> BinOrErr = object::createBinary(*Buffer);
+  error(FileName, errorToErrorCode(BinOrErr.takeError()));
+
+  import(**BinOrErr, FileName, Options);
+}
+
+void DwarfImporter::import(const llvm::object::Binary &TheBinary,
+                           StringRef FileName,
+                           const ImporterOptions &Options) {
   Task T(3,
          "Importing DWARF information for "
            + llvm::sys::path::filename(FileName));
@@ -1155,35 +1285,12 @@ void DwarfImporter::import(StringRef FileName, const ImporterOptions &Options) {
   T.advance("Fetching debug info", true);
 
   using namespace llvm::object;
-  ErrorOr<std::unique_ptr<MemoryBuffer>>
-    BuffOrErr = MemoryBuffer::getFileOrSTDIN(FileName);
-  error(FileName, BuffOrErr.getError());
-  std::unique_ptr<MemoryBuffer> Buffer = std::move(BuffOrErr.get());
-  Expected<std::unique_ptr<Binary>> BinOrErr = object::createBinary(*Buffer);
-  error(FileName, errorToErrorCode(BinOrErr.takeError()));
 
   // Find Debugging Information.
   // If the file has debug info sections within itself, no need for finding
   // it on the device.
   // TODO: When we add support for Split DWARF, this will need additional
   // improvement.
-  auto HasDebugInfo = [](ObjectFile *Object) {
-    for (const SectionRef &Section : Object->sections()) {
-      StringRef SectionName;
-      if (Expected<StringRef> NameOrErr = Section.getName()) {
-        SectionName = *NameOrErr;
-      } else {
-        llvm::consumeError(NameOrErr.takeError());
-        continue;
-      }
-
-      // TODO: When adding support for Split dwarf, there will be
-      // .debug_info.dwo section, so we need to handle it.
-      if (SectionName == ".debug_info")
-        return true;
-    }
-    return false;
-  };
 
   auto PerformImport = [this, &T, &Options](StringRef FilePath,
                                             StringRef TheDebugFile) {
@@ -1200,42 +1307,24 @@ void DwarfImporter::import(StringRef FileName, const ImporterOptions &Options) {
     }
   };
 
-  if (auto *ELF = dyn_cast<ObjectFile>(BinOrErr->get())) {
-    if (Options.DebugInfo != DebugInfoLevel::No && !HasDebugInfo(ELF)) {
+  if (auto *ELF = dyn_cast<ObjectFile>(&TheBinary)) {
+    if (Options.DebugInfo != DebugInfoLevel::No && !hasDebugInfo(*ELF)) {
       // There are no .debug_* sections in the file itself, let's try to find it
       // on the device, otherwise find it on web by using the `fetch-debuginfo`
       // tool.
-      auto DebugFile = getDebugFileName(BinOrErr->get());
+      auto DebugFile = getDebugFileName(&TheBinary);
       if (!DebugFile.size()) {
         revng_log(DILogger, "Can't find file name of the debug file.");
         return;
       }
-      auto DebugFilePath = findDebugInfoFileByName(FileName, DebugFile, ELF);
-      if (!DebugFilePath) {
-        if (!::Runner.isProgramAvailable("revng")) {
-          revng_log(DILogger,
-                    "Can't find `revng` binary to run `fetch-debuginfo`.");
-          return;
-        }
-
-        int ExitCode = runFetchDebugInfo(FileName);
-        if (ExitCode != 0) {
-          revng_log(DILogger,
-                    "Failed to find debug info with `revng model "
-                    "fetch-debuginfo`.");
-        } else {
-          DebugFilePath = findDebugInfoFileByName(FileName, DebugFile, ELF);
-          if (DebugFilePath)
-            PerformImport(*DebugFilePath, DebugFile);
-        }
-      } else {
+      auto DebugFilePath = findOrFetchDebugInfoFile(FileName, DebugFile, ELF);
+      if (DebugFilePath)
         PerformImport(*DebugFilePath, DebugFile);
-      }
     }
   }
 
   T.advance("Parsing debug info in the binary itself", true);
-  import(*BinOrErr->get(), FileName, Options.BaseAddress);
+  import(TheBinary, FileName, Options.BaseAddress);
 }
 
 auto zipPairs(auto &&R) {
@@ -4,18 +4,63 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <chrono>
+
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Process.h"
+#include "llvm/Support/raw_ostream.h"
 
 #include "revng/Support/Assert.h"
+#include "revng/Support/PathList.h"
 #include "revng/Support/ProgramRunner.h"
 
 namespace {
 
 inline int runFetchDebugInfo(llvm::StringRef InputFileName) {
   revng_assert(::Runner.isProgramAvailable("revng"));
-  return ::Runner.run("revng",
-                      { "model", "fetch-debuginfo", InputFileName.str() });
+  return ::Runner.runRevngCommand("revng",
+                                  { "model",
+                                    "fetch-debuginfo",
+                                    InputFileName.str() });
+}
+
+/// How long a failure to fetch some debug information is remembered, before
+/// trying again
+inline constexpr std::chrono::hours NotFoundLifetime(24);
+
+/// \p Format is the directory of the cache of fetched debug information
+/// dedicated to a binary format, \p ID identifies the binary within it
+inline std::string getNotFoundMarkerPath(llvm::StringRef Format,
+                                         llvm::StringRef ID) {
+  return joinPath(getCacheDirectory(),
+                  "debug-symbols",
+                  Format,
+                  ID,
+                  "not-found");
+}
+
+/// \returns true if fetching the debug information identified by \p ID has
+///          failed recently
+inline bool isKnownToBeMissing(llvm::StringRef Format, llvm::StringRef ID) {
+  llvm::sys::fs::file_status Status;
+  if (llvm::sys::fs::status(getNotFoundMarkerPath(Format, ID), Status))
+    return false;
+
+  auto Age = std::chrono::system_clock::now()
+             - Status.getLastModificationTime();
+  return Age < NotFoundLifetime;
+}
+
+/// Remember that fetching the debug information identified by \p ID failed
+inline void markAsMissing(llvm::StringRef Format, llvm::StringRef ID) {
+  std::string Path = getNotFoundMarkerPath(Format, ID);
+  if (llvm::sys::fs::create_directories(llvm::sys::path::parent_path(Path)))
+    return;
+
+  // Create the marker or, if it exists, refresh its modification time
+  std::error_code EC;
+  llvm::raw_fd_ostream Marker(Path, EC);
 }
 
 } // namespace
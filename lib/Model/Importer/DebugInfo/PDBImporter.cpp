@@ -26,6 +26,8 @@
 #include "llvm/DebugInfo/PDB/Native/SymbolStream.h"
 #include "llvm/DebugInfo/PDB/Native/TpiStream.h"
 #include "llvm/DebugInfo/PDB/PDB.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Support/Program.h"
@@ -33,6 +35,7 @@
 #include "revng/Model/Binary.h"
 #include "revng/Model/Importer/Binary/Options.h"
 #include "revng/Model/Importer/DebugInfo/PDBImporter.h"
+#include "revng/Model/Importer/TypeCopier.h"
 #include "revng/Model/Pass/AllPasses.h"
 #include "revng/Model/Processing.h"
 #include "revng/Model/TypeDefinition.h"
@@ -44,6 +47,7 @@
 #include "revng/Support/ProgramRunner.h"
 
 #include "ImportDebugInfoHelper.h"
+#include "TypeInterningTable.h"
 
 using namespace llvm;
 using namespace llvm::codeview;
@@ -57,11 +61,23 @@ static llvm::cl::opt<std::string> UsePDB("use-pdb",
                                          llvm::cl::desc("Path to the PDB."),
                                          llvm::cl::cat(MainCategory));
 
+static llvm::cl::opt<bool>
+  NoPDBTypesCache("no-pdb-types-cache",
+                  llvm::cl::desc("Do not use nor populate the cache of the "
+                                 "types imported from PDB files."),
+                  llvm::cl::cat(MainCategory));
+
+/// Bump this every time the way types are imported from PDB files changes
+static constexpr unsigned PDBTypesCacheVersion = 1;
+
 namespace {
+
+using ProcessedTypeMap = DenseMap<TypeIndex, model::UpcastableType>;
+
 class PDBImporterImpl {
 private:
   PDBImporter &Importer;
-  DenseMap<TypeIndex, model::UpcastableType> ProcessedTypes;
+  ProcessedTypeMap ProcessedTypes;
 
 public:
   PDBImporterImpl(PDBImporter &Importer) : Importer(Importer) {}
@@ -69,10 +85,20 @@ public:
 
 private:
   void populateTypes();
+  bool visitTypes(TupleTree<model::Binary> &Fragment,
+                  ProcessedTypeMap &FragmentTypes);
+  void mergeTypes(TupleTree<model::Binary> &Fragment,
+                  const ProcessedTypeMap &FragmentTypes);
   void populateSymbolsWithTypes(NativeSession &Session);
-};
 
-using ProcessedTypeMap = DenseMap<TypeIndex, model::UpcastableType>;
+  std::optional<std::string> getTypesCachePath();
+  bool loadTypesCache(llvm::StringRef Path,
+                      TupleTree<model::Binary> &Fragment,
+                      ProcessedTypeMap &FragmentTypes);
+  void storeTypesCache(llvm::StringRef Path,
+                       TupleTree<model::Binary> &Fragment,
+                       const ProcessedTypeMap &FragmentTypes);
+};
 
 /// Visitor for CodeView type streams found in PDB files. It overrides callbacks
 /// (from `TypeVisitorCallbacks`) to types of interest for the revng `Model`.
@@ -89,6 +115,7 @@ class PDBImporterTypeVisitor : public TypeVisitorCallbacks {
   ProcessedTypeMap &ProcessedTypes;
   DenseMap<TypeIndex, TypeIndex> &ForwardReferencedTypes;
   TpiStream &Tpi;
+  TypeInterningTable Interner;
 
   TypeIndex CurrentTypeIndex = TypeIndex::None();
   std::map<TypeIndex, SmallVector<DataMemberRecord, 8>> InProgressMemberTypes;
@@ -113,7 +140,8 @@ public:
     Types(Types),
     ProcessedTypes(ProcessedTypes),
     ForwardReferencedTypes(ForwardReferencedTypes),
-    Tpi(Tpi) {}
+    Tpi(Tpi),
+    Interner(M) {}
 
   Error visitTypeBegin(CVType &Record) override;
   Error visitTypeBegin(CVType &Record, TypeIndex TI) override;
@@ -169,11 +197,34 @@ public:
 } // namespace
 
 void PDBImporterImpl::populateTypes() {
+  TupleTree<model::Binary> &Model = Importer.getModel();
+
+  // Import the types in a separate model, which only depends on the PDB and on
+  // the architecture, so that it can be cached and reused every time the same
+  // PDB is imported
+  TupleTree<model::Binary> Fragment;
+  Fragment->Architecture() = Model->Architecture();
+  Fragment->DefaultABI() = Model->DefaultABI();
+  ProcessedTypeMap FragmentTypes;
+
+  std::optional<std::string> CachePath = getTypesCachePath();
+  if (CachePath and loadTypesCache(*CachePath, Fragment, FragmentTypes)) {
+    revng_log(Log, "Types loaded from " << *CachePath);
+  } else if (visitTypes(Fragment, FragmentTypes) and CachePath) {
+    storeTypesCache(*CachePath, Fragment, FragmentTypes);
+  }
+
+  mergeTypes(Fragment, FragmentTypes);
+}
+
+/// \returns true if the whole type stream has been imported
+bool PDBImporterImpl::visitTypes(TupleTree<model::Binary> &Fragment,
+                                 ProcessedTypeMap &FragmentTypes) {
   auto InputFile = InputFile::open(Importer.getPDBFile()->getFilePath());
   if (not InputFile) {
     revng_log(Log, "Unable to open PDB file " << InputFile.takeError());
     consumeError(InputFile.takeError());
-    return;
+    return false;
   }
 
   auto StreamTpiOrErr = Importer.getPDBFile()->getPDBTpiStream();
@@ -181,20 +232,41 @@ void PDBImporterImpl::populateTypes() {
     revng_log(Log,
               "Unable to find TPI in PDB file: " << StreamTpiOrErr.takeError());
     consumeError(StreamTpiOrErr.takeError());
-    return;
+    return false;
   }
 
   // Those will be processed after all the types are visited.
   DenseMap<TypeIndex, TypeIndex> ForwardReferencedTypes;
-  PDBImporterTypeVisitor TypeVisitor(Importer.getModel(),
+  PDBImporterTypeVisitor TypeVisitor(Fragment,
                                      InputFile->types(),
-                                     ProcessedTypes,
+                                     FragmentTypes,
                                      ForwardReferencedTypes,
                                      *StreamTpiOrErr);
   if (auto Err = visitTypeStream(InputFile->types(), TypeVisitor)) {
     revng_log(Log, "Error during visiting types: " << Err);
     consumeError(std::move(Err));
+    return false;
+  }
+
+  return true;
+}
+
+void PDBImporterImpl::mergeTypes(TupleTree<model::Binary> &Fragment,
+                                 const ProcessedTypeMap &FragmentTypes) {
+  TypeCopier Copier(Fragment, Importer.getModel());
+  Copier.copyAllTypesInto();
+
+  // Only the entries referring directly to a definition are used after this
+  // point, to assign prototypes to functions
+  for (const auto &[Index, Type] : FragmentTypes) {
+    if (Type.isEmpty())
+      continue;
+
+    if (const model::TypeDefinition *Definition = Type->tryGetAsDefinition())
+      ProcessedTypes[Index] = Copier.getCopy(Definition->key());
   }
+
+  Copier.finalize();
 }
 
 class PDBSymbolHandler {
@@ -271,7 +343,7 @@ void PDBImporterImpl::run(NativeSession &Session) {
   deduplicateEquivalentTypes(Model);
   promoteOriginalName(Model);
   purgeUnreachableTypes(Model);
-  revng_assert(Model->verify(true));
+  revng_assert(Model->verifyInParallel(true));
 }
 
 bool PDBImporter::loadDataFromPDB(StringRef PDBFileName) {
@@ -369,6 +441,121 @@ static std::string formatPDBFileID(ArrayRef<uint8_t> Bytes, uint16_t Age) {
   return PDBFileID;
 }
 
+// ==== Implementation of the cache of the imported types. ==== //
+
+// The cache of the types imported from a PDB file holds, in the binary tuple
+// tree encoding, a model containing only the imported type definitions,
+// followed by the TypeIndex of each PDB type mapped to a definition along with
+// the key of such definition.
+
+std::optional<std::string> PDBImporterImpl::getTypesCachePath() {
+  if (NoPDBTypesCache)
+    return std::nullopt;
+
+  auto InfoStream = Importer.getPDBFile()->getPDBInfoStream();
+  if (not InfoStream) {
+    consumeError(InfoStream.takeError());
+    return std::nullopt;
+  }
+
+  auto PDBFileID = formatPDBFileID(InfoStream->getGuid().Guid,
+                                   InfoStream->getAge());
+
+  TupleTree<model::Binary> &Model = Importer.getModel();
+  std::string FileName = ("types-v" + Twine(PDBTypesCacheVersion) + "-"
+                          + model::Architecture::getName(Model->Architecture())
+                          + "-" + model::ABI::getName(Model->DefaultABI())
+                          + ".bin")
+                           .str();
+  return joinPath(getCacheDirectory(),
+                  "debug-symbols",
+                  "pe",
+                  PDBFileID,
+                  FileName);
+}
+
+bool PDBImporterImpl::loadTypesCache(StringRef Path,
+                                     TupleTree<model::Binary> &Fragment,
+                                     ProcessedTypeMap &FragmentTypes) {
+  if (not fileExists(Path))
+    return false;
+
+  auto MaybeBuffer = MemoryBuffer::getFile(Path);
+  if (not MaybeBuffer) {
+    revng_log(Log,
+              "Unable to read " << Path << ": "
+                                << MaybeBuffer.getError().message());
+    return false;
+  }
+
+  std::vector<uint32_t> Indices;
+  std::vector<uint64_t> IDs;
+  std::vector<model::TypeDefinitionKind::Values> Kinds;
+
+  TupleTree<model::Binary> Loaded;
+  revng::detail::BinaryTupleTreeReader Reader((*MaybeBuffer)->getBuffer());
+  if (Reader.readHeader()) {
+    Reader.read(*Loaded);
+    Reader.read(Indices);
+    Reader.read(IDs);
+    Reader.read(Kinds);
+  }
+
+  if (Reader.failed() or not Reader.atEnd() or Indices.size() != IDs.size()
+      or Indices.size() != Kinds.size()) {
+    revng_log(Log, "Ignoring malformed cache " << Path);
+    return false;
+  }
+
+  Fragment = std::move(Loaded);
+  Fragment.initializeReferences();
+  for (auto [Index, ID, Kind] : zip(Indices, IDs, Kinds))
+    FragmentTypes[TypeIndex(Index)] = Fragment->makeType({ ID, Kind });
+
+  return true;
+}
+
+void PDBImporterImpl::storeTypesCache(StringRef Path,
+                                      TupleTree<model::Binary> &Fragment,
+                                      const ProcessedTypeMap &FragmentTypes) {
+  std::vector<uint32_t> Indices;
+  std::vector<uint64_t> IDs;
+  std::vector<model::TypeDefinitionKind::Values> Kinds;
+  for (const auto &[Index, Type] : FragmentTypes) {
+    if (Type.isEmpty())
+      continue;
+
+    if (const model::TypeDefinition *Definition = Type->tryGetAsDefinition()) {
+      Indices.push_back(Index.getIndex());
+      IDs.push_back(Definition->ID());
+      Kinds.push_back(Definition->Kind());
+    }
+  }
+
+  if (auto EC = sys::fs::create_directories(sys::path::parent_path(Path))) {
+    revng_log(Log, "Unable to create the directory of " << Path);
+    return;
+  }
+
+  auto Write = [&](raw_ostream &Stream) {
+    revng::detail::BinaryTupleTreeWriter Writer(Stream);
+    Writer.writeHeader();
+    Writer.write(*Fragment);
+    Writer.write(Indices);
+    Writer.write(IDs);
+    Writer.write(Kinds);
+    return Error::success();
+  };
+
+  // Write to a temporary file first, so that concurrent importers never
+  // observe a partially written cache
+  std::string TemporaryPath = (Path + ".tmp-%%%%%%%%").str();
+  if (auto Result = writeFileAtomically(TemporaryPath, Path, Write)) {
+    revng_log(Log, "Unable to write " << Path << ": " << Result);
+    consumeError(std::move(Result));
+  }
+}
+
 void PDBImporter::import(const COFFObjectFile &TheBinary,
                          const ImporterOptions &Options) {
   if (Options.DebugInfo == DebugInfoLevel::No)
@@ -478,6 +665,11 @@ PDBImporter::getPDBFilePath(const COFFObjectFile &TheBinary) {
   if (auto MaybeCachedPDBPath = getCachedPDBFilePath(PDBFileID, PDBBaseName))
     return MaybeCachedPDBPath;
 
+  if (isKnownToBeMissing("pe", PDBFileID)) {
+    revng_log(Log, "Fetching " << PDBFileID << " failed recently, skipping.");
+    return std::nullopt;
+  }
+
   // Let's try finding it on web with the `fetch-debuginfo` tool.
   // If the `revng` cannot be found, avoid finding debug info.
   int ExitCode = runFetchDebugInfo(TheBinary.getFileName());
@@ -485,6 +677,7 @@ PDBImporter::getPDBFilePath(const COFFObjectFile &TheBinary) {
     revng_log(Log,
               "Failed to find debug info with `revng model "
               "fetch-debuginfo`.");
+    markAsMissing("pe", PDBFileID);
     return std::nullopt;
   }
 
@@ -724,7 +917,7 @@ Error PDBImporterTypeVisitor::visitKnownRecord(CVType &Record,
     }
 
     if (not WasReferenced) {
-      auto [_, NewType] = Model->recordNewType(std::move(NewDefinition));
+      auto NewType = Interner.record(std::move(NewDefinition));
       ProcessedTypes[CurrentTypeIndex] = std::move(NewType);
     } else {
       TypeIndex ForwardRef = ForwardReferencedTypes[CurrentTypeIndex];
@@ -805,7 +998,7 @@ Error PDBImporterTypeVisitor::visitKnownRecord(CVType &Record,
         }
       }
 
-      auto [_, NewType] = Model->recordNewType(std::move(NewDefinition));
+      auto NewType = Interner.record(std::move(NewDefinition));
       ProcessedTypes[FnTypeIndex] = std::move(NewType);
     }
   }
@@ -841,7 +1034,7 @@ Error PDBImporterTypeVisitor::visitKnownRecord(CVType &Record,
     EnumEntry.OriginalName() = Entry.getName().str();
   }
 
-  auto [_, NewType] = Model->recordNewType(std::move(NewDefinition));
+  auto NewType = Interner.record(std::move(NewDefinition));
   ProcessedTypes[CurrentTypeIndex] = std::move(NewType);
 
   return Error::success();
@@ -956,7 +1149,7 @@ Error PDBImporterTypeVisitor::visitKnownRecord(CVType &Record,
       }
     }
 
-    auto [_, NewType] = Model->recordNewType(std::move(NewDef));
+    auto NewType = Interner.record(std::move(NewDef));
     ProcessedTypes[CurrentTypeIndex] = std::move(NewType);
   }
 
@@ -1007,7 +1200,7 @@ Error PDBImporterTypeVisitor::visitKnownRecord(CVType &Record,
   }
 
   if (GeneratedAtLeastOneField) {
-    auto [_, NewType] = Model->recordNewType(std::move(NewDefinition));
+    auto NewType = Interner.record(std::move(NewDefinition));
     ProcessedTypes[CurrentTypeIndex] = std::move(NewType);
   }
 
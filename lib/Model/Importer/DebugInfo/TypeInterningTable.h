@@ -0,0 +1,73 @@
+#pragma once
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <string>
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "revng/Model/Binary.h"
+#include "revng/Support/Assert.h"
+#include "revng/TupleTree/BinarySerialization.h"
+
+/// Shares structurally identical type definitions while they are imported
+///
+/// Debug information usually contains a copy of each type for every
+/// compilation unit using it. Instead of recording all of them in the model
+/// and leaving it to `deduplicateEquivalentTypes` to collapse them later,
+/// importers can record definitions through this table, which returns the
+/// previously recorded definition when an identical one is recorded again.
+///
+/// \note only definitions that are complete when they are recorded can be
+///       interned: definitions that are populated after being recorded (e.g.,
+///       to import recursive types) must be recorded in the model directly.
+class TypeInterningTable {
+private:
+  TupleTree<model::Binary> &Model;
+
+  /// Map from the digest of the binary serialization of a definition, taken
+  /// before an ID is assigned to it, to the key of the recorded definition
+  llvm::StringMap<model::TypeDefinition::Key> Interned;
+  uint64_t HitCount = 0;
+
+public:
+  TypeInterningTable(TupleTree<model::Binary> &Model) : Model(Model) {}
+
+public:
+  /// Record \p Definition in the model, unless an identical definition has
+  /// already been recorded through this table
+  ///
+  /// \returns the type referring to the recorded definition.
+  model::UpcastableType record(model::UpcastableTypeDefinition &&Definition) {
+    revng_assert(not Definition.isEmpty());
+    revng_assert(Definition->ID() == 0);
+
+    std::string Serialized;
+    {
+      llvm::raw_string_ostream Stream(Serialized);
+      revng::detail::BinaryTupleTreeWriter Writer(Stream);
+      Writer.write(Definition);
+    }
+
+    auto Digest = llvm::SHA1::hash(llvm::arrayRefFromStringRef(Serialized));
+    llvm::StringRef Key(reinterpret_cast<const char *>(Digest.data()),
+                        Digest.size());
+
+    auto It = Interned.find(Key);
+    if (It != Interned.end()) {
+      ++HitCount;
+      return Model->makeType(It->second);
+    }
+
+    auto [Recorded, Type] = Model->recordNewType(std::move(Definition));
+    Interned.try_emplace(Key, Recorded.key());
+    return std::move(Type);
+  }
+
+  /// \returns how many definitions have been replaced by an existing one
+  uint64_t hitCount() const { return HitCount; }
+};
@@ -4,6 +4,15 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <map>
+#include <mutex>
+#include <set>
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Path.h"
+
 #include "revng/Model/Binary.h"
 #include "revng/Model/Importer/TypeCopier.h"
 #include "revng/Pipeline/RegisterAnalysis.h"
@@ -12,30 +21,99 @@
 
 namespace revng::pipes {
 
-class WellKnownFunctionKey {
+/// The well-known models shipped with revng, loaded once per process
+///
+/// Each model is looked for in its binary form first (`.model`), which is much
+/// cheaper to load than the corresponding `.yml`, and models are loaded only
+/// the first time a binary actually imports a dynamic function.
+class WellKnownModelsDatabase {
 public:
-  model::Architecture::Values Architecture;
-  model::ABI::Values ABI;
-  std::string Name;
+  struct WellKnownFunction {
+    model::Architecture::Values Architecture;
+    model::ABI::Values ABI;
+    size_t ModelIndex;
+    const model::Function *Function;
+  };
 
 private:
-  auto tie() const { return std::tie(Architecture, ABI, Name); }
+  std::mutex Mutex;
+  std::vector<TupleTree<model::Binary>> Models;
+  /// Exported names to the functions exporting them
+  llvm::StringMap<llvm::SmallVector<WellKnownFunction, 1>> Functions;
 
 public:
-  bool operator<(const WellKnownFunctionKey &Other) const {
-    return tie() < Other.tie();
+  static WellKnownModelsDatabase &get() {
+    static WellKnownModelsDatabase Instance;
+    return Instance;
   }
-};
 
-class WellKnownModel {
-public:
-  TupleTree<model::Binary> FromModel;
-  TypeCopier Copier;
+private:
+  WellKnownModelsDatabase() {
+    constexpr llvm::StringRef Directory = "share/revng/well-known-models";
+
+    std::set<std::string> Loaded;
+    auto Load = [&](const std::string &Path) {
+      if (not Loaded.insert(llvm::sys::path::stem(Path).str()).second)
+        return;
+
+      auto MaybeModel = TupleTree<model::Binary>::fromFile(Path);
+      revng_assert(MaybeModel);
+      Models.push_back(std::move(*MaybeModel));
+    };
+
+    for (const std::string &Path : revng::ResourceFinder.list(Directory,
+                                                              ".model"))
+      Load(Path);
+
+    for (const std::string &Path : revng::ResourceFinder.list(Directory,
+                                                              ".yml"))
+      Load(Path);
+
+    // Create an index of well-known functions
+    for (size_t Index = 0; Index < Models.size(); ++Index) {
+      auto &Model = Models[Index];
+      // Collect exported functions
+      for (const model::Function &F : Model->Functions()) {
+        for (const std::string &ExportedName : F.ExportedNames()) {
+          WellKnownFunction New = {
+            Model->Architecture(), Model->DefaultABI(), Index, &F
+          };
+
+          // Later models take precedence
+          auto &Entries = Functions[ExportedName];
+          auto IsSameTarget = [&New](const WellKnownFunction &Entry) {
+            return Entry.Architecture == New.Architecture
+                   and Entry.ABI == New.ABI;
+          };
+          auto It = llvm::find_if(Entries, IsSameTarget);
+          if (It != Entries.end())
+            *It = New;
+          else
+            Entries.push_back(New);
+        }
+      }
+    }
+  }
 
 public:
-  WellKnownModel(TupleTree<model::Binary> &&FromModel,
-                 TupleTree<model::Binary> &DestinationModel) :
-    FromModel(FromModel), Copier(this->FromModel, DestinationModel) {}
+  /// Callers should own this lock while using the database
+  std::mutex &mutex() { return Mutex; }
+
+  TupleTree<model::Binary> &model(size_t Index) { return Models[Index]; }
+
+  const WellKnownFunction *find(model::Architecture::Values Architecture,
+                                model::ABI::Values ABI,
+                                llvm::StringRef Name) const {
+    auto It = Functions.find(Name);
+    if (It == Functions.end())
+      return nullptr;
+
+    for (const WellKnownFunction &Entry : It->second)
+      if (Entry.Architecture == Architecture and Entry.ABI == ABI)
+        return &Entry;
+
+    return nullptr;
+  }
 };
 
 class ImportWellKnownModelsAnalysis {
@@ -47,60 +125,41 @@ public:
 
 public:
   llvm::Error run(pipeline::ExecutionContext &Context) {
-    std::vector<std::unique_ptr<WellKnownModel>> WellKnownModels;
-    std::map<WellKnownFunctionKey,
-             std::pair<WellKnownModel *, model::Function *>>
-      WellKnownFunctions;
     TupleTree<model::Binary> &Model = getWritableModelFromContext(Context);
+    if (Model->ImportedDynamicFunctions().empty())
+      return llvm::Error::success();
 
-    // Load all well-known models
-    for (const std::string &Path :
-         revng::ResourceFinder.list("share/revng/well-known-models", ".yml")) {
-      auto MaybeModel = TupleTree<model::Binary>::fromFile(Path);
-      revng_assert(MaybeModel);
-      using namespace std;
-      auto NewWKM = make_unique<WellKnownModel>(std::move(*MaybeModel), Model);
-      WellKnownModels.push_back(std::move(NewWKM));
-    }
+    auto &Database = WellKnownModelsDatabase::get();
+    std::lock_guard Lock(Database.mutex());
 
-    // Create an index of well-known functions
-    for (auto &WellKnownModel : WellKnownModels) {
-      auto &Model = WellKnownModel->FromModel;
-      // Collect exported functions
-      for (model::Function &F : Model->Functions()) {
-        for (const std::string &ExportedName : F.ExportedNames()) {
-          WellKnownFunctions[{
-            Model->Architecture(), Model->DefaultABI(), ExportedName }] = {
-            WellKnownModel.get(), &F
-          };
-        }
-      }
-    }
+    // Only the models actually providing a function get a copier
+    std::map<size_t, TypeCopier> Copiers;
 
     for (model::DynamicFunction &F : Model->ImportedDynamicFunctions()) {
-      // Compose the key
-      WellKnownFunctionKey Key = { Model->Architecture(),
-                                   Model->DefaultABI(),
-                                   F.OriginalName() };
-
       // See if it's a well-known function
-      auto It = WellKnownFunctions.find(Key);
-      if (It != WellKnownFunctions.end()) {
-        model::Function *WellKnownFunction = It->second.second;
-
-        // Copy attributes
-        F.Attributes() = WellKnownFunction->Attributes();
-
-        // Copy prototype
-        if (const auto *NewPrototype = WellKnownFunction->prototype()) {
-          TypeCopier &Copier = It->second.first->Copier;
-          F.Prototype() = Copier.copyTypeInto(*NewPrototype);
-        }
+      const auto *Match = Database.find(Model->Architecture(),
+                                        Model->DefaultABI(),
+                                        F.OriginalName());
+      if (Match == nullptr)
+        continue;
+
+      const model::Function *WellKnownFunction = Match->Function;
+
+      // Copy attributes
+      F.Attributes() = WellKnownFunction->Attributes();
+
+      // Copy prototype
+      if (const auto *NewPrototype = WellKnownFunction->prototype()) {
+        auto &FromModel = Database.model(Match->ModelIndex);
+        TypeCopier &Copier = Copiers
+                               .try_emplace(Match->ModelIndex, FromModel, Model)
+                               .first->second;
+        F.Prototype() = Copier.copyTypeInto(*NewPrototype);
       }
     }
 
-    for (auto &WLF : WellKnownModels)
-      WLF->Copier.finalize();
+    for (auto &[_, Copier] : Copiers)
+      Copier.finalize();
 
     return llvm::Error::success();
   }
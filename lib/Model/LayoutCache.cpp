@@ -0,0 +1,22 @@
+/// \file LayoutCache.cpp
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include "revng/Model/LayoutCache.h"
+
+static thread_local model::LayoutCacheScope *CurrentScope = nullptr;
+
+model::LayoutCacheScope::LayoutCacheScope() : Previous(CurrentScope) {
+  CurrentScope = this;
+}
+
+model::LayoutCacheScope::~LayoutCacheScope() {
+  revng_assert(CurrentScope == this);
+  CurrentScope = Previous;
+}
+
+model::LayoutCacheScope *model::LayoutCacheScope::current() {
+  return CurrentScope;
+}
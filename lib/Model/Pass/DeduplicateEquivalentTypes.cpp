@@ -5,8 +5,11 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <unordered_set>
+
 #include "llvm/ADT/DepthFirstIterator.h"
 #include "llvm/ADT/EquivalenceClasses.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/PostOrderIterator.h"
 
 #include "revng/ADT/GenericGraph.h"
@@ -44,6 +47,9 @@ class TypeSystemDeduplicator {
 private:
   struct TypeNode {
     model::TypeDefinition *T;
+
+    /// Strongly equivalent types are guaranteed to have the same hash
+    size_t StructuralHash = 0;
   };
   using Node = ForwardNode<TypeNode>;
   using Graph = GenericGraph<Node>;
@@ -68,6 +74,7 @@ public:
     TypeSystemDeduplicator Helper(Model);
     Helper.computeWeakEquivalenceClasses();
     Helper.createTypeGraph();
+    Helper.computeStructuralHashes();
     Helper.computeVisitOrder();
     Helper.computeStrongEquivalenceClasses();
     return std::move(Helper.StrongEquivalence);
@@ -162,6 +169,58 @@ private:
         addEdge(*Type, *EdgeType);
   }
 
+  /// Compute a hash of each type such that strongly equivalent types have the
+  /// same hash, so that only types with the same hash need to be compared
+  ///
+  /// This starts from a hash of the properties of each type compared by
+  /// `localCompare` and, at each round, combines the hash of each type with
+  /// the hashes of its successors, in order. Since this mirrors how
+  /// `deepCompare` matches successors, equivalent types never get different
+  /// hashes. Each round refines the partition induced by the hashes of the
+  /// previous one: as soon as the number of distinct hashes stops changing,
+  /// further rounds would not tell apart any more types.
+  void computeStructuralHashes() {
+    revng_log(Log, "Computing structural hashes");
+
+    auto CountDistinct = [this]() {
+      std::unordered_set<size_t> Hashes;
+      for (Node *N : TypeGraph.nodes())
+        Hashes.insert(N->StructuralHash);
+      return Hashes.size();
+    };
+
+    for (Node *N : TypeGraph.nodes()) {
+      size_t SuccessorsCount = llvm::size(N->successors());
+      N->StructuralHash = llvm::hash_combine(N->T->Kind(),
+                                             N->T->OriginalName(),
+                                             SuccessorsCount);
+    }
+
+    constexpr unsigned MaxRounds = 32;
+    size_t DistinctCount = CountDistinct();
+    std::vector<size_t> NewHashes;
+    for (unsigned Round = 0; Round < MaxRounds; ++Round) {
+      NewHashes.clear();
+      for (Node *N : TypeGraph.nodes()) {
+        llvm::hash_code Hash = N->StructuralHash;
+        for (Node *Successor : N->successors())
+          Hash = llvm::hash_combine(Hash, Successor->StructuralHash);
+        NewHashes.push_back(Hash);
+      }
+
+      for (auto [N, Hash] : zip(TypeGraph.nodes(), NewHashes))
+        N->StructuralHash = Hash;
+
+      size_t NewDistinctCount = CountDistinct();
+      revng_log(Log,
+                "Round " << Round << ": " << NewDistinctCount
+                         << " distinct hashes");
+      if (NewDistinctCount == DistinctCount)
+        break;
+      DistinctCount = NewDistinctCount;
+    }
+  }
+
   /// Compute a visit order: post order in the leaders of WeakEquivalence
   void computeVisitOrder() {
     revng_log(Log, "Computing visit order");
@@ -196,10 +255,13 @@ private:
       auto LeaderIt = WeakEquivalence.findValue(Leader);
       revng_assert(LeaderIt->isLeader());
 
-      SmallVector<model::TypeDefinition *> ToTest;
-      std::copy(WeakEquivalence.member_begin(LeaderIt),
-                WeakEquivalence.member_end(),
-                std::back_inserter(ToTest));
+      // Types with different structural hashes cannot be strongly
+      // equivalent: only compare types within the same bucket
+      std::map<size_t, SmallVector<model::TypeDefinition *>> Buckets;
+      for (model::TypeDefinition *Member :
+           make_range(WeakEquivalence.member_begin(LeaderIt),
+                      WeakEquivalence.member_end()))
+        Buckets[TypeToNode.at(Member)->StructuralHash].push_back(Member);
 
       auto Compare = [this](model::TypeDefinition *Left,
                             model::TypeDefinition *Right) {
@@ -216,7 +278,8 @@ private:
         return Result;
       };
 
-      compareAll(ToTest, Compare);
+      for (auto &[Hash, ToTest] : Buckets)
+        compareAll(ToTest, Compare);
     }
   }
 
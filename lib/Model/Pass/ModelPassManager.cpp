@@ -0,0 +1,82 @@
+/// \file ModelPassManager.cpp
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <set>
+
+#include "llvm/Support/ThreadPool.h"
+
+#include "revng/Model/Pass/ModelPassManager.h"
+#include "revng/Support/Debug.h"
+
+using namespace llvm;
+
+static Logger<> Log("model-pass-manager");
+
+Error ModelPassManager::add(StringRef Name) {
+  const Pass *ToAdd = RegisterModelPass::lookup(Name);
+  if (ToAdd == nullptr)
+    return createStringError(inconvertibleErrorCode(),
+                             "Pass not found: " + Name);
+
+  add(*ToAdd);
+  return Error::success();
+}
+
+std::vector<std::vector<const ModelPassManager::Pass *>>
+ModelPassManager::schedule() const {
+  std::vector<std::vector<const Pass *>> Result;
+
+  // The read-only passes that have run and whose input has not changed since
+  std::set<const Pass *> UpToDate;
+
+  for (const Pass *Current : Passes) {
+    const ModelPassEffects &Effects = Current->Effects;
+
+    if (UpToDate.contains(Current)) {
+      revng_log(Log, "Skipping " << Current->Name << ": nothing changed");
+      continue;
+    }
+
+    auto ConflictsWithCurrent = [&Effects](const Pass *Other) {
+      return Other->Effects.conflictsWith(Effects);
+    };
+    if (Result.empty() or any_of(Result.back(), ConflictsWithCurrent))
+      Result.emplace_back();
+    Result.back().push_back(Current);
+
+    if (Effects.isReadOnly()) {
+      UpToDate.insert(Current);
+    } else {
+      std::erase_if(UpToDate, [&Effects](const Pass *Other) {
+        return (Other->Effects.Reads & Effects.Writes) != 0;
+      });
+    }
+  }
+
+  return Result;
+}
+
+void ModelPassManager::run(TupleTree<model::Binary> &Model) const {
+  for (const std::vector<const Pass *> &Group : schedule()) {
+    if (Group.size() == 1) {
+      revng_log(Log, "Running " << Group[0]->Name);
+      Group[0]->Pass(Model);
+      continue;
+    }
+
+    if (Log.isEnabled()) {
+      Log << "Running concurrently:";
+      for (const Pass *Current : Group)
+        Log << " " << Current->Name;
+      Log << DoLog;
+    }
+
+    ThreadPool Pool(hardware_concurrency(Threads));
+    for (const Pass *Current : Group)
+      Pool.async([Current, &Model] { Current->Pass(Model); });
+    Pool.wait();
+  }
+}
@@ -13,10 +13,16 @@
 using namespace llvm;
 using namespace model;
 
+static constexpr uint8_t Names = ModelPassEffects::Functions
+                                 | ModelPassEffects::ImportedDynamicFunctions
+                                 | ModelPassEffects::TypeDefinitions
+                                 | ModelPassEffects::Segments;
+
 static RegisterModelPass R("promote-original-name",
                            "Promote OriginalName fields to CustomName ensuring "
                            "the validity of the model is preserved",
-                           model::promoteOriginalName);
+                           model::promoteOriginalName,
+                           { .Reads = Names, .Writes = Names });
 
 class SymbolPromoter {
 private:
@@ -4,9 +4,10 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
-#include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallVector.h"
 
-#include "revng/ADT/GenericGraph.h"
+#include "revng/ADT/RecursiveCoroutine.h"
 #include "revng/Model/Filters.h"
 #include "revng/Model/Pass/PurgeUnnamedAndUnreachableTypes.h"
 #include "revng/Model/Pass/RegisterModelPass.h"
@@ -24,12 +25,14 @@ static RegisterModelPass R("purge-unnamed-and-unreachable-types",
                            "Remove all the types that cannot be reached from "
                            "any named type or a type \"outside\" the type "
                            "system itself",
-                           model::purgeUnnamedAndUnreachableTypes);
+                           model::purgeUnnamedAndUnreachableTypes,
+                           { .Writes = ModelPassEffects::TypeDefinitions });
 
 static RegisterModelPass R2("purge-unreachable-types",
                             "Remove all the types that cannot be reached from "
                             "a type \"outside\" the type system itself",
-                            model::purgeUnreachableTypes);
+                            model::purgeUnreachableTypes,
+                            { .Writes = ModelPassEffects::TypeDefinitions });
 
 // Helper for fixing array constness.
 static RecursiveCoroutine<void> fixConstArrays(model::Type &Type) {
@@ -138,53 +141,51 @@ void model::purgeUnreachableTypes(TupleTree<model::Binary> &Model) {
 
 static void model::purgeTypesImpl(TupleTree<model::Binary> &Model,
                                   bool KeepTypesWithName) {
-  struct NodeData {
-    const model::TypeDefinition *T;
+  // Mark phase: starting from the roots, follow the edges of the type system
+  // on demand. The definitions that are not reachable are never expanded and
+  // no graph of the whole type system is built.
+  llvm::DenseSet<const model::TypeDefinition *> Reachable;
+  llvm::SmallVector<const model::TypeDefinition *, 16> Worklist;
+  auto Mark = [&](const model::TypeDefinition *T) {
+    if (Reachable.insert(T).second)
+      Worklist.push_back(T);
   };
-  using Node = ForwardNode<NodeData>;
-  using Graph = GenericGraph<Node>;
 
-  Graph TypeGraph;
-  std::map<const model::TypeDefinition *, Node *> TypeToNode;
-
-  llvm::SmallPtrSet<const model::TypeDefinition *, 16> ToKeep;
-
-  // Remember those types we want to preserve.
-  for (const model::UpcastableTypeDefinition &T : Model->TypeDefinitions()) {
-    if (KeepTypesWithName)
+  // Named types are roots
+  if (KeepTypesWithName)
+    for (const model::UpcastableTypeDefinition &T : Model->TypeDefinitions())
       if (not T->CustomName().empty() or not T->OriginalName().empty())
-        ToKeep.insert(T.get());
+        Mark(T.get());
 
-    TypeToNode[T.get()] = TypeGraph.addNode(NodeData{ T.get() });
-  }
-
-  // Create type system edges
-  for (const model::UpcastableTypeDefinition &D : Model->TypeDefinitions())
-    for (const model::Type *Edge : D->edges())
-      if (const model::TypeDefinition *Definition = Edge->skipToDefinition())
-        TypeToNode.at(D.get())->addSuccessor(TypeToNode.at(Definition));
+  // If everything is a root, there's nothing to purge
+  if (Reachable.size() == Model->TypeDefinitions().size())
+    return;
 
-  // Record references to types *outside* of Model->Types
+  // References to types *outside* of Model->Types are roots too
   auto VisitBinary = [&](auto &Field) {
     auto Visitor = [&](auto &Element) {
       using type = std::decay_t<decltype(Element)>;
       if constexpr (std::is_same_v<type, DefinitionReference>)
         if (Element.isValid())
-          ToKeep.insert(Element.get());
+          Mark(Element.get());
     };
     visitTupleTree(Field, Visitor, [](auto) {});
   };
   visitTupleExcept(VisitBinary, *Model, &Model->TypeDefinitions());
 
-  // Visit all the nodes reachable from ToKeep
-  df_iterator_default_set<Node *> Visited;
-  for (const model::TypeDefinition *T : ToKeep)
-    for (Node *N : depth_first_ext(TypeToNode.at(T), Visited))
-      ;
-
-  // Purge the non-visited
-  llvm::erase_if(Model->TypeDefinitions(),
-                 [&](const model::UpcastableTypeDefinition &P) {
-                   return not Visited.contains(TypeToNode.at(P.get()));
-                 });
+  while (not Worklist.empty()) {
+    const model::TypeDefinition *T = Worklist.pop_back_val();
+    for (const model::Type *Edge : T->edges())
+      if (const model::TypeDefinition *Definition = Edge->skipToDefinition())
+        Mark(Definition);
+  }
+
+  // Purge the unmarked
+  auto IsUnreachable = [&](const model::UpcastableTypeDefinition &P) {
+    return not Reachable.contains(P.get());
+  };
+  size_t PurgedCount = llvm::count_if(Model->TypeDefinitions(), IsUnreachable);
+  revng_log(Log, "Purging " << PurgedCount << " unreachable types.");
+  if (PurgedCount != 0)
+    llvm::erase_if(Model->TypeDefinitions(), IsUnreachable);
 }
@@ -16,8 +16,9 @@ using namespace model;
 static RegisterModelPass R("verify",
                            "Verifies that there are no serious issues with the "
                            "model",
-                           model::verify);
+                           model::verify,
+                           { .Writes = ModelPassEffects::None });
 
 void model::verify(TupleTree<model::Binary> &Model) {
-  Model->verify(true);
+  Model->verifyInParallel(true);
 }
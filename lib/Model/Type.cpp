@@ -5,6 +5,7 @@
 //
 
 #include "revng/Model/Binary.h"
+#include "revng/Model/LayoutCache.h"
 
 // NOTE: there's a really similar function for computing alignment in
 //       `lib/ABI/Definition.cpp`. It's better if two are kept in sync, so
@@ -36,6 +37,9 @@ model::Type::trySize(model::VerifyHelper &VH) const {
 }
 
 std::optional<uint64_t> model::Type::trySize() const {
+  if (auto *Scope = model::LayoutCacheScope::current())
+    return trySize(Scope->sizes());
+
   model::VerifyHelper VH;
   return trySize(VH);
 }
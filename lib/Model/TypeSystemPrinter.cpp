@@ -24,6 +24,7 @@ using model::StructDefinition;
 using model::TypedefDefinition;
 using model::UnionDefinition;
 using std::to_string;
+using TD = model::TypeDefinition;
 
 using FieldList = llvm::SmallVector<const model::Type *, 16>;
 
@@ -438,6 +439,9 @@ void TypeSystemPrinter::print(const model::TypeDefinition &T) {
       if (DefinitionPointer == nullptr)
         continue;
 
+      if (Filter != nullptr and not Filter->contains(DefinitionPointer))
+        continue;
+
       uint64_t SuccID;
       auto It = NodesMap.find(DefinitionPointer);
       if (It != NodesMap.end()) {
@@ -665,3 +669,52 @@ void TypeSystemPrinter::print(const model::Binary &Model) {
     if (!NodesMap.contains(T.get()))
       print(*T);
 }
+
+void TypeSystemPrinter::printNeighbourhood(const model::Binary &Model,
+                                           llvm::ArrayRef<const TD *> Roots,
+                                           unsigned Depth) {
+  // Collect the users of each type, in order to follow edges backwards
+  llvm::DenseMap<const TD *, llvm::SmallVector<const TD *, 2>> Users;
+  if (Depth > 0)
+    for (const model::UpcastableTypeDefinition &T : Model.TypeDefinitions())
+      for (const model::Type *Edge : T->edges())
+        if (const TD *Definition = Edge->skipToDefinition())
+          Users[Definition].push_back(T.get());
+
+  // Breadth-first visit, up to Depth edges away from the roots
+  llvm::DenseSet<const TD *> Neighbourhood(Roots.begin(), Roots.end());
+  std::vector<const TD *> Frontier(Roots.begin(), Roots.end());
+  for (unsigned Distance = 0; Distance < Depth; ++Distance) {
+    std::vector<const TD *> Next;
+    auto Reach = [&Neighbourhood, &Next](const TD *T) {
+      if (Neighbourhood.insert(T).second)
+        Next.push_back(T);
+    };
+
+    for (const TD *T : Frontier) {
+      for (const model::Type *Edge : T->edges())
+        if (const TD *Definition = Edge->skipToDefinition())
+          Reach(Definition);
+
+      if (auto It = Users.find(T); It != Users.end())
+        for (const TD *User : It->second)
+          Reach(User);
+    }
+
+    Frontier = std::move(Next);
+  }
+
+  Filter = &Neighbourhood;
+
+  for (const TD *Root : Roots)
+    if (not NodesMap.contains(Root))
+      print(*Root);
+
+  // Print the rest of the neighbourhood that is not reachable from the roots
+  // (e.g., their users)
+  for (const model::UpcastableTypeDefinition &T : Model.TypeDefinitions())
+    if (Neighbourhood.contains(T.get()) and not NodesMap.contains(T.get()))
+      print(*T);
+
+  Filter = nullptr;
+}
@@ -4,9 +4,13 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <set>
+
 #include "llvm/ADT/SmallSet.h"
+#include "llvm/Support/Parallel.h"
 
 #include "revng/Model/Binary.h"
+#include "revng/Model/GlobalNamespace.h"
 
 using namespace llvm;
 
@@ -17,7 +21,10 @@ namespace model {
 //
 
 bool VerifyHelper::isGlobalSymbol(const model::Identifier &Name) const {
-  return GlobalSymbols.count(Name) > 0;
+  if (GlobalSymbols.count(Name) > 0)
+    return true;
+
+  return Parent != nullptr and Parent->isGlobalSymbol(Name);
 }
 
 bool VerifyHelper::registerGlobalSymbol(const model::Identifier &Name,
@@ -41,33 +48,6 @@ bool VerifyHelper::registerGlobalSymbol(const model::Identifier &Name,
   }
 }
 
-template<typename T>
-static std::string key(const T &Object) {
-  return getNameFromYAMLScalar(KeyedObjectTraits<T>::key(Object));
-}
-
-static std::string path(const model::Function &F) {
-  return "/Functions/" + key(F);
-}
-
-static std::string path(const model::DynamicFunction &F) {
-  return "/ImportedDynamicFunctions/" + key(F);
-}
-
-static std::string path(const model::TypeDefinition &T) {
-  return "/TypeDefinitions/" + key(T);
-}
-
-static std::string path(const model::EnumDefinition &D,
-                        const model::EnumEntry &Entry) {
-  return path(static_cast<const model::TypeDefinition &>(D))
-         + "/EnumDefinition/Entries/" + key(Entry);
-}
-
-static std::string path(const model::Segment &Segment) {
-  return "/Segments/" + key(Segment);
-}
-
 bool model::Binary::verifyGlobalNamespace(VerifyHelper &VH) const {
 
   // Namespacing rules:
@@ -81,30 +61,31 @@ bool model::Binary::verifyGlobalNamespace(VerifyHelper &VH) const {
   // Verify needs to verify that each namespace has no internal clashes.
   // Also, the global namespace clashes with everything.
   for (const Function &F : Functions()) {
-    if (not VH.registerGlobalSymbol(F.CustomName(), path(F)))
+    if (not VH.registerGlobalSymbol(F.CustomName(), globalSymbolPath(F)))
       return VH.fail("Duplicate name", F);
   }
 
   // Verify DynamicFunctions
   for (const DynamicFunction &DF : ImportedDynamicFunctions()) {
-    if (not VH.registerGlobalSymbol(DF.CustomName(), path(DF)))
+    if (not VH.registerGlobalSymbol(DF.CustomName(), globalSymbolPath(DF)))
       return VH.fail();
   }
 
   // Verify types and enum entries
   for (const model::UpcastableTypeDefinition &Def : TypeDefinitions()) {
-    if (not VH.registerGlobalSymbol(Def->CustomName(), path(*Def)))
+    if (not VH.registerGlobalSymbol(Def->CustomName(), globalSymbolPath(*Def)))
       return VH.fail();
 
     if (auto *Enum = dyn_cast<model::EnumDefinition>(Def.get()))
       for (auto &Entry : Enum->Entries())
-        if (not VH.registerGlobalSymbol(Entry.CustomName(), path(*Enum, Entry)))
+        if (not VH.registerGlobalSymbol(Entry.CustomName(),
+                                        globalSymbolPath(*Enum, Entry)))
           return VH.fail();
   }
 
   // Verify Segments
   for (const Segment &S : Segments()) {
-    if (not VH.registerGlobalSymbol(S.CustomName(), path(S)))
+    if (not VH.registerGlobalSymbol(S.CustomName(), globalSymbolPath(S)))
       return VH.fail();
   }
 
@@ -749,6 +730,32 @@ RecursiveCoroutine<bool> TypeDefinition::verify(VerifyHelper &VH) const {
   rc_return VH.maybeFail(Result);
 }
 
+/// Verify the properties of \p Definition that depend on the rest of the
+/// binary, as opposed to the ones checked by `TypeDefinition::verify`
+static bool verifyInBinary(VerifyHelper &VH,
+                           const Binary &Binary,
+                           const model::TypeDefinition &Definition,
+                           std::set<Identifier> &Names) {
+  // Ensure the names are unique
+  auto Name = Definition.name();
+  if (not Names.insert(Name).second)
+    return VH.fail(Twine("Multiple types with the following name: ") + Name);
+
+  using CFT = model::CABIFunctionDefinition;
+  using RFT = model::RawFunctionDefinition;
+  if (const auto *T = llvm::dyn_cast<CFT>(&Definition)) {
+    if (getArchitecture(T->ABI()) != Binary.Architecture())
+      return VH.fail("Function type architecture differs from the binary "
+                     "architecture");
+  } else if (const auto *T = llvm::dyn_cast<RFT>(&Definition)) {
+    if (T->Architecture() != Binary.Architecture())
+      return VH.fail("Function type architecture differs from the binary "
+                     "architecture");
+  }
+
+  return true;
+}
+
 bool Binary::verifyTypeDefinitions(VerifyHelper &VH) const {
   auto Guard = VH.suspendTracking(*this);
 
@@ -758,22 +765,8 @@ bool Binary::verifyTypeDefinitions(VerifyHelper &VH) const {
     if (not Definition.get()->verify(VH))
       return VH.fail();
 
-    // Ensure the names are unique
-    auto Name = Definition->name();
-    if (not Names.insert(Name).second)
-      return VH.fail(Twine("Multiple types with the following name: ") + Name);
-
-    using CFT = model::CABIFunctionDefinition;
-    using RFT = model::RawFunctionDefinition;
-    if (const auto *T = llvm::dyn_cast<CFT>(Definition.get())) {
-      if (getArchitecture(T->ABI()) != Architecture())
-        return VH.fail("Function type architecture differs from the binary "
-                       "architecture");
-    } else if (const auto *T = llvm::dyn_cast<RFT>(Definition.get())) {
-      if (T->Architecture() != Architecture())
-        return VH.fail("Function type architecture differs from the binary "
-                       "architecture");
-    }
+    if (not verifyInBinary(VH, *this, *Definition, Names))
+      return VH.fail();
   }
 
   return true;
@@ -783,6 +776,19 @@ bool Binary::verifyTypeDefinitions(VerifyHelper &VH) const {
 // Binary
 //
 
+static bool verifyNoOverlaps(VerifyHelper &VH, const auto &Segments) {
+  for (const auto &[LHS, RHS] : zip_pairs(Segments)) {
+    revng_assert(LHS.StartAddress() <= RHS.StartAddress());
+    if (LHS.endAddress() > RHS.StartAddress()) {
+      std::string Error = "Overlapping segments:\n" + ::toString(LHS) + "and\n"
+                          + ::toString(RHS);
+      return VH.fail(Error);
+    }
+  }
+
+  return true;
+}
+
 bool Binary::verify(VerifyHelper &VH) const {
   auto Guard = VH.suspendTracking(*this);
 
@@ -806,15 +812,8 @@ bool Binary::verify(VerifyHelper &VH) const {
     if (not S.verify(VH))
       return VH.fail();
 
-  // Make sure no segments overlap
-  for (const auto &[LHS, RHS] : zip_pairs(Segments())) {
-    revng_assert(LHS.StartAddress() <= RHS.StartAddress());
-    if (LHS.endAddress() > RHS.StartAddress()) {
-      std::string Error = "Overlapping segments:\n" + ::toString(LHS) + "and\n"
-                          + ::toString(RHS);
-      return VH.fail(Error);
-    }
-  }
+  if (not verifyNoOverlaps(VH, Segments()))
+    return VH.fail();
 
   //
   // Verify the type system
@@ -822,6 +821,239 @@ bool Binary::verify(VerifyHelper &VH) const {
   return verifyTypeDefinitions(VH);
 }
 
+template<typename T>
+static llvm::ArrayRef<const T *> shard(const std::vector<const T *> &Elements,
+                                       size_t Index,
+                                       size_t Count) {
+  size_t Begin = Elements.size() * Index / Count;
+  size_t End = Elements.size() * (Index + 1) / Count;
+  return llvm::ArrayRef(Elements).slice(Begin, End - Begin);
+}
+
+template<typename T>
+static std::vector<const T *> pointersTo(const auto &Container) {
+  std::vector<const T *> Result;
+  Result.reserve(Container.size());
+  for (const auto &Element : Container) {
+    if constexpr (SpecializationOf<std::decay_t<decltype(Element)>,
+                                   UpcastablePointer>)
+      Result.push_back(Element.get());
+    else
+      Result.push_back(&Element);
+  }
+  return Result;
+}
+
+bool Binary::verifyInParallel(bool Assert) const {
+  // Reading the model while tracking is active writes to it
+  PauseTracking<model::Binary> Pause(*this);
+
+  VerifyHelper VH(Assert);
+  auto Guard = VH.suspendTracking(*this);
+
+  // The checks requiring a global view of the binary are cheap compared to
+  // verifying the objects themselves, perform them upfront
+  if (not verifyGlobalNamespace(VH))
+    return VH.fail();
+
+  if (not verifyNoOverlaps(VH, Segments()))
+    return VH.fail();
+
+  std::set<Identifier> Names;
+  for (const model::UpcastableTypeDefinition &Definition : TypeDefinitions())
+    if (not verifyInBinary(VH, *this, *Definition, Names))
+      return VH.fail();
+
+  auto AllFunctions = pointersTo<Function>(Functions());
+  auto AllDynamicFunctions = pointersTo<DynamicFunction>(
+    ImportedDynamicFunctions());
+  auto AllSegments = pointersTo<Segment>(Segments());
+  auto AllDefinitions = pointersTo<TypeDefinition>(TypeDefinitions());
+
+  // Use more shards than threads, so that a shard full of large types does
+  // not end up being the only one still running. Each shard has its own
+  // caches: a type referenced from multiple shards is verified more than once.
+  const size_t ShardCount = 4 * llvm::parallel::strategy.compute_thread_count();
+  std::vector<std::optional<std::string>> Failures(ShardCount);
+  llvm::parallelForEachN(0, ShardCount, [&](size_t Index) {
+    VerifyHelper ShardVH = VH.makeShard();
+    auto Verify = [&](const auto &Elements) {
+      for (const auto *Element : shard(Elements, Index, ShardCount))
+        if (not Element->verify(ShardVH))
+          return false;
+      return true;
+    };
+
+    if (not Verify(AllFunctions) or not Verify(AllDynamicFunctions)
+        or not Verify(AllSegments) or not Verify(AllDefinitions))
+      Failures[Index] = ShardVH.getReason();
+  });
+
+  for (const std::optional<std::string> &Failure : Failures)
+    if (Failure.has_value())
+      return VH.fail(*Failure);
+
+  return true;
+}
+
+//
+// Incremental verification
+//
+
+template<typename T>
+using KeyOf = std::remove_cvref_t<
+  decltype(KeyedObjectTraits<T>::key(std::declval<const T &>()))>;
+
+/// Record in \p Keys the key of the `T` touched by \p TheChange, unless it has
+/// been removed
+///
+/// \return false if the change cannot be mapped to an element
+template<typename T>
+static bool collectTouched(const Change<model::Binary> &TheChange,
+                           std::set<KeyOf<T>> &Keys) {
+  const TupleTreePath &Path = TheChange.Path;
+  revng_assert(Path.size() > 0);
+
+  if (Path.size() > 1) {
+    // A change within the element
+    const auto *Key = Path[1].tryGet<KeyOf<T>>();
+    if (Key == nullptr)
+      return false;
+
+    Keys.insert(*Key);
+    return true;
+  }
+
+  // The whole element has been added or removed
+  if (not TheChange.New.has_value())
+    return true;
+
+  const auto *Element = std::get_if<T>(&*TheChange.New);
+  if (Element == nullptr)
+    return false;
+
+  Keys.insert(KeyedObjectTraits<T>::key(*Element));
+  return true;
+}
+
+/// \return true if any of \p Names is used as the name of a field or of an
+///         argument, which would collide with the global namespace
+static bool
+collidesWithLocalNames(const model::Binary &Model,
+                       const std::set<model::Identifier> &Names) {
+  if (Names.empty())
+    return false;
+
+  auto Collides = [&Names](const auto &Range) {
+    return llvm::any_of(Range, [&Names](const auto &Element) {
+      return Names.contains(Element.CustomName());
+    });
+  };
+
+  for (const model::UpcastableTypeDefinition &Def : Model.TypeDefinitions()) {
+    const model::TypeDefinition *T = Def.get();
+    if (auto *Struct = dyn_cast<model::StructDefinition>(T)) {
+      if (Collides(Struct->Fields()))
+        return true;
+    } else if (auto *Union = dyn_cast<model::UnionDefinition>(T)) {
+      if (Collides(Union->Fields()))
+        return true;
+    } else if (auto *CFT = dyn_cast<model::CABIFunctionDefinition>(T)) {
+      if (Collides(CFT->Arguments()))
+        return true;
+    } else if (auto *RFT = dyn_cast<model::RawFunctionDefinition>(T)) {
+      if (Collides(RFT->Arguments()))
+        return true;
+    }
+  }
+
+  return false;
+}
+
+bool verifyAfterDiff(const model::Binary &Model,
+                     const TupleTreeDiff<model::Binary> &Diff,
+                     VerifyHelper &VH) {
+  auto Guard = VH.suspendTracking(Model);
+
+  using Fields = TupleLikeTraits<model::Binary>::Fields;
+  constexpr auto FunctionsIndex = static_cast<size_t>(Fields::Functions);
+  constexpr auto DynamicFunctionsIndex = static_cast<size_t>(
+    Fields::ImportedDynamicFunctions);
+  constexpr auto SegmentsIndex = static_cast<size_t>(Fields::Segments);
+
+  std::set<KeyOf<model::Function>> Functions;
+  std::set<KeyOf<model::DynamicFunction>> DynamicFunctions;
+  std::set<KeyOf<model::Segment>> Segments;
+  bool SegmentsChanged = false;
+  for (const auto &Change : Diff.Changes) {
+    const TupleTreePath &Path = Change.Path;
+    const size_t *Field = Path.empty() ? nullptr : Path[0].tryGet<size_t>();
+
+    bool Understood = false;
+    if (Field == nullptr) {
+      Understood = false;
+    } else if (*Field == FunctionsIndex) {
+      Understood = collectTouched<model::Function>(Change, Functions);
+    } else if (*Field == DynamicFunctionsIndex) {
+      Understood = collectTouched<model::DynamicFunction>(Change,
+                                                          DynamicFunctions);
+    } else if (*Field == SegmentsIndex) {
+      Understood = collectTouched<model::Segment>(Change, Segments);
+      SegmentsChanged = true;
+    }
+
+    // Anything else (most notably, type definitions) can affect objects that
+    // are not part of the diff: verify everything
+    if (not Understood)
+      return Model.verify(VH);
+  }
+
+  // Populating the global namespace is cheap compared to verifying all the
+  // objects in it, and the type definitions we're about to verify need it
+  if (not Model.verifyGlobalNamespace(VH))
+    return VH.fail();
+
+  // A touched object might have been given a name that was already used by an
+  // argument or a field of a type that has not been touched
+  std::set<model::Identifier> TouchedNames;
+
+  for (const auto &Key : Functions) {
+    if (const model::Function *F = Model.Functions().tryGet(Key)) {
+      if (not F->verify(VH))
+        return VH.fail();
+      if (not F->CustomName().empty())
+        TouchedNames.insert(F->CustomName());
+    }
+  }
+
+  for (const auto &Key : DynamicFunctions) {
+    const auto *DF = Model.ImportedDynamicFunctions().tryGet(Key);
+    if (DF != nullptr) {
+      if (not DF->verify(VH))
+        return VH.fail();
+      if (not DF->CustomName().empty())
+        TouchedNames.insert(DF->CustomName());
+    }
+  }
+
+  for (const auto &Key : Segments) {
+    if (const model::Segment *S = Model.Segments().tryGet(Key)) {
+      if (not S->verify(VH))
+        return VH.fail();
+      if (not S->CustomName().empty())
+        TouchedNames.insert(S->CustomName());
+    }
+  }
+
+  if (collidesWithLocalNames(Model, TouchedNames))
+    return VH.fail("A name collides with the name of a field or argument");
+
+  if (SegmentsChanged and not verifyNoOverlaps(VH, Model.Segments()))
+    return VH.fail();
+
+  return true;
+}
+
 //
 // And the wrappers
 //
@@ -946,4 +1178,11 @@ bool Binary::verify() const {
   return verify(false);
 }
 
+bool verifyAfterDiff(const model::Binary &Model,
+                     const TupleTreeDiff<model::Binary> &Diff,
+                     bool Assert) {
+  VerifyHelper VH(Assert);
+  return verifyAfterDiff(Model, Diff, VH);
+}
+
 } // namespace model
@@ -4,6 +4,8 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include "llvm/ADT/Hashing.h"
+
 #include "revng/ABI/FunctionType/Layout.h"
 #include "revng/Model/Binary.h"
 #include "revng/PTML/Constants.h"
@@ -569,3 +571,118 @@ std::string ptml::functionComment(const ::ptml::PTMLBuilder &PTML,
   CommentBuilder Builder(PTML, CommentIndicator, Indentation, WrapAt);
   return Builder.emit(std::move(Result));
 }
+
+static llvm::hash_code hashValue(const model::TypeDefinition &Definition) {
+  return llvm::hash_combine(Definition.ID(), Definition.Kind());
+}
+
+/// \return a hash of everything `functionComment` reads from the model for
+///         \p Function. Entities without a comment only contribute their count.
+static uint64_t commentHash(const model::Function &Function,
+                            const model::Binary &Binary) {
+  llvm::StringRef Comment = Function.Comment();
+  llvm::hash_code Result = llvm::hash_combine(Function.Entry().address(),
+                                              Comment,
+                                              Binary.Architecture());
+  if (Function.Prototype().isEmpty())
+    return Result;
+
+  if (auto *FT = Function.cabiPrototype()) {
+    Result = llvm::hash_combine(Result,
+                                hashValue(*FT),
+                                llvm::StringRef(FT->ReturnValueComment()),
+                                FT->Arguments().size());
+
+    // The layout is only needed to describe the location of the arguments
+    // with a comment
+    std::optional<abi::FunctionType::Layout> Layout;
+    for (size_t Index = 0; Index < FT->Arguments().size(); ++Index) {
+      const model::Argument &Argument = FT->Arguments().at(Index);
+      if (Argument.Comment().empty())
+        continue;
+
+      if (not Layout.has_value())
+        Layout.emplace(*FT);
+
+      size_t IndOffset = Layout->hasSPTAR() ? 1 : 0;
+      const auto &Location = Layout->Arguments[Index + IndOffset];
+      const auto &Registers = Location.Registers;
+      Result = llvm::hash_combine(Result,
+                                  Index,
+                                  llvm::StringRef(Argument.Comment()),
+                                  Argument.name().str(),
+                                  llvm::hash_combine_range(Registers.begin(),
+                                                           Registers.end()));
+      if (Location.Stack)
+        Result = llvm::hash_combine(Result,
+                                    Location.Stack->Offset,
+                                    Location.Stack->Size);
+    }
+  } else if (auto *FT = Function.rawPrototype()) {
+    Result = llvm::hash_combine(Result,
+                                hashValue(*FT),
+                                llvm::StringRef(FT->ReturnValueComment()),
+                                FT->Arguments().size(),
+                                FT->ReturnValues().size());
+
+    for (const model::NamedTypedRegister &Argument : FT->Arguments())
+      if (not Argument.Comment().empty())
+        Result = llvm::hash_combine(Result,
+                                    Argument.Location(),
+                                    llvm::StringRef(Argument.Comment()),
+                                    Argument.name().str());
+
+    for (const model::NamedTypedRegister &ReturnValue : FT->ReturnValues())
+      if (not ReturnValue.Comment().empty())
+        Result = llvm::hash_combine(Result,
+                                    ReturnValue.Location(),
+                                    llvm::StringRef(ReturnValue.Comment()));
+
+    if (const model::StructDefinition *Stack = FT->stackArgumentsType()) {
+      Result = llvm::hash_combine(Result,
+                                  hashValue(*Stack),
+                                  Stack->Fields().size());
+      for (const model::StructField &Field : Stack->Fields())
+        if (not Field.Comment().empty())
+          Result = llvm::hash_combine(Result,
+                                      Field.Offset(),
+                                      llvm::StringRef(Field.Comment()),
+                                      Field.name().str());
+    }
+  }
+
+  return Result;
+}
+
+std::string
+ptml::FunctionCommentCache::functionComment(const ::ptml::PTMLBuilder &B,
+                                            const model::Function &Function,
+                                            const model::Binary &Binary,
+                                            llvm::StringRef CommentIndicator,
+                                            size_t Indentation,
+                                            size_t WrapAt) {
+  uint64_t Hash = llvm::hash_combine(commentHash(Function, Binary),
+                                     B.isGenerateTagLessPTML(),
+                                     CommentIndicator,
+                                     Indentation,
+                                     WrapAt);
+
+  {
+    std::lock_guard Lock(Mutex);
+    auto It = Entries.find(Function.Entry());
+    if (It != Entries.end() and It->second.Hash == Hash)
+      return It->second.Comment;
+  }
+
+  // Emit outside of the critical section
+  std::string Result = ptml::functionComment(B,
+                                             Function,
+                                             Binary,
+                                             CommentIndicator,
+                                             Indentation,
+                                             WrapAt);
+
+  std::lock_guard Lock(Mutex);
+  Entries[Function.Entry()] = Entry{ Hash, Result };
+  return Result;
+}
@@ -2,6 +2,8 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <cstring>
+
 #include "llvm/Support/ErrorHandling.h"
 
 #include "revng/PTML/Constants.h"
@@ -15,38 +17,39 @@ uint64_t PTMLIndentedOstream::current_pos() const {
 }
 
 void PTMLIndentedOstream::write_impl(const char *Ptr, size_t Size) {
-  llvm::StringRef Str(Ptr, Size);
-  llvm::SmallVector<llvm::StringRef> Lines;
-  Str.split(Lines, '\n');
-
-  bool EndsInNewLine = Str.endswith("\n");
-  if (EndsInNewLine)
-    Lines.pop_back();
-
-  if (TrailingNewline)
-    writeIndent();
-
-  for (auto &Line : llvm::make_range(Lines.begin(), std::prev(Lines.end()))) {
-    OS << Line << '\n';
-    writeIndent();
+  const char *End = Ptr + Size;
+  while (Ptr != End) {
+    if (TrailingNewline)
+      writeIndent();
+
+    // Write everything up to the next newline, included, in a single chunk
+    const void *Newline = std::memchr(Ptr, '\n', End - Ptr);
+    if (Newline == nullptr) {
+      OS.write(Ptr, End - Ptr);
+      return;
+    }
+
+    const char *LineEnd = static_cast<const char *>(Newline) + 1;
+    OS.write(Ptr, LineEnd - Ptr);
+    Ptr = LineEnd;
+    TrailingNewline = true;
   }
-
-  OS << Lines.pop_back_val();
-  if (EndsInNewLine)
-    OS << '\n';
-
-  TrailingNewline = EndsInNewLine;
 }
 
 void PTMLIndentedOstream::writeIndent() {
   if (IndentDepth > 0) {
-    Tag IndentTag = B.getTag(tags::Span,
-                             std::string(IndentSize * IndentDepth, ' '));
+    if (CachedIndentDepth != IndentDepth) {
+      Tag IndentTag = B.getTag(tags::Span,
+                               std::string(IndentSize * IndentDepth, ' '));
+
+      if (not B.isGenerateTagLessPTML())
+        IndentTag.addAttribute(attributes::Token, ptml::tokens::Indentation);
 
-    if (not B.isGenerateTagLessPTML())
-      IndentTag.addAttribute(attributes::Token, ptml::tokens::Indentation);
+      CachedIndent = IndentTag.toString();
+      CachedIndentDepth = IndentDepth;
+    }
 
-    OS << IndentTag.toString();
+    OS << CachedIndent;
   }
   TrailingNewline = false;
 }
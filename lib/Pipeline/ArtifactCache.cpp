@@ -0,0 +1,77 @@
+/// \file ArtifactCache.cpp
+/// A content-addressed cache of the results of pipes, that can be shared
+/// across pipelines.
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include "revng/Pipeline/ArtifactCache.h"
+#include "revng/Support/ResourceFinder.h"
+
+using namespace pipeline;
+
+/// Bump this every time the layout of the entries or the way keys are computed
+/// changes
+static constexpr llvm::StringRef CacheVersion = "1";
+
+ArtifactCache::ArtifactCache(revng::DirectoryPath Root) :
+  Client(), Root(std::move(Root)), ComponentsHash(revng::getComponentsHash()) {
+}
+
+llvm::Expected<std::unique_ptr<ArtifactCache>>
+ArtifactCache::fromPathOrURL(llvm::StringRef URL) {
+  auto MaybeClient = revng::StorageClient::fromPathOrURL(URL);
+  if (not MaybeClient)
+    return MaybeClient.takeError();
+
+  std::unique_ptr<revng::StorageClient> Client = std::move(MaybeClient.get());
+  revng::DirectoryPath Root(Client.get(), "");
+  auto Result = std::make_unique<ArtifactCache>(std::move(Root));
+  Result->Client = std::move(Client);
+  return Result;
+}
+
+std::unique_ptr<ArtifactCache::KeyBuilder>
+ArtifactCache::makeKeyBuilder() const {
+  auto Result = std::make_unique<KeyBuilder>();
+  Result->addField(CacheVersion);
+  Result->addField(ComponentsHash);
+  return Result;
+}
+
+llvm::Expected<bool> ArtifactCache::contains(llvm::StringRef Key) const {
+  revng::DirectoryPath Entry = getEntry(Key);
+  auto MaybeExists = Entry.exists();
+  if (not MaybeExists or not MaybeExists.get())
+    return MaybeExists;
+
+  return Entry.getFile(CompleteMarkerName).exists();
+}
+
+llvm::Expected<revng::DirectoryPath>
+ArtifactCache::createEntry(llvm::StringRef Key) const {
+  if (auto Error = Root.create(); Error)
+    return Error;
+
+  revng::DirectoryPath Entry = getEntry(Key);
+  if (auto Error = Entry.create(); Error)
+    return Error;
+
+  return Entry;
+}
+
+llvm::Error ArtifactCache::markComplete(llvm::StringRef Key) {
+  revng::FilePath Marker = getEntry(Key).getFile(CompleteMarkerName);
+  auto MaybeWritableFile = Marker.getWritableFile();
+  if (not MaybeWritableFile)
+    return MaybeWritableFile.takeError();
+
+  if (auto Error = MaybeWritableFile.get()->commit(); Error)
+    return Error;
+
+  if (Client != nullptr)
+    return Client->commit();
+
+  return llvm::Error::success();
+}
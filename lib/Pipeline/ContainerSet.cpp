@@ -89,6 +89,26 @@ llvm::Error ContainerSet::store(const revng::DirectoryPath &Directory) const {
   return Error::success();
 }
 
+uint64_t ContainerSet::memoryUsage() const {
+  uint64_t Result = 0;
+  for (const auto &Pair : Content)
+    if (Pair.second != nullptr)
+      Result += Pair.second->memoryUsage();
+  return Result;
+}
+
+size_t ContainerSet::release(const revng::DirectoryPath &Directory) {
+  size_t Released = 0;
+  for (auto &Pair : Content) {
+    if (Pair.second == nullptr)
+      continue;
+
+    if (Pair.second->release(Directory.getFile(Pair.first())))
+      ++Released;
+  }
+  return Released;
+}
+
 llvm::Error ContainerSet::load(const revng::DirectoryPath &Directory) {
   for (auto &Pair : Content) {
     revng::FilePath Filename = Directory.getFile(Pair.first());
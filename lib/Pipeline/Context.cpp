@@ -31,13 +31,19 @@ llvm::Error Context::store(const revng::DirectoryPath &Path) const {
     return MaybeWritableFile.takeError();
 
   MaybeWritableFile->get()->os() << CommitIndex << "\n";
-  return MaybeWritableFile->get()->commit();
+  if (auto Error = MaybeWritableFile->get()->commit(); Error)
+    return Error;
+
+  return Costs.store(Path.getFile("target-costs"));
 }
 
 llvm::Error Context::load(const revng::DirectoryPath &Path) {
   if (auto Error = Globals.load(Path); Error)
     return Error;
 
+  if (auto Error = Costs.load(Path.getFile("target-costs")); Error)
+    return Error;
+
   revng::FilePath IndexPath = Path.getFile("index");
 
   auto MaybeExists = IndexPath.exists();
@@ -19,6 +19,37 @@ using namespace pipeline;
 using namespace llvm;
 using namespace std;
 
+static thread_local ContractEvaluationScope *ActiveScope = nullptr;
+
+ContractEvaluationScope::ContractEvaluationScope() {
+  if (ActiveScope == nullptr)
+    ActiveScope = this;
+}
+
+ContractEvaluationScope::~ContractEvaluationScope() {
+  if (ActiveScope == this)
+    ActiveScope = nullptr;
+}
+
+const TargetsList &ContractEvaluationScope::allTargets(const Context &Context,
+                                                       const Kind &K,
+                                                       TargetsList &Storage) {
+  if (ActiveScope == nullptr) {
+    K.appendAllTargets(Context, Storage);
+    return Storage;
+  }
+
+  auto [It, New] = ActiveScope->AllTargets.try_emplace({ &Context, &K });
+  if (New)
+    K.appendAllTargets(Context, It->second);
+  return It->second;
+}
+
+static const TargetsList &
+allTargets(const Context &Context, const Kind &K, TargetsList &Storage) {
+  return ContractEvaluationScope::allTargets(Context, K, Storage);
+}
+
 void Contract::deduceResults(const Context &Context,
                              ContainerToTargetsMap &StepStatus,
                              ArrayRef<string> Names) const {
@@ -59,7 +90,8 @@ void Contract::deduceResults(const Context &Context,
                              TargetsList &Results,
                              ArrayRef<string> Names) const {
   if (Source == nullptr) {
-    TargetKind->appendAllTargets(Context, Results);
+    TargetsList Storage;
+    Results.merge(allTargets(Context, *TargetKind, Storage));
     return;
   }
 
@@ -90,21 +122,16 @@ TargetsList Contract::forward(const Context &Context, TargetsList Input) const {
     return Input;
   }
 
-  if (Source->depth() > TargetKind->depth()) {
-    TargetsList All;
-    TargetKind->appendAllTargets(Context, All);
-    return All;
-  }
+  TargetsList Storage;
+  if (Source->depth() > TargetKind->depth())
+    return allTargets(Context, *TargetKind, Storage);
 
-  TargetsList All;
-  Source->appendAllTargets(Context, All);
-  if (All != Input) {
+  if (allTargets(Context, *Source, Storage) != Input) {
     return Input;
   }
 
-  TargetsList AllDestination;
-  TargetKind->appendAllTargets(Context, AllDestination);
-  return AllDestination;
+  TargetsList DestinationStorage;
+  return allTargets(Context, *TargetKind, DestinationStorage);
 }
 
 ContainerToTargetsMap
@@ -175,22 +202,17 @@ TargetsList Contract::backward(const Context &Context,
     return Output;
   }
 
-  if (Source->depth() < TargetKind->depth()) {
-    TargetsList All;
-    Source->appendAllTargets(Context, All);
-    return All;
-  }
+  TargetsList Storage;
+  if (Source->depth() < TargetKind->depth())
+    return allTargets(Context, *Source, Storage);
 
   if (Source->depth() > TargetKind->depth()) {
-    TargetsList All;
-    TargetKind->appendAllTargets(Context, All);
-    if (All != Output) {
+    if (allTargets(Context, *TargetKind, Storage) != Output) {
       return Output;
     }
 
-    TargetsList AllDestination;
-    Source->appendAllTargets(Context, AllDestination);
-    return AllDestination;
+    TargetsList DestinationStorage;
+    return allTargets(Context, *Source, DestinationStorage);
   }
 
   return Output;
@@ -239,7 +261,8 @@ void Contract::insertDefaultInput(const Context &Context,
   if (Source == nullptr)
     return;
   auto &SourceContainerTargets = Status[Names[PipeArgumentSourceIndex]];
-  Source->appendAllTargets(Context, SourceContainerTargets);
+  TargetsList Storage;
+  SourceContainerTargets.merge(allTargets(Context, *Source, Storage));
 }
 
 bool ContractGroup::forwardMatches(const BCS &Status,
@@ -0,0 +1,112 @@
+/// \file EventLog.cpp
+/// Ordered log of the changes to the state of the pipeline.
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include "llvm/Support/JSON.h"
+
+#include "revng/Pipeline/EventLog.h"
+#include "revng/Pipeline/Target.h"
+#include "revng/Support/Assert.h"
+
+using namespace pipeline;
+
+llvm::StringRef PipelineEvent::kindName(KindType Kind) {
+  switch (Kind) {
+  case TargetInvalidated:
+    return "target-invalidated";
+  case TargetProduced:
+    return "target-produced";
+  case GlobalChanged:
+    return "global-changed";
+  }
+
+  revng_abort();
+}
+
+void EventBatch::dump(llvm::raw_ostream &OS) const {
+  llvm::json::OStream JSON(OS);
+  JSON.object([&] {
+    JSON.attribute("next", static_cast<int64_t>(Next));
+    JSON.attribute("truncated", Truncated);
+    JSON.attributeArray("events", [&] {
+      for (const PipelineEvent &Event : Events) {
+        JSON.object([&] {
+          JSON.attribute("sequence", static_cast<int64_t>(Event.Sequence));
+          JSON.attribute("kind", PipelineEvent::kindName(Event.Kind));
+          if (Event.Kind == PipelineEvent::GlobalChanged) {
+            JSON.attribute("global", Event.Global);
+            JSON.attribute("path", Event.Path);
+          } else {
+            JSON.attribute("step", Event.Step);
+            JSON.attribute("container", Event.Container);
+            JSON.attribute("target", Event.Target);
+          }
+        });
+      }
+    });
+  });
+}
+
+void EventLog::targetInvalidated(llvm::StringRef Step,
+                                 llvm::StringRef Container,
+                                 const Target &Invalidated) {
+  PipelineEvent Event;
+  Event.Kind = PipelineEvent::TargetInvalidated;
+  Event.Step = Step.str();
+  Event.Container = Container.str();
+  Event.Target = Invalidated.toString();
+  push(std::move(Event));
+}
+
+void EventLog::targetProduced(llvm::StringRef Step,
+                              llvm::StringRef Container,
+                              const Target &Produced) {
+  PipelineEvent Event;
+  Event.Kind = PipelineEvent::TargetProduced;
+  Event.Step = Step.str();
+  Event.Container = Container.str();
+  Event.Target = Produced.toString();
+  push(std::move(Event));
+}
+
+void EventLog::globalChanged(llvm::StringRef Global, llvm::StringRef Path) {
+  PipelineEvent Event;
+  Event.Kind = PipelineEvent::GlobalChanged;
+  Event.Global = Global.str();
+  Event.Path = Path.str();
+  push(std::move(Event));
+}
+
+uint64_t EventLog::nextSequence() const {
+  std::lock_guard Lock(Mutex);
+  return NextSequence;
+}
+
+EventBatch EventLog::since(uint64_t Sequence) const {
+  std::lock_guard Lock(Mutex);
+  EventBatch Result;
+  Result.Next = NextSequence;
+
+  uint64_t First = NextSequence - Events.size();
+  if (Sequence < First) {
+    Result.Truncated = true;
+    Sequence = First;
+  }
+
+  // Sequence numbers have no gaps, hence they can be used as indexes
+  for (uint64_t I = Sequence; I < NextSequence; ++I)
+    Result.Events.push_back(Events[I - First]);
+
+  return Result;
+}
+
+void EventLog::push(PipelineEvent &&Event) {
+  std::lock_guard Lock(Mutex);
+  Event.Sequence = NextSequence++;
+  Events.push_back(std::move(Event));
+  if (Events.size() > Capacity)
+    Events.pop_front();
+}
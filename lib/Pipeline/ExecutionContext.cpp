@@ -5,12 +5,24 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include "llvm/Support/CommandLine.h"
+
 #include "revng/Pipeline/ExecutionContext.h"
+#include "revng/Pipeline/ProductionProgress.h"
 #include "revng/Pipeline/Step.h"
 #include "revng/Pipeline/Target.h"
 
 using namespace pipeline;
 
+static llvm::cl::opt<unsigned> PipeDeadline("pipe-deadline",
+                                            llvm::cl::desc("number of seconds "
+                                                           "after which the "
+                                                           "analyses run by "
+                                                           "a pipe return a "
+                                                           "partial result, "
+                                                           "0 means never"),
+                                            llvm::cl::init(0));
+
 ExecutionContext::ExecutionContext(Context &Context,
                                    PipeWrapper *Pipe,
                                    const ContainerToTargetsMap
@@ -18,7 +30,8 @@ ExecutionContext::ExecutionContext(Context &Context,
   TheContext(&Context),
   Pipe(Pipe),
   Requested(RequestedTargets),
-  RunningOnPipe(Pipe != nullptr) {
+  RunningOnPipe(Pipe != nullptr),
+  Deadline(std::chrono::seconds(PipeDeadline)) {
   // pipe is null when execution a analysis. We could just provide a context to
   // analyses, for the sake of uniformity we pass a execution context to them
   // too.
@@ -39,10 +52,13 @@ void ExecutionContext::commit(const Target &Target,
             "Committing " << Target.toString() << " into "
                           << ContainerName.str());
 
-  // TODO: this triggers a sort at every invocation, which is bad for
-  //       performance
+  // Targets are usually committed in the same order they have been requested,
+  // in which case adding them to Committed does not require any sorting
   Committed.add(ContainerName.str(), Target);
 
+  if (ProductionProgress *Progress = getContext().getProgress())
+    Progress->advance();
+
   TargetInContainer ToCollect(Target, ContainerName.str());
   getContext().collectReadFields(ToCollect,
                                  Pipe->InvalidationMetadata.getPathCache());
@@ -5,10 +5,13 @@
 //
 
 #include <system_error>
+#include <vector>
 
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include "revng/Pipeline/GlobalsMap.h"
@@ -17,20 +20,95 @@ using namespace std;
 using namespace pipeline;
 using namespace llvm;
 
+// Globals are (de)serialized concurrently, but the storage is always accessed
+// from the calling thread: storage clients are not thread-safe
+
 llvm::Error GlobalsMap::store(const revng::DirectoryPath &Path) const {
+  std::vector<std::string> Serialized(Map.size());
+  std::vector<llvm::Error> Errors;
+  for (size_t I = 0; I < Map.size(); ++I)
+    Errors.push_back(llvm::Error::success());
+
+  {
+    llvm::ThreadPool Pool(llvm::hardware_concurrency());
+    size_t Index = 0;
+    for (const auto &Global : Map) {
+      Pool.async([&, Index, &Global = *Global.second] {
+        llvm::raw_string_ostream OS(Serialized[Index]);
+        Errors[Index] = Global.serialize(OS);
+      });
+      ++Index;
+    }
+    Pool.wait();
+  }
+
+  llvm::Error Result = llvm::Error::success();
+  for (llvm::Error &E : Errors)
+    Result = llvm::joinErrors(std::move(Result), std::move(E));
+  if (Result)
+    return Result;
+
+  size_t Index = 0;
   for (const auto &Global : Map) {
     revng::FilePath Filename = Path.getFile(Global.first);
-    if (auto E = Global.second->store(Filename); !!E)
+    auto MaybeWritableFile = Filename.getWritableFile();
+    if (not MaybeWritableFile)
+      return MaybeWritableFile.takeError();
+
+    auto &WritableFile = MaybeWritableFile.get();
+    WritableFile->os() << Serialized[Index];
+    if (auto E = WritableFile->commit(); !!E)
       return E;
+    ++Index;
   }
+
   return llvm::Error::success();
 }
 
 llvm::Error GlobalsMap::load(const revng::DirectoryPath &Path) {
+  // A missing file means the global has to be cleared
+  std::vector<std::unique_ptr<revng::ReadableFile>> Files;
   for (const auto &Global : Map) {
     revng::FilePath Filename = Path.getFile(Global.first);
-    if (auto E = Global.second->load(Filename); !!E)
-      return E;
+    auto MaybeExists = Filename.exists();
+    if (not MaybeExists)
+      return MaybeExists.takeError();
+
+    if (not MaybeExists.get()) {
+      Files.push_back(nullptr);
+      continue;
+    }
+
+    auto MaybeBuffer = Filename.getReadableFile();
+    if (not MaybeBuffer)
+      return MaybeBuffer.takeError();
+    Files.push_back(std::move(MaybeBuffer.get()));
   }
-  return llvm::Error::success();
+
+  std::vector<llvm::Error> Errors;
+  for (size_t I = 0; I < Map.size(); ++I)
+    Errors.push_back(llvm::Error::success());
+
+  {
+    llvm::ThreadPool Pool(llvm::hardware_concurrency());
+    size_t Index = 0;
+    for (const auto &Global : Map) {
+      Pool.async([&, Index, &Global = *Global.second] {
+        if (Files[Index] == nullptr) {
+          Global.clear();
+          return;
+        }
+
+        llvm::StringRef String = Files[Index]->buffer().getBuffer();
+        Errors[Index] = Global.fromString(String);
+      });
+      ++Index;
+    }
+    Pool.wait();
+  }
+
+  llvm::Error Result = llvm::Error::success();
+  for (llvm::Error &E : Errors)
+    Result = llvm::joinErrors(std::move(Result), std::move(E));
+  return Result;
 }
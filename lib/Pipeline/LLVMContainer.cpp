@@ -61,6 +61,8 @@ void pipeline::makeGlobalObjectsArray(llvm::Module &Module,
 
 std::unique_ptr<ContainerBase>
 LLVMContainer::cloneFiltered(const TargetsList &Targets) const {
+  materialize();
+
   using InspectorT = LLVMKind;
   auto ToClone = InspectorT::functions(Targets, *this->self());
   auto ToClonedNotOwned = InspectorT::untrackedFunctions(*this->self());
@@ -123,7 +125,35 @@ static void fixGlobals(llvm::Module &Module,
   }
 }
 
+/// Turn into declarations all the global objects of \p Module that are also
+/// defined in \p Other
+static void dropDefinitionsOf(llvm::Module &Module, const llvm::Module &Other) {
+  using namespace llvm;
+
+  for (const Function &F : Other.functions()) {
+    if (F.isDeclaration())
+      continue;
+
+    Function *Clashing = Module.getFunction(F.getName());
+    if (Clashing != nullptr and not Clashing->isDeclaration())
+      Clashing->deleteBody();
+  }
+
+  for (const GlobalVariable &Global : Other.globals()) {
+    if (Global.isDeclaration())
+      continue;
+
+    auto *Clashing = Module.getGlobalVariable(Global.getName(), true);
+    if (Clashing != nullptr and not Clashing->isDeclaration()) {
+      Clashing->setInitializer(nullptr);
+      Clashing->setLinkage(GlobalValue::ExternalLinkage);
+      Clashing->setComdat(nullptr);
+    }
+  }
+}
+
 void LLVMContainer::mergeBackImpl(ThisType &&OtherContainer) {
+  materialize();
   llvm::Module *ToMerge = &OtherContainer.getModule();
   revng::verify(ToMerge);
 
@@ -176,22 +206,28 @@ void LLVMContainer::mergeBackImpl(ThisType &&OtherContainer) {
   if (Module->getDataLayout().isDefault())
     Module->setDataLayout(ToMerge->getDataLayout());
 
-  llvm::Linker TheLinker(*ToMerge);
+  // The definitions in ToMerge must take precedence over the ones in Module.
+  // Instead of linking Module into ToMerge, which costs as much as the whole
+  // Module, turn the clashing definitions of Module into declarations and link
+  // ToMerge into Module: this way the cost of linking is proportional to the
+  // size of ToMerge, which is usually a handful of functions.
+  dropDefinitionsOf(*Module, *ToMerge);
+
+  llvm::Linker TheLinker(*Module);
 
   // Actually link
-  bool Failure = TheLinker.linkInModule(std::move(Module));
+  bool Failure = TheLinker.linkInModule(std::move(OtherContainer.Module));
+  ToMerge = nullptr;
 
   revng_assert(not Failure, "Linker failed");
 
   // Restores the initial linkage for local functions
-  for (auto &Global : ToMerge->global_objects()) {
+  for (auto &Global : Module->global_objects()) {
     auto It = LinkageRestore.find(Global.getName().str());
     if (It != LinkageRestore.end())
       Global.setLinkage(It->second);
   }
 
-  Module = std::move(OtherContainer.Module);
-
   // Checks that module merging commutes w.r.t. enumeration, as specified in
   // the first comment.
   auto ActualEnumeration = this->enumerate();
@@ -272,7 +308,7 @@ void LLVMContainer::mergeBackImpl(ThisType &&OtherContainer) {
   auto *NamedMDNode = Module->getOrInsertNamedMetadata("llvm.dbg.cu");
   pruneDICompileUnits(*Module);
 
-  revng::verify(ToMerge);
+  revng::verify(Module.get());
 
   if (ModuleStatisticsLogger.isEnabled()) {
     auto PostMergeStatistics = ModuleStatistics::analyze(*Module.get());
@@ -299,12 +335,25 @@ llvm::Error LLVMContainer::extractOne(llvm::raw_ostream &OS,
 }
 
 llvm::Error LLVMContainer::serialize(llvm::raw_ostream &OS) const {
+  reload();
+  if (Serialized) {
+    // The module has never been accessed since it has been loaded, there's no
+    // need to parse it and print it back
+    OS << Serialized->getBuffer();
+    OS.flush();
+    return llvm::Error::success();
+  }
+
   getModule().print(OS, nullptr);
   OS.flush();
   return llvm::Error::success();
 }
 
 llvm::Error LLVMContainer::deserialize(const llvm::MemoryBuffer &Buffer) {
+  Serialized.reset();
+  LoadedFrom.reset();
+  Released = false;
+
   llvm::SMDiagnostic Error;
   auto M = llvm::parseIR(Buffer, Error, Module->getContext());
   std::string ErrorMessage;
@@ -329,3 +378,117 @@ llvm::Error LLVMContainer::deserialize(const llvm::MemoryBuffer &Buffer) {
 
   return llvm::Error::success();
 }
+
+llvm::Error LLVMContainer::load(const revng::FilePath &Path) {
+  auto MaybeExists = Path.exists();
+  if (not MaybeExists)
+    return MaybeExists.takeError();
+
+  if (not MaybeExists.get()) {
+    clear();
+    return llvm::Error::success();
+  }
+
+  auto MaybeBuffer = Path.getReadableFile();
+  if (not MaybeBuffer)
+    return MaybeBuffer.takeError();
+
+  // Defer parsing to the first access to the module, see materialize. We need
+  // our own copy, since the file might be overwritten in the meantime.
+  const llvm::MemoryBuffer &Buffer = MaybeBuffer.get()->buffer();
+  llvm::StringRef Name = Buffer.getBufferIdentifier();
+  Serialized = llvm::MemoryBuffer::getMemBufferCopy(Buffer.getBuffer(), Name);
+  LoadedFrom = Path;
+  Released = false;
+  return llvm::Error::success();
+}
+
+llvm::Error LLVMContainer::store(const revng::FilePath &Path) const {
+  // Any change to the module goes through materialize: if we still have the
+  // serialized module, the file we loaded it from is up to date
+  if ((Serialized or Released) and LoadedFrom == Path)
+    return llvm::Error::success();
+
+  return ContainerBase::store(Path);
+}
+
+bool LLVMContainer::release(const revng::FilePath &Path) {
+  Serialized.reset();
+  Module = std::make_unique<llvm::Module>("revng.module",
+                                          Module->getContext());
+  LoadedFrom = Path;
+  Released = true;
+  return true;
+}
+
+uint64_t LLVMContainer::memoryUsage() const {
+  if (Released)
+    return 0;
+
+  if (Serialized)
+    return Serialized->getBufferSize();
+
+  // Count the IR objects, ignoring what is owned by the LLVMContext (types,
+  // constants and metadata), which is shared among all the modules
+  uint64_t Result = sizeof(llvm::Module);
+  for (const llvm::GlobalVariable &Global : Module->globals())
+    Result += sizeof(llvm::GlobalVariable);
+
+  for (const llvm::Function &F : Module->functions()) {
+    Result += sizeof(llvm::Function) + F.arg_size() * sizeof(llvm::Argument);
+    for (const llvm::BasicBlock &BB : F) {
+      Result += sizeof(llvm::BasicBlock);
+      for (const llvm::Instruction &I : BB) {
+        Result += sizeof(llvm::Instruction);
+        Result += I.getNumOperands() * sizeof(llvm::Use);
+      }
+    }
+  }
+
+  return Result;
+}
+
+void LLVMContainer::reload() const {
+  if (not Released)
+    return;
+
+  auto MaybeFile = LoadedFrom->getReadableFile();
+  if (not MaybeFile) {
+    std::string Message = "Cannot reload container " + name() + ": "
+                          + llvm::toString(MaybeFile.takeError());
+    revng_abort(Message.c_str());
+  }
+
+  const llvm::MemoryBuffer &Buffer = MaybeFile.get()->buffer();
+  llvm::StringRef Name = Buffer.getBufferIdentifier();
+  Serialized = llvm::MemoryBuffer::getMemBufferCopy(Buffer.getBuffer(), Name);
+  Released = false;
+}
+
+void LLVMContainer::materialize() const {
+  reload();
+  if (not Serialized)
+    return;
+
+  std::unique_ptr<llvm::MemoryBuffer> Buffer = std::move(Serialized);
+
+  llvm::SMDiagnostic Error;
+  auto M = llvm::parseIR(*Buffer, Error, Module->getContext());
+  std::string ErrorMessage;
+  llvm::raw_string_ostream Stream(ErrorMessage);
+  if (not M) {
+    Stream << "Cannot load LLVM IR module of container " << name() << ".\n";
+    Error.print("revng", Stream);
+    Stream.flush();
+    revng_abort(ErrorMessage.c_str());
+  }
+
+  // NOLINTNEXTLINE
+  bool Failed = llvm::verifyModule(*M.get(), &Stream);
+  if (Failed) {
+    Stream.flush();
+    revng_abort(ErrorMessage.c_str());
+  }
+
+  Module = std::move(M);
+}
@@ -8,7 +8,9 @@
 
 #include <optional>
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Error.h"
 
 #include "revng/Pipeline/Loader.h"
@@ -20,6 +22,28 @@ using namespace std;
 using namespace llvm;
 using StringsMap = llvm::StringMap<string>;
 
+static cl::opt<bool> NoLLVMPipesFusion("no-llvm-pipes-fusion",
+                                       cl::desc("run each llvm-pipe with its "
+                                                "own pass manager, instead of "
+                                                "fusing adjacent ones"));
+
+/// Adjacent llvm-pipes running on the same containers are run by a single
+/// pass manager, so that the analyses they have in common (e.g., the loaded
+/// model) are computed once.
+///
+/// This preserves the semantics of the pipeline: the contracts of the passes
+/// of an llvm-pipe are applied in sequence, exactly as if they belonged to
+/// distinct pipes. The only difference is that the accesses to the model are
+/// tracked for the fused pipe as a whole, which can only lead to more
+/// conservative invalidations.
+static bool canBeFused(const PipeInvocation &Previous,
+                       const PipeInvocation &Next) {
+  return not NoLLVMPipesFusion and Previous.Type == "llvm-pipe"
+         and Next.Type == "llvm-pipe"
+         and Previous.UsedContainers == Next.UsedContainers
+         and Previous.Name.empty() and Next.Name.empty();
+}
+
 Error Loader::parseStepDeclaration(Runner &Runner,
                                    const StepDeclaration &Declaration,
                                    std::string &LastAddedStep,
@@ -48,10 +72,18 @@ Error Loader::parseStepDeclaration(Runner &Runner,
     }
   }
 
+  std::vector<PipeInvocation> Invocations;
   for (const auto &Invocation : Declaration.Pipes) {
     if (not isInvocationUsed(Invocation.EnabledWhen))
       continue;
 
+    if (not Invocations.empty() and canBeFused(Invocations.back(), Invocation))
+      append_range(Invocations.back().Passes, Invocation.Passes);
+    else
+      Invocations.push_back(Invocation);
+  }
+
+  for (const auto &Invocation : Invocations) {
     if (auto MaybeInvocation = parseInvocation(JustAdded,
                                                Invocation,
                                                ReadOnlyNames);
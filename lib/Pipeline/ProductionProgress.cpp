@@ -0,0 +1,96 @@
+/// \file ProductionProgress.cpp
+/// Tracking of the targets committed by the running pipe.
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include "llvm/Support/JSON.h"
+
+#include "revng/Pipeline/ProductionProgress.h"
+
+using namespace pipeline;
+
+void ProgressSnapshot::dump(llvm::raw_ostream &OS) const {
+  llvm::json::OStream JSON(OS);
+  JSON.object([&] {
+    JSON.attribute("running", Running);
+    JSON.attribute("step", Step);
+    JSON.attribute("pipe", Pipe);
+    JSON.attribute("done-targets", static_cast<int64_t>(DoneTargets));
+    JSON.attribute("total-targets", static_cast<int64_t>(TotalTargets));
+    JSON.attribute("targets-per-second", TargetsPerSecond);
+    if (RemainingSeconds.has_value())
+      JSON.attribute("remaining-seconds", *RemainingSeconds);
+    else
+      JSON.attribute("remaining-seconds", nullptr);
+  });
+}
+
+void ProductionProgress::startPipe(llvm::StringRef StepName,
+                                   llvm::StringRef PipeName,
+                                   uint64_t TotalTargets,
+                                   std::optional<double> ExpectedCost) {
+  std::lock_guard Lock(Mutex);
+  Current = ProgressSnapshot();
+  Current.Running = true;
+  Current.Step = StepName.str();
+  Current.Pipe = PipeName.str();
+  Current.TotalTargets = TotalTargets;
+  this->ExpectedCost = ExpectedCost;
+
+  Window.clear();
+  Window.push_back({ Clock::now(), 0 });
+  updateEstimate();
+}
+
+void ProductionProgress::advance(uint64_t Count) {
+  std::lock_guard Lock(Mutex);
+  if (not Current.Running)
+    return;
+
+  Current.DoneTargets += Count;
+  Window.push_back({ Clock::now(), Current.DoneTargets });
+  if (Window.size() > WindowSize)
+    Window.pop_front();
+  updateEstimate();
+}
+
+void ProductionProgress::endPipe() {
+  std::lock_guard Lock(Mutex);
+  Current.Running = false;
+  Current.RemainingSeconds.reset();
+  Window.clear();
+}
+
+ProgressSnapshot ProductionProgress::snapshot() const {
+  std::lock_guard Lock(Mutex);
+  return Current;
+}
+
+void ProductionProgress::updateEstimate() {
+  uint64_t Remaining = 0;
+  if (Current.TotalTargets > Current.DoneTargets)
+    Remaining = Current.TotalTargets - Current.DoneTargets;
+
+  // The first sample is the start of the pipe, we need at least one commit
+  if (Window.size() >= 2) {
+    const Sample &First = Window.front();
+    const Sample &Last = Window.back();
+    std::chrono::duration<double> Elapsed = Last.Time - First.Time;
+    uint64_t Done = Last.DoneTargets - First.DoneTargets;
+    if (Elapsed.count() > 0 and Done > 0) {
+      Current.TargetsPerSecond = Done / Elapsed.count();
+      Current.RemainingSeconds = Remaining / Current.TargetsPerSecond;
+      return;
+    }
+  }
+
+  if (ExpectedCost.has_value() and *ExpectedCost > 0) {
+    Current.TargetsPerSecond = 1 / *ExpectedCost;
+    Current.RemainingSeconds = Remaining * *ExpectedCost;
+  } else {
+    Current.TargetsPerSecond = 0;
+    Current.RemainingSeconds.reset();
+  }
+}
@@ -0,0 +1,118 @@
+/// \file Profiler.cpp
+/// Collection and export of the cost of running pipes.
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <ctime>
+
+#include <sys/resource.h>
+
+#include "llvm/Support/JSON.h"
+
+#include "revng/Pipeline/Profiler.h"
+
+using namespace pipeline;
+
+/// \return the CPU time consumed by the process so far, in microseconds
+static uint64_t getCPUTime() {
+  std::clock_t Ticks = std::clock();
+  return static_cast<uint64_t>(Ticks) * 1000000 / CLOCKS_PER_SEC;
+}
+
+/// \return the peak resident set size of the process so far, in KiB
+static uint64_t getPeakRSS() {
+  struct rusage Usage;
+  if (getrusage(RUSAGE_SELF, &Usage) != 0)
+    return 0;
+  return Usage.ru_maxrss;
+}
+
+uint64_t Profiler::now() const {
+  using namespace std::chrono;
+  return duration_cast<microseconds>(Clock::now() - Origin).count();
+}
+
+Profiler::Scope::Scope(Profiler *TheProfiler,
+                       llvm::StringRef Category,
+                       llvm::StringRef Name,
+                       uint64_t InputTargets) :
+  TheProfiler(TheProfiler) {
+  if (TheProfiler == nullptr)
+    return;
+
+  TheEvent.Name = Name.str();
+  TheEvent.Category = Category.str();
+  TheEvent.InputTargets = InputTargets;
+  TheEvent.Start = TheProfiler->now();
+  StartCPUTime = getCPUTime();
+  StartPeakRSS = getPeakRSS();
+
+  if (revng::PerfCounters::isEnabled()) {
+    TheEvent.HasPerfCounters = true;
+    StartPerfCounters = revng::PerfCounters::read();
+  }
+}
+
+Profiler::Scope::~Scope() {
+  if (TheProfiler == nullptr)
+    return;
+
+  TheEvent.WallTime = TheProfiler->now() - TheEvent.Start;
+  TheEvent.CPUTime = getCPUTime() - StartCPUTime;
+  TheEvent.PeakRSSDelta = getPeakRSS() - StartPeakRSS;
+  if (TheEvent.HasPerfCounters) {
+    auto End = revng::PerfCounters::read();
+    TheEvent.PerfCounters = End - StartPerfCounters;
+  }
+  TheProfiler->Events.push_back(std::move(TheEvent));
+}
+
+void Profiler::emitChromeTrace(llvm::raw_ostream &OS) const {
+  llvm::json::OStream JSON(OS);
+  JSON.object([&] {
+    JSON.attribute("displayTimeUnit", "ms");
+    JSON.attributeArray("traceEvents", [&] {
+      for (const Event &Event : Events) {
+        JSON.object([&] {
+          JSON.attribute("name", Event.Name);
+          JSON.attribute("cat", Event.Category);
+          JSON.attribute("ph", "X");
+          JSON.attribute("pid", 1);
+          JSON.attribute("tid", 1);
+          JSON.attribute("ts", static_cast<int64_t>(Event.Start));
+          JSON.attribute("dur", static_cast<int64_t>(Event.WallTime));
+          JSON.attributeObject("args", [&] {
+            JSON.attribute("cpu-time-us", static_cast<int64_t>(Event.CPUTime));
+            JSON.attribute("peak-rss-delta-kib",
+                           static_cast<int64_t>(Event.PeakRSSDelta));
+            JSON.attribute("input-targets",
+                           static_cast<int64_t>(Event.InputTargets));
+            JSON.attribute("output-targets",
+                           static_cast<int64_t>(Event.OutputTargets));
+            JSON.attribute("from-cache", Event.FromCache);
+
+            if (Event.HasIRSize) {
+              JSON.attribute("ir-functions",
+                             static_cast<int64_t>(Event.IRFunctions));
+              JSON.attribute("ir-instructions",
+                             static_cast<int64_t>(Event.IRInstructions));
+            }
+
+            if (Event.HasPerfCounters) {
+              const revng::PerfCounterValues &Counters = Event.PerfCounters;
+              JSON.attribute("cycles", static_cast<int64_t>(Counters.Cycles));
+              JSON.attribute("instructions",
+                             static_cast<int64_t>(Counters.Instructions));
+              JSON.attribute("cache-misses",
+                             static_cast<int64_t>(Counters.CacheMisses));
+              JSON.attribute("branch-misses",
+                             static_cast<int64_t>(Counters.BranchMisses));
+            }
+          });
+        });
+      }
+    });
+  });
+}
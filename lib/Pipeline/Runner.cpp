@@ -7,14 +7,18 @@
 
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Progress.h"
 
 #include "revng/Pipeline/Context.h"
+#include "revng/Pipeline/Contract.h"
 #include "revng/Pipeline/Errors.h"
+#include "revng/Pipeline/EventLog.h"
 #include "revng/Pipeline/GlobalTupleTreeDiff.h"
 #include "revng/Pipeline/Kind.h"
+#include "revng/Pipeline/Profiler.h"
 #include "revng/Pipeline/Runner.h"
 #include "revng/Pipeline/Target.h"
 #include "revng/Support/Assert.h"
@@ -42,70 +46,106 @@ public:
     PipesExecuteEntries(std::move(PipesToExecuteEntries)) {}
 };
 
+/// Computes which steps need to be executed to satisfy all the requests in
+/// \p ToProduce.
+///
+/// Steps are visited from the last to the first, and the goals of each step
+/// are merged with the inputs required by all of its successors before being
+/// analyzed. This way each step is scheduled at most once, with the union of
+/// what all the requests need from it, even when several requests go through
+/// the same steps.
+///
+/// The resulting entries are in execution order (predecessors first) and only
+/// contain the steps that actually have to run.
+static cl::opt<bool> BatchAnalysesLists("batch-analyses-lists",
+                                        cl::desc("run the analyses of a list "
+                                                 "back to back and compute "
+                                                 "the diff and the "
+                                                 "invalidations once, at the "
+                                                 "end. An analysis might "
+                                                 "observe artifacts made "
+                                                 "stale by the previous ones "
+                                                 "in the list."));
+
 static Error getObjectives(Runner &Runner,
-                           llvm::StringRef EndingStepName,
-                           const ContainerToTargetsMap &Targets,
+                           const Runner::State &ToProduce,
                            std::vector<PipelineExecutionEntry> &ToExec) {
-  ContainerToTargetsMap ToLoad = Targets;
-  Step *CurrentStep = &(Runner[EndingStepName]);
-  while (CurrentStep != nullptr and not ToLoad.empty()) {
-    ContainerToTargetsMap Output = ToLoad;
-    auto [Required, PipesExecutionEntries] = CurrentStep->analyzeGoals(ToLoad);
-    ToLoad = std::move(Required);
-    ToExec.emplace_back(*CurrentStep,
-                        Output,
-                        ToLoad,
+  ContractEvaluationScope Scope;
+
+  Runner::State Goals;
+  for (const auto &Request : ToProduce) {
+    revng_assert(Runner.containsStep(Request.first()),
+                 ("Can't find step " + Request.first()).str().c_str());
+    Goals[Request.first()].merge(Request.second);
+  }
+
+  for (Step &CurrentStep : llvm::reverse(Runner)) {
+    auto It = Goals.find(CurrentStep.getName());
+    if (It == Goals.end() or It->second.empty())
+      continue;
+
+    ContainerToTargetsMap Output = It->second;
+    auto [Required, PipesExecutionEntries] = CurrentStep.analyzeGoals(Output);
+
+    // Everything is already available in this step
+    if (Required.empty())
+      continue;
+
+    if (not CurrentStep.hasPredecessor()) {
+      ContainerToTargetsMap Requested;
+      for (const auto &Request : ToProduce)
+        Requested.merge(Request.second);
+      return make_error<UnsatisfiableRequestError>(std::move(Requested),
+                                                   std::move(Required));
+    }
+
+    Goals[CurrentStep.getPredecessor().getName()].merge(Required);
+    ToExec.emplace_back(CurrentStep,
+                        std::move(Output),
+                        std::move(Required),
                         std::move(PipesExecutionEntries));
-    CurrentStep = CurrentStep->hasPredecessor() ?
-                    &CurrentStep->getPredecessor() :
-                    nullptr;
   }
 
-  if (not ToLoad.empty())
-    return make_error<UnsatisfiableRequestError>(Targets, ToLoad);
   reverse(ToExec.begin(), ToExec.end());
 
   return Error::success();
 }
 
-static void explainPipeline(const ContainerToTargetsMap &Targets,
+static void explainPipeline(const Runner::State &ToProduce,
                             ArrayRef<PipelineExecutionEntry> Requirements) {
-  if (Requirements.empty())
+  if (not ExplanationLogger.isEnabled())
     return;
 
   ExplanationLogger << "Requested targets:\n";
-  indent(ExplanationLogger, 1);
+  for (const auto &Request : ToProduce) {
+    indent(ExplanationLogger, 1);
+    ExplanationLogger << Request.first() << ":\n";
+    prettyPrintStatus(Request.second, ExplanationLogger, 2);
+  }
 
-  if (Requirements.size() <= 1) {
+  if (Requirements.empty()) {
+    indent(ExplanationLogger, 1);
     ExplanationLogger << "Already satisfied\n";
+    ExplanationLogger << DoLog;
     return;
   }
 
-  ExplanationLogger << Requirements.back().ToExecute->getName() << ":\n";
-  prettyPrintStatus(Targets, ExplanationLogger, 2);
-
   ExplanationLogger << DoLog;
 
   ExplanationLogger << "We need to have the following targets at the beginning "
                        "of the steps\n";
 
-  indent(ExplanationLogger, 1);
-  ExplanationLogger << Requirements.back().ToExecute->getName() << ":\n";
-  prettyPrintStatus(Targets, ExplanationLogger, 2);
-
-  for (size_t I = Requirements.size(); I != 0; I--) {
-    StringRef StepName = Requirements[I - 1].ToExecute->getName();
-    const ContainerToTargetsMap &TargetsNeeded = Requirements[I - 1].Input;
-
+  for (const PipelineExecutionEntry &Entry : llvm::reverse(Requirements)) {
     indent(ExplanationLogger, 1);
-    ExplanationLogger << StepName << ":\n";
-    prettyPrintStatus(TargetsNeeded, ExplanationLogger, 2);
+    ExplanationLogger << Entry.ToExecute->getName() << ":\n";
+    prettyPrintStatus(Entry.Input, ExplanationLogger, 2);
   }
 
   ExplanationLogger << DoLog;
 }
 
 Error Runner::getInvalidations(TargetInStepSet &Invalidated) const {
+  ContractEvaluationScope Scope;
 
   for (const Step &NextS : *this) {
     if (not NextS.hasPredecessor())
@@ -273,9 +313,48 @@ Runner::runAnalysis(llvm::StringRef AnalysisName,
                     const ContainerToTargetsMap &Targets,
                     TargetInStepSet &InvalidationsMap,
                     const llvm::StringMap<std::string> &Options) {
-
   GlobalsMap Before = getContext().getGlobals();
+  return runAnalysis(AnalysisName,
+                     StepName,
+                     Targets,
+                     InvalidationsMap,
+                     Options,
+                     Before);
+}
 
+llvm::Expected<DiffMap>
+Runner::runAnalysis(llvm::StringRef AnalysisName,
+                    llvm::StringRef StepName,
+                    const ContainerToTargetsMap &Targets,
+                    TargetInStepSet &InvalidationsMap,
+                    const llvm::StringMap<std::string> &Options,
+                    GlobalsMap &Before) {
+  Task T(2, "Analysis execution");
+  T.advance("Run analysis", true);
+  if (llvm::Error Error = executeAnalysis(AnalysisName,
+                                          StepName,
+                                          Targets,
+                                          Options))
+    return std::move(Error);
+
+  T.advance("Apply diff produced by the analysis", true);
+  const GlobalsMap &After = getContext().getGlobals();
+  DiffMap Map = Before.diff(After);
+  for (const auto &GlobalNameDiffPair : Map)
+    if (llvm::Error Error = apply(GlobalNameDiffPair.second, InvalidationsMap))
+      return std::move(Error);
+
+  if (llvm::Error Error = Before.applyDiffs(Map))
+    return std::move(Error);
+
+  return std::move(Map);
+}
+
+llvm::Error Runner::executeAnalysis(llvm::StringRef AnalysisName,
+                                    llvm::StringRef StepName,
+                                    const ContainerToTargetsMap &Targets,
+                                    const llvm::StringMap<std::string>
+                                      &Options) {
   auto MaybeStep = Steps.find(StepName);
 
   if (MaybeStep == Steps.end()) {
@@ -284,27 +363,31 @@ Runner::runAnalysis(llvm::StringRef AnalysisName,
                              StepName.str().c_str());
   }
 
-  Task T(3, "Analysis execution");
+  Task T(2, "Analysis " + AnalysisName);
   T.advance("Produce step " + StepName, true);
   if (llvm::Error Error = run(StepName, Targets))
-    return std::move(Error);
+    return Error;
 
   T.advance("Run analysis", true);
-  if (llvm::Error Error = MaybeStep->second.runAnalysis(AnalysisName,
-                                                        Targets,
-                                                        Options);
-      Error) {
-    return std::move(Error);
-  }
+  Profiler::Scope AnalysisScope(TheContext->getProfiler(),
+                                "analysis",
+                                AnalysisName);
+  return MaybeStep->second.runAnalysis(AnalysisName, Targets, Options);
+}
 
-  T.advance("Apply diff produced by the analysis", true);
-  const GlobalsMap &After = getContext().getGlobals();
-  DiffMap Map = Before.diff(After);
-  for (const auto &GlobalNameDiffPair : Map)
-    if (llvm::Error Error = apply(GlobalNameDiffPair.second, InvalidationsMap))
-      return std::move(Error);
+ContainerToTargetsMap Runner::analysisTargets(const AnalysisReference &Ref) {
+  const Step &Step = getStep(Ref.getStepName());
+  const AnalysisWrapper &Analysis = Step.getAnalysis(Ref.getAnalysisName());
+  ContainerToTargetsMap Map;
+  const std::vector<std::string>
+    &Containers = Analysis->getRunningContainersNames();
+  for (size_t I = 0; I < Containers.size(); I++) {
+    for (const Kind *K : Analysis->getAcceptedKinds(I)) {
+      Map.add(Containers[I], TargetsList::allTargets(getContext(), *K));
+    }
+  }
 
-  return std::move(Map);
+  return Map;
 }
 
 /// Run all analysis in reverse post order (that is: parents first),
@@ -314,26 +397,47 @@ Runner::runAnalyses(const AnalysesList &List,
                     const llvm::StringMap<std::string> &Options) {
   GlobalsMap Before = getContext().getGlobals();
 
+  if (BatchAnalysesLists) {
+    // Run the analyses back to back, then diff and invalidate once
+    Task T(List.size() + 1, "Analysis list " + List.getName());
+    for (const AnalysisReference &Ref : List) {
+      T.advance(Ref.getAnalysisName(), true);
+      if (llvm::Error Error = executeAnalysis(Ref.getAnalysisName(),
+                                              Ref.getStepName(),
+                                              analysisTargets(Ref),
+                                              Options))
+        return std::move(Error);
+    }
+
+    T.advance("Computing analysis list diff", true);
+    const GlobalsMap &After = getContext().getGlobals();
+    DiffMap Map = Before.diff(After);
+    for (const auto &GlobalNameDiffPair : Map)
+      if (llvm::Error Error = apply(GlobalNameDiffPair.second,
+                                    InvalidationsMap))
+        return std::move(Error);
+
+    return std::move(Map);
+  }
+
+  // Each analysis needs the state of the globals right before it runs: keep a
+  // second copy up to date through the diffs, rather than copying the globals
+  // once per analysis
+  GlobalsMap Current = Before;
+
   Task T(List.size() + 1, "Analysis list " + List.getName());
   for (const AnalysisReference &Ref : List) {
     T.advance(Ref.getAnalysisName(), true);
     const Step &Step = getStep(Ref.getStepName());
-    const AnalysisWrapper &Analysis = Step.getAnalysis(Ref.getAnalysisName());
-    ContainerToTargetsMap Map;
-    const std::vector<std::string>
-      &Containers = Analysis->getRunningContainersNames();
-    for (size_t I = 0; I < Containers.size(); I++) {
-      for (const Kind *K : Analysis->getAcceptedKinds(I)) {
-        Map.add(Containers[I], TargetsList::allTargets(getContext(), *K));
-      }
-    }
+    ContainerToTargetsMap Map = analysisTargets(Ref);
 
     TargetInStepSet NewInvalidationsMap;
     auto Result = runAnalysis(Ref.getAnalysisName(),
                               Step.getName(),
                               Map,
                               NewInvalidationsMap,
-                              Options);
+                              Options,
+                              Current);
     if (not Result)
       return Result.takeError();
     for (auto &NewEntry : NewInvalidationsMap)
@@ -345,34 +449,23 @@ Runner::runAnalyses(const AnalysesList &List,
   return Before.diff(After);
 }
 
-Error Runner::run(const State &ToProduce) {
-  Task T(ToProduce.size(), "Multi-step pipeline run");
-  for (const auto &Request : ToProduce) {
-    T.advance(Request.first(), true);
-    if (llvm::Error Error = run(Request.first(), Request.second))
-      return Error;
-  }
-
-  return llvm::Error::success();
+static Error createCancellationError() {
+  return createStringError(std::errc::operation_canceled,
+                           "The production has been cancelled");
 }
 
-Error Runner::run(llvm::StringRef EndingStepName,
-                  const ContainerToTargetsMap &Targets) {
-
+Error Runner::run(const State &ToProduce) {
   vector<PipelineExecutionEntry> ToExec;
-  revng_log(ExplanationLogger, "Running until step " << EndingStepName);
 
-  if (llvm::Error Error = getObjectives(*this, EndingStepName, Targets, ToExec);
-      Error) {
+  if (llvm::Error Error = getObjectives(*this, ToProduce, ToExec); Error)
     return Error;
-  }
 
-  explainPipeline(Targets, ToExec);
+  explainPipeline(ToProduce, ToExec);
 
-  if (ToExec.size() <= 1)
+  if (ToExec.empty())
     return Error::success();
 
-  for (PipelineExecutionEntry &StepGoalsPairs : llvm::drop_begin(ToExec)) {
+  for (PipelineExecutionEntry &StepGoalsPairs : ToExec) {
     Step &Step = *StepGoalsPairs.ToExecute;
     if (llvm::Error Error = Step.checkPrecondition(); Error) {
       return llvm::make_error<AnnotatedError>(std::move(Error),
@@ -381,9 +474,12 @@ Error Runner::run(llvm::StringRef EndingStepName,
     }
   }
 
-  Task T(ToExec.size() - 1, "Produce steps required up to " + EndingStepName);
-  for (PipelineExecutionEntry &StepGoalsPairs : llvm::drop_begin(ToExec)) {
+  Task T(ToExec.size(), "Produce steps");
+  for (PipelineExecutionEntry &StepGoalsPairs : ToExec) {
     auto &[Step, PredictedOutput, Input, PipesInfo] = StepGoalsPairs;
+    if (getContext().isCancellationRequested())
+      return createCancellationError();
+
     T.advance(Step->getName(), true);
 
     Task T2(3, "Run step");
@@ -394,17 +490,21 @@ Error Runner::run(llvm::StringRef EndingStepName,
 
     // Run the step
     T2.advance("Run the step", true);
-    Step->run(std::move(CurrentContainer), PipesInfo);
+    Step->runInPlace(std::move(CurrentContainer), PipesInfo);
+    if (getContext().isCancellationRequested())
+      return createCancellationError();
 
     T2.advance("Extract the requested targets", true);
     if (VerifyLog.isEnabled()) {
-      ContainerSet Produced = Step->containers().cloneFiltered(PredictedOutput);
+      // Look at the enumeration only, cloning the containers is expensive
+      ContainerToTargetsMap Produced = PredictedOutput;
+      Step->containers().intersect(Produced);
 
-      if (not Produced.enumerate().contains(PredictedOutput)) {
+      if (not Produced.contains(PredictedOutput)) {
         dbg << "PredictedOutput:\n";
         PredictedOutput.dump(dbg, 2, false);
         dbg << "Produced:\n";
-        Produced.enumerate().dump(dbg, 2, false);
+        Produced.dump(dbg, 2, false);
         revng_abort("Not all the expected targets have been produced");
       }
       revng_check(Step->containers().enumerate().contains(PredictedOutput));
@@ -413,17 +513,28 @@ Error Runner::run(llvm::StringRef EndingStepName,
 
   if (ExplanationLogger.isEnabled()) {
     ExplanationLogger << "PRODUCED\n";
-    indent(ExplanationLogger, 1);
-    ExplanationLogger << EndingStepName << ":\n";
-    ToExec.back().ToExecute->containers().enumerate().dump(ExplanationLogger,
-                                                           2,
-                                                           false);
+    for (const auto &Request : ToProduce) {
+      indent(ExplanationLogger, 1);
+      ExplanationLogger << Request.first() << ":\n";
+      getStep(Request.first()).containers().enumerate().dump(ExplanationLogger,
+                                                             2,
+                                                             false);
+    }
     ExplanationLogger << DoLog;
   }
 
   return Error::success();
 }
 
+Error Runner::run(llvm::StringRef EndingStepName,
+                  const ContainerToTargetsMap &Targets) {
+  revng_log(ExplanationLogger, "Running until step " << EndingStepName);
+
+  State ToProduce;
+  ToProduce.try_emplace(EndingStepName, Targets);
+  return run(ToProduce);
+}
+
 Error Runner::invalidate(const TargetInStepSet &Invalidations) {
   for (const auto &Step : Invalidations) {
     llvm::StringRef StepName = Step.first();
@@ -442,6 +553,7 @@ void Runner::getCurrentState(State &Out) const {
 }
 
 void Runner::deduceAllPossibleTargets(State &Out) const {
+  ContractEvaluationScope Scope;
   getCurrentState(Out);
 
   for (const auto &NextStep : *this) {
@@ -479,19 +591,29 @@ void Runner::getDiffInvalidations(const GlobalTupleTreeDiff &Diff,
     // Also, this will invalidate all the targets depending on them and all the
     // targets depending on stuff that's already in Map.
     revng_log(InvalidationLog, Diff.getPaths().size() << " paths have changed");
-    for (const TupleTreePath *Path : Diff.getPaths()) {
-      revng_log(InvalidationLog, "Processing " << *Diff.pathAsString(*Path));
-      LoggerIndent<> Indent(InvalidationLog);
-      Step.registerTargetsDependingOn(Diff.getGlobalName(),
-                                      *Path,
-                                      Map,
-                                      InvalidationLog);
-    }
+    Step.registerTargetsDependingOn(Diff, Map, InvalidationLog);
   }
 }
 
+llvm::Expected<CostEstimate>
+Runner::estimateInvalidations(const GlobalTupleTreeDiff &Diff,
+                              TargetInStepSet &Map) const {
+  getDiffInvalidations(Diff, Map);
+  if (auto Error = getInvalidations(Map); Error)
+    return std::move(Error);
+
+  return TheContext->getTargetCosts().estimate(Map);
+}
+
 llvm::Error Runner::apply(const GlobalTupleTreeDiff &Diff,
                           TargetInStepSet &Map) {
+  if (EventLog *Events = TheContext->getEventLog()) {
+    for (const TupleTreePath *Path : Diff.getPaths()) {
+      std::optional<std::string> MaybePath = Diff.pathAsString(*Path);
+      Events->globalChanged(Diff.getGlobalName(), MaybePath.value_or(""));
+    }
+  }
+
   getDiffInvalidations(Diff, Map);
   if (auto Error = getInvalidations(Map); Error)
     return Error;
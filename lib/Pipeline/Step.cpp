@@ -6,15 +6,22 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <chrono>
+
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Progress.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include "revng/Pipeline/ArtifactCache.h"
 #include "revng/Pipeline/ContainerSet.h"
 #include "revng/Pipeline/Context.h"
 #include "revng/Pipeline/Errors.h"
+#include "revng/Pipeline/EventLog.h"
+#include "revng/Pipeline/LLVMContainer.h"
+#include "revng/Pipeline/ProductionProgress.h"
+#include "revng/Pipeline/Profiler.h"
 #include "revng/Pipeline/Step.h"
 #include "revng/Pipeline/Target.h"
 #include "revng/Support/Assert.h"
@@ -24,6 +31,8 @@ using namespace llvm;
 using namespace std;
 using namespace pipeline;
 
+static Logger<> ArtifactCacheLog("artifact-cache");
+
 namespace pipeline {
 
 class TargetInPipe {
@@ -161,12 +170,17 @@ ContainerInvalidationMetadata::serialize(const PathTargetBimap &Map,
   std::map<pipeline::TargetInPipe, std::vector<std::string>> TemporaryMap;
 
   for (const auto &Content : Map) {
+    // Serialize the path lazily, but only once for all of its targets
+    std::optional<std::string> AsString;
     for (const TargetInContainer &Entry : Content.second) {
       if (Entry.getContainerName() != ContainerName)
         continue;
 
-      std::optional<std::string> AsString = Global.serializePath(Content.first);
-      revng_check(AsString.has_value());
+      if (not AsString.has_value()) {
+        AsString = Global.serializePath(Content.first);
+        revng_check(AsString.has_value());
+      }
+
       TemporaryMap[TargetInPipe::fromTargetInContainer(Entry, PipeName)]
         .push_back(*AsString);
     }
@@ -188,6 +202,11 @@ ContainerInvalidationMetadata::deserialize(const Context &Context,
   const {
 
   PathTargetBimap ToReturn;
+
+  // The same paths (e.g., the architecture of the binary) are read by most
+  // targets: parse each of them only once
+  llvm::StringMap<TupleTreePath> ParsedPaths;
+
   for (const ValueType &Entry : Data) {
     if (Entry.first.PipeName != PipeName) {
       continue;
@@ -201,17 +220,22 @@ ContainerInvalidationMetadata::deserialize(const Context &Context,
     }
 
     for (auto &SerializedPath : Entry.second) {
-      std::optional<TupleTreePath>
-        MaybeParsedPath = Global.deserializePath(SerializedPath);
-
-      if (not MaybeParsedPath) {
-        return llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                       "could not parse " + SerializedPath);
+      auto It = ParsedPaths.find(SerializedPath);
+      if (It == ParsedPaths.end()) {
+        std::optional<TupleTreePath>
+          MaybeParsedPath = Global.deserializePath(SerializedPath);
+
+        if (not MaybeParsedPath) {
+          return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                         "could not parse " + SerializedPath);
+        }
+
+        TupleTreePath &Parsed = *MaybeParsedPath;
+        It = ParsedPaths.try_emplace(SerializedPath, std::move(Parsed)).first;
       }
 
-      for (const TargetInContainer &Path : *MaybeTarget) {
-        ToReturn.insert(std::move(Path), std::move(*MaybeParsedPath));
-      }
+      for (const TargetInContainer &Target : *MaybeTarget)
+        ToReturn.insert(Target, It->second);
     }
   }
 
@@ -237,6 +261,60 @@ Step::analyzeGoals(const ContainerToTargetsMap &RequiredGoals) const {
   return std::make_pair(std::move(Targets), std::move(PipesExecutionEntries));
 }
 
+ContainerToTargetsMap Step::targetsDependingOn(llvm::StringRef GlobalName,
+                                               const TupleTreePath &Path,
+                                               Logger<> &Log) const {
+  ContainerToTargetsMap Result;
+  for (const PipeWrapper &Pipe : Pipes) {
+    revng_log(Log, "Handling the " << Pipe.Pipe->getName() << " pipe");
+    LoggerIndent<> Indent(Log);
+    Pipe.InvalidationMetadata.registerTargetsDependingOn(*TheContext,
+                                                         GlobalName,
+                                                         Path,
+                                                         Result,
+                                                         Log);
+    Pipe.Pipe->deduceResults(*TheContext, Result);
+  }
+
+  return Result;
+}
+
+void Step::intersectWithContainers(ContainerToTargetsMap &Map) const {
+  for (auto &Container : Map) {
+    if (Containers.contains(Container.first())) {
+      const ContainerBase &Current = Containers.at(Container.first());
+      Container.second = Container.second.intersect(Current.enumerate());
+    }
+  }
+}
+
+void Step::registerTargetsDependingOn(const GlobalTupleTreeDiff &Diff,
+                                      TargetInStepSet &Out,
+                                      Logger<> &Log) const {
+  // Without invalidation metadata, we cannot tell what depends on the changed
+  // paths: be conservative
+  if (not TheContext->isReadTrackingEnabled()) {
+    if (not Diff.getPaths().empty()) {
+      revng_log(Log, "Read tracking is disabled, invalidating everything");
+      Out[getName()].merge(Containers.enumerate());
+    }
+    return;
+  }
+
+  // Intersecting commutes with merging, hence we can intersect only once
+  ContainerToTargetsMap ToInvalidateMap;
+  for (const TupleTreePath *Path : Diff.getPaths()) {
+    revng_log(Log, "Processing " << *Diff.pathAsString(*Path));
+    LoggerIndent<> Indent(Log);
+    ToInvalidateMap.merge(targetsDependingOn(Diff.getGlobalName(),
+                                             *Path,
+                                             Log));
+  }
+
+  intersectWithContainers(ToInvalidateMap);
+  Out[getName()].merge(ToInvalidateMap);
+}
+
 void Step::explainStartStep(const ContainerToTargetsMap &Targets,
                             size_t Indentation) const {
 
@@ -277,31 +355,333 @@ void Step::explainExecutedPipe(const InvokableWrapperBase &Wrapper,
   ExplanationLogger << DoLog;
 }
 
+static uint64_t countTargets(const ContainerToTargetsMap &Targets) {
+  uint64_t Result = 0;
+  for (const auto &Entry : Targets)
+    Result += Entry.second.size();
+  return Result;
+}
+
+/// \return the average cost of a target in \p Targets, if the cost of all of
+///         their containers has been recorded
+static std::optional<double>
+expectedCost(const TargetCosts &Costs,
+             llvm::StringRef StepName,
+             const ContainerToTargetsMap &Targets) {
+  double Seconds = 0;
+  uint64_t Count = 0;
+  for (const auto &Entry : Targets) {
+    uint64_t Size = Entry.second.size();
+    if (Size == 0)
+      continue;
+
+    auto Cost = Costs.averageCost(StepName, Entry.first());
+    if (not Cost.has_value())
+      return std::nullopt;
+
+    Seconds += *Cost * Size;
+    Count += Size;
+  }
+
+  if (Count == 0)
+    return std::nullopt;
+
+  return Seconds / Count;
+}
+
+static std::vector<std::string> getOutputContainers(const PipeWrapper &Pipe) {
+  std::vector<std::string> Result;
+  std::vector<std::string> Names = Pipe.Pipe->getRunningContainersNames();
+  for (size_t I = 0; I < Names.size(); ++I)
+    if (not Pipe.Pipe->isContainerArgumentConst(I))
+      Result.push_back(std::move(Names[I]));
+  return Result;
+}
+
+/// Record in \p Scope the size of the LLVM modules written by \p Pipe
+static void recordIRSize(Profiler::Scope &Scope,
+                         const PipeWrapper &Pipe,
+                         const ContainerSet &Containers) {
+  for (const std::string &Name : getOutputContainers(Pipe)) {
+    if (not Containers.contains(Name))
+      continue;
+
+    const auto *Container = dyn_cast<LLVMContainer>(&Containers.at(Name));
+    if (Container == nullptr)
+      continue;
+
+    auto Statistics = FunctionsStatistics::analyze(Container->getModule());
+    const FunctionClass &All = Statistics.AllFunctions;
+    Scope.addIRSize(All.DefinitionsCount, All.InstructionsStatistics.sum());
+  }
+}
+
+std::string Step::computeCacheKey(const ArtifactCache &Cache,
+                                  const PipeWrapper &Pipe,
+                                  const PipeExecutionEntry &Info,
+                                  const ContainerSet &Input) const {
+  auto Builder = Cache.makeKeyBuilder();
+  Builder->addField(getName());
+  Builder->addField(Pipe.Pipe->getName());
+
+  for (const std::string &Name : Pipe.Pipe->getRunningContainersNames()) {
+    Builder->addField(Name);
+
+    // Requested targets
+    if (auto It = Info.Output.find(Name); It != Info.Output.end()) {
+      Builder->addField(std::to_string(It->second.size()));
+      for (const Target &Target : It->second)
+        Builder->addField(Target.toString());
+    }
+
+    // Current content
+    Builder->addField(Input.contains(Name) ? "present" : "absent");
+    if (Input.contains(Name))
+      llvm::cantFail(Input.at(Name).serialize(*Builder));
+  }
+
+  // The read fields are known only after the pipe has run: conservatively
+  // consider the whole content of each global
+  for (const Global *Global : TheContext->getGlobals()) {
+    Builder->addField(Global->getName());
+    llvm::cantFail(Global->serialize(*Builder));
+  }
+
+  return Builder->finalize();
+}
+
+llvm::Expected<bool> Step::restoreFromCache(const ArtifactCache &Cache,
+                                            llvm::StringRef Key,
+                                            PipeWrapper &Pipe,
+                                            ContainerSet &Input) {
+  auto MaybeContains = Cache.contains(Key);
+  if (not MaybeContains or not MaybeContains.get())
+    return MaybeContains;
+
+  revng::DirectoryPath Entry = Cache.getEntry(Key);
+  for (const std::string &Name : getOutputContainers(Pipe)) {
+    revng::FilePath ContainerPath = Entry.getFile(Name);
+    auto MaybeExists = ContainerPath.exists();
+    if (not MaybeExists)
+      return MaybeExists.takeError();
+
+    // The pipe did not produce the container
+    if (not MaybeExists.get())
+      continue;
+
+    if (auto Error = Input[Name].load(ContainerPath); Error)
+      return Error;
+
+    // Replay the invalidation metadata of the targets committed by the pipe
+    auto File = Entry.getFile(Name + ".cache").getReadableFile();
+    if (not File)
+      return File.takeError();
+
+    using Type = llvm::SmallVector<NamedPathTargetBimapVector, 2>;
+    auto Parsed = ::fromString<Type>(File.get()->buffer().getBuffer());
+    if (not Parsed)
+      return Parsed.takeError();
+
+    for (NamedPathTargetBimapVector &Metadata : *Parsed) {
+      auto MaybeGlobal = TheContext->getGlobals().get(Metadata.GlobalName);
+      if (not MaybeGlobal)
+        return MaybeGlobal.takeError();
+
+      auto MaybeBimap = Metadata.Map.deserialize(*TheContext,
+                                                 **MaybeGlobal,
+                                                 Pipe.Pipe->getName(),
+                                                 Name);
+      if (not MaybeBimap)
+        return MaybeBimap.takeError();
+
+      Pipe.InvalidationMetadata.getPathCache(Metadata.GlobalName)
+        .merge(std::move(*MaybeBimap));
+    }
+  }
+
+  return true;
+}
+
+llvm::Error Step::storeInCache(ArtifactCache &Cache,
+                               llvm::StringRef Key,
+                               const PipeWrapper &Pipe,
+                               const ContainerToTargetsMap &Committed,
+                               const ContainerSet &Input) const {
+  auto MaybeEntry = Cache.createEntry(Key);
+  if (not MaybeEntry)
+    return MaybeEntry.takeError();
+
+  // Collect the read fields of the targets committed by this run only, the
+  // invalidation metadata of the pipe also contains those of previous runs
+  llvm::StringMap<PathTargetBimap> ReadFields;
+  for (const auto &Entry : Pipe.InvalidationMetadata.getPathCache()) {
+    PathTargetBimap &Filtered = ReadFields[Entry.first()];
+    for (const auto &[Path, Targets] : Entry.second) {
+      for (const TargetInContainer &Target : Targets) {
+        auto It = Committed.find(Target.getContainerName());
+        if (It != Committed.end() and It->second.contains(Target.getTarget()))
+          Filtered.insert(Target, Path);
+      }
+    }
+  }
+
+  for (const std::string &Name : getOutputContainers(Pipe)) {
+    if (not Input.contains(Name))
+      continue;
+
+    revng::FilePath ContainerPath = MaybeEntry->getFile(Name);
+    if (auto Error = Input.at(Name).store(ContainerPath); Error)
+      return Error;
+
+    llvm::SmallVector<NamedPathTargetBimapVector, 2> ToStore;
+    for (const Global *Global : TheContext->getGlobals()) {
+      auto It = ReadFields.find(Global->getName());
+      if (It == ReadFields.end())
+        continue;
+
+      NamedPathTargetBimapVector Metadata;
+      Metadata.GlobalName = Global->getName();
+      Metadata.Map = ContainerInvalidationMetadata::serialize(It->second,
+                                                              *Global,
+                                                              Pipe.Pipe
+                                                                ->getName(),
+                                                              Name);
+      ToStore.emplace_back(std::move(Metadata));
+    }
+
+    auto File = MaybeEntry->getFile(Name + ".cache").getWritableFile();
+    if (not File)
+      return File.takeError();
+    ::serialize(File->get()->os(), ToStore);
+    if (auto Error = File->get()->commit())
+      return Error;
+  }
+
+  return Cache.markComplete(Key);
+}
+
 ContainerSet Step::run(ContainerSet &&Input,
                        const std::vector<PipeExecutionEntry> &ExecutionInfos) {
+  auto MaybeProduced = runInPlace(std::move(Input), ExecutionInfos);
+  if (not MaybeProduced.has_value())
+    return ContainerSet();
+
+  return Containers.cloneFiltered(*MaybeProduced);
+}
+
+std::optional<ContainerToTargetsMap>
+Step::runInPlace(ContainerSet &&Input,
+                 const std::vector<PipeExecutionEntry> &ExecutionInfos) {
   ContainerToTargetsMap InputEnumeration = Input.enumerate();
   explainStartStep(InputEnumeration);
 
+  ArtifactCache *Cache = TheContext->getArtifactCache();
+  Profiler *TheProfiler = TheContext->getProfiler();
+  Profiler::Scope StepScope(TheProfiler,
+                            "step",
+                            getName(),
+                            countTargets(InputEnumeration));
+
   Task T(Pipes.size() + 1, "Step " + getName());
   for (const auto &[Pipe, Info] : llvm::zip(Pipes, ExecutionInfos)) {
+    // Drop the partial results: the containers of the step are left untouched
+    if (TheContext->isCancellationRequested())
+      return std::nullopt;
+
     T.advance(Pipe.Pipe->getName(), false);
+    Profiler::Scope PipeScope(TheProfiler,
+                              "pipe",
+                              Pipe.Pipe->getName(),
+                              countTargets(Info.Input));
+
+    // The key must be computed before the execution context starts tracking
+    // accesses to the globals
+    std::string CacheKey;
+    if (Cache != nullptr) {
+      CacheKey = computeCacheKey(*Cache, Pipe, Info, Input);
+
+      auto MaybeRestored = restoreFromCache(*Cache, CacheKey, Pipe, Input);
+      if (not MaybeRestored) {
+        revng_log(ArtifactCacheLog,
+                  "Cannot restore " << CacheKey << ": "
+                                    << toString(MaybeRestored.takeError()));
+      } else if (MaybeRestored.get()) {
+        revng_log(ArtifactCacheLog,
+                  "Restored " << Pipe.Pipe->getName() << " from " << CacheKey);
+        ExplanationLogger << "Restored " << Pipe.Pipe->getName() << " in step "
+                          << getName() << " from the artifact cache" << DoLog;
+        llvm::cantFail(Input.verify());
+        PipeScope.setFromCache();
+        PipeScope.setOutputTargets(countTargets(Info.Output));
+        continue;
+      }
+    }
+
     explainExecutedPipe(*Pipe.Pipe);
 
     ExecutionContext EC(*TheContext, &Pipe, Info.Output);
 
     Pipe.Pipe->deduceResults(*TheContext, EC.getCurrentRequestedTargets());
 
+    ProductionProgress *Progress = TheContext->getProgress();
+    if (Progress != nullptr) {
+      const ContainerToTargetsMap &Requested = EC.getCurrentRequestedTargets();
+      Progress->startPipe(getName(),
+                          Pipe.Pipe->getName(),
+                          countTargets(Requested),
+                          expectedCost(TheContext->getTargetCosts(),
+                                       getName(),
+                                       Requested));
+    }
+
+    auto Start = std::chrono::steady_clock::now();
     cantFail(Pipe.Pipe->run(EC, Input));
+    if (Progress != nullptr)
+      Progress->endPipe();
+    if (TheContext->isCancellationRequested())
+      return std::nullopt;
+
+    std::chrono::duration<double> Elapsed = std::chrono::steady_clock::now()
+                                            - Start;
+    TheContext->getTargetCosts().record(getName(),
+                                        EC.getCurrentRequestedTargets(),
+                                        Elapsed.count());
+
     llvm::cantFail(Input.verify());
     EC.verify();
+    PipeScope.setOutputTargets(countTargets(EC.getCurrentRequestedTargets()));
+    if (TheProfiler != nullptr)
+      recordIRSize(PipeScope, Pipe, Input);
+
+    // Partial results must not outlive the current session
+    if (EC.hasPartialResults()) {
+      ExplanationLogger << Pipe.Pipe->getName()
+                        << " produced partial results, not caching them"
+                        << DoLog;
+    } else if (Cache != nullptr) {
+      const ContainerToTargetsMap &Committed = EC.getCurrentRequestedTargets();
+      if (auto Error = storeInCache(*Cache, CacheKey, Pipe, Committed, Input)) {
+        revng_log(ArtifactCacheLog,
+                  "Cannot store " << CacheKey << ": "
+                                  << toString(std::move(Error)));
+      }
+    }
   }
 
   T.advance("Merging back", true);
-  explainEndStep(Input.enumerate());
+  ContainerToTargetsMap OutputEnumeration = Input.enumerate();
+  explainEndStep(OutputEnumeration);
+  if (EventLog *Events = TheContext->getEventLog()) {
+    // Report only the targets that were not available already
+    OutputEnumeration.erase(Containers.enumerate());
+    for (const auto &Entry : OutputEnumeration)
+      for (const Target &Produced : Entry.second)
+        Events->targetProduced(getName(), Entry.first(), Produced);
+  }
   Containers.mergeBack(std::move(Input));
   InputEnumeration = deduceResults(InputEnumeration);
-  ContainerSet Cloned = Containers.cloneFiltered(InputEnumeration);
-  return Cloned;
+  StepScope.setOutputTargets(countTargets(InputEnumeration));
+  return InputEnumeration;
 }
 
 void Step::pipeInvalidate(const GlobalTupleTreeDiff &Diff,
@@ -366,6 +746,15 @@ ContainerToTargetsMap Step::deduceResults(ContainerToTargetsMap Input) const {
 }
 
 Error Step::invalidate(const ContainerToTargetsMap &ToRemove) {
+  if (EventLog *Events = TheContext->getEventLog()) {
+    // Report only the targets that are actually going away
+    ContainerToTargetsMap Removed = ToRemove;
+    Containers.intersect(Removed);
+    for (const auto &Entry : Removed)
+      for (const Target &Invalidated : Entry.second)
+        Events->targetInvalidated(getName(), Entry.first(), Invalidated);
+  }
+
   for (auto &Pipe : Pipes) {
     Pipe.InvalidationMetadata.remove(ToRemove);
   }
@@ -376,6 +765,10 @@ Error Step::store(const revng::DirectoryPath &DirPath) const {
   if (auto Error = Containers.store(DirPath))
     return Error;
 
+  // There's no metadata to store, keep the one of the previous runs, if any
+  if (not TheContext->isReadTrackingEnabled())
+    return llvm::Error::success();
+
   return storeInvalidationMetadata(DirPath);
 }
 
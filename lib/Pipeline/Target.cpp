@@ -6,7 +6,10 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <mutex>
+
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/Error.h"
 
 #include "revng/Pipeline/Container.h"
@@ -21,25 +24,43 @@ using namespace std;
 using namespace llvm;
 
 bool TargetsList::contains(const Target &Target) const {
-  return find(*this, Target) != end();
+  return std::binary_search(begin(), end(), Target);
 }
 
 void TargetsList::merge(const TargetsList &Source) {
+  if (Source.empty())
+    return;
+
+  // Both lists are sorted: append and merge in linear time
+  auto Middle = Contained.size();
   copy(Source, back_inserter(Contained));
-  llvm::sort(Contained);
+  std::inplace_merge(Contained.begin(),
+                     Contained.begin() + Middle,
+                     Contained.end());
   Contained.erase(unique(Contained.begin(), Contained.end()), Contained.end());
 }
 
+void TargetsList::erase(const TargetsList &Targets) {
+  if (Targets.empty() or empty())
+    return;
+
+  List Result;
+  Result.reserve(Contained.size());
+  std::set_difference(Contained.begin(),
+                      Contained.end(),
+                      Targets.begin(),
+                      Targets.end(),
+                      std::back_inserter(Result));
+  Contained = std::move(Result);
+}
+
 void ContainerToTargetsMap::erase(const ContainerToTargetsMap &Other) {
   for (const auto &Container : Other.Status) {
     const auto &ContainerName = Container.first();
     const auto &ContainerSymbols = Container.second;
     if (Status.find(ContainerName) == Status.end())
       continue;
-    auto &ToRemoveFrom = Status[ContainerName];
-
-    for (auto &Symbol : ContainerSymbols)
-      ToRemoveFrom.erase(Symbol);
+    Status[ContainerName].erase(ContainerSymbols);
   }
 }
 
@@ -78,6 +99,15 @@ int Target::operator<=>(const Target &Other) const {
   return 0;
 }
 
+StringRef Target::intern(StringRef String) {
+  // Entries are never removed, hence the returned references are stable
+  static std::mutex Mutex;
+  static StringSet<> Pool;
+
+  std::lock_guard Lock(Mutex);
+  return Pool.insert(String).first->getKey();
+}
+
 std::string Target::toString() const {
   std::string ToReturn;
 
@@ -85,8 +115,10 @@ std::string Target::toString() const {
     return ":" + K->name().str();
   }
 
-  for (size_t I = 0; I < Components.size() - 1; I++)
-    ToReturn += Components[I] + "/";
+  for (size_t I = 0; I < Components.size() - 1; I++) {
+    ToReturn += Components[I];
+    ToReturn += "/";
+  }
 
   ToReturn += Components.back();
   ToReturn += ":";
@@ -0,0 +1,127 @@
+/// \file TargetCosts.cpp
+/// Recording of the cost of producing targets and invalidation estimates.
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Format.h"
+
+#include "revng/Pipeline/TargetCosts.h"
+#include "revng/Storage/ReadableFile.h"
+#include "revng/Storage/WritableFile.h"
+
+using namespace pipeline;
+
+void CostEstimate::dump(llvm::raw_ostream &OS) const {
+  OS << "EstimatedSeconds: " << llvm::format("%.3f", Seconds) << "\n";
+  OS << "Targets: " << Targets << "\n";
+  OS << "UnknownTargets: " << UnknownTargets << "\n";
+}
+
+void TargetCosts::record(llvm::StringRef StepName,
+                         const ContainerToTargetsMap &Produced,
+                         double Seconds) {
+  uint64_t Total = 0;
+  for (const auto &Entry : Produced)
+    Total += Entry.second.size();
+
+  if (Total == 0)
+    return;
+
+  auto &StepCosts = Costs[StepName];
+  for (const auto &Entry : Produced) {
+    uint64_t Count = Entry.second.size();
+    if (Count == 0)
+      continue;
+
+    auto &Cost = StepCosts[Entry.first()];
+    Cost.Seconds += Seconds * Count / Total;
+    Cost.Targets += Count;
+  }
+}
+
+std::optional<double>
+TargetCosts::averageCost(llvm::StringRef StepName,
+                         llvm::StringRef ContainerName) const {
+  auto StepIt = Costs.find(StepName);
+  if (StepIt == Costs.end())
+    return std::nullopt;
+
+  auto It = StepIt->second.find(ContainerName);
+  if (It == StepIt->second.end() or It->second.Targets == 0)
+    return std::nullopt;
+
+  return It->second.Seconds / It->second.Targets;
+}
+
+CostEstimate TargetCosts::estimate(const TargetInStepSet &Targets) const {
+  CostEstimate Result;
+  for (const auto &Step : Targets) {
+    for (const auto &Container : Step.second) {
+      uint64_t Count = Container.second.size();
+      Result.Targets += Count;
+      if (auto Cost = averageCost(Step.first(), Container.first()))
+        Result.Seconds += *Cost * Count;
+      else
+        Result.UnknownTargets += Count;
+    }
+  }
+
+  return Result;
+}
+
+llvm::Error TargetCosts::store(const revng::FilePath &Path) const {
+  auto MaybeWritableFile = Path.getWritableFile();
+  if (not MaybeWritableFile)
+    return MaybeWritableFile.takeError();
+
+  // One line for each step and container: the number of targets produced and
+  // the total time it took
+  llvm::raw_ostream &OS = MaybeWritableFile->get()->os();
+  for (const auto &Step : Costs) {
+    for (const auto &Container : Step.second) {
+      const Entry &Cost = Container.second;
+      OS << Step.first() << " " << Container.first() << " " << Cost.Targets
+         << " " << llvm::format("%.6f", Cost.Seconds) << "\n";
+    }
+  }
+
+  return MaybeWritableFile->get()->commit();
+}
+
+llvm::Error TargetCosts::load(const revng::FilePath &Path) {
+  Costs.clear();
+
+  auto MaybeExists = Path.exists();
+  if (not MaybeExists)
+    return MaybeExists.takeError();
+
+  if (not MaybeExists.get())
+    return llvm::Error::success();
+
+  auto MaybeReadableFile = Path.getReadableFile();
+  if (not MaybeReadableFile)
+    return MaybeReadableFile.takeError();
+
+  llvm::StringRef Buffer = MaybeReadableFile->get()->buffer().getBuffer();
+  llvm::SmallVector<llvm::StringRef> Lines;
+  Buffer.split(Lines, '\n', -1, false);
+  for (llvm::StringRef Line : Lines) {
+    llvm::SmallVector<llvm::StringRef, 4> Fields;
+    Line.split(Fields, ' ', -1, false);
+
+    Entry Cost;
+    if (Fields.size() != 4 or Fields[2].getAsInteger(10, Cost.Targets)
+        or Fields[3].getAsDouble(Cost.Seconds)) {
+      Costs.clear();
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Malformed target costs file");
+    }
+
+    Costs[Fields[0]][Fields[1]] = Cost;
+  }
+
+  return llvm::Error::success();
+}
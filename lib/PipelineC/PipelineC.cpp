@@ -30,6 +30,7 @@
 #include "revng/Pipes/PipelineManager.h"
 #include "revng/Support/Assert.h"
 #include "revng/Support/InitRevng.h"
+#include "revng/Support/Statistics.h"
 #include "revng/TupleTree/TupleTreeDiff.h"
 
 #include "Tracing/Wrapper.h"
@@ -98,8 +99,9 @@ static void llvmErrorToRpError(llvm::Error Error, rp_error *Out) {
                         OtherErrorHandler);
 }
 
-void revng::tracing::setTracing(llvm::raw_ostream *OS) {
-  Tracing.swap(OS);
+void revng::tracing::setTracing(llvm::raw_ostream *OS,
+                                llvm::raw_ostream *IndexOS) {
+  Tracing.swap(OS, IndexOS);
 }
 
 /// Used when we want to return a stack allocated string. Copies the string onto
@@ -363,6 +365,60 @@ static rp_buffer *_rp_manager_produce_targets(rp_manager *manager,
   return Out;
 }
 
+static bool _rp_manager_produce_targets_in_place(rp_manager *manager,
+                                                 const rp_step *step,
+                                                 const rp_container *container,
+                                                 uint64_t targets_count,
+                                                 rp_target *targets[],
+                                                 rp_error *error) {
+  revng_check(manager != nullptr);
+  revng_check(step != nullptr);
+  revng_check(container != nullptr);
+  revng_check(targets_count != 0);
+  revng_check(targets != nullptr);
+
+  TargetsList List;
+  for (size_t I = 0; I < targets_count; I++)
+    List.push_back(*targets[I]);
+
+  auto ErrorOrCloned = manager->produceTargets(step->getName(),
+                                               *container,
+                                               List);
+
+  if (!ErrorOrCloned) {
+    llvmErrorToRpError(ErrorOrCloned.takeError(), error);
+    return false;
+  }
+
+  return true;
+}
+
+static bool
+_rp_manager_produce_targets_batch(rp_manager *manager,
+                                  uint64_t steps_count,
+                                  const char *step_names[],
+                                  const rp_container_targets_map *maps[],
+                                  rp_error *error) {
+  revng_check(manager != nullptr);
+  revng_check(steps_count != 0);
+  revng_check(step_names != nullptr);
+  revng_check(maps != nullptr);
+
+  pipeline::Runner::State ToProduce;
+  for (size_t I = 0; I < steps_count; I++) {
+    revng_check(step_names[I] != nullptr);
+    revng_check(maps[I] != nullptr);
+    ToProduce[step_names[I]].merge(*maps[I]);
+  }
+
+  if (auto Error = manager->materializeTargets(ToProduce); Error) {
+    llvmErrorToRpError(std::move(Error), error);
+    return false;
+  }
+
+  return true;
+}
+
 static rp_target *_rp_target_create(const rp_kind *kind,
                                     uint64_t path_components_count,
                                     const char *path_components[]) {
@@ -427,7 +483,7 @@ static const char *_rp_target_get_path_component(rp_target *target,
   auto &PathComponents = target->getPathComponents();
   revng_check(index < PathComponents.size());
 
-  return PathComponents[index].c_str();
+  return PathComponents[index].data();
 }
 
 static rp_targets_list *
@@ -452,6 +508,14 @@ static void _rp_string_destroy(char *string) {
   free(string);
 }
 
+static char *_rp_statistics_create_json() {
+  std::string Out;
+  llvm::raw_string_ostream Serialized(Out);
+  StatisticsRegistry::get().writeJSON(Serialized);
+  Serialized.flush();
+  return copyString(Out);
+}
+
 static const rp_container_identifier *
 _rp_manager_get_container_identifier_from_name(const rp_manager *manager,
                                                const char *name) {
@@ -497,6 +561,11 @@ static const char *_rp_container_get_mime(const rp_container *container) {
   return container->getValue()->mimeType().data();
 }
 
+static uint64_t _rp_container_memory_usage(const rp_container *container) {
+  revng_check(container != nullptr);
+  return container->getValue()->memoryUsage();
+}
+
 static rp_buffer *_rp_container_extract_one(const rp_container *container,
                                             const rp_target *target) {
   revng_check(container != nullptr);
@@ -723,6 +792,74 @@ static uint64_t _rp_manager_get_context_commit_index(rp_manager *manager) {
   return manager->context().getCommitIndex();
 }
 
+static void _rp_manager_set_profiling(rp_manager *manager, bool enable) {
+  revng_check(manager != nullptr);
+  manager->setProfiling(enable);
+}
+
+static char *_rp_manager_create_profiling_trace(const rp_manager *manager) {
+  revng_check(manager != nullptr);
+  const pipeline::Profiler *Profiler = manager->getProfiler();
+  if (Profiler == nullptr)
+    return nullptr;
+
+  std::string Out;
+  llvm::raw_string_ostream Serialized(Out);
+  Profiler->emitChromeTrace(Serialized);
+  Serialized.flush();
+  return copyString(Out);
+}
+
+static char *
+_rp_manager_create_invalidation_estimate(rp_manager *manager,
+                                         const char *global_name,
+                                         const char *diff,
+                                         rp_invalidations *invalidations,
+                                         rp_error *error) {
+  revng_check(manager != nullptr);
+  revng_check(global_name != nullptr);
+  revng_check(diff != nullptr);
+
+  ExistingOrNew<rp_invalidations> Invalidations(invalidations);
+  auto MaybeEstimate = manager->estimateInvalidationsFromDiff(global_name,
+                                                              diff,
+                                                              *Invalidations);
+  if (not MaybeEstimate) {
+    llvmErrorToRpError(MaybeEstimate.takeError(), error);
+    return nullptr;
+  }
+
+  std::string Out;
+  llvm::raw_string_ostream Serialized(Out);
+  MaybeEstimate->dump(Serialized);
+  Serialized.flush();
+  return copyString(Out);
+}
+
+static void _rp_manager_request_cancellation(rp_manager *manager) {
+  revng_check(manager != nullptr);
+  manager->requestCancellation();
+}
+
+static char *_rp_manager_create_progress_json(const rp_manager *manager) {
+  revng_check(manager != nullptr);
+  std::string Out;
+  llvm::raw_string_ostream Serialized(Out);
+  manager->getProgress().dump(Serialized);
+  Serialized.flush();
+  return copyString(Out);
+}
+
+static char *_rp_manager_create_events_json(const rp_manager *manager,
+                                            uint64_t since) {
+  revng_check(manager != nullptr);
+  std::string Out;
+  llvm::raw_string_ostream Serialized(Out);
+  manager->getEvents(since).dump(Serialized);
+  Serialized.flush();
+  return copyString(Out);
+}
+
 // NOLINTEND
 
 // Import the autogenerated wrappers, these will contains calls to the
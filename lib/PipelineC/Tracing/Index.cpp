@@ -0,0 +1,238 @@
+/// \file Index.cpp
+/// Implements the index of a trace file, which maps each command to its
+/// position in the trace and to the handles it references.
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/FileSystem.h"
+
+#include "revng/PipelineC/Tracing/Common.h"
+#include "revng/PipelineC/Tracing/Trace.h"
+
+using llvm::StringRef;
+
+static constexpr StringRef CommandStart = "- ID: ";
+static constexpr StringRef NameStart = "  Name: ";
+static constexpr StringRef ArgumentStart = "  - ";
+static constexpr StringRef ResultStart = "  Result: ";
+static constexpr StringRef ResultMarker = "R";
+
+static llvm::Error indexError(const llvm::Twine &Message) {
+  return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                 "Malformed trace index: " + Message);
+}
+
+static bool isHandle(StringRef Value) {
+  return Value.startswith(PointerPrefix) and Value != NullPointer;
+}
+
+/// Record the handles in the value of an argument, which is either a single
+/// pointer or a list thereof
+static void collectHandles(revng::tracing::TraceIndex::Entry &Entry,
+                           size_t ArgNo,
+                           StringRef Value) {
+  if (isHandle(Value)) {
+    Entry.Handles.emplace_back(ArgNo, Value.str());
+    return;
+  }
+
+  if (not Value.consume_front("[") or not Value.consume_back("]"))
+    return;
+
+  llvm::SmallVector<StringRef, 4> Elements;
+  Value.split(Elements, ", ", -1, false);
+  for (StringRef Element : Elements)
+    if (isHandle(Element))
+      Entry.Handles.emplace_back(ArgNo, Element.str());
+}
+
+namespace revng::tracing {
+
+bool TraceIndex::Entry::references(StringRef Handle) const {
+  for (const auto &[ArgNo, EntryHandle] : Handles)
+    if (EntryHandle == Handle)
+      return true;
+
+  return false;
+}
+
+void TraceIndex::Entry::dump(llvm::raw_ostream &OS) const {
+  OS << ID << " " << Offset << " " << Name;
+  for (const auto &[ArgNo, Handle] : Handles) {
+    OS << " ";
+    if (ArgNo == Result)
+      OS << ResultMarker;
+    else
+      OS << ArgNo;
+    OS << "=" << Handle;
+  }
+  OS << "\n";
+}
+
+llvm::Expected<TraceIndex::Entry> TraceIndex::Entry::parse(StringRef Line) {
+  llvm::SmallVector<StringRef, 8> Fields;
+  Line.split(Fields, " ", -1, false);
+  if (Fields.size() < 3)
+    return indexError("expected at least three fields in \"" + Line + "\"");
+
+  Entry Result;
+  if (Fields[0].getAsInteger(10, Result.ID)
+      or Fields[1].getAsInteger(10, Result.Offset))
+    return indexError("invalid ID or offset in \"" + Line + "\"");
+  Result.Name = Fields[2].str();
+
+  for (StringRef Field : llvm::drop_begin(Fields, 3)) {
+    auto [ArgNoString, Handle] = Field.split("=");
+    size_t ArgNo = 0;
+    if (ArgNoString == ResultMarker)
+      ArgNo = Entry::Result;
+    else if (ArgNoString.getAsInteger(10, ArgNo))
+      return indexError("invalid handle \"" + Field + "\"");
+
+    Result.Handles.emplace_back(ArgNo, Handle.str());
+  }
+
+  return Result;
+}
+
+std::vector<size_t> TraceIndex::commandsUsing(StringRef Handle) const {
+  std::vector<size_t> Result;
+  for (size_t CommandI = 0; CommandI < Entries.size(); CommandI++)
+    if (Entries[CommandI].references(Handle))
+      Result.push_back(CommandI);
+
+  return Result;
+}
+
+llvm::Expected<Command> TraceIndex::loadCommand(StringRef TraceBuffer,
+                                                size_t CommandNo) const {
+  if (CommandNo >= Entries.size())
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "Command number OOB");
+
+  uint64_t Start = Entries[CommandNo].Offset;
+  uint64_t End = TraceBuffer.size();
+  if (CommandNo + 1 < Entries.size())
+    End = Entries[CommandNo + 1].Offset;
+
+  if (Start >= End or End > TraceBuffer.size())
+    return indexError("the index does not match the trace");
+
+  // Each command is an element of the top-level `Commands` sequence, which is
+  // not indented, hence a command alone is a valid one-element sequence
+  llvm::yaml::Input YAMLReader(TraceBuffer.slice(Start, End));
+  std::vector<Command> Commands;
+  YAMLReader >> Commands;
+  if (YAMLReader.error() or Commands.size() != 1
+      or Commands[0].Name != Entries[CommandNo].Name)
+    return indexError("cannot parse command #" + llvm::Twine(CommandNo));
+
+  Command &Result = Commands[0];
+  for (size_t ArgumentI = 0; ArgumentI < Result.Arguments.size(); ArgumentI++)
+    if (not Result.Arguments[ArgumentI].isValid())
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "Argument did not verify: Command #%u, "
+                                     "Argument #%u",
+                                     CommandNo,
+                                     ArgumentI);
+
+  return std::move(Result);
+}
+
+void TraceIndex::dump(llvm::raw_ostream &OS) const {
+  for (const Entry &TheEntry : Entries)
+    TheEntry.dump(OS);
+}
+
+llvm::Expected<TraceIndex> TraceIndex::fromBuffer(StringRef Buffer) {
+  TraceIndex Result;
+  llvm::SmallVector<StringRef, 0> Lines;
+  Buffer.split(Lines, "\n", -1, false);
+  for (StringRef Line : Lines) {
+    auto MaybeEntry = Entry::parse(Line);
+    if (not MaybeEntry)
+      return MaybeEntry.takeError();
+    Result.Entries.push_back(std::move(*MaybeEntry));
+  }
+
+  return Result;
+}
+
+llvm::Expected<TraceIndex> TraceIndex::fromFile(StringRef Path) {
+  auto MaybeBuffer = llvm::MemoryBuffer::getFile(Path);
+  if (std::error_code EC = MaybeBuffer.getError())
+    return llvm::createStringError(EC,
+                                   "Unable to read trace index: "
+                                     + EC.message());
+
+  return fromBuffer((*MaybeBuffer)->getBuffer());
+}
+
+TraceIndex TraceIndex::fromTrace(StringRef TraceBuffer) {
+  TraceIndex Result;
+  Entry *Current = nullptr;
+  size_t NextArgument = 0;
+
+  uint64_t Offset = 0;
+  while (Offset < TraceBuffer.size()) {
+    size_t LineEnd = TraceBuffer.find('\n', Offset);
+    if (LineEnd == StringRef::npos)
+      LineEnd = TraceBuffer.size();
+    StringRef Line = TraceBuffer.slice(Offset, LineEnd);
+
+    if (Line.startswith(CommandStart)) {
+      Entry &NewEntry = Result.Entries.emplace_back();
+      NewEntry.Offset = Offset;
+      Line.drop_front(CommandStart.size()).getAsInteger(10, NewEntry.ID);
+      Current = &NewEntry;
+      NextArgument = 0;
+    } else if (Current != nullptr) {
+      // Strings and buffers are escaped, hence each argument fits on a line
+      if (Line.startswith(NameStart))
+        Current->Name = Line.drop_front(NameStart.size()).str();
+      else if (Line.startswith(ArgumentStart))
+        collectHandles(*Current,
+                       NextArgument++,
+                       Line.drop_front(ArgumentStart.size()));
+      else if (Line.startswith(ResultStart))
+        collectHandles(*Current,
+                       Entry::Result,
+                       Line.drop_front(ResultStart.size()));
+    }
+
+    Offset = LineEnd + 1;
+  }
+
+  return Result;
+}
+
+llvm::Expected<TraceIndex> TraceIndex::forTrace(StringRef TracePath,
+                                                StringRef TraceBuffer) {
+  std::string IndexPath = pathFor(TracePath);
+  if (not llvm::sys::fs::exists(IndexPath))
+    return fromTrace(TraceBuffer);
+
+  auto MaybeIndex = fromFile(IndexPath);
+  if (not MaybeIndex)
+    return MaybeIndex.takeError();
+
+  // The trace might have been overwritten without its index, or the index
+  // might have been truncated by a crash: check the offsets are sensible
+  auto StartsCommand = [&TraceBuffer](const Entry &TheEntry) {
+    return TheEntry.Offset < TraceBuffer.size()
+           and TraceBuffer.drop_front(TheEntry.Offset).startswith(CommandStart);
+  };
+  const std::vector<Entry> &Entries = MaybeIndex->Entries;
+  if (Entries.empty() or not StartsCommand(Entries.front())
+      or not StartsCommand(Entries.back())
+      or TraceBuffer.find(("\n" + CommandStart).str(), Entries.back().Offset)
+           != StringRef::npos)
+    return fromTrace(TraceBuffer);
+
+  return MaybeIndex;
+}
+
+} // namespace revng::tracing
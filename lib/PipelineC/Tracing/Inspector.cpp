@@ -94,16 +94,32 @@ Trace::getBuffer(const BufferLocation &Location) const {
 
 llvm::Expected<std::vector<char>> Trace::getBuffer(size_t CommandNo,
                                                    size_t ArgNo) const {
-  if (CommandNo > this->Commands.size())
+  if (CommandNo >= this->Commands.size())
     return llvm::createStringError(llvm::inconvertibleErrorCode(),
                                    "Command number OOB");
 
-  const revng::tracing::Command &Command = this->Commands[CommandNo];
-  if (!BufferRegistry.has(Command.Name)
-      || !BufferRegistry[Command.Name].contains(ArgNo))
+  return this->Commands[CommandNo].getBuffer(ArgNo);
+}
+
+llvm::Expected<std::vector<char>> Command::getBuffer(size_t ArgNo) const {
+  if (!BufferRegistry.has(Name) || !BufferRegistry[Name].contains(ArgNo))
     return llvm::createStringError(llvm::inconvertibleErrorCode(),
                                    "No buffer information");
 
-  return extractBuffer(Command.Arguments[ArgNo]);
+  return extractBuffer(Arguments[ArgNo]);
+}
+
+std::vector<BufferLocation> TraceIndex::listBuffers() const {
+  std::vector<BufferLocation> Result;
+  for (size_t CommandI = 0; CommandI < this->Entries.size(); CommandI++) {
+    auto &Entry = this->Entries[CommandI];
+    if (BufferRegistry.has(Entry.Name)) {
+      for (size_t ArgI : BufferRegistry[Entry.Name]) {
+        Result.push_back({ Entry.Name, CommandI, ArgI });
+      }
+    }
+  }
+
+  return Result;
 }
 } // namespace revng::tracing
@@ -6,9 +6,12 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <chrono>
 #include <csignal>
+#include <map>
 
 #include "llvm/Support/Base64.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/raw_ostream.h"
@@ -445,6 +448,85 @@ argumentTransformer(RunnerContext &Context,
   return NewArguments;
 }
 
+namespace {
+
+struct CommandTiming {
+  size_t CommandIndex;
+  std::chrono::nanoseconds Duration;
+};
+
+} // namespace
+
+static double toMilliseconds(std::chrono::nanoseconds Duration) {
+  return std::chrono::duration<double, std::milli>(Duration).count();
+}
+
+/// Print the slowest commands and, for each function, how many times it has
+/// been called and how long it took
+static void printBenchmark(llvm::raw_ostream &OS,
+                           const revng::tracing::Trace &Trace,
+                           std::vector<CommandTiming> Timings) {
+  constexpr size_t SlowestCommandsCount = 10;
+
+  struct FunctionStatistics {
+    size_t Calls = 0;
+    std::chrono::nanoseconds Total{ 0 };
+    std::chrono::nanoseconds Max{ 0 };
+  };
+
+  std::chrono::nanoseconds Total{ 0 };
+  std::map<std::string, FunctionStatistics> Statistics;
+  for (const CommandTiming &Timing : Timings) {
+    const std::string &Name = Trace.Commands[Timing.CommandIndex].Name;
+    FunctionStatistics &Entry = Statistics[Name];
+    Entry.Calls++;
+    Entry.Total += Timing.Duration;
+    Entry.Max = std::max(Entry.Max, Timing.Duration);
+    Total += Timing.Duration;
+  }
+
+  OS << "Commands: " << Timings.size() << "\n";
+  OS << "Total: " << llvm::format("%.3f", toMilliseconds(Total)) << " ms\n";
+
+  llvm::sort(Timings, [](const CommandTiming &LHS, const CommandTiming &RHS) {
+    return LHS.Duration > RHS.Duration;
+  });
+
+  OS << "\nSlowest commands:\n";
+  auto Slowest = llvm::ArrayRef(Timings).take_front(SlowestCommandsCount);
+  for (const CommandTiming &Timing : Slowest) {
+    const std::string &Name = Trace.Commands[Timing.CommandIndex].Name;
+    OS << llvm::format("  #%-6zu %-48s %12.3f ms\n",
+                       Timing.CommandIndex,
+                       Name.c_str(),
+                       toMilliseconds(Timing.Duration));
+  }
+
+  using NamedStatistics = std::pair<std::string, FunctionStatistics>;
+  std::vector<NamedStatistics> Sorted(Statistics.begin(), Statistics.end());
+  auto Compare = [](const NamedStatistics &LHS, const NamedStatistics &RHS) {
+    return LHS.second.Total > RHS.second.Total;
+  };
+  llvm::sort(Sorted, Compare);
+
+  OS << "\nFunctions:\n";
+  OS << llvm::format("%-48s %8s %12s %12s %12s\n",
+                     "Name",
+                     "Calls",
+                     "Total (ms)",
+                     "Mean (ms)",
+                     "Max (ms)");
+  for (const auto &[Name, Entry] : Sorted) {
+    double TotalMs = toMilliseconds(Entry.Total);
+    OS << llvm::format("%-48s %8zu %12.3f %12.3f %12.3f\n",
+                       Name.c_str(),
+                       Entry.Calls,
+                       TotalMs,
+                       TotalMs / Entry.Calls,
+                       toMilliseconds(Entry.Max));
+  }
+}
+
 namespace revng::tracing {
 llvm::Error Trace::run(const revng::tracing::RunTraceOptions Options) const {
   using namespace revng;
@@ -460,6 +542,8 @@ llvm::Error Trace::run(const revng::tracing::RunTraceOptions Options) const {
   const size_t LastCommandI = this->Commands.size()
                               - (LastCommand.Name == "rp_shutdown" ? 1 : 0);
 
+  std::vector<CommandTiming> Timings;
+
   for (size_t CommandI = FirstCommandI; CommandI < LastCommandI; CommandI++) {
     auto &Command = this->Commands[CommandI];
     revng_check(CommandHandler.has(Command.Name),
@@ -469,9 +553,20 @@ llvm::Error Trace::run(const revng::tracing::RunTraceOptions Options) const {
     if (Options.BreakAt.contains(CommandI))
       raise(SIGTRAP);
 
+    if (Options.BenchmarkOutput == nullptr) {
+      CommandHandler[Command.Name](Context, Arguments, Command.Result);
+      continue;
+    }
+
+    auto Start = std::chrono::steady_clock::now();
     CommandHandler[Command.Name](Context, Arguments, Command.Result);
+    auto End = std::chrono::steady_clock::now();
+    Timings.push_back({ CommandI, End - Start });
   }
 
+  if (Options.BenchmarkOutput != nullptr)
+    printBenchmark(*Options.BenchmarkOutput, *this, Timings);
+
   return llvm::Error::success();
 };
 } // namespace revng::tracing
@@ -14,6 +14,7 @@
 #include "revng/ADT/ConstexprString.h"
 #include "revng/PipelineC/PipelineC.h"
 #include "revng/PipelineC/Tracing/Common.h"
+#include "revng/PipelineC/Tracing/Trace.h"
 #include "revng/Support/Assert.h"
 
 #include "Types.h"
@@ -64,25 +65,35 @@ private:
   // Integer used to compute the ID of the command
   uint64_t ID = 0;
 
+  // If present, the index of the trace is written here (see TraceIndex)
+  llvm::raw_ostream *IndexOS = nullptr;
+  revng::tracing::TraceIndex::Entry CurrentEntry;
+  size_t CurrentArgument = 0;
+  size_t NextArgument = 0;
+
 public:
-  TraceWriter(llvm::raw_ostream &OS) : OS(OS) {
-    OS.SetUnbuffered();
+  TraceWriter(llvm::raw_ostream &OS, llvm::raw_ostream *IndexOS = nullptr) :
+    OS(OS), IndexOS(IndexOS) {
     printHeader();
   }
 
 public:
   void functionPrelude(const llvm::StringRef Name) {
+    if (IndexOS != nullptr) {
+      CurrentEntry = { .ID = ID, .Offset = OS.tell(), .Name = Name.str() };
+      NextArgument = 0;
+    }
+
     OS << "- ID: " << ID++ << "\n";
     OS << "  StartTime: " << getUnixMillis() << "\n";
     OS << "  Name: " << Name << "\n";
     OS << "  Arguments:\n";
     OutputtingArguments = true;
-    OS.flush();
   }
 
   void newArgument() {
     OS << "  - ";
-    OS.flush();
+    CurrentArgument = NextArgument++;
   }
 
   // For integral types we still keep the template parameter. This is to avoid
@@ -91,14 +102,12 @@ public:
   template<IntegerType T>
   void printValue(const T &Int) {
     OS << Int << "\n";
-    OS.flush();
   }
 
   template<typename T>
     requires std::is_same_v<T, bool>
   void printValue(const T &Bool) {
     OS << (Bool ? "true" : "false") << "\n";
-    OS.flush();
   }
 
   template<typename T>
@@ -106,7 +115,6 @@ public:
   void printValue(const T *String) {
     if (OutputtingArguments) {
       OS << reprString(String) << "\n";
-      OS.flush();
     } else {
       printPointer(String);
     }
@@ -125,12 +133,11 @@ public:
     OS << PointerPrefix;
     llvm::write_hex(OS, reinterpret_cast<uintptr_t>(Ptr), PointerStyle);
     OS << "\n";
-    OS.flush();
+    recordHandle(Ptr);
   }
 
   void printBuffer(const llvm::StringRef Input) {
     OS << llvm::encodeBase64(Input) << "\n";
-    OS.flush();
   }
 
   template<IntegerType T>
@@ -144,7 +151,6 @@ public:
       }
     }
     OS << "]\n";
-    OS.flush();
   }
 
   template<typename T>
@@ -158,7 +164,6 @@ public:
       }
     }
     OS << "]\n";
-    OS.flush();
   }
 
   template<RPType T>
@@ -169,12 +174,12 @@ public:
       llvm::write_hex(OS,
                       reinterpret_cast<uintptr_t>(PtrList[I]),
                       PointerStyle);
+      recordHandle(PtrList[I]);
       if (I < Length - 1) {
         OS << ", ";
       }
     }
     OS << "]\n";
-    OS.flush();
   }
 
   template<typename... T>
@@ -189,13 +194,38 @@ public:
     }
     OS << "  EndTime: " << getUnixMillis() << "\n";
     OS.flush();
+
+    if (IndexOS != nullptr) {
+      CurrentEntry.dump(*IndexOS);
+      IndexOS->flush();
+    }
   }
 
+  /// Write out everything printed so far. The output is buffered and flushed
+  /// twice per command: once right before invoking the function, so that the
+  /// trace is complete up to the offending call in case of a crash, and once
+  /// after the return value has been printed.
+  void flush() { OS.flush(); }
+
 private:
+  template<typename T>
+  void recordHandle(const T *Ptr) {
+    if (IndexOS == nullptr or Ptr == nullptr)
+      return;
+
+    std::string Handle = PointerPrefix;
+    llvm::raw_string_ostream HandleOS(Handle);
+    llvm::write_hex(HandleOS, reinterpret_cast<uintptr_t>(Ptr), PointerStyle);
+    HandleOS.flush();
+
+    using Entry = revng::tracing::TraceIndex::Entry;
+    size_t ArgNo = OutputtingArguments ? CurrentArgument : Entry::Result;
+    CurrentEntry.Handles.emplace_back(ArgNo, std::move(Handle));
+  }
+
   void printHeader() {
     OS << "Version: 1\n";
     OS << "Commands:\n";
-    OS.flush();
   }
 
   std::string reprString(const char *String) {
@@ -214,6 +244,7 @@ class TracingRuntime {
 private:
   std::optional<TraceWriter> Writer;
   std::optional<llvm::raw_fd_ostream> OS;
+  std::optional<llvm::raw_fd_ostream> IndexOS;
 
 public:
   TracingRuntime() {
@@ -221,15 +252,25 @@ public:
       std::error_code EC;
       OS.emplace(*Path, EC);
       revng_assert(!EC);
-      Writer.emplace(*OS);
+
+      // The index is an optimization for reading the trace, tracing works
+      // without it
+      using revng::tracing::TraceIndex;
+      IndexOS.emplace(TraceIndex::pathFor(*Path), EC);
+      if (EC)
+        IndexOS.reset();
+
+      Writer.emplace(*OS, IndexOS.has_value() ? &*IndexOS : nullptr);
     }
   }
 
-  void swap(llvm::raw_ostream *NewOS = nullptr) {
+  void swap(llvm::raw_ostream *NewOS = nullptr,
+            llvm::raw_ostream *NewIndexOS = nullptr) {
     Writer.reset();
     OS.reset();
+    IndexOS.reset();
     if (NewOS != nullptr) {
-      Writer.emplace(*NewOS);
+      Writer.emplace(*NewOS, NewIndexOS);
     }
   }
 
@@ -300,6 +341,7 @@ inline decltype(auto) wrap(CalleeT Callee, ArgsT... Args) {
 
     Tracing->functionPrelude(std::string_view(Name));
     handleArguments<Name>(Args...);
+    Tracing->flush();
     if constexpr (std::is_same_v<ReturnT, void>) {
       Callee(std::forward<ArgsT>(Args)...);
       Tracing->printReturn();
@@ -34,6 +34,10 @@ bool pipeline::detail::runOnModule(llvm::Module &Module,
   auto ToIterOn = Type::getFunctionsAndCommit(*EC, Module, ContainerName);
   llvm::Task T(Analysis.getRequestedTargets().size(), "Running FunctionPass");
   for (const auto &[ModelFunction, LLVMFunction] : ToIterOn) {
+    // The results will be dropped by Step::run
+    if (EC->getContext().isCancellationRequested())
+      break;
+
     T.advance(ModelFunction->Entry().toString(), true);
     Result = Pipe.runOnFunction(*ModelFunction, *LLVMFunction) or Result;
   }
@@ -41,14 +41,18 @@ static llvm::Error applyDiffImpl(pipeline::ExecutionContext &EC,
   if (auto ApplyError = GlobalClone->applyDiff(Diff); ApplyError)
     return ApplyError;
 
-  if (not GlobalClone->verify()) {
+  // The global has already been verified, only verify what the diff touched
+  if (not GlobalClone->verifyAfterDiff(Diff)) {
     return llvm::createStringError(llvm::inconvertibleErrorCode(),
                                    "could not verify %s",
                                    DiffGlobalName.c_str());
   }
 
   if constexpr (commit) {
-    *Global = *GlobalClone;
+    // The diff applies cleanly to an identical copy: apply it again rather
+    // than copying the whole global back
+    if (auto ApplyError = Global->applyDiff(Diff); ApplyError)
+      return ApplyError;
   }
 
   return llvm::Error::success();
@@ -15,6 +15,7 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/raw_os_ostream.h"
 #include "llvm/Support/raw_ostream.h"
@@ -38,6 +39,44 @@ static cl::opt<bool> CheckComponentsVersion("check-components-version",
                                                      "don't match"),
                                             cl::init(false));
 
+static cl::opt<uint64_t> ContainersMemoryBudget("containers-memory-budget",
+                                                cl::desc("When the resident "
+                                                         "set size exceeds "
+                                                         "this amount of MiB "
+                                                         "after storing the "
+                                                         "pipeline, release "
+                                                         "the containers of "
+                                                         "all the steps but "
+                                                         "the most recently "
+                                                         "used one. 0 means "
+                                                         "no limit."),
+                                                cl::init(0));
+
+static cl::opt<bool> NoReadTracking("no-read-tracking",
+                                    cl::desc("Do not track what pipes read "
+                                             "from the globals. Any change "
+                                             "to a global will invalidate "
+                                             "all the produced targets. "
+                                             "Meant for batch runs."),
+                                    cl::init(false));
+
+/// \return the resident set size of the current process in bytes, or 0 if it
+///         cannot be determined
+static uint64_t getResidentSetSize() {
+  auto MaybeBuffer = MemoryBuffer::getFileAsStream("/proc/self/statm");
+  if (not MaybeBuffer)
+    return 0;
+
+  // The second field is the number of resident pages
+  StringRef Fields = (*MaybeBuffer)->getBuffer();
+  uint64_t ResidentPages = 0;
+  StringRef Resident = Fields.split(' ').second.split(' ').first;
+  if (Resident.getAsInteger(10, ResidentPages))
+    return 0;
+
+  return ResidentPages * sys::Process::getPageSizeEstimate();
+}
+
 class LoadModelPipePass {
 private:
   ModelWrapper Wrapper;
@@ -205,9 +244,21 @@ PipelineManager::PipelineManager(llvm::ArrayRef<std::string> EnablingFlags,
                                    &&Client) :
   StorageClient(std::move(Client)),
   ExecutionDirectory(StorageClient.get(), "") {
+  // Let containers be serialized while the previous ones are being written,
+  // store and storeStepToDisk wait for all of them by committing
+  if (StorageClient != nullptr)
+    llvm::cantFail(StorageClient->setWriteBehind(true));
+
   LLVMContext = std::make_unique<llvm::LLVMContext>();
   auto Context = setUpContext(*LLVMContext);
   PipelineContext = make_unique<pipeline::Context>(std::move(Context));
+  PipelineContext->setReadTracking(not NoReadTracking);
+
+  CancellationRequested = std::make_unique<std::atomic<bool>>(false);
+  Progress = std::make_unique<pipeline::ProductionProgress>();
+  PipelineContext->setProgress(Progress.get());
+  Events = std::make_unique<pipeline::EventLog>();
+  PipelineContext->setEventLog(Events.get());
 
   auto Loader = setupLoader(*PipelineContext, EnablingFlags);
   this->Loader = make_unique<pipeline::Loader>(std::move(Loader));
@@ -324,6 +375,23 @@ void PipelineManager::writeAllPossibleTargets(llvm::raw_ostream &OS) const {
   }
 }
 
+void PipelineManager::writeMemoryUsage(llvm::raw_ostream &OS) const {
+  uint64_t Total = 0;
+  for (const auto &Step : *Runner) {
+    OS << Step.getName() << ": " << Step.containers().memoryUsage() << "\n";
+    for (const auto &Container : Step.containers()) {
+      if (Container.second == nullptr)
+        continue;
+
+      uint64_t Usage = Container.second->memoryUsage();
+      indent(OS, 1);
+      OS << Container.first() << ": " << Usage << "\n";
+      Total += Usage;
+    }
+  }
+  OS << "Total: " << Total << "\n";
+}
+
 llvm::Error PipelineManager::store() {
   // If we are in ephemeral mode (resume was "") then we don't store anything
   if (StorageClient == nullptr)
@@ -335,7 +403,48 @@ llvm::Error PipelineManager::store() {
     return Error;
 
   // Commit all the changes to storage
-  return StorageClient->commit();
+  if (auto Error = StorageClient->commit(); Error)
+    return Error;
+
+  enforceMemoryBudget();
+  return llvm::Error::success();
+}
+
+void PipelineManager::enforceMemoryBudget() {
+  if (ContainersMemoryBudget == 0 or StorageClient == nullptr)
+    return;
+
+  uint64_t ResidentSetSize = getResidentSetSize();
+  if (ResidentSetSize <= ContainersMemoryBudget * 1024 * 1024)
+    return;
+
+  // Freed memory is not necessarily given back to the system right away, so
+  // we cannot release one step at a time until the budget is met: release
+  // everything except the step that has been used last, which is the most
+  // likely to be needed by the next request.
+  const pipeline::Step *MostRecentlyUsed = nullptr;
+  uint64_t MostRecentUse = 0;
+  for (const auto &Step : *Runner) {
+    auto It = StepsLastUse.find(Step.getName());
+    if (It != StepsLastUse.end() and It->second > MostRecentUse) {
+      MostRecentUse = It->second;
+      MostRecentlyUsed = &Step;
+    }
+  }
+
+  size_t Released = 0;
+  for (auto &Step : *Runner) {
+    if (&Step == MostRecentlyUsed)
+      continue;
+
+    auto StepDirectory = ExecutionDirectory.getDirectory(Step.getName());
+    Released += Step.containers().release(StepDirectory);
+  }
+
+  revng_log(ExplanationLogger,
+            "Resident set size is " << ResidentSetSize / (1024 * 1024)
+                                    << " MiB, released " << Released
+                                    << " containers");
 }
 
 llvm::Error PipelineManager::storeStepToDisk(llvm::StringRef StepName) {
@@ -525,32 +634,69 @@ PipelineManager::invalidateFromDiff(const llvm::StringRef Name,
   return invalidateAllPossibleTargets();
 }
 
+llvm::Expected<pipeline::CostEstimate>
+PipelineManager::estimateInvalidationsFromDiff(llvm::StringRef GlobalName,
+                                               llvm::StringRef Diff,
+                                               TargetInStepSet &Map) {
+  auto MaybeGlobal = PipelineContext->getGlobals().get(GlobalName);
+  if (not MaybeGlobal)
+    return MaybeGlobal.takeError();
+
+  auto MaybeDiff = MaybeGlobal.get()->diffFromString(Diff);
+  if (not MaybeDiff)
+    return MaybeDiff.takeError();
+
+  return getRunner().estimateInvalidations(*MaybeDiff, Map);
+}
+
 llvm::Error
 PipelineManager::materializeTargets(const llvm::StringRef StepName,
                                     const ContainerToTargetsMap &Map) {
-  if (CurrentState.count(StepName) == 0)
-    return llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                   "Step %s does not have any targets",
-                                   StepName.str().c_str());
+  pipeline::Runner::State ToProduce;
+  ToProduce.try_emplace(StepName, Map);
+  return materializeTargets(ToProduce);
+}
 
-  const auto &StepCurrentState = CurrentState[StepName];
-  for (auto ContainerName : Map.keys()) {
-    if (!StepCurrentState.contains(ContainerName))
+llvm::Error
+PipelineManager::materializeTargets(const pipeline::Runner::State &ToProduce) {
+  for (const auto &Entry : ToProduce) {
+    llvm::StringRef StepName = Entry.first();
+    const ContainerToTargetsMap &Map = Entry.second;
+    if (CurrentState.count(StepName) == 0)
       return llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                     "Container %s does not have any targets",
-                                     ContainerName.str().c_str());
+                                     "Step %s does not have any targets",
+                                     StepName.str().c_str());
 
-    auto &CurrentContainerState = StepCurrentState.at(ContainerName);
-    for (const pipeline::Target &Target : Map.at(ContainerName)) {
-      if (!CurrentContainerState.contains(Target))
+    const auto &StepCurrentState = CurrentState[StepName];
+    for (auto ContainerName : Map.keys()) {
+      if (!StepCurrentState.contains(ContainerName))
         return llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                       "Target %s cannot be produced",
-                                       Target.toString().c_str());
+                                       "Container %s does not have any "
+                                       "targets",
+                                       ContainerName.str().c_str());
+
+      auto &CurrentContainerState = StepCurrentState.at(ContainerName);
+      for (const pipeline::Target &Target : Map.at(ContainerName)) {
+        if (!CurrentContainerState.contains(Target))
+          return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                         "Target %s cannot be produced",
+                                         Target.toString().c_str());
+      }
     }
   }
 
-  if (auto Error = getRunner().run(StepName, Map); Error)
-    return Error;
+  ++UseClock;
+  for (const auto &Entry : ToProduce)
+    StepsLastUse[Entry.first()] = UseClock;
+
+  // Only the production of targets can be cancelled: stopping in the middle of
+  // a list of analyses would leave the globals partially updated
+  CancellationRequested->store(false);
+  PipelineContext->setCancellationFlag(CancellationRequested.get());
+  llvm::Error Result = getRunner().run(ToProduce);
+  PipelineContext->setCancellationFlag(nullptr);
+  if (Result)
+    return Result;
 
   return Error::success();
 }
@@ -588,6 +734,23 @@ llvm::Error PipelineManager::computeDescription() {
 
   constexpr auto DescriptionName = "pipeline-description.yml";
   revng::FilePath DescriptionPath = ExecutionDirectory.getFile(DescriptionName);
+
+  // Do not rewrite an up-to-date description: when the execution directory is
+  // remote, the write (and the subsequent commit) dominates cold starts
+  auto MaybeExists = DescriptionPath.exists();
+  if (not MaybeExists)
+    return MaybeExists.takeError();
+
+  if (MaybeExists.get()) {
+    auto MaybeReadableFile = DescriptionPath.getReadableFile();
+    if (not MaybeReadableFile)
+      return MaybeReadableFile.takeError();
+
+    llvm::StringRef Existing = MaybeReadableFile.get()->buffer().getBuffer();
+    if (Existing == this->Description)
+      return llvm::Error::success();
+  }
+
   auto MaybeWritableFile = DescriptionPath.getWritableFile();
   if (!MaybeWritableFile)
     return MaybeWritableFile.takeError();
@@ -606,3 +769,12 @@ PipelineManager::setStorageCredentials(llvm::StringRef Credentials) {
 
   return StorageClient->setCredentials(Credentials);
 }
+
+void PipelineManager::setProfiling(bool Enable) {
+  if (Enable and Profiler == nullptr)
+    Profiler = std::make_unique<pipeline::Profiler>();
+  else if (not Enable)
+    Profiler.reset();
+
+  PipelineContext->setProfiler(Profiler.get());
+}
@@ -5,28 +5,43 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <functional>
 #include <memory>
 
 #include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/CodeGen/CommandFlags.h"
 #include "llvm/CodeGen/MachineModuleInfo.h"
+#include "llvm/CodeGen/ParallelCG.h"
 #include "llvm/IR/AutoUpgrade.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/MC/TargetRegistry.h"
 #include "llvm/Option/OptTable.h"
 #include "llvm/Support/CodeGen.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_os_ostream.h"
 #include "llvm/Target/TargetMachine.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 
 #include "revng/Pipeline/AllRegistries.h"
 #include "revng/Pipeline/LLVMContainer.h"
 #include "revng/Pipeline/Target.h"
 #include "revng/Pipes/Kinds.h"
 #include "revng/Recompile/CompileModulePipe.h"
+#include "revng/Recompile/LayoutCPUState.h"
+#include "revng/Recompile/OptimizeDispatchers.h"
+#include "revng/Recompile/ProfileGuidedOptimization.h"
 #include "revng/Support/Assert.h"
 #include "revng/Support/IRAnnotators.h"
 #include "revng/Support/IRHelpers.h"
 #include "revng/Support/OriginalAssemblyAnnotationWriter.h"
+#include "revng/Support/PathList.h"
+#include "revng/Support/ProgramRunner.h"
+#include "revng/Support/ResourceFinder.h"
+#include "revng/Support/TemporaryFile.h"
 
 using namespace llvm;
 using namespace llvm::codegen;
@@ -44,6 +59,182 @@ static cl::opt<char> OptLevel("compile-opt-level",
                               cl::ZeroOrMore,
                               cl::init(' '));
 
+static cl::opt<unsigned> CompileThreads("compile-threads",
+                                        cl::desc("split the module in this "
+                                                 "many parts and compile them "
+                                                 "in parallel"),
+                                        cl::init(1));
+
+static cl::opt<bool> CompileCache("compile-cache",
+                                  cl::desc("split the module in parts and "
+                                           "cache their object files, so that "
+                                           "only the parts that changed are "
+                                           "compiled again"));
+
+static cl::opt<unsigned> CompileCacheParts("compile-cache-parts",
+                                           cl::desc("number of parts to split "
+                                                    "the module into when "
+                                                    "-compile-cache is "
+                                                    "enabled"),
+                                           cl::init(64));
+
+static Logger<> CompileCacheLog("compile-cache");
+
+using TargetMachineFactory = std::function<unique_ptr<TargetMachine>()>;
+
+/// Compile \p M as a whole in the object file \p OutputStream
+static void compileSequentially(llvm::Module &M,
+                                TargetMachine &Target,
+                                raw_pwrite_stream &OutputStream) {
+  LLVMTargetMachine &LLVMTM = static_cast<LLVMTargetMachine &>(Target);
+  auto *MMIWP = new MachineModuleInfoWrapperPass(&LLVMTM);
+
+  // Create pass manager
+  legacy::PassManager PM;
+
+  // Add an appropriate TargetLibraryInfo pass for the module's triple.
+  TargetLibraryInfoImpl TLII(Triple(M.getTargetTriple()));
+  PM.add(new TargetLibraryInfoWrapperPass(TLII));
+
+  bool Err = Target.addPassesToEmitFile(PM,
+                                        OutputStream,
+                                        nullptr,
+                                        CGFT_ObjectFile,
+                                        true,
+                                        MMIWP);
+  revng_assert(not Err);
+  revng::verify(&M);
+  PM.run(M);
+  revng::verify(&M);
+}
+
+/// Split \p M in CompileThreads parts, compile them in parallel and combine the
+/// resulting object files in a single relocatable object, \p OutputPath
+static void compileInParallel(llvm::Module &M,
+                              const TargetMachineFactory &CreateTargetMachine,
+                              llvm::StringRef OutputPath) {
+  std::vector<TemporaryFile> Parts;
+  Parts.reserve(CompileThreads);
+  std::vector<std::unique_ptr<raw_fd_ostream>> Streams;
+  SmallVector<raw_pwrite_stream *, 16> StreamPointers;
+  for (unsigned I = 0; I < CompileThreads; ++I) {
+    TemporaryFile &Part = Parts.emplace_back("revng-compile-module", "o");
+    std::error_code EC;
+    Streams.push_back(std::make_unique<raw_fd_ostream>(Part.path(), EC));
+    revng_assert(!EC);
+    StreamPointers.push_back(Streams.back().get());
+  }
+
+  // Preserve local symbols, so that the module does not change: its locals
+  // referencing each other end up in the same part
+  revng::verify(&M);
+  splitCodeGen(M,
+               StreamPointers,
+               {},
+               CreateTargetMachine,
+               CGFT_ObjectFile,
+               true);
+
+  for (std::unique_ptr<raw_fd_ostream> &Stream : Streams)
+    Stream->close();
+
+  std::vector<std::string> Arguments = { "-r", "-o", OutputPath.str() };
+  for (const TemporaryFile &Part : Parts)
+    Arguments.push_back(Part.path().str());
+
+  int ExitCode = ::Runner.run("ld.bfd", Arguments);
+  revng_check(ExitCode == 0);
+}
+
+/// Split \p M in CompileCacheParts parts, compile in parallel those that are
+/// not in the cache yet and combine all of them in a single relocatable
+/// object, \p OutputPath
+///
+/// Each part is cached by the hash of its bitcode along with \p OptionsKey,
+/// which has to describe everything else affecting code generation. The way
+/// SplitModule assigns globals to parts only depends on their names, so a
+/// change to a function only affects the part containing it.
+///
+/// \return false if the cache is not available.
+static bool compileIncrementally(llvm::Module &M,
+                                 const TargetMachineFactory &CreateTM,
+                                 llvm::StringRef OptionsKey,
+                                 llvm::StringRef OutputPath) {
+  std::string CacheDirectory = joinPath(getCacheDirectory(),
+                                        "compiled-objects");
+  if (auto EC = sys::fs::create_directories(CacheDirectory)) {
+    revng_log(CompileCacheLog, "Unable to create " << CacheDirectory);
+    return false;
+  }
+
+  struct Part {
+    std::string Path;
+    SmallString<0> Bitcode;
+  };
+  std::vector<Part> Parts;
+
+  revng::verify(&M);
+  auto RegisterPart = [&](std::unique_ptr<llvm::Module> PartModule) {
+    Part &NewPart = Parts.emplace_back();
+    raw_svector_ostream Stream(NewPart.Bitcode);
+    WriteBitcodeToFile(*PartModule, Stream);
+
+    SHA1 Hasher;
+    Hasher.update(OptionsKey);
+    Hasher.update(NewPart.Bitcode.str());
+    std::string Hash = toHex(Hasher.final(), true);
+    NewPart.Path = joinPath(CacheDirectory, Hash + ".o");
+
+    // We won't need the bitcode if it's already in the cache
+    if (sys::fs::exists(NewPart.Path))
+      NewPart.Bitcode.clear();
+  };
+  SplitModule(M, CompileCacheParts, RegisterPart, true);
+
+  unsigned Misses = 0;
+  ThreadPool Pool(hardware_concurrency(CompileThreads));
+  for (Part &ToCompile : Parts) {
+    if (ToCompile.Bitcode.empty())
+      continue;
+
+    ++Misses;
+    Pool.async([&ToCompile, &CreateTM]() {
+      // Each thread needs its own context
+      LLVMContext Context;
+      MemoryBufferRef Buffer(ToCompile.Bitcode.str(), "<split-module>");
+      auto PartModule = cantFail(parseBitcodeFile(Buffer, Context));
+
+      SmallString<0> Object;
+      raw_svector_ostream Stream(Object);
+      compileSequentially(*PartModule, *CreateTM(), Stream);
+
+      // Concurrent compilations of the same part must never observe a
+      // partially written object file
+      std::string TemporaryPath = ToCompile.Path + ".tmp-%%%%%%%%";
+      if (auto Error = writeFileAtomically(TemporaryPath,
+                                           ToCompile.Path,
+                                           Object.str())) {
+        revng_abort(("Unable to write " + ToCompile.Path + ": "
+                     + toString(std::move(Error)))
+                      .c_str());
+      }
+    });
+  }
+  Pool.wait();
+
+  revng_log(CompileCacheLog,
+            "Compiled " << Misses << " parts out of " << Parts.size());
+
+  std::vector<std::string> Arguments = { "-r", "-o", OutputPath.str() };
+  for (const Part &Compiled : Parts)
+    Arguments.push_back(Compiled.Path);
+
+  int ExitCode = ::Runner.run("ld.bfd", Arguments);
+  revng_check(ExitCode == 0);
+
+  return true;
+}
+
 static void compileModuleRunImpl(const Context &Context,
                                  LLVMContainer &Module,
                                  ObjectFileContainer &TargetBinary) {
@@ -95,14 +286,17 @@ static void compileModuleRunImpl(const Context &Context,
     return;
   }
 
-  auto Ptr = TheTarget->createTargetMachine(TheTriple.getTriple(),
-                                            "",
-                                            "",
-                                            Options,
-                                            getRelocModel(),
-                                            M->getCodeModel(),
-                                            OLvl);
-  unique_ptr<TargetMachine> Target(Ptr);
+  auto CreateTargetMachine = [&]() {
+    auto Ptr = TheTarget->createTargetMachine(TheTriple.getTriple(),
+                                              "",
+                                              "",
+                                              Options,
+                                              getRelocModel(),
+                                              M->getCodeModel(),
+                                              OLvl);
+    return unique_ptr<TargetMachine>(Ptr);
+  };
+  unique_ptr<TargetMachine> Target = CreateTargetMachine();
 
   // Add the target data from the target machine, if it exists, or the module.
   M->setDataLayout(Target->createDataLayout());
@@ -111,30 +305,34 @@ static void compileModuleRunImpl(const Context &Context,
   // to check debug info whereas verifier relies on correct datalayout.
   UpgradeDebugInfo(*M);
 
-  LLVMTargetMachine &LLVMTM = static_cast<LLVMTargetMachine &>(*Target);
-  auto *MMIWP = new MachineModuleInfoWrapperPass(&LLVMTM);
+  // The profile refers to the blocks as they are before the other changes
+  applyProfileGuidedOptimization(*M);
+  optimizeDispatchers(*M);
+  layoutCPUState(*M);
 
-  std::error_code EC;
-  raw_fd_ostream OutputStream(TargetBinary.getOrCreatePath(), EC);
-  revng_assert(!EC);
+  // Everything affecting code generation that is not part of the IR
+  std::string OptionsKey = (TheTriple.str() + ":" + Twine(OptLevel.getValue())
+                            + ":" + getComponentsHash())
+                             .str();
 
-  // Create pass manager
-  legacy::PassManager PM;
+  StringRef OutputPath = TargetBinary.getOrCreatePath();
+  bool Done = false;
+  if (CompileCache)
+    Done = compileIncrementally(*M,
+                                CreateTargetMachine,
+                                OptionsKey,
+                                OutputPath);
 
-  // Add an appropriate TargetLibraryInfo pass for the module's triple.
-  TargetLibraryInfoImpl TLII(Triple(M->getTargetTriple()));
-  PM.add(new TargetLibraryInfoWrapperPass(TLII));
-
-  bool Err = Target->addPassesToEmitFile(PM,
-                                         OutputStream,
-                                         nullptr,
-                                         CGFT_ObjectFile,
-                                         true,
-                                         MMIWP);
-  revng_assert(not Err);
-  revng::verify(M);
-  PM.run(*M);
-  revng::verify(M);
+  if (Done) {
+    // Nothing to do
+  } else if (CompileThreads > 1) {
+    compileInParallel(*M, CreateTargetMachine, OutputPath);
+  } else {
+    std::error_code EC;
+    raw_fd_ostream OutputStream(OutputPath, EC);
+    revng_assert(!EC);
+    compileSequentially(*M, *Target, OutputStream);
+  }
 
   auto Path = TargetBinary.path();
 
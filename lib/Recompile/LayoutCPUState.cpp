@@ -0,0 +1,115 @@
+/// \file LayoutCPUState.cpp
+/// Lay out the CSVs of translated binaries to improve the locality of the CPU
+/// state.
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <vector>
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include "revng/Recompile/LayoutCPUState.h"
+#include "revng/Support/Assert.h"
+#include "revng/Support/Debug.h"
+#include "revng/Support/FunctionTags.h"
+
+using namespace llvm;
+
+static cl::opt<bool> LayoutCPUState("layout-cpu-state",
+                                    cl::desc("place the CSVs of the "
+                                             "translated binary next to each "
+                                             "other, the most accessed "
+                                             "first"));
+
+static cl::opt<std::string> CPUStateProfile("cpu-state-profile",
+                                            cl::desc("file with lines in the "
+                                                     "form `<CSV> <count>`, "
+                                                     "overriding the static "
+                                                     "estimate of the "
+                                                     "accesses to each CSV "
+                                                     "used by "
+                                                     "-layout-cpu-state"),
+                                            cl::value_desc("path"));
+
+static Logger<> Log("layout-cpu-state");
+
+/// All the CSVs laid out by this pass end up in this section, in the order they
+/// have in the module
+static constexpr const char *CPUStateSection = ".data.revng.cpu_state";
+
+/// \return the number of instructions using \p V, directly or through constant
+///         expressions (e.g., casts)
+static uint64_t countAccesses(const Value *V) {
+  uint64_t Result = 0;
+  for (const User *U : V->users()) {
+    if (isa<Instruction>(U))
+      ++Result;
+    else if (isa<ConstantExpr>(U))
+      Result += countAccesses(U);
+  }
+  return Result;
+}
+
+static StringMap<uint64_t> loadProfile(StringRef Path) {
+  auto MaybeBuffer = MemoryBuffer::getFile(Path);
+  revng_check(MaybeBuffer, "Cannot read the CPU state profile");
+
+  StringMap<uint64_t> Result;
+  SmallVector<StringRef, 64> Lines;
+  MaybeBuffer.get()->getBuffer().split(Lines, '\n', -1, false);
+  for (StringRef Line : Lines) {
+    auto [Name, CountString] = Line.trim().split(' ');
+    uint64_t Count = 0;
+    if (CountString.trim().getAsInteger(10, Count)) {
+      revng_log(Log, "Ignoring invalid profile line: " << Line);
+      continue;
+    }
+    Result[Name] = Count;
+  }
+
+  return Result;
+}
+
+void layoutCPUState(Module &M) {
+  if (not LayoutCPUState)
+    return;
+
+  StringMap<uint64_t> Profile;
+  if (not CPUStateProfile.empty())
+    Profile = loadProfile(CPUStateProfile);
+
+  std::vector<std::pair<uint64_t, GlobalVariable *>> CSVs;
+  for (GlobalVariable &CSV : FunctionTags::CSV.globals(&M)) {
+    if (not CSV.hasInitializer() or CSV.hasSection())
+      continue;
+
+    auto It = Profile.find(CSV.getName());
+    uint64_t Count = It != Profile.end() ? It->second : countAccesses(&CSV);
+    CSVs.emplace_back(Count, &CSV);
+  }
+
+  // Most accessed first, by name among equally accessed ones for determinism
+  llvm::stable_sort(CSVs, [](const auto &LHS, const auto &RHS) {
+    if (LHS.first != RHS.first)
+      return LHS.first > RHS.first;
+    return LHS.second->getName() < RHS.second->getName();
+  });
+
+  // The code generator emits the globals of a section in the order they have
+  // in the module: move the CSVs, in order, to the end of the list
+  for (auto &[Count, CSV] : CSVs) {
+    revng_log(Log, CSV->getName() << ": " << Count << " accesses");
+    CSV->removeFromParent();
+    M.getGlobalList().push_back(CSV);
+    CSV->setSection(CPUStateSection);
+  }
+}
@@ -4,6 +4,7 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -13,6 +14,7 @@
 #include "llvm/Object/ELFObjectFile.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Regex.h"
@@ -81,13 +83,45 @@ defineProgramHeadersSymbols(RawBinaryView &BinaryView,
     revng_abort();
 }
 
+/// Extract the bytes of a segment from \p InputBinary into \p OutputPath,
+/// extending it with zeros up to its size in memory. This is equivalent to
+/// running dd and truncate, without spawning two processes per segment.
+static void extractSegment(const std::string &InputBinary,
+                           uint64_t StartOffset,
+                           uint64_t FileSize,
+                           uint64_t VirtualSize,
+                           const std::string &OutputPath) {
+  // Map the input rather than reading it: only the pages of this segment will
+  // actually be loaded
+  auto MaybeInput = mapBinaryFile(InputBinary);
+  revng_check(MaybeInput);
+  StringRef Input = (*MaybeInput)->getBuffer();
+
+  StringRef Data = Input.substr(StartOffset, std::min(FileSize, VirtualSize));
+
+  std::error_code EC;
+  raw_fd_ostream Output(OutputPath, EC);
+  revng_check(not EC);
+  Output << Data;
+  Output.write_zeros(VirtualSize - Data.size());
+  Output.close();
+  revng_check(not Output.has_error());
+}
+
 class Command {
 public:
   std::string CommandName;
   std::vector<std::string> Arguments;
 
+  /// Run CommandName through ProgramRunner::runRevngCommand
+  bool IsRevngCommand = false;
+
+  /// If set, perform this action in-process instead of running a program
+  std::function<void()> Action;
+
 public:
   Command(std::string CommandName) : CommandName(CommandName) {}
+  Command(std::function<void()> Action) : Action(std::move(Action)) {}
 };
 
 class CommandList {
@@ -98,7 +132,16 @@ private:
 public:
   void run() const {
     for (const Command &C : Commands) {
-      auto ExitCode = ::Runner.run(C.CommandName, C.Arguments);
+      if (C.Action) {
+        C.Action();
+        continue;
+      }
+
+      int ExitCode = 0;
+      if (C.IsRevngCommand)
+        ExitCode = ::Runner.runRevngCommand(C.CommandName, C.Arguments);
+      else
+        ExitCode = ::Runner.run(C.CommandName, C.Arguments);
       revng_check(ExitCode == 0);
     }
   }
@@ -149,7 +192,7 @@ static CommandList linkingArgs(const model::Binary &Model,
                                                        "translation",
                                                        "");
 
-  auto MaybeBuffer = llvm::MemoryBuffer::getFileOrSTDIN(InputBinary);
+  auto MaybeBuffer = mapBinaryFile(InputBinary);
   revng_assert(MaybeBuffer);
   llvm::MemoryBuffer &Buffer = **MaybeBuffer;
   RawBinaryView BinaryView(Model, Buffer.getBuffer());
@@ -198,19 +241,13 @@ static CommandList linkingArgs(const model::Binary &Model,
                                                        "translation",
                                                        "raw");
 
-    Command DD("dd");
-    DD.Arguments = { { "status=none",
-                       "bs=1",
-                       ("skip=" + Twine(Segment.StartOffset())).str(),
-                       ("if=" + InputBinary).str(),
-                       ("count=" + Twine(Segment.FileSize())).str(),
-                       ("of=" + RawSegment.path()).str() } };
-    Result.enqueueCommand(std::move(DD));
-
-    Command Truncate("truncate");
-    Truncate.Arguments = { { ("--size=" + Twine(Segment.VirtualSize())).str(),
-                             RawSegment.path().str() } };
-    Result.enqueueCommand(std::move(Truncate));
+    Result.enqueueCommand(Command([InputBinary = InputBinary.str(),
+                                   StartOffset = Segment.StartOffset(),
+                                   FileSize = Segment.FileSize(),
+                                   VirtualSize = Segment.VirtualSize(),
+                                   Path = RawSegment.path().str()]() {
+      extractSegment(InputBinary, StartOffset, FileSize, VirtualSize, Path);
+    }));
 
     Command ObjCopy("objcopy");
 
@@ -286,6 +323,7 @@ static CommandList linkingArgs(const model::Binary &Model,
 
   std::string MainExecutablePath = *revng::ResourceFinder.findFile("bin/revng");
   Command MergeDynamic(MainExecutablePath);
+  MergeDynamic.IsRevngCommand = true;
 
   // Invoke revng-merge-dynamic
   MergeDynamic.Arguments = { "merge-dynamic",
@@ -0,0 +1,625 @@
+/// \file OptimizeDispatchers.cpp
+/// Transformations speeding up indirect jumps and calls in translated binaries.
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <array>
+#include <map>
+#include <vector>
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MathExtras.h"
+
+#include "revng/Model/IRHelpers.h"
+#include "revng/Recompile/OptimizeDispatchers.h"
+#include "revng/Support/FunctionTags.h"
+#include "revng/Support/IRHelpers.h"
+
+using namespace llvm;
+
+static cl::opt<bool> PromoteDispatcherCalls("promote-dispatcher-calls",
+                                            cl::desc("call isolated functions "
+                                                     "directly where the "
+                                                     "function dispatcher "
+                                                     "can only be invoked "
+                                                     "with a few known "
+                                                     "program counters"));
+
+static cl::opt<unsigned> HashDispatcherThreshold("hash-dispatcher-threshold",
+                                                 cl::desc("lower switches "
+                                                          "with at least this "
+                                                          "many cases, such "
+                                                          "as the dispatcher, "
+                                                          "as a lookup in a "
+                                                          "hash table (0 "
+                                                          "disables)"),
+                                                 cl::init(0));
+
+
+static cl::opt<bool> InlineCaches("dispatcher-inline-caches",
+                                  cl::desc("remember, at each call to the "
+                                           "function dispatcher, the last "
+                                           "called function, and call it "
+                                           "directly if the program counter "
+                                           "did not change"));
+
+static cl::opt<bool> InlineCacheCounters("dispatcher-inline-cache-counters",
+                                         cl::desc("count the hits and misses "
+                                                  "of each inline cache. Set "
+                                                  "REVNG_INLINE_CACHE_STATS "
+                                                  "to a path when running "
+                                                  "the translated binary to "
+                                                  "dump them"));
+
+/// Lower \p Switch as a lookup in an open addressing hash table mapping each
+/// case value to the address of its successor, followed by an indirectbr
+///
+/// LLVM lowers huge sparse switches, such as the dispatcher of a large binary,
+/// as a deep tree of comparisons. The hash table makes the cost of a lookup
+/// independent from the number of cases. In front of the table, we also check
+/// the value that has been looked up last, which is the common case for
+/// indirect jumps with a single destination, such as returns.
+///
+/// \return false if \p Switch is not suitable for the transformation.
+static bool lowerAsHashTable(SwitchInst *Switch) {
+  BasicBlock *BB = Switch->getParent();
+  BasicBlock *Default = Switch->getDefaultDest();
+  Value *Condition = Switch->getCondition();
+  auto *ConditionType = cast<IntegerType>(Condition->getType());
+  if (ConditionType->getBitWidth() > 64)
+    return false;
+
+  // The lookup reaches the successors through new blocks, bail out if we'd
+  // have to fix up phis
+  SmallPtrSet<BasicBlock *, 16> Successors;
+  for (BasicBlock *Successor : successors(BB)) {
+    if (isa<PHINode>(&Successor->front()))
+      return false;
+    Successors.insert(Successor);
+  }
+
+  Module *M = BB->getModule();
+  LLVMContext &Context = M->getContext();
+  Function *F = BB->getParent();
+  auto *Int64 = Type::getInt64Ty(Context);
+  auto *Int8Ptr = Type::getInt8PtrTy(Context);
+  auto *DefaultAddress = BlockAddress::get(F, Default);
+
+  //
+  // Populate the table
+  //
+  uint64_t CasesCount = Switch->getNumCases();
+  unsigned SizeLog2 = Log2_64_Ceil(std::max<uint64_t>(2 * CasesCount, 2));
+  uint64_t Size = 1ULL << SizeLog2;
+  uint64_t Mask = Size - 1;
+  auto Hash = [SizeLog2](uint64_t Value) -> uint64_t {
+    return (Value * 0x9E3779B97F4A7C15ULL) >> (64 - SizeLog2);
+  };
+
+  std::vector<Constant *> Keys(Size, ConstantInt::get(Int64, 0));
+  std::vector<Constant *> Targets(Size, DefaultAddress);
+  for (const auto &Case : Switch->cases()) {
+    // Cases leading to the default destination can be ignored
+    if (Case.getCaseSuccessor() == Default)
+      continue;
+
+    uint64_t Key = Case.getCaseValue()->getZExtValue();
+    uint64_t Slot = Hash(Key);
+    while (Targets[Slot] != DefaultAddress)
+      Slot = (Slot + 1) & Mask;
+
+    Keys[Slot] = ConstantInt::get(Int64, Key);
+    Targets[Slot] = BlockAddress::get(F, Case.getCaseSuccessor());
+  }
+
+  std::string Prefix = (F->getName() + "_" + BB->getName() + "_").str();
+  auto CreateTable = [&](Type *ElementType,
+                         ArrayRef<Constant *> Elements,
+                         StringRef Suffix) {
+    auto *TableType = ArrayType::get(ElementType, Elements.size());
+    return new GlobalVariable(*M,
+                              TableType,
+                              true,
+                              GlobalValue::InternalLinkage,
+                              ConstantArray::get(TableType, Elements),
+                              Prefix + Suffix);
+  };
+  GlobalVariable *KeysTable = CreateTable(Int64, Keys, "keys");
+  GlobalVariable *TargetsTable = CreateTable(Int8Ptr, Targets, "targets");
+
+  // The last value looked up and its destination. Start from the first
+  // case, so that they're always consistent.
+  Constant *InitialKey = ConstantInt::get(Int64, 0);
+  Constant *InitialTarget = DefaultAddress;
+  if (CasesCount != 0) {
+    auto FirstCase = *Switch->case_begin();
+    InitialKey = ConstantInt::get(Int64,
+                                  FirstCase.getCaseValue()->getZExtValue());
+    InitialTarget = BlockAddress::get(F, FirstCase.getCaseSuccessor());
+  }
+
+  auto CreateCache = [&](Constant *Initializer, StringRef Suffix) {
+    return new GlobalVariable(*M,
+                              Initializer->getType(),
+                              false,
+                              GlobalValue::InternalLinkage,
+                              Initializer,
+                              Prefix + Suffix);
+  };
+  GlobalVariable *LastKey = CreateCache(InitialKey, "last_key");
+  GlobalVariable *LastTarget = CreateCache(InitialTarget, "last_target");
+
+  //
+  // Emit the lookup
+  //
+  auto *CacheHit = BasicBlock::Create(Context, Prefix + "cache_hit", F);
+  auto *Lookup = BasicBlock::Create(Context, Prefix + "lookup", F);
+  auto *Probe = BasicBlock::Create(Context, Prefix + "probe", F);
+  auto *Found = BasicBlock::Create(Context, Prefix + "found", F);
+  auto *Next = BasicBlock::Create(Context, Prefix + "next", F);
+
+  auto CreateIndirectBranch = [&Successors, Default](IRBuilder<> &Builder,
+                                                     Value *Address) {
+    auto *Branch = Builder.CreateIndirectBr(Address, Successors.size() + 1);
+    Branch->addDestination(Default);
+    for (BasicBlock *Successor : Successors)
+      if (Successor != Default)
+        Branch->addDestination(Successor);
+  };
+
+  IRBuilder<> Builder(Switch);
+  Value *Key = Builder.CreateZExt(Condition, Int64);
+  Value *IsLast = Builder.CreateICmpEQ(Key,
+                                       Builder.CreateLoad(Int64, LastKey));
+  Builder.CreateCondBr(IsLast, CacheHit, Lookup);
+  Switch->eraseFromParent();
+
+  Builder.SetInsertPoint(CacheHit);
+  CreateIndirectBranch(Builder, Builder.CreateLoad(Int8Ptr, LastTarget));
+
+  Builder.SetInsertPoint(Lookup);
+  auto *HashMultiplier = ConstantInt::get(Int64, 0x9E3779B97F4A7C15ULL);
+  Value *FirstSlot = Builder.CreateLShr(Builder.CreateMul(Key, HashMultiplier),
+                                        64 - SizeLog2);
+  Builder.CreateBr(Probe);
+
+  Builder.SetInsertPoint(Probe);
+  PHINode *Slot = Builder.CreatePHI(Int64, 2);
+  Slot->addIncoming(FirstSlot, Lookup);
+  auto *Zero = ConstantInt::get(Int64, 0);
+  Value *KeyAddress = Builder.CreateInBoundsGEP(KeysTable->getValueType(),
+                                                KeysTable,
+                                                { Zero, Slot });
+  Type *TargetsType = TargetsTable->getValueType();
+  Value *TargetAddress = Builder.CreateInBoundsGEP(TargetsType,
+                                                   TargetsTable,
+                                                   { Zero, Slot });
+  Value *SlotKey = Builder.CreateLoad(Int64, KeyAddress);
+  Value *SlotTarget = Builder.CreateLoad(Int8Ptr, TargetAddress);
+  Builder.CreateCondBr(Builder.CreateICmpEQ(SlotKey, Key), Found, Next);
+
+  // Note: an empty slot matching the key leads to the default destination
+  Builder.SetInsertPoint(Found);
+  Builder.CreateStore(Key, LastKey);
+  Builder.CreateStore(SlotTarget, LastTarget);
+  CreateIndirectBranch(Builder, SlotTarget);
+
+  // An empty slot terminates the probing
+  Builder.SetInsertPoint(Next);
+  Value *IsEmpty = Builder.CreateICmpEQ(SlotTarget, DefaultAddress);
+  Value *Incremented = Builder.CreateAdd(Slot, ConstantInt::get(Int64, 1));
+  Value *NextSlot = Builder.CreateAnd(Incremented, Mask);
+  Slot->addIncoming(NextSlot, Next);
+  Builder.CreateCondBr(IsEmpty, Default, Probe);
+
+  return true;
+}
+
+static void lowerLargeSwitchesAsHashTables(llvm::Module &M) {
+  if (HashDispatcherThreshold == 0)
+    return;
+
+  std::vector<SwitchInst *> ToLower;
+  for (Function &F : M)
+    for (BasicBlock &BB : F)
+      if (auto *Switch = dyn_cast<SwitchInst>(BB.getTerminator()))
+        if (Switch->getNumCases() >= HashDispatcherThreshold)
+          ToLower.push_back(Switch);
+
+  for (SwitchInst *Switch : ToLower)
+    lowerAsHashTable(Switch);
+}
+
+/// Maximum number of direct calls emitted in front of a call to the dispatcher
+static constexpr unsigned MaxSpeculatedTargets = 4;
+
+/// Collect in \p Result the constants \p V can evaluate to
+///
+/// \return false if \p V can take non-constant values or too many values.
+static bool collectSpeculatedAddresses(Value *V,
+                                       SmallVectorImpl<uint64_t> &Result) {
+  SmallVector<Value *, MaxSpeculatedTargets> Values;
+  if (auto *Select = dyn_cast<SelectInst>(V)) {
+    Values = { Select->getTrueValue(), Select->getFalseValue() };
+  } else if (auto *Phi = dyn_cast<PHINode>(V)) {
+    for (Value *Incoming : Phi->incoming_values())
+      Values.push_back(Incoming);
+  } else {
+    Values = { V };
+  }
+
+  for (Value *Candidate : Values) {
+    auto *Address = dyn_cast<ConstantInt>(Candidate);
+    if (Address == nullptr or Address->getBitWidth() > 64)
+      return false;
+
+    if (not is_contained(Result, Address->getZExtValue()))
+      Result.push_back(Address->getZExtValue());
+  }
+
+  return Result.size() <= MaxSpeculatedTargets;
+}
+
+/// \return the last value stored in \p CSV before \p Call, in the same basic
+///         block, if nothing else can have written it in between
+static Value *getStoredValue(CallInst *Call, GlobalVariable *CSV) {
+  for (Instruction &I :
+       reverse(make_range(Call->getParent()->begin(), Call->getIterator()))) {
+    if (auto *Store = dyn_cast<StoreInst>(&I)) {
+      Value *Pointer = Store->getPointerOperand();
+      if (Pointer == CSV)
+        return Store->getValueOperand();
+      else if (isa<GlobalVariable>(Pointer))
+        continue;
+    }
+
+    if (I.mayWriteToMemory())
+      return nullptr;
+  }
+
+  return nullptr;
+}
+
+/// Guard the calls to the function dispatcher where the program counter is
+/// one of a few known values with direct calls to the corresponding isolated
+/// functions
+///
+/// Each direct call is guarded by a comparison of all the components of the
+/// program counter, the dispatcher is still invoked on mismatch.
+static void promoteDispatcherCalls(llvm::Module &M,
+                                   ArrayRef<GlobalVariable *> PCCSVs,
+                                   ArrayRef<CallInst *> DispatcherCalls) {
+  std::multimap<uint64_t, std::pair<MetaAddress, Function *>> Isolated;
+  for (Function &F : FunctionTags::Isolated.functions(&M)) {
+    MetaAddress Entry = getMetaAddressOfIsolatedFunction(F);
+    Isolated.insert({ Entry.address(), { Entry, &F } });
+  }
+
+  for (CallInst *Call : DispatcherCalls) {
+    Value *StoredAddress = getStoredValue(Call, PCCSVs[3]);
+    if (StoredAddress == nullptr)
+      continue;
+
+    SmallVector<uint64_t, MaxSpeculatedTargets> Addresses;
+    if (not collectSpeculatedAddresses(StoredAddress, Addresses))
+      continue;
+
+    SmallVector<std::pair<MetaAddress, Function *>, MaxSpeculatedTargets>
+      Targets;
+    for (uint64_t Address : Addresses)
+      for (const auto &[_, Target] : make_range(Isolated.equal_range(Address)))
+        if (Target.second->getFunctionType() == Call->getFunctionType())
+          Targets.push_back(Target);
+
+    if (Targets.empty() or Targets.size() > MaxSpeculatedTargets)
+      continue;
+
+    // Isolate the call to the dispatcher in its own block, the fallback
+    BasicBlock *Guards = Call->getParent();
+    BasicBlock *Fallback = Guards->splitBasicBlock(Call, "dispatcher_call");
+    BasicBlock *Continue = Fallback->splitBasicBlock(Call->getNextNode());
+    Guards->getTerminator()->eraseFromParent();
+
+    IRBuilder<> Builder(Guards);
+    Builder.SetCurrentDebugLocation(Call->getDebugLoc());
+    std::array<Value *, 4> Components;
+    for (unsigned I = 0; I < PCCSVs.size(); ++I)
+      Components[I] = createLoad(Builder, PCCSVs[I]);
+
+    LLVMContext &Context = M.getContext();
+    Function *Caller = Guards->getParent();
+    for (const auto &[Entry, Target] : Targets) {
+      uint64_t Expected[] = {
+        Entry.epoch(), Entry.addressSpace(), Entry.type(), Entry.address()
+      };
+
+      Value *Match = Builder.getTrue();
+      for (unsigned I = 0; I < PCCSVs.size(); ++I) {
+        auto *ExpectedValue = ConstantInt::get(Components[I]->getType(),
+                                               Expected[I]);
+        Match = Builder.CreateAnd(Match,
+                                  Builder.CreateICmpEQ(Components[I],
+                                                       ExpectedValue));
+      }
+
+      auto *Direct = BasicBlock::Create(Context, "direct_call", Caller);
+      auto *NextGuard = BasicBlock::Create(Context, "next_guard", Caller);
+      Builder.CreateCondBr(Match, Direct, NextGuard);
+
+      Builder.SetInsertPoint(Direct);
+      auto *DirectCall = Builder.CreateCall(Target);
+      DirectCall->setAttributes(Call->getAttributes());
+      DirectCall->setDebugLoc(Call->getDebugLoc());
+      Builder.CreateBr(Continue);
+
+      Builder.SetInsertPoint(NextGuard);
+    }
+
+    Builder.CreateBr(Fallback);
+  }
+}
+
+/// Create a function mapping the components of a program counter to the
+/// isolated function of type \p CalleeType starting there, or null
+static Function *createIsolatedFunctionLookup(Module &M,
+                                              ArrayRef<GlobalVariable *> PCCSVs,
+                                              FunctionType *CalleeType) {
+  LLVMContext &Context = M.getContext();
+  auto *Int8Ptr = Type::getInt8PtrTy(Context);
+
+  SmallVector<Type *, 4> ComponentTypes;
+  for (GlobalVariable *CSV : PCCSVs)
+    ComponentTypes.push_back(CSV->getValueType());
+
+  auto *LookupType = FunctionType::get(Int8Ptr, ComponentTypes, false);
+  auto *Lookup = Function::Create(LookupType,
+                                  GlobalValue::InternalLinkage,
+                                  "lookup_isolated_function",
+                                  M);
+  auto *Entry = BasicBlock::Create(Context, "", Lookup);
+  auto *NotFound = BasicBlock::Create(Context, "not_found", Lookup);
+  ReturnInst::Create(Context, ConstantPointerNull::get(Int8Ptr), NotFound);
+
+  // Group the functions by address, usually there's only one
+  std::map<uint64_t, SmallVector<std::pair<MetaAddress, Function *>, 1>>
+    ByAddress;
+  for (Function &F : FunctionTags::Isolated.functions(&M)) {
+    if (F.getFunctionType() != CalleeType)
+      continue;
+
+    MetaAddress FunctionEntry = getMetaAddressOfIsolatedFunction(F);
+    ByAddress[FunctionEntry.address()].push_back({ FunctionEntry, &F });
+  }
+
+  Argument *Address = Lookup->getArg(3);
+  IRBuilder<> Builder(Entry);
+  SwitchInst *Switch = Builder.CreateSwitch(Address, NotFound);
+  for (const auto &[AddressValue, Functions] : ByAddress) {
+    auto *Case = BasicBlock::Create(Context, "", Lookup);
+    Switch->addCase(ConstantInt::get(cast<IntegerType>(Address->getType()),
+                                     AddressValue),
+                    Case);
+
+    Builder.SetInsertPoint(Case);
+    for (const auto &[FunctionEntry, F] : Functions) {
+      uint64_t Expected[] = { FunctionEntry.epoch(),
+                              FunctionEntry.addressSpace(),
+                              FunctionEntry.type() };
+      Value *Match = Builder.getTrue();
+      for (unsigned I = 0; I < std::size(Expected); ++I) {
+        Argument *Component = Lookup->getArg(I);
+        auto *ExpectedValue = ConstantInt::get(Component->getType(),
+                                               Expected[I]);
+        Match = Builder.CreateAnd(Match,
+                                  Builder.CreateICmpEQ(Component,
+                                                       ExpectedValue));
+      }
+
+      auto *Found = BasicBlock::Create(Context, "", Lookup);
+      auto *Next = BasicBlock::Create(Context, "", Lookup);
+      Builder.CreateCondBr(Match, Found, Next);
+
+      Builder.SetInsertPoint(Found);
+      Builder.CreateRet(Builder.CreateBitCast(F, Int8Ptr));
+
+      Builder.SetInsertPoint(Next);
+    }
+    Builder.CreateBr(NotFound);
+  }
+
+  return Lookup;
+}
+
+/// Put in front of each call to the function dispatcher a cache of the last
+/// program counter it has been invoked with, along with the corresponding
+/// isolated function
+///
+/// On a miss, the isolated function is looked up and the cache is updated. If
+/// the program counter is not the entry of an isolated function, the
+/// dispatcher is invoked as before.
+static void addInlineCaches(llvm::Module &M,
+                            ArrayRef<GlobalVariable *> PCCSVs,
+                            ArrayRef<CallInst *> DispatcherCalls) {
+  LLVMContext &Context = M.getContext();
+  auto *Int64 = Type::getInt64Ty(Context);
+  auto *Int8Ptr = Type::getInt8PtrTy(Context);
+
+  FunctionType *CalleeType = DispatcherCalls.front()->getFunctionType();
+  Function *Lookup = createIsolatedFunctionLookup(M, PCCSVs, CalleeType);
+
+  // Counters of each cache: the caller entry, hits, misses and the last target
+  auto *CountersType = StructType::get(Context,
+                                       { Int64, Int64, Int64, Int64 });
+  GlobalVariable *Counters = nullptr;
+  if (InlineCacheCounters) {
+    std::vector<Constant *> Initializers;
+    for (CallInst *Call : DispatcherCalls) {
+      Function *Caller = Call->getFunction();
+      uint64_t CallerEntry = 0;
+      if (FunctionTags::Isolated.isTagOf(Caller))
+        CallerEntry = getMetaAddressOfIsolatedFunction(*Caller).address();
+
+      auto *Zero = ConstantInt::get(Int64, 0);
+      auto *Entry = ConstantInt::get(Int64, CallerEntry);
+      Initializers.push_back(ConstantStruct::get(CountersType,
+                                                 { Entry, Zero, Zero, Zero }));
+    }
+
+    auto *TableType = ArrayType::get(CountersType, Initializers.size());
+    Counters = new GlobalVariable(M,
+                                  TableType,
+                                  false,
+                                  GlobalValue::ExternalLinkage,
+                                  ConstantArray::get(TableType, Initializers),
+                                  "revng_inline_cache_counters");
+    new GlobalVariable(M,
+                       Int64,
+                       true,
+                       GlobalValue::ExternalLinkage,
+                       ConstantInt::get(Int64, Initializers.size()),
+                       "revng_inline_cache_counters_count");
+  }
+
+  auto GetCounter = [&](IRBuilder<> &Builder, unsigned Site, unsigned Index) {
+    Type *TableType = Counters->getValueType();
+    Value *Counter = Builder.CreateConstInBoundsGEP2_32(TableType,
+                                                        Counters,
+                                                        0,
+                                                        Site);
+    return Builder.CreateStructGEP(CountersType, Counter, Index);
+  };
+
+  auto Increment = [&](IRBuilder<> &Builder, unsigned Site, unsigned Index) {
+    Value *Field = GetCounter(Builder, Site, Index);
+    Value *Incremented = Builder.CreateAdd(Builder.CreateLoad(Int64, Field),
+                                           ConstantInt::get(Int64, 1));
+    Builder.CreateStore(Incremented, Field);
+  };
+
+  for (unsigned Site = 0; Site < DispatcherCalls.size(); ++Site) {
+    CallInst *Call = DispatcherCalls[Site];
+    Function *Caller = Call->getFunction();
+
+    // The cache: the components of the program counter and the function
+    SmallVector<GlobalVariable *, 4> CachedKeys;
+    for (GlobalVariable *CSV : PCCSVs) {
+      // All ones never matches a valid epoch
+      auto *Initializer = Constant::getAllOnesValue(CSV->getValueType());
+      CachedKeys.push_back(new GlobalVariable(M,
+                                              CSV->getValueType(),
+                                              false,
+                                              GlobalValue::InternalLinkage,
+                                              Initializer,
+                                              "inline_cache_key"));
+    }
+    auto *CachedTarget = new GlobalVariable(M,
+                                            Int8Ptr,
+                                            false,
+                                            GlobalValue::InternalLinkage,
+                                            ConstantPointerNull::get(Int8Ptr),
+                                            "inline_cache_target");
+
+    // Isolate the call to the dispatcher in its own block, the fallback
+    BasicBlock *Head = Call->getParent();
+    BasicBlock *Fallback = Head->splitBasicBlock(Call, "ic_fallback");
+    BasicBlock *Continue = Fallback->splitBasicBlock(Call->getNextNode(),
+                                                     "ic_continue");
+    Head->getTerminator()->eraseFromParent();
+
+    auto *Hit = BasicBlock::Create(Context, "ic_hit", Caller);
+    auto *Miss = BasicBlock::Create(Context, "ic_miss", Caller);
+    auto *Fill = BasicBlock::Create(Context, "ic_fill", Caller);
+    auto *CallCached = BasicBlock::Create(Context, "ic_call", Caller);
+
+    IRBuilder<> Builder(Head);
+    Builder.SetCurrentDebugLocation(Call->getDebugLoc());
+    SmallVector<Value *, 4> Components;
+    Value *Match = Builder.getTrue();
+    for (auto [CSV, CachedKey] : llvm::zip(PCCSVs, CachedKeys)) {
+      Value *Component = createLoad(Builder, CSV);
+      Components.push_back(Component);
+      Value *Cached = Builder.CreateLoad(CSV->getValueType(), CachedKey);
+      Match = Builder.CreateAnd(Match, Builder.CreateICmpEQ(Component, Cached));
+    }
+    Value *Target = Builder.CreateLoad(Int8Ptr, CachedTarget);
+    Builder.CreateCondBr(Match, Hit, Miss);
+
+    Builder.SetInsertPoint(Hit);
+    if (Counters != nullptr)
+      Increment(Builder, Site, 1);
+    Builder.CreateBr(CallCached);
+
+    Builder.SetInsertPoint(Miss);
+    Value *Found = Builder.CreateCall(Lookup, Components);
+    if (Counters != nullptr)
+      Increment(Builder, Site, 2);
+    Builder.CreateCondBr(Builder.CreateIsNull(Found), Fallback, Fill);
+
+    Builder.SetInsertPoint(Fill);
+    for (auto [Component, CachedKey] : llvm::zip(Components, CachedKeys))
+      Builder.CreateStore(Component, CachedKey);
+    Builder.CreateStore(Found, CachedTarget);
+    if (Counters != nullptr) {
+      Value *LastTarget = GetCounter(Builder, Site, 3);
+      Builder.CreateStore(Builder.CreateZExtOrTrunc(Components[3], Int64),
+                          LastTarget);
+    }
+    Builder.CreateBr(CallCached);
+
+    Builder.SetInsertPoint(CallCached);
+    PHINode *Callee = Builder.CreatePHI(Int8Ptr, 2);
+    Callee->addIncoming(Target, Hit);
+    Callee->addIncoming(Found, Fill);
+    Value *CalleePointer = Builder.CreateBitCast(Callee,
+                                                 CalleeType->getPointerTo());
+    CallInst *CachedCall = Builder.CreateCall(CalleeType, CalleePointer);
+    CachedCall->setAttributes(Call->getAttributes());
+    CachedCall->setDebugLoc(Call->getDebugLoc());
+    Builder.CreateBr(Continue);
+  }
+}
+
+/// \return the calls to the function dispatcher in \p M
+static std::vector<CallInst *> getDispatcherCalls(llvm::Module &M) {
+  std::vector<CallInst *> Result;
+  for (Function &Dispatcher : FunctionTags::FunctionDispatcher.functions(&M))
+    for (CallBase *Caller : callers(&Dispatcher))
+      if (auto *Call = dyn_cast<CallInst>(Caller))
+        Result.push_back(Call);
+  return Result;
+}
+
+void optimizeDispatchers(llvm::Module &M) {
+  // The CSVs the dispatcher switches on
+  std::array<GlobalVariable *, 4> PCCSVs = {
+    M.getGlobalVariable("pc_epoch", true),
+    M.getGlobalVariable("pc_address_space", true),
+    M.getGlobalVariable("pc_type", true),
+    M.getGlobalVariable("pc", true)
+  };
+
+  if (not is_contained(PCCSVs, nullptr)) {
+    if (PromoteDispatcherCalls) {
+      std::vector<CallInst *> DispatcherCalls = getDispatcherCalls(M);
+      if (not DispatcherCalls.empty())
+        promoteDispatcherCalls(M, PCCSVs, DispatcherCalls);
+    }
+
+    // Note: this includes the calls to the dispatcher left on mismatch by
+    //       promoteDispatcherCalls
+    if (InlineCaches) {
+      std::vector<CallInst *> DispatcherCalls = getDispatcherCalls(M);
+      if (not DispatcherCalls.empty())
+        addInlineCaches(M, PCCSVs, DispatcherCalls);
+    }
+  }
+
+  lowerLargeSwitchesAsHashTables(M);
+}
@@ -0,0 +1,220 @@
+/// \file ProfileGuidedOptimization.cpp
+/// Collect and use basic block counts of translated binaries.
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/MDBuilder.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include "revng/Recompile/ProfileGuidedOptimization.h"
+#include "revng/Support/Assert.h"
+#include "revng/Support/Debug.h"
+#include "revng/Support/FunctionTags.h"
+
+using namespace llvm;
+
+static cl::opt<bool> ProfileInstrument("profile-instrument",
+                                       cl::desc("count how many times each "
+                                                "basic block of the "
+                                                "translated code runs. Set "
+                                                "REVNG_PROFILE to a path when "
+                                                "running the translated "
+                                                "binary to dump the counts "
+                                                "for -profile-use"));
+
+static cl::opt<std::string> ProfileUse("profile-use",
+                                       cl::desc("optimize the translated "
+                                                "code using the counts "
+                                                "dumped by a binary built "
+                                                "with -profile-instrument"),
+                                       cl::value_desc("path"));
+
+static Logger<> Log("profile-guided-optimization");
+
+/// Functions whose blocks account for this fraction of all the executed blocks
+/// are considered hot
+static constexpr double HotFraction = 0.99;
+
+static bool isTranslatedCode(const Function &F) {
+  if (F.isDeclaration())
+    return false;
+
+  return FunctionTags::Isolated.isTagOf(&F) or FunctionTags::Root.isTagOf(&F)
+         or FunctionTags::FunctionDispatcher.isTagOf(&F);
+}
+
+/// \return the blocks with a counter, in the order of their counters
+static std::vector<BasicBlock *> countedBlocks(Module &M) {
+  std::vector<BasicBlock *> Result;
+  for (Function &F : M)
+    if (isTranslatedCode(F))
+      for (BasicBlock &BB : F)
+        Result.push_back(&BB);
+  return Result;
+}
+
+static void instrument(Module &M) {
+  std::vector<BasicBlock *> Blocks = countedBlocks(M);
+  if (Blocks.empty())
+    return;
+
+  auto *Int64 = Type::getInt64Ty(M.getContext());
+  auto *TableType = ArrayType::get(Int64, Blocks.size());
+  auto *Counters = new GlobalVariable(M,
+                                      TableType,
+                                      false,
+                                      GlobalValue::ExternalLinkage,
+                                      Constant::getNullValue(TableType),
+                                      "revng_profile_counters");
+  new GlobalVariable(M,
+                     Int64,
+                     true,
+                     GlobalValue::ExternalLinkage,
+                     ConstantInt::get(Int64, Blocks.size()),
+                     "revng_profile_counters_count");
+
+  for (size_t Index = 0; Index < Blocks.size(); ++Index) {
+    IRBuilder<> Builder(&*Blocks[Index]->getFirstInsertionPt());
+    Value *Counter = Builder.CreateConstInBoundsGEP2_64(TableType,
+                                                        Counters,
+                                                        0,
+                                                        Index);
+    Value *Incremented = Builder.CreateAdd(Builder.CreateLoad(Int64, Counter),
+                                           ConstantInt::get(Int64, 1));
+    Builder.CreateStore(Incremented, Counter);
+  }
+}
+
+/// \return the counts in \p Path, one per line
+static std::optional<std::vector<uint64_t>> loadCounts(StringRef Path) {
+  auto MaybeBuffer = MemoryBuffer::getFile(Path);
+  if (not MaybeBuffer)
+    return std::nullopt;
+
+  std::vector<uint64_t> Result;
+  SmallVector<StringRef, 0> Lines;
+  MaybeBuffer.get()->getBuffer().split(Lines, '\n', -1, false);
+  for (StringRef Line : Lines) {
+    uint64_t Count = 0;
+    if (Line.trim().getAsInteger(10, Count))
+      return std::nullopt;
+    Result.push_back(Count);
+  }
+
+  return Result;
+}
+
+/// Attach to each branch with multiple successors the weight of each edge,
+/// when it's known, i.e., when the successors can only be reached from it
+static void setBranchWeights(Module &M,
+                             const DenseMap<BasicBlock *, uint64_t> &Counts) {
+  MDBuilder Builder(M.getContext());
+  constexpr uint64_t MaxWeight = std::numeric_limits<uint32_t>::max();
+
+  for (auto &[BB, Count] : Counts) {
+    Instruction *Terminator = BB->getTerminator();
+    if (Terminator->getNumSuccessors() < 2)
+      continue;
+
+    SmallVector<uint64_t, 2> EdgeCounts;
+    for (BasicBlock *Successor : successors(Terminator)) {
+      if (Successor->getSinglePredecessor() != BB)
+        break;
+      EdgeCounts.push_back(Counts.lookup(Successor));
+    }
+
+    if (EdgeCounts.size() != Terminator->getNumSuccessors())
+      continue;
+
+    // Scale the counts so that they fit the 32-bit weights
+    uint64_t Max = *std::max_element(EdgeCounts.begin(), EdgeCounts.end());
+    uint64_t Scale = Max / MaxWeight + 1;
+    SmallVector<uint32_t, 2> Weights;
+    for (uint64_t EdgeCount : EdgeCounts)
+      Weights.push_back(EdgeCount / Scale);
+
+    Terminator->setMetadata(LLVMContext::MD_prof,
+                            Builder.createBranchWeights(Weights));
+  }
+}
+
+/// Set the entry count of each function and put the hot and never executed
+/// ones in their own sections, so that the hot code is packed together
+static void setFunctionHotness(Module &M,
+                               const DenseMap<BasicBlock *, uint64_t> &Counts) {
+  std::vector<std::pair<uint64_t, Function *>> Totals;
+  uint64_t Total = 0;
+  for (Function &F : M) {
+    if (not isTranslatedCode(F))
+      continue;
+
+    uint64_t FunctionTotal = 0;
+    for (BasicBlock &BB : F)
+      FunctionTotal += Counts.lookup(&BB);
+    Total += FunctionTotal;
+    Totals.emplace_back(FunctionTotal, &F);
+
+    uint64_t EntryCount = Counts.lookup(&F.getEntryBlock());
+    F.setEntryCount(Function::ProfileCount(EntryCount, Function::PCT_Real));
+    if (FunctionTotal == 0) {
+      F.addFnAttr(Attribute::Cold);
+      F.setSectionPrefix("unlikely");
+    }
+  }
+
+  llvm::stable_sort(Totals, [](const auto &LHS, const auto &RHS) {
+    return LHS.first > RHS.first;
+  });
+
+  uint64_t Accumulated = 0;
+  for (auto &[FunctionTotal, F] : Totals) {
+    if (FunctionTotal == 0 or Accumulated >= Total * HotFraction)
+      break;
+    Accumulated += FunctionTotal;
+    F->setSectionPrefix("hot");
+  }
+}
+
+static void useProfile(Module &M, StringRef Path) {
+  auto MaybeCounts = loadCounts(Path);
+  revng_check(MaybeCounts.has_value(), "Cannot read the profile");
+
+  std::vector<BasicBlock *> Blocks = countedBlocks(M);
+  if (MaybeCounts->size() != Blocks.size()) {
+    dbg << "Warning: the profile has been collected on a different module, "
+           "ignoring it\n";
+    return;
+  }
+
+  DenseMap<BasicBlock *, uint64_t> Counts;
+  for (size_t Index = 0; Index < Blocks.size(); ++Index)
+    Counts[Blocks[Index]] = (*MaybeCounts)[Index];
+  revng_log(Log, "Loaded the counts of " << Blocks.size() << " blocks");
+
+  setBranchWeights(M, Counts);
+  setFunctionHotness(M, Counts);
+}
+
+void applyProfileGuidedOptimization(Module &M) {
+  revng_check(not(ProfileInstrument and not ProfileUse.empty()),
+              "-profile-instrument and -profile-use are incompatible");
+
+  if (ProfileInstrument)
+    instrument(M);
+  else if (not ProfileUse.empty())
+    useProfile(M, ProfileUse);
+}
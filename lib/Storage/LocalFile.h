@@ -4,6 +4,8 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include "llvm/ADT/FunctionExtras.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Error.h"
 
 #include "revng/Storage/ReadableFile.h"
@@ -35,4 +37,24 @@ public:
   llvm::Error commit() override { return llvm::Error::success(); }
 };
 
+/// WritableFile used in write-behind mode: the content is kept in memory and
+/// written to \p Path in background upon commit
+class LocalBufferedWritableFile : public WritableFile {
+public:
+  using Writer = llvm::unique_function<llvm::Error(llvm::SmallVector<char, 0>
+                                                     &&)>;
+
+private:
+  llvm::SmallVector<char, 0> Buffer;
+  llvm::raw_svector_ostream OS;
+  Writer Write;
+
+public:
+  LocalBufferedWritableFile(Writer &&Write) :
+    Buffer(), OS(Buffer), Write(std::move(Write)) {}
+  ~LocalBufferedWritableFile() override = default;
+  llvm::raw_pwrite_stream &os() override { return OS; }
+  llvm::Error commit() override { return Write(std::move(Buffer)); }
+};
+
 } // namespace revng
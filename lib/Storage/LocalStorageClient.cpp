@@ -5,6 +5,9 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/FileSystem.h"
+
 #include "revng/Support/PathList.h"
 
 #include "LocalFile.h"
@@ -27,11 +30,18 @@ LocalStorageClient::LocalStorageClient(llvm::StringRef Root) :
   revng_assert(not Root.empty());
 };
 
+LocalStorageClient::~LocalStorageClient() {
+  llvm::consumeError(waitPendingWrites());
+}
+
 std::string LocalStorageClient::dumpString() const {
   return Root;
 }
 
 llvm::Expected<PathType> LocalStorageClient::type(llvm::StringRef Path) {
+  if (auto Error = waitPendingWrites(); Error)
+    return Error;
+
   std::string ResolvedPath = resolvePath(Path);
   if (llvm::sys::fs::exists(ResolvedPath)) {
     if (llvm::sys::fs::is_directory(ResolvedPath))
@@ -56,6 +66,9 @@ llvm::Error LocalStorageClient::createDirectory(llvm::StringRef Path) {
 }
 
 llvm::Error LocalStorageClient::remove(llvm::StringRef Path) {
+  if (auto Error = waitPendingWrites(); Error)
+    return Error;
+
   std::string ResolvedPath = resolvePath(Path);
   std::error_code EC = llvm::sys::fs::remove(ResolvedPath);
   if (EC) {
@@ -73,6 +86,9 @@ llvm::sys::path::Style LocalStorageClient::getStyle() const {
 
 llvm::Error LocalStorageClient::copy(llvm::StringRef Source,
                                      llvm::StringRef Destination) {
+  if (auto Error = waitPendingWrites(); Error)
+    return Error;
+
   std::string ResolvedSource = resolvePath(Source);
   std::string ResolvedDestination = resolvePath(Destination);
   std::error_code EC = llvm::sys::fs::copy_file(ResolvedSource.c_str(),
@@ -89,6 +105,9 @@ llvm::Error LocalStorageClient::copy(llvm::StringRef Source,
 
 llvm::Expected<std::unique_ptr<ReadableFile>>
 LocalStorageClient::getReadableFile(llvm::StringRef Path) {
+  if (auto Error = waitPendingWrites(); Error)
+    return Error;
+
   std::string ResolvedPath = resolvePath(Path);
   auto MaybeBuffer = llvm::MemoryBuffer::getFile(ResolvedPath);
   if (not MaybeBuffer) {
@@ -100,10 +119,93 @@ LocalStorageClient::getReadableFile(llvm::StringRef Path) {
   return std::make_unique<LocalReadableFile>(std::move(MaybeBuffer.get()));
 }
 
+/// Maximum number of files written in background at the same time
+static constexpr unsigned MaxParallelWrites = 4;
+
+unsigned LocalStorageClient::getWriteBehindConcurrency() const {
+  return MaxParallelWrites;
+}
+
+/// Write \p Data to a temporary file next to \p Path, then hand it over to
+/// \p Replace, which is expected to move it to \p Path
+///
+/// Since the file is replaced atomically, readers (possibly through a mmap) of
+/// the previous version are never affected.
+static llvm::Error
+writeFile(const std::string &Path,
+          llvm::StringRef Data,
+          llvm::function_ref<std::error_code(llvm::StringRef)> Replace) {
+  int FD = -1;
+  llvm::SmallString<128> TemporaryPath;
+  std::error_code EC = llvm::sys::fs::createUniqueFile(Path + "-%%%%%%.tmp",
+                                                       FD,
+                                                       TemporaryPath);
+  if (EC) {
+    return llvm::createStringError(EC,
+                                   "Could not open file %s for writing",
+                                   Path.c_str());
+  }
+
+  llvm::raw_fd_ostream OS(FD, /* shouldClose */ true);
+  OS << Data;
+  OS.close();
+  if (OS.has_error()) {
+    EC = OS.error();
+    OS.clear_error();
+    llvm::sys::fs::remove(TemporaryPath);
+    return llvm::createStringError(EC,
+                                   "Could not write file %s",
+                                   Path.c_str());
+  }
+
+  EC = Replace(TemporaryPath);
+  if (EC) {
+    llvm::sys::fs::remove(TemporaryPath);
+    return llvm::createStringError(EC,
+                                   "Could not write file %s",
+                                   Path.c_str());
+  }
+
+  return llvm::Error::success();
+}
+
 llvm::Expected<std::unique_ptr<WritableFile>>
 LocalStorageClient::getWritableFile(llvm::StringRef Path,
                                     ContentEncoding Encoding) {
   std::string ResolvedPath = resolvePath(Path);
+
+  if (isWriteBehind()) {
+    using Buffer = llvm::SmallVector<char, 0>;
+    auto Write = [this, ResolvedPath](Buffer &&Data) {
+      uint64_t ID = 0;
+      {
+        std::lock_guard Guard(WritesMutex);
+        ID = ++LastWriteID;
+        LatestWrites[ResolvedPath] = ID;
+      }
+
+      auto Replace = [this, ResolvedPath, ID](llvm::StringRef TemporaryPath) {
+        std::lock_guard Guard(WritesMutex);
+
+        // A more recent write of this file has been enqueued, drop ours
+        if (LatestWrites.lookup(ResolvedPath) != ID) {
+          llvm::sys::fs::remove(TemporaryPath);
+          return std::error_code();
+        }
+
+        LatestWrites.erase(ResolvedPath);
+        return llvm::sys::fs::rename(TemporaryPath, ResolvedPath);
+      };
+
+      return enqueueWrite([ResolvedPath, Replace, Data = std::move(Data)]() {
+        return writeFile(ResolvedPath,
+                         llvm::StringRef(Data.data(), Data.size()),
+                         Replace);
+      });
+    };
+    return std::make_unique<LocalBufferedWritableFile>(std::move(Write));
+  }
+
   std::error_code EC;
   auto OS = std::make_unique<llvm::raw_fd_ostream>(ResolvedPath,
                                                    EC,
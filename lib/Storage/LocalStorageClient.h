@@ -4,6 +4,10 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <mutex>
+
+#include "llvm/ADT/StringMap.h"
+
 #include "revng/Storage/StorageClient.h"
 #include "revng/Support/Debug.h"
 
@@ -13,9 +17,15 @@ class LocalStorageClient : public StorageClient {
 private:
   std::string Root;
 
+  /// Writes in background can complete out of order: each one gets an ID and
+  /// only the latest for a certain path is allowed to replace the file
+  std::mutex WritesMutex;
+  uint64_t LastWriteID = 0;
+  llvm::StringMap<uint64_t> LatestWrites;
+
 public:
   LocalStorageClient(llvm::StringRef Root);
-  ~LocalStorageClient() override = default;
+  ~LocalStorageClient() override;
 
   llvm::Expected<PathType> type(llvm::StringRef Path) override;
   llvm::Error createDirectory(llvm::StringRef Path) override;
@@ -31,6 +41,9 @@ public:
   llvm::Expected<std::unique_ptr<WritableFile>>
   getWritableFile(llvm::StringRef Path, ContentEncoding Encoding) override;
 
+protected:
+  unsigned getWriteBehindConcurrency() const override;
+
 private:
   std::string dumpString() const override;
   std::string resolvePath(llvm::StringRef Path);
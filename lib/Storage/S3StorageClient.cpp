@@ -5,6 +5,7 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <algorithm>
 #include <fstream>
 
 #include "aws/core/Aws.h"
@@ -12,13 +13,24 @@
 #include "aws/core/auth/AWSCredentialsProvider.h"
 #include "aws/core/utils/logging/FormattedLogSystem.h"
 #include "aws/s3/S3Client.h"
+#include "aws/core/utils/stream/PreallocatedStreamBuf.h"
+#include "aws/s3/model/AbortMultipartUploadRequest.h"
+#include "aws/s3/model/CompleteMultipartUploadRequest.h"
+#include "aws/s3/model/CompletedMultipartUpload.h"
+#include "aws/s3/model/CompletedPart.h"
 #include "aws/s3/model/CopyObjectRequest.h"
+#include "aws/s3/model/CreateMultipartUploadRequest.h"
 #include "aws/s3/model/DeleteObjectRequest.h"
 #include "aws/s3/model/GetObjectRequest.h"
 #include "aws/s3/model/HeadObjectRequest.h"
 #include "aws/s3/model/PutObjectRequest.h"
+#include "aws/s3/model/UploadPartRequest.h"
 
+#include "llvm/ADT/ScopeExit.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Process.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/YAMLTraits.h"
 
 #include "revng/Storage/Path.h"
@@ -144,6 +156,53 @@ static Aws::Auth::AWSCredentials readCredentials(llvm::StringRef Credentials) {
   return Aws::Auth::AWSCredentials{ Username.str(), Password.str() };
 }
 
+/// Objects larger than this are transferred in parts, in parallel
+static constexpr uint64_t MultipartThreshold = 64 * 1024 * 1024;
+
+/// Size of each part, must be at least 5 MiB as mandated by S3
+static constexpr uint64_t PartSize = 16 * 1024 * 1024;
+
+/// Maximum number of parts transferred at the same time
+static constexpr unsigned MaxParallelTransfers = 8;
+
+static uint64_t getPartsCount(uint64_t Size) {
+  return (Size + PartSize - 1) / PartSize;
+}
+
+/// Run \p Transfer on each part of an object of \p Size bytes, in parallel.
+/// \p Transfer takes the index, the offset and the size of the part and
+/// returns an error message, if any.
+template<typename T>
+static llvm::Error transferParts(uint64_t Size, T &&Transfer) {
+  uint64_t PartsCount = getPartsCount(Size);
+  std::vector<std::string> Errors(PartsCount);
+
+  {
+    unsigned Threads = std::min<uint64_t>(MaxParallelTransfers, PartsCount);
+    llvm::ThreadPool Pool(llvm::hardware_concurrency(Threads));
+    for (uint64_t I = 0; I < PartsCount; I++) {
+      uint64_t Offset = I * PartSize;
+      uint64_t Length = std::min(PartSize, Size - Offset);
+      Pool.async([&Errors, &Transfer, I, Offset, Length]() {
+        Errors[I] = Transfer(I, Offset, Length);
+      });
+    }
+    Pool.wait();
+  }
+
+  for (const std::string &Error : Errors)
+    if (not Error.empty())
+      return llvm::createStringError(llvm::inconvertibleErrorCode(), Error);
+
+  return llvm::Error::success();
+}
+
+/// Copy \p Body into \p Destination, \return false if the body is shorter
+static bool readBody(std::istream &Body, char *Destination, uint64_t Length) {
+  Body.read(Destination, Length);
+  return static_cast<uint64_t>(Body.gcount()) == Length;
+}
+
 class S3ReadableFile : public ReadableFile {
 private:
   TemporaryFile TempFile;
@@ -179,18 +238,64 @@ public:
 
   llvm::raw_pwrite_stream &os() override { return *OS; }
   llvm::Error commit() override {
-    OS->flush();
+    OS->close();
+    if (OS->has_error()) {
+      std::error_code EC = OS->error();
+      OS->clear_error();
+      return llvm::createStringError(EC, "Could not write temporary file");
+    }
+
+    // The upload owns the temporary file, since in write-behind mode it
+    // outlives this object
+    auto Upload = [&Client = Client,
+                   TempFile = std::move(TempFile),
+                   Path = Path,
+                   Encoding = Encoding]() {
+      return uploadFile(Client, TempFile.path(), Path, Encoding);
+    };
+    return Client.enqueueWrite(std::move(Upload));
+  }
+
+private:
+  static llvm::Error uploadFile(S3StorageClient &Client,
+                                llvm::StringRef LocalPath,
+                                llvm::StringRef Path,
+                                ContentEncoding Encoding) {
+    std::string NewFilename = generateNewFilename(Path);
+    std::string Key = Client.resolvePath(NewFilename);
+
+    uint64_t Size = 0;
+    if (std::error_code EC = llvm::sys::fs::file_size(LocalPath, Size))
+      return llvm::createStringError(EC, "Could not stat temporary file");
+
+    if (Size > MultipartThreshold) {
+      if (auto Error = uploadMultipart(Client, LocalPath, Key, Size, Encoding))
+        return Error;
+    } else {
+      if (llvm::Error Error = upload(Client, LocalPath, Key, Encoding))
+        return Error;
+    }
 
+    std::lock_guard Guard(Client.FilenameMapMutex);
+    Client.FilenameMap[Path] = NewFilename;
+    return llvm::Error::success();
+  }
+
+  static llvm::Error upload(S3StorageClient &Client,
+                            llvm::StringRef LocalPath,
+                            const std::string &Key,
+                            ContentEncoding Encoding) {
     Aws::S3::Model::PutObjectRequest Request;
     Request.SetBucket(Client.Bucket);
 
     if (Encoding == ContentEncoding::Gzip)
       Request.SetContentEncoding("gzip");
+    else if (Encoding == ContentEncoding::Zstd)
+      Request.SetContentEncoding("zstd");
 
-    std::string NewFilename = generateNewFilename(Path);
-    Request.SetKey(Client.resolvePath(NewFilename));
+    Request.SetKey(Key);
 
-    auto File = std::make_shared<Aws::FStream>(TempFile.path().str(),
+    auto File = std::make_shared<Aws::FStream>(LocalPath.str(),
                                                std::ios_base::in
                                                  | std::ios_base::binary);
     if (File->fail()) {
@@ -203,7 +308,89 @@ public:
     if (not Result.IsSuccess())
       return toError(Result);
 
-    Client.FilenameMap[Path] = NewFilename;
+    return llvm::Error::success();
+  }
+
+  static llvm::Error uploadMultipart(S3StorageClient &Client,
+                                     llvm::StringRef LocalPath,
+                                     const std::string &Key,
+                                     uint64_t Size,
+                                     ContentEncoding Encoding) {
+    using namespace Aws::S3::Model;
+    using Aws::Utils::Stream::PreallocatedStreamBuf;
+
+    // The temporary file is private to this object, it's safe to map it
+    auto MaybeBuffer = llvm::MemoryBuffer::getFile(LocalPath,
+                                                   /* IsText */ false,
+                                                   /* NullTerminated */ false);
+    if (not MaybeBuffer) {
+      return llvm::createStringError(MaybeBuffer.getError(),
+                                     "Could not open temporary file");
+    }
+    llvm::MemoryBuffer &Buffer = **MaybeBuffer;
+
+    CreateMultipartUploadRequest CreateRequest;
+    CreateRequest.SetBucket(Client.Bucket);
+    CreateRequest.SetKey(Key);
+    if (Encoding == ContentEncoding::Gzip)
+      CreateRequest.SetContentEncoding("gzip");
+    else if (Encoding == ContentEncoding::Zstd)
+      CreateRequest.SetContentEncoding("zstd");
+
+    auto CreateResult = Client.Client.CreateMultipartUpload(CreateRequest);
+    if (not CreateResult.IsSuccess())
+      return toError(CreateResult);
+    const Aws::String &UploadId = CreateResult.GetResult().GetUploadId();
+
+    std::vector<CompletedPart> Parts(getPartsCount(Size));
+    auto UploadPart = [&](uint64_t Index, uint64_t Offset, uint64_t Length) {
+      // PreallocatedStreamBuf requires a non-const pointer, but the body of a
+      // request is only read
+      auto *Start = reinterpret_cast<unsigned char *>(const_cast<char *>(
+        Buffer.getBufferStart() + Offset));
+      PreallocatedStreamBuf StreamBuffer(Start, Length);
+
+      UploadPartRequest Request;
+      Request.SetBucket(Client.Bucket);
+      Request.SetKey(Key);
+      Request.SetUploadId(UploadId);
+      Request.SetPartNumber(Index + 1);
+      Request.SetContentLength(Length);
+      Request.SetBody(std::make_shared<Aws::IOStream>(&StreamBuffer));
+
+      auto Result = Client.Client.UploadPart(Request);
+      if (not Result.IsSuccess())
+        return std::string(Result.GetError().GetMessage());
+
+      Parts[Index].SetPartNumber(Index + 1);
+      Parts[Index].SetETag(Result.GetResult().GetETag());
+      return std::string();
+    };
+
+    if (llvm::Error Error = transferParts(Size, UploadPart)) {
+      AbortMultipartUploadRequest AbortRequest;
+      AbortRequest.SetBucket(Client.Bucket);
+      AbortRequest.SetKey(Key);
+      AbortRequest.SetUploadId(UploadId);
+      auto AbortResult = Client.Client.AbortMultipartUpload(AbortRequest);
+      if (not AbortResult.IsSuccess())
+        return llvm::joinErrors(std::move(Error), toError(AbortResult));
+      return Error;
+    }
+
+    CompletedMultipartUpload Completed;
+    Completed.SetParts(std::move(Parts));
+
+    CompleteMultipartUploadRequest CompleteRequest;
+    CompleteRequest.SetBucket(Client.Bucket);
+    CompleteRequest.SetKey(Key);
+    CompleteRequest.SetUploadId(UploadId);
+    CompleteRequest.SetMultipartUpload(std::move(Completed));
+
+    auto Result = Client.Client.CompleteMultipartUpload(CompleteRequest);
+    if (not Result.IsSuccess())
+      return toError(Result);
+
     return llvm::Error::success();
   }
 };
@@ -302,11 +489,22 @@ S3StorageClient::fromURL(llvm::StringRef URL) {
   return Instance;
 }
 
+S3StorageClient::~S3StorageClient() {
+  llvm::consumeError(waitPendingWrites());
+}
+
+unsigned S3StorageClient::getWriteBehindConcurrency() const {
+  return MaxParallelTransfers;
+}
+
 std::string S3StorageClient::dumpString() const {
   return RedactedURL;
 }
 
 llvm::Expected<PathType> S3StorageClient::type(llvm::StringRef Path) {
+  if (auto Error = waitPendingWrites(); Error)
+    return Error;
+
   if (FilenameMap.count(Path) > 0) {
     Aws::S3::Model::HeadObjectRequest Request;
     Request.SetBucket(Bucket);
@@ -337,6 +535,9 @@ llvm::Error S3StorageClient::createDirectory(llvm::StringRef Path) {
 }
 
 llvm::Error S3StorageClient::remove(llvm::StringRef Path) {
+  if (auto Error = waitPendingWrites(); Error)
+    return Error;
+
   revng_assert(FilenameMap.count(Path) != 0);
   FilenameMap.erase(Path);
   return llvm::Error::success();
@@ -348,6 +549,9 @@ llvm::sys::path::Style S3StorageClient::getStyle() const {
 
 llvm::Error S3StorageClient::copy(llvm::StringRef Source,
                                   llvm::StringRef Destination) {
+  if (auto Error = waitPendingWrites(); Error)
+    return Error;
+
   if (FilenameMap.count(Source) == 0) {
     return llvm::createStringError(llvm::inconvertibleErrorCode(),
                                    "Source file %s does not exist",
@@ -361,19 +565,25 @@ llvm::Error S3StorageClient::copy(llvm::StringRef Source,
 llvm::Expected<std::unique_ptr<ReadableFile>>
 S3StorageClient::getReadableFile(llvm::StringRef Path) {
   using llvm::MemoryBuffer;
+  if (auto Error = waitPendingWrites(); Error)
+    return Error;
+
   if (FilenameMap.count(Path) == 0) {
     return llvm::createStringError(llvm::inconvertibleErrorCode(),
                                    "File %s does not exist",
                                    Path.str().c_str());
   }
 
-  Aws::S3::Model::GetObjectRequest Request;
-  Request.SetBucket(Bucket);
-  Request.SetKey(resolvePath(FilenameMap[Path]));
+  std::string Key = resolvePath(FilenameMap[Path]);
 
-  Aws::S3::Model::GetObjectOutcome Result = Client.GetObject(Request);
-  if (not Result.IsSuccess())
-    return toError(Result);
+  Aws::S3::Model::HeadObjectRequest HeadRequest;
+  HeadRequest.SetBucket(Bucket);
+  HeadRequest.SetKey(Key);
+
+  Aws::S3::Model::HeadObjectOutcome HeadResult = Client.HeadObject(HeadRequest);
+  if (not HeadResult.IsSuccess())
+    return toError(HeadResult);
+  uint64_t Size = HeadResult.GetResult().GetContentLength();
 
   auto MaybeTemporary = TemporaryFile::make("revng-s3-storage");
   if (!MaybeTemporary) {
@@ -381,25 +591,61 @@ S3StorageClient::getReadableFile(llvm::StringRef Path) {
                                    "Could not create temporary file");
   }
 
-  std::ofstream OS(MaybeTemporary->path().str(), std::ios::binary);
-  if (OS.fail()) {
-    return llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                   "Could not open temporary file");
-  }
-
-  constexpr size_t BufSize = 4096;
-  llvm::SmallVector<char> Buffer;
-  Buffer.resize_for_overwrite(BufSize);
-  auto &Body = Result.GetResult().GetBody();
-
-  while (!Body.eof()) {
-    Body.read(Buffer.data(), BufSize);
-    OS.write(Buffer.data(), Body.gcount());
+  // Download the object straight into a mapping of the temporary file, each
+  // ranged request writes its own slice
+  if (Size > 0) {
+    using llvm::sys::fs::mapped_file_region;
+    int FD = -1;
+    std::error_code EC;
+    EC = llvm::sys::fs::openFileForReadWrite(MaybeTemporary->path(),
+                                             FD,
+                                             llvm::sys::fs::CD_OpenExisting,
+                                             llvm::sys::fs::OF_None);
+    if (EC)
+      return llvm::createStringError(EC, "Could not open temporary file");
+    auto CloseFD = llvm::make_scope_exit([FD]() {
+      llvm::sys::Process::SafelyCloseFileDescriptor(FD);
+    });
+
+    if ((EC = llvm::sys::fs::resize_file(FD, Size)))
+      return llvm::createStringError(EC, "Could not resize temporary file");
+
+    auto Kind = mapped_file_region::readwrite;
+    auto Handle = llvm::sys::fs::convertFDToNativeFile(FD);
+    mapped_file_region Region(Handle, Kind, Size, 0, EC);
+    if (EC)
+      return llvm::createStringError(EC, "Could not map temporary file");
+
+    auto Download = [&](uint64_t Index, uint64_t Offset, uint64_t Length) {
+      Aws::S3::Model::GetObjectRequest Request;
+      Request.SetBucket(Bucket);
+      Request.SetKey(Key);
+      if (Size > MultipartThreshold) {
+        Request.SetRange("bytes=" + std::to_string(Offset) + "-"
+                         + std::to_string(Offset + Length - 1));
+      }
+
+      Aws::S3::Model::GetObjectOutcome Result = Client.GetObject(Request);
+      if (not Result.IsSuccess())
+        return std::string(Result.GetError().GetMessage());
+
+      auto &Body = Result.GetResult().GetBody();
+      if (not readBody(Body, Region.data() + Offset, Length))
+        return "Short read while downloading " + Key;
+
+      return std::string();
+    };
+
+    llvm::Error Error = llvm::Error::success();
+    if (Size > MultipartThreshold)
+      Error = transferParts(Size, Download);
+    else if (std::string Message = Download(0, 0, Size); not Message.empty())
+      Error = llvm::createStringError(llvm::inconvertibleErrorCode(), Message);
+
+    if (Error)
+      return Error;
   }
 
-  OS.flush();
-  OS.close();
-
   auto MaybeReadableStream = MemoryBuffer::getFile(MaybeTemporary->path());
   if (not MaybeReadableStream) {
     return llvm::createStringError(MaybeReadableStream.getError(),
@@ -432,6 +678,9 @@ S3StorageClient::getWritableFile(llvm::StringRef Path,
 }
 
 llvm::Error S3StorageClient::commit() {
+  if (auto Error = waitPendingWrites(); Error)
+    return Error;
+
   std::string SerializedIndex;
 
   {
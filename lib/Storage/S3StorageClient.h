@@ -4,6 +4,8 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <mutex>
+
 #include "aws/core/auth/AWSCredentials.h"
 #include "aws/s3/S3Client.h"
 
@@ -23,12 +25,14 @@ private:
   std::string Bucket;
   std::string SubPath;
   std::string RedactedURL;
+  /// Guards FilenameMap against concurrent updates from write-behind uploads
+  std::mutex FilenameMapMutex;
   llvm::StringMap<std::string> FilenameMap;
   static constexpr auto IndexName = "index.yml";
 
 public:
   S3StorageClient(llvm::StringRef URL);
-  ~S3StorageClient() override = default;
+  ~S3StorageClient() override;
 
   static llvm::Expected<std::unique_ptr<S3StorageClient>>
   fromURL(llvm::StringRef URL);
@@ -58,6 +62,7 @@ public:
   llvm::Error setCredentials(llvm::StringRef Credentials) override;
 
 private:
+  unsigned getWriteBehindConcurrency() const override;
   std::string dumpString() const override;
   std::string resolvePath(llvm::StringRef Path);
   friend class S3WritableFile;
@@ -5,6 +5,9 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+
 #include "revng/Storage/StorageClient.h"
 
 #include "LocalStorageClient.h"
@@ -19,3 +22,54 @@ revng::StorageClient::fromPathOrURL(llvm::StringRef URL) {
     return std::make_unique<revng::LocalStorageClient>(URL);
   }
 }
+
+revng::StorageClient::StorageClient() = default;
+
+revng::StorageClient::~StorageClient() {
+  // Errors are reported by commit, writes that have not been committed might
+  // be lost anyway. Subclasses must wait for writes relying on their members
+  // in their own destructor.
+  llvm::consumeError(waitPendingWrites());
+}
+
+llvm::Error revng::StorageClient::setWriteBehind(bool Enable) {
+  if (Enable == isWriteBehind())
+    return llvm::Error::success();
+
+  llvm::Error Result = waitPendingWrites();
+  if (Enable) {
+    auto Strategy = llvm::hardware_concurrency(getWriteBehindConcurrency());
+    WriteBehindPool = std::make_unique<llvm::ThreadPool>(Strategy);
+  } else {
+    WriteBehindPool.reset();
+  }
+
+  return Result;
+}
+
+llvm::Error
+revng::StorageClient::enqueueWrite(llvm::unique_function<llvm::Error()> Write) {
+  if (not isWriteBehind())
+    return Write();
+
+  // ThreadPool requires copyable tasks
+  auto Shared = std::make_shared<decltype(Write)>(std::move(Write));
+  WriteBehindPool->async([this, Shared]() {
+    llvm::Error Error = (*Shared)();
+    if (Error) {
+      std::lock_guard Guard(PendingErrorsMutex);
+      PendingErrors = llvm::joinErrors(std::move(PendingErrors),
+                                       std::move(Error));
+    }
+  });
+
+  return llvm::Error::success();
+}
+
+llvm::Error revng::StorageClient::waitPendingWrites() {
+  if (WriteBehindPool != nullptr)
+    WriteBehindPool->wait();
+
+  std::lock_guard Guard(PendingErrorsMutex);
+  return std::move(PendingErrors);
+}
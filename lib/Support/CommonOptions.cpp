@@ -11,3 +11,8 @@ using namespace llvm;
 cl::opt<bool> DebugNames("debug-names",
                          cl::desc("Use friendly names in non-user artifacts"),
                          cl::init(false));
+
+cl::opt<bool> ZstdWorkspace("zstd-workspace",
+                            cl::desc("Compress the archives stored in the "
+                                     "workspace with zstd instead of gzip"),
+                            cl::init(false));
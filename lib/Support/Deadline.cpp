@@ -0,0 +1,70 @@
+/// \file Deadline.cpp
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <mutex>
+
+#include "revng/Support/Assert.h"
+#include "revng/Support/Deadline.h"
+#include "revng/Support/Debug.h"
+
+using namespace revng;
+
+static Logger<> Log("deadline");
+
+/// The current deadline, in ticks of the steady clock, or 0 for none
+static std::atomic<int64_t> CurrentDeadline = 0;
+
+/// Protects the chain of the active scopes
+static std::mutex ScopesMutex;
+static DeadlineScope *CurrentScope = nullptr;
+
+DeadlineScope::DeadlineScope(std::chrono::milliseconds Budget) {
+  std::lock_guard Lock(ScopesMutex);
+  Previous = CurrentDeadline;
+  PreviousScope = CurrentScope;
+  CurrentScope = this;
+
+  if (Budget.count() == 0)
+    return;
+
+  auto End = (Clock::now() + Budget).time_since_epoch().count();
+  if (Previous == 0 or End < Previous)
+    CurrentDeadline = End;
+}
+
+DeadlineScope::~DeadlineScope() {
+  std::lock_guard Lock(ScopesMutex);
+  revng_assert(CurrentScope == this);
+  CurrentScope = PreviousScope;
+  CurrentDeadline = Previous;
+
+  // Expirations are reported to the enclosing scopes too
+  if (Expired and PreviousScope != nullptr)
+    PreviousScope->Expired = true;
+}
+
+bool revng::deadlinePassed() {
+  int64_t Deadline = CurrentDeadline.load(std::memory_order_relaxed);
+  if (Deadline == 0)
+    return false;
+
+  using Clock = std::chrono::steady_clock;
+  return Clock::now().time_since_epoch().count() >= Deadline;
+}
+
+bool revng::deadlineExpired(llvm::StringRef What) {
+  if (not deadlinePassed())
+    return false;
+
+  // Warn only the first time, algorithms can poll in a loop after expiration
+  std::lock_guard Lock(ScopesMutex);
+  if (CurrentScope != nullptr and not CurrentScope->Expired.exchange(true)) {
+    dbg << "Warning: the deadline expired, " << What.str()
+        << " returned a partial result\n";
+  }
+  revng_log(Log, What.str() << " returned a partial result");
+  return true;
+}
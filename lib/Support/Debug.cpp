@@ -7,12 +7,15 @@
 
 #include <algorithm>
 #include <iostream>
+#include <mutex>
 #include <string>
 #include <vector>
 
 #include "llvm/ADT/Twine.h"
 #include "llvm/IR/Value.h"
 #include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/raw_ostream.h"
 
 #include "revng/Support/Assert.h"
 #include "revng/Support/CommandLine.h"
@@ -29,8 +32,75 @@ static cl::opt<unsigned> MaxLocationLength("debug-location-max-length",
                                            cl::cat(MainCategory),
                                            cl::init(0));
 
+static cl::opt<unsigned> LogRingBufferSize("debug-log-ring-buffer",
+                                           cl::desc("keep the last bytes of "
+                                                    "the enabled logs in "
+                                                    "memory, instead of "
+                                                    "printing them, and print "
+                                                    "them only in case of a "
+                                                    "crash. 0 disables it."),
+                                           cl::cat(MainCategory),
+                                           cl::init(0));
+
 size_t MaxLoggerNameLength = 0;
 
+/// Fixed-size in-memory sink for the log lines, printed in case of a crash
+///
+/// This allows to keep detailed logging on without paying for writing it out.
+class LogRingBuffer {
+private:
+  std::mutex Mutex;
+  std::vector<char> Data;
+  size_t Next = 0;
+  bool Wrapped = false;
+
+public:
+  void append(llvm::StringRef Text) {
+    std::lock_guard Lock(Mutex);
+
+    if (Data.empty()) {
+      Data.resize(LogRingBufferSize);
+      llvm::sys::AddSignalHandler(dumpOnCrash, this);
+    }
+
+    // Only the tail of a line longer than the whole buffer would survive
+    if (Text.size() > Data.size())
+      Text = Text.take_back(Data.size());
+
+    size_t Head = std::min(Text.size(), Data.size() - Next);
+    std::copy_n(Text.begin(), Head, Data.begin() + Next);
+    std::copy(Text.begin() + Head, Text.end(), Data.begin());
+
+    Next += Text.size();
+    if (Next >= Data.size()) {
+      Next -= Data.size();
+      Wrapped = true;
+    }
+  }
+
+private:
+  static void dumpOnCrash(void *Argument) {
+    auto *This = static_cast<LogRingBuffer *>(Argument);
+
+    // We might have crashed while holding the lock: in that case, print the
+    // buffer anyway, it's the best we can do at this point
+    bool Locked = This->Mutex.try_lock();
+
+    llvm::raw_fd_ostream &Output = llvm::errs();
+    Output << "Last log lines before the crash:\n";
+    llvm::StringRef Content(This->Data.data(), This->Data.size());
+    if (This->Wrapped)
+      Output << Content.drop_front(This->Next);
+    Output << Content.take_front(This->Next);
+    Output.flush();
+
+    if (Locked)
+      This->Mutex.unlock();
+  }
+};
+
+static llvm::ManagedStatic<LogRingBuffer> RingBuffer;
+
 /// A global registry for all the loggers
 ///
 /// Loggers are usually global static variables in translation units, the role
@@ -93,7 +163,10 @@ Logger<> VerifyLog("verify");
 
 template<bool X>
 void Logger<X>::flush(const LogTerminator &LineInfo) {
-  if (X && Enabled) {
+  if (isEnabled()) {
+    // Compose the whole line first, so that it reaches the sink at once
+    std::string Line;
+    llvm::raw_string_ostream Output(Line);
     std::string Pad;
 
     if (MaxLocationLength != 0) {
@@ -110,12 +183,12 @@ void Logger<X>::flush(const LogTerminator &LineInfo) {
 
       Pad = std::string(MaxLocationLength - Location.size() - Suffix.size(),
                         ' ');
-      dbg << "[" << Location << Suffix << Pad << "] ";
+      Output << "[" << Location << Suffix << Pad << "] ";
     }
 
     Pad = std::string(MaxLoggerNameLength - Name.size(), ' ');
-    dbg << "[" << Name.data() << Pad << "] ";
-    dbg << std::string(IndentLevel * 2, ' ');
+    Output << "[" << Name.data() << Pad << "] ";
+    Output << std::string(IndentLevel * 2, ' ');
 
     std::string Data = Buffer.str();
     if (Data.size() > 0 and Data.back() == '\n')
@@ -124,17 +197,23 @@ void Logger<X>::flush(const LogTerminator &LineInfo) {
     std::string Delimiter = "\n";
     size_t Start = 0;
     size_t End = Data.find(Delimiter);
-    dbg << Data.substr(Start, End) << "\n";
+    Output << Data.substr(Start, End) << "\n";
 
     if (End != std::string::npos) {
       Pad = std::string(3 + MaxLoggerNameLength + IndentLevel * 2, ' ');
       do {
         Start = End + Delimiter.length();
         End = Data.find(Delimiter, Start);
-        dbg << Pad << Data.substr(Start, End - Start) << "\n";
+        Output << Pad << Data.substr(Start, End - Start) << "\n";
       } while (End != std::string::npos);
     }
 
+    Output.flush();
+    if (LogRingBufferSize != 0)
+      RingBuffer->append(Line);
+    else
+      dbg << Line;
+
     Buffer.str("");
     Buffer.clear();
   }
@@ -0,0 +1,268 @@
+/// \file ELFDynamicInfo.cpp
+/// Parsing of the dynamic section of ELF files, shared by its users.
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <map>
+#include <mutex>
+#include <optional>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Object/Binary.h"
+#include "llvm/Object/ELFObjectFile.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/FileSystem.h"
+
+#include "revng/Support/Debug.h"
+#include "revng/Support/ELFDynamicInfo.h"
+#include "revng/Support/OverflowSafeInt.h"
+
+static Logger<> Log("elf-dynamic-info");
+
+using namespace llvm;
+
+template<class ELFT>
+static std::optional<StringRef>
+getDynamicString(const llvm::object::ELFFile<ELFT> &TheELF,
+                 StringRef DynamicStringTable,
+                 uint64_t Value) {
+  if (DynamicStringTable.empty() && !DynamicStringTable.data())
+    return std::nullopt;
+  uint64_t FileSize = TheELF.getBufSize();
+  uint64_t Offset = reinterpret_cast<const uint8_t *>(DynamicStringTable.data())
+                    - TheELF.base();
+  if (DynamicStringTable.size() > FileSize - Offset)
+    return std::nullopt;
+  if (Value >= DynamicStringTable.size())
+    return std::nullopt;
+  if (DynamicStringTable.back() != '\0')
+    return std::nullopt;
+  return DynamicStringTable.data() + Value;
+}
+
+template<class ELFT>
+static std::optional<StringRef>
+getDynamicStringTable(const ELFT &ELFObjectFile,
+                      typename ELFT::Elf_Dyn_Range &DynamicEntries) {
+  // Find address and size of .dynstr using dynamic entries
+  uint64_t DynstrAddress = 0;
+  uint64_t DynstrSize = 0;
+  for (const auto &DynamicTag : DynamicEntries) {
+    auto TheTag = DynamicTag.getTag();
+    auto TheVal = DynamicTag.getVal();
+    if (TheTag == llvm::ELF::DT_STRTAB) {
+      DynstrAddress = TheVal;
+    } else if (TheTag == llvm::ELF::DT_STRSZ) {
+      DynstrSize = TheVal;
+    }
+  }
+
+  // Compute end address
+  auto MaybeEndAddress = OverflowSafeInt(DynstrAddress) + DynstrSize;
+  if (DynstrAddress == 0 or DynstrSize == 0 or not MaybeEndAddress)
+    return {};
+  uint64_t EndAddress = *MaybeEndAddress;
+
+  //
+  // Convert address to offset
+  //
+
+  // Collect program headers
+  auto ProgramHeadersOrError = ELFObjectFile.getELFFile().program_headers();
+  if (not ProgramHeadersOrError) {
+    revng_log(Log, "No valid program headers available");
+    llvm::consumeError(ProgramHeadersOrError.takeError());
+    return {};
+  }
+
+  // Find the correct program header
+  using Elf_Phdr = ELFT::Elf_Phdr;
+  for (const Elf_Phdr &Phdr : *ProgramHeadersOrError) {
+    if (Phdr.p_type != llvm::ELF::PT_LOAD)
+      continue;
+
+    uint64_t StartAddress = Phdr.p_vaddr;
+    uint64_t FileSize = Phdr.p_filesz;
+    auto SegmentEndAddress = OverflowSafeInt(StartAddress) + FileSize;
+    if (SegmentEndAddress and DynstrAddress >= Phdr.p_vaddr
+        and EndAddress <= *SegmentEndAddress) {
+      uint64_t SegmentStartOffset = Phdr.p_offset;
+      auto MaybeSegmentEndOffset = OverflowSafeInt(SegmentStartOffset)
+                                   + FileSize;
+      auto MaybeDynstrOffset = OverflowSafeInt(DynstrAddress) - StartAddress;
+      auto MaybeDynstrEnd = MaybeDynstrOffset + DynstrSize;
+
+      StringRef RawData = ELFObjectFile.getData();
+      if (MaybeSegmentEndOffset and MaybeDynstrOffset and MaybeDynstrEnd
+          and SegmentStartOffset <= *MaybeSegmentEndOffset
+          and SegmentStartOffset <= RawData.size()
+          and *MaybeSegmentEndOffset <= RawData.size()) {
+        return RawData.slice(SegmentStartOffset, *MaybeSegmentEndOffset)
+          .slice(*MaybeDynstrOffset, *MaybeDynstrEnd);
+      }
+    }
+  }
+
+  return {};
+}
+
+namespace {
+
+/// Process-wide cache of the parsed ELF files, so that a library is parsed
+/// only once, no matter how many binaries depend on it and how many times it
+/// is probed while looking for a dependency. An entry is discarded if the size
+/// or the modification time of the file change.
+class ELFCache {
+private:
+  struct Entry {
+    sys::TimePoint<> LastModification;
+    uint64_t Size = 0;
+    std::optional<ELFDynamicInfo> Info;
+  };
+
+private:
+  std::mutex Mutex;
+  std::map<std::string, Entry> Entries;
+
+public:
+  static ELFCache &get() {
+    static ELFCache Instance;
+    return Instance;
+  }
+
+public:
+  /// \return the information about \p Path, or std::nullopt if it does not
+  ///         exist or it's not an ELF
+  ///
+  /// \param Object if not null, the already parsed content of \p Path
+  std::optional<ELFDynamicInfo>
+  lookup(const std::string &Path, const object::ObjectFile *Object) {
+    sys::fs::file_status Status;
+    if (sys::fs::status(Path, Status) or not sys::fs::exists(Status)) {
+      revng_log(Log, Path << " does not exist");
+      return std::nullopt;
+    }
+
+    {
+      std::lock_guard Lock(Mutex);
+      auto It = Entries.find(Path);
+      if (It != Entries.end()
+          and It->second.LastModification == Status.getLastModificationTime()
+          and It->second.Size == Status.getSize())
+        return It->second.Info;
+    }
+
+    // Parse without holding the lock, parsing the same file twice is harmless
+    Entry NewEntry{ Status.getLastModificationTime(),
+                    Status.getSize(),
+                    Object != nullptr ? parse(Path, *Object) : parse(Path) };
+
+    std::lock_guard Lock(Mutex);
+    Entries.insert_or_assign(Path, NewEntry);
+    return NewEntry.Info;
+  }
+
+private:
+  static std::optional<ELFDynamicInfo> parse(const std::string &Path) {
+    using namespace object;
+    auto BinaryOrErr = createBinary(Path);
+    if (not BinaryOrErr) {
+      revng_log(Log,
+                "Can't create binary: " << toString(BinaryOrErr.takeError()));
+      llvm::consumeError(BinaryOrErr.takeError());
+      return std::nullopt;
+    }
+
+    if (auto *Object = dyn_cast<ObjectFile>(BinaryOrErr->getBinary()))
+      return parse(Path, *Object);
+
+    revng_log(Log, "Found " << Path << " but it's not an ELF.");
+    return std::nullopt;
+  }
+
+  static std::optional<ELFDynamicInfo> parse(const std::string &Path,
+                                             const object::ObjectFile &Object) {
+    using namespace object;
+    const auto *Binary = &Object;
+    if (auto *ELFObjectFile = dyn_cast<ELF32LEObjectFile>(Binary))
+      return parseDynamicInfo(*ELFObjectFile);
+    else if (auto *ELFObjectFile = dyn_cast<ELF32BEObjectFile>(Binary))
+      return parseDynamicInfo(*ELFObjectFile);
+    else if (auto *ELFObjectFile = dyn_cast<ELF64LEObjectFile>(Binary))
+      return parseDynamicInfo(*ELFObjectFile);
+    else if (auto *ELFObjectFile = dyn_cast<ELF64BEObjectFile>(Binary))
+      return parseDynamicInfo(*ELFObjectFile);
+
+    revng_log(Log, "Found " << Path << " but it's not an ELF.");
+    return std::nullopt;
+  }
+
+  template<class ELFT>
+  static ELFDynamicInfo parseDynamicInfo(const ELFT &ELFObjectFile) {
+    const auto &TheELF = ELFObjectFile.getELFFile();
+
+    ELFDynamicInfo Result;
+    Result.EMachine = TheELF.getHeader().e_machine;
+    Result.Is64 = (std::is_same_v<ELFT, object::ELF64LEObjectFile>
+                   or std::is_same_v<ELFT, object::ELF64BEObjectFile>);
+
+    auto MaybeDynamicEntries = TheELF.dynamicEntries();
+    if (not MaybeDynamicEntries) {
+      revng_log(Log, "No dynamic entries");
+      llvm::consumeError(MaybeDynamicEntries.takeError());
+      return Result;
+    }
+    using Elf_Dyn_Range = ELFT::Elf_Dyn_Range;
+    Elf_Dyn_Range DynamicEntries = *MaybeDynamicEntries;
+
+    // Look for .dynstr
+    StringRef DynamicStringTable;
+    if (auto MaybeDynamicStringTable = getDynamicStringTable(ELFObjectFile,
+                                                             DynamicEntries))
+      DynamicStringTable = *MaybeDynamicStringTable;
+
+    if (DynamicStringTable.empty()) {
+      revng_log(Log, "Cannot find .dynstr");
+      return Result;
+    }
+
+    auto GetString = [&](uint64_t Value) -> std::optional<std::string> {
+      if (auto String = getDynamicString(TheELF, DynamicStringTable, Value))
+        return String->str();
+      return std::nullopt;
+    };
+
+    using Elf_Dyn = ELFT::Elf_Dyn;
+    for (const Elf_Dyn &DynamicTag : DynamicEntries) {
+      auto TheTag = DynamicTag.getTag();
+      auto TheVal = DynamicTag.getVal();
+      if (TheTag == llvm::ELF::DT_RUNPATH) {
+        Result.RunPath = GetString(TheVal);
+      } else if (TheTag == llvm::ELF::DT_RPATH) {
+        Result.RPath = GetString(TheVal);
+      } else if (TheTag == llvm::ELF::DT_FLAGS_1) {
+        Result.NoDefault = (TheVal & llvm::ELF::DF_1_NODEFLIB) != 0;
+      } else if (TheTag == llvm::ELF::DT_NEEDED) {
+        if (auto LibName = GetString(TheVal))
+          Result.Needed.push_back(std::move(*LibName));
+        else
+          revng_log(Log, "Unable to parse needed library name");
+      }
+    }
+
+    return Result;
+  }
+};
+
+} // namespace
+
+std::optional<ELFDynamicInfo> getELFDynamicInfo(const std::string &Path) {
+  return ELFCache::get().lookup(Path, nullptr);
+}
+
+std::optional<ELFDynamicInfo>
+getELFDynamicInfo(const std::string &Path, const object::ObjectFile &Object) {
+  return ELFCache::get().lookup(Path, &Object);
+}
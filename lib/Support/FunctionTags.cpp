@@ -7,6 +7,7 @@
 #include <map>
 
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/InstrTypes.h"
 #include "llvm/IR/Metadata.h"
@@ -32,22 +33,68 @@ llvm::MDNode *TagsSet::getMetadata(LLVMContext &C) const {
   return MDTuple::get(C, MDTags);
 }
 
+const Tag *TagsSet::findTag(StringRef Name) {
+  // Tag::findByName performs a linear scan: index all the tags by name once
+  static const StringMap<const Tag *> ByName = [] {
+    StringMap<const Tag *> Result;
+    for (const Tag *T : Tag::getAll())
+      Result[T->name()] = T;
+    return Result;
+  }();
+
+  auto It = ByName.find(Name);
+  if (It != ByName.end())
+    return It->second;
+
+  // The tag has been registered after the index has been built
+  return Tag::findByName(Name);
+}
+
+static const Tag &getTag(const MDOperand &Operand) {
+  const Tag *Result = TagsSet::findTag(cast<MDString>(Operand.get())->getString());
+  revng_assert(Result != nullptr);
+  return *Result;
+}
+
 TagsSet TagsSet::from(const MDNode *MD) {
   TagsSet Result;
 
   if (MD == nullptr)
     return Result;
 
-  for (const MDOperand &Op : cast<MDTuple>(MD)->operands()) {
-    StringRef Name = cast<MDString>(Op.get())->getString();
-    Tag *T = Tag::findByName(Name);
-    revng_assert(T != nullptr);
-    Result.Tags.insert(T);
-  }
+  for (const MDOperand &Op : cast<MDTuple>(MD)->operands())
+    Result.Tags.insert(&getTag(Op));
 
   return Result;
 }
 
+bool TagsSet::contains(const MDNode *MD, const Tag &Target) {
+  if (MD == nullptr)
+    return false;
+
+  for (const MDOperand &Op : MD->operands())
+    if (Target.ancestorOf(getTag(Op)))
+      return true;
+
+  return false;
+}
+
+bool TagsSet::containsExactly(const MDNode *MD, const Tag &Target) {
+  if (MD == nullptr)
+    return false;
+
+  bool Found = false;
+  for (const MDOperand &Op : MD->operands()) {
+    const Tag &T = getTag(Op);
+    if (&T == &Target)
+      Found = true;
+    else if (Target.ancestorOf(T))
+      return false;
+  }
+
+  return Found;
+}
+
 } // namespace FunctionTags
 
 const llvm::CallInst *getCallToTagged(const llvm::Value *V,
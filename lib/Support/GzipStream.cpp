@@ -4,7 +4,12 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <algorithm>
+
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include "revng/Support/Assert.h"
@@ -18,6 +23,10 @@ static_assert(OutputBufferSize <= UINT_MAX);
 constexpr int WindowBits = 15 // 2**15 bytes (32k) of window
                            + 16; // Magic offset for gzip
 
+/// Inputs larger than this are split in blocks of this size, which are
+/// compressed in parallel
+constexpr size_t ParallelBlockSize = 1024 * 1024;
+
 template<int (*Next)(z_stream *, int)>
 static void zlibCopyStream(z_stream &Stream,
                            llvm::raw_ostream &OutputOS,
@@ -47,6 +56,12 @@ static void zlibCopyStream(z_stream &Stream,
     // Compute bytes consumed
     RemainingInput -= InputSize - Stream.avail_in;
 
+    // A gzip file can be made of multiple members, start decoding the next one
+    if constexpr (Next == &inflate) {
+      if (RC == Z_STREAM_END and RemainingInput > 0)
+        revng_assert(inflateReset(&Stream) == Z_OK);
+    }
+
     if (Stream.avail_out == 0) {
       // Empty the buffer
       OutputOS.write(OutBufferPtr, OutBuffer.size());
@@ -79,10 +94,9 @@ static void zlibCopyStream(z_stream &Stream,
   OutputOS.flush();
 }
 
-void gzipCompress(llvm::raw_ostream &OutputOS,
-                  llvm::ArrayRef<uint8_t> InputBuffer,
-                  int CompressionLevel) {
-  revng_assert(CompressionLevel >= 1 and CompressionLevel <= 9);
+static void gzipCompressSerial(llvm::raw_ostream &OutputOS,
+                               llvm::ArrayRef<uint8_t> InputBuffer,
+                               int CompressionLevel) {
   z_stream Stream = { .zalloc = Z_NULL, .zfree = Z_NULL, .opaque = Z_NULL };
 
   int Strategy = Z_DEFAULT_STRATEGY;
@@ -99,6 +113,42 @@ void gzipCompress(llvm::raw_ostream &OutputOS,
   revng_assert(deflateEnd(&Stream) == Z_OK);
 }
 
+void gzipCompress(llvm::raw_ostream &OutputOS,
+                  llvm::ArrayRef<uint8_t> InputBuffer,
+                  int CompressionLevel) {
+  revng_assert(CompressionLevel >= 1 and CompressionLevel <= 9);
+
+  if (InputBuffer.size() <= 2 * ParallelBlockSize) {
+    gzipCompressSerial(OutputOS, InputBuffer, CompressionLevel);
+    return;
+  }
+
+  // Compress each block as a separate gzip member: the concatenation is still
+  // a valid gzip file. This costs a few bytes per block and a slightly worse
+  // ratio, since blocks do not share the dictionary.
+  size_t BlocksCount = (InputBuffer.size() + ParallelBlockSize - 1)
+                       / ParallelBlockSize;
+  std::vector<llvm::SmallVector<char, 0>> Blocks(BlocksCount);
+  {
+    llvm::ThreadPool Pool(llvm::hardware_concurrency());
+    for (size_t I = 0; I < BlocksCount; ++I) {
+      Pool.async([&, I]() {
+        size_t Offset = I * ParallelBlockSize;
+        size_t Size = std::min(ParallelBlockSize, InputBuffer.size() - Offset);
+        llvm::raw_svector_ostream BlockOS(Blocks[I]);
+        gzipCompressSerial(BlockOS,
+                           InputBuffer.slice(Offset, Size),
+                           CompressionLevel);
+      });
+    }
+    Pool.wait();
+  }
+
+  for (const llvm::SmallVector<char, 0> &Block : Blocks)
+    OutputOS.write(Block.data(), Block.size());
+  OutputOS.flush();
+}
+
 void gzipDecompress(llvm::raw_ostream &OutputOS,
                     llvm::ArrayRef<uint8_t> InputBuffer) {
   z_stream Stream = { .zalloc = Z_NULL, .zfree = Z_NULL, .opaque = Z_NULL };
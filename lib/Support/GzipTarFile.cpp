@@ -10,11 +10,14 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include "revng/Support/Debug.h"
 #include "revng/Support/GzipStream.h"
 #include "revng/Support/GzipTarFile.h"
+#include "revng/Support/ZstdStream.h"
 
 #include "archive.h"
 #include "archive_entry.h"
@@ -129,15 +132,34 @@ static llvm::SmallString<BlockSize * 3> writePaxHeader(llvm::StringRef Path,
   return Result;
 }
 
-static void
-writeFileHeader(llvm::raw_ostream &OS, llvm::StringRef Path, size_t Size) {
+using revng::TarCompression;
+
+static void compress(llvm::raw_ostream &OS,
+                     llvm::ArrayRef<char> Data,
+                     TarCompression Compression) {
+  switch (Compression) {
+  case TarCompression::Gzip:
+    return gzipCompress(OS, Data);
+  case TarCompression::Zstd:
+    return zstdCompress(OS, Data);
+  }
+
+  revng_abort();
+}
+
+static void writeFileHeader(llvm::raw_ostream &OS,
+                            llvm::StringRef Path,
+                            size_t Size,
+                            TarCompression Compression) {
   llvm::SmallString<BlockSize * 3> FileHeader = writePaxHeader(Path, Size);
-  gzipCompress(OS, { FileHeader.data(), FileHeader.size() });
+  compress(OS, { FileHeader.data(), FileHeader.size() }, Compression);
 }
 
-static void compressedPadding(llvm::raw_ostream &OS, size_t Size) {
+static void compressedPadding(llvm::raw_ostream &OS,
+                              size_t Size,
+                              TarCompression Compression) {
   llvm::SmallVector<char> Buffer(Size, '\0');
-  return gzipCompress(OS, { Buffer.data(), Buffer.size() });
+  return compress(OS, { Buffer.data(), Buffer.size() }, Compression);
 }
 
 namespace revng {
@@ -149,33 +171,114 @@ OffsetDescriptor GzipTarWriter::append(llvm::StringRef Path,
   revng_assert(not Filenames.contains(Path));
 
   OffsetDescriptor Result = { .Start = OS->tell() };
-  writeFileHeader(*OS, Path, Data.size());
+  writeFileHeader(*OS, Path, Data.size(), Compression);
 
   Result.DataStart = OS->tell();
-  gzipCompress(*OS, { Data.data(), Data.size() });
+  compress(*OS, Data, Compression);
 
   Result.PaddingStart = OS->tell();
   if (size_t Padding = computePadding(Data.size()); Padding % BlockSize != 0)
-    compressedPadding(*OS, Padding);
+    compressedPadding(*OS, Padding, Compression);
 
   Result.End = OS->tell();
   Filenames.insert(Path);
   return Result;
 }
 
+std::vector<OffsetDescriptor>
+GzipTarWriter::appendAll(llvm::ArrayRef<File> Files) {
+  revng_assert(OS != nullptr);
+
+  // The compressed form of a file, before being written to the archive
+  struct CompressedFile {
+    llvm::SmallVector<char, 0> Header;
+    llvm::SmallVector<char, 0> Data;
+    llvm::SmallVector<char, 0> Padding;
+  };
+
+  // Compress a batch at a time, to bound the memory holding compressed files
+  // that have not been written yet
+  unsigned ThreadsCount = llvm::hardware_concurrency().compute_thread_count();
+  size_t BatchSize = 4 * std::max(ThreadsCount, 1U);
+
+  std::vector<OffsetDescriptor> Result;
+  Result.reserve(Files.size());
+  llvm::ThreadPool Pool(llvm::hardware_concurrency());
+  for (size_t BatchStart = 0; BatchStart < Files.size();
+       BatchStart += BatchSize) {
+    llvm::ArrayRef<File> Batch = Files.slice(BatchStart).take_front(BatchSize);
+
+    std::vector<CompressedFile> Compressed(Batch.size());
+    for (size_t I = 0; I < Batch.size(); ++I) {
+      Pool.async([this, &Batch, &Compressed, I]() {
+        const File &Input = Batch[I];
+        CompressedFile &Output = Compressed[I];
+
+        llvm::raw_svector_ostream HeaderOS(Output.Header);
+        writeFileHeader(HeaderOS, Input.Name, Input.Data.size(), Compression);
+
+        llvm::raw_svector_ostream DataOS(Output.Data);
+        compress(DataOS, Input.Data, Compression);
+
+        size_t Padding = computePadding(Input.Data.size());
+        if (Padding % BlockSize != 0) {
+          llvm::raw_svector_ostream PaddingOS(Output.Padding);
+          compressedPadding(PaddingOS, Padding, Compression);
+        }
+      });
+    }
+    Pool.wait();
+
+    for (size_t I = 0; I < Batch.size(); ++I) {
+      revng_assert(not Filenames.contains(Batch[I].Name));
+      const CompressedFile &File = Compressed[I];
+
+      OffsetDescriptor Offsets = { .Start = OS->tell() };
+      OS->write(File.Header.data(), File.Header.size());
+      Offsets.DataStart = OS->tell();
+      OS->write(File.Data.data(), File.Data.size());
+      Offsets.PaddingStart = OS->tell();
+      OS->write(File.Padding.data(), File.Padding.size());
+      Offsets.End = OS->tell();
+
+      Filenames.insert(Batch[I].Name);
+      Result.push_back(Offsets);
+    }
+  }
+
+  return Result;
+}
+
 void GzipTarWriter::close() {
   revng_assert(OS != nullptr);
   // The tar archive needs to be ended with two blocks of zeros
-  compressedPadding(*OS, BlockSize * 2);
+  compressedPadding(*OS, BlockSize * 2, Compression);
   OS->flush();
   OS = nullptr;
 }
 
+llvm::SmallVector<char, 0> readGzipTarEntry(llvm::ArrayRef<char> Archive,
+                                            size_t DataStart,
+                                            size_t PaddingStart) {
+  revng_check(DataStart <= PaddingStart and PaddingStart <= Archive.size());
+
+  llvm::SmallVector<char, 0> Result;
+  llvm::raw_svector_ostream OS(Result);
+  llvm::ArrayRef<char> Data = Archive.slice(DataStart,
+                                            PaddingStart - DataStart);
+  if (isZstdFrame(Data))
+    zstdDecompress(OS, Data);
+  else
+    gzipDecompress(OS, Data);
+  return Result;
+}
+
 GzipTarReader::GzipTarReader(llvm::ArrayRef<char> Ref) {
   Archive = archive_read_new();
   revng_assert(Archive != NULL);
 
   revng_assert(archive_read_support_filter_gzip(Archive) == ARCHIVE_OK);
+  revng_assert(archive_read_support_filter_zstd(Archive) == ARCHIVE_OK);
   revng_assert(archive_read_support_format_tar(Archive) == ARCHIVE_OK);
 
   int EC = archive_read_open_memory(Archive, Ref.data(), Ref.size());
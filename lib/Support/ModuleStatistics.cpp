@@ -4,8 +4,11 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <vector>
+
 #include "llvm/IR/DebugInfo.h"
 #include "llvm/IR/TypeFinder.h"
+#include "llvm/Support/Parallel.h"
 
 #include "revng/ADT/ZipMapIterator.h"
 #include "revng/Support/IRHelpers.h"
@@ -95,12 +98,17 @@ void ModuleStatistics::dump(llvm::raw_ostream &Output,
 
   emitIndentation(Output, Indent);
   Output << "AllFunctions:\n";
-  AllFunctions.dump(Output, Indent + 1, HasOld ? &Old->AllFunctions : nullptr);
+  const FunctionClass &AllFunctions = Functions.AllFunctions;
+  const FunctionClass *OldAllFunctions = nullptr;
+  if (HasOld)
+    OldAllFunctions = &Old->Functions.AllFunctions;
+  AllFunctions.dump(Output, Indent + 1, OldAllFunctions);
 
   emitIndentation(Output, Indent);
   Output << "TaggedFunctions:\n";
   for (auto [NewEntry, OldEntry] :
-       zipmap_range(TaggedFunctions, Old->TaggedFunctions)) {
+       zipmap_range(Functions.TaggedFunctions,
+                    Old->Functions.TaggedFunctions)) {
     const FunctionTags::Tag *Tag = nullptr;
     static const FunctionClass Empty;
     const FunctionClass *NewClass = nullptr;
@@ -130,6 +138,47 @@ void ModuleStatistics::dump(llvm::raw_ostream &Output,
 #undef EMIT
 }
 
+void FunctionsStatistics::process(const llvm::Function &F) {
+  AllFunctions.process(F);
+
+  for (const FunctionTags::Tag *FunctionTag : FunctionTags::TagsSet::from(&F))
+    TaggedFunctions[FunctionTag].process(F);
+}
+
+FunctionsStatistics FunctionsStatistics::analyze(const llvm::Module &M) {
+  FunctionsStatistics Result;
+  if (M.empty())
+    return Result;
+
+  std::vector<const Function *> ToProcess;
+  ToProcess.reserve(M.size());
+  for (const Function &F : M)
+    ToProcess.push_back(&F);
+
+  // Process the first function right away: looking up the tags the first time
+  // might register the metadata kind in the context, which must not happen
+  // concurrently
+  Result.process(*ToProcess.front());
+
+  // Chunks have a fixed size, so that the result (in particular, the floating
+  // point rounding of the merged statistics) doesn't depend on the number of
+  // threads
+  constexpr size_t ChunkSize = 256;
+  size_t ChunksCount = (ToProcess.size() - 1 + ChunkSize - 1) / ChunkSize;
+  std::vector<FunctionsStatistics> Chunks(ChunksCount);
+  llvm::parallelForEachN(0, ChunksCount, [&](size_t Index) {
+    size_t Begin = 1 + Index * ChunkSize;
+    size_t End = std::min(Begin + ChunkSize, ToProcess.size());
+    for (size_t I = Begin; I < End; ++I)
+      Chunks[Index].process(*ToProcess[I]);
+  });
+
+  for (const FunctionsStatistics &Chunk : Chunks)
+    Result.merge(Chunk);
+
+  return Result;
+}
+
 ModuleStatistics ModuleStatistics::analyze(const llvm::Module &M) {
   using namespace FunctionTags;
 
@@ -156,12 +205,7 @@ ModuleStatistics ModuleStatistics::analyze(const llvm::Module &M) {
   }
 
   // Measure functions
-  for (const Function &F : M) {
-    Result.AllFunctions.process(F);
-
-    for (const Tag *FunctionTag : TagsSet::from(&F))
-      Result.TaggedFunctions[FunctionTag].process(F);
-  }
+  Result.Functions = FunctionsStatistics::analyze(M);
 
   // Measure types
   {
@@ -0,0 +1,149 @@
+/// \file PerfCounters.cpp
+/// Collection of hardware performance counters through perf_event.
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <array>
+#include <atomic>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "revng/Support/CommandLine.h"
+#include "revng/Support/Debug.h"
+#include "revng/Support/PerfCounters.h"
+
+namespace cl = llvm::cl;
+
+static cl::opt<bool> CollectPerfCounters("perf-counters",
+                                         cl::desc("collect hardware "
+                                                  "performance counters "
+                                                  "(cycles, instructions, "
+                                                  "cache and branch misses) "
+                                                  "for the profiled regions"),
+                                         cl::cat(MainCategory),
+                                         cl::init(false));
+
+static Logger<> Log("perf-counters");
+
+/// Set the first time opening the counters fails, to avoid retrying on each
+/// region
+static std::atomic<bool> Unavailable = false;
+
+#if defined(__linux__)
+
+namespace {
+
+/// The counters of a thread, as a single perf_event group, so that they are
+/// read all at once
+class ThreadCounters {
+private:
+  static constexpr std::array<uint64_t, 4> Events = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES,
+  };
+
+private:
+  std::array<int, Events.size()> FDs;
+
+public:
+  ThreadCounters() {
+    FDs.fill(-1);
+
+    for (size_t I = 0; I < Events.size(); I++) {
+      struct perf_event_attr Attributes = {};
+      Attributes.size = sizeof(Attributes);
+      Attributes.type = PERF_TYPE_HARDWARE;
+      Attributes.config = Events[I];
+      Attributes.read_format = PERF_FORMAT_GROUP;
+      Attributes.exclude_kernel = 1;
+      Attributes.exclude_hv = 1;
+      Attributes.disabled = I == 0 ? 1 : 0;
+
+      // Monitor the calling thread, on any CPU
+      pid_t Thread = 0;
+      int CPU = -1;
+      int GroupFD = FDs[0];
+      long Result = syscall(SYS_perf_event_open,
+                            &Attributes,
+                            Thread,
+                            CPU,
+                            GroupFD,
+                            0);
+      if (Result < 0) {
+        revng_log(Log, "Cannot open hardware performance counters");
+        Unavailable = true;
+        close();
+        return;
+      }
+
+      FDs[I] = static_cast<int>(Result);
+    }
+
+    ioctl(FDs[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(FDs[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+
+  ~ThreadCounters() { close(); }
+
+  ThreadCounters(const ThreadCounters &) = delete;
+  ThreadCounters &operator=(const ThreadCounters &) = delete;
+
+public:
+  revng::PerfCounterValues read() const {
+    if (FDs[0] < 0)
+      return {};
+
+    // With PERF_FORMAT_GROUP, the number of events followed by their values
+    std::array<uint64_t, 1 + Events.size()> Buffer = {};
+    ssize_t Size = sizeof(Buffer);
+    if (::read(FDs[0], Buffer.data(), Size) != Size)
+      return {};
+
+    return { Buffer[1], Buffer[2], Buffer[3], Buffer[4] };
+  }
+
+private:
+  void close() {
+    for (int &FD : FDs) {
+      if (FD >= 0)
+        ::close(FD);
+      FD = -1;
+    }
+  }
+};
+
+} // namespace
+
+static revng::PerfCounterValues readThreadCounters() {
+  static thread_local ThreadCounters Counters;
+  return Counters.read();
+}
+
+#else
+
+static revng::PerfCounterValues readThreadCounters() {
+  Unavailable = true;
+  return {};
+}
+
+#endif
+
+bool revng::PerfCounters::isEnabled() {
+  return CollectPerfCounters and not Unavailable;
+}
+
+revng::PerfCounterValues revng::PerfCounters::read() {
+  if (not isEnabled())
+    return {};
+
+  return readThreadCounters();
+}
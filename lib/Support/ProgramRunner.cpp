@@ -6,24 +6,243 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <cerrno>
 #include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
 
 #include "revng/Support/Assert.h"
+#include "revng/Support/CommandLine.h"
 #include "revng/Support/Debug.h"
 #include "revng/Support/PathList.h"
 #include "revng/Support/ProgramRunner.h"
 
 using namespace llvm;
 
+extern char **environ;
+
 static Logger<> Log("program-runner");
 
+static cl::opt<bool> UseHelpers("program-runner-helpers",
+                                cl::desc("run revng commands invoked by "
+                                         "the C++ code in persistent helper "
+                                         "processes"),
+                                cl::cat(MainCategory),
+                                cl::init(true));
+
 ProgramRunner Runner;
 
+namespace {
+
+/// A `revng helper-server` process, see helper_server.py for the protocol
+class HelperProcess {
+private:
+  /// The file descriptor of the channel in the helper
+  static constexpr int ChildChannel = 3;
+
+private:
+  pid_t PID = -1;
+  int Channel = -1;
+  std::string Pending;
+
+public:
+  HelperProcess() = default;
+  ~HelperProcess() {
+    // Closing the channel makes the helper exit
+    if (Channel >= 0)
+      close(Channel);
+    if (PID > 0)
+      waitpid(PID, nullptr, 0);
+  }
+
+  HelperProcess(const HelperProcess &) = delete;
+  HelperProcess &operator=(const HelperProcess &) = delete;
+
+public:
+  static std::unique_ptr<HelperProcess> spawn(const std::string &Program) {
+    int Sockets[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, Sockets) != 0)
+      return nullptr;
+
+    auto Result = std::make_unique<HelperProcess>();
+    Result->Channel = Sockets[0];
+
+    // Make sure the end for the helper does not collide with ChildChannel,
+    // otherwise dup2 would not clear its FD_CLOEXEC flag
+    int ChildEnd = fcntl(Sockets[1], F_DUPFD_CLOEXEC, ChildChannel + 1);
+    close(Sockets[1]);
+    if (ChildEnd < 0)
+      return nullptr;
+
+    posix_spawn_file_actions_t Actions;
+    posix_spawn_file_actions_init(&Actions);
+    posix_spawn_file_actions_adddup2(&Actions, ChildEnd, ChildChannel);
+
+    std::string Command = "helper-server";
+    char *Arguments[] = { const_cast<char *>(Program.c_str()),
+                          Command.data(),
+                          nullptr };
+    int Error = posix_spawn(&Result->PID,
+                            Program.c_str(),
+                            &Actions,
+                            nullptr,
+                            Arguments,
+                            environ);
+    posix_spawn_file_actions_destroy(&Actions);
+    close(ChildEnd);
+
+    if (Error != 0) {
+      Result->PID = -1;
+      return nullptr;
+    }
+
+    revng_log(Log, "Started helper " << Result->PID << " for " << Program);
+    return Result;
+  }
+
+  /// \return the exit code of the command, or std::nullopt if the helper died
+  std::optional<int> request(ArrayRef<std::string> Args) {
+    SmallString<128> WorkingDirectory;
+    if (sys::fs::current_path(WorkingDirectory))
+      return std::nullopt;
+
+    json::Array Arguments;
+    for (const std::string &Argument : Args)
+      Arguments.push_back(Argument);
+    json::Value Request = json::Object{
+      { "arguments", std::move(Arguments) },
+      { "cwd", WorkingDirectory.str() },
+    };
+
+    std::string Line;
+    raw_string_ostream Stream(Line);
+    Stream << Request << "\n";
+    Stream.flush();
+
+    if (not sendAll(Line))
+      return std::nullopt;
+
+    auto MaybeResponse = receiveLine();
+    if (not MaybeResponse)
+      return std::nullopt;
+
+    auto MaybeParsed = json::parse(*MaybeResponse);
+    if (not MaybeParsed) {
+      consumeError(MaybeParsed.takeError());
+      return std::nullopt;
+    }
+
+    const json::Object *Response = MaybeParsed->getAsObject();
+    if (Response == nullptr)
+      return std::nullopt;
+
+    auto ExitCode = Response->getInteger("exit_code");
+    if (not ExitCode)
+      return std::nullopt;
+
+    return static_cast<int>(*ExitCode);
+  }
+
+private:
+  bool sendAll(StringRef Data) {
+    while (not Data.empty()) {
+      // MSG_NOSIGNAL: if the helper died, fail instead of getting SIGPIPE
+      ssize_t Sent = send(Channel, Data.data(), Data.size(), MSG_NOSIGNAL);
+      if (Sent < 0 and errno == EINTR)
+        continue;
+      if (Sent <= 0)
+        return false;
+      Data = Data.drop_front(Sent);
+    }
+    return true;
+  }
+
+  std::optional<std::string> receiveLine() {
+    while (true) {
+      size_t End = Pending.find('\n');
+      if (End != std::string::npos) {
+        std::string Result = Pending.substr(0, End);
+        Pending.erase(0, End + 1);
+        return Result;
+      }
+
+      char Buffer[256];
+      ssize_t Received = recv(Channel, Buffer, sizeof(Buffer), 0);
+      if (Received < 0 and errno == EINTR)
+        continue;
+      if (Received <= 0)
+        return std::nullopt;
+      Pending.append(Buffer, Received);
+    }
+  }
+};
+
+/// The idle helpers, by program. A helper serves a single request at a time,
+/// concurrent requests get a helper each.
+class HelperPool {
+private:
+  std::mutex Mutex;
+  StringMap<std::vector<std::unique_ptr<HelperProcess>>> Idle;
+  bool Broken = false;
+
+public:
+  static HelperPool &get() {
+    static HelperPool Instance;
+    return Instance;
+  }
+
+public:
+  std::optional<int> run(const std::string &Program,
+                         ArrayRef<std::string> Args) {
+    std::unique_ptr<HelperProcess> Helper;
+    {
+      std::lock_guard Lock(Mutex);
+      if (Broken)
+        return std::nullopt;
+
+      auto &Helpers = Idle[Program];
+      if (not Helpers.empty()) {
+        Helper = std::move(Helpers.back());
+        Helpers.pop_back();
+      }
+    }
+
+    if (Helper == nullptr)
+      Helper = HelperProcess::spawn(Program);
+
+    std::optional<int> Result;
+    if (Helper != nullptr)
+      Result = Helper->request(Args);
+
+    std::lock_guard Lock(Mutex);
+    if (Result) {
+      Idle[Program].push_back(std::move(Helper));
+    } else {
+      // Don't insist: from now on, use a new process for each invocation
+      revng_log(Log, "Cannot use a helper for " << Program);
+      Broken = true;
+    }
+
+    return Result;
+  }
+};
+
+} // namespace
+
 ProgramRunner::ProgramRunner() {
   using namespace llvm::sys::path;
   llvm::SmallString<128> BinPath;
@@ -40,24 +259,25 @@ ProgramRunner::ProgramRunner() {
     Paths.push_back(BasePath.str());
 }
 
-bool ProgramRunner::isProgramAvailable(llvm::StringRef ProgramName) {
+std::optional<std::string>
+ProgramRunner::findProgram(llvm::StringRef ProgramName) {
   llvm::SmallVector<llvm::StringRef, 64> PathsRef;
   for (const std::string &Path : Paths)
     PathsRef.push_back(llvm::StringRef(Path));
 
   auto MaybeProgramPath = llvm::sys::findProgramByName(ProgramName, PathsRef);
   if (!MaybeProgramPath)
-    return false;
-  return true;
+    return std::nullopt;
+  return *MaybeProgramPath;
+}
+
+bool ProgramRunner::isProgramAvailable(llvm::StringRef ProgramName) {
+  return findProgram(ProgramName).has_value();
 }
 
 int ProgramRunner::run(llvm::StringRef ProgramName,
                        ArrayRef<std::string> Args) {
-  llvm::SmallVector<llvm::StringRef, 64> PathsRef;
-  for (const std::string &Path : Paths)
-    PathsRef.push_back(llvm::StringRef(Path));
-
-  auto MaybeProgramPath = llvm::sys::findProgramByName(ProgramName, PathsRef);
+  auto MaybeProgramPath = findProgram(ProgramName);
   revng_assert(not Paths.empty());
   revng_assert(MaybeProgramPath,
                (ProgramName + " was not found in " + getenv("PATH"))
@@ -78,3 +298,22 @@ int ProgramRunner::run(llvm::StringRef ProgramName,
 
   return ExitCode;
 }
+
+int ProgramRunner::runRevngCommand(llvm::StringRef ProgramName,
+                                   ArrayRef<std::string> Args) {
+  if (UseHelpers) {
+    if (auto MaybeProgramPath = findProgram(ProgramName)) {
+      if (Log.isEnabled()) {
+        Log << "Running revng";
+        for (const std::string &Arg : Args)
+          Log << " " << Arg;
+        Log << " in a helper" << DoLog;
+      }
+
+      if (auto ExitCode = HelperPool::get().run(*MaybeProgramPath, Args))
+        return *ExitCode;
+    }
+  }
+
+  return run(ProgramName, Args);
+}
@@ -15,3 +15,43 @@ cl::opt<bool> Statistics("statistics",
                                   "SIGINT. Use "
                                   "this argument, ignore -stats."),
                          cl::cat(MainCategory));
+
+RegisteredStatistics::RegisteredStatistics() {
+  StatisticsRegistry::get().add(this);
+}
+
+RegisteredStatistics::~RegisteredStatistics() {
+  StatisticsRegistry::get().remove(this);
+}
+
+StatisticsRegistry &StatisticsRegistry::get() {
+  static StatisticsRegistry Instance;
+  return Instance;
+}
+
+void StatisticsRegistry::add(const RegisteredStatistics *Entry) {
+  std::lock_guard Lock(Mutex);
+  Registry.push_back(Entry);
+}
+
+void StatisticsRegistry::remove(const RegisteredStatistics *Entry) {
+  std::lock_guard Lock(Mutex);
+  std::erase(Registry, Entry);
+}
+
+void StatisticsRegistry::writeJSON(llvm::raw_ostream &Output) {
+  std::lock_guard Lock(Mutex);
+  llvm::json::OStream JSON(Output, 2);
+  JSON.object([&] {
+    for (const RegisteredStatistics *Entry : Registry) {
+      // Anonymous statistics are meant to be inspected by their owner
+      if (Entry->name().empty())
+        continue;
+
+      JSON.attributeBegin(Entry->name());
+      Entry->toJSON(JSON);
+      JSON.attributeEnd();
+    }
+  });
+  Output << "\n";
+}
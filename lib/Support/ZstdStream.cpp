@@ -0,0 +1,93 @@
+/// \file ZstdStream.cpp
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <algorithm>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "revng/Support/Assert.h"
+#include "revng/Support/ZstdStream.h"
+
+#include "zstd.h"
+
+/// Inputs larger than this are compressed by multiple zstd workers
+constexpr size_t ParallelThreshold = 2 * 1024 * 1024;
+
+void zstdCompress(llvm::raw_ostream &OutputOS,
+                  llvm::ArrayRef<uint8_t> InputBuffer,
+                  int CompressionLevel) {
+  revng_assert(CompressionLevel >= ZSTD_minCLevel()
+               and CompressionLevel <= ZSTD_maxCLevel());
+
+  ZSTD_CCtx *Context = ZSTD_createCCtx();
+  revng_assert(Context != nullptr);
+
+  size_t RC = ZSTD_CCtx_setParameter(Context,
+                                     ZSTD_c_compressionLevel,
+                                     CompressionLevel);
+  revng_assert(not ZSTD_isError(RC));
+
+  if (InputBuffer.size() > ParallelThreshold) {
+    // This fails if libzstd has been built without multithreading support,
+    // in which case we just compress on this thread
+    unsigned Threads = llvm::hardware_concurrency().compute_thread_count();
+    ZSTD_CCtx_setParameter(Context, ZSTD_c_nbWorkers, Threads);
+  }
+
+  llvm::SmallVector<char, 0> Output;
+  Output.resize_for_overwrite(ZSTD_compressBound(InputBuffer.size()));
+  size_t Size = ZSTD_compress2(Context,
+                               Output.data(),
+                               Output.size(),
+                               InputBuffer.data(),
+                               InputBuffer.size());
+  revng_assert(not ZSTD_isError(Size));
+  ZSTD_freeCCtx(Context);
+
+  OutputOS.write(Output.data(), Size);
+  OutputOS.flush();
+}
+
+void zstdDecompress(llvm::raw_ostream &OutputOS,
+                    llvm::ArrayRef<uint8_t> InputBuffer) {
+  ZSTD_DCtx *Context = ZSTD_createDCtx();
+  revng_assert(Context != nullptr);
+
+  llvm::SmallVector<char, 0> OutBuffer;
+  OutBuffer.resize_for_overwrite(ZSTD_DStreamOutSize());
+
+  // Concatenated frames are decoded one after the other
+  ZSTD_inBuffer Input = { InputBuffer.data(), InputBuffer.size(), 0 };
+  size_t RC = 0;
+  while (Input.pos < Input.size) {
+    ZSTD_outBuffer Output = { OutBuffer.data(), OutBuffer.size(), 0 };
+    RC = ZSTD_decompressStream(Context, &Output, &Input);
+    revng_assert(not ZSTD_isError(RC));
+    OutputOS.write(OutBuffer.data(), Output.pos);
+  }
+
+  // Flush the data which has been decoded but not returned yet
+  while (RC != 0) {
+    ZSTD_outBuffer Output = { OutBuffer.data(), OutBuffer.size(), 0 };
+    RC = ZSTD_decompressStream(Context, &Output, &Input);
+    revng_assert(not ZSTD_isError(RC));
+    revng_assert(Output.pos > 0, "Truncated zstd frame");
+    OutputOS.write(OutBuffer.data(), Output.pos);
+  }
+
+  ZSTD_freeDCtx(Context);
+  OutputOS.flush();
+}
+
+bool isZstdFrame(llvm::ArrayRef<char> Buffer) {
+  // The magic number of zstd frames, in little endian
+  static constexpr char Magic[] = { '\x28', '\xb5', '\x2f', '\xfd' };
+  return Buffer.size() >= sizeof(Magic)
+         and std::equal(std::begin(Magic), std::end(Magic), Buffer.begin());
+}
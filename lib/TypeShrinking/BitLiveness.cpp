@@ -290,7 +290,6 @@ BitLivenessPass::Result BitLivenessPass::run(llvm::Function &F,
   }
 
   revng_assert(not DataFlowGraph.verify());
-  MFP::Graph<BitLivenessAnalysis> MFPGraph(&DataFlowGraph, MFPRes);
 
   return Result;
 }
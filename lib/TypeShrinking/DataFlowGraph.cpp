@@ -4,8 +4,7 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
-#include <unordered_map>
-
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/IR/InstIterator.h"
 
 #include "revng/TypeShrinking/DataFlowGraph.h"
@@ -16,8 +15,14 @@ namespace TypeShrinking {
 GenericGraph<DataFlowNode> buildDataFlowGraph(Function &F) {
   GenericGraph<DataFlowNode> DataFlowGraph;
 
+  size_t InstructionsCount = F.getInstructionCount();
+  DataFlowGraph.reserve(InstructionsCount);
+
   std::vector<DataFlowNode *> Worklist;
-  std::unordered_map<Instruction *, DataFlowNode *> InstructionNodeMap;
+  Worklist.reserve(InstructionsCount);
+  llvm::DenseMap<Instruction *, DataFlowNode *> InstructionNodeMap;
+  InstructionNodeMap.reserve(InstructionsCount);
+
   // Initialization
   for (Instruction &I : instructions(F)) {
     DataFlowNode Node{ &I };
@@ -29,7 +34,9 @@ GenericGraph<DataFlowNode> buildDataFlowGraph(Function &F) {
   for (auto *DefNode : Worklist) {
     auto *Ins = DefNode->Instruction;
     for (auto &Use : Ins->uses()) {
-      auto *UseNode = InstructionNodeMap.at(cast<Instruction>(Use.getUser()));
+      auto *User = cast<Instruction>(Use.getUser());
+      DataFlowNode *UseNode = InstructionNodeMap.lookup(User);
+      revng_assert(UseNode != nullptr);
       UseNode->addSuccessor(DefNode);
     }
   }
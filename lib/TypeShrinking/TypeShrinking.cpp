@@ -124,6 +124,7 @@ static bool runTypeShrinking(Function &F,
         NewResultSize = NewOperandsSize;
 
       if (NewOperandsSize < OldSize) {
+        HasChanges = true;
         B.SetInsertPoint(I);
 
         // Shrink operands
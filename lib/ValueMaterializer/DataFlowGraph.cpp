@@ -8,6 +8,7 @@
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/SCCIterator.h"
 #include "llvm/IR/Intrinsics.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/GraphWriter.h"
 
 #include "revng/ValueMaterializer/DataFlowGraph.h"
@@ -20,6 +21,32 @@ Logger<> &Log = ValueMaterializerLogger;
 
 const range_size_t MaxMaterializedValues = (1 << 16);
 
+static cl::opt<uint64_t> MaxCost("vm-max-cost",
+                                 cl::desc("maximum number of values a single "
+                                          "value materializer query can "
+                                          "compute, across all the nodes of "
+                                          "the data-flow graph, before giving "
+                                          "up"),
+                                 cl::init(1 << 20));
+
+uint64_t DataFlowGraph::maxMaterializationCost() {
+  return MaxCost;
+}
+
+/// Charge \p Amount to the budget of the current query
+///
+/// \return false if the budget has been exhausted
+static bool consumeCost(uint64_t &RemainingCost, uint64_t Amount) {
+  if (Amount > RemainingCost) {
+    revng_log(Log, "The cost budget of the query is exhausted. Bailing out.");
+    RemainingCost = 0;
+    return false;
+  }
+
+  RemainingCost -= Amount;
+  return true;
+}
+
 template<typename Range>
 using RangeValueType = std::decay_t<decltype(*std::declval<Range>().begin())>;
 
@@ -282,12 +309,12 @@ materialize(MemoryOracle &MO,
 RecursiveCoroutine<std::optional<MaterializedValues>>
 DataFlowGraph::materializeImpl(DataFlowGraph::Node *N,
                                MemoryOracle &MO,
-                               NodeValuesMap &Results) const {
+                               MaterializationState &State) const {
   using namespace llvm;
   using Node = DataFlowGraph::Node;
 
-  auto It = Results.find(N);
-  if (It != Results.end())
+  auto It = State.Results.find(N);
+  if (It != State.Results.end())
     rc_return It->second;
 
   revng_log(Log, "Materializing " << N->valueToString());
@@ -301,8 +328,12 @@ DataFlowGraph::materializeImpl(DataFlowGraph::Node *N,
     rc_return std::nullopt;
   }
 
-  if (N->UseOracle)
-    rc_return{ { ::materialize(*N->OracleRange), {} } };
+  if (N->UseOracle) {
+    MaterializedValues FromOracle = ::materialize(*N->OracleRange);
+    if (not consumeCost(State.RemainingCost, FromOracle.size()))
+      rc_return std::nullopt;
+    rc_return FromOracle;
+  }
 
   MaterializedValues Result;
 
@@ -312,10 +343,13 @@ DataFlowGraph::materializeImpl(DataFlowGraph::Node *N,
 
     // For phi-likes, merge all the results of the successors
     for (Node *Successor : N->successors()) {
-      auto MaybeMaterialized = rc_recur materializeImpl(Successor, MO, Results);
+      auto MaybeMaterialized = rc_recur materializeImpl(Successor, MO, State);
       if (not MaybeMaterialized)
         rc_return std::nullopt;
 
+      if (not consumeCost(State.RemainingCost, MaybeMaterialized->size()))
+        rc_return std::nullopt;
+
       for (MaterializedValue &Value : *MaybeMaterialized)
         Result.push_back(Value);
     }
@@ -332,7 +366,7 @@ DataFlowGraph::materializeImpl(DataFlowGraph::Node *N,
 
     // Build vector of ranges
     for (Node *Successor : N->successors()) {
-      auto MaybeMaterialized = rc_recur materializeImpl(Successor, MO, Results);
+      auto MaybeMaterialized = rc_recur materializeImpl(Successor, MO, State);
 
       if (not MaybeMaterialized)
         rc_return std::nullopt;
@@ -362,6 +396,9 @@ DataFlowGraph::materializeImpl(DataFlowGraph::Node *N,
       rc_return{};
     }
 
+    if (not consumeCost(State.RemainingCost, *ToMaterialize))
+      rc_return std::nullopt;
+
     for (SmallVector<MaterializedValue, 2> &Operands :
          allCombinations(Ranges)) {
 
@@ -417,6 +454,9 @@ DataFlowGraph::materializeImpl(DataFlowGraph::Node *N,
     }
   }
 
+  // Nodes can be reached through multiple paths, record the result
+  State.Results[N] = Result;
+
   rc_return Result;
 }
 
@@ -6,10 +6,16 @@
 
 #include "llvm/Support/GenericDomTreeConstruction.h"
 
+#include "revng/Support/Deadline.h"
 #include "revng/Support/Debug.h"
 #include "revng/ValueMaterializer/ValueMaterializer.h"
 
 void ValueMaterializer::run() {
+  // Leave Values empty, as when the value cannot be materialized (e.g., an
+  // indirect jump remains unresolved)
+  if (revng::deadlineExpired("the value materializer"))
+    return;
+
   revng_log(ValueMaterializerLogger,
             "Evaluating " << getName(V) << " using " << getName(Context)
                           << " as context");
@@ -41,6 +47,9 @@ void ValueMaterializer::run() {
 
   electMaterializationStartingPoints();
 
+  if (revng::deadlineExpired("the value materializer"))
+    return;
+
   Values = DataFlowGraph.materialize(DataFlowGraph.getEntryNode(), MO);
 }
 
@@ -4,6 +4,9 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/STLExtras.h"
+
 #include "revng/EarlyFunctionAnalysis/CFGHelpers.h"
 #include "revng/EarlyFunctionAnalysis/ControlFlowGraph.h"
 #include "revng/Model/Binary.h"
@@ -48,21 +51,19 @@ static void analyzeBasicBlocks(yield::Function &Function,
                                const efa::ControlFlowGraph &Metadata,
                                const model::Binary &Binary) {
   // Gather all the basic blocks that only have a single predecessor.
-  std::map<BasicBlockID, std::optional<BasicBlockID>> Predecessors;
-
-  for (const efa::BasicBlock &BasicBlock : Metadata.Blocks()) {
-    auto [It, Success] = Predecessors.try_emplace(BasicBlock.ID());
-    revng_assert(Success,
-                 "Duplicate basic blocks in a `SortedVector`? "
-                 "Something is clearly very wrong.");
-  }
+  efa::BlockNumbering Numbering = Metadata.numbering();
+  std::vector<std::optional<uint32_t>> Predecessors(Numbering.size());
+  llvm::BitVector Excluded(Numbering.size());
 
   // Remove the entry block from the analysis - its label is always required.
-  size_t RemovedCount = Predecessors.erase(BasicBlockID(Function.Entry()));
-  revng_assert(RemovedCount == 1,
+  auto EntryNumber = Numbering.find(BasicBlockID(Function.Entry()));
+  revng_assert(EntryNumber.has_value(),
                "No basic block at the function entry address!");
+  Excluded.set(*EntryNumber);
 
-  for (const efa::BasicBlock &BasicBlock : Metadata.Blocks()) {
+  for (const auto &Enumerated : llvm::enumerate(Metadata.Blocks())) {
+    const efa::BasicBlock &BasicBlock = Enumerated.value();
+    uint32_t Number = Enumerated.index();
     for (const auto &Edge : BasicBlock.Successors()) {
       auto [NextBlock, _] = efa::parseSuccessor(*convert(Edge).get(),
                                                 BasicBlock.nextBlock(),
@@ -72,34 +73,33 @@ static void analyzeBasicBlocks(yield::Function &Function,
         continue;
       }
 
-      auto Iterator = Predecessors.find(NextBlock);
-      if (Iterator != Predecessors.end()) {
-        if (Iterator->second.has_value()) {
+      auto NextNumber = Numbering.find(NextBlock);
+      if (NextNumber.has_value() and not Excluded.test(*NextNumber)) {
+        if (Predecessors[*NextNumber].has_value()) {
           // This basic block already has a predecessor, remove it.
-          Predecessors.erase(Iterator);
+          Excluded.set(*NextNumber);
         } else {
           // First predecessor found - save it.
-          Iterator->second = BasicBlock.ID();
+          Predecessors[*NextNumber] = Number;
         }
       }
     }
   }
 
   // Save the results of the analysis
-  for (auto [CurrentAddress, PredecessorAddress] : Predecessors) {
-    if (PredecessorAddress.has_value()) {
-      auto Current = Metadata.Blocks().find(CurrentAddress);
-      revng_assert(Current != Metadata.Blocks().end());
+  auto Blocks = Metadata.Blocks().begin();
+  for (uint32_t Number = 0; Number < Numbering.size(); ++Number) {
+    if (Excluded.test(Number) or not Predecessors[Number].has_value())
+      continue;
 
-      auto Predecessor = Metadata.Blocks().find(*PredecessorAddress);
-      revng_assert(Predecessor != Metadata.Blocks().end());
+    const efa::BasicBlock &Current = Blocks[Number];
+    const efa::BasicBlock &Predecessor = Blocks[*Predecessors[Number]];
 
-      auto CurrentBlock = Function.Blocks().find(CurrentAddress);
-      revng_assert(CurrentBlock != Function.Blocks().end());
+    auto CurrentBlock = Function.Blocks().find(Current.ID());
+    revng_assert(CurrentBlock != Function.Blocks().end());
 
-      if (Predecessor->nextBlock() == Current->ID())
-        CurrentBlock->IsLabelAlwaysRequired() = false;
-    }
+    if (Predecessor.nextBlock() == Current.ID())
+      CurrentBlock->IsLabelAlwaysRequired() = false;
   }
 }
 
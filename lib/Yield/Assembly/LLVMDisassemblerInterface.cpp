@@ -4,7 +4,9 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <algorithm>
 #include <map>
+#include <mutex>
 #include <string>
 
 #include "llvm/ADT/StringRef.h"
@@ -104,6 +106,10 @@ DI::LLVMDisassemblerInterface(MetaAddressType::Values AddrType,
     ImmediateStyle = Style::CHexadecimal;
   }
 
+  CurrentFlavor.AddressType = AddrType;
+  CurrentFlavor.AssemblyDialect = AssemblyDialect;
+  CurrentFlavor.ImmediateStyle = ImmediateStyle;
+
   if (ImmediateStyle == Style::Decimal)
     Printer->setPrintImmHex(false);
   else
@@ -203,16 +209,10 @@ makeInvalidInstruction(MetaAddress Where, size_t Size, std::string Reason) {
   return Result;
 }
 
+/// \note the result points into \p Input.
 static llvm::StringRef cleanStringUp(std::string &Input) {
-  Input = llvm::StringRef(Input).trim().str();
-
-  size_t Position = Input.find_first_of('\t');
-  while (Position != std::string::npos) {
-    Input.replace(Position, 1, " ");
-    Position = Input.find_first_of('\t', Position);
-  }
-
-  return Input;
+  std::replace(Input.begin(), Input.end(), '\t', ' ');
+  return llvm::StringRef(Input).trim();
 }
 
 // TODO: this is but a temporary measure. LLVM MCInstPrinter needs to be
@@ -309,13 +309,18 @@ DI::Disassembled DI::parse(const llvm::MCInst &Instruction,
   if (!Mnemonic.has_value())
     Result.Error = "Impossible to detect mnemonic.";
 
-  auto WhitespaceCheck = [](char C) {
-    constexpr llvm::StringRef Whitespaces = " \t\n\v\f\r";
+  constexpr llvm::StringRef Whitespaces = " \t\n\v\f\r";
+  auto WhitespaceCheck = [&Whitespaces](char C) {
     return Whitespaces.contains(C);
   };
 
+  // The characters that end a run of plain text.
+  constexpr llvm::StringRef Special = "<> \t\n\v\f\r";
+
+  // The text can only shrink: drop the markup and keep everything else.
+  Result.Text.reserve(Markup.size());
+
   // Investigate the llvm-provided tags.
-  constexpr llvm::StringRef TagBoundaries = "<>";
   llvm::SmallVector<yield::Instruction::RawTag, 8> OpenTagStack;
   for (size_t Position = 0; Position < Markup.size(); ++Position) {
     // Mark the whitespaces so that the client can easily remove them if needed.
@@ -374,8 +379,15 @@ DI::Disassembled DI::parse(const llvm::MCInst &Instruction,
       Result.Text += Markup.substr(Mnemonic->FullPosition, Mnemonic->FullSize);
       Position += Mnemonic->FullSize - 1;
     } else {
-      // Nothing special, just a character.
-      Result.Text += Markup[Position];
+      // Nothing special, copy everything up to the next interesting position
+      // at once.
+      size_t End = std::min(Markup.find_first_of(Special, Position + 1),
+                            Markup.size());
+      if (Mnemonic.has_value() && Mnemonic->FullPosition > Position)
+        End = std::min(End, Mnemonic->FullPosition);
+
+      Result.Text += Markup.slice(Position, End);
+      Position = End - 1;
     }
   }
 
@@ -385,10 +397,84 @@ DI::Disassembled DI::parse(const llvm::MCInst &Instruction,
   return Result;
 }
 
+namespace {
+
+/// Process-wide cache of the results of `LLVMDisassemblerInterface::decode`
+///
+/// The output of the disassembler only depends on the flavor, the address and
+/// the bytes of the instruction: each entry records the bytes the instruction
+/// has been decoded from, so that it's reused only if they match.
+class DecodedInstructionCache {
+private:
+  /// Stop caching new entries after this many, to bound memory usage
+  static constexpr size_t MaxEntries = 1 << 20;
+
+  using Key = std::pair<DI::Flavor, MetaAddress>;
+
+  struct Entry {
+    std::vector<uint8_t> Bytes;
+    DI::Disassembled Instruction;
+  };
+
+private:
+  std::mutex Mutex;
+  std::map<Key, Entry> Entries;
+
+public:
+  std::optional<DI::Disassembled> get(const DI::Flavor &Flavor,
+                                      const MetaAddress &Where,
+                                      llvm::ArrayRef<uint8_t> RawBytes) {
+    std::lock_guard Lock(Mutex);
+    auto It = Entries.find({ Flavor, Where });
+    if (It == Entries.end())
+      return std::nullopt;
+
+    llvm::ArrayRef<uint8_t> Cached = It->second.Bytes;
+    if (RawBytes.size() < Cached.size()
+        or RawBytes.take_front(Cached.size()) != Cached)
+      return std::nullopt;
+
+    return It->second.Instruction;
+  }
+
+  void insert(const DI::Flavor &Flavor,
+              llvm::ArrayRef<uint8_t> RawBytes,
+              const DI::Disassembled &Instruction) {
+    revng_assert(Instruction.Size <= RawBytes.size());
+
+    std::lock_guard Lock(Mutex);
+    if (Entries.size() >= MaxEntries)
+      return;
+
+    Entry &NewEntry = Entries[{ Flavor, Instruction.Address }];
+    auto Bytes = RawBytes.take_front(Instruction.Size);
+    NewEntry.Bytes.assign(Bytes.begin(), Bytes.end());
+    NewEntry.Instruction = Instruction;
+  }
+};
+
+} // namespace
+
+static DecodedInstructionCache DecodedInstructions;
+
 DI::Disassembled DI::instruction(const MetaAddress &Where,
                                  llvm::ArrayRef<uint8_t> RawBytes) {
   revng_assert(Where.isValid() && !RawBytes.empty());
 
+  if (auto Cached = DecodedInstructions.get(CurrentFlavor, Where, RawBytes))
+    return std::move(*Cached);
+
+  Disassembled Result = decode(Where, RawBytes);
+
+  // Failures depend on how many bytes were available, don't cache them
+  if (Result.Error.empty())
+    DecodedInstructions.insert(CurrentFlavor, RawBytes, Result);
+
+  return Result;
+}
+
+DI::Disassembled DI::decode(const MetaAddress &Where,
+                            llvm::ArrayRef<uint8_t> RawBytes) {
   auto [Instruction, Size] = disassemble(Where, RawBytes, *Disassembler);
   if (Instruction.has_value()) {
     revng_assert(Size != 0);
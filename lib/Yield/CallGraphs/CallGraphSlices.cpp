@@ -21,16 +21,10 @@ static Node *copyNode(yield::calls::PreLayoutGraph &Graph, const Node *Source) {
 /// \tparam NV local `NodeView` specialization
 /// \tparam INV inverted location `NodeView` specialization
 template<typename NV, typename INV>
-Graph makeTreeImpl(const Graph &Input, std::string_view SlicePointLocation) {
-  auto SlicePointPredicate = [&SlicePointLocation](const Node *Node) {
-    return Node->getLocationString() == SlicePointLocation;
-  };
-  auto Entry = llvm::find_if(Input.nodes(), SlicePointPredicate);
-  revng_assert(Entry != Input.nodes().end());
-
+Graph makeTreeImpl(const Node *Entry) {
   // Find the rank of each node, such that for any node its rank is equal to
   // the highest rank among its children plus one.
-  llvm::ReversePostOrderTraversal ReversePostOrder(NV{ *Entry });
+  llvm::ReversePostOrderTraversal ReversePostOrder(NV{ Entry });
   std::unordered_map<const Node *, size_t> Ranks;
   for (const Node *CurrentNode : ReversePostOrder) {
     uint64_t &CurrentRank = Ranks[CurrentNode];
@@ -85,10 +79,10 @@ Graph makeTreeImpl(const Graph &Input, std::string_view SlicePointLocation) {
   // Manually adding `Entry` to the result graphs guarantees that it's never
   // empty. Since we only ever iterate on edges, this will guarantee that the
   // produced graph is not empty even in the cases where `Entry` has no edges.
-  Result.setEntryNode(FindOrAddHelper(*Entry));
+  Result.setEntryNode(FindOrAddHelper(Entry));
 
   // Fill in the `Result` graph.
-  for (const Node *Node : llvm::breadth_first(NV{ *Entry })) {
+  for (const Node *Node : llvm::breadth_first(NV{ Entry })) {
     for (auto Neighbour : llvm::children<INV>(Node)) {
       if (Ranks.contains(Neighbour)) {
         auto *NewNeighbour = FindOrAddHelper(Neighbour);
@@ -108,18 +102,61 @@ Graph makeTreeImpl(const Graph &Input, std::string_view SlicePointLocation) {
   return Result;
 }
 
+static const Node *findSlicePoint(const Graph &Input,
+                                  std::string_view SlicePointLocation) {
+  auto SlicePointPredicate = [&SlicePointLocation](const Node *Node) {
+    return Node->getLocationString() == SlicePointLocation;
+  };
+  auto Entry = llvm::find_if(Input.nodes(), SlicePointPredicate);
+  revng_assert(Entry != Input.nodes().end());
+  return *Entry;
+}
+
+// Forwards direction, makes sure no successor relation ever gets lost.
+static Graph makeCalleeTreeImpl(const Node *SlicePoint) {
+  using NV = const yield::calls::PreLayoutNode *;
+  return makeTreeImpl<NV, llvm::Inverse<NV>>(SlicePoint);
+}
+
+// Backwards direction, makes sure no predecessor relation ever gets lost.
+static Graph makeCallerTreeImpl(const Node *SlicePoint) {
+  using NV = const yield::calls::PreLayoutNode *;
+  return makeTreeImpl<llvm::Inverse<NV>, NV>(SlicePoint);
+}
+
 yield::calls::PreLayoutGraph
 yield::calls::makeCalleeTree(const PreLayoutGraph &Input,
                              std::string_view SlicePoint) {
-  // Forwards direction, makes sure no successor relation ever gets lost.
-  return makeTreeImpl<const PreLayoutNode *,
-                      llvm::Inverse<const PreLayoutNode *>>(Input, SlicePoint);
+  return makeCalleeTreeImpl(findSlicePoint(Input, SlicePoint));
 }
 
 yield::calls::PreLayoutGraph
 yield::calls::makeCallerTree(const PreLayoutGraph &Input,
                              std::string_view SlicePoint) {
-  // Backwards direction, makes sure no predecessor relation ever gets lost.
-  return makeTreeImpl<llvm::Inverse<const PreLayoutNode *>,
-                      const PreLayoutNode *>(Input, SlicePoint);
+  return makeCallerTreeImpl(findSlicePoint(Input, SlicePoint));
+}
+
+using SCG = yield::calls::SliceableCallGraph;
+
+SCG::SliceableCallGraph(PreLayoutGraph &&Input) : Graph(std::move(Input)) {
+  Lookup.reserve(Graph.size());
+  for (const PreLayoutNode *Node : Graph.nodes())
+    Lookup.try_emplace(Node->getLocationString(), Node);
+}
+
+const yield::calls::PreLayoutNode *
+SCG::find(std::string_view SlicePoint) const {
+  auto Iterator = Lookup.find(SlicePoint);
+  revng_assert(Iterator != Lookup.end());
+  return Iterator->second;
+}
+
+yield::calls::PreLayoutGraph
+SCG::makeCalleeTree(std::string_view SlicePoint) const {
+  return makeCalleeTreeImpl(find(SlicePoint));
+}
+
+yield::calls::PreLayoutGraph
+SCG::makeCallerTree(std::string_view SlicePoint) const {
+  return makeCallerTreeImpl(find(SlicePoint));
 }
@@ -4,6 +4,10 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <unordered_map>
+
+#include "llvm/ADT/Hashing.h"
+
 #include "revng/EarlyFunctionAnalysis/CFGHelpers.h"
 #include "revng/EarlyFunctionAnalysis/FunctionEdgeType.h"
 #include "revng/Model/Binary.h"
@@ -69,3 +73,75 @@ yield::cfg::extractFromInternal(const yield::Function &Function,
 
   return std::move(Result);
 }
+
+static llvm::hash_code hashValue(const BasicBlockID &ID) {
+  return llvm::hash_combine(std::hash<MetaAddress>()(ID.start()),
+                            ID.inliningIndex());
+}
+
+uint64_t yield::cfg::extractionHash(const yield::Function &Function,
+                                    const model::Binary &Binary,
+                                    const Configuration &Configuration) {
+  llvm::hash_code Result = llvm::hash_combine(Function.Blocks().size(),
+                                              Configuration.AddEntryNode,
+                                              Configuration.AddExitNode);
+
+  for (const auto &BasicBlock : Function.Blocks()) {
+    Result = llvm::hash_combine(Result,
+                                hashValue(BasicBlock.ID()),
+                                hashValue(BasicBlock.nextBlock()),
+                                BasicBlock.Successors().size());
+
+    for (const auto &Successor : BasicBlock.Successors()) {
+      auto [NextInstruction, _] = efa::parseSuccessor(*Successor,
+                                                      BasicBlock.nextBlock(),
+                                                      Binary);
+      Result = llvm::hash_combine(Result, hashValue(NextInstruction));
+    }
+  }
+
+  return Result;
+}
+
+static yield::cfg::PreLayoutGraph
+copy(const yield::cfg::PreLayoutGraph &Input) {
+  using Node = yield::cfg::PreLayoutNode;
+  yield::cfg::PreLayoutGraph Result;
+
+  std::unordered_map<const Node *, Node *> Lookup;
+  for (const Node *Current : Input.nodes())
+    Lookup.emplace(Current, Result.addNode(Current->copyData()));
+
+  for (const Node *From : Input.nodes())
+    for (auto [To, Label] : From->successor_edges())
+      Lookup.at(From)->addSuccessor(Lookup.at(To), *Label);
+
+  if (Input.getEntryNode() != nullptr)
+    Result.setEntryNode(Lookup.at(Input.getEntryNode()));
+
+  return Result;
+}
+
+yield::cfg::PreLayoutGraph
+yield::cfg::ExtractionCache::extract(const yield::Function &Function,
+                                     const model::Binary &Binary,
+                                     const Configuration &Configuration) {
+  uint64_t Hash = extractionHash(Function, Binary, Configuration);
+
+  {
+    std::lock_guard Lock(Mutex);
+    auto It = Entries.find(Function.Entry());
+    if (It != Entries.end() and It->second.Hash == Hash)
+      return copy(It->second.Graph);
+  }
+
+  // Extract outside of the critical section
+  PreLayoutGraph Result = extractFromInternal(Function, Binary, Configuration);
+
+  std::lock_guard Lock(Mutex);
+  Entry &Slot = Entries[Function.Entry()];
+  Slot.Hash = Hash;
+  Slot.Graph = copy(Result);
+
+  return Result;
+}
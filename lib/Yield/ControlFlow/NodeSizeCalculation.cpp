@@ -4,6 +4,8 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <cstring>
+
 #include "revng/EarlyFunctionAnalysis/CFGHelpers.h"
 #include "revng/GraphLayout/Graphs.h"
 #include "revng/Model/Binary.h"
@@ -56,7 +58,7 @@ textSize(const SortedVector<yield::TaggedString> &Tagged) {
   revng_assert(!Tagged.empty());
 
   size_t LineLength = 0;
-  for (yield::TaggedString String : Tagged)
+  for (const yield::TaggedString &String : Tagged)
     LineLength += textSize(String).W;
 
   return yield::layout::Size(LineLength, 1);
@@ -101,6 +103,30 @@ singleLineSize(std::string_view Text,
   return Result;
 }
 
+static size_t digitCount(uint64_t Value, unsigned Base) {
+  size_t Result = 1;
+  for (; Value >= Base; Value /= Base)
+    ++Result;
+  return Result;
+}
+
+/// The length of `Address.toString()`, without building it
+static size_t addressLength(const MetaAddress &Address) {
+  if (Address.isInvalid())
+    return Address.toString().size();
+
+  const size_t SeparatorSize = MetaAddress::Separator.size();
+  size_t Result = 2 + digitCount(Address.address(), 16);
+  Result += SeparatorSize;
+  Result += std::strlen(MetaAddressType::toString(Address.type()));
+  if (not Address.isDefaultEpoch())
+    Result += SeparatorSize + digitCount(Address.epoch(), 10);
+  if (not Address.isDefaultAddressSpace())
+    Result += SeparatorSize + digitCount(Address.addressSpace(), 10);
+
+  return Result;
+}
+
 static yield::layout::Size &appendSize(yield::layout::Size &Original,
                                        const yield::layout::Size &AddOn) {
   if (AddOn.W > Original.W)
@@ -168,9 +194,9 @@ instructionSize(const yield::Instruction &Instruction,
   yield::layout::Size RawBytesLengthWithOffsets{ 0, 0 };
   RawBytesLengthWithOffsets.W += Instruction.RawBytes().size() * 3;
   RawBytesLengthWithOffsets.W += CommentIndicatorSize + 5;
+  yield::layout::Size AddressSize(addressLength(Instruction.Address()), 1);
   appendSize(Result,
-             fontSize(textSize(Instruction.Address().toString())
-                        + RawBytesLengthWithOffsets,
+             fontSize(AddressSize + RawBytesLengthWithOffsets,
                       Configuration.AnnotationFontSize,
                       Configuration));
 
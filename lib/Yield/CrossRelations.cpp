@@ -37,39 +37,60 @@ CR::CrossRelations::CrossRelations(const MetadataContainer &Metadata,
     Inserter.insert(CR::RelationDescription(std::move(Location), {}));
   }
 
-  for (const auto &[EntryAddress, _, ControlFlowGraph] : Metadata) {
-    for (const auto &BasicBlock : ControlFlowGraph) {
-      auto CallLocation = toString(ranks::BasicBlock,
-                                   EntryAddress,
-                                   BasicBlock.ID());
-
-      for (const auto &Edge : BasicBlock.Successors()) {
-        if (auto *CallEdge = llvm::dyn_cast<efa::CallEdge>(Edge.get())) {
-          if (efa::FunctionEdgeType::isCall(Edge->Type())) {
-            if (const auto &Callee = Edge->Destination(); Callee.isValid()) {
-              // TODO: embed information about the call instruction into
-              //       `CallLocation` after metadata starts providing it.
-              const auto L = toString(ranks::Function,
-                                      Callee.notInlinedAddress());
-              if (auto It = Relations().find(L); It != Relations().end())
-                It->IsCalledFrom().emplace(std::move(CallLocation));
-            } else if (!CallEdge->DynamicFunction().empty()) {
-              const auto L = toString(ranks::DynamicFunction,
-                                      CallEdge->DynamicFunction());
-              if (auto It = Relations().find(L); It != Relations().end())
-                It->IsCalledFrom().emplace(std::move(CallLocation));
-            } else {
-              // Ignore indirect calls.
-            }
+  for (const efa::ControlFlowGraph &ControlFlowGraph : Metadata)
+    recordCallSites(ControlFlowGraph);
+}
+
+void CR::CrossRelations::recordCallSites(const efa::ControlFlowGraph &CFG) {
+  namespace ranks = revng::ranks;
+  using pipeline::toString;
+
+  const MetaAddress &EntryAddress = CFG.Entry();
+  for (const auto &BasicBlock : CFG.Blocks()) {
+    auto CallLocation = toString(ranks::BasicBlock,
+                                 EntryAddress,
+                                 BasicBlock.ID());
+
+    for (const auto &Edge : BasicBlock.Successors()) {
+      if (auto *CallEdge = llvm::dyn_cast<efa::CallEdge>(Edge.get())) {
+        if (efa::FunctionEdgeType::isCall(Edge->Type())) {
+          if (const auto &Callee = Edge->Destination(); Callee.isValid()) {
+            // TODO: embed information about the call instruction into
+            //       `CallLocation` after metadata starts providing it.
+            const auto L = toString(ranks::Function,
+                                    Callee.notInlinedAddress());
+            if (auto It = Relations().find(L); It != Relations().end())
+              It->IsCalledFrom().insert(CallLocation);
+          } else if (!CallEdge->DynamicFunction().empty()) {
+            const auto L = toString(ranks::DynamicFunction,
+                                    CallEdge->DynamicFunction());
+            if (auto It = Relations().find(L); It != Relations().end())
+              It->IsCalledFrom().insert(CallLocation);
           } else {
-            // Ignore non-call edges.
+            // Ignore indirect calls.
           }
+        } else {
+          // Ignore non-call edges.
         }
       }
     }
   }
 }
 
+void CR::CrossRelations::removeCallSitesIn(const MetaAddress &Entry) {
+  namespace ranks = revng::ranks;
+  using pipeline::locationFromString;
+
+  auto IsInFunction = [&Entry](const std::string &CallSite) {
+    auto Location = locationFromString(ranks::BasicBlock, CallSite);
+    revng_assert(Location.has_value());
+    return Location->at(ranks::Function) == Entry;
+  };
+
+  for (CR::RelationDescription &Relation : Relations())
+    Relation.IsCalledFrom().erase_if(IsInFunction);
+}
+
 template<typename AddNodeCallable, typename AddEdgeCallable>
 static void conversionHelper(const CR::CrossRelations &Input,
                              const AddNodeCallable &AddNode,
@@ -33,12 +33,53 @@ static FormattedNumber formatNumber(uint64_t Number, unsigned Width = 8) {
   return FormattedNumber(Number, 0, Width, true, false, false);
 };
 
+/// Write \p Byte as two lowercase hexadecimal digits, skipping the generic
+/// (and much slower) formatting machinery of `raw_ostream`
+static void writeHexByte(raw_ostream &Output, uint8_t Byte) {
+  static constexpr char Digits[] = "0123456789abcdef";
+  char Buffer[2] = { Digits[Byte >> 4], Digits[Byte & 0xF] };
+  Output.write(Buffer, sizeof(Buffer));
+}
+
+/// Write a whole line of bytes that are not part of any instruction: this is
+/// equivalent to what the generic loop in `outputHexDump` prints in this case,
+/// but it formats the line into a local buffer first.
+static void writePlainLine(raw_ostream &Output,
+                           const MetaAddress &Address,
+                           ArrayRef<uint8_t> Bytes) {
+  revng_assert(Bytes.size() == BytesInLine);
+  static constexpr char Digits[] = "0123456789abcdef";
+
+  // Two digits and a separator for each byte, plus the extra space in the
+  // middle of the line
+  char Buffer[BytesInLine * 3 + 1];
+  char *Cursor = Buffer;
+  SmallString<BytesInLine> PrintableChars;
+  for (size_t Index = 0; Index < BytesInLine; ++Index) {
+    uint8_t Byte = Bytes[Index];
+    *Cursor++ = Digits[Byte >> 4];
+    *Cursor++ = Digits[Byte & 0xF];
+    if (Index + 1 != BytesInLine)
+      *Cursor++ = ' ';
+    if (Index + 1 == BytesInLine / 2)
+      *Cursor++ = ' ';
+
+    PrintableChars += std::isprint(Byte) ? static_cast<char>(Byte) : '.';
+  }
+
+  Output << formatNumber(Address.address()) << "  ";
+  Output.write(Buffer, Cursor - Buffer);
+  Output << "   | ";
+  printHTMLEscaped(PrintableChars, Output);
+  Output << " |\n";
+}
+
 static void outputHexDump(const TupleTree<model::Binary> &Binary,
                           const pipeline::LLVMContainer &ModuleContainer,
                           const CFGMap &CFGMap,
                           const BinaryFileContainer &SourceBinary,
                           StringRef OutputPath) {
-  auto BufferOrError = MemoryBuffer::getFileOrSTDIN(*SourceBinary.path());
+  auto BufferOrError = mapBinaryFile(*SourceBinary.path());
   auto Buffer = cantFail(errorOrToExpected(std::move(BufferOrError)));
   RawBinaryView BinaryView(*Binary.get(), Buffer->getBuffer());
 
@@ -129,6 +170,23 @@ static void outputHexDump(const TupleTree<model::Binary> &Binary,
                                                      IntervalMetaAddress{} };
 
       bool LineBegins = Index % BytesInLine == 0;
+
+      // Most of the lines do not overlap any instruction: print them in one
+      // go, without going through the checks below for each byte
+      if (LineBegins and Index + BytesInLine <= SegmentBinary.size()) {
+        MetaAddress LineEnd = CurrentAddress + BytesInLine;
+        bool IsIntervalValid = CurrentInterval.lower().isValid()
+                               and CurrentInterval.upper().isValid();
+        if (not IsIntervalValid or LineEnd <= CurrentInterval.lower()) {
+          writePlainLine(Output,
+                         CurrentAddress,
+                         SegmentBinary.slice(Index, BytesInLine));
+          CurrentAddress = LineEnd;
+          Index += BytesInLine - 1;
+          continue;
+        }
+      }
+
       if (LineBegins) {
         // Print address of first byte in line
         Output << formatNumber(CurrentAddress.address()) << "  ";
@@ -165,7 +223,7 @@ static void outputHexDump(const TupleTree<model::Binary> &Binary,
 
       // Format number and put it to the output
       const uint64_t &B = SegmentBinary[Index];
-      Output << formatNumber(B, 2);
+      writeHexByte(Output, B);
 
       // Increment counter of bytes printed in current line.
       ++Counter;
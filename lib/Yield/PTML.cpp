@@ -95,30 +95,34 @@ static std::set<std::string> targets(const yield::BasicBlock &BasicBlock,
   return Result;
 }
 
-static std::string emitTagged(const PTMLBuilder &B,
-                              const yield::TaggedString &String) {
+static void emitTagged(llvm::raw_ostream &OS,
+                       const PTMLBuilder &B,
+                       const yield::TaggedString &String) {
   llvm::StringRef Type = yield::TagType::toPTML(String.Type());
   if (Type.empty()) {
     revng_assert(String.Attributes().empty());
-    return std::move(String.Content());
+    OS << String.Content();
+    return;
   }
 
-  auto Result = B.getTag(tags::Span, std::move(String.Content()))
-                  .addAttribute(attributes::Token, std::move(Type));
+  auto Result = B.writeTag(OS, tags::Span);
+  Result.addAttribute(attributes::Token, Type);
   for (const yield::TagAttribute &Attribute : String.Attributes())
     Result.addAttribute(Attribute.Name(), Attribute.Value());
-
-  return Result.toString();
+  Result.finish(String.Content());
 }
 
 static std::string taggedLine(const PTMLBuilder &B,
                               const SortedVector<yield::TaggedString> &Tagged) {
   std::string Result;
+  llvm::raw_string_ostream OS(Result);
 
   for (const yield::TaggedString &String : Tagged)
-    Result += emitTagged(B, String);
+    emitTagged(OS, B, String);
 
-  return Result += '\n';
+  OS << '\n';
+  OS.flush();
+  return Result;
 }
 
 /// An internal helper for managing instruction prefixes.
@@ -193,51 +197,36 @@ public:
     InstructionPrefix &Data = Prefixes.at(BasicBlock).at(Instruction);
 
     std::string Result;
-    if (LongestAddressString != 0) {
-      Result = B.getTag(tags::Span, std::move(Data.Address))
-                 .addAttribute(attributes::Token,
-                               tokenTypes::InstructionAddress)
-                 .toString();
+    llvm::raw_string_ostream OS(Result);
+    B.writeToken(OS, "  ", ptml::tokens::Indentation);
 
+    if (LongestAddressString != 0) {
       revng_assert(Data.Address.size() != 0);
       revng_assert(Data.Address.size() <= LongestAddressString);
       if (Data.Address.size() < LongestAddressString) {
         std::string Indentation(LongestAddressString - Data.Address.size(),
                                 ' ');
-        Result = B.getTag(tags::Span, std::move(Indentation))
-                   .addAttribute(attributes::Token, ptml::tokens::Indentation)
-                   .toString()
-                 + std::move(Result);
+        B.writeToken(OS, Indentation, ptml::tokens::Indentation);
       }
+      B.writeToken(OS, Data.Address, tokenTypes::InstructionAddress);
 
       using model::Architecture::getAssemblyLabelIndicator;
-      std::string Indicator(getAssemblyLabelIndicator(Binary.Architecture()));
-      Result += B.getTag(tags::Span, std::move(Indicator))
-                  .addAttribute(attributes::Token,
-                                tokenTypes::InstructionAddress)
-                  .toString();
-      Result += B.getTag(tags::Span, std::string(4, ' '))
-                  .addAttribute(attributes::Token, ptml::tokens::Indentation)
-                  .toString();
+      auto Indicator = getAssemblyLabelIndicator(Binary.Architecture());
+      B.writeToken(OS, Indicator, tokenTypes::InstructionAddress);
+      B.writeToken(OS, "    ", ptml::tokens::Indentation);
     }
 
     if (LongestByteString != 0) {
-      Result += B.getTag(tags::Span, std::move(Data.Bytes))
-                  .addAttribute(attributes::Token, tokenTypes::RawBytes)
-                  .toString();
+      B.writeToken(OS, Data.Bytes, tokenTypes::RawBytes);
 
       revng_assert(Data.Bytes.size() != 0);
       revng_assert(Data.Bytes.size() <= LongestByteString);
       std::string Indentation(LongestByteString + 3 - Data.Bytes.size(), ' ');
-      Result += B.getTag(tags::Span, std::move(Indentation))
-                  .addAttribute(attributes::Token, ptml::tokens::Indentation)
-                  .toString();
+      B.writeToken(OS, Indentation, ptml::tokens::Indentation);
     }
 
-    return B.getTag(tags::Span, "  ")
-             .addAttribute(attributes::Token, ptml::tokens::Indentation)
-             .toString()
-           + std::move(Result);
+    OS.flush();
+    return Result;
   }
 
   /// \note This does _not_ consume anything, feel free to call as many times
@@ -2,6 +2,11 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <deque>
+#include <memory>
+
+#include "llvm/Support/ThreadPool.h"
+
 #include "revng/EarlyFunctionAnalysis/ControlFlowGraph.h"
 #include "revng/EarlyFunctionAnalysis/ControlFlowGraphCache.h"
 #include "revng/Lift/LoadBinaryPass.h"
@@ -45,7 +50,14 @@ void ProcessAssembly::run(pipeline::ExecutionContext &Context,
   // This allows it to only be created once.
   DissassemblyHelper Helper;
 
-  ControlFlowGraphCache Cache(CFGMap);
+  auto &SharedCFGs = getSharedControlFlowGraphCache(Context.getContext());
+  ControlFlowGraphCache Cache(CFGMap, &SharedCFGs);
+
+  // Disassembling reads the model, whose tracking is not thread-safe, but
+  // serializing the result does not: let a pool of threads take care of it
+  // while we move on to the next function
+  llvm::ThreadPool Pool(llvm::hardware_concurrency());
+  std::deque<std::pair<MetaAddress, std::string>> Serialized;
 
   for (const model::Function &Function :
        getFunctionsAndCommit(Context, Output.name())) {
@@ -56,8 +68,19 @@ void ProcessAssembly::run(pipeline::ExecutionContext &Context,
                                            Metadata,
                                            BinaryView,
                                            *Model);
-    Output.insert_or_assign(Function.Entry(), toString(Disassembled));
+
+    // ThreadPool requires copyable tasks
+    auto Shared = std::make_shared<yield::Function>(std::move(Disassembled));
+    std::string &Result = Serialized.emplace_back(Function.Entry(), "").second;
+    Pool.async([Shared, &Result]() { Result = toString(*Shared); });
   }
+
+  Pool.wait();
+
+  // Insert in the same order as the functions have been disassembled, so that
+  // the output does not depend on scheduling
+  for (auto &[Entry, Text] : Serialized)
+    Output.insert_or_assign(Entry, std::move(Text));
 }
 
 void YieldAssembly::run(pipeline::ExecutionContext &Context,
@@ -68,6 +91,12 @@ void YieldAssembly::run(pipeline::ExecutionContext &Context,
 
   PTMLBuilder B;
 
+  // Reuse the comments emitted by previous runs whose inputs did not change
+  using Cache = ptml::FunctionCommentCache;
+  pipeline::Context &PipelineContext = Context.getContext();
+  constexpr llvm::StringRef Name = Cache::ContextName;
+  auto &Comments = PipelineContext.getOrCreateSharedObject<Cache>(Name);
+
   for (const model::Function &Function :
        getFunctionsAndCommit(Context, Output.name())) {
     MetaAddress Address = Function.Entry();
@@ -79,12 +108,12 @@ void YieldAssembly::run(pipeline::ExecutionContext &Context,
 
     const model::Architecture::Values A = Model->Architecture();
     auto CommentIndicator = model::Architecture::getAssemblyCommentIndicator(A);
-    std::string R = ptml::functionComment(B,
-                                          Function,
-                                          *Model,
-                                          CommentIndicator,
-                                          0,
-                                          80);
+    std::string R = Comments.functionComment(B,
+                                             Function,
+                                             *Model,
+                                             CommentIndicator,
+                                             0,
+                                             80);
     R += yield::ptml::functionAssembly(B, **MaybeFunction, *Model);
     R = B.getTag(ptml::tags::Div, std::move(R)).toString();
     Output.insert_or_assign((*MaybeFunction)->Entry(), std::move(R));
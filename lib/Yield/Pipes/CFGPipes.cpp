@@ -2,12 +2,18 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <deque>
+#include <memory>
+
+#include "llvm/Support/ThreadPool.h"
+
 #include "revng/Model/Binary.h"
 #include "revng/Pipeline/Pipe.h"
 #include "revng/Pipeline/RegisterContainerFactory.h"
 #include "revng/Pipeline/RegisterPipe.h"
 #include "revng/Pipes/Kinds.h"
 #include "revng/Pipes/ModelGlobal.h"
+#include "revng/Yield/ControlFlow/Extraction.h"
 #include "revng/Yield/Function.h"
 #include "revng/Yield/Pipes/YieldControlFlow.h"
 #include "revng/Yield/SVG.h"
@@ -23,6 +29,18 @@ void YieldControlFlow::run(pipeline::ExecutionContext &Context,
   const auto &Model = revng::getModelFromContext(Context);
   ptml::PTMLBuilder B;
 
+  // Reuse the graphs extracted by previous runs whose CFG did not change
+  using Cache = yield::cfg::ExtractionCache;
+  pipeline::Context &PipelineContext = Context.getContext();
+  constexpr llvm::StringRef Name = Cache::ContextName;
+  auto &Graphs = PipelineContext.getOrCreateSharedObject<Cache>(Name);
+
+  // Extracting the graphs reads the model, whose tracking is not thread-safe,
+  // but laying them out does not: let a pool of threads take care of it while
+  // we move on to the next function
+  llvm::ThreadPool Pool(llvm::hardware_concurrency());
+  std::deque<std::pair<MetaAddress, std::string>> Results;
+
   for (const model::Function &Function :
        getFunctionsAndCommit(Context, Output.name())) {
     MetaAddress Address = Function.Entry();
@@ -32,11 +50,26 @@ void YieldControlFlow::run(pipeline::ExecutionContext &Context,
     revng_assert(MaybeFunction && MaybeFunction->verify());
     revng_assert((*MaybeFunction)->Entry() == Address);
 
-    Output.insert_or_assign((*MaybeFunction)->Entry(),
-                            yield::svg::controlFlowGraph(B,
-                                                         **MaybeFunction,
-                                                         *Model));
+    auto Prepared = yield::svg::prepareControlFlowGraph(B,
+                                                        **MaybeFunction,
+                                                        *Model,
+                                                        &Graphs);
+
+    // ThreadPool requires copyable tasks
+    using PreparedGraph = yield::svg::PreparedControlFlowGraph;
+    auto SharedPrepared = std::make_shared<PreparedGraph>(std::move(Prepared));
+    std::string &Result = Results.emplace_back(Address, "").second;
+    Pool.async([&B, SharedPrepared, &Result]() {
+      Result = yield::svg::controlFlowGraph(B, *SharedPrepared);
+    });
   }
+
+  Pool.wait();
+
+  // Insert in the same order as the functions have been requested, so that
+  // the output does not depend on scheduling
+  for (auto &[Address, SVG] : Results)
+    Output.insert_or_assign(Address, std::move(SVG));
 }
 
 } // end namespace revng::pipes
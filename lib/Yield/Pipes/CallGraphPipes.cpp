@@ -14,6 +14,7 @@
 #include "revng/Pipes/StringMap.h"
 #include "revng/Pipes/TupleTreeContainer.h"
 #include "revng/TupleTree/TupleTree.h"
+#include "revng/Yield/CallGraphs/CallGraphSlices.h"
 #include "revng/Yield/CrossRelations/CrossRelations.h"
 #include "revng/Yield/Generated/ForwardDecls.h"
 #include "revng/Yield/Pipes/ProcessCallGraph.h"
@@ -56,11 +57,11 @@ void YieldCallGraph::run(pipeline::ExecutionContext &Context,
   const auto &Model = revng::getModelFromContext(Context);
   PTMLBuilder B;
 
-  // Convert the graph to SVG.
-  auto Result = yield::svg::callGraph(B, *Relations.get(), *Model);
-
-  // Print the result.
-  Output.setContent(std::move(Result));
+  // Convert the graph to SVG, writing it directly into the container.
+  Output.clear();
+  auto Stream = Output.asStream();
+  yield::svg::callGraph(Stream, B, *Relations.get(), *Model);
+  Stream.flush();
 
   Context.commitUniqueTarget(Output);
 }
@@ -75,7 +76,11 @@ void YieldCallGraphSlice::run(pipeline::ExecutionContext &Context,
   // Access the llvm module
   PTMLBuilder B;
 
-  ControlFlowGraphCache Cache(CFGMap);
+  auto &SharedCFGs = getSharedControlFlowGraphCache(Context.getContext());
+  ControlFlowGraphCache Cache(CFGMap, &SharedCFGs);
+
+  // Build the call graph only once, all the slices are cut out of it
+  yield::calls::SliceableCallGraph CallGraph(Relations.get()->toYieldGraph());
 
   for (const model::Function &Function :
        getFunctionsAndCommit(Context, Output.name())) {
@@ -87,7 +92,7 @@ void YieldCallGraphSlice::run(pipeline::ExecutionContext &Context,
     Output.insert_or_assign(Function.Entry(),
                             yield::svg::callGraphSlice(B,
                                                        SlicePoint,
-                                                       *Relations.get(),
+                                                       CallGraph,
                                                        *Model));
   }
 }
@@ -85,11 +85,12 @@ static std::string cubicBend(const yield::layout::Point &From,
                        -To.Y);
 }
 
-static std::string edge(const PTMLBuilder &B,
-                        const yield::layout::Path &Path,
-                        const std::string_view Type,
-                        bool UseOrthogonalBends = true,
-                        bool UseVerticalCurves = false) {
+static void edge(llvm::raw_ostream &OS,
+                 const PTMLBuilder &B,
+                 const yield::layout::Path &Path,
+                 const std::string_view Type,
+                 bool UseOrthogonalBends = true,
+                 bool UseVerticalCurves = false) {
   std::string Points;
 
   revng_assert(!Path.empty());
@@ -110,27 +111,27 @@ static std::string edge(const PTMLBuilder &B,
   Points.pop_back(); // Remove an extra space at the end.
 
   std::string Marker = llvm::formatv("url(#{0}-arrow-head)", Type);
-  return B.getTag("path")
-    .addAttribute("class", std::string(Type) += "-edge")
-    .addAttribute("d", std::move(Points))
-    .addAttribute("marker-end", std::move(Marker))
-    .addAttribute("fill", "none")
-    .toString();
+  OS << B.getTag("path")
+          .addAttribute("class", std::string(Type) += "-edge")
+          .addAttribute("d", std::move(Points))
+          .addAttribute("marker-end", std::move(Marker))
+          .addAttribute("fill", "none");
 }
 
 template<typename NodeData, typename EdgeData = Empty>
-std::string node(const PTMLBuilder &B,
-                 const yield::layout::OutputNode<NodeData, EdgeData> *Node,
-                 std::string &&Content,
-                 const yield::cfg::Configuration &Configuration) {
+void node(llvm::raw_ostream &OS,
+          const PTMLBuilder &B,
+          const yield::layout::OutputNode<NodeData, EdgeData> *Node,
+          std::string &&Content,
+          const yield::cfg::Configuration &Configuration) {
   yield::layout::Size HalfSize{ Node->Size.W / 2, Node->Size.H / 2 };
   yield::layout::Point TopLeft{ Node->Center.X - HalfSize.W,
                                 -Node->Center.Y - HalfSize.H };
 
-  Tag Body = B.getTag("body", std::move(Content));
+  Tag Body = B.getTag("body");
   Body.addAttribute("xmlns", R"(http://www.w3.org/1999/xhtml)");
 
-  Tag Text = B.getTag("foreignObject", Body.toString());
+  Tag Text = B.getTag("foreignObject");
   Text.addAttribute("class", ::tags::NodeContents)
     .addAttribute("x", std::to_string(TopLeft.X))
     .addAttribute("y", std::to_string(TopLeft.Y))
@@ -146,7 +147,12 @@ std::string node(const PTMLBuilder &B,
     .addAttribute("width", std::to_string(Node->Size.W))
     .addAttribute("height", std::to_string(Node->Size.H));
 
-  return Text.toString() + Border.toString();
+  {
+    auto TextScope = Text.scope(OS);
+    auto BodyScope = Body.scope(OS);
+    OS << Content;
+  }
+  OS << Border;
 }
 
 struct Viewbox {
@@ -278,19 +284,40 @@ concept NodeExporter = requires(CallableType &&Callable, const NodeType &Node) {
   { Callable(Node) } -> convertible_to<std::string>;
 };
 
+/// Write the SVG of a laid out graph to \p OS.
+///
+/// Each node and edge is written as soon as it's produced, so that the memory
+/// needed does not depend on the size of the graph.
 template<bool ShouldEmitEmptyNodes,
          SpecializationOf<yield::layout::OutputGraph> PostLayoutGraph,
          NodeExporter<typename PostLayoutGraph::Node> ContentsLambda>
-static std::string exportGraph(const PTMLBuilder &B,
-                               const PostLayoutGraph &Graph,
-                               const yield::cfg::Configuration &Configuration,
-                               yield::layout::sugiyama::Orientation Orientation,
-                               ContentsLambda &&NodeContents) {
-  std::string Result;
-
+static void exportGraph(llvm::raw_ostream &OS,
+                        const PTMLBuilder &B,
+                        const PostLayoutGraph &Graph,
+                        const yield::cfg::Configuration &Configuration,
+                        yield::layout::sugiyama::Orientation Orientation,
+                        ContentsLambda &&NodeContents) {
   // Short circuit the execution for an empty graph.
   if (Graph.size() == 0)
-    return Result;
+    return;
+
+  Viewbox Box = calculateViewbox(Graph);
+  std::string SerializedBox = llvm::formatv("{0} {1} {2} {3}",
+                                            Box.TopLeft.X,
+                                            Box.TopLeft.Y,
+                                            Box.BottomRight.X - Box.TopLeft.X,
+                                            Box.BottomRight.Y - Box.TopLeft.Y);
+
+  Tag SVG = B.getTag("svg")
+              .addAttribute("xmlns", R"(http://www.w3.org/2000/svg)")
+              .addAttribute("viewbox", std::move(SerializedBox))
+              .addAttribute("width",
+                            std::to_string(Box.BottomRight.X - Box.TopLeft.X))
+              .addAttribute("height",
+                            std::to_string(Box.BottomRight.Y - Box.TopLeft.Y));
+  auto SVGScope = SVG.scope(OS);
+
+  OS << B.getTag("defs", defaultArrowHeads(B, Configuration));
 
   // Export all the edges.
   for (const auto *From : Graph.nodes()) {
@@ -298,11 +325,12 @@ static std::string exportGraph(const PTMLBuilder &B,
       for (const auto [To, Edge] : From->successor_edges()) {
         if (ShouldEmitEmptyNodes || !To->isEmpty()) {
           revng_assert(Edge != nullptr);
-          Result += edge(B,
-                         Edge->Path,
-                         edgeTypeAsString(*Edge),
-                         Configuration.UseOrthogonalBends,
-                         isVertical(Orientation));
+          edge(OS,
+               B,
+               Edge->Path,
+               edgeTypeAsString(*Edge),
+               Configuration.UseOrthogonalBends,
+               isVertical(Orientation));
         }
       }
     }
@@ -311,22 +339,17 @@ static std::string exportGraph(const PTMLBuilder &B,
   // Export all the nodes.
   for (const auto *Node : Graph.nodes())
     if (ShouldEmitEmptyNodes || !Node->isEmpty())
-      Result += node(B, Node, NodeContents(*Node), Configuration);
-
-  Viewbox Box = calculateViewbox(Graph);
-  std::string SerializedBox = llvm::formatv("{0} {1} {2} {3}",
-                                            Box.TopLeft.X,
-                                            Box.TopLeft.Y,
-                                            Box.BottomRight.X - Box.TopLeft.X,
-                                            Box.BottomRight.Y - Box.TopLeft.Y);
+      node(OS, B, Node, NodeContents(*Node), Configuration);
+}
 
-  Tag ArrowHeads = B.getTag("defs", defaultArrowHeads(B, Configuration));
-  return B.getTag("svg", ArrowHeads.toString() + std::move(Result))
-    .addAttribute("xmlns", R"(http://www.w3.org/2000/svg)")
-    .addAttribute("viewbox", std::move(SerializedBox))
-    .addAttribute("width", std::to_string(Box.BottomRight.X - Box.TopLeft.X))
-    .addAttribute("height", std::to_string(Box.BottomRight.Y - Box.TopLeft.Y))
-    .toString();
+/// Collect the output of a function writing to a stream into a string
+template<typename CallableType>
+static std::string writeToString(CallableType &&Writer) {
+  std::string Result;
+  llvm::raw_string_ostream Stream(Result);
+  Writer(Stream);
+  Stream.flush();
+  return Result;
 }
 
 namespace yield::layout::sugiyama {
@@ -352,6 +375,12 @@ compute(const InputGraph<Node, Edge> &Graph,
         Orientation LayoutOrientation = Orientation::TopToBottom,
         RankingStrategy Ranking = RankingStrategy::DisjointDepthFirstSearch,
         bool UseSimpleTreeOptimization = false) {
+  // Trees are cheap to lay out regardless of their size.
+  bool IsHuge = !UseSimpleTreeOptimization
+                && Graph.size() > CFG.ScalableLayoutThreshold;
+  if (IsHuge)
+    Ranking = RankingStrategy::NetworkSimplex;
+
   return compute(Graph,
                  Configuration{
                    .Ranking = Ranking,
@@ -361,7 +390,8 @@ compute(const InputGraph<Node, Edge> &Graph,
                    .UseSimpleTreeOptimization = UseSimpleTreeOptimization,
                    .VirtualNodeWeight = CFG.VirtualNodeWeight,
                    .NodeMarginSize = CFG.ExternalNodeMarginSize,
-                   .EdgeMarginSize = CFG.EdgeMarginSize });
+                   .EdgeMarginSize = CFG.EdgeMarginSize,
+                   .UseLinearTimeHorizontalPlacement = IsHuge });
 }
 
 } // namespace yield::layout::sugiyama
@@ -369,30 +399,71 @@ compute(const InputGraph<Node, Edge> &Graph,
 std::string
 yield::svg::controlFlowGraph(const PTMLBuilder &B,
                              const yield::Function &InternalFunction,
-                             const model::Binary &Binary) {
+                             const model::Binary &Binary,
+                             cfg::ExtractionCache *Cache) {
+  return controlFlowGraph(B,
+                          prepareControlFlowGraph(B,
+                                                  InternalFunction,
+                                                  Binary,
+                                                  Cache));
+}
+
+yield::svg::PreparedControlFlowGraph
+yield::svg::prepareControlFlowGraph(const PTMLBuilder &B,
+                                    const yield::Function &InternalFunction,
+                                    const model::Binary &Binary,
+                                    cfg::ExtractionCache *Cache) {
   constexpr auto Configuration = cfg::Configuration::getDefault();
 
-  using Pre = cfg::PreLayoutGraph;
-  Pre Graph = cfg::extractFromInternal(InternalFunction, Binary, Configuration);
+  // Only the size of the nodes depends on their content, the structure of the
+  // graph can be reused as long as the CFG did not change
+  PreparedControlFlowGraph Result;
+  Result.Graph = Cache != nullptr ?
+                   Cache->extract(InternalFunction, Binary, Configuration) :
+                   cfg::extractFromInternal(InternalFunction,
+                                            Binary,
+                                            Configuration);
+
+  cfg::calculateNodeSizes(Result.Graph,
+                          InternalFunction,
+                          Binary,
+                          Configuration);
+
+  for (const cfg::PreLayoutNode *Node : Result.Graph.nodes()) {
+    if (Node->isEmpty())
+      continue;
+
+    BasicBlockID ID = Node->getBasicBlock();
+    Result.Contents[ID] = yield::ptml::controlFlowNode(B,
+                                                       ID,
+                                                       InternalFunction,
+                                                       Binary);
+  }
 
-  cfg::calculateNodeSizes(Graph, InternalFunction, Binary, Configuration);
+  return Result;
+}
 
+std::string
+yield::svg::controlFlowGraph(const PTMLBuilder &B,
+                             const PreparedControlFlowGraph &Prepared) {
+  constexpr auto Configuration = cfg::Configuration::getDefault();
   constexpr auto TopToBottom = layout::sugiyama::Orientation::TopToBottom;
 
   using Post = std::optional<cfg::PostLayoutGraph>;
-  Post Result = layout::sugiyama::compute(Graph, Configuration, TopToBottom);
+  Post Result = layout::sugiyama::compute(Prepared.Graph,
+                                          Configuration,
+                                          TopToBottom);
   revng_assert(Result.has_value());
 
   auto Content = [&](const yield::cfg::PostLayoutNode &Node) {
     if (!Node.isEmpty())
-      return yield::ptml::controlFlowNode(B,
-                                          Node.getBasicBlock(),
-                                          InternalFunction,
-                                          Binary);
+      return Prepared.Contents.at(Node.getBasicBlock());
     else
       return std::string{};
   };
-  return exportGraph<true>(B, *Result, Configuration, TopToBottom, Content);
+  return writeToString([&](llvm::raw_ostream &OS) {
+    exportGraph<true>(OS, B, *Result, Configuration, TopToBottom, Content);
+  });
 }
 
 struct LabelNodeHelper {
@@ -452,9 +523,10 @@ struct LabelNodeHelper {
 };
 
 using CrossRelations = yield::crossrelations::CrossRelations;
-std::string yield::svg::callGraph(const PTMLBuilder &B,
-                                  const CrossRelations &Relations,
-                                  const model::Binary &Binary) {
+void yield::svg::callGraph(llvm::raw_ostream &OS,
+                           const PTMLBuilder &B,
+                           const CrossRelations &Relations,
+                           const model::Binary &Binary) {
   // TODO: make configuration accessible from outside.
   auto Configuration = cfg::Configuration::getDefault();
   Configuration.UseOrthogonalBends = false;
@@ -483,7 +555,15 @@ std::string yield::svg::callGraph(const PTMLBuilder &B,
   auto LT = sugiyama::compute(Tree, Configuration, LeftToRight, BFS, true);
   revng_assert(LT.has_value());
 
-  return exportGraph<false>(B, *LT, Configuration, LeftToRight, Helper);
+  exportGraph<false>(OS, B, *LT, Configuration, LeftToRight, Helper);
+}
+
+std::string yield::svg::callGraph(const PTMLBuilder &B,
+                                  const CrossRelations &Relations,
+                                  const model::Binary &Binary) {
+  return writeToString([&](llvm::raw_ostream &OS) {
+    callGraph(OS, B, Relations, Binary);
+  });
 }
 
 static auto flipPoint(yield::layout::Point const &Point) {
@@ -573,6 +653,15 @@ std::string yield::svg::callGraphSlice(const PTMLBuilder &B,
                                        std::string_view SlicePoint,
                                        const CrossRelations &Relations,
                                        const model::Binary &Binary) {
+  calls::SliceableCallGraph CallGraph(Relations.toYieldGraph());
+  return callGraphSlice(B, SlicePoint, CallGraph, Binary);
+}
+
+std::string
+yield::svg::callGraphSlice(const PTMLBuilder &B,
+                           std::string_view SlicePoint,
+                           const calls::SliceableCallGraph &CallGraph,
+                           const model::Binary &Binary) {
   // TODO: make configuration accessible from outside.
   auto Configuration = cfg::Configuration::getDefault();
   Configuration.UseOrthogonalBends = false;
@@ -582,7 +671,7 @@ std::string yield::svg::callGraphSlice(const PTMLBuilder &B,
   LabelNodeHelper Helper{ B, Binary, Configuration, SlicePoint };
 
   // Ready the forwards facing part of the slice
-  auto Forward = calls::makeCalleeTree(Relations.toYieldGraph(), SlicePoint);
+  auto Forward = CallGraph.makeCalleeTree(SlicePoint);
   for (auto *From : Forward.nodes())
     for (auto [To, Label] : From->successor_edges())
       Label->IsBackwards = false;
@@ -595,7 +684,7 @@ std::string yield::svg::callGraphSlice(const PTMLBuilder &B,
   revng_assert(LaidOutForwardsGraph.has_value());
 
   // Ready the backwards facing part of the slice
-  auto Backwards = calls::makeCallerTree(Relations.toYieldGraph(), SlicePoint);
+  auto Backwards = CallGraph.makeCallerTree(SlicePoint);
   for (auto *From : Backwards.nodes())
     for (auto [To, Label] : From->successor_edges())
       Label->IsBackwards = true;
@@ -611,9 +700,12 @@ std::string yield::svg::callGraphSlice(const PTMLBuilder &B,
   auto CombinedGraph = combineHalvesHelper(SlicePoint,
                                            std::move(*LaidOutForwardsGraph),
                                            std::move(*LaidOutBackwardsGraph));
-  return exportGraph<false>(B,
-                            CombinedGraph,
-                            Configuration,
-                            LeftToRight,
-                            Helper);
+  return writeToString([&](llvm::raw_ostream &OS) {
+    exportGraph<false>(OS,
+                       B,
+                       CombinedGraph,
+                       Configuration,
+                       LeftToRight,
+                       Helper);
+  });
 }
@@ -50,6 +50,14 @@ class AtomicCounterWithCallback:
 
 
 class ApiWrapper:
+    # Functions that are meant to be called while another thread is running a
+    # function, these must not take the lock
+    unlocked_functions = {
+        "rp_manager_request_cancellation",
+        "rp_manager_create_progress_json",
+        "rp_manager_create_events_json",
+    }
+
     function_matcher = re.compile(
         r"(?P<return_type>[\w_]+)\s*\*\s*\/\*\s*owning\s*\*\/\s*(?P<function_name>[\w_]+)",
         re.M | re.S,
@@ -73,17 +81,28 @@ class ApiWrapper:
             else:
                 raise ValueError(f"Could not find suitable destructor for {return_type}")
 
-            self.__proxy[function_name] = self.__wrap_lock(self.__wrap_gc(function, destructor))
+            if function_name in self.unlocked_functions:
+                self.__proxy[function_name] = self.__wrap_gc(function, destructor, False)
+            else:
+                self.__proxy[function_name] = self.__wrap_lock(self.__wrap_gc(function, destructor))
 
         for attribute_name in dir(self.__api):
             if attribute_name.startswith("RP_") or attribute_name in self.__proxy:
                 continue
             function = getattr(self.__api, attribute_name)
-            self.__proxy[attribute_name] = self.__wrap_lock(function)
+            if attribute_name in self.unlocked_functions:
+                self.__proxy[attribute_name] = function
+            else:
+                self.__proxy[attribute_name] = self.__wrap_lock(function)
 
-    def __wrap_gc(self, function, destructor):
+    def __wrap_gc(self, function, destructor, lock=True):
         def wrapped_destructor(ptr):
-            with self.__lock:
+            # Objects returned by unlocked functions can be destroyed while
+            # another thread is running a function
+            if lock:
+                with self.__lock:
+                    destructor(ptr)
+            else:
                 destructor(ptr)
             self.__counter.decrement()
 
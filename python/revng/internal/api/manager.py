@@ -2,8 +2,10 @@
 # This file is distributed under the MIT License. See LICENSE.md for details.
 #
 
+import json
 from tempfile import TemporaryDirectory
-from typing import Dict, Iterable, List, Mapping, Optional
+from threading import Lock
+from typing import Any, Dict, Iterable, List, Mapping, Optional
 
 import yaml
 
@@ -36,6 +38,14 @@ class Manager:
         # Ensures that the _manager property is always defined even if the API call fails
         self._manager = None
 
+        # Results of read-only requests, they are dropped every time an operation that might change
+        # them completes. This allows to serve readers from any thread, without waiting for the
+        # operation running on the manager (e.g., a long production) to finish.
+        self._snapshot_lock = Lock()
+        self._snapshot_generation = 0
+        self._globals_snapshot: Dict[str, str] = {}
+        self._commit_index_snapshot: Optional[int] = None
+
         self._manager = _api.rp_manager_create(
             len(_flags),
             _flags,
@@ -108,6 +118,11 @@ class Manager:
         step_ptr = self._get_step_ptr(step_name)
         return self._get_container_ptr_from_step(step_name, step_ptr, container_name)
 
+    def container_memory_usage(self, step_name: str, container_name: str) -> int:
+        """Estimate of the bytes of memory used by the content of a container"""
+        _, container_ptr = self._get_step_container_ptr(step_name, container_name)
+        return _api.rp_container_memory_usage(container_ptr)
+
     # Target-related Functions
 
     def deserialize_target(self, serialized_target: str) -> Optional[Target]:
@@ -152,7 +167,9 @@ class Manager:
 
         _step, _container = self._get_step_container_ptr(step_name, container)
         error = Error()
-        product = _api.rp_manager_produce_targets(
+        # The targets are extracted one by one below, there's no need to
+        # serialize the whole container as well
+        success = _api.rp_manager_produce_targets_in_place(
             self._manager,
             _step,
             _container,
@@ -161,7 +178,7 @@ class Manager:
             error._error,
         )
 
-        if product == ffi.NULL:
+        if not success:
             return error
 
         result = {}
@@ -172,6 +189,64 @@ class Manager:
             result[produced_target.serialize()] = extracted_target
         return result
 
+    def produce_artifacts_batch(
+        self, paths: Mapping[str, List[str]], only_if_ready=False
+    ) -> Dict[str, str | bytes] | Error:
+        """Produce the artifacts at the given paths of multiple steps with a
+        single request, so that the work they have in common is done once.
+        The result is indexed by "<step>/<serialized target>"."""
+        targets: Dict[str, List[Target]] = {}
+        step_names = []
+        target_maps = []
+        for step_name, step_paths in paths.items():
+            step = self.step_from_name(step_name)
+            if step is None:
+                raise RevngException(f"Invalid step {step_name}")
+
+            container = step.Artifacts.Container
+            if container == "":
+                raise RevngException(f"Step {step_name} does not have an artifacts container")
+
+            _, _container = self._get_step_container_ptr(step_name, container)
+            target_map = ContainerToTargetsMap()
+            step_targets = []
+            for path in step_paths:
+                target = self.create_target(step_name, container, path, True)
+                target_map.add(_container, target)
+                step_targets.append(target)
+
+            targets[step_name] = step_targets
+            step_names.append(make_c_string(step_name))
+            target_maps.append(target_map)
+
+        all_targets = [t for step_targets in targets.values() for t in step_targets]
+        if len(all_targets) == 0:
+            return {}
+
+        if only_if_ready and any(not t.is_ready for t in all_targets):
+            raise RevngException("Requested production of unready targets")
+
+        error = Error()
+        success = _api.rp_manager_produce_targets_batch(
+            self._manager,
+            len(step_names),
+            step_names,
+            [m._map for m in target_maps],
+            error._error,
+        )
+
+        if not success:
+            return error
+
+        result = {}
+        for step_name, step_targets in targets.items():
+            for produced_target in step_targets:
+                extracted_target = produced_target.extract()
+                if extracted_target is None:
+                    raise RevngException(f"Target {produced_target.serialize()} extraction failed")
+                result[f"{step_name}/{produced_target.serialize()}"] = extracted_target
+        return result
+
     def create_target(
         self, step_name: str, container_name: str, target_path: str, use_artifact_kind: bool
     ) -> Target:
@@ -286,6 +361,7 @@ class Manager:
             invalidations._invalidations,
             error._error,
         )
+        self._drop_snapshot()
 
         return Expected(
             ResultWithInvalidations(
@@ -310,6 +386,7 @@ class Manager:
             invalidations._invalidations,
             error._error,
         )
+        self._drop_snapshot()
 
         return Expected(
             ResultWithInvalidations(
@@ -329,9 +406,30 @@ class Manager:
     # Global Handling & misc.
 
     def get_global(self, name) -> str:
+        result = self.get_cached_global(name)
+        if result is not None:
+            return result
+
+        generation = self._snapshot_generation
         _name = make_c_string(name)
         _out = _api.rp_manager_create_global_copy(self._manager, _name)
-        return make_python_string(_out)
+        result = make_python_string(_out)
+        with self._snapshot_lock:
+            if generation == self._snapshot_generation:
+                self._globals_snapshot[name] = result
+        return result
+
+    def get_cached_global(self, name) -> Optional[str]:
+        """Return the global if it has not changed since it has last been
+        read, None otherwise. Unlike get_global, this never waits."""
+        with self._snapshot_lock:
+            return self._globals_snapshot.get(name)
+
+    def _drop_snapshot(self):
+        with self._snapshot_lock:
+            self._snapshot_generation += 1
+            self._globals_snapshot.clear()
+            self._commit_index_snapshot = None
 
     def set_input(self, container_name: str, content: bytes, _key=None) -> Invalidations:
         step_ptr = self._get_step_ptr("begin")
@@ -346,6 +444,7 @@ class Manager:
             len(_content),
             invalidations._invalidations,
         )
+        self._drop_snapshot()
 
         if not success:
             raise RevngException(
@@ -362,4 +461,67 @@ class Manager:
         assert _api.rp_manager_set_storage_credentials(self._manager, _credentials)
 
     def get_context_commit_index(self) -> int:
-        return _api.rp_manager_get_context_commit_index(self._manager)
+        result = self.get_cached_context_commit_index()
+        if result is not None:
+            return result
+
+        generation = self._snapshot_generation
+        result = _api.rp_manager_get_context_commit_index(self._manager)
+        with self._snapshot_lock:
+            if generation == self._snapshot_generation:
+                self._commit_index_snapshot = result
+        return result
+
+    def get_cached_context_commit_index(self) -> Optional[int]:
+        """Same as get_cached_global, for the context commit index"""
+        with self._snapshot_lock:
+            return self._commit_index_snapshot
+
+    def set_profiling(self, enable: bool):
+        _api.rp_manager_set_profiling(self._manager, enable)
+
+    def get_profiling_trace(self) -> Optional[str]:
+        _out = _api.rp_manager_create_profiling_trace(self._manager)
+        if _out == ffi.NULL:
+            return None
+        return make_python_string(_out)
+
+    def estimate_invalidations(
+        self, global_name: str, diff: str
+    ) -> Expected[ResultWithInvalidations[Optional[Dict[str, float]]]]:
+        invalidations = Invalidations()
+        error = Error()
+        _out = _api.rp_manager_create_invalidation_estimate(
+            self._manager,
+            make_c_string(global_name),
+            make_c_string(diff),
+            invalidations._invalidations,
+            error._error,
+        )
+        result = yaml.safe_load(make_python_string(_out)) if _out != ffi.NULL else None
+        return Expected(ResultWithInvalidations(result, invalidations), error)
+
+    def get_statistics(self) -> str:
+        """JSON object with the statistics collected so far by all the
+        managers of this process"""
+        return make_python_string(_api.rp_statistics_create_json())
+
+    def request_cancellation(self):
+        """Stop the production of targets running in another thread, which
+        will return an error. Safe to call from any thread."""
+        _api.rp_manager_request_cancellation(self._manager)
+
+    def get_progress(self) -> Dict[str, Any]:
+        """Progress of the pipe currently running: step, pipe, targets done and
+        total, throughput and estimated remaining seconds (None if unknown).
+        Safe to call from any thread."""
+        _out = _api.rp_manager_create_progress_json(self._manager)
+        return json.loads(make_python_string(_out))
+
+    def get_events(self, since: int) -> Dict[str, Any]:
+        """Events starting from the sequence number `since`: a dict with the
+        list of `events`, the sequence number to ask for `next` and whether
+        some of the requested events were `truncated`. Safe to call from any
+        thread."""
+        _out = _api.rp_manager_create_events_json(self._manager, since)
+        return json.loads(make_python_string(_out))
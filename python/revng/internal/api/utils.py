@@ -35,8 +35,8 @@ def convert_buffer(ptr: ffi.CData, size: int, mime: str) -> str | bytes:
     if ptr == ffi.NULL:
         return b""
 
-    data = ffi.unpack(ptr, size)
+    # Decode text directly from the C buffer, without an intermediate copy
     if mime.startswith("text/") or mime == "image/svg":
-        return data.decode("utf-8")
+        return str(ffi.buffer(ptr, size), "utf-8")
     else:
-        return data
+        return ffi.unpack(ptr, size)
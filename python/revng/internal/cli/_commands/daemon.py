@@ -35,6 +35,8 @@ REVNG_NOTIFY_FIFOS: list of fifo pipes to be notified of changes in the pipeline
 REVNG_ORIGINS: comma-separated list of allowed CORS origins
 REVNG_EXPOSE_HEADERS: comma-separated list of response headers to expose via CORS
 REVNG_C_API_TRACE_PATH: path to file to use to save api tracing, useful for debugging
+REVNG_PREFETCH_BUDGET: maximum number of function artifacts to speculatively produce after
+  each interactive request, 0 (the default) disables prefetching
 
 Persistence:
 If the REVNG_DATA_DIR environment variable is set, the the data is persisted across
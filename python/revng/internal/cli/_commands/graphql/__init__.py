@@ -12,7 +12,8 @@ from typing import List
 from revng.internal.cli.commands_registry import Command, CommandsRegistry, Options
 
 from .daemon_handler import DaemonHandler, ExternalDaemonHandler, InternalDaemonHandler
-from .runner import Runner, produce_artifacts, run_analyses_lists, run_on_daemon, upload_file
+from .runner import Runner, produce_artifact, produce_artifacts, run_analyses_lists, run_on_daemon
+from .runner import upload_file
 
 
 class GraphQLCommand(Command):
@@ -45,7 +46,26 @@ class GraphQLCommand(Command):
             "--analyses-list", action="append", help="Analyses lists to run after upload"
         )
         parser.add_argument(
-            "executable", metavar="EXECUTABLE", help="Executable to run the test with"
+            "--artifact",
+            metavar="STEP",
+            help="Produce the artifact of the specified step and save it to --output",
+        )
+        parser.add_argument(
+            "--artifact-path",
+            action="append",
+            default=[],
+            help="Path of the artifact to produce, can be repeated. Defaults to the empty path",
+        )
+        parser.add_argument("-o", "--output", default="/dev/stdout", help="Output of --artifact")
+        parser.add_argument(
+            "executable",
+            metavar="EXECUTABLE",
+            nargs="?",
+            help=(
+                "Executable to run the test with. Can be omitted when using an external daemon "
+                "which already has an input, so that a long-running daemon can serve many "
+                "requests without paying the startup cost of the pipeline each time"
+            ),
         )
 
     def run(self, options: Options):
@@ -65,9 +85,15 @@ class GraphQLCommand(Command):
             env = {k: v for k, v in os.environ.items() if k not in self.FILTER_ENV}
             self.daemon_handler = InternalDaemonHandler(url, options, env)
 
-        executable_path = args.executable
-        assert os.path.isfile(executable_path), "Executable file not found"
-        runners: List[Runner] = [upload_file(executable_path)]
+        if args.executable is None and args.external is None:
+            self.log("EXECUTABLE can only be omitted with --external")
+            return 1
+
+        runners: List[Runner] = []
+        if args.executable is not None:
+            executable_path = args.executable
+            assert os.path.isfile(executable_path), "Executable file not found"
+            runners.append(upload_file(executable_path))
 
         if args.analyses_list is not None:
             runners.append(run_analyses_lists(args.analyses_list))
@@ -75,6 +101,9 @@ class GraphQLCommand(Command):
         if args.produce_artifacts:
             runners.append(produce_artifacts(args.filter_artifacts))
 
+        if args.artifact is not None:
+            runners.append(produce_artifact(args.artifact, args.artifact_path, args.output))
+
         run_rc = asyncio.run(run_on_daemon(self.daemon_handler, runners))
         if run_rc != 0:
             self.log(f"run_on_daemon exited with code {run_rc}")
@@ -5,6 +5,7 @@
 import asyncio
 import json
 import sys
+from base64 import b64decode
 from graphlib import TopologicalSorter
 from typing import Awaitable, Callable, Iterable, List, Tuple
 
@@ -158,6 +159,62 @@ def produce_artifacts(filter_: List[str] | None = None):
     return runner
 
 
+def produce_artifact(step_name: str, paths: List[str], output: str):
+    """Produce the artifacts at the given paths of a single step and write them to output. If a
+    single artifact is requested, output will contain just it, otherwise it will contain a JSON
+    object mapping each target to its (base64-encoded, unless textual) content."""
+
+    async def runner(client: AsyncClientSession):
+        q = gql("""{ pipelineDescription contextCommitIndex }""")
+        req = await client.execute(q)
+        description = yaml.load(req["pipelineDescription"], Loader=YamlLoader)
+        index = req["contextCommitIndex"]
+
+        step = next((s for s in description.Steps if s.Name == step_name), None)
+        assert step is not None, f"Missing step {step_name}"
+        assert step.Artifacts != Artifacts(), f"Step {step_name} has no artifacts"
+
+        log(f"Producing {step_name}")
+        q = gql(
+            """
+        query($step: String!, $paths: String, $index: BigInt!) {
+            produceArtifacts(step: $step, paths: $paths, index: $index) {
+                __typename
+                ... on Produced {
+                    result
+                }
+                ... on SimpleError {
+                    errorType
+                    message
+                }
+            }
+        }"""
+        )
+        arguments = {"step": step_name, "paths": ",".join(paths) if paths else None}
+        result = await client.execute(q, {**arguments, "index": index})
+        if result["produceArtifacts"]["__typename"] != "Produced":
+            log(f"Production failed: {json.dumps(result, indent=2)}")
+            assert False
+
+        json_result = json.loads(result["produceArtifacts"]["result"])
+        if len(json_result) != 1:
+            with open(output, "w", encoding="utf-8") as output_file:
+                json.dump(json_result, output_file)
+            return
+
+        content = next(iter(json_result.values()))
+        container = next(c for c in description.Containers if c.Name == step.Artifacts.Container)
+        mime = container.MIMEType
+        if mime.startswith("text/") or mime == "image/svg":
+            with open(output, "w", encoding="utf-8") as output_file:
+                output_file.write(content)
+        else:
+            with open(output, "wb") as output_file:
+                output_file.write(b64decode(content))
+
+    return runner
+
+
 async def check_server_up(url: str):
     connector, address = get_connection(url)
     session = ClientSession(connector=connector, timeout=ClientTimeout())
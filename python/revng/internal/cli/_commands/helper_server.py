@@ -0,0 +1,73 @@
+#
+# This file is distributed under the MIT License. See LICENSE.md for details.
+#
+
+# `revng helper-server` runs `revng` commands on behalf of ProgramRunner (see
+# ProgramRunner.cpp), so that repeated invocations of Python helpers (e.g.,
+# `merge-dynamic` or `model fetch-debuginfo`) pay the startup of the
+# interpreter only once.
+#
+# The protocol goes through a stream socket inherited as file descriptor 3.
+# Each request is a JSON object on a single line:
+#
+#     {"arguments": ["model", "fetch-debuginfo", "/lib/libc.so.6"], "cwd": "/"}
+#
+# Each response is a JSON object on a single line:
+#
+#     {"exit_code": 0}
+#
+# The commands write to the standard output and error of the server, which are
+# inherited from the client. The server exits when the socket is closed.
+
+import json
+import os
+import socket
+import sys
+import traceback
+
+from revng.internal.cli.commands_registry import Command, CommandsRegistry, Options
+from revng.internal.cli.revng import run_revng_command
+
+CHANNEL_FD = 3
+
+
+def run_request(request: dict, options: Options) -> int:
+    try:
+        os.chdir(request["cwd"])
+        result = run_revng_command(request["arguments"], options)
+    except SystemExit as exit_exception:
+        if exit_exception.code is None:
+            result = 0
+        elif isinstance(exit_exception.code, int):
+            result = exit_exception.code
+        else:
+            result = 1
+    except Exception:
+        traceback.print_exc()
+        result = 1
+    finally:
+        sys.stdout.flush()
+        sys.stderr.flush()
+
+    return result if result is not None else 0
+
+
+class HelperServerCommand(Command):
+    def __init__(self):
+        super().__init__(("helper-server",), "Run revng commands requested through a socket")
+
+    def register_arguments(self, parser):
+        pass
+
+    def run(self, options: Options):
+        channel = socket.socket(fileno=CHANNEL_FD)
+        with channel.makefile("rw") as stream:
+            for line in stream:
+                exit_code = run_request(json.loads(line), options)
+                stream.write(json.dumps({"exit_code": exit_code}) + "\n")
+                stream.flush()
+        return 0
+
+
+def setup(commands_registry: CommandsRegistry):
+    commands_registry.register_command(HelperServerCommand())
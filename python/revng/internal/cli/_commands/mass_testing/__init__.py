@@ -5,6 +5,7 @@
 from ...commands_registry import CommandsRegistry
 from .configure import MassTestingConfigureCommand
 from .generate_report import MassTestingGenerateReportCommand
+from .performance import MassTestingComparePerformanceCommand, MassTestingPerformanceSummaryCommand
 from .run import MassTestingRunCommand
 
 
@@ -12,3 +13,5 @@ def setup(commands_registry: CommandsRegistry):
     commands_registry.register_command(MassTestingConfigureCommand())
     commands_registry.register_command(MassTestingRunCommand())
     commands_registry.register_command(MassTestingGenerateReportCommand())
+    commands_registry.register_command(MassTestingPerformanceSummaryCommand())
+    commands_registry.register_command(MassTestingComparePerformanceCommand())
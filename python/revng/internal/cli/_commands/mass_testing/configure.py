@@ -24,6 +24,11 @@ class MassTestingConfigureCommand(Command):
         parser.description = "Collect binary files and run test-configure"
         parser.add_argument("--meta", help="Metadata definition")
         parser.add_argument("--seed", help="Seed to use in the RNG for shuffling")
+        parser.add_argument(
+            "--largest-first",
+            action="store_true",
+            help="Instead of shuffling, sort the inputs by decreasing size",
+        )
         parser.add_argument("input", help="Input directory")
         parser.add_argument("output", help="Output directory")
         parser.add_argument(
@@ -48,6 +53,12 @@ class MassTestingConfigureCommand(Command):
             seed = getrandbits(32)
         Random(seed).shuffle(file_list)
 
+        # Starting from the biggest inputs, which are expected to take longer,
+        # avoids having a few long tests left running at the end on an
+        # otherwise idle machine
+        if args.largest_first:
+            file_list.sort(key=lambda name: (input_path / name).stat().st_size, reverse=True)
+
         data = {"sources": [{"members": file_list}]}
         binaries_yml = NamedTemporaryFile("w", suffix=".yml")
         yaml.safe_dump(data, binaries_yml)
@@ -0,0 +1,247 @@
+#
+# This file is distributed under the MIT License. See LICENSE.md for details.
+#
+
+# Performance tracking over a mass-testing run. When the run is performed with
+# `mass-testing run --profile`, each test directory contains `profile.json`, a
+# Chrome trace of the analyses, steps and pipes that have been run. This file
+# provides:
+# * `mass-testing performance-summary`, which condenses the profiles and the
+#   `test-harness.json` files of a run in a single JSON file, suitable to be
+#   stored as a baseline
+# * `mass-testing compare-performance`, which compares two runs (or their
+#   summaries), prints a report and returns a non-zero exit code if any
+#   component got significantly slower or bigger
+
+import argparse
+import json
+import math
+import os
+import sys
+from collections import defaultdict
+from pathlib import Path
+from statistics import mean, stdev
+from typing import Dict, List
+
+from ...commands_registry import Command, Options
+from .generate_report.test_directory import TestDirectory
+
+# Metric name -> (key in the trace event arguments, minimum baseline value for
+# a sample to be considered). Samples below the minimum are dominated by noise.
+EVENT_METRICS = {
+    "wall_time_s": ("dur", 0.05),
+    "cpu_time_s": ("cpu-time-us", 0.05),
+    "peak_rss_delta_mib": ("peak-rss-delta-kib", 16),
+}
+
+# Conversion factors from the units of the trace to the ones of EVENT_METRICS
+EVENT_SCALE = {
+    "dur": 1e-6,
+    "cpu-time-us": 1e-6,
+    "peak-rss-delta-kib": 1 / 1024,
+}
+
+TOTAL_METRICS = {
+    "wall_time_s": 0.05,
+    "max_rss_mib": 16,
+}
+
+# Two-sided 95% quantile of the standard normal distribution
+Z_95 = 1.96
+
+Summary = Dict[str, Dict[str, Dict[str, float]]]
+
+
+def summarize_test(test: TestDirectory) -> Dict[str, Dict[str, float]]:
+    # Returns a dictionary from component (e.g., "pipe/lift" or "total") to
+    # metric name to value. Events with the same component are summed.
+    time_data = test.test_harness_data["time"]
+    result: Dict[str, Dict[str, float]] = {
+        "total": {
+            "wall_time_s": time_data["elapsed_time"],
+            "max_rss_mib": time_data["max_resident_set_size"] / 1024,
+        }
+    }
+
+    profile = test.path / "profile.json"
+    if not profile.is_file():
+        return result
+
+    with open(profile) as f:
+        events = json.load(f)["traceEvents"]
+
+    components: Dict[str, Dict[str, float]] = defaultdict(lambda: defaultdict(float))
+    for event in events:
+        # Results coming from the cache are not representative of the cost
+        if event["args"].get("from-cache", False):
+            continue
+
+        component = components[f"{event['cat']}/{event['name']}"]
+        for metric, (key, _) in EVENT_METRICS.items():
+            value = event["dur"] if key == "dur" else event["args"][key]
+            component[metric] += value * EVENT_SCALE[key]
+
+    for name, metrics in components.items():
+        result[name] = dict(metrics)
+    return result
+
+
+def summarize_directory(input_dir: str | Path) -> Summary:
+    # Summarize all the tests that have completed successfully, failed tests
+    # would skew the comparison
+    result: Summary = {}
+    for dirpath, _, _ in os.walk(input_dir):
+        test = TestDirectory(dirpath, os.path.relpath(dirpath, input_dir))
+        if test.is_valid() and test.status == "OK":
+            result[test.name] = summarize_test(test)
+    return result
+
+
+def load_summary(path: str | Path) -> Summary:
+    # Accept both a mass-testing output directory and the output of
+    # `mass-testing performance-summary`
+    if Path(path).is_dir():
+        return summarize_directory(path)
+
+    with open(path) as f:
+        return json.load(f)["tests"]
+
+
+def minimum_value(metric: str) -> float:
+    if metric in TOTAL_METRICS:
+        return TOTAL_METRICS[metric]
+    return EVENT_METRICS[metric][1]
+
+
+def compare(baseline: Summary, current: Summary, threshold: float) -> List[dict]:
+    # For each (component, metric), collect the ratio current/baseline of each
+    # test that is present in both runs
+    ratios: Dict[tuple, List[float]] = defaultdict(list)
+    for test_name in baseline.keys() & current.keys():
+        for component, metrics in baseline[test_name].items():
+            if component not in current[test_name]:
+                continue
+
+            current_metrics = current[test_name][component]
+            for metric, before in metrics.items():
+                after = current_metrics.get(metric)
+                minimum = minimum_value(metric)
+                if after is None or before < minimum:
+                    continue
+                ratios[(component, metric)].append(max(after, minimum) / before)
+
+    # Ratios are multiplicative, hence work on their logarithm: the mean of the
+    # logarithms is the logarithm of the geometric mean
+    rows = []
+    for (component, metric), samples in ratios.items():
+        logs = [math.log(ratio) for ratio in samples]
+        log_mean = mean(logs)
+        if len(logs) > 1:
+            margin = Z_95 * stdev(logs) / math.sqrt(len(logs))
+        else:
+            margin = math.inf
+
+        ratio = math.exp(log_mean)
+        low = math.exp(log_mean - margin)
+        high = math.exp(log_mean + margin)
+
+        # A regression must be both large and statistically significant
+        if ratio > 1 + threshold and low > 1:
+            status = "REGRESSION"
+        elif ratio < 1 - threshold and high < 1:
+            status = "IMPROVEMENT"
+        else:
+            status = "OK"
+
+        rows.append(
+            {
+                "component": component,
+                "metric": metric,
+                "samples": len(samples),
+                "ratio": ratio,
+                "ratio_low": low,
+                "ratio_high": high,
+                "status": status,
+            }
+        )
+
+    rows.sort(key=lambda row: (row["status"] != "REGRESSION", -row["ratio"]))
+    return rows
+
+
+def print_report(rows: List[dict], file=sys.stdout):
+    header = ("Status", "Component", "Metric", "Samples", "Ratio", "95% CI")
+    lines = [header]
+    for row in rows:
+        lines.append(
+            (
+                row["status"],
+                row["component"],
+                row["metric"],
+                str(row["samples"]),
+                f"{row['ratio']:.3f}",
+                f"[{row['ratio_low']:.3f}, {row['ratio_high']:.3f}]",
+            )
+        )
+
+    widths = [max(len(line[i]) for line in lines) for i in range(len(header))]
+    for line in lines:
+        file.write("  ".join(cell.ljust(width) for cell, width in zip(line, widths)).rstrip())
+        file.write("\n")
+
+
+class MassTestingPerformanceSummaryCommand(Command):
+    def __init__(self):
+        super().__init__(
+            ("mass-testing", "performance-summary"),
+            "Summarize the performance data of a mass-testing run",
+        )
+
+    def register_arguments(self, parser: argparse.ArgumentParser):
+        parser.description = (
+            "Summarize the performance data of a mass-testing run, e.g., to store it as a baseline"
+        )
+        parser.add_argument("input", help="Input directory")
+        parser.add_argument("output", help="Output JSON file")
+
+    def run(self, options: Options):
+        args = options.parsed_args
+        with open(args.output, "w") as f:
+            json.dump({"tests": summarize_directory(args.input)}, f, indent=2, sort_keys=True)
+
+
+class MassTestingComparePerformanceCommand(Command):
+    def __init__(self):
+        super().__init__(
+            ("mass-testing", "compare-performance"),
+            "Compare the performance of two mass-testing runs",
+        )
+
+    def register_arguments(self, parser: argparse.ArgumentParser):
+        parser.description = (
+            "Compare the performance of two mass-testing runs. Each run can be either an output "
+            "directory or a summary produced by performance-summary. Returns 1 if any component "
+            "got significantly worse."
+        )
+        parser.add_argument(
+            "--threshold",
+            type=float,
+            default=0.2,
+            help="Relative slowdown considered a regression (default: 0.2)",
+        )
+        parser.add_argument("--json", help="Also save the report in JSON to the specified file")
+        parser.add_argument("baseline", help="Baseline run")
+        parser.add_argument("current", help="Run to check")
+
+    def run(self, options: Options):
+        args = options.parsed_args
+        rows = compare(load_summary(args.baseline), load_summary(args.current), args.threshold)
+
+        print_report(rows)
+        if args.json is not None:
+            with open(args.json, "w") as f:
+                json.dump(rows, f, indent=2)
+
+        if any(row["status"] == "REGRESSION" for row in rows):
+            return 1
+        return 0
@@ -6,6 +6,7 @@ import argparse
 import os
 import time
 from pathlib import Path
+from shutil import rmtree
 from subprocess import run
 
 import yaml
@@ -21,6 +22,23 @@ class MassTestingRunCommand(Command):
 
     def register_arguments(self, parser: argparse.ArgumentParser):
         parser.description = "Run a mass-testing configuration"
+        parser.add_argument(
+            "--profile",
+            action="store_true",
+            help="Save the profile of each test as profile.json, see compare-performance",
+        )
+        parser.add_argument(
+            "--jobs",
+            "-j",
+            type=int,
+            help="Number of tests to run in parallel (default: number of CPUs)",
+        )
+        parser.add_argument(
+            "--memory-budget",
+            type=int,
+            help="Memory, in bytes, that all the running tests together can reserve"
+            " (default: 80%% of the total memory, 0 to use a fixed limit per test)",
+        )
         parser.add_argument("build_dir", help="Build directory")
 
     def run(self, options: Options):
@@ -39,5 +57,28 @@ class MassTestingRunCommand(Command):
         new_env = os.environ.copy()
         bin_dir = get_root() / "libexec/revng/mass-testing"
         new_env["PATH"] = f"{bin_dir.resolve()!s}:{new_env['PATH']}"
+        if args.profile:
+            new_env["MASS_TESTING_PROFILE"] = "1"
 
-        run(["ninja", "--quiet", "-k0", "-C", args.build_dir], env=new_env, check=True)
+        # Tests reserve their estimated memory usage against a shared budget
+        # (see test-harness): instead of each test having a fixed share of the
+        # memory, big tests can use more of it, while the others wait
+        jobs = args.jobs if args.jobs is not None else meta_data["cpu_count"]
+        if args.memory_budget is None:
+            total_memory = os.sysconf("SC_PAGE_SIZE") * os.sysconf("SC_PHYS_PAGES")
+            memory_budget = int(total_memory * 0.8)
+        else:
+            memory_budget = args.memory_budget
+
+        if memory_budget > 0:
+            scheduler_dir = Path(args.build_dir) / "scheduler"
+            rmtree(scheduler_dir, ignore_errors=True)
+            scheduler_dir.mkdir()
+            new_env["MASS_TESTING_SCHEDULER_DIR"] = str(scheduler_dir.resolve())
+            new_env["MASS_TESTING_MEMORY_BUDGET"] = str(memory_budget)
+
+        run(
+            ["ninja", "--quiet", "-k0", f"-j{jobs}", "-C", args.build_dir],
+            env=new_env,
+            check=True,
+        )
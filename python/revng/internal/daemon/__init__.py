@@ -2,7 +2,6 @@
 # This file is distributed under the MIT License. See LICENSE.md for details.
 #
 
-import asyncio
 import logging
 import os
 import signal
@@ -31,7 +30,9 @@ from revng.internal.api._capi import initialize as capi_initialize
 from revng.internal.api._capi import shutdown as capi_shutdown
 
 from .event_manager import EventManager
-from .graphql import get_schema
+from .graphql import get_schema, run_in_executor
+from .prefetch import Prefetcher
+from .priority_lock import PriorityLock
 from .util import project_workdir
 
 config = Config()
@@ -147,14 +148,20 @@ def make_startlette() -> Starlette:
         else:
             return PlainTextResponse("KO", 503)
 
+    # Lock for operations that have an `index` parameter. This is needed
+    # because otherwise there's a TOCTOU between when the index is checked and
+    # when the analysis actually bumps the index. It's shared by all the
+    # requests and serves interactive requests before bulk ones.
+    index_lock = PriorityLock()
+    prefetch_budget = int(os.environ.get("REVNG_PREFETCH_BUDGET", "0"))
+    prefetcher = Prefetcher(manager, index_lock, run_in_executor, prefetch_budget)
+
     def generate_context(request: Request):
         return {
             "manager": manager,
             "event_manager": event_manager,
-            # Lock for operations that have an `index` parameter. This is
-            # needed because otherwise there's a TOCTOU between when the index
-            # is checked and when the analysis actually bumps the index.
-            "index_lock": asyncio.Lock(),
+            "index_lock": index_lock,
+            "prefetcher": prefetcher,
             "headers": request.headers,
         }
 
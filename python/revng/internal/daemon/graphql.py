@@ -10,7 +10,7 @@ from concurrent.futures import ThreadPoolExecutor
 from dataclasses import dataclass
 from functools import partial
 from pathlib import Path
-from typing import AsyncGenerator, Awaitable, Callable, Optional, ParamSpec, TypeVar
+from typing import AsyncGenerator, Awaitable, Callable, Dict, List, Optional, ParamSpec, TypeVar
 
 from starlette.datastructures import UploadFile
 
@@ -23,6 +23,8 @@ from revng.internal.api.target import Target
 
 from .event_manager import EventType, emit_event
 from .multiqueue import MultiQueue
+from .prefetch import Prefetcher
+from .priority_lock import Priority, PriorityLock
 from .util import produce_serializer
 
 
@@ -34,6 +36,8 @@ class Invalidation:
 
 executor = ThreadPoolExecutor(1)
 invalidation_queue: MultiQueue[Invalidation] = MultiQueue()
+# Notifies the subscribers of `events` that new events might be available
+events_queue: MultiQueue[None] = MultiQueue()
 
 T = TypeVar("T")
 P = ParamSpec("P")
@@ -82,6 +86,44 @@ document_error_type.set_alias("locationType", "location_type")
 bigint_scalar = ScalarType("BigInt", serializer=str, value_parser=int)
 
 
+# Number of targets produced while holding the index lock when serving a
+# request with many targets. Between chunks, interactive requests (i.e., the
+# ones with at most this many targets) can take over.
+PRODUCE_CHUNK_SIZE = 8
+
+
+async def produce_in_chunks(
+    info,
+    index: int,
+    targets: List[T],
+    produce: Callable[[List[T]], Dict[str, str | bytes] | Error],
+):
+    manager: Manager = info.context["manager"]
+    index_lock: PriorityLock = info.context["index_lock"]
+    if len(targets) <= PRODUCE_CHUNK_SIZE:
+        priority = Priority.INTERACTIVE
+    else:
+        priority = Priority.BULK
+
+    result: Dict[str, str | bytes] = {}
+    for start in range(0, len(targets), PRODUCE_CHUNK_SIZE):
+        async with index_lock.priority(priority):
+            # Check the index for every chunk, since it might have been
+            # changed by requests served in between
+            current_index = await run_in_executor(manager.get_context_commit_index)
+            if current_index != index:
+                return CommitIndexError(current_index)
+
+            chunk = targets[start : start + PRODUCE_CHUNK_SIZE]
+            chunk_result = await run_in_executor(produce, chunk)
+            await events_queue.send(None)
+            if isinstance(chunk_result, Error):
+                return chunk_result.unwrap()
+            result.update(chunk_result)
+
+    return Produced(produce_serializer(result))
+
+
 @query.field("produce")
 async def resolve_produce(
     obj,
@@ -94,20 +136,13 @@ async def resolve_produce(
     index: int,
 ):
     manager: Manager = info.context["manager"]
-    index_lock: asyncio.Lock = info.context["index_lock"]
-    async with index_lock:
-        current_index = await run_in_executor(manager.get_context_commit_index)
-        if current_index != index:
-            return CommitIndexError(current_index)
-
-        targets = targetList.split(",")
-        result = await run_in_executor(
-            manager.produce_target, step, targets, container, onlyIfReady
-        )
-        if isinstance(result, Error):
-            return result.unwrap()
-        else:
-            return Produced(produce_serializer(result))
+    targets = targetList.split(",")
+    return await produce_in_chunks(
+        info,
+        index,
+        targets,
+        lambda chunk: manager.produce_target(step, chunk, container, onlyIfReady),
+    )
 
 
 @query.field("produceArtifacts")
@@ -121,16 +156,46 @@ async def resolve_produce_artifacts(
     index: int,
 ):
     manager: Manager = info.context["manager"]
-    index_lock: asyncio.Lock = info.context["index_lock"]
+    # Producing the whole container is a single chunk
+    targets: List[Optional[str]] = paths.split(",") if paths is not None else [None]
+
+    def produce(chunk: List[Optional[str]]):
+        chunk_targets = None if chunk == [None] else chunk
+        return manager.produce_target(step, chunk_targets, only_if_ready=onlyIfReady)
+
+    result = await produce_in_chunks(info, index, targets, produce)
+    if isinstance(result, Produced) and paths is not None and len(targets) <= PRODUCE_CHUNK_SIZE:
+        prefetcher: Prefetcher = info.context["prefetcher"]
+        prefetcher.notify(step, paths.split(","), index)
+    return result
+
+
+@query.field("produceArtifactsBatch")
+async def resolve_produce_artifacts_batch(
+    obj,
+    info,
+    *,
+    paths: str,
+    onlyIfReady=False,  # noqa: N803
+    index: int,
+):
+    manager: Manager = info.context["manager"]
+    index_lock: PriorityLock = info.context["index_lock"]
     async with index_lock:
         current_index = await run_in_executor(manager.get_context_commit_index)
         if current_index != index:
             return CommitIndexError(current_index)
 
-        targets = paths.split(",") if paths is not None else None
+        # Each element is "<step>/<path>", where path can be empty
+        step_paths: Dict[str, List[str]] = {}
+        for step_path in paths.split(","):
+            step, _, path = step_path.partition("/")
+            step_paths.setdefault(step, []).append(path)
+
         result = await run_in_executor(
-            manager.produce_target, step, targets, only_if_ready=onlyIfReady
+            manager.produce_artifacts_batch, step_paths, only_if_ready=onlyIfReady
         )
+        await events_queue.send(None)
         if isinstance(result, Error):
             return result.unwrap()
         else:
@@ -154,30 +219,62 @@ async def resolve_target(_, info, *, step: str, container: str, target: str) ->
 @query.field("getGlobal")
 async def resolve_get_global(_, info, *, name: str) -> str:
     manager: Manager = info.context["manager"]
+    # Avoid waiting for the executor if the global did not change
+    result = manager.get_cached_global(name)
+    if result is not None:
+        return result
     return await run_in_executor(manager.get_global, name)
 
 
 @query.field("pipelineDescription")
 async def resolve_pipeline_description(_, info) -> str:
     manager: Manager = info.context["manager"]
-    return await run_in_executor(manager.get_pipeline_description)
+    # The description never changes, there's no need to go through the executor
+    return manager.get_pipeline_description()
 
 
 @query.field("contextCommitIndex")
 async def resolve_context_commit_index(_, info) -> int:
     manager: Manager = info.context["manager"]
+    result = manager.get_cached_context_commit_index()
+    if result is not None:
+        return result
     return await run_in_executor(manager.get_context_commit_index)
 
 
+@query.field("progress")
+async def resolve_progress(_, info):
+    # This must not go through the executor, which is busy with the production
+    manager: Manager = info.context["manager"]
+    progress = manager.get_progress()
+    return {
+        "running": progress["running"],
+        "step": progress["step"],
+        "pipe": progress["pipe"],
+        "doneTargets": progress["done-targets"],
+        "totalTargets": progress["total-targets"],
+        "targetsPerSecond": progress["targets-per-second"],
+        "remainingSeconds": progress["remaining-seconds"],
+    }
+
+
+@query.field("events")
+async def resolve_events(_, info, *, since: int):
+    # Like progress, this does not need to wait for the executor
+    manager: Manager = info.context["manager"]
+    return manager.get_events(since)
+
+
 @mutation.field("uploadB64")
 @emit_event(EventType.BEGIN)
 async def resolve_upload_b64(_, info, *, input: str, container: str):  # noqa: A002
     manager: Manager = info.context["manager"]
-    index_lock: asyncio.Lock = info.context["index_lock"]
+    index_lock: PriorityLock = info.context["index_lock"]
     async with index_lock:
         invalidations = await run_in_executor(manager.set_input, container, b64decode(input))
         index = await run_in_executor(manager.get_context_commit_index)
         await invalidation_queue.send(Invalidation(index, str(invalidations)))
+        await events_queue.send(None)
         logging.info(f"Saved file for container {container}")
         return True
 
@@ -186,16 +283,25 @@ async def resolve_upload_b64(_, info, *, input: str, container: str):  # noqa: A
 @emit_event(EventType.BEGIN)
 async def resolve_upload_file(_, info, *, file: UploadFile, container: str):
     manager: Manager = info.context["manager"]
-    index_lock: asyncio.Lock = info.context["index_lock"]
+    index_lock: PriorityLock = info.context["index_lock"]
     async with index_lock:
         contents = await file.read()
         invalidations = await run_in_executor(manager.set_input, container, contents)
         index = await run_in_executor(manager.get_context_commit_index)
         await invalidation_queue.send(Invalidation(index, str(invalidations)))
+        await events_queue.send(None)
         logging.info(f"Saved file for container {container}")
         return True
 
 
+@mutation.field("cancelProduction")
+async def resolve_cancel_production(_, info):
+    # This must not go through the executor, which is busy with the production
+    manager: Manager = info.context["manager"]
+    manager.request_cancellation()
+    return True
+
+
 @mutation.field("runAnalysis")
 @emit_event(EventType.CONTEXT)
 async def resolve_run_analysis(
@@ -209,7 +315,7 @@ async def resolve_run_analysis(
     index: int,
 ):
     manager: Manager = info.context["manager"]
-    index_lock: asyncio.Lock = info.context["index_lock"]
+    index_lock: PriorityLock = info.context["index_lock"]
     async with index_lock:
         current_index = await run_in_executor(manager.get_context_commit_index)
         if current_index != index:
@@ -225,6 +331,7 @@ async def resolve_run_analysis(
             real_result = result.unwrap()
             new_index = await run_in_executor(manager.get_context_commit_index)
             await invalidation_queue.send(Invalidation(new_index, str(real_result.invalidations)))
+            await events_queue.send(None)
             return Diff(json.dumps(real_result.result))
         else:
             return result.error.unwrap()
@@ -234,7 +341,7 @@ async def resolve_run_analysis(
 @emit_event(EventType.CONTEXT)
 async def resolve_run_analyses_list(_, info, *, name: str, options: str | None = None, index: int):
     manager: Manager = info.context["manager"]
-    index_lock: asyncio.Lock = info.context["index_lock"]
+    index_lock: PriorityLock = info.context["index_lock"]
     async with index_lock:
         current_index = await run_in_executor(manager.get_context_commit_index)
         if current_index != index:
@@ -247,6 +354,7 @@ async def resolve_run_analyses_list(_, info, *, name: str, options: str | None =
             real_result = result.unwrap()
             new_index = await run_in_executor(manager.get_context_commit_index)
             await invalidation_queue.send(Invalidation(new_index, str(real_result.invalidations)))
+            await events_queue.send(None)
             return Diff(json.dumps(real_result.result))
         else:
             return result.error.unwrap()
@@ -292,6 +400,25 @@ async def invalidations(message: Invalidation, info):
     return message
 
 
+@subscription.source("events")
+async def events_generator(_, info, *, since: int) -> AsyncGenerator[Dict, None]:
+    manager: Manager = info.context["manager"]
+    with events_queue.stream() as stream:
+        batch = manager.get_events(since)
+        if batch["events"] or batch["truncated"]:
+            yield batch
+
+        async for _ in stream:
+            batch = manager.get_events(batch["next"])
+            if batch["events"] or batch["truncated"]:
+                yield batch
+
+
+@subscription.field("events")
+async def events(message: Dict, info):
+    return message
+
+
 def get_schema():
     schema_file = (Path(__file__).parent.resolve()) / "schema.graphql"
     return make_executable_schema(
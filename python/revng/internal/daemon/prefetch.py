@@ -0,0 +1,164 @@
+#
+# This file is distributed under the MIT License. See LICENSE.md for details.
+#
+
+import asyncio
+import logging
+from collections import deque
+from typing import Awaitable, Callable, Deque, Dict, List, Optional, Set, Tuple
+
+import yaml
+
+from revng.internal.api import Manager
+from revng.internal.api.errors import Error
+
+from .priority_lock import Priority, PriorityLock
+
+logger = logging.getLogger(__name__)
+
+# Number of distinct steps remembered as the recent navigation history
+HISTORY_SIZE = 4
+
+CROSS_RELATIONS_STEP = "isolate"
+CROSS_RELATIONS_CONTAINER = "cross-relations.yml"
+
+Executor = Callable[..., Awaitable]
+
+
+class Prefetcher:
+    """Speculatively produces, at the lowest priority, the function artifacts
+    the user is likely to request next: the same functions in the steps
+    requested recently (e.g., the CFG after the disassembly) and their callers
+    and callees, according to the cross relations. Every navigation drops what
+    was still to be prefetched for the previous one.
+
+    At most `budget` targets are produced for every navigation, a budget of 0
+    disables prefetching."""
+
+    def __init__(
+        self, manager: Manager, index_lock: PriorityLock, run_in_executor: Executor, budget: int
+    ):
+        self.manager = manager
+        self.index_lock = index_lock
+        self.run_in_executor = run_in_executor
+        self.budget = budget
+        self.history: Deque[str] = deque(maxlen=HISTORY_SIZE)
+        self.task: Optional[asyncio.Task] = None
+        # Cross relations, as a map from each function to its neighbours,
+        # together with the commit index they have been computed at
+        self.neighbours: Dict[str, Set[str]] = {}
+        self.neighbours_index: Optional[int] = None
+
+    @property
+    def enabled(self) -> bool:
+        return self.budget > 0
+
+    def notify(self, step: str, paths: List[str], index: int):
+        """Record that the given paths of step have been requested at index and
+        start prefetching their likely successors"""
+        if not self.enabled or not self.has_function_artifacts(step):
+            return
+
+        if step in self.history:
+            self.history.remove(step)
+        self.history.append(step)
+
+        if self.task is not None:
+            self.task.cancel()
+        self.task = asyncio.create_task(self.prefetch(step, paths, index))
+
+    def has_function_artifacts(self, step_name: str) -> bool:
+        step = self.manager.step_from_name(step_name)
+        if step is None or step.Artifacts.Kind == "":
+            return False
+        kind = self.manager.kind_from_name(step.Artifacts.Kind)
+        return kind is not None and kind.Rank == "function"
+
+    async def prefetch(self, step: str, paths: List[str], index: int):
+        try:
+            for candidate_step, path in await self.candidates(step, paths, index):
+                async with self.index_lock.priority(Priority.SPECULATIVE):
+                    current_index = await self.run_in_executor(
+                        self.manager.get_context_commit_index
+                    )
+                    if current_index != index:
+                        return
+                    await self.run_in_executor(self.produce, candidate_step, path)
+        except asyncio.CancelledError:
+            pass
+
+    def produce(self, step: str, path: str):
+        try:
+            result = self.manager.produce_target(step, [path])
+            if isinstance(result, Error):
+                logger.debug("Prefetching %s/%s failed", step, path)
+        except Exception:
+            logger.debug("Cannot prefetch %s/%s", step, path, exc_info=True)
+
+    async def candidates(self, step: str, paths: List[str], index: int) -> List[Tuple[str, str]]:
+        neighbours: List[str] = []
+        if self.neighbours_index != index:
+            await self.load_neighbours(index)
+        for path in paths:
+            neighbours.extend(sorted(self.neighbours.get(path, ())))
+
+        # Most recent steps first, the requested one included for neighbours
+        steps = list(reversed(self.history))
+        result: List[Tuple[str, str]] = []
+        for path in paths:
+            result.extend((other_step, path) for other_step in steps if other_step != step)
+        for path in neighbours:
+            result.extend((other_step, path) for other_step in steps)
+
+        # Keep the first occurrence of each candidate
+        return list(dict.fromkeys(result))[: self.budget]
+
+    async def load_neighbours(self, index: int):
+        self.neighbours = {}
+        self.neighbours_index = index
+
+        # Computing the cross relations requires the control flow graph of all
+        # the functions: don't do it speculatively, only exploit them if they
+        # have already been produced
+        async with self.index_lock.priority(Priority.SPECULATIVE):
+            relations = await self.run_in_executor(self.read_cross_relations)
+        if relations is None:
+            return
+
+        for relation in relations.get("Relations", []):
+            callee = function_path(relation["Location"])
+            if callee is None:
+                continue
+            for call_site in relation.get("IsCalledFrom", []):
+                caller = function_path(call_site)
+                if caller is None or caller == callee:
+                    continue
+                self.neighbours.setdefault(callee, set()).add(caller)
+                self.neighbours.setdefault(caller, set()).add(callee)
+
+    def read_cross_relations(self) -> Optional[dict]:
+        try:
+            target = self.manager.create_target(
+                CROSS_RELATIONS_STEP, CROSS_RELATIONS_CONTAINER, ":binary-cross-relations", False
+            )
+            if not target.is_ready:
+                return None
+            content = target.extract()
+        except Exception:
+            logger.debug("Cannot read the cross relations", exc_info=True)
+            return None
+
+        if content is None:
+            return None
+        return yaml.safe_load(content)
+
+
+def function_path(location: str) -> Optional[str]:
+    """Convert the location of a function, or of one of its basic blocks, into
+    the path of the function's artifacts"""
+    rank, _, path = location.lstrip("/").partition("/")
+    if rank == "function":
+        return path
+    elif rank == "basic-block":
+        return path.partition("/")[0]
+    return None
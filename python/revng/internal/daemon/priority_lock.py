@@ -0,0 +1,69 @@
+#
+# This file is distributed under the MIT License. See LICENSE.md for details.
+#
+
+import asyncio
+import heapq
+from contextlib import asynccontextmanager
+from enum import IntEnum
+from itertools import count
+from typing import AsyncIterator, List, Tuple
+
+
+class Priority(IntEnum):
+    """Priorities of the requests, lower values are served first"""
+
+    INTERACTIVE = 0
+    NORMAL = 1
+    BULK = 2
+    SPECULATIVE = 3
+
+
+class PriorityLock:
+    """An asyncio lock that, when released, is handed over to the waiter with
+    the highest priority. Waiters with the same priority are served in FIFO
+    order."""
+
+    def __init__(self):
+        self.locked = False
+        self.counter = count()
+        self.waiters: List[Tuple[int, int, asyncio.Future]] = []
+
+    async def acquire(self, priority: Priority = Priority.NORMAL):
+        if not self.locked and len(self.waiters) == 0:
+            self.locked = True
+            return
+
+        future = asyncio.get_running_loop().create_future()
+        heapq.heappush(self.waiters, (priority, next(self.counter), future))
+        try:
+            await future
+        except asyncio.CancelledError:
+            if future.done() and not future.cancelled():
+                # We have been handed the lock right before being cancelled
+                self.release()
+            raise
+
+    def release(self):
+        assert self.locked
+        # Hand the lock over to the first waiter that has not been cancelled
+        while len(self.waiters) > 0:
+            _, _, future = heapq.heappop(self.waiters)
+            if not future.done():
+                future.set_result(None)
+                return
+        self.locked = False
+
+    @asynccontextmanager
+    async def priority(self, priority: Priority) -> AsyncIterator[None]:
+        await self.acquire(priority)
+        try:
+            yield
+        finally:
+            self.release()
+
+    async def __aenter__(self):
+        await self.acquire()
+
+    async def __aexit__(self, *args):
+        self.release()
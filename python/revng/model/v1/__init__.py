@@ -4,7 +4,11 @@
 # flake8: noqa: F405
 # type: ignore
 
+import yaml
+
 from revng.tupletree import Reference, enum_value_to_index, init_reference_yaml_classes
+from revng.tupletree.binary import is_binary_tuple_tree
+from revng.tupletree.binary import load_binary as _load_binary
 
 from ..metaaddress import *
 from . import _generated
@@ -27,3 +31,18 @@ class Binary(_generated.Binary):
 # Since we subclassed them we need to re-register their constructors and representers
 YamlLoader.add_constructor("!Binary", Binary.yaml_constructor)
 YamlDumper.add_representer(Binary, Binary.yaml_representer)
+
+
+def load_binary(data: bytes) -> Binary:
+    """Deserializes a model in the binary tuple tree format, e.g., the output of
+    `revng model opt --binary`"""
+    return _load_binary(data, Binary)
+
+
+def load(path) -> Binary:
+    """Deserializes a model from a file, either in YAML or in the binary format"""
+    with open(path, "rb") as f:
+        data = f.read()
+    if is_binary_tuple_tree(data):
+        return load_binary(data)
+    return yaml.load(data, Loader=YamlLoader)
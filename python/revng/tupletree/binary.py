@@ -0,0 +1,186 @@
+#
+# This file is distributed under the MIT License. See LICENSE.md for details.
+#
+
+# Reader for the binary tuple tree format produced by the C++ serializeBinary
+# (see BinarySerialization.h), which is much faster to load than YAML.
+#
+# The objects are encoded as the sequence of their fields, in the order of the
+# schema. The layout of each class is described by the `_binary_fields`
+# attribute emitted by the tuple tree generator: a tuple of (field name,
+# encoding) pairs, where the encoding is one of:
+#
+# * ("bool",), ("uint",), ("sint",), ("string",), ("reference",)
+# * ("metaaddress", MetaAddress class)
+# * ("scalar", class), a scalar stored as its YAML string
+# * ("enum", class), ("struct", class), ("upcastable", base class)
+# * ("list", element encoding)
+#
+# Since strings are interned and addresses are stored as differences from the
+# previous one, the buffer can only be decoded sequentially: there's no way to
+# skip a collection without decoding it.
+
+from typing import Any, Dict, List
+
+from . import Reference
+
+MAGIC = b"\x7fRVNGTT\x01"
+VERSION = 2
+
+
+class BinaryTupleTreeError(ValueError):
+    pass
+
+
+def is_binary_tuple_tree(data: bytes) -> bool:
+    return data.startswith(MAGIC)
+
+
+class BinaryTupleTreeReader:
+    def __init__(self, data: bytes):
+        self.data = memoryview(data)
+        self.position = 0
+        self.strings: List[str] = []
+        self.last_address = 0
+        # Enum class -> members, in the order of their C++ values
+        self.enum_members: Dict[type, list] = {}
+
+    def read_header(self):
+        if not is_binary_tuple_tree(bytes(self.data[: len(MAGIC)])):
+            raise BinaryTupleTreeError("Not a binary tuple tree")
+        self.position = len(MAGIC)
+        version = self.read_unsigned()
+        if version != VERSION:
+            raise BinaryTupleTreeError(f"Unsupported binary tuple tree version {version}")
+
+    def at_end(self) -> bool:
+        return self.position == len(self.data)
+
+    def read_unsigned(self) -> int:
+        data = self.data
+        position = self.position
+        result = 0
+        shift = 0
+        while True:
+            if position >= len(data) or shift >= 64:
+                raise BinaryTupleTreeError("Truncated integer")
+            byte = data[position]
+            position += 1
+            result |= (byte & 0x7F) << shift
+            shift += 7
+            if byte & 0x80 == 0:
+                break
+        self.position = position
+        return result
+
+    def read_signed(self) -> int:
+        bits = self.read_unsigned()
+        return (bits >> 1) ^ -(bits & 1)
+
+    def read_count(self) -> int:
+        # Reject counts that cannot fit in the rest of the buffer
+        count = self.read_unsigned()
+        if count > len(self.data) - self.position:
+            raise BinaryTupleTreeError("Invalid element count")
+        return count
+
+    def read_string(self) -> str:
+        index = self.read_unsigned()
+        if index != 0:
+            if index > len(self.strings):
+                raise BinaryTupleTreeError("Invalid string index")
+            return self.strings[index - 1]
+
+        size = self.read_count()
+        start = self.position
+        self.position += size
+        result = str(self.data[start : self.position], "utf-8")
+        self.strings.append(result)
+        return result
+
+    def read_metaaddress(self, metaaddress_class):
+        type_index = self.read_unsigned()
+        if type_index == 0:
+            # Invalid
+            return metaaddress_class()
+
+        types = self.members(type(metaaddress_class().Type))
+        if type_index >= len(types):
+            raise BinaryTupleTreeError("Invalid MetaAddress type")
+
+        epoch = self.read_unsigned()
+        address_space = self.read_unsigned()
+        address = (self.last_address + self.read_signed()) & 0xFFFFFFFFFFFFFFFF
+        self.last_address = address
+        return metaaddress_class(
+            Address=address,
+            Type=types[type_index],
+            Epoch=epoch,
+            AddressSpace=address_space,
+        )
+
+    def members(self, enum_class) -> list:
+        result = self.enum_members.get(enum_class)
+        if result is None:
+            result = list(enum_class)
+            self.enum_members[enum_class] = result
+        return result
+
+    def read(self, encoding) -> Any:
+        kind = encoding[0]
+        if kind == "uint":
+            return self.read_unsigned()
+        elif kind == "string":
+            return self.read_string()
+        elif kind == "struct":
+            return self.read_struct(encoding[1])
+        elif kind == "list":
+            element_encoding = encoding[1]
+            return [self.read(element_encoding) for _ in range(self.read_count())]
+        elif kind == "bool":
+            return self.read_unsigned() != 0
+        elif kind == "enum":
+            members = self.members(encoding[1])
+            index = self.read_unsigned()
+            if index >= len(members):
+                raise BinaryTupleTreeError(f"Invalid value for {encoding[1].__name__}")
+            return members[index]
+        elif kind == "reference":
+            return Reference(self.read_string())
+        elif kind == "metaaddress":
+            return self.read_metaaddress(encoding[1])
+        elif kind == "upcastable":
+            return self.read_upcastable(encoding[1])
+        elif kind == "sint":
+            return self.read_signed()
+        elif kind == "scalar":
+            return encoding[1].from_string(self.read_string())
+        raise BinaryTupleTreeError(f"Unknown encoding {kind}")
+
+    def read_upcastable(self, base_class):
+        name = self.read_string()
+        if name == "":
+            return None
+
+        concrete_class = getattr(base_class, "_children", {}).get(name)
+        if concrete_class is None and name == base_class.__name__:
+            concrete_class = base_class
+        if concrete_class is None:
+            raise BinaryTupleTreeError(f"Unknown kind {name} of {base_class.__name__}")
+        return self.read_struct(concrete_class)
+
+    def read_struct(self, struct_class):
+        kwargs = {}
+        for name, encoding in struct_class._binary_fields:
+            kwargs[name] = self.read(encoding)
+        return struct_class(**kwargs)
+
+
+def load_binary(data: bytes, root_class):
+    """Deserialize a binary tuple tree whose root is an instance of root_class"""
+    reader = BinaryTupleTreeReader(data)
+    reader.read_header()
+    result = reader.read_struct(root_class)
+    if not reader.at_end():
+        raise BinaryTupleTreeError("Trailing data after the binary tuple tree")
+    return result
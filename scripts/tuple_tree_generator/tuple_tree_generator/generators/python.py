@@ -30,6 +30,7 @@ class PythonGenerator:
         self.jinja_environment.filters["python_type"] = self.python_type
         self.jinja_environment.filters["docstring"] = self.render_docstring
         self.jinja_environment.filters["default_value"] = self.default_value
+        self.jinja_environment.filters["binary_encoding"] = self.binary_encoding
         self.jinja_environment.tests["simple_field"] = is_simple_struct_field
         self.jinja_environment.tests["sequence_field"] = is_sequence_struct_field
         self.jinja_environment.tests["reference_field"] = is_reference_struct_field
@@ -79,6 +80,37 @@ class PythonGenerator:
         else:
             assert False
 
+    def binary_encoding(self, field: StructField):
+        """Describes how revng.tupletree.binary decodes the field, mirroring the C++
+        BinaryTupleTreeWriter"""
+        return self._binary_encoding(field.resolved_type)
+
+    def _binary_encoding(self, resolved_type: Definition) -> str:
+        if isinstance(resolved_type, StructDefinition):
+            return f'("struct", {resolved_type.name})'
+        elif isinstance(resolved_type, SequenceDefinition):
+            return f'("list", {self._binary_encoding(resolved_type.element_type)})'
+        elif isinstance(resolved_type, EnumDefinition):
+            return f'("enum", {resolved_type.name})'
+        elif isinstance(resolved_type, ScalarDefinition):
+            name = resolved_type.name
+            if name == "bool":
+                return '("bool",)'
+            elif name == "MetaAddress":
+                return '("metaaddress", MetaAddress)'
+            elif name == "string" or name in self.string_types:
+                return '("string",)'
+            elif match := int_re.fullmatch(name):
+                return '("uint",)' if match.group(1) else '("sint",)'
+            else:
+                return f'("scalar", {name})'
+        elif isinstance(resolved_type, ReferenceDefinition):
+            return '("reference",)'
+        elif isinstance(resolved_type, UpcastableDefinition):
+            return f'("upcastable", {resolved_type.base.name})'
+        else:
+            assert False
+
     @staticmethod
     def render_docstring(docstr: str, indent=1):
         if not docstr:
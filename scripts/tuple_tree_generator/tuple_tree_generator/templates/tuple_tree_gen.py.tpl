@@ -128,6 +128,15 @@ if sys.version_info < (3, 10, 0):
     force_kw_only('struct.name')
 ##- endfor ##
 
+### Layout of the binary tuple tree format, see revng.tupletree.binary -###
+## for struct in structs ##
+'struct.name'._binary_fields = (
+    ##- for field in struct.all_fields ##
+    ("'field.name'", 'field | binary_encoding'),
+    ##- endfor ##
+)
+## endfor ##
+
 ## for enum in enums ##
 YamlDumper.add_representer('enum.name', 'enum.name'.yaml_representer)
 ##- endfor ##
@@ -231,7 +231,7 @@ export function validateDiff(obj: /*= global_name =*/, diffs: DiffSet): boolean
 }
 
 export function applyDiff(obj: /*= global_name =*/, diffs: DiffSet): [false] | [true, /*= global_name =*/] {
-  return _applyDiff(obj, diffs, validateDiff, getTypeInfo, clone);
+  return _applyDiff(obj, diffs, validateDiff, getTypeInfo);
 }
 
 export function getElementByPath<T>(path: string, tree: /*= global_name =*/): T | undefined {
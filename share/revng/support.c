@@ -271,6 +271,81 @@ void jump_to_symbol(char *Symbol) {
   _abort(Symbol);
 }
 
+// Inline caches statistics, emitted by the compiler when
+// --dispatcher-inline-cache-counters is enabled
+struct inline_cache_counters {
+  uint64_t caller;
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t last_target;
+};
+
+extern struct inline_cache_counters revng_inline_cache_counters[]
+  __attribute__((weak));
+extern const uint64_t revng_inline_cache_counters_count __attribute__((weak));
+
+// If REVNG_INLINE_CACHE_STATS contains a path, dump the inline caches
+// statistics there as CSV
+static void dump_inline_cache_counters(void) {
+  static bool dumped = false;
+  if (dumped || &revng_inline_cache_counters_count == NULL)
+    return;
+  dumped = true;
+
+  char *stats_path = getenv("REVNG_INLINE_CACHE_STATS");
+  if (stats_path == NULL || strlen(stats_path) == 0)
+    return;
+
+  FILE *stats = fopen(stats_path, "w");
+  if (stats == NULL)
+    return;
+
+  fprintf(stats, "caller,hits,misses,last_target\n");
+  for (uint64_t i = 0; i < revng_inline_cache_counters_count; i++) {
+    struct inline_cache_counters *counters = &revng_inline_cache_counters[i];
+    fprintf(stats,
+            "0x%" PRIx64 ",%" PRIu64 ",%" PRIu64 ",0x%" PRIx64 "\n",
+            counters->caller,
+            counters->hits,
+            counters->misses,
+            counters->last_target);
+  }
+
+  fclose(stats);
+}
+
+// Basic block counts, emitted by the compiler when --profile-instrument is
+// enabled
+extern uint64_t revng_profile_counters[] __attribute__((weak));
+extern const uint64_t revng_profile_counters_count __attribute__((weak));
+
+// If REVNG_PROFILE contains a path, dump the basic block counts there, one per
+// line, to be used with --profile-use
+static void dump_profile_counters(void) {
+  static bool dumped = false;
+  if (dumped || &revng_profile_counters_count == NULL)
+    return;
+  dumped = true;
+
+  char *profile_path = getenv("REVNG_PROFILE");
+  if (profile_path == NULL || strlen(profile_path) == 0)
+    return;
+
+  FILE *profile = fopen(profile_path, "w");
+  if (profile == NULL)
+    return;
+
+  for (uint64_t i = 0; i < revng_profile_counters_count; i++)
+    fprintf(profile, "%" PRIu64 "\n", revng_profile_counters[i]);
+
+  fclose(profile);
+}
+
+static void dump_counters(void) {
+  dump_inline_cache_counters();
+  dump_profile_counters();
+}
+
 #ifdef TRACE
 
 // Execution tracing support
@@ -341,6 +416,7 @@ void flush_trace_buffer_signal_handler(int signal) {
 // This function is called by the syscall helpers in case of exit/exit_group
 void on_exit_syscall(void) {
   flush_trace_buffer();
+  dump_counters();
 }
 
 void newpc(uint64_t pc,
@@ -366,6 +442,7 @@ void init_tracing(void) {
 }
 
 void on_exit_syscall(void) {
+  dump_counters();
 }
 
 void newpc(uint64_t pc,
@@ -382,12 +459,19 @@ void newpc(uint64_t pc,
 bool is_executable(uint64_t pc) {
   assert(segments_count != 0);
 
-  // Check if the pc is inside one of the executable segments
-  for (int i = 0; i < segments_count; i++)
-    if (pc >= segment_boundaries[2 * i] && pc < segment_boundaries[2 * i + 1])
-      return true;
+  // The executable segments are sorted and do not overlap: look for the last
+  // one starting at or before pc. The loop count only depends on the number
+  // of segments, the comparison can be lowered to a conditional move.
+  const uint64_t *segment = segment_boundaries;
+  uint64_t count = segments_count;
+  while (count > 1) {
+    uint64_t half = count / 2;
+    if (segment[2 * half] <= pc)
+      segment += 2 * half;
+    count -= half;
+  }
 
-  return false;
+  return pc >= segment[0] && pc < segment[1];
 }
 
 void handle_sigsegv(int signo, siginfo_t *info, void *opaque_context) {
@@ -423,6 +507,10 @@ int main(int argc, char *argv[]) {
   // Initialize the tracing system
   init_tracing();
 
+  // Upon exit, dump the inline caches statistics and the profile, if any
+  int atexit_result = atexit(dump_counters);
+  assert(atexit_result == 0);
+
   // Allocate and initialize the stack
   void *stack = mmap((void *) NULL,
                      16 * 0x100000,
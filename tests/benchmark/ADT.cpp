@@ -0,0 +1,286 @@
+/// \file ADT.cpp
+/// Microbenchmarks for the containers and algorithms in revng/ADT.
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <random>
+#include <set>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "revng/ADT/ConstantRangeSet.h"
+#include "revng/ADT/GenericGraph.h"
+#include "revng/ADT/LazySmallBitVector.h"
+#include "revng/ADT/RecursiveCoroutine.h"
+#include "revng/ADT/SmallMap.h"
+#include "revng/ADT/SortedVector.h"
+#include "revng/ADT/ZipMapIterator.h"
+#include "revng/MFP/MFP.h"
+#include "revng/MFP/SetLattices.h"
+
+// All the inputs are generated with a fixed seed, so that runs are comparable
+static std::vector<uint64_t> randomValues(size_t Count, uint64_t Max) {
+  std::mt19937_64 Generator(42);
+  std::uniform_int_distribution<uint64_t> Distribution(0, Max);
+  std::vector<uint64_t> Result(Count);
+  for (uint64_t &Value : Result)
+    Value = Distribution(Generator);
+  return Result;
+}
+
+//
+// LazySmallBitVector
+//
+
+static void lazySmallBitVectorSet(benchmark::State &State) {
+  auto Bits = randomValues(State.range(0), 4 * State.range(0));
+  for (auto _ : State) {
+    LazySmallBitVector Vector;
+    for (uint64_t Bit : Bits)
+      Vector.set(Bit);
+    benchmark::DoNotOptimize(Vector);
+  }
+  State.SetItemsProcessed(State.iterations() * Bits.size());
+}
+BENCHMARK(lazySmallBitVectorSet)->Range(8, 1 << 14);
+
+static void lazySmallBitVectorBitwise(benchmark::State &State) {
+  LazySmallBitVector Left;
+  LazySmallBitVector Right;
+  for (uint64_t Bit : randomValues(State.range(0), 4 * State.range(0)))
+    Left.set(Bit);
+  for (uint64_t Bit : randomValues(State.range(0), 8 * State.range(0)))
+    Right.set(Bit);
+
+  for (auto _ : State) {
+    LazySmallBitVector Result = Left;
+    Result |= Right;
+    Result &= Left;
+    benchmark::DoNotOptimize(Result.count());
+  }
+}
+BENCHMARK(lazySmallBitVectorBitwise)->Range(8, 1 << 14);
+
+static void lazySmallBitVectorIterate(benchmark::State &State) {
+  LazySmallBitVector Vector;
+  for (uint64_t Bit : randomValues(State.range(0), 4 * State.range(0)))
+    Vector.set(Bit);
+
+  for (auto _ : State) {
+    uint64_t Sum = 0;
+    for (unsigned Bit : Vector)
+      Sum += Bit;
+    benchmark::DoNotOptimize(Sum);
+  }
+}
+BENCHMARK(lazySmallBitVectorIterate)->Range(8, 1 << 14);
+
+//
+// ConstantRangeSet
+//
+
+static ConstantRangeSet makeRangeSet(const std::vector<uint64_t> &Bounds) {
+  ConstantRangeSet Result(32, false);
+  for (size_t I = 0; I + 1 < Bounds.size(); I += 2) {
+    uint64_t Start = std::min(Bounds[I], Bounds[I + 1]);
+    uint64_t End = std::max(Bounds[I], Bounds[I + 1]) + 1;
+    Result = Result.unionWith(ConstantRangeSet({ { 32, Start }, { 32, End } }));
+  }
+  return Result;
+}
+
+static void constantRangeSetUnionIntersect(benchmark::State &State) {
+  ConstantRangeSet Left = makeRangeSet(randomValues(2 * State.range(0),
+                                                    0xFFFFFFF));
+  ConstantRangeSet Right = makeRangeSet(randomValues(2 * State.range(0) + 1,
+                                                     0xFFFFFFF));
+  for (auto _ : State) {
+    benchmark::DoNotOptimize(Left.unionWith(Right));
+    benchmark::DoNotOptimize(Left.intersectWith(Right));
+  }
+}
+BENCHMARK(constantRangeSetUnionIntersect)->Range(4, 256);
+
+//
+// SmallMap
+//
+
+template<size_t N>
+static void smallMapInsertLookup(benchmark::State &State) {
+  auto Keys = randomValues(State.range(0), 1024);
+  for (auto _ : State) {
+    SmallMap<uint64_t, uint64_t, N> Map;
+    for (uint64_t Key : Keys)
+      Map[Key] += 1;
+
+    uint64_t Hits = 0;
+    for (uint64_t Key : Keys)
+      Hits += Map.count(Key);
+    benchmark::DoNotOptimize(Hits);
+  }
+  State.SetItemsProcessed(State.iterations() * Keys.size());
+}
+BENCHMARK(smallMapInsertLookup<16>)->DenseRange(4, 32, 4)->Arg(256);
+
+//
+// KeyedObjectsContainers and ZipMapIterator
+//
+
+static void sortedVectorBatchInsert(benchmark::State &State) {
+  auto Keys = randomValues(State.range(0), 16 * State.range(0));
+  for (auto _ : State) {
+    SortedVector<uint64_t> Vector;
+    {
+      auto Inserter = Vector.batch_insert_or_assign();
+      for (uint64_t Key : Keys)
+        Inserter.insert_or_assign(Key);
+    }
+    benchmark::DoNotOptimize(Vector.size());
+  }
+  State.SetItemsProcessed(State.iterations() * Keys.size());
+}
+BENCHMARK(sortedVectorBatchInsert)->Range(64, 1 << 16);
+
+static void sortedVectorFind(benchmark::State &State) {
+  auto Keys = randomValues(State.range(0), 16 * State.range(0));
+  SortedVector<uint64_t> Vector;
+  {
+    auto Inserter = Vector.batch_insert_or_assign();
+    for (uint64_t Key : Keys)
+      Inserter.insert_or_assign(Key);
+  }
+
+  for (auto _ : State) {
+    uint64_t Hits = 0;
+    for (uint64_t Key : Keys)
+      Hits += Vector.count(Key);
+    benchmark::DoNotOptimize(Hits);
+  }
+  State.SetItemsProcessed(State.iterations() * Keys.size());
+}
+BENCHMARK(sortedVectorFind)->Range(64, 1 << 16);
+
+static void zipMapIterate(benchmark::State &State) {
+  std::set<uint64_t> LeftKeys;
+  std::set<uint64_t> RightKeys;
+  for (uint64_t Key : randomValues(State.range(0), 2 * State.range(0)))
+    LeftKeys.insert(Key);
+  for (uint64_t Key : randomValues(State.range(0) + 1, 2 * State.range(0)))
+    RightKeys.insert(Key);
+
+  SortedVector<uint64_t> Left;
+  SortedVector<uint64_t> Right;
+  for (uint64_t Key : LeftKeys)
+    Left.insert(Key);
+  for (uint64_t Key : RightKeys)
+    Right.insert(Key);
+
+  for (auto _ : State) {
+    size_t Matching = 0;
+    for (auto [LeftElement, RightElement] : zipmap_range(Left, Right))
+      Matching += LeftElement != nullptr and RightElement != nullptr;
+    benchmark::DoNotOptimize(Matching);
+  }
+}
+BENCHMARK(zipMapIterate)->Range(64, 1 << 16);
+
+//
+// GenericGraph and MFP
+//
+
+struct ReachingNode {
+  ReachingNode(uint64_t Index) : Index(Index) {}
+  uint64_t Index;
+};
+
+using ReachingGraphNode = ForwardNode<ReachingNode>;
+using ReachingGraph = GenericGraph<ReachingGraphNode>;
+
+/// A random CFG-like graph: a chain, so that every node is reachable from the
+/// entry, plus two random edges per node, some of which are back edges
+static ReachingGraph makeGraph(size_t NodeCount) {
+  ReachingGraph Graph;
+  std::vector<ReachingGraphNode *> Nodes;
+  for (size_t I = 0; I < NodeCount; I++)
+    Nodes.push_back(Graph.addNode(I));
+  Graph.setEntryNode(Nodes.front());
+
+  auto Targets = randomValues(2 * NodeCount, NodeCount - 1);
+  for (size_t I = 0; I < NodeCount; I++) {
+    if (I + 1 < NodeCount)
+      Nodes[I]->addSuccessor(Nodes[I + 1]);
+    Nodes[I]->addSuccessor(Nodes[Targets[2 * I]]);
+    Nodes[I]->addSuccessor(Nodes[Targets[2 * I + 1]]);
+  }
+
+  return Graph;
+}
+
+static void genericGraphBuild(benchmark::State &State) {
+  for (auto _ : State) {
+    ReachingGraph Graph = makeGraph(State.range(0));
+    benchmark::DoNotOptimize(Graph.size());
+  }
+}
+BENCHMARK(genericGraphBuild)->Range(64, 1 << 14);
+
+static void genericGraphVisit(benchmark::State &State) {
+  ReachingGraph Graph = makeGraph(State.range(0));
+  for (auto _ : State) {
+    size_t Visited = 0;
+    for (ReachingGraphNode *Node : llvm::post_order(&Graph))
+      Visited += Node->successorCount();
+    benchmark::DoNotOptimize(Visited);
+  }
+}
+BENCHMARK(genericGraphVisit)->Range(64, 1 << 14);
+
+/// Collect, for each node, the set of the nodes that can reach it
+struct ReachingNodesMFI : public SetUnionLattice<std::set<uint64_t>> {
+  using Label = ReachingGraphNode *;
+  using GraphType = ReachingGraph *;
+
+  static LatticeElement applyTransferFunction(Label L,
+                                              const LatticeElement &Value) {
+    LatticeElement Result = Value;
+    Result.insert(L->Index);
+    return Result;
+  }
+};
+
+static void mfpReachingNodes(benchmark::State &State) {
+  ReachingGraph Graph = makeGraph(State.range(0));
+  for (auto _ : State) {
+    auto Result = MFP::getMaximalFixedPoint<ReachingNodesMFI>({},
+                                                              &Graph,
+                                                              {},
+                                                              {},
+                                                              {},
+                                                              {});
+    benchmark::DoNotOptimize(Result.size());
+  }
+}
+BENCHMARK(mfpReachingNodes)->Range(16, 1 << 10);
+
+//
+// RecursiveCoroutine
+//
+
+static RecursiveCoroutine<uint64_t> sumTree(uint64_t Depth) {
+  if (Depth == 0)
+    rc_return 1;
+
+  uint64_t Left = rc_recur sumTree(Depth - 1);
+  uint64_t Right = rc_recur sumTree(Depth - 1);
+  rc_return Left + Right + 1;
+}
+
+static void recursiveCoroutineTree(benchmark::State &State) {
+  for (auto _ : State)
+    benchmark::DoNotOptimize(static_cast<uint64_t>(sumTree(State.range(0))));
+  State.SetItemsProcessed(State.iterations() * ((2 << State.range(0)) - 1));
+}
+BENCHMARK(recursiveCoroutineTree)->DenseRange(4, 16, 4);
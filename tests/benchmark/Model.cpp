@@ -0,0 +1,114 @@
+/// \file Model.cpp
+/// Microbenchmarks for TupleTree (de)serialization and diffing on the model.
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <string>
+
+#include "benchmark/benchmark.h"
+
+#include "llvm/Support/raw_ostream.h"
+
+#include "revng/Model/Binary.h"
+#include "revng/TupleTree/TupleTreeDiff.h"
+
+/// A model with \p FunctionCount functions and as many structs, each with a
+/// few fields, roughly the shape of the model of a small binary
+static TupleTree<model::Binary> makeModel(size_t FunctionCount) {
+  TupleTree<model::Binary> Model;
+  Model->Architecture() = model::Architecture::x86_64;
+
+  for (size_t I = 0; I < FunctionCount; I++) {
+    auto [Struct, Type] = Model->makeStructDefinition(32);
+    for (uint64_t Offset = 0; Offset < 32; Offset += 8)
+      Struct.addField(Offset, model::PrimitiveType::makeGeneric(8));
+
+    auto Entry = MetaAddress::fromPC(llvm::Triple::x86_64, 0x400000 + I * 16);
+    model::Function &Function = Model->Functions()[Entry];
+    Function.CustomName() = "function_" + std::to_string(I);
+  }
+
+  return Model;
+}
+
+static std::string serializeModel(const TupleTree<model::Binary> &Model) {
+  std::string Buffer;
+  llvm::raw_string_ostream OS(Buffer);
+  Model.serialize(OS);
+  OS.flush();
+  return Buffer;
+}
+
+static void tupleTreeSerialize(benchmark::State &State) {
+  auto Model = makeModel(State.range(0));
+  size_t Size = 0;
+  for (auto _ : State) {
+    std::string YAML = serializeModel(Model);
+    Size = YAML.size();
+    benchmark::DoNotOptimize(YAML.data());
+  }
+  State.SetBytesProcessed(State.iterations() * Size);
+}
+BENCHMARK(tupleTreeSerialize)->Range(16, 1 << 12);
+
+static void tupleTreeDeserialize(benchmark::State &State) {
+  std::string YAML = serializeModel(makeModel(State.range(0)));
+  for (auto _ : State) {
+    auto Model = TupleTree<model::Binary>::fromString(YAML);
+    benchmark::DoNotOptimize(Model->get());
+  }
+  State.SetBytesProcessed(State.iterations() * YAML.size());
+}
+BENCHMARK(tupleTreeDeserialize)->Range(16, 1 << 12);
+
+static void tupleTreeCopy(benchmark::State &State) {
+  auto Model = makeModel(State.range(0));
+  for (auto _ : State) {
+    TupleTree<model::Binary> Copy = Model;
+    benchmark::DoNotOptimize(Copy.get());
+  }
+}
+BENCHMARK(tupleTreeCopy)->Range(16, 1 << 12);
+
+/// Rename one function out of eight, the typical size of the diff produced by
+/// an analysis or by the user
+static TupleTree<model::Binary> renameSome(const TupleTree<model::Binary> &M) {
+  TupleTree<model::Binary> Result = M;
+  size_t I = 0;
+  for (model::Function &Function : Result->Functions())
+    if (I++ % 8 == 0)
+      Function.CustomName().append("_renamed");
+  return Result;
+}
+
+static void tupleTreeDiffCompute(benchmark::State &State) {
+  auto Left = makeModel(State.range(0));
+  auto Right = renameSome(Left);
+  for (auto _ : State) {
+    auto Diff = diff(*Left, *Right);
+    benchmark::DoNotOptimize(Diff.Changes.size());
+  }
+}
+BENCHMARK(tupleTreeDiffCompute)->Range(16, 1 << 12);
+
+static void tupleTreeDiffApply(benchmark::State &State) {
+  auto Left = makeModel(State.range(0));
+  auto Diff = diff(*Left, *renameSome(Left));
+  for (auto _ : State) {
+    State.PauseTiming();
+    TupleTree<model::Binary> Target = Left;
+    State.ResumeTiming();
+    llvm::cantFail(Diff.apply(Target));
+    benchmark::DoNotOptimize(Target.get());
+  }
+}
+BENCHMARK(tupleTreeDiffApply)->Range(16, 1 << 12);
+
+static void modelVerify(benchmark::State &State) {
+  auto Model = makeModel(State.range(0));
+  for (auto _ : State)
+    benchmark::DoNotOptimize(Model->verify());
+}
+BENCHMARK(modelVerify)->Range(16, 1 << 12);
@@ -0,0 +1,119 @@
+/// \file Support.cpp
+/// Microbenchmarks for MetaAddress and GzipTarFile.
+
+//
+// This file is distributed under the MIT License. See LICENSE.md for details.
+//
+
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "revng/Support/GzipTarFile.h"
+#include "revng/Support/MetaAddress.h"
+
+static std::vector<MetaAddress> randomAddresses(size_t Count) {
+  std::mt19937_64 Generator(42);
+  std::uniform_int_distribution<uint64_t> Distribution(0x400000, 0x4FFFFF);
+  std::vector<MetaAddress> Result;
+  Result.reserve(Count);
+  for (size_t I = 0; I < Count; I++)
+    Result.push_back(MetaAddress::fromPC(llvm::Triple::x86_64,
+                                         Distribution(Generator)));
+  return Result;
+}
+
+//
+// MetaAddress
+//
+
+static void metaAddressSort(benchmark::State &State) {
+  auto Addresses = randomAddresses(State.range(0));
+  for (auto _ : State) {
+    State.PauseTiming();
+    auto ToSort = Addresses;
+    State.ResumeTiming();
+    std::sort(ToSort.begin(), ToSort.end());
+    benchmark::DoNotOptimize(ToSort.data());
+  }
+  State.SetItemsProcessed(State.iterations() * Addresses.size());
+}
+BENCHMARK(metaAddressSort)->Range(64, 1 << 16);
+
+static void metaAddressStdHash(benchmark::State &State) {
+  auto Addresses = randomAddresses(State.range(0));
+  for (auto _ : State) {
+    std::unordered_set<MetaAddress> Set(Addresses.begin(), Addresses.end());
+    benchmark::DoNotOptimize(Set.size());
+  }
+  State.SetItemsProcessed(State.iterations() * Addresses.size());
+}
+BENCHMARK(metaAddressStdHash)->Range(64, 1 << 16);
+
+static void metaAddressToString(benchmark::State &State) {
+  auto Addresses = randomAddresses(State.range(0));
+  for (auto _ : State) {
+    for (const MetaAddress &Address : Addresses) {
+      std::string String = Address.toString();
+      benchmark::DoNotOptimize(MetaAddress::fromString(String));
+    }
+  }
+  State.SetItemsProcessed(State.iterations() * Addresses.size());
+}
+BENCHMARK(metaAddressToString)->Range(64, 1 << 12);
+
+//
+// GzipTarFile
+//
+
+/// Files of \p Size bytes of (somewhat compressible) pseudo-random text
+static std::vector<std::string> makeFiles(size_t Count, size_t Size) {
+  std::mt19937_64 Generator(42);
+  std::uniform_int_distribution<int> Distribution('a', 'p');
+  std::vector<std::string> Result(Count);
+  for (std::string &File : Result) {
+    File.resize(Size);
+    for (char &Character : File)
+      Character = static_cast<char>(Distribution(Generator));
+  }
+  return Result;
+}
+
+static llvm::SmallVector<char, 0> writeArchive(const auto &Files) {
+  llvm::SmallVector<char, 0> Archive;
+  llvm::raw_svector_ostream OS(Archive);
+  revng::GzipTarWriter Writer(OS);
+  for (size_t I = 0; I < Files.size(); I++)
+    Writer.append("file-" + std::to_string(I),
+                  { Files[I].data(), Files[I].size() });
+  Writer.close();
+  return Archive;
+}
+
+static void gzipTarWrite(benchmark::State &State) {
+  auto Files = makeFiles(16, State.range(0));
+  for (auto _ : State)
+    benchmark::DoNotOptimize(writeArchive(Files).size());
+  State.SetBytesProcessed(State.iterations() * 16 * State.range(0));
+}
+BENCHMARK(gzipTarWrite)->Range(1 << 10, 1 << 20);
+
+static void gzipTarRead(benchmark::State &State) {
+  auto Archive = writeArchive(makeFiles(16, State.range(0)));
+  for (auto _ : State) {
+    revng::GzipTarReader Reader({ Archive.data(), Archive.size() });
+    size_t Size = 0;
+    for (revng::ArchiveEntry &Entry : Reader.entries())
+      Size += Entry.Data.size();
+    benchmark::DoNotOptimize(Size);
+  }
+  State.SetBytesProcessed(State.iterations() * 16 * State.range(0));
+}
+BENCHMARK(gzipTarRead)->Range(1 << 10, 1 << 20);
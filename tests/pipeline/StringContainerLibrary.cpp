@@ -55,7 +55,7 @@ public:
   }
 
   bool contains(const Target &Target) const {
-    return ContainedStrings.contains(Target.getPathComponents().back());
+    return ContainedStrings.contains(Target.getPathComponents().back().str());
   }
 
   bool remove(const TargetsList &Targets) override {
@@ -114,7 +114,7 @@ public:
 
 private:
   static std::string toString(const Target &Target) {
-    return Target.getPathComponents().front();
+    return Target.getPathComponents().front().str();
   }
 
   void mergeBackImpl(StringContainer &&Container) override {
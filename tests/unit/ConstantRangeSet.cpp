@@ -69,3 +69,27 @@ BOOST_AUTO_TEST_CASE(TestEnumerate) {
     dbg << "\n";
   }
 }
+
+BOOST_AUTO_TEST_CASE(TestSetOperations) {
+  using CRS = ConstantRangeSet;
+
+  auto Range = [](uint32_t Start, uint32_t End) {
+    return CRS({ { 32, Start }, { 32, End } });
+  };
+
+  CRS TwoRanges = Range(10, 20).unionWith(Range(30, 40));
+  revng_check(TwoRanges.contains(Range(12, 18)));
+  revng_check(TwoRanges.contains(Range(30, 40)));
+  revng_check(not TwoRanges.contains(Range(15, 35)));
+  revng_check(not Range(12, 18).contains(TwoRanges));
+  revng_check(CRS(32, true).contains(TwoRanges));
+  revng_check(TwoRanges.contains(CRS(32, false)));
+
+  // Adjacent ranges are merged
+  revng_check(Range(10, 20).unionWith(Range(20, 30)) == Range(10, 30));
+
+  revng_check(TwoRanges.intersectWith(Range(15, 35)).size() == 10);
+  revng_check(TwoRanges.intersectWith(CRS(32, true)) == TwoRanges);
+  revng_check(TwoRanges.intersectWith(CRS(32, false)).isEmptySet());
+  revng_check(TwoRanges.unionWith(CRS(32, true)).isFullSet());
+}
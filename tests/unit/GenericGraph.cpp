@@ -4,6 +4,8 @@
 // This file is distributed under the MIT License. See LICENSE.md for details.
 //
 
+#include <set>
+
 #define BOOST_TEST_MODULE GenericGraph
 bool init_unit_test();
 #include "boost/test/unit_test.hpp"
@@ -18,6 +20,7 @@ bool init_unit_test();
 
 #include "revng/ADT/FilteredGraphTraits.h"
 #include "revng/ADT/GenericGraph.h"
+#include "revng/ADT/RecyclingAllocated.h"
 #include "revng/ADT/SerializableGraph.h"
 #include "revng/TupleTree/Introspection.h"
 
@@ -437,6 +440,27 @@ BOOST_AUTO_TEST_CASE(TestSerializeGraph) {
   revng_check(Deserialized == Serializable);
 }
 
+BOOST_AUTO_TEST_CASE(TestSerializeGraphBinary) {
+  auto DG = createGraph<BidirectionalTestNode>();
+  auto Serializable = toSerializable(DG.Graph);
+
+  std::string Buffer;
+  {
+    llvm::raw_string_ostream Stream(Buffer);
+    serializeBinary(Stream, Serializable);
+  }
+
+  using GraphType = decltype(Serializable);
+  auto Deserialized = serializableGraphFromBinary<GraphType>(Buffer);
+  revng_check(Deserialized);
+  revng_check(*Deserialized == Serializable);
+
+  llvm::StringRef Truncated = llvm::StringRef(Buffer).drop_back(1);
+  auto Failed = serializableGraphFromBinary<GraphType>(Truncated);
+  revng_check(not Failed);
+  llvm::consumeError(Failed.takeError());
+}
+
 // MutableEdgeNode tests
 struct SomeNode {
   std::string Text;
@@ -617,3 +641,34 @@ BOOST_AUTO_TEST_CASE(MutableEdgeNodeRemovalTest) {
   revng_check(C->successorCount() == 0);
   revng_check(C->predecessorCount() == 1);
 }
+
+BOOST_AUTO_TEST_CASE(RecyclingAllocatedNodesTest) {
+  struct RecycledNode : public RecyclingAllocated {
+    RecycledNode(int Value) : Value(Value) {}
+    int Value;
+  };
+  using NodeType = BidirectionalNode<RecycledNode>;
+
+  std::set<NodeType *> Previous;
+  {
+    GenericGraph<NodeType> Graph;
+    for (int I = 0; I < 10; ++I)
+      Previous.insert(Graph.addNode(I));
+  }
+
+  // Nodes of a graph built after the first one has been destroyed must reuse
+  // the memory of the previous nodes
+  GenericGraph<NodeType> Graph;
+  NodeType *Last = nullptr;
+  for (int I = 0; I < 10; ++I) {
+    auto *Node = Graph.addNode(I);
+    revng_check(Previous.contains(Node));
+    if (Last != nullptr)
+      Last->addSuccessor(Node);
+    Last = Node;
+  }
+
+  revng_check(Graph.size() == 10);
+  for (NodeType *Node : Graph.nodes())
+    revng_check(Node->successorCount() + Node->predecessorCount() >= 1);
+}
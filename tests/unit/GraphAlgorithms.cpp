@@ -372,3 +372,72 @@ BOOST_AUTO_TEST_CASE(NullTargetTest) {
   revng_check(ReachableSet[1] == RG.SmallerBlock);
   revng_check(ReachableSet[2] == RG.EndBlock);
 }
+
+BOOST_AUTO_TEST_CASE(IndexedGraphTest) {
+  using NodeType = BidirectionalNode<MyBidirectionalNode>;
+  auto NLG = createNLGGraph<NodeType>();
+  revng::IndexedGraph<NodeType *> View(NLG.Entry);
+
+  // Nodes are numbered in depth-first preorder
+  revng_check(View.size() == 6);
+  revng_check(View.node(0) == NLG.Entry);
+  revng_check(View.node(1) == NLG.LoopHeader);
+  revng_check(View.node(2) == NLG.SecondLoopHeader);
+  revng_check(View.node(3) == NLG.LoopLatch);
+  revng_check(View.node(4) == NLG.SecondLoopLatch);
+  revng_check(View.node(5) == NLG.Exit);
+  revng_check(View.successors(3).size() == 2);
+  revng_check(View.predecessors(2).size() == 2);
+
+  std::vector<unsigned> RPO = View.reversePostOrder();
+  revng_check((RPO == std::vector<unsigned>{ 0, 1, 2, 3, 4, 5 }));
+
+  // The loop is a single component, completed after the exit
+  auto SCCs = View.stronglyConnectedComponents();
+  revng_check(SCCs.Components.size() == 3);
+  revng_check(SCCs.ComponentOf[5] == 0);
+  revng_check(SCCs.ComponentOf[0] == 2);
+  for (unsigned I = 1; I < 5; ++I)
+    revng_check(SCCs.ComponentOf[I] == 1);
+
+  std::vector<unsigned> IDoms = View.immediateDominators();
+  revng_check((IDoms == std::vector<unsigned>{ 0, 0, 1, 2, 3, 4 }));
+
+  revng_check(not isDAG(NLG.Entry));
+}
+
+BOOST_AUTO_TEST_CASE(GraphAnalysisCacheTest) {
+  using NodeType = BidirectionalNode<MyBidirectionalNode>;
+  auto RG = createRGraph<NodeType>();
+  revng::GraphAnalysisCache<NodeType *> Cache(RG.InitialBlock);
+
+  revng_check(isDAG(RG.InitialBlock));
+  revng_check(Cache.rpoNumber(RG.InitialBlock) == 0);
+  revng_check(Cache.rpoNumber(RG.SmallerBlock) == 1);
+  revng_check(Cache.rpoNumber(RG.EndBlock) == 2);
+  revng_check(Cache.dominates(RG.InitialBlock, RG.EndBlock));
+  revng_check(not Cache.dominates(RG.SmallerBlock, RG.EndBlock));
+
+  // After the graph changes, the cache has to be invalidated
+  auto Successors = RG.InitialBlock->successors();
+  revng_check(*std::next(Successors.begin()) == RG.EndBlock);
+  RG.InitialBlock->removeSuccessor(std::next(Successors.begin()));
+  Cache.invalidate();
+  revng_check(Cache.dominates(RG.SmallerBlock, RG.EndBlock));
+  revng_check(Cache.stronglyConnectedComponents().Components.size() == 3);
+}
+
+BOOST_AUTO_TEST_CASE(WhiteListBackedgesTest) {
+  using NodeType = BidirectionalNode<MyBidirectionalNode>;
+  auto NLG = createNLGGraph<NodeType>();
+
+  // The node closing the outer loop is not part of the white list
+  llvm::SmallPtrSet<NodeType *, 4> WhiteList = { NLG.Entry,
+                                                 NLG.LoopHeader,
+                                                 NLG.SecondLoopHeader,
+                                                 NLG.LoopLatch };
+  auto Backedges = getBackedgesWhiteList(NLG.Entry, WhiteList);
+  revng_check(Backedges.size() == 1);
+  revng_check(Backedges[0].first == NLG.LoopLatch);
+  revng_check(Backedges[0].second == NLG.SecondLoopHeader);
+}
@@ -6,6 +6,7 @@
 
 #include "revng/Support/GzipStream.h"
 #include "revng/Support/GzipTarFile.h"
+#include "revng/Support/ZstdStream.h"
 
 #define BOOST_TEST_MODULE GzipTarFile
 bool init_unit_test();
@@ -68,3 +69,120 @@ BOOST_AUTO_TEST_CASE(GzipTarFileTest) {
   checkOffset(Buffer, Offset1.DataStart, Offset1.dataSize(), "foo2");
   checkOffset(Buffer, Offset2.DataStart, Offset2.dataSize(), "bar2");
 }
+
+BOOST_AUTO_TEST_CASE(GzipTarFileReadEntry) {
+  llvm::SmallVector<char> Buffer;
+  llvm::raw_svector_ostream OS(Buffer);
+
+  revng::GzipTarWriter Writer(OS);
+  std::string Data1(4096, 'a');
+  revng::OffsetDescriptor Offset1 = Writer.append("first",
+                                                  { Data1.data(),
+                                                    Data1.size() });
+  std::string Data2 = "second";
+  revng::OffsetDescriptor Offset2 = Writer.append("second",
+                                                  { Data2.data(),
+                                                    Data2.size() });
+  Writer.close();
+
+  // Entries can be read in any order, without going through the others
+  llvm::ArrayRef<char> Archive(Buffer.data(), Buffer.size());
+  auto Entry2 = revng::readGzipTarEntry(Archive,
+                                        Offset2.DataStart,
+                                        Offset2.PaddingStart);
+  BOOST_TEST(std::string(Entry2.data(), Entry2.size()) == Data2);
+
+  auto Entry1 = revng::readGzipTarEntry(Archive,
+                                        Offset1.DataStart,
+                                        Offset1.PaddingStart);
+  BOOST_TEST(std::string(Entry1.data(), Entry1.size()) == Data1);
+}
+
+BOOST_AUTO_TEST_CASE(GzipParallelCompression) {
+  // Large enough to be split in multiple gzip members
+  std::string Input;
+  for (size_t I = 0; I < 5 * 1024 * 1024; I++)
+    Input.push_back('a' + (I * 7919) % 26);
+
+  llvm::SmallVector<char> Compressed;
+  llvm::raw_svector_ostream OS(Compressed);
+  gzipCompress(OS, { Input.data(), Input.size() });
+
+  BOOST_TEST(gzipDecompress({ Compressed.data(), Compressed.size() })
+             == Input);
+}
+
+BOOST_AUTO_TEST_CASE(GzipTarFileAppendAll) {
+  std::vector<std::string> Names;
+  std::vector<std::string> Contents;
+  for (unsigned I = 0; I < 100; I++) {
+    Names.push_back("file" + std::to_string(I));
+    Contents.push_back(std::string(I * 37, 'a' + I % 26));
+  }
+
+  llvm::SmallVector<char> Sequential;
+  std::vector<revng::OffsetDescriptor> SequentialOffsets;
+  {
+    llvm::raw_svector_ostream OS(Sequential);
+    revng::GzipTarWriter Writer(OS);
+    for (unsigned I = 0; I < Names.size(); I++) {
+      llvm::ArrayRef<char> Data(Contents[I].data(), Contents[I].size());
+      SequentialOffsets.push_back(Writer.append(Names[I], Data));
+    }
+    Writer.close();
+  }
+
+  llvm::SmallVector<char> Parallel;
+  std::vector<revng::OffsetDescriptor> ParallelOffsets;
+  {
+    std::vector<revng::GzipTarWriter::File> Files;
+    for (unsigned I = 0; I < Names.size(); I++)
+      Files.push_back({ Names[I], { Contents[I].data(), Contents[I].size() } });
+
+    llvm::raw_svector_ostream OS(Parallel);
+    revng::GzipTarWriter Writer(OS);
+    ParallelOffsets = Writer.appendAll(Files);
+    Writer.close();
+  }
+
+  BOOST_TEST((Sequential == Parallel));
+  BOOST_TEST(SequentialOffsets.size() == ParallelOffsets.size());
+  for (unsigned I = 0; I < SequentialOffsets.size(); I++) {
+    BOOST_TEST(SequentialOffsets[I].Start == ParallelOffsets[I].Start);
+    BOOST_TEST(SequentialOffsets[I].End == ParallelOffsets[I].End);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ZstdTarFile) {
+  llvm::SmallVector<char> Buffer;
+  std::vector<revng::OffsetDescriptor> Offsets;
+  std::string Large(3 * 1024 * 1024, 'z');
+  {
+    std::vector<revng::GzipTarWriter::File> Files = {
+      { "small", { "small", 5 } }, { "large", { Large.data(), Large.size() } }
+    };
+
+    llvm::raw_svector_ostream OS(Buffer);
+    revng::GzipTarWriter Writer(OS, revng::TarCompression::Zstd);
+    Offsets = Writer.appendAll(Files);
+    Writer.close();
+  }
+
+  llvm::ArrayRef<char> Archive(Buffer.data(), Buffer.size());
+  BOOST_TEST(isZstdFrame(Archive));
+
+  {
+    revng::GzipTarReader Reader(Archive);
+    cppcoro::generator<revng::ArchiveEntry> Gen = Reader.entries();
+    std::vector<revng::ArchiveEntry> Entries(Gen.begin(), Gen.end());
+    BOOST_TEST(Entries.size() == 2ULL);
+    BOOST_TEST(Entries[0].Filename == "small");
+    BOOST_TEST(Entries[1].Filename == "large");
+    BOOST_TEST(Entries[1].Data.size() == Large.size());
+  }
+
+  auto Entry = revng::readGzipTarEntry(Archive,
+                                       Offsets[1].DataStart,
+                                       Offsets[1].PaddingStart);
+  BOOST_TEST(std::string(Entry.data(), Entry.size()) == Large);
+}
@@ -9,10 +9,13 @@ bool init_unit_test();
 #include "boost/test/unit_test.hpp"
 
 #include "llvm/IR/DebugInfoMetadata.h"
+#include "llvm/IR/IRBuilder.h"
 #include "llvm/Linker/Linker.h"
 #include "llvm/Transforms/Utils/Cloning.h"
 
+#include "revng/Support/FunctionTags.h"
 #include "revng/Support/IRHelpers.h"
+#include "revng/Support/ModuleStatistics.h"
 #include "revng/UnitTestHelpers/LLVMTestHelpers.h"
 #include "revng/UnitTestHelpers/UnitTestHelpers.h"
 
@@ -224,3 +227,52 @@ BOOST_AUTO_TEST_CASE(PruneDICompileUnits) {
 
   revng_check(NamedMDNode->getNumOperands() == 1);
 }
+
+BOOST_AUTO_TEST_CASE(ParallelFunctionsStatistics) {
+  LLVMContext Context;
+  auto M = std::make_unique<Module>("", Context);
+  auto *FT = FunctionType::get(Type::getVoidTy(Context), false);
+
+  // Enough functions to be split in multiple chunks
+  for (unsigned I = 0; I < 1000; ++I) {
+    auto *F = Function::Create(FT,
+                               GlobalValue::ExternalLinkage,
+                               "f" + Twine(I),
+                               &*M);
+    if (I % 10 == 0)
+      continue;
+
+    if (I % 3 == 0)
+      FunctionTags::Helper.addTo(F);
+
+    IRBuilder<> Builder(BasicBlock::Create(Context, "", F));
+    for (unsigned J = 0; J < I % 17; ++J)
+      Builder.CreateAlloca(Builder.getInt8Ty());
+    Builder.CreateRetVoid();
+  }
+
+  FunctionsStatistics Expected;
+  for (const Function &F : *M)
+    Expected.process(F);
+
+  FunctionsStatistics Actual = FunctionsStatistics::analyze(*M);
+
+  auto Check = [](const FunctionClass &Left, const FunctionClass &Right) {
+    const ListStatistics &LeftList = Left.InstructionsStatistics;
+    const ListStatistics &RightList = Right.InstructionsStatistics;
+    revng_check(Left.DeclarationsCount == Right.DeclarationsCount);
+    revng_check(Left.DefinitionsCount == Right.DefinitionsCount);
+    revng_check(LeftList.count() == RightList.count());
+    revng_check(LeftList.sum() == RightList.sum());
+    revng_check(std::abs(LeftList.mean() - RightList.mean()) < 1e-6);
+    revng_check(std::abs(LeftList.variance() - RightList.variance()) < 1e-6);
+  };
+
+  Check(Expected.AllFunctions, Actual.AllFunctions);
+  revng_check(Actual.AllFunctions.DeclarationsCount == 100);
+
+  revng_check(Expected.TaggedFunctions.size() == 1);
+  revng_check(Actual.TaggedFunctions.size() == 1);
+  const FunctionTags::Tag *Helper = &FunctionTags::Helper;
+  Check(Expected.TaggedFunctions.at(Helper), Actual.TaggedFunctions.at(Helper));
+}
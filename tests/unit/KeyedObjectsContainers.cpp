@@ -158,6 +158,43 @@ BOOST_AUTO_TEST_CASE(TestSortedVector) {
   testSet<SortedVector<Element>>();
 }
 
+BOOST_AUTO_TEST_CASE(TestSortedVectorBatchMerge) {
+  SortedVector<Element> Vector;
+
+  // Keys in increasing order are appended
+  for (uint64_t Key = 10; Key <= 50; Key += 10)
+    assertInsert(Vector, Key, Key);
+  revng_check(Vector.isSorted());
+
+  // New elements interleaved with the existing ones, later ones win
+  {
+    auto Inserter = Vector.batch_insert_or_assign();
+    Inserter.reserve(4);
+    Inserter.insert_or_assign({ 35, 1 });
+    Inserter.insert_or_assign({ 20, 2 });
+    Inserter.insert_or_assign({ 5, 3 });
+    Inserter.insert_or_assign({ 20, 4 });
+  }
+
+  revng_check(Vector.isSorted());
+  revng_check(Vector.size() == 7);
+  revng_check(Vector.begin()->key() == 5);
+  revng_check(Vector.at(20).value() == 4);
+  revng_check(Vector.at(35).value() == 1);
+  revng_check(Vector.at(50).value() == 50);
+
+  // New elements all past the existing ones
+  {
+    auto Inserter = Vector.batch_insert();
+    Inserter.insert({ 70, 70 });
+    Inserter.insert({ 60, 60 });
+  }
+
+  revng_check(Vector.isSorted());
+  revng_check(Vector.size() == 9);
+  revng_check(Vector.rbegin()->key() == 70);
+}
+
 template<typename T>
 bool isSerializationStable(T &&Original) {
   std::string Buffer;
@@ -332,5 +369,39 @@ BOOST_AUTO_TEST_CASE(TrackingContainerPush) {
   testPush<MutableSet>();
 }
 
+template<template<typename...> class T>
+static void testRepeatedAccesses() {
+  revng::TrackingContainer<T<int>> Container;
+  Container.insert(1);
+  Container.insert(2);
+  Container.insert(3);
+  Container.clearTracking();
+  const auto &Reference = Container;
+
+  Reference.contains(3);
+  Reference.at(3);
+  Reference.at(1);
+  Reference.at(3);
+  Reference.tryGet(4);
+
+  Reference.trackingPush();
+  Reference.at(2);
+
+  auto TrackingResult = Reference.getTrackingResult();
+  revng_check(TrackingResult.InspectedKeys == std::set<int>({ 1, 2, 3, 4 }));
+  revng_check(not TrackingResult.Exact);
+
+  Reference.trackingPop();
+
+  TrackingResult = Reference.getTrackingResult();
+  revng_check(TrackingResult.InspectedKeys == std::set<int>({ 1, 3, 4 }));
+  revng_check(not TrackingResult.Exact);
+}
+
+BOOST_AUTO_TEST_CASE(TrackingContainerRepeatedAccesses) {
+  testRepeatedAccesses<SortedVector>();
+  testRepeatedAccesses<MutableSet>();
+}
+
 static_assert(KeyedObjectContainer<TrackingSortedVector<int>>);
 static_assert(KeyedObjectContainer<revng::TrackingContainer<MutableSet<int>>>);
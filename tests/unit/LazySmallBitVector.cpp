@@ -218,3 +218,24 @@ BOOST_AUTO_TEST_CASE(TestIterator) {
   std::copy(A.begin(), A.end(), std::back_inserter(Results));
   BOOST_REQUIRE_EQUAL(Results, (std::vector<unsigned>{ 0, 16, 1000 }));
 }
+
+BOOST_AUTO_TEST_CASE(TestCount) {
+  LazySmallBitVector A;
+  BOOST_TEST(A.count() == 0U);
+  BOOST_TEST(A.isZero());
+
+  // Test small implementation
+  A.set(3);
+  A.set(40);
+  BOOST_TEST(A.count() == 2U);
+  BOOST_TEST(not A.isZero());
+
+  // Test large implementation
+  A.set(200);
+  A.set(1000);
+  BOOST_TEST(A.count() == 4U);
+
+  A.zero();
+  BOOST_TEST(A.count() == 0U);
+  BOOST_TEST(A.isZero());
+}
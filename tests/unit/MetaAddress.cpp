@@ -5,12 +5,16 @@
 //
 
 #include <map>
+#include <tuple>
+#include <vector>
 
 #define BOOST_TEST_MODULE MetaAddress
 bool init_unit_test();
 #include "boost/test/execution_monitor.hpp"
 #include "boost/test/unit_test.hpp"
 
+#include "llvm/ADT/DenseMap.h"
+
 #include "revng/Support/MetaAddress.h"
 #include "revng/UnitTestHelpers/UnitTestHelpers.h"
 
@@ -183,3 +187,40 @@ BOOST_AUTO_TEST_CASE(Map) {
 
   BOOST_TEST(Map.size() == size_t(5));
 }
+
+BOOST_AUTO_TEST_CASE(Packed) {
+  std::vector<MetaAddress> Addresses = { generic32(0x2000),
+                                         generic64(0x1000),
+                                         pc(0x1000),
+                                         pc(0x1001),
+                                         MetaAddress::fromPC(Triple::x86,
+                                                             0x1000,
+                                                             1),
+                                         MetaAddress::fromPC(Triple::x86,
+                                                             0x1000,
+                                                             0,
+                                                             1) };
+
+  // Comparisons must follow the order of the fields
+  auto Fields = [](const MetaAddress &Address) {
+    return std::tuple(Address.epoch(),
+                      Address.addressSpace(),
+                      Address.type(),
+                      Address.address());
+  };
+  for (const MetaAddress &LHS : Addresses) {
+    for (const MetaAddress &RHS : Addresses) {
+      BOOST_TEST((LHS == RHS) == (Fields(LHS) == Fields(RHS)));
+      BOOST_TEST((LHS < RHS) == (Fields(LHS) < Fields(RHS)));
+    }
+  }
+
+  llvm::DenseMap<MetaAddress, int> Map;
+  for (const MetaAddress &Address : Addresses)
+    Map[Address] = 1;
+  Map[pc(0x1000)] = 2;
+
+  BOOST_TEST(Map.size() == Addresses.size());
+  BOOST_TEST(Map.lookup(pc(0x1000)) == 2);
+  BOOST_TEST(Map.lookup(pc(0x3000)) == 0);
+}
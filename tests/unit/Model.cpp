@@ -9,11 +9,14 @@ bool init_unit_test();
 #include "boost/test/unit_test.hpp"
 
 #include "revng/Model/Binary.h"
+#include "revng/Model/GlobalNamespace.h"
 #include "revng/Model/Pass/AllPasses.h"
+#include "revng/Model/Pass/ModelPassManager.h"
 #include "revng/Model/Processing.h"
 #include "revng/Support/MetaAddress.h"
 #include "revng/Support/MetaAddress/YAMLTraits.h"
 #include "revng/Support/YAMLTraits.h"
+#include "revng/TupleTree/ConcurrentDeserialization.h"
 #include "revng/TupleTree/DiffError.h"
 #include "revng/TupleTree/Introspection.h"
 #include "revng/TupleTree/Tracking.h"
@@ -249,12 +252,187 @@ BOOST_AUTO_TEST_CASE(TestModelDeduplication) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(TestPurgeUnreachableTypes) {
+  TupleTree<model::Binary> Model;
+  auto UInt32 = model::PrimitiveType::makeGeneric(4);
+
+  // Reachable from a segment, through another typedef
+  auto [Inner, InnerType] = Model->makeTypedefDefinition(UInt32.copy());
+  auto [Outer, OuterType] = Model->makeTypedefDefinition(InnerType.copy());
+  model::Segment::Key SegmentKey = { ARM1000, 0x100 };
+  Model->Segments()[SegmentKey].Type() = OuterType.copy();
+
+  // Unreachable, but named
+  auto [Named, NamedType] = Model->makeTypedefDefinition(UInt32.copy());
+  Named.OriginalName() = "Named";
+
+  // Unreachable and unnamed, reachable only from each other
+  auto [Unnamed, UnnamedType] = Model->makeTypedefDefinition(UInt32.copy());
+  auto [Other, OtherType] = Model->makeTypedefDefinition(UnnamedType.copy());
+  Unnamed.UnderlyingType() = OtherType.copy();
+
+  purgeUnnamedAndUnreachableTypes(Model);
+  BOOST_TEST(Model->TypeDefinitions().size() == 3U);
+  BOOST_TEST(Model->TypeDefinitions().contains(Named.key()));
+
+  purgeUnreachableTypes(Model);
+  BOOST_TEST(Model->TypeDefinitions().size() == 2U);
+  BOOST_TEST(Model->TypeDefinitions().contains(Inner.key()));
+  BOOST_TEST(Model->TypeDefinitions().contains(Outer.key()));
+}
+
 BOOST_AUTO_TEST_CASE(TestTupleTreeDiff) {
   model::Binary Left;
   model::Binary Right;
   diff(Left, Right).dump();
 }
 
+BOOST_AUTO_TEST_CASE(TestTupleTreeDiffSkipsIdenticalSubtrees) {
+  model::Binary Left;
+  Left.Functions()[ARM1000].CustomName() = "first";
+  Left.Functions()[ARM2000].CustomName() = "second";
+  model::Binary Right = Left;
+
+  BOOST_TEST(diff(Left, Right).Changes.empty());
+
+  Right.Functions()[ARM2000].CustomName() = "renamed";
+  auto Diff = diff(Left, Right);
+  BOOST_TEST(Diff.Changes.size() == 1);
+
+  TupleTree<model::Binary> Applied;
+  *Applied = Left;
+  llvm::cantFail(Diff.apply(Applied));
+  BOOST_TEST(Applied->Functions().at(ARM2000).CustomName() == "renamed");
+  BOOST_TEST(Applied->Functions().at(ARM1000).CustomName() == "first");
+}
+
+BOOST_AUTO_TEST_CASE(TestTupleTreeDiffInitializesNewReferences) {
+  TupleTree<model::Binary> Left;
+  Left->Architecture() = model::Architecture::x86_64;
+  auto StructType = Left->makeStructDefinition().second;
+
+  // The new typedef refers to the struct
+  TupleTree<model::Binary> Right = Left;
+  Right->makeTypedefDefinition(StructType.copy());
+  auto Diff = diff(*Left, *Right);
+
+  TupleTree<model::Binary> Applied = Left;
+  llvm::cantFail(Diff.apply(Applied));
+  BOOST_TEST(Applied->TypeDefinitions().size() == 2);
+  BOOST_TEST(Applied.verify());
+}
+
+BOOST_AUTO_TEST_CASE(TestVerifyAfterDiff) {
+  model::Binary Left;
+  Left.Functions()[ARM1000].CustomName() = "first";
+  Left.Functions()[ARM2000].CustomName() = "second";
+  revng_check(Left.verify());
+
+  model::Binary Renamed = Left;
+  Renamed.Functions()[ARM2000].CustomName() = "renamed";
+  BOOST_TEST(model::verifyAfterDiff(Renamed, diff(Left, Renamed)));
+
+  model::Binary Clashing = Left;
+  Clashing.Functions()[ARM2000].CustomName() = "first";
+  BOOST_TEST(not model::verifyAfterDiff(Clashing, diff(Left, Clashing)));
+}
+
+BOOST_AUTO_TEST_CASE(TestGlobalNamespaceUpdate) {
+  model::Binary Left;
+  Left.Functions()[ARM1000].CustomName() = "first";
+  Left.Functions()[ARM2000].CustomName() = "second";
+
+  GlobalNamespace Index(Left);
+  BOOST_TEST(Index.size() == 2U);
+  std::string FirstPath = globalSymbolPath(Left.Functions().at(ARM1000));
+  std::string SecondPath = globalSymbolPath(Left.Functions().at(ARM2000));
+  BOOST_TEST(*Index.owner("first") == FirstPath);
+  BOOST_TEST(Index.isAvailable("first", FirstPath));
+  BOOST_TEST(not Index.isAvailable("first", SecondPath));
+  BOOST_TEST(Index.isAvailable("third", SecondPath));
+
+  // Rename a function and add a clashing one
+  model::Binary Right = Left;
+  Right.Functions()[ARM2000].CustomName() = "renamed";
+  Right.Functions()[ARM3000].CustomName() = "first";
+  Index.update(Right, diff(Left, Right));
+  BOOST_TEST(not Index.contains("second"));
+  BOOST_TEST(Index.contains("renamed"));
+  BOOST_TEST(*Index.findCollision() == "first");
+
+  // Remove the clashing function
+  model::Binary Fixed = Right;
+  Fixed.Functions().erase(ARM3000);
+  Index.update(Fixed, diff(Right, Fixed));
+  BOOST_TEST(not Index.findCollision().has_value());
+  BOOST_TEST(Index.size() == 2U);
+  BOOST_TEST(Index.isAvailable("first", FirstPath));
+}
+
+BOOST_AUTO_TEST_CASE(TestVerifyInParallel) {
+  TupleTree<model::Binary> Model;
+  Model->Architecture() = model::Architecture::x86_64;
+  auto UInt32 = model::PrimitiveType::makeGeneric(4);
+  for (int I = 0; I < 100; ++I) {
+    auto &Struct = Model->makeStructDefinition(4).first;
+    Struct.addField(0, UInt32.copy());
+  }
+  Model->Functions()[ARM1000].CustomName() = "first";
+  Model->Functions()[ARM2000].CustomName() = "second";
+
+  BOOST_TEST(Model->verify());
+  BOOST_TEST(Model->verifyInParallel());
+
+  Model->Functions()[ARM2000].CustomName() = "first";
+  BOOST_TEST(not Model->verify());
+  BOOST_TEST(not Model->verifyInParallel());
+}
+
+BOOST_AUTO_TEST_CASE(TestModelPassManagerSchedule) {
+  using Effects = ModelPassEffects;
+  unsigned Checks = 0;
+  auto Check = [&Checks](TupleTree<model::Binary> &) { ++Checks; };
+  auto Nothing = [](TupleTree<model::Binary> &) {};
+
+  RegisterModelPass::Registered Verify{ "check",
+                                       "",
+                                       Check,
+                                       { .Writes = Effects::None } };
+  RegisterModelPass::Registered
+    SegmentsOnly{ "segments",
+                  "",
+                  Nothing,
+                  { .Reads = Effects::Segments, .Writes = Effects::Segments } };
+  RegisterModelPass::Registered
+    FunctionsOnly{ "functions",
+                   "",
+                   Nothing,
+                   { .Reads = Effects::Functions,
+                     .Writes = Effects::Functions } };
+  RegisterModelPass::Registered Everything{ "everything", "", Nothing };
+
+  ModelPassManager Manager;
+  Manager.add(SegmentsOnly);
+  Manager.add(FunctionsOnly);
+  Manager.add(Verify);
+  // Nothing changed since the last check
+  Manager.add(Verify);
+  Manager.add(Everything);
+  Manager.add(Verify);
+
+  auto Schedule = Manager.schedule();
+  BOOST_TEST(Schedule.size() == 4U);
+  BOOST_TEST(Schedule[0].size() == 2U);
+  BOOST_TEST(Schedule[1].size() == 1U);
+  BOOST_TEST(Schedule[1][0] == &Verify);
+  BOOST_TEST(Schedule[2][0] == &Everything);
+  BOOST_TEST(Schedule[3][0] == &Verify);
+
+  TupleTree<model::Binary> Model;
+  Manager.run(Model);
+  BOOST_TEST(Checks == 2U);
+}
+
 BOOST_AUTO_TEST_CASE(TestTupleTreeDiffSerialization) {
   model::Binary Left;
   model::Binary Right;
@@ -281,6 +459,105 @@ BOOST_AUTO_TEST_CASE(TestTupleTreeDiffDeserialization) {
   BOOST_TEST(S == S2);
 }
 
+BOOST_AUTO_TEST_CASE(TestTupleTreeDiffWriter) {
+  model::Binary Left;
+  model::Binary Right;
+
+  auto Written = [](const model::Binary &Left, const model::Binary &Right) {
+    std::string S;
+    llvm::raw_string_ostream Stream(S);
+    TupleTreeDiffWriter<model::Binary> Writer(Stream);
+    diff(Left, Right, Writer);
+    Writer.finish();
+    Stream.flush();
+    return S;
+  };
+
+  BOOST_TEST(Written(Left, Right) == toString(diff(Left, Right)));
+
+  Right.ExtraCodeAddresses().insert(MetaAddress(0x1000,
+                                                MetaAddressType::Code_aarch64));
+  Right.ExtraCodeAddresses().insert(MetaAddress(0x2000,
+                                                MetaAddressType::Code_aarch64));
+  Right.EntryPoint() = MetaAddress(0x1000, MetaAddressType::Code_aarch64);
+  BOOST_TEST(Written(Left, Right) == toString(diff(Left, Right)));
+}
+
+BOOST_AUTO_TEST_CASE(TestBinarySerializationRoundTrip) {
+  TupleTree<model::Binary> Model;
+  Model->Architecture() = model::Architecture::x86_64;
+  Model->ExtraCodeAddresses().insert(ARM1000);
+  Model->Segments().insert(model::Segment(ARM2000, 0x100));
+
+  auto UInt32 = model::PrimitiveType::makeGeneric(4);
+  auto &Struct = Model->makeStructDefinition().first;
+  Struct.OriginalName() = "MyStruct";
+  Struct.Fields()[0].CustomName() = "FirstField";
+  Struct.Fields()[0].Type() = model::PointerType::make(UInt32.copy(), 8);
+  Model->makeTypedefDefinition(UInt32.copy());
+
+  std::string Binary;
+  {
+    llvm::raw_string_ostream Stream(Binary);
+    Model.serializeBinary(Stream);
+  }
+  BOOST_TEST(isBinaryTupleTree(Binary));
+
+  using Tree = TupleTree<model::Binary>;
+  auto Parsed = llvm::cantFail(errorOrToExpected(Tree::fromString(Binary)));
+  BOOST_TEST(toString(*Parsed) == toString(*Model));
+
+  // Truncated buffers must be rejected
+  llvm::StringRef Truncated = llvm::StringRef(Binary).drop_back(1);
+  BOOST_TEST(not Tree::fromString(Truncated));
+}
+
+BOOST_AUTO_TEST_CASE(TestConcurrentDeserialization) {
+  TupleTree<model::Binary> Model;
+  Model->Architecture() = model::Architecture::x86_64;
+  Model->Segments().insert(model::Segment(ARM2000, 0x100));
+  auto UInt32 = model::PrimitiveType::makeGeneric(4);
+  auto &Struct = Model->makeStructDefinition(4).first;
+  Struct.addField(0, UInt32.copy());
+  Model->Functions()[ARM1000].CustomName() = "first";
+  Model->Functions()[ARM3000].CustomName() = "second";
+
+  std::string Serialized = toString(*Model);
+  auto Sections = revng::detail::splitTopLevelMapping(Serialized);
+  BOOST_TEST(Sections.has_value());
+  BOOST_TEST(Sections->size() > 3);
+
+  // Split every section, no matter the size
+  using Tree = TupleTree<model::Binary>;
+  auto MaybeParsed = concurrentlyFromString<model::Binary>(Serialized, 0);
+  auto Parsed = llvm::cantFail(errorOrToExpected(std::move(MaybeParsed)));
+  BOOST_TEST(toString(*Parsed) == Serialized);
+  BOOST_TEST(Parsed.verify());
+
+  // Documents that cannot be split are parsed as a whole
+  llvm::StringRef Flow = "{ Architecture: x86_64 }";
+  BOOST_TEST(not revng::detail::splitTopLevelMapping(Flow));
+  auto FlowParsed = concurrentlyFromString<model::Binary>(Flow, 0);
+  BOOST_TEST(toString(**FlowParsed) == toString(**Tree::fromString(Flow)));
+}
+
+BOOST_AUTO_TEST_CASE(TestRegisterNameLookup) {
+  using namespace model::Register;
+  for (unsigned I = Invalid + 1; I < Count; ++I) {
+    auto Register = static_cast<Values>(I);
+    auto Architecture = getReferenceArchitecture(Register);
+    BOOST_TEST(fromRegisterName(getRegisterName(Register), Architecture)
+               == Register);
+  }
+
+  BOOST_TEST(fromRegisterName("rax", model::Architecture::x86) == Invalid);
+  BOOST_TEST(fromRegisterName("nope", model::Architecture::x86_64) == Invalid);
+  BOOST_TEST(fromCSVName("state_0x8558", model::Architecture::x86_64)
+             == xmm0_x86_64);
+  BOOST_TEST(fromCSVName("state_0x83c0", model::Architecture::x86) == Invalid);
+  BOOST_TEST(fromCSVName("r13", model::Architecture::arm) == r13_arm);
+}
+
 BOOST_AUTO_TEST_CASE(CABIFunctionTypePathShouldParse) {
   const char *Path = "/TypeDefinitions/10000-CABIFunctionDefinition";
   auto MaybeParsed = stringAsPath<model::Binary>(Path);
@@ -406,3 +683,21 @@ BOOST_AUTO_TEST_CASE(CollectReadFieldsShouldCollectAllSegments) {
   };
   BOOST_TEST(Collected.ExactVectors == Paths);
 }
+
+BOOST_AUTO_TEST_CASE(IdentifierSanitization) {
+  // Long enough to be checked a word at a time, with invalid characters both
+  // in the words and in the tail
+  llvm::StringRef Name = "_ZN4llvm5Value10getContextEv const&";
+  Identifier Sanitized = Identifier::sanitize(Name);
+  revng_check(Sanitized == "_ZN4llvm5Value10getContextEv_const_");
+
+  revng_check(Identifier::fromString(Name)
+              == "unreserved__ZN4llvm5Value10getContextEv_const_");
+  revng_check(Identifier::fromString("int") == "unreserved_int");
+  revng_check(Identifier::fromString("a.b") == "a_b");
+
+  revng_check(Identifier("valid_identifier_0123456789").verify());
+  revng_check(not Identifier("invalid identifier 0123456789").verify());
+  revng_check(not Identifier("invalid_identifier_\xe2\x82\xac").verify());
+  revng_check(not Identifier("0invalid").verify());
+}
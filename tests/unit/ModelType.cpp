@@ -4,6 +4,7 @@
 
 #include "revng/Model/Binary.h"
 #include "revng/Model/Filters.h"
+#include "revng/Model/LayoutCache.h"
 
 static bool verify(const model::TypeDefinition &ModelType, const bool Assert) {
   return ModelType.verify(Assert);
@@ -39,3 +40,32 @@ static bool checkSerialization(const TupleTree<model::Binary> &T) {
 }
 
 #include "revng/tests/unit/ModelType.inc"
+
+BOOST_AUTO_TEST_CASE(LayoutCacheScope) {
+  TupleTree<model::Binary> Model;
+
+  auto [Union, UnionType] = Model->makeUnionDefinition();
+  UnionField Field(0);
+  Field.Type() = model::PrimitiveType::makeSigned(4);
+  revng_check(Union.Fields().insert(Field).second);
+  auto [Typedef, TypedefType] = Model->makeTypedefDefinition(UnionType.copy());
+  auto Array = model::ArrayType::make(TypedefType.copy(), 3);
+
+  {
+    model::LayoutCacheScope Scope;
+    revng_check(model::LayoutCacheScope::current() == &Scope);
+    revng_check(*Array->size() == 12);
+    revng_check(*Array->size() == 12);
+
+    // Make the union bigger: the new size is visible after the invalidation
+    UnionField Bigger(1);
+    Bigger.Type() = model::PrimitiveType::makeSigned(8);
+    revng_check(Union.Fields().insert(Bigger).second);
+    Scope.invalidate();
+    revng_check(*Array->size() == 24);
+    revng_check(*Typedef.trySize() == 8);
+  }
+
+  revng_check(model::LayoutCacheScope::current() == nullptr);
+  revng_check(*Array->size() == 24);
+}
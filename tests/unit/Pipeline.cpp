@@ -5,7 +5,9 @@
 //
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
+#include <thread>
 
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
@@ -18,11 +20,14 @@
 #include "llvm/InitializePasses.h"
 #include "llvm/Pass.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/YAMLTraits.h"
 #include "llvm/Transforms/Utils/Cloning.h"
 
 #include "revng/Pipeline/AllRegistries.h"
+#include "revng/Pipeline/ArtifactCache.h"
 #include "revng/Pipeline/ContainerEnumerator.h"
 #include "revng/Pipeline/ContainerFactory.h"
 #include "revng/Pipeline/ContainerFactorySet.h"
@@ -30,6 +35,7 @@
 #include "revng/Pipeline/Context.h"
 #include "revng/Pipeline/Contract.h"
 #include "revng/Pipeline/Errors.h"
+#include "revng/Pipeline/EventLog.h"
 #include "revng/Pipeline/ExecutionContext.h"
 #include "revng/Pipeline/GenericLLVMPipe.h"
 #include "revng/Pipeline/Invokable.h"
@@ -38,9 +44,14 @@
 #include "revng/Pipeline/LLVMContainerFactory.h"
 #include "revng/Pipeline/LLVMKind.h"
 #include "revng/Pipeline/Loader.h"
+#include "revng/Pipeline/ProductionProgress.h"
+#include "revng/Pipeline/Profiler.h"
 #include "revng/Pipeline/Runner.h"
 #include "revng/Pipeline/Target.h"
+#include "revng/Pipeline/TargetCosts.h"
+#include "revng/Storage/StorageClient.h"
 #include "revng/Support/Assert.h"
+#include "revng/Support/Deadline.h"
 
 #define BOOST_TEST_MODULE Pipeline
 bool init_unit_test();
@@ -209,6 +220,46 @@ struct Fixture {
 
 BOOST_AUTO_TEST_SUITE(PipelineTestSuite, *boost::unit_test::fixture<Fixture>())
 
+BOOST_AUTO_TEST_CASE(TargetsListStaysSortedOnAppend) {
+  TargetsList List;
+  List.push_back(Target("f2", FunctionKind));
+  List.push_back(Target("f3", FunctionKind));
+  List.push_back(Target("f1", FunctionKind));
+  List.push_back(Target("f2", FunctionKind));
+  List.emplace_back("f4", FunctionKind);
+
+  BOOST_TEST(List.size() == 4U);
+  BOOST_TEST(llvm::is_sorted(List));
+  BOOST_TEST(List.front().getPathComponents()[0] == "f1");
+  BOOST_TEST(List.contains(Target("f4", FunctionKind)));
+}
+
+BOOST_AUTO_TEST_CASE(TargetsListSetOperations) {
+  TargetsList List;
+  List.push_back(Target("f1", FunctionKind));
+  List.push_back(Target("f3", FunctionKind));
+  List.push_back(Target("f5", FunctionKind));
+
+  TargetsList Other;
+  Other.push_back(Target("f2", FunctionKind));
+  Other.push_back(Target("f3", FunctionKind));
+
+  std::string Name = "f2";
+  BOOST_TEST((Target(Name, FunctionKind) == Other.front()));
+  BOOST_TEST((Target(Name, FunctionKind).getPathComponents()[0].data()
+              == Other.front().getPathComponents()[0].data()));
+
+  List.merge(Other);
+  BOOST_TEST(List.size() == 4U);
+  BOOST_TEST(llvm::is_sorted(List));
+  BOOST_TEST(List.contains(Other));
+
+  List.erase(Other);
+  BOOST_TEST(List.size() == 2U);
+  BOOST_TEST(not List.contains(Target("f3", FunctionKind)));
+  BOOST_TEST(List.contains(Target("f5", FunctionKind)));
+}
+
 BOOST_AUTO_TEST_CASE(ContainerIsa) {
   std::map<Target, int> Map;
   Map[ExampleTarget] = 1;
@@ -388,6 +439,24 @@ BOOST_AUTO_TEST_CASE(InputOutputContractExactExactFineGrainedForward) {
   BOOST_TEST((Targets[CName][0].getPathComponents().size() == 1));
 }
 
+BOOST_AUTO_TEST_CASE(InputOutputContractEvaluationScope) {
+  Context Ctx;
+  ContractGroup Contract1(RootKind, 0, FunctionKind, 0);
+
+  ContainerToTargetsMap Expected;
+  Expected[CName].emplace_back(Target({}, RootKind));
+  Contract1.deduceResults(Ctx, Expected, { CName });
+
+  ContractEvaluationScope Scope;
+  for (unsigned I = 0; I < 2; ++I) {
+    ContainerToTargetsMap Targets;
+    Targets[CName].emplace_back(Target({}, RootKind));
+    Contract1.deduceResults(Ctx, Targets, { CName });
+    BOOST_TEST((Targets[CName] == Expected[CName]));
+    BOOST_TEST((Targets[CName].size() == 2));
+  }
+}
+
 static void checkIfContains(auto &TargetRange, const Kind &K) {
   const auto ToFind = [&K](const Target &Target) {
     return &Target.getKind() == &K;
@@ -477,6 +546,30 @@ BOOST_AUTO_TEST_CASE(StepCanCloneAndRun) {
   BOOST_TEST(Cont.get(Target({}, RootKind2)) == 1);
 }
 
+BOOST_AUTO_TEST_CASE(StepCanRunInPlace) {
+  Context Context;
+
+  ContainerSet Containers;
+  auto Factory = getMapFactoryContainer();
+  Containers.add(CName, Factory, Factory("dont-care"));
+  Step Step(Context,
+            "first-step",
+            "",
+            std::move(Containers),
+            PipeWrapper::bind<TestPipe>(CName, CName));
+
+  Containers = ContainerSet();
+  Containers.add(CName, Factory, Factory("dont-care"));
+  cast<MapContainer>(Containers[CName]).get(Target({}, RootKind)) = 1;
+  auto Produced = Step.runInPlace(std::move(Containers),
+                                  std::vector({ PipeExecutionEntry({}, {}) }));
+
+  BOOST_TEST(Produced.has_value());
+  BOOST_TEST((*Produced)[CName].contains(Target({}, RootKind2)));
+  const auto &Cont = cast<MapContainer>(Step.containers().at(CName));
+  BOOST_TEST(Cont.get(Target({}, RootKind2)) == 1);
+}
+
 BOOST_AUTO_TEST_CASE(PipelineCanBeManuallyExectued) {
   ContainerFactorySet Registry;
   Registry.registerDefaultConstructibleFactory<MapContainer>(CName);
@@ -674,6 +767,7 @@ static void makeF(llvm::Module &M, llvm::StringRef FName) {
 
 struct FunctionInserterPass : public llvm::ModulePass {
   static char ID;
+  static inline unsigned RunCount = 0;
   FunctionInserterPass() : llvm::ModulePass(ID) {}
 
   void getAnalysisUsage(llvm::AnalysisUsage &AU) const override {
@@ -681,6 +775,7 @@ struct FunctionInserterPass : public llvm::ModulePass {
   }
 
   bool runOnModule(llvm::Module &M) override {
+    ++RunCount;
     M.getFunction("root")->eraseFromParent();
     makeF(M, "f1");
 
@@ -728,6 +823,242 @@ struct LLVMPassFunctionIdentity {
   }
 };
 
+BOOST_AUTO_TEST_CASE(ProfilerRecordsStepsAndPipes) {
+  Context Context;
+  Profiler TheProfiler;
+  Context.setProfiler(&TheProfiler);
+
+  Runner Pipeline(Context);
+  Pipeline.addDefaultConstructibleFactory<MapContainer>(CName);
+
+  const std::string Name = "first-step";
+  Pipeline.emplaceStep("", Name, "");
+  Pipeline.emplaceStep(Name,
+                       "end",
+                       "",
+                       PipeWrapper::bind<FineGrainPipe>(CName, CName));
+
+  auto &Container(Pipeline[Name].containers().getOrCreate<MapContainer>(CName));
+  Container.get(Target(RootKind)) = 1;
+
+  ContainerToTargetsMap Targets;
+  Targets.add(CName, { "f1" }, FunctionKind);
+  BOOST_TEST(!Pipeline.run("end", Targets));
+
+  const auto IsPipe = [](const Profiler::Event &Event) {
+    return Event.Category == "pipe" and Event.Name == FineGrainPipe::Name;
+  };
+  const auto &Events = TheProfiler.events();
+  auto PipeEvent = llvm::find_if(Events, IsPipe);
+  BOOST_TEST((PipeEvent != Events.end()));
+  if (PipeEvent != Events.end()) {
+    BOOST_TEST(PipeEvent->InputTargets == 1U);
+    BOOST_TEST(PipeEvent->OutputTargets == 1U);
+  }
+
+  const auto IsStep = [](const Profiler::Event &Event) {
+    return Event.Category == "step" and Event.Name == "end";
+  };
+  BOOST_TEST((llvm::find_if(Events, IsStep) != Events.end()));
+
+  std::string Trace;
+  {
+    llvm::raw_string_ostream Stream(Trace);
+    TheProfiler.emitChromeTrace(Stream);
+  }
+  auto Parsed = llvm::json::parse(Trace);
+  BOOST_TEST(!!Parsed);
+  if (Parsed) {
+    const llvm::json::Array *TraceEvents = Parsed->getAsObject()
+                                             ->getArray("traceEvents");
+    BOOST_TEST((TraceEvents != nullptr));
+    if (TraceEvents != nullptr)
+      BOOST_TEST(TraceEvents->size() == Events.size());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(CancelledProductionLeavesContainersUntouched) {
+  Context Context;
+  std::atomic<bool> Cancelled = true;
+  Context.setCancellationFlag(&Cancelled);
+
+  Runner Pipeline(Context);
+  Pipeline.addDefaultConstructibleFactory<MapContainer>(CName);
+
+  const std::string Name = "first-step";
+  Pipeline.emplaceStep("", Name, "");
+  Pipeline.emplaceStep(Name,
+                       "end",
+                       "",
+                       PipeWrapper::bind<FineGrainPipe>(CName, CName));
+
+  auto &Container(Pipeline[Name].containers().getOrCreate<MapContainer>(CName));
+  Container.get(Target(RootKind)) = 1;
+
+  ContainerToTargetsMap Targets;
+  Targets.add(CName, { "f1" }, FunctionKind);
+  auto Error = Pipeline.run("end", Targets);
+  BOOST_TEST(!!Error);
+  auto Code = llvm::errorToErrorCode(std::move(Error));
+  BOOST_TEST((Code == std::errc::operation_canceled));
+
+  Target Produced({ "f1" }, FunctionKind);
+  const ContainerSet &End = Pipeline["end"].containers();
+  BOOST_TEST(not End.contains(CName)
+             or not End.at(CName).enumerate().contains(Produced));
+
+  Cancelled = false;
+  BOOST_TEST(!Pipeline.run("end", Targets));
+  BOOST_TEST(Pipeline["end"].containers().at(CName).enumerate().contains(
+    Produced));
+}
+
+BOOST_AUTO_TEST_CASE(TargetCostsAreRecordedAndEstimated) {
+  Context Context;
+  Runner Pipeline(Context);
+  Pipeline.addDefaultConstructibleFactory<MapContainer>(CName);
+
+  const std::string Name = "first-step";
+  Pipeline.emplaceStep("", Name, "");
+  Pipeline.emplaceStep(Name,
+                       "end",
+                       "",
+                       PipeWrapper::bind<FineGrainPipe>(CName, CName));
+
+  auto &Container(Pipeline[Name].containers().getOrCreate<MapContainer>(CName));
+  Container.get(Target(RootKind)) = 1;
+
+  ContainerToTargetsMap Targets;
+  Targets.add(CName, { "f1" }, FunctionKind);
+  BOOST_TEST(!Pipeline.run("end", Targets));
+
+  const TargetCosts &Costs = Context.getTargetCosts();
+  BOOST_TEST(Costs.averageCost("end", CName).has_value());
+  BOOST_TEST(not Costs.averageCost(Name, CName).has_value());
+
+  TargetInStepSet Invalidations;
+  Invalidations["end"].add(CName, { "f1" }, FunctionKind);
+  Invalidations[Name].add(CName, { "f1" }, FunctionKind);
+  CostEstimate Estimate = Costs.estimate(Invalidations);
+  BOOST_TEST(Estimate.Targets == 2U);
+  BOOST_TEST(Estimate.UnknownTargets == 1U);
+  BOOST_TEST(Estimate.Seconds >= 0);
+
+  // The cost of a pipe is split among the targets it produces
+  TargetCosts Split;
+  ContainerToTargetsMap Produced;
+  Produced.add(CName, { "f1" }, FunctionKind);
+  Produced.add(CName, { "f2" }, FunctionKind);
+  Split.record("end", Produced, 2.0);
+  BOOST_TEST(*Split.averageCost("end", CName) == 1.0);
+}
+
+BOOST_AUTO_TEST_CASE(ProductionProgressIsTracked) {
+  Context Context;
+  ProductionProgress Progress;
+  Context.setProgress(&Progress);
+  Runner Pipeline(Context);
+  Pipeline.addDefaultConstructibleFactory<MapContainer>(CName);
+
+  const std::string Name = "first-step";
+  Pipeline.emplaceStep("", Name, "");
+  Pipeline.emplaceStep(Name,
+                       "end",
+                       "",
+                       PipeWrapper::bind<FineGrainPipe>(CName, CName));
+
+  auto &Container(Pipeline[Name].containers().getOrCreate<MapContainer>(CName));
+  Container.get(Target(RootKind)) = 1;
+
+  ContainerToTargetsMap Targets;
+  Targets.add(CName, { "f1" }, FunctionKind);
+  BOOST_TEST(!Pipeline.run("end", Targets));
+
+  ProgressSnapshot AfterRun = Progress.snapshot();
+  BOOST_TEST(not AfterRun.Running);
+  BOOST_TEST(AfterRun.Step == "end");
+  BOOST_TEST(AfterRun.DoneTargets == AfterRun.TotalTargets);
+  BOOST_TEST(AfterRun.DoneTargets > 0U);
+
+  // Before any commit, the estimate is based on the expected cost
+  Progress.startPipe("step", "pipe", 4, 0.5);
+  ProgressSnapshot Started = Progress.snapshot();
+  BOOST_TEST(Started.Running);
+  BOOST_TEST(Started.TargetsPerSecond == 2.0);
+  BOOST_TEST(*Started.RemainingSeconds == 2.0);
+
+  Progress.advance(2);
+  ProgressSnapshot Advanced = Progress.snapshot();
+  BOOST_TEST(Advanced.DoneTargets == 2U);
+  BOOST_TEST(Advanced.RemainingSeconds.has_value());
+
+  // Without an expected cost nor commits, there's no estimate
+  Progress.startPipe("step", "pipe", 4, std::nullopt);
+  BOOST_TEST(not Progress.snapshot().RemainingSeconds.has_value());
+
+  Progress.endPipe();
+  BOOST_TEST(not Progress.snapshot().Running);
+}
+
+BOOST_AUTO_TEST_CASE(EventLogRecordsTargetChanges) {
+  Context Context;
+  EventLog Events;
+  Context.setEventLog(&Events);
+  Runner Pipeline(Context);
+  Pipeline.addDefaultConstructibleFactory<MapContainer>(CName);
+
+  const std::string Name = "first-step";
+  Pipeline.emplaceStep("", Name, "");
+  Pipeline.emplaceStep(Name,
+                       "end",
+                       "",
+                       PipeWrapper::bind<FineGrainPipe>(CName, CName));
+
+  auto &Container(Pipeline[Name].containers().getOrCreate<MapContainer>(CName));
+  Container.get(Target(RootKind)) = 1;
+
+  ContainerToTargetsMap Targets;
+  Targets.add(CName, { "f1" }, FunctionKind);
+  BOOST_TEST(!Pipeline.run("end", Targets));
+
+  const std::string Produced = Target({ "f1" }, FunctionKind).toString();
+  auto IsEventOn = [&](const PipelineEvent &Event,
+                       PipelineEvent::KindType Kind) {
+    return Event.Kind == Kind and Event.Step == "end"
+           and Event.Container == CName and Event.Target == Produced;
+  };
+
+  EventBatch AfterRun = Events.since(0);
+  BOOST_TEST(not AfterRun.Truncated);
+  BOOST_TEST(AfterRun.Next == AfterRun.Events.size());
+  BOOST_TEST(llvm::any_of(AfterRun.Events, [&](const PipelineEvent &Event) {
+    return IsEventOn(Event, PipelineEvent::TargetProduced);
+  }));
+
+  // Producing again what is already available does not emit events
+  BOOST_TEST(!Pipeline.run("end", Targets));
+  BOOST_TEST(Events.since(AfterRun.Next).Events.empty());
+
+  BOOST_TEST(!Pipeline.invalidate(Target(RootKind)));
+  EventBatch AfterInvalidation = Events.since(AfterRun.Next);
+  BOOST_TEST(AfterInvalidation.Events.front().Sequence == AfterRun.Next);
+  BOOST_TEST(llvm::any_of(AfterInvalidation.Events,
+                          [&](const PipelineEvent &Event) {
+                            return IsEventOn(Event,
+                                             PipelineEvent::TargetInvalidated);
+                          }));
+
+  // Only the most recent events are kept
+  EventLog Small(2);
+  for (int I = 0; I < 3; ++I)
+    Small.globalChanged("model.yml", "/Functions");
+  EventBatch Truncated = Small.since(0);
+  BOOST_TEST(Truncated.Truncated);
+  BOOST_TEST(Truncated.Next == 3U);
+  BOOST_TEST(Truncated.Events.size() == 2U);
+  BOOST_TEST(Truncated.Events.front().Sequence == 1U);
+}
+
 BOOST_AUTO_TEST_CASE(SingleElementLLVMPipelineBackwardFinedGrained) {
   llvm::LLVMContext C;
 
@@ -1029,6 +1360,42 @@ static revng::DirectoryPath getCurrentPath() {
   return revng::DirectoryPath::fromLocalStorage(ToReturn.str());
 }
 
+BOOST_AUTO_TEST_CASE(StorageClientWriteBehind) {
+  llvm::SmallString<128> Root;
+  llvm::sys::fs::current_path(Root);
+  auto Client = llvm::cantFail(revng::StorageClient::fromPathOrURL(Root));
+  BOOST_TEST(!Client->setWriteBehind(true));
+  revng::DirectoryPath Path(Client.get(), "");
+
+  revng::FilePath File = Path.getFile("write-behind.txt");
+  {
+    auto MaybeWritableFile = File.getWritableFile();
+    BOOST_TEST(!!MaybeWritableFile);
+    MaybeWritableFile.get()->os() << "content";
+    BOOST_TEST(!MaybeWritableFile.get()->commit());
+  }
+
+  // Reads wait for pending writes, even without a commit of the client
+  auto MaybeReadableFile = File.getReadableFile();
+  BOOST_TEST(!!MaybeReadableFile);
+  BOOST_TEST(MaybeReadableFile.get()->buffer().getBuffer() == "content");
+
+  // Writes completing out of order never override more recent ones
+  for (unsigned I = 0; I < 16; ++I) {
+    auto MaybeWritableFile = File.getWritableFile();
+    BOOST_TEST(!!MaybeWritableFile);
+    MaybeWritableFile.get()->os() << "content " << I;
+    BOOST_TEST(!MaybeWritableFile.get()->commit());
+  }
+
+  BOOST_TEST(!Client->commit());
+  auto MaybeLastFile = File.getReadableFile();
+  BOOST_TEST(!!MaybeLastFile);
+  BOOST_TEST(MaybeLastFile.get()->buffer().getBuffer() == "content 15");
+
+  BOOST_TEST(!Client->setWriteBehind(false));
+}
+
 BOOST_AUTO_TEST_CASE(SingleElementPipelinestore) {
   Context Ctx;
   Runner Pipeline(Ctx);
@@ -1281,6 +1648,104 @@ BOOST_AUTO_TEST_CASE(InspectorKindTest) {
   BOOST_TEST(Container->enumerate().contains(RootF));
 }
 
+BOOST_AUTO_TEST_CASE(LLVMContainerLoadIsLazy) {
+  Context Ctx;
+  llvm::LLVMContext C;
+
+  using Cont = LLVMContainer;
+  auto Factory = ContainerFactory::fromGlobal<Cont>(&Ctx, &C);
+
+  auto Container = Factory("dont-care");
+  makeF(cast<Cont>(*Container).getModule(), "root");
+
+  revng::FilePath Path = getCurrentPath().getFile("lazy-llvm-container.ll");
+  BOOST_TEST(!Container->store(Path));
+
+  std::string Expected;
+  {
+    llvm::raw_string_ostream Stream(Expected);
+    BOOST_TEST(!Container->serialize(Stream));
+  }
+
+  // Storing a container that has been loaded but never accessed must
+  // reproduce the original content
+  auto Loaded = Factory("dont-care");
+  BOOST_TEST(!Loaded->load(Path));
+  std::string Reserialized;
+  {
+    llvm::raw_string_ostream Stream(Reserialized);
+    BOOST_TEST(!Loaded->serialize(Stream));
+  }
+  BOOST_TEST(Expected == Reserialized);
+
+  // Accessing the module parses it
+  Target RootF({ "root" }, InspKindExample);
+  BOOST_TEST(Loaded->enumerate().contains(RootF));
+  BOOST_TEST(cast<Cont>(*Loaded).getModule().getFunction("root") != nullptr);
+
+  // Storing an unmodified container to the file it was loaded from is a no-op,
+  // while changes must reach the disk
+  auto Unmodified = Factory("dont-care");
+  BOOST_TEST(!Unmodified->load(Path));
+  BOOST_TEST(!Unmodified->store(Path));
+
+  makeF(cast<Cont>(*Loaded).getModule(), "other");
+  BOOST_TEST(!Loaded->store(Path));
+
+  auto Reloaded = Factory("dont-care");
+  BOOST_TEST(!Reloaded->load(Path));
+  BOOST_TEST(cast<Cont>(*Reloaded).getModule().getFunction("other") != nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(ArtifactCacheIsSharedAcrossPipelines) {
+  using Cont = LLVMContainer;
+
+  // Start from an empty cache
+  llvm::SmallString<128> CachePath;
+  llvm::sys::fs::current_path(CachePath);
+  llvm::sys::path::append(CachePath, "artifact-cache");
+  llvm::sys::fs::remove_directories(CachePath);
+  ArtifactCache Cache(getCurrentPath().getDirectory("artifact-cache"));
+
+  const auto RunPipeline = [&Cache]() {
+    llvm::LLVMContext C;
+    Context Ctx;
+    Ctx.setArtifactCache(&Cache);
+
+    Runner Pipeline(Ctx);
+    Pipeline.addContainerFactory(CName,
+                                 ContainerFactory::fromGlobal<Cont>(&Ctx, &C));
+    Pipeline.emplaceStep("", "first-step", "");
+    Pipeline.emplaceStep("first-step",
+                         "end",
+                         "",
+                         Cont::wrapLLVMPasses(CName,
+                                              LLVMPassFunctionCreator()));
+
+    makeF(Pipeline["first-step"]
+            .containers()
+            .getOrCreate<Cont>(CName)
+            .getModule(),
+          "root");
+
+    ContainerToTargetsMap Targets;
+    Targets.add(CName, Target({ "f1" }, FunctionKind));
+    BOOST_TEST(!Pipeline.run("end", Targets));
+
+    const auto &Final = Pipeline["end"].containers().get<Cont>(CName);
+    BOOST_TEST(Final.getModule().getFunction("f1") != nullptr);
+    BOOST_TEST(Final.enumerate().contains(Target({ "f1" }, FunctionKind)));
+  };
+
+  // The second pipeline finds the result of the first one in the cache and
+  // does not run the pass again
+  unsigned Initial = FunctionInserterPass::RunCount;
+  RunPipeline();
+  BOOST_TEST(FunctionInserterPass::RunCount == Initial + 1);
+  RunPipeline();
+  BOOST_TEST(FunctionInserterPass::RunCount == Initial + 1);
+}
+
 BOOST_AUTO_TEST_CASE(MultiStepInvalidationTest) {
   Context Ctx;
   Runner Pipeline(Ctx);
@@ -1369,4 +1834,24 @@ BOOST_AUTO_TEST_CASE(PipeOptions) {
     BOOST_FAIL("unreachable");
 }
 
+BOOST_AUTO_TEST_CASE(DeadlineScopes) {
+  using namespace std::chrono_literals;
+  BOOST_TEST(not revng::deadlineExpired("the test"));
+
+  {
+    revng::DeadlineScope Outer(1ms);
+    {
+      // A scope cannot postpone the deadline of an enclosing one
+      revng::DeadlineScope Inner(1h);
+      std::this_thread::sleep_for(5ms);
+      BOOST_TEST(revng::deadlineExpired("the test"));
+      BOOST_TEST(Inner.hasExpired());
+    }
+    BOOST_TEST(Outer.hasExpired());
+  }
+
+  // The deadline is gone together with its scope
+  BOOST_TEST(not revng::deadlineExpired("the test"));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
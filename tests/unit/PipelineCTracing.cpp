@@ -111,4 +111,46 @@ BOOST_AUTO_TEST_CASE(PipelineCTraceTest) {
   verifyTrace(Trace2);
 }
 
+BOOST_AUTO_TEST_CASE(PipelineCTraceIndexTest) {
+  llvm::ExitOnError AbortOnError;
+  std::string Buffer;
+  std::string IndexBuffer;
+
+  {
+    llvm::raw_string_ostream OS(Buffer);
+    llvm::raw_string_ostream IndexOS(IndexBuffer);
+    tracing::setTracing(&OS, &IndexOS);
+
+    rp_manager *Manager = rp_manager_create(0, {}, "");
+    rp_manager_get_step_from_name(Manager, "begin");
+    rp_manager_get_step_from_name(Manager, "first-step");
+    rp_manager_destroy(Manager);
+
+    tracing::setTracing(nullptr);
+  }
+
+  auto Index = AbortOnError(tracing::TraceIndex::fromBuffer(IndexBuffer));
+  BOOST_TEST(Index.Entries.size() == 4ULL);
+
+  // The index recorded while tracing matches the one built from the trace
+  std::string ScannedIndexBuffer;
+  {
+    llvm::raw_string_ostream OS(ScannedIndexBuffer);
+    tracing::TraceIndex::fromTrace(Buffer).dump(OS);
+  }
+  BOOST_TEST(IndexBuffer == ScannedIndexBuffer);
+
+  const std::string &ManagerAddress = Index.Entries[0].Handles.at(0).second;
+  BOOST_TEST(Index.Entries[0].Handles.at(0).first
+             == tracing::TraceIndex::Entry::Result);
+  std::vector<size_t> Expected = { 0, 1, 2, 3 };
+  BOOST_TEST(Index.commandsUsing(ManagerAddress) == Expected,
+             boost::test_tools::per_element());
+
+  tracing::Command Command = AbortOnError(Index.loadCommand(Buffer, 2));
+  BOOST_TEST(Command.Name == "rp_manager_get_step_from_name");
+  BOOST_TEST(Command.Arguments[0].getScalar() == ManagerAddress);
+  BOOST_TEST(Command.Arguments[1].getScalar() == "first-step");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
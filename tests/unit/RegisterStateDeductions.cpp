@@ -158,4 +158,26 @@ BOOST_AUTO_TEST_CASE(ForbiddenRegisterFail) {
   revng_check(not Result.has_value());
 }
 
+BOOST_AUTO_TEST_CASE(MaskMatchesSet) {
+  auto ABI = abi::Definition::get(model::ABI::SystemV_x86_64);
+  const auto &GPRArguments = ABI.GeneralPurposeArgumentRegisters();
+  const auto &VRArguments = ABI.VectorArgumentRegisters();
+
+  abi::Definition::RegisterMask Arguments;
+  Arguments.set(GPRArguments[2]);
+  Arguments.set(VRArguments[1]);
+  Arguments = ABI.enforceArgumentRegisterMask(Arguments);
+
+  abi::Definition::RegisterSet Expected{ GPRArguments[2], VRArguments[1] };
+  Expected = ABI.enforceArgumentRegisterState(std::move(Expected));
+  revng_check(Arguments.count() == Expected.size());
+  for (model::Register::Values Register : Expected)
+    revng_check(Arguments.test(Register));
+
+  auto Register = model::Register::getLast<model::Architecture::x86_64>();
+  abi::Definition::RegisterMask Forbidden;
+  Forbidden.set(Register);
+  revng_check(not ABI.tryDeducingArgumentRegisterMask(Forbidden).has_value());
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -44,6 +44,84 @@ static_assert(std::is_copy_constructible_v<UpcastablePointer<TestClass>>);
 static_assert(std::is_move_assignable_v<UpcastablePointer<TestClass>>);
 static_assert(std::is_move_constructible_v<UpcastablePointer<TestClass>>);
 
+namespace ShapeKind {
+enum Values {
+  Invalid,
+  Square,
+  Circle,
+  Count
+};
+} // namespace ShapeKind
+
+class Shape {
+private:
+  ShapeKind::Values TheKind;
+
+public:
+  Shape(ShapeKind::Values Kind = ShapeKind::Invalid) : TheKind(Kind) {}
+  ShapeKind::Values &Kind() { return TheKind; }
+  const ShapeKind::Values &Kind() const { return TheKind; }
+  static bool classof(const Shape *) { return true; }
+};
+
+class Square : public Shape {
+public:
+  static constexpr ShapeKind::Values AssociatedKind = ShapeKind::Square;
+  Square() : Shape(AssociatedKind) {}
+  static bool classof(const Shape *S) { return S->Kind() == AssociatedKind; }
+};
+
+class Circle : public Shape {
+public:
+  static constexpr ShapeKind::Values AssociatedKind = ShapeKind::Circle;
+  Circle() : Shape(AssociatedKind) {}
+  static bool classof(const Shape *S) { return S->Kind() == AssociatedKind; }
+};
+
+template<>
+struct concrete_types_traits<Shape> {
+  using type = std::tuple<Square, Circle, Shape>;
+};
+
+template<>
+struct concrete_types_traits<const Shape> {
+  using type = std::tuple<const Square, const Circle, const Shape>;
+};
+
+static_assert(KindDispatchable<Shape>);
+static_assert(KindDispatchable<const Shape>);
+static_assert(not KindDispatchable<TestClass>);
+
+// Kinds without a concrete type resolve to the base, as with llvm::dyn_cast
+static_assert(detail::KindToIndex<Shape>[ShapeKind::Invalid] == 2);
+static_assert(detail::KindToIndex<Shape>[ShapeKind::Square] == 0);
+static_assert(detail::KindToIndex<Shape>[ShapeKind::Circle] == 1);
+
+template<typename T>
+static int kindOf(const T &) {
+  if constexpr (std::is_same_v<T, Square>)
+    return ShapeKind::Square;
+  else if constexpr (std::is_same_v<T, Circle>)
+    return ShapeKind::Circle;
+  else
+    return ShapeKind::Invalid;
+}
+
 int main() {
+  auto Dispatch = [](const UpcastablePointer<Shape> &Pointer) {
+    auto Visitor = [](const auto &Upcasted) { return kindOf(Upcasted); };
+    return upcast(Pointer, Visitor, -1);
+  };
+
+  revng_check(Dispatch(UpcastablePointer<Shape>::make<Square>()) == 1);
+  revng_check(Dispatch(UpcastablePointer<Shape>::make<Circle>()) == 2);
+  revng_check(Dispatch(UpcastablePointer<Shape>::make<Shape>()) == 0);
+  revng_check(Dispatch(UpcastablePointer<Shape>()) == -1);
+
+  // Copies go through the dispatch too
+  UpcastablePointer<Shape> Original = UpcastablePointer<Shape>::make<Circle>();
+  UpcastablePointer<Shape> Copy = Original;
+  revng_check(llvm::isa<Circle>(Copy.get()));
+
   return 0;
 }
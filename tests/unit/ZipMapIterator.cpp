@@ -215,3 +215,58 @@ BOOST_AUTO_TEST_CASE(TestSmallMap) {
 BOOST_AUTO_TEST_CASE(TestSortedVectorAndMutableSet) {
   run<SortedVector<int>, MutableSet<int>>();
 }
+
+template<typename LeftMap, typename RightMap>
+void runLongRuns() {
+  LeftMap A;
+  RightMap B;
+
+  using LeftKC = KeyContainer<LeftMap>;
+  using RightKC = KeyContainer<RightMap>;
+
+  // Long runs of elements present on one side only, long enough to trigger
+  // galloping, interleaved with shared elements
+  std::set<int> LeftKeys;
+  std::set<int> RightKeys;
+  for (int I = 0; I < 40; ++I)
+    LeftKeys.insert(I);
+  for (int I = 40; I < 100; ++I)
+    RightKeys.insert(I);
+  for (int I = 100; I < 110; ++I) {
+    LeftKeys.insert(I);
+    RightKeys.insert(I);
+  }
+  for (int I = 110; I < 117; ++I)
+    LeftKeys.insert(I);
+  RightKeys.insert(117);
+  for (int I = 118; I < 300; I += 2)
+    LeftKeys.insert(I);
+
+  for (int Key : LeftKeys)
+    LeftKC::insert(A, Key);
+  for (int Key : RightKeys)
+    RightKC::insert(B, Key);
+  LeftKC::sort(A);
+  RightKC::sort(B);
+
+  std::vector<std::pair<optional<int>, optional<int>>> Expected;
+  std::set<int> AllKeys = LeftKeys;
+  AllKeys.insert(RightKeys.begin(), RightKeys.end());
+  for (int Key : AllKeys) {
+    optional<int> Left;
+    optional<int> Right;
+    if (LeftKeys.contains(Key))
+      Left = Key;
+    if (RightKeys.contains(Key))
+      Right = Key;
+    Expected.push_back({ Left, Right });
+  }
+
+  compare(A, B, std::move(Expected));
+}
+
+BOOST_AUTO_TEST_CASE(TestLongRuns) {
+  runLongRuns<SortedVector<int>, SortedVector<int>>();
+  runLongRuns<SortedVector<int>, MutableSet<int>>();
+  runLongRuns<std::map<int, long>, std::map<int, long>>();
+}
@@ -63,11 +63,14 @@ int main(int Argc, char *Argv[]) {
     ExitOnError(llvm::createStringError(EC, EC.message()));
   auto &Stream = OutputFile.os();
 
-  auto Diff = diff(**LeftModel, **RightModel);
-  Diff.dump(Stream);
+  // Write the changes as they are found, instead of collecting them first: on
+  // large models, the diff can take as much memory as the models themselves
+  TupleTreeDiffWriter<model::Binary> Writer(Stream);
+  diff(**LeftModel, **RightModel, Writer);
+  Writer.finish();
   OutputFile.keep();
 
-  if (Diff.Changes.empty())
+  if (Writer.changes() == 0)
     return EXIT_SUCCESS;
   else
     return EXIT_FAILURE;
@@ -24,6 +24,18 @@ static cl::opt<std::string> InputModulePath(cl::Positional,
                                             cl::init("-"),
                                             cl::value_desc("module"));
 
+static cl::list<std::string> Roots("root",
+                                   cl::cat(ThisToolCategory),
+                                   cl::desc("Only print the types around the "
+                                            "type with this name"),
+                                   cl::value_desc("type name"));
+
+static cl::opt<unsigned> Depth("depth",
+                               cl::cat(ThisToolCategory),
+                               cl::desc("How many edges away from the roots "
+                                        "to go, in either direction"),
+                               cl::init(1));
+
 int main(int Argc, char *Argv[]) {
   revng::InitRevng X(Argc, Argv, "", { &ThisToolCategory });
 
@@ -39,8 +51,26 @@ int main(int Argc, char *Argv[]) {
   if (EC)
     revng_abort(EC.message().c_str());
 
+  const model::Binary &Binary = **MaybeModel;
   TypeSystemPrinter TSPrinter(Out);
-  TSPrinter.print(**MaybeModel);
+  if (Roots.empty()) {
+    TSPrinter.print(Binary);
+    return EXIT_SUCCESS;
+  }
+
+  llvm::SmallVector<const model::TypeDefinition *, 4> RootTypes;
+  for (const std::string &Name : Roots) {
+    auto IsNamed = [&Name](const model::UpcastableTypeDefinition &T) {
+      return T->name().str() == Name;
+    };
+    auto It = llvm::find_if(Binary.TypeDefinitions(), IsNamed);
+    if (It == Binary.TypeDefinitions().end())
+      ExitOnError(createStringError(inconvertibleErrorCode(),
+                                    "No type named " + Name));
+    RootTypes.push_back(It->get());
+  }
+
+  TSPrinter.printNeighbourhood(Binary, RootTypes, Depth);
 
   return EXIT_SUCCESS;
 }
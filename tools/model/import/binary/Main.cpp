@@ -59,7 +59,7 @@ int main(int Argc, char *Argv[]) {
   // Serialize
   Model.serialize(OutputFile.os());
 
-  Model->verify(true);
+  Model->verifyInParallel(true);
 
   OutputFile.keep();
 
@@ -9,6 +9,7 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Error.h"
 
+#include "revng/Model/Pass/ModelPassManager.h"
 #include "revng/Model/Pass/RegisterModelPass.h"
 #include "revng/Model/Processing.h"
 #include "revng/Model/ToolHelpers.h"
@@ -27,6 +28,19 @@ static cl::opt<std::string> InputFilename(cl::Positional,
                                           cl::value_desc("filename"),
                                           cl::cat(ThisToolCategory));
 
+static cl::opt<bool> OutputBinary("binary",
+                                  cl::desc("Emit the model in the binary "
+                                           "tuple tree format instead of "
+                                           "YAML"),
+                                  cl::cat(ThisToolCategory));
+
+static cl::opt<unsigned> Threads("model-pass-threads",
+                                cl::desc("Maximum number of model passes to "
+                                         "run concurrently, 0 for the number "
+                                         "of hardware threads"),
+                                cl::init(0),
+                                cl::cat(ThisToolCategory));
+
 class PassName : public std::string {
 public:
   PassName() {}
@@ -57,8 +71,10 @@ static cl::list<PassName> PassesList(cl::desc("Optimizations available:"),
                                      cl::cat(ThisToolCategory));
 
 static void loadPassesList() {
-  for (const auto &[Name, Description, _] : RegisterModelPass::passes())
-    PassesList.getParser().addLiteralOption(Name, PassName(Name), Description);
+  for (const RegisterModelPass::Registered &Pass : RegisterModelPass::passes())
+    PassesList.getParser().addLiteralOption(Pass.Name,
+                                            PassName(Pass.Name),
+                                            Pass.Description);
 }
 
 int main(int Argc, char *Argv[]) {
@@ -71,17 +87,15 @@ int main(int Argc, char *Argv[]) {
   auto ParsedModel = errorOrToExpected(Model::fromFileOrSTDIN(InputFilename));
   auto MaybeModel = ExitOnError(std::move(ParsedModel));
 
-  for (const PassName &PassName : PassesList) {
-    const RegisterModelPass::ModelPass *Pass = RegisterModelPass::get(PassName);
-    if (Pass == nullptr) {
-      ExitOnError(llvm::createStringError(llvm::inconvertibleErrorCode(),
-                                          "Pass not found: " + PassName));
-    }
+  ModelPassManager Manager(Threads);
+  for (const PassName &PassName : PassesList)
+    ExitOnError(Manager.add(PassName));
 
-    // Run pass
-    (*Pass)(MaybeModel);
-  }
+  Manager.run(MaybeModel);
 
   // Serialize
-  ExitOnError(MaybeModel.toFile(Options.getPath()));
+  if (OutputBinary)
+    ExitOnError(MaybeModel.toBinaryFile(Options.getPath()));
+  else
+    ExitOnError(MaybeModel.toFile(Options.getPath()));
 }
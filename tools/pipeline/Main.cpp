@@ -17,6 +17,7 @@
 
 #include "revng/Model/LoadModelPass.h"
 #include "revng/Pipeline/AllRegistries.h"
+#include "revng/Pipeline/ArtifactCache.h"
 #include "revng/Pipeline/ContainerSet.h"
 #include "revng/Pipeline/CopyPipe.h"
 #include "revng/Pipeline/GenericLLVMPipe.h"
@@ -29,6 +30,7 @@
 #include "revng/Pipes/PipelineManager.h"
 #include "revng/Pipes/ToolCLOptions.h"
 #include "revng/Support/InitRevng.h"
+#include "revng/Support/Statistics.h"
 #include "revng/TupleTree/TupleTreeDiff.h"
 
 using std::string;
@@ -71,6 +73,24 @@ static cl::list<string> AnalysesLists("analyses-list",
                                       desc("Analyses list to run"),
                                       cat(MainCategory));
 
+static opt<string> ArtifactCachePath("artifact-cache",
+                                     desc("Path or URL of a cache of the "
+                                          "results of pipes, shared across "
+                                          "runs and workspaces"),
+                                     cat(MainCategory),
+                                     init(""));
+
+static OutputPathOpt ProfileTrace("profile-trace",
+                                  desc("Save the time, memory and targets of "
+                                       "each step and pipe in the Chrome "
+                                       "trace-event format"),
+                                  cat(MainCategory));
+
+static OutputPathOpt StatisticsJSON("statistics-json",
+                                    desc("Save the statistics collected "
+                                         "during the run in JSON"),
+                                    cat(MainCategory));
+
 static opt<bool> InvalidateAll("invalidate-all",
                                desc("Try invalidating all possible "
                                     "targets after producing them. Used for "
@@ -107,6 +127,12 @@ static alias A2("t",
                 aliasopt(PrintBuildableTargets),
                 cat(MainCategory));
 
+static opt<bool> PrintMemoryUsage("memory-usage",
+                                  desc("Print an estimate of the memory used "
+                                       "by each container after running the "
+                                       "pipeline"),
+                                  cat(MainCategory));
+
 static ToolCLOptions BaseOptions(MainCategory);
 
 static ExitOnError AbortOnError;
@@ -163,7 +189,16 @@ int main(int argc, char *argv[]) {
 
   Registry::runAllInitializationRoutines();
 
+  // The cache must outlive the manager
+  std::unique_ptr<ArtifactCache> Cache;
+  if (not ArtifactCachePath.empty())
+    Cache = AbortOnError(ArtifactCache::fromPathOrURL(ArtifactCachePath));
+
   auto Manager = AbortOnError(BaseOptions.makeManager());
+  if (Cache != nullptr)
+    Manager.context().setArtifactCache(Cache.get());
+  if (ProfileTrace.hasValue())
+    Manager.setProfiling(true);
 
   for (const auto &Override : ContainerOverrides)
     AbortOnError(Manager.overrideContainer(Override));
@@ -213,6 +248,10 @@ int main(int argc, char *argv[]) {
     AbortOnError(Manager.invalidateAllPossibleTargets());
   }
 
+  // Before storing, which might release containers
+  if (PrintMemoryUsage)
+    Manager.writeMemoryUsage(llvm::outs());
+
   AbortOnError(Manager.store(StoresOverrides));
   AbortOnError(Manager.store());
 
@@ -223,5 +262,17 @@ int main(int argc, char *argv[]) {
     AbortOnError(FinalModel->store(*SaveModel));
   }
 
+  if (ProfileTrace.hasValue()) {
+    auto File = AbortOnError((*ProfileTrace).getWritableFile());
+    Manager.getProfiler()->emitChromeTrace(File->os());
+    AbortOnError(File->commit());
+  }
+
+  if (StatisticsJSON.hasValue()) {
+    auto File = AbortOnError((*StatisticsJSON).getWritableFile());
+    StatisticsRegistry::get().writeJSON(File->os());
+    AbortOnError(File->commit());
+  }
+
   return EXIT_SUCCESS;
 }
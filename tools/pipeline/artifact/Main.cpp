@@ -39,8 +39,8 @@ using namespace ::revng;
 
 static cl::list<string> Arguments(Positional,
                                   ZeroOrMore,
-                                  desc("<artifact> <binary> [TARGET [TARGET "
-                                       "[...]]]"),
+                                  desc("<artifact>[,<artifact>[...]] <binary> "
+                                       "[TARGET [TARGET [...]]]"),
                                   cat(MainCategory));
 
 static OutputPathOpt Output("o",
@@ -48,6 +48,13 @@ static OutputPathOpt Output("o",
                             cat(MainCategory),
                             init(revng::PathInit::Dash));
 
+static opt<string> OutputDirectory("output-directory",
+                                   desc("When more than one artifact is "
+                                        "requested, the directory where to "
+                                        "store them, each one in a file named "
+                                        "after its artifact"),
+                                   cat(MainCategory));
+
 static OutputPathOpt SaveModel("save-model",
                                desc("Save the model at the end of the run"),
                                cat(MainCategory));
@@ -66,6 +73,28 @@ static opt<bool> Analyze("analyze",
                          desc("Run all available *-initial-auto-analysis"),
                          cat(MainCategory));
 
+static OutputPathOpt ProfileTrace("profile-trace",
+                                  desc("Save the time, memory and targets of "
+                                       "each analysis, step and pipe in the "
+                                       "Chrome trace-event format"),
+                                  cat(MainCategory));
+
+static opt<string> Shard("shard",
+                         desc("Produce only a shard of the artifact, in the "
+                              "form I/N: the targets are split in N shards "
+                              "and only the I-th (starting from 0) is "
+                              "produced. The shards can be produced "
+                              "independently, even on different machines, and "
+                              "then joined with --merge-shard."),
+                         cat(MainCategory));
+
+static cl::list<string> MergeShards("merge-shard",
+                                    desc("Instead of producing the artifact, "
+                                         "merge the specified artifacts, "
+                                         "produced using --shard, into the "
+                                         "output"),
+                                    cat(MainCategory));
+
 static ToolCLOptions BaseOptions(MainCategory);
 
 static ExitOnError AbortOnError;
@@ -82,6 +111,68 @@ printStringPair(const std::vector<std::pair<std::string, std::string>> &Pairs) {
               << "- " << Second << "\n";
 }
 
+static Expected<std::pair<size_t, size_t>> parseShard(StringRef Text) {
+  auto [Index, Count] = Text.split('/');
+  size_t ShardIndex = 0;
+  size_t ShardsCount = 0;
+  if (Index.getAsInteger(10, ShardIndex) or Count.getAsInteger(10, ShardsCount)
+      or ShardsCount == 0 or ShardIndex >= ShardsCount) {
+    return createStringError(inconvertibleErrorCode(),
+                             "Invalid shard \"%s\", expected I/N with "
+                             "I < N.",
+                             Text.str().c_str());
+  }
+
+  return std::make_pair(ShardIndex, ShardsCount);
+}
+
+/// \return the targets of the \p ShardIndex-th of \p ShardsCount shards
+static TargetsList filterShard(const TargetsList &Targets,
+                               size_t ShardIndex,
+                               size_t ShardsCount) {
+  // Assign the targets in a round-robin fashion, so that each shard gets a
+  // similar mix of functions
+  TargetsList Result = Targets;
+  size_t Index = 0;
+  Result.erase_if([&](const Target &) {
+    return (Index++ % ShardsCount) != ShardIndex;
+  });
+
+  return Result;
+}
+
+/// An artifact requested on the command line
+struct RequestedArtifact {
+  Step *TheStep = nullptr;
+  const ContainerSet::value_type *Container = nullptr;
+  const Kind *TheKind = nullptr;
+  ContainerToTargetsMap Targets;
+};
+
+static Expected<RequestedArtifact> getArtifact(PipelineManager &Manager,
+                                               StringRef Name) {
+  if (not Manager.getRunner().containsStep(Name)) {
+    return createStringError(inconvertibleErrorCode(),
+                             "No known artifact named %s.\nUse `revng "
+                             "artifact` with no arguments to list "
+                             "available artifacts.",
+                             Name.str().c_str());
+  }
+
+  RequestedArtifact Result;
+  Result.TheStep = &Manager.getRunner().getStep(Name);
+  Result.Container = Result.TheStep->getArtifactsContainer();
+  Result.TheKind = Result.TheStep->getArtifactsKind();
+  if (Result.Container == nullptr) {
+    return createStringError(inconvertibleErrorCode(),
+                             "The step %s is not associated to an "
+                             "artifact.",
+                             Name.str().c_str());
+  }
+
+  return Result;
+}
+
 int main(int argc, char *argv[]) {
   using revng::FilePath;
 
@@ -92,7 +183,8 @@ int main(int argc, char *argv[]) {
   auto Manager = AbortOnError(BaseOptions.makeManager());
 
   if (Arguments.size() == 0) {
-    std::cout << "USAGE: revng-artifact [options] <artifact> <binary>\n\n";
+    std::cout << "USAGE: revng-artifact [options] <artifact>[,<artifact>...] "
+                 "<binary>\n\n";
     std::cout << "<artifact> can be one of:\n\n";
 
     std::vector<std::pair<std::string, std::string>> Pairs;
@@ -107,23 +199,38 @@ int main(int argc, char *argv[]) {
     return EXIT_SUCCESS;
   }
 
-  if (not Manager.getRunner().containsStep(Arguments[0])) {
-    AbortOnError(createStringError(inconvertibleErrorCode(),
-                                   "No known artifact named %s.\nUse `revng "
-                                   "artifact` with no arguments to list "
-                                   "available artifacts.",
-                                   Arguments[0].c_str()));
-  }
+  // Several artifacts can be requested at once, so that they are planned
+  // together and the steps they have in common are run only once
+  SmallVector<StringRef> ArtifactNames;
+  StringRef(Arguments[0]).split(ArtifactNames, ',');
+  SmallVector<RequestedArtifact> Artifacts;
+  for (StringRef Name : ArtifactNames)
+    Artifacts.push_back(AbortOnError(getArtifact(Manager, Name)));
+  bool ManyArtifacts = Artifacts.size() > 1;
+
+  if (ManyArtifacts) {
+    if (OutputDirectory.getNumOccurrences() == 0
+        or Output.getNumOccurrences() > 0) {
+      AbortOnError(createStringError(inconvertibleErrorCode(),
+                                     "When more than one artifact is "
+                                     "requested, --output-directory must be "
+                                     "used instead of -o."));
+    }
 
-  auto &Step = Manager.getRunner().getStep(Arguments[0]);
-  auto MaybeContainer = Step.getArtifactsContainer();
-  if (not MaybeContainer) {
+    if (ListArtifacts or MergeShards.getNumOccurrences() > 0) {
+      AbortOnError(createStringError(inconvertibleErrorCode(),
+                                     "--list and --merge-shard only support "
+                                     "a single artifact."));
+    }
+  } else if (OutputDirectory.getNumOccurrences() > 0) {
     AbortOnError(createStringError(inconvertibleErrorCode(),
-                                   "The step %s is not associated to an "
-                                   "artifact.",
-                                   Arguments[0].c_str()));
+                                   "--output-directory requires more than "
+                                   "one artifact, use -o instead."));
   }
 
+  auto &Step = *Artifacts.front().TheStep;
+  auto MaybeContainer = Artifacts.front().Container;
+
   if (Analyze && AnalysesLists.getNumOccurrences() > 0) {
     AbortOnError(createStringError(inconvertibleErrorCode(),
                                    "Cannot use --analyze and --analyses-lists "
@@ -136,10 +243,32 @@ int main(int argc, char *argv[]) {
                                    "arguments different from 1."));
   }
 
+  if (Shard.getNumOccurrences() > 0 and MergeShards.getNumOccurrences() > 0) {
+    AbortOnError(createStringError(inconvertibleErrorCode(),
+                                   "Cannot use --shard and --merge-shard "
+                                   "together."));
+  }
+
+  if (ProfileTrace.hasValue())
+    Manager.setProfiling(true);
+
   auto &InputContainer = Manager.getRunner().begin()->containers()["input"];
   InputPath = Arguments[1];
   AbortOnError(InputContainer.load(FilePath::fromLocalStorage(Arguments[1])));
 
+  if (MergeShards.getNumOccurrences() > 0) {
+    auto &Container = Step.containers()[MaybeContainer->first()];
+    auto Merged = Container.cloneFiltered({});
+    for (const std::string &ShardPath : MergeShards) {
+      auto Part = Container.cloneFiltered({});
+      AbortOnError(Part->load(FilePath::fromLocalStorage(ShardPath)));
+      Merged->mergeBack(std::move(*Part));
+    }
+
+    AbortOnError(Merged->store(*Output));
+    return EXIT_SUCCESS;
+  }
+
   TargetInStepSet InvMap;
   for (auto &AnalysesListName : AnalysesLists) {
     if (!Manager.getRunner().hasAnalysesList(AnalysesListName)) {
@@ -184,10 +313,9 @@ int main(int argc, char *argv[]) {
 
   T.advance("Produce artifact", true);
 
-  auto ContainerName = MaybeContainer->first();
-  auto *Kind = Step.getArtifactsKind();
-
   if (ListArtifacts) {
+    auto ContainerName = MaybeContainer->first();
+    auto *Kind = Step.getArtifactsKind();
     Manager.recalculateAllPossibleTargets();
     auto &StepState = *Manager.getLastState().find(Step.getName());
     auto State = StepState.second.find(ContainerName)->second.filter(*Kind);
@@ -199,25 +327,63 @@ int main(int argc, char *argv[]) {
     return EXIT_SUCCESS;
   }
 
-  ContainerToTargetsMap Map;
   if (Arguments.size() == 2) {
-    Map.add(ContainerName, Kind->allTargets(Manager.context()));
+    for (RequestedArtifact &Artifact : Artifacts) {
+      TargetsList Targets = Artifact.TheKind->allTargets(Manager.context());
+      if (Shard.getNumOccurrences() > 0) {
+        auto [ShardIndex, ShardsCount] = AbortOnError(parseShard(Shard));
+        Targets = filterShard(Targets, ShardIndex, ShardsCount);
+      }
+      Artifact.Targets.add(Artifact.Container->first(), Targets);
+    }
   } else {
     for (llvm::StringRef Argument : llvm::drop_begin(Arguments, 2)) {
       auto RequestedTarget = AbortOnError(Target::deserialize(Manager.context(),
                                                               Argument));
-      Map.add(ContainerName, RequestedTarget);
+
+      // Each target goes to the artifacts of its kind
+      bool Found = false;
+      for (RequestedArtifact &Artifact : Artifacts) {
+        if (ManyArtifacts and &RequestedTarget.getKind() != Artifact.TheKind)
+          continue;
+
+        Artifact.Targets.add(Artifact.Container->first(), RequestedTarget);
+        Found = true;
+      }
+
+      if (not Found) {
+        AbortOnError(createStringError(inconvertibleErrorCode(),
+                                       "None of the requested artifacts has "
+                                       "the kind of target %s.",
+                                       Argument.str().c_str()));
+      }
     }
   }
-  AbortOnError(Manager.getRunner().run(Step.getName(), Map));
+
+  // Produce all the artifacts with a single run, so that the steps they have
+  // in common are scheduled and run once
+  Runner::State ToProduce;
+  for (RequestedArtifact &Artifact : Artifacts)
+    ToProduce[Artifact.TheStep->getName()].merge(Artifact.Targets);
+  AbortOnError(Manager.getRunner().run(ToProduce));
 
   AbortOnError(Manager.store());
 
-  const TargetsList &Targets = Map.contains(ContainerName) ?
-                                 Map.at(ContainerName) :
-                                 TargetsList();
-  auto Produced = MaybeContainer->second->cloneFiltered(Targets);
-  AbortOnError(Produced->store(*Output));
+  for (RequestedArtifact &Artifact : Artifacts) {
+    auto ContainerName = Artifact.Container->first();
+    const TargetsList &Targets = Artifact.Targets.contains(ContainerName) ?
+                                   Artifact.Targets.at(ContainerName) :
+                                   TargetsList();
+    auto Produced = Artifact.Container->second->cloneFiltered(Targets);
+
+    if (ManyArtifacts) {
+      auto Directory = revng::DirectoryPath::fromLocalStorage(OutputDirectory);
+      StringRef Name = Artifact.TheStep->getName();
+      AbortOnError(Produced->store(Directory.getFile(Name)));
+    } else {
+      AbortOnError(Produced->store(*Output));
+    }
+  }
 
   if (SaveModel.hasValue()) {
     auto Context = Manager.context();
@@ -226,5 +392,11 @@ int main(int argc, char *argv[]) {
     AbortOnError(FinalModel->store(*SaveModel));
   }
 
+  if (ProfileTrace.hasValue()) {
+    auto File = AbortOnError((*ProfileTrace).getWritableFile());
+    Manager.getProfiler()->emitChromeTrace(File->os());
+    AbortOnError(File->commit());
+  }
+
   return EXIT_SUCCESS;
 }
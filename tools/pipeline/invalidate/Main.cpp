@@ -40,6 +40,13 @@ static opt<bool> DumpPredictedRemovals("dump-invalidations",
                                             "targets"),
                                        cat(MainCategory));
 
+static opt<bool> EstimateCost("estimate-cost",
+                              desc("print the estimated cost of producing "
+                                   "again the invalidated targets, based on "
+                                   "the recorded costs, and exit without "
+                                   "invalidating them"),
+                              cat(MainCategory));
+
 static opt<bool> DumpFinalStatus("dump-status",
                                  desc("dump status after invalidation "
                                       "targets"),
@@ -81,10 +88,14 @@ int main(int argc, char *argv[]) {
   auto Map = getTargetInStepSet(Manager.getRunner());
   AbortOnError(Manager.getRunner().getInvalidations(Map));
 
-  if (DumpPredictedRemovals) {
+  if (DumpPredictedRemovals)
     dumpTargetInStepSet(llvm::outs(), Map);
+
+  if (EstimateCost)
+    Manager.context().getTargetCosts().estimate(Map).dump(llvm::outs());
+
+  if (DumpPredictedRemovals or EstimateCost)
     return EXIT_SUCCESS;
-  }
 
   AbortOnError(Manager.getRunner().invalidate(Map));
 
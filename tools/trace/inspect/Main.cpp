@@ -7,6 +7,7 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/ToolOutputFile.h"
 
 #include "revng/PipelineC/Tracing/Trace.h"
@@ -16,7 +17,8 @@
 using llvm::StringRef;
 
 using revng::tracing::BufferLocation;
-using revng::tracing::Trace;
+using revng::tracing::Command;
+using revng::tracing::TraceIndex;
 
 namespace Options {
 using namespace llvm::cl;
@@ -44,6 +46,18 @@ static alias ExtractBufferA("e",
                             desc("Alias for --extract-buffer"),
                             aliasopt(ExtractBuffer));
 
+static opt<string> CommandsUsing("commands-using",
+                                 cat(ThisToolCategory),
+                                 desc("List the commands taking or returning "
+                                      "the specified handle"),
+                                 value_desc("ptr_0x..."));
+
+static opt<bool> WriteIndex("write-index",
+                            desc("Write the index of a trace recorded "
+                                 "without one"),
+                            cat(ThisToolCategory),
+                            init(false));
+
 static opt<string> Output("output",
                           cat(ThisToolCategory),
                           desc("Output file when extracting"),
@@ -57,17 +71,62 @@ static alias OutputA("o",
 
 static llvm::ExitOnError AbortOnError;
 
+static std::unique_ptr<llvm::MemoryBuffer> openTrace() {
+  auto MaybeBuffer = llvm::MemoryBuffer::getFile(Options::Input);
+  if (std::error_code EC = MaybeBuffer.getError()) {
+    AbortOnError(llvm::createStringError(EC,
+                                         "Unable to read input trace: "
+                                           + EC.message()));
+  }
+
+  return std::move(*MaybeBuffer);
+}
+
 int main(int argc, char *argv[]) {
   revng::InitRevng X(argc, argv, "", { &Options::ThisToolCategory });
 
-  if (Options::ListBuffers xor Options::ExtractBuffer.empty()) {
-    dbg << "Please specify either --list-buffers or --extract-buffer\n";
+  unsigned Actions = Options::ListBuffers + !Options::ExtractBuffer.empty()
+                     + !Options::CommandsUsing.empty() + Options::WriteIndex;
+  if (Actions != 1) {
+    dbg << "Please specify exactly one of --list-buffers, --extract-buffer, "
+           "--commands-using and --write-index\n";
     return EXIT_FAILURE;
   }
 
+  // Queries are answered through the index, so that only the commands of
+  // interest are parsed
+  std::unique_ptr<llvm::MemoryBuffer> TraceBuffer = openTrace();
+  StringRef TraceContent = TraceBuffer->getBuffer();
+
+  if (Options::WriteIndex) {
+    TraceIndex Index = TraceIndex::fromTrace(TraceContent);
+    std::error_code EC;
+    llvm::ToolOutputFile OutputFile(TraceIndex::pathFor(Options::Input),
+                                    EC,
+                                    llvm::sys::fs::OF_Text);
+    if (EC) {
+      dbg << "Unable to write the index: " << EC.message() << "\n";
+      return EXIT_FAILURE;
+    }
+
+    Index.dump(OutputFile.os());
+    OutputFile.keep();
+    return EXIT_SUCCESS;
+  }
+
+  TraceIndex Index = AbortOnError(TraceIndex::forTrace(Options::Input,
+                                                       TraceContent));
+
+  if (!Options::CommandsUsing.empty()) {
+    for (size_t CommandNo : Index.commandsUsing(Options::CommandsUsing)) {
+      const TraceIndex::Entry &Entry = Index.Entries[CommandNo];
+      std::cout << "Command #" << CommandNo << ": " << Entry.Name << "\n";
+    }
+    return EXIT_SUCCESS;
+  }
+
   if (Options::ListBuffers) {
-    Trace TheTrace = AbortOnError(Trace::fromFile(Options::Input));
-    std::vector<BufferLocation> Result = TheTrace.listBuffers();
+    std::vector<BufferLocation> Result = Index.listBuffers();
     for (auto &Location : Result) {
       std::cout << "Buffer on command " << Location.CommandName << " (Command #"
                 << Location.CommandNumber << "), argument #"
@@ -92,9 +151,10 @@ int main(int argc, char *argv[]) {
       return EXIT_FAILURE;
     }
 
-    Trace TheTrace = AbortOnError(Trace::fromFile(Options::Input));
+    Command TheCommand = AbortOnError(Index.loadCommand(TraceContent,
+                                                        CommandNo));
     using Buffer = std::vector<char>;
-    Buffer Result = AbortOnError(TheTrace.getBuffer(CommandNo, ArgNo));
+    Buffer Result = AbortOnError(TheCommand.getBuffer(ArgNo));
 
     std::error_code EC;
     llvm::ToolOutputFile OutputFile(Options::Output,
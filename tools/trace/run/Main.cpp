@@ -71,6 +71,11 @@ static opt<std::string> Resume("trace-resume",
                                cat(TraceRunToolCategory),
                                desc("Use the provided directory as a resume "
                                     "directory"));
+static opt<bool> Benchmark("benchmark",
+                           init(false),
+                           cat(TraceRunToolCategory),
+                           desc("Time each command and print statistics "
+                                "at the end of the run"));
 
 static alias SoftAssertsA("s",
                           desc("Alias for --soft-asserts"),
@@ -119,6 +124,7 @@ int main(int argc, const char *argv[]) {
     .BreakAt = { Options::BreakAt.begin(), Options::BreakAt.end() },
     .TemporaryRoot = TemporaryRoot,
     .ResumeDirectory = Options::Resume,
+    .BenchmarkOutput = Options::Benchmark ? &llvm::outs() : nullptr,
   };
   AbortOnError(TheTrace.run(Options));
 
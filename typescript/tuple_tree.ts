@@ -321,6 +321,11 @@ export function makeDiffSubtree(
         return [];
     }
 
+    // Trees produced by applyDiff share the untouched subtrees
+    if (obj_old === obj_new) {
+        return [];
+    }
+
     let infoObject: TypeInfoObject;
     let upcast = false;
     if (typeInfo.isAbstract) {
@@ -478,13 +483,67 @@ export function _getTypeInfo(
     return undefined;
 }
 
-function getParentElementByPath<T>(path: string, obj: any): T | undefined {
-    const parentPath = path.split("/").slice(1, -1);
-    if (parentPath.length > 1) {
-        return _getElementByPath(`/${parentPath.join("/")}`, obj);
-    } else {
+function shallowCopy<T>(obj: T): T {
+    if (obj instanceof Array) {
+        return obj.slice() as T;
+    }
+    return Object.assign(Object.create(Object.getPrototypeOf(obj)), obj);
+}
+
+/**
+ * Like getElementByPathArray, but replaces each object from obj (excluded) to
+ * the result with a shallow copy, unless it's already in copies. This way, the
+ * result can be modified without affecting the other trees sharing objects with
+ * obj.
+ */
+function getWritableElementByPathArray(path: string[], obj: any, copies: Set<any>): any {
+    if (obj === undefined || path.length === 0) {
         return obj;
     }
+
+    let component = path[0];
+    let slot: string | number = component;
+    if (obj instanceof Array) {
+        slot = obj.findIndex((elem) => keyableObject(elem) && elem.key() === component);
+        if (slot === -1) {
+            return undefined;
+        }
+    } else {
+        if (component.includes("::")) {
+            const parts = component.split("::", 2);
+            component = parts[1];
+            slot = component;
+            if (obj.Kind !== parts[0]) {
+                return undefined;
+            }
+        }
+        if (!(component in obj)) {
+            return undefined;
+        }
+    }
+
+    let child = obj[slot];
+    if (child !== null && typeof child === "object" && !copies.has(child)) {
+        child = shallowCopy(child);
+        copies.add(child);
+        obj[slot] = child;
+    }
+    return getWritableElementByPathArray(path.slice(1), child, copies);
+}
+
+/**
+ * Find the index of the element of array matching raw, by key if the elements
+ * are keyed, by value otherwise. Returns -1 if there's no such element.
+ */
+function findArrayElement(array: any[], info: TypeInfo, raw: any): number {
+    const element = constructType(info, raw);
+    if (keyableObject(element)) {
+        const key = element.key();
+        return array.findIndex((e) => keyableObject(e) && e.key() === key);
+    }
+
+    const serialized = yaml.stringify(raw);
+    return array.findIndex((e) => yaml.stringify(e) === serialized);
 }
 
 export function _validateDiff<T>(obj: T, diffs: DiffSet, getTypeInfo: getTypeInfoType): boolean {
@@ -494,21 +553,16 @@ export function _validateDiff<T>(obj: T, diffs: DiffSet, getTypeInfo: getTypeInf
         if (info.isArray) {
             if (diff.Remove !== undefined) {
                 if (target instanceof Array) {
-                    const array_target = target.find(
-                        (e) => yaml.stringify(e) === yaml.stringify(diff.Remove)
-                    );
-                    if (array_target === undefined) {
+                    const idx = findArrayElement(target, info, diff.Remove);
+                    if (idx === -1 || yaml.stringify(target[idx]) !== yaml.stringify(diff.Remove)) {
                         return false;
                     }
                 } else {
                     return false;
                 }
             }
-            if (diff.Add !== undefined && target instanceof Array) {
-                const array_target = target.find(
-                    (e) => yaml.stringify(e) === yaml.stringify(diff.Add)
-                );
-                if (array_target !== undefined) {
+            if (diff.Add !== undefined && diff.Remove === undefined && target instanceof Array) {
+                if (findArrayElement(target, info, diff.Add) !== -1) {
                     return false;
                 }
             }
@@ -527,42 +581,54 @@ export function _validateDiff<T>(obj: T, diffs: DiffSet, getTypeInfo: getTypeInf
     return true;
 }
 
+/**
+ * Apply diffs to obj, returning the new tree. obj is left untouched: the new
+ * tree copies only the objects on the paths of the changes and shares the rest
+ * with obj, hence unchanged subtrees are identical (===) in the two trees.
+ */
 export function _applyDiff<T>(
     obj: T,
     diffs: DiffSet,
     validateDiff: (obj: T, diffs: DiffSet) => boolean,
-    getTypeInfo: getTypeInfoType,
-    clone: (obj: T) => T
+    getTypeInfo: getTypeInfoType
 ): [false] | [true, T] {
     if (!validateDiff(obj, diffs)) {
         return [false];
     }
-    const new_obj = clone(obj);
+
+    const new_obj = shallowCopy(obj);
+    const copies = new Set<any>([new_obj]);
+    const getWritable = (path: string[]) => getWritableElementByPathArray(path, new_obj, copies);
+
     for (const diff of diffs.Changes) {
-        let target = _getElementByPath(diff.Path, new_obj);
+        const path = diff.Path.split("/").slice(1);
         const info = getTypeInfo(diff.Path);
-        if (target instanceof Array) {
+        if (info.isArray) {
+            let target = getWritable(path);
+            if (target === undefined) {
+                if (diff.Add === undefined) {
+                    continue;
+                }
+                const parent = getWritable(path.slice(0, -1));
+                target = [];
+                copies.add(target);
+                parent[path[path.length - 1]] = target;
+            }
+
             if (diff.Remove !== undefined) {
-                const idx = target.findIndex(
-                    (e) => yaml.stringify(e) === yaml.stringify(diff.Remove)
-                );
+                const idx = findArrayElement(target, info, diff.Remove);
                 target.splice(idx, 1);
             }
 
             if (diff.Add !== undefined) {
-                if (target === undefined) {
-                    const parentPath = diff.Path.split("/").slice(1);
-                    const element = parentPath.pop();
-                    const parent = _getElementByPath(parentPath.join("/"), new_obj)!;
-                    parent[element!] = [];
-                    target = parent[element!];
-                }
-                (target as any).push(constructType(info, diff.Add));
+                target.push(constructType(info, diff.Add));
             }
         } else {
-            const parent = getParentElementByPath(diff.Path, new_obj)!;
-            const element = diff.Path.split("/").reverse()[0];
-            true;
+            const parent = getWritable(path.slice(0, -1));
+            let element = path[path.length - 1];
+            if (element.includes("::")) {
+                element = element.split("::", 2)[1];
+            }
             if (diff.Remove !== undefined) {
                 parent[element] = undefined;
             }